@@ -0,0 +1,62 @@
+ /**
+ ******************************************************************************
+ * @file    app_pipe.h
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+#ifndef APP_PIPE
+#define APP_PIPE
+
+#include <stdint.h>
+
+/* 0: sequential loop, the NN pipe takes one snapshot per inference.
+ * 1: pipelined loop, the NN pipe captures continuously in a ring of buffers while the
+ *    NPU runs the newest frame and the CPU draws the results of the previous one. */
+#ifndef APP_PIPELINE_MODE
+#define APP_PIPELINE_MODE 0
+#endif
+
+/* One buffer being captured, one ready, one held while copied to the NN input
+ * (and until its ROIs are cropped with APP_ROI_CLASSIFIER) */
+#define APP_PIPE_NB_BUFFERS 3
+
+typedef enum
+{
+  APP_PIPE_FREE = 0,
+  APP_PIPE_CAPTURE,
+  APP_PIPE_READY,
+  APP_PIPE_HELD
+} app_pipe_state_t;
+
+/* Capture ring of the NN pipe. Frames get consecutive ids when their capture ends,
+ * dropped frames leave a gap.
+ * No hardware access: app_pipe_frame_done() is called from the frame event interrupt,
+ * app_pipe_acquire() and app_pipe_release() from the main loop with interrupts masked. */
+typedef struct
+{
+  uint8_t *buffers[APP_PIPE_NB_BUFFERS];
+  app_pipe_state_t state[APP_PIPE_NB_BUFFERS];
+  uint32_t frame_id[APP_PIPE_NB_BUFFERS];
+  int32_t capture_idx;
+  uint32_t next_frame_id;
+  uint32_t nb_dropped;
+} app_pipe_t;
+
+void app_pipe_init(app_pipe_t *pipe, uint8_t *buffers[APP_PIPE_NB_BUFFERS]);
+uint8_t *app_pipe_capture_buffer(app_pipe_t *pipe);
+uint8_t *app_pipe_frame_done(app_pipe_t *pipe);
+int32_t app_pipe_acquire(app_pipe_t *pipe, uint8_t **buffer, uint32_t *frame_id);
+void app_pipe_release(app_pipe_t *pipe, int32_t idx);
+
+#endif
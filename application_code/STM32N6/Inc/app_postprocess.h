@@ -42,6 +42,7 @@ extern "C"
 #include "iseg_pp_output_if.h"
 #include "sseg_deeplabv3_pp_if.h"
 #include "sseg_pp_output_if.h"
+#include "od_tracker_pp_if.h"
 
 #define POSTPROCESS_OD_YOLO_V2_UF       (10) /* Yolov2 postprocessing; Input model: uint8; output: float32         */
 #define POSTPROCESS_OD_YOLO_V5_UU       (11) /* Yolov5 postprocessing; Input model: uint8; output: uint8           */
@@ -55,9 +56,41 @@ extern "C"
 #define POSTPROCESS_ISEG_YOLO_V8_UI     (30) /* Yolov8 Seg postprocessing; Input model: uint8; output: int8        */
 #define POSTPROCESS_SSEG_DEEPLAB_V3_UF  (40) /* Deeplabv3 Seg postprocessing; Input model: uint8; output: float32  */
 
+/* 0: object detections are displayed as the post processing outputs them.
+ * 1: object detections go through the tracker of lib_vision_models_pp: displayed boxes are smoothed,
+ *    keep a track id and survive a few missed detections. In the sequential loop the detector runs
+ *    once every APP_TRACKER_DETECT_PERIOD displayed frames, the tracks being extrapolated in between. */
+#ifndef APP_TRACKER
+#define APP_TRACKER 0
+#endif
+#ifndef APP_TRACKER_DETECT_PERIOD
+#define APP_TRACKER_DETECT_PERIOD 1
+#endif
+
+/* Tracker tuning, see od_tracker_pp_static_param_t */
+#ifndef APP_TRACKER_IOU_THRESHOLD
+#define APP_TRACKER_IOU_THRESHOLD   (0.3f)
+#endif
+#ifndef APP_TRACKER_DIST_THRESHOLD
+#define APP_TRACKER_DIST_THRESHOLD  (1.0f)
+#endif
+#ifndef APP_TRACKER_ALPHA
+#define APP_TRACKER_ALPHA           (0.6f)
+#endif
+#ifndef APP_TRACKER_BETA
+#define APP_TRACKER_BETA            (0.3f)
+#endif
+#ifndef APP_TRACKER_MIN_HITS
+#define APP_TRACKER_MIN_HITS        (2)
+#endif
+#ifndef APP_TRACKER_MAX_MISSED
+#define APP_TRACKER_MAX_MISSED      (3)
+#endif
+
 /* Exported functions ------------------------------------------------------- */
 int32_t app_postprocess_init(void *params_postprocess);
 int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *pInput_param);
+int32_t app_tracker_init(od_tracker_pp_static_param_t *params_tracker);
 
 #ifdef __cplusplus
 }
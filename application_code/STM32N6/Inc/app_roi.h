@@ -0,0 +1,118 @@
+ /**
+ ******************************************************************************
+ * @file    app_roi.h
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+#ifndef APP_ROI
+#define APP_ROI
+
+#include <stdint.h>
+#include "od_pp_output_if.h"
+
+/* 0: detections are displayed as is.
+ * 1: each detection is cropped from the NN capture frame and classified by a second network
+ *    (generated with --name classifier), run back-to-back over all the detections of a frame. */
+#ifndef APP_ROI_CLASSIFIER
+#define APP_ROI_CLASSIFIER 0
+#endif
+
+/* Second network input */
+#ifndef ROI_NN_WIDTH
+#define ROI_NN_WIDTH 128
+#endif
+#ifndef ROI_NN_HEIGHT
+#define ROI_NN_HEIGHT 128
+#endif
+#define ROI_NN_BPP 3
+
+/* Detections classified per frame */
+#ifndef APP_ROI_MAX_ROIS
+#define APP_ROI_MAX_ROIS 16
+#endif
+
+/* ROI k + 1 is cropped in one slot while ROI k is inferred from the other */
+#define APP_ROI_NB_SLOTS 2
+
+/* Output lines cropped between two polls of the running inference */
+#define APP_ROI_CROP_BAND 8
+
+typedef struct
+{
+  uint32_t x0;
+  uint32_t y0;
+  uint32_t width;
+  uint32_t height;
+} app_roi_rect_t;
+
+/* Frame the ROIs are cropped from, the detection boxes being normalized to it */
+typedef struct
+{
+  const uint8_t *pixels;
+  uint32_t width;
+  uint32_t height;
+  uint32_t pitch;
+  uint32_t bpp;       /* 2: RGB565, 3: RGB888 */
+  uint32_t bgr;       /* RGB888 only, 0: R, G, B bytes, 1: B, G, R bytes */
+} app_roi_frame_t;
+
+/* Second network input tensor, 3 channels of 8 bits */
+typedef struct
+{
+  uint32_t width;
+  uint32_t height;
+  uint32_t bgr;       /* 0: RGB, 1: BGR channel order */
+} app_roi_input_t;
+
+/* Second network, no hardware access in the batch runner.
+ * start() launches the inference of an input slot, the slot is not written again before
+ * poll() returned 1, so the network may read it in place or copy it to its input buffer.
+ * poll() advances the inference without blocking and returns 1 once it is done.
+ * idle() waits for the next network event, it may be NULL.
+ * result() reads the outputs of the inference of box box_idx. */
+typedef struct
+{
+  void *ctx;
+  void (*start)(void *ctx, uint8_t *input);
+  int32_t (*poll)(void *ctx);
+  void (*idle)(void *ctx);
+  void (*result)(void *ctx, uint32_t box_idx);
+} app_roi_net_t;
+
+/* Crops and resizes lines [y_start, y_end) of the NN input of a ROI */
+typedef void (*app_roi_crop_t)(const app_roi_frame_t *frame, const app_roi_rect_t *rect,
+                               const app_roi_input_t *input, uint8_t *dst,
+                               uint32_t y_start, uint32_t y_end);
+
+typedef struct
+{
+  app_roi_net_t net;
+  app_roi_input_t input;
+  app_roi_crop_t crop;
+  uint8_t *slots[APP_ROI_NB_SLOTS];
+  app_roi_rect_t rects[APP_ROI_MAX_ROIS];
+  uint32_t box_idx[APP_ROI_MAX_ROIS];
+  uint32_t nb_rois;
+} app_roi_batch_t;
+
+void app_roi_init(app_roi_batch_t *batch, const app_roi_net_t *net, const app_roi_input_t *input,
+                  uint8_t *slots[APP_ROI_NB_SLOTS]);
+int32_t app_roi_box_to_rect(const od_pp_outBuffer_t *box, uint32_t frame_width, uint32_t frame_height,
+                            app_roi_rect_t *rect);
+void app_roi_crop_resize(const app_roi_frame_t *frame, const app_roi_rect_t *rect,
+                         const app_roi_input_t *input, uint8_t *dst, uint32_t y_start, uint32_t y_end);
+uint32_t app_roi_run(app_roi_batch_t *batch, const app_roi_frame_t *frame,
+                     const od_pp_outBuffer_t *boxes, uint32_t nb_boxes);
+
+#endif
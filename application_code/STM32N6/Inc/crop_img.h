@@ -18,10 +18,18 @@
 #ifndef CROP_IMG
 #define CROP_IMG
 #include "arm_math.h"
+#include "ll_aton_NN_interface.h"
 
 
 void img_crop(uint8_t *src_image, uint8_t *dst_img, const uint32_t src_width,
               const uint16_t dst_width, const uint16_t dst_height,
               const uint16_t bpp);
+void img_crop_inplace(uint8_t *image, const uint32_t src_stride,
+                      const uint16_t dst_width, const uint16_t height,
+                      const uint16_t dst_bpp);
+int img_crop_inplace_fits(const LL_Buffer_InfoTypeDef *nn_in_info,
+                          const LL_Buffer_InfoTypeDef *internal_info,
+                          const LL_Buffer_InfoTypeDef *output_info,
+                          const uint32_t frame_len);
 
 #endif
\ No newline at end of file
@@ -16,10 +16,12 @@
 #endif
 
 #include "arm_math.h"
+#include "vision_models_nms_if.h"
 
 /* Error return codes */
 #define AI_ISEG_POSTPROCESS_ERROR_NO                    (0)
 #define AI_ISEG_POSTPROCESS_ERROR_BAD_HW                (-1)
+#define AI_ISEG_POSTPROCESS_ERROR                       (-2)
 
 
 typedef struct
@@ -17,6 +17,7 @@
 
 
 #include "iseg_pp_output_if.h"
+#include "vision_models_pp_ctx_if.h"
 
 
 /* I/O structures for YoloV8 SEG type */
@@ -36,9 +37,26 @@ typedef struct
 	int8_t height;
 	int8_t conf;
 	uint8_t class_index;
-	int8_t *pMask; // AI_ISEG_YOLOV8_PP_SEG_MASK_NB application definition
+	int8_t *pMask; // nb_masks coefficients, in the scratch arena
 } iseg_postprocess_scratchBuffer_s8_t;
 
+/* Scratch arena of iseg_yolov8_pp_process: one record per candidate box, the int32 mask
+ * coefficients of the decoded detection and the int8 coefficients of each candidate */
+#define AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(nb_total_boxes, nb_masks) \
+  ((nb_total_boxes) * sizeof(iseg_postprocess_scratchBuffer_s8_t) + \
+   (nb_masks) * sizeof(int32_t) + (nb_total_boxes) * (nb_masks) * sizeof(int8_t))
+
+/* Mask decoding. FULL evaluates the whole mask grid of each detection. BOX only evaluates
+ * the pixels inside the box (clipped to the mask grid) and clears the others: same pixels
+ * inside the box, faster for small boxes. The LAZY modes leave the decoding to the
+ * application through iseg_yolov8_pp_decode_mask(), for the detections it actually uses. */
+typedef enum yolov8_seg_pp_mask_mode {
+  AI_ISEG_YOLOV8_PP_MASK_FULL = 0,
+  AI_ISEG_YOLOV8_PP_MASK_BOX,
+  AI_ISEG_YOLOV8_PP_MASK_LAZY,
+  AI_ISEG_YOLOV8_PP_MASK_LAZY_BOX
+} yolov8_seg_pp_mask_mode_e;
+
 
 typedef struct yolov8_seg_pp_static_param {
   int32_t  nb_classes;
@@ -46,15 +64,15 @@ typedef struct yolov8_seg_pp_static_param {
   int32_t  max_boxes_limit;
   float32_t conf_threshold;
   float32_t iou_threshold;
-  int32_t nb_detect;
   int32_t nb_masks;
   int32_t size_masks;
   int32_t raw_output_zero_point;
   float32_t raw_output_scale;
   int32_t mask_raw_output_zero_point;
   float32_t mask_raw_output_scale;
-  float32_t *pMask;
-  iseg_postprocess_scratchBuffer_s8_t *pTmpBuff;
+  vision_models_nms_mode_e nms_mode;
+  yolov8_seg_pp_mask_mode_e mask_mode;
+  int32_t conf_threshold_s8;   /* set by iseg_yolov8_pp_reset from conf_threshold */
 } yolov8_seg_pp_static_param_t;
 
 
@@ -69,6 +87,16 @@ typedef struct yolov8_seg_pp_static_param {
 int32_t iseg_yolov8_pp_reset(yolov8_seg_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Size in bytes of the scratch arena needed by iseg_yolov8_pp_process,
+ *        same as AI_ISEG_YOLOV8_PP_SCRATCH_SIZE
+ *
+ * @param [IN] Input static parameters
+ * @retval Scratch size
+ */
+uint32_t iseg_yolov8_pp_get_scratch_size(const yolov8_seg_pp_static_param_t *pInput_static_param);
+
+
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for YoloV8.
@@ -76,11 +104,33 @@ int32_t iseg_yolov8_pp_reset(yolov8_seg_pp_static_param_t *pInput_static_param);
  * @param [IN] Pointer on input data
  *             Pointer on output data
  *             pointer on static parameters
+ *             Pointer on the context, with a scratch arena of at least
+ *             iseg_yolov8_pp_get_scratch_size() bytes
  * @retval Error code
  */
 int32_t iseg_yolov8_pp_process(yolov8_seg_pp_in_centroid_int8_t *pInput,
                                iseg_postprocess_out_t *pOutput,
-                               yolov8_seg_pp_static_param_t *pInput_static_param);
+                               const yolov8_seg_pp_static_param_t *pInput_static_param,
+                               vision_models_pp_ctx_t *pCtx);
+
+
+/*!
+ * @brief Decodes the mask of one detection returned by iseg_yolov8_pp_process
+ *        in a LAZY mask mode. Raw masks and scratch arena of the
+ *        context must not have been modified since the process call.
+ *
+ * @param [IN] Pointer on input data
+ *             Pointer on output data
+ *             pointer on static parameters
+ *             Pointer on the context given to the process call
+ *             Index of the detection in the output data
+ * @retval Error code
+ */
+int32_t iseg_yolov8_pp_decode_mask(yolov8_seg_pp_in_centroid_int8_t *pInput,
+                                   iseg_postprocess_out_t *pOutput,
+                                   const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                   vision_models_pp_ctx_t *pCtx,
+                                   int32_t detection_index);
 
 
 
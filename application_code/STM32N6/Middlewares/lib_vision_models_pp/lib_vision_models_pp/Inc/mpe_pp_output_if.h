@@ -20,6 +20,7 @@
 #endif
 
 #include "arm_math.h"
+#include "vision_models_nms_if.h"
 
 
 /*Pose structures*/
@@ -37,8 +37,8 @@ typedef struct mpe_yolov8_pp_static_param {
   int32_t  max_boxes_limit;
   float32_t conf_threshold;
   float32_t iou_threshold;
-  int32_t nb_detect;
 	uint32_t nb_keypoints;
+	vision_models_nms_mode_e	nms_mode;
 } mpe_yolov8_pp_static_param_t;
 
 
@@ -64,7 +64,7 @@ int32_t mpe_yolov8_pp_reset(mpe_yolov8_pp_static_param_t *pInput_static_param);
  */
 int32_t mpe_yolov8_pp_process(mpe_yolov8_pp_in_centroid_t *pInput,
                               mpe_pp_out_t *pOutput,
-                              mpe_yolov8_pp_static_param_t *pInput_static_param);
+                              const mpe_yolov8_pp_static_param_t *pInput_static_param);
 
 
 
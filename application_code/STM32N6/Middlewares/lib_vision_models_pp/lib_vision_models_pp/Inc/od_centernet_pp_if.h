@@ -17,6 +17,7 @@
 
 #include "arm_math.h"
 #include "od_pp_output_if.h"
+#include "vision_models_pp_ctx_if.h"
 
 
 
@@ -29,6 +30,12 @@ typedef struct centernet_pp_in
 } centernet_pp_in_t;
 
 
+/* Scratch arena of od_centernet_pp_process: one detection record per grid cell, then the dense map
+ * of the center confidences upsampled by AI_OD_CENTERNET_PP_OPTIM_ACCURACY */
+#define AI_OD_CENTERNET_PP_SCRATCH_SIZE(grid_width, grid_height) \
+  ((grid_width) * (grid_height) * (sizeof(od_pp_outBuffer_t) + sizeof(float32_t)))
+
+
 /* Generic Static parameters */
 /* ------------------------- */
 typedef enum centernet_pp_optim {
@@ -46,7 +53,7 @@ typedef struct centernet_pp_static_param {
   float32_t	conf_threshold;
   float32_t	iou_threshold;
   centernet_pp_optim_e optim;
-  int32_t nb_detect;
+  vision_models_nms_mode_e nms_mode;
 } centernet_pp_static_param_t;
 
 
@@ -62,6 +69,16 @@ typedef struct centernet_pp_static_param {
 int32_t od_centernet_pp_reset(centernet_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Size in bytes of the scratch arena needed by od_centernet_pp_process,
+ *        same as AI_OD_CENTERNET_PP_SCRATCH_SIZE
+ *
+ * @param [IN] Input static parameters
+ * @retval Scratch size
+ */
+uint32_t od_centernet_pp_get_scratch_size(const centernet_pp_static_param_t *pInput_static_param);
+
+
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for CenterNet.
@@ -69,11 +86,14 @@ int32_t od_centernet_pp_reset(centernet_pp_static_param_t *pInput_static_param);
  * @param [IN] Pointer on input data
  *             Pointer on output data
  *             pointer on static parameters
+ *             Pointer on the context, with a scratch arena of at least
+ *             od_centernet_pp_get_scratch_size() bytes
  * @retval Error code
  */
 int32_t od_centernet_pp_process(centernet_pp_in_t *pInput,
                                 od_pp_out_t *pOutput,
-                                centernet_pp_static_param_t *pInput_static_param);
+                                const centernet_pp_static_param_t *pInput_static_param,
+                                vision_models_pp_ctx_t *pCtx);
 
 
 #ifdef __cplusplus
@@ -17,6 +17,18 @@
 
 #include "arm_math.h"
 
+/* Packed int8 candidate used by the quantized paths, its head matches the int8 NMS
+ * records (box, confidence, class index) */
+typedef struct
+{
+  int8_t  x_center;
+  int8_t  y_center;
+  int8_t  width;
+  int8_t  height;
+  int8_t  conf;
+  uint8_t class_index;
+} od_pp_scratchBuffer_s8_t;
+
 /*-----------------------------     YOLO_V2      -----------------------------*/
 /* Offsets to access YoloV2 input data */
 #define AI_YOLOV2_PP_XCENTER      (0)
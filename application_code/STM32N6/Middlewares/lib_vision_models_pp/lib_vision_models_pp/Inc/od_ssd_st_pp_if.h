@@ -15,6 +15,7 @@
 #endif
 
 #include "od_pp_output_if.h"
+#include "vision_models_pp_ctx_if.h"
 
 
 /* I/O structures for SSD detector type */
@@ -27,6 +28,12 @@ typedef struct ssd_st_pp_in_centroid
 } ssd_st_pp_in_centroid_t;
 
 
+/* Scratch arena of od_ssd_st_pp_process: each candidate box with its scores of all the
+ * classes but the background */
+#define AI_OD_SSD_ST_PP_SCRATCH_SIZE(nb_detections, nb_classes) \
+  ((nb_detections) * (4 + ((nb_classes) - 1)) * sizeof(float32_t))
+
+
 /* Generic Static parameters */
 /* ------------------------- */
 typedef struct ssd_st_pp_static_param
@@ -36,7 +43,7 @@ typedef struct ssd_st_pp_static_param
 	int32_t   max_boxes_limit;
 	float32_t	conf_threshold;
 	float32_t	iou_threshold;
-	int32_t   nb_detect;
+	vision_models_nms_mode_e	nms_mode;
 } ssd_st_pp_static_param_t;
 
 
@@ -51,6 +58,16 @@ typedef struct ssd_st_pp_static_param
 int32_t od_ssd_st_pp_reset(ssd_st_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Size in bytes of the scratch arena needed by od_ssd_st_pp_process,
+ *        same as AI_OD_SSD_ST_PP_SCRATCH_SIZE
+ *
+ * @param [IN] Input static parameters
+ * @retval Scratch size
+ */
+uint32_t od_ssd_st_pp_get_scratch_size(const ssd_st_pp_static_param_t *pInput_static_param);
+
+
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for SSD.
@@ -58,11 +75,14 @@ int32_t od_ssd_st_pp_reset(ssd_st_pp_static_param_t *pInput_static_param);
  * @param [IN] Pointer on input data
  *             Pointer on output data
  *             pointer on static parameters
+ *             Pointer on the context, with a scratch arena of at least
+ *             od_ssd_st_pp_get_scratch_size() bytes
  * @retval Error code
  */
 int32_t od_ssd_st_pp_process(ssd_st_pp_in_centroid_t *pInput,
-                                 od_pp_out_t *pOutput,
-                                 ssd_st_pp_static_param_t *pInput_static_param);
+                              od_pp_out_t *pOutput,
+                              const ssd_st_pp_static_param_t *pInput_static_param,
+                              vision_models_pp_ctx_t *pCtx);
 
 
 #ifdef __cplusplus
@@ -16,6 +16,7 @@
 #endif
 
 #include "od_pp_output_if.h"
+#include "vision_models_pp_ctx_if.h"
 
 
 /* I/O structures for ST_YoloX detector type */
@@ -28,6 +29,13 @@ typedef struct st_yolox_pp_in
 } st_yolox_pp_in_t;
 
 
+/* Scratch arena of od_st_yolox_pp_process: the levels are decoded one after the other, each in
+ * one record of the input layout (box, objectness and the scores of all the classes) per anchor
+ * box; nb_level_boxes is the number of anchor boxes of the largest level */
+#define AI_OD_ST_YOLOX_PP_SCRATCH_SIZE(nb_level_boxes, nb_classes) \
+  ((nb_level_boxes) * (5 + (nb_classes)) * sizeof(float32_t))
+
+
 
 /* Generic Static parameters */
 /* ------------------------- */
@@ -48,7 +56,8 @@ typedef struct st_yolox_pp_static_param {
   const float32_t	*pAnchors_L;
   const float32_t	*pAnchors_M;
   const float32_t	*pAnchors_S;
-  int32_t nb_detect;
+  vision_models_nms_mode_e nms_mode;
+  float32_t conf_threshold_logit;   /* set by od_st_yolox_pp_reset from conf_threshold */
 } st_yolox_pp_static_param_t;
 
 
@@ -64,18 +73,31 @@ typedef struct st_yolox_pp_static_param {
 int32_t od_st_yolox_pp_reset(st_yolox_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Size in bytes of the scratch arena needed by od_st_yolox_pp_process,
+ *        same as AI_OD_ST_YOLOX_PP_SCRATCH_SIZE for the largest of the three grids
+ *
+ * @param [IN] Input static parameters
+ * @retval Scratch size
+ */
+uint32_t od_st_yolox_pp_get_scratch_size(const st_yolox_pp_static_param_t *pInput_static_param);
+
+
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for ST_YoloX.
  *
  * @param [IN] Pointer on input data
- *             Pointer on output data
+ *             Pointer on output data, whose buffer holds the detections of the three levels
  *             pointer on static parameters
+ *             Pointer on the context, with a scratch arena of at least
+ *             od_st_yolox_pp_get_scratch_size() bytes
  * @retval Error code
  */
 int32_t od_st_yolox_pp_process(st_yolox_pp_in_t *pInput,
                                od_pp_out_t *pOutput,
-                               st_yolox_pp_static_param_t *pInput_static_param);
+                               const st_yolox_pp_static_param_t *pInput_static_param,
+                               vision_models_pp_ctx_t *pCtx);
 
 
 
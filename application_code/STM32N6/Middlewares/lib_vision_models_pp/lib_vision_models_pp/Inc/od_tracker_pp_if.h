@@ -0,0 +1,140 @@
+/*---------------------------------------------------------------------------------------------
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file in
+ * the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *--------------------------------------------------------------------------------------------*/
+
+#ifndef __OD_TRACKER_PP_IF_H__
+#define __OD_TRACKER_PP_IF_H__
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include "od_pp_output_if.h"
+
+
+/* Capacity of the track table, and detections considered per update */
+#ifndef AI_OD_TRACKER_PP_MAX_TRACKS
+#define AI_OD_TRACKER_PP_MAX_TRACKS      (32)
+#endif
+
+/* Largest tracks x detections problem solved by AI_OD_TRACKER_PP_ASSOC_OPTIMAL,
+ * bigger ones fall back to the greedy association */
+#ifndef AI_OD_TRACKER_PP_OPTIMAL_MAX
+#define AI_OD_TRACKER_PP_OPTIMAL_MAX     (12)
+#endif
+
+
+/* Association of the detections to the tracks, selected through the assoc_mode field */
+/* ---------------------------------------------------------------------------------- */
+typedef enum od_tracker_pp_assoc_mode {
+  AI_OD_TRACKER_PP_ASSOC_GREEDY = 0,   /* pairs associated by decreasing affinity */
+  AI_OD_TRACKER_PP_ASSOC_OPTIMAL       /* assignment maximizing the total affinity (Hungarian method) */
+} od_tracker_pp_assoc_mode_e;
+
+
+/* Track state, position and size normalized as od_pp_outBuffer_t */
+typedef struct od_tracker_pp_track
+{
+  float32_t x_center;
+  float32_t y_center;
+  float32_t width;
+  float32_t height;
+  float32_t conf;
+  int32_t   class_index;
+  float32_t vx;                /* center velocity, per frame */
+  float32_t vy;
+  uint32_t  track_id;
+  int32_t   nb_hits;           /* detections associated to the track */
+  int32_t   nb_missed;         /* consecutive updates without detection */
+  int32_t   nb_frames;         /* frames since the last detection */
+} od_tracker_pp_track_t;
+
+/* Tracker output, a record begins as od_pp_outBuffer_t */
+typedef struct
+{
+  float32_t x_center;
+  float32_t y_center;
+  float32_t width;
+  float32_t height;
+  float32_t conf;
+  int32_t   class_index;
+  uint32_t  track_id;
+  int32_t   nb_missed;
+} od_tracker_pp_outBuffer_t;
+
+typedef struct
+{
+  od_tracker_pp_outBuffer_t *pOutBuff;   /* AI_OD_TRACKER_PP_MAX_TRACKS records */
+  int32_t nb_tracks;
+} od_tracker_pp_out_t;
+
+
+typedef struct od_tracker_pp_static_param {
+  float32_t iou_threshold;     /* smallest IoU associating a detection to a track */
+  float32_t dist_threshold;    /* below iou_threshold, largest center distance associating a detection,
+                                  in box sizes per frame since the track was last detected;
+                                  0 disables the centroid association */
+  float32_t alpha;             /* position and size smoothing (1: detection taken as is) */
+  float32_t beta;              /* velocity smoothing (0: no extrapolation) */
+  int32_t   min_hits;          /* detections before a track is output */
+  int32_t   max_missed;        /* updates a track is extrapolated without detection before it is dropped */
+  od_tracker_pp_assoc_mode_e assoc_mode;
+  /* Tracker state, set by od_tracker_pp_reset */
+  od_tracker_pp_track_t tracks[AI_OD_TRACKER_PP_MAX_TRACKS];
+  int32_t   nb_tracks;
+  uint32_t  next_track_id;
+  /* Scratch memory */
+  int16_t   det_track[AI_OD_TRACKER_PP_MAX_TRACKS];
+  int16_t   track_det[AI_OD_TRACKER_PP_MAX_TRACKS];
+  float32_t affinity[AI_OD_TRACKER_PP_MAX_TRACKS][AI_OD_TRACKER_PP_MAX_TRACKS];
+} od_tracker_pp_static_param_t;
+
+
+/* Exported functions ------------------------------------------------------- */
+
+/*!
+ * @brief Resets the object tracker: all tracks are dropped
+ *
+ * @param [IN] Input static parameters
+ * @retval Error code
+ */
+int32_t od_tracker_pp_reset(od_tracker_pp_static_param_t *pInput_static_param);
+
+
+/*!
+ * @brief Object tracker update with the detections of a frame : tracks extrapolated to
+ *        the frame, association of the detections, smoothing, creation and deletion of tracks.
+ *        At most AI_OD_TRACKER_PP_MAX_TRACKS detections are considered, by order.
+ *
+ * @param [IN] Pointer on object detector post processing output
+ *             Pointer on output data, the confirmed tracks
+ *             pointer on static parameters
+ * @retval Error code
+ */
+int32_t od_tracker_pp_update(od_pp_out_t *pInput,
+                             od_tracker_pp_out_t *pOutput,
+                             od_tracker_pp_static_param_t *pInput_static_param);
+
+
+/*!
+ * @brief Object tracker extrapolation to a frame the detector did not run on.
+ *        Tracks are moved by their velocity, no track is created or dropped.
+ *
+ * @param [IN] Pointer on output data, the confirmed tracks
+ *             pointer on static parameters
+ * @retval Error code
+ */
+int32_t od_tracker_pp_predict(od_tracker_pp_out_t *pOutput,
+                              od_tracker_pp_static_param_t *pInput_static_param);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif      /* __OD_TRACKER_PP_IF_H__  */
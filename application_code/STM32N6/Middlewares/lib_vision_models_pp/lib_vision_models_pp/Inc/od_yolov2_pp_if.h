@@ -16,6 +16,7 @@
 #endif
 
 #include "od_pp_output_if.h"
+#include "vision_models_pp_ctx_if.h"
 
 
 /* I/O structures for YoloV2 detector type */
@@ -26,6 +27,12 @@ typedef struct yolov2_pp_in
 } yolov2_pp_in_t;
 
 
+/* Scratch arena of od_yolov2_pp_process: one record of the input layout (box, objectness and
+ * the scores of all the classes) per anchor box of the grid */
+#define AI_OD_YOLOV2_PP_SCRATCH_SIZE(nb_anchor_boxes, nb_classes) \
+  ((nb_anchor_boxes) * (5 + (nb_classes)) * sizeof(float32_t))
+
+
 
 /* Generic Static parameters */
 /* ------------------------- */
@@ -40,7 +47,8 @@ typedef struct yolov2_pp_static_param {
   float32_t	conf_threshold;
   float32_t	iou_threshold;
   const float32_t	*pAnchors;
-  int32_t nb_detect;
+  vision_models_nms_mode_e nms_mode;
+  float32_t conf_threshold_logit;   /* set by od_yolov2_pp_reset from conf_threshold */
 } yolov2_pp_static_param_t;
 
 
@@ -56,6 +64,16 @@ typedef struct yolov2_pp_static_param {
 int32_t od_yolov2_pp_reset(yolov2_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Size in bytes of the scratch arena needed by od_yolov2_pp_process,
+ *        same as AI_OD_YOLOV2_PP_SCRATCH_SIZE for grid_width * grid_height * nb_anchors boxes
+ *
+ * @param [IN] Input static parameters
+ * @retval Scratch size
+ */
+uint32_t od_yolov2_pp_get_scratch_size(const yolov2_pp_static_param_t *pInput_static_param);
+
+
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for YoloV2.
@@ -63,11 +81,14 @@ int32_t od_yolov2_pp_reset(yolov2_pp_static_param_t *pInput_static_param);
  * @param [IN] Pointer on input data
  *             Pointer on output data
  *             pointer on static parameters
+ *             Pointer on the context, with a scratch arena of at least
+ *             od_yolov2_pp_get_scratch_size() bytes
  * @retval Error code
  */
 int32_t od_yolov2_pp_process(yolov2_pp_in_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov2_pp_static_param_t *pInput_static_param);
+                                    const yolov2_pp_static_param_t *pInput_static_param,
+                                    vision_models_pp_ctx_t *pCtx);
 
 
 
@@ -39,7 +39,8 @@ typedef struct yolov5_pp_static_param {
   float32_t iou_threshold;
   float32_t raw_output_scale;
   uint8_t raw_output_zero_point;
-  int32_t nb_detect;
+  vision_models_nms_mode_e nms_mode;
+  int32_t conf_threshold_u8;   /* set by od_yolov5_pp_reset from conf_threshold, uint8 input only */
 } yolov5_pp_static_param_t;
 
 
@@ -65,7 +66,7 @@ int32_t od_yolov5_pp_reset(yolov5_pp_static_param_t *pInput_static_param);
  */
 int32_t od_yolov5_pp_process(yolov5_pp_in_centroid_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov5_pp_static_param_t *pInput_static_param);
+                                    const yolov5_pp_static_param_t *pInput_static_param);
 
 
 /*!
@@ -79,7 +80,7 @@ int32_t od_yolov5_pp_process(yolov5_pp_in_centroid_t *pInput,
  */
 int32_t od_yolov5_pp_process_uint8(yolov5_pp_in_centroid_uint8_t *pInput,
                                          od_pp_out_t *pOutput,
-                                         yolov5_pp_static_param_t *pInput_static_param);
+                                         const yolov5_pp_static_param_t *pInput_static_param);
 
 #ifdef __cplusplus
  }
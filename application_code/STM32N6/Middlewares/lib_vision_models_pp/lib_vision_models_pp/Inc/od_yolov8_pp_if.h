@@ -31,6 +31,22 @@ typedef struct yolov8_pp_in_centroid_int8
 } yolov8_pp_in_centroid_int8_t;
 
 
+/* Number of od_pp_outBuffer_t records of the output buffer of od_yolov8_pp_process_int8.
+ * Up to 255 classes, the candidates are packed 6 bytes int8 records laid in the output buffer,
+ * then at most max_boxes_limit detections per class are output; beyond, one record per box
+ * as od_yolov8_pp_process */
+#define AI_OD_YOLOV8_PP_INT8_CANDIDATE_RECORDS(nb_total_boxes) \
+  (((nb_total_boxes) * 6 + sizeof(od_pp_outBuffer_t) - 1) / sizeof(od_pp_outBuffer_t))
+#define AI_OD_YOLOV8_PP_INT8_DETECTION_RECORDS(nb_total_boxes, nb_classes, max_boxes_limit) \
+  ((((nb_classes) * (max_boxes_limit)) < (nb_total_boxes)) ? ((nb_classes) * (max_boxes_limit)) : (nb_total_boxes))
+#define AI_OD_YOLOV8_PP_INT8_OUT_RECORDS(nb_total_boxes, nb_classes, max_boxes_limit) \
+  (((nb_classes) > 255) ? (nb_total_boxes) : \
+   ((AI_OD_YOLOV8_PP_INT8_CANDIDATE_RECORDS(nb_total_boxes) > \
+     AI_OD_YOLOV8_PP_INT8_DETECTION_RECORDS(nb_total_boxes, nb_classes, max_boxes_limit)) ? \
+    AI_OD_YOLOV8_PP_INT8_CANDIDATE_RECORDS(nb_total_boxes) : \
+    AI_OD_YOLOV8_PP_INT8_DETECTION_RECORDS(nb_total_boxes, nb_classes, max_boxes_limit)))
+
+
 typedef struct yolov8_pp_static_param {
   int32_t  nb_classes;
   int32_t  nb_total_boxes;
@@ -39,7 +55,8 @@ typedef struct yolov8_pp_static_param {
   float32_t iou_threshold;
   float32_t raw_output_scale;
   int8_t raw_output_zero_point;
-  int32_t nb_detect;
+  vision_models_nms_mode_e nms_mode;
+  int32_t conf_threshold_s8;   /* set by od_yolov8_pp_reset from conf_threshold, int8 input only */
 } yolov8_pp_static_param_t;
 
 
@@ -65,12 +82,13 @@ int32_t od_yolov8_pp_reset(yolov8_pp_static_param_t *pInput_static_param);
  */
 int32_t od_yolov8_pp_process(yolov8_pp_in_centroid_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov8_pp_static_param_t *pInput_static_param);
+                                    const yolov8_pp_static_param_t *pInput_static_param);
 
 
 /*!
  * @brief Object detector post processing : includes output detector remapping,
  *        nms and score filtering for YoloV8 with 8-bits quantized inputs.
+ *        The output buffer needs AI_OD_YOLOV8_PP_INT8_OUT_RECORDS records.
  *
  * @param [IN] Pointer on input data
  *             Pointer on output data
@@ -79,7 +97,7 @@ int32_t od_yolov8_pp_process(yolov8_pp_in_centroid_t *pInput,
  */
 int32_t od_yolov8_pp_process_int8(yolov8_pp_in_centroid_int8_t *pInput,
                                          od_pp_out_t *pOutput,
-                                         yolov8_pp_static_param_t *pInput_static_param);
+                                         const yolov8_pp_static_param_t *pInput_static_param);
 
 #ifdef __cplusplus
   }
@@ -41,6 +41,7 @@ typedef struct pd_model_static_param {
   uint32_t nb_total_boxes;
   uint32_t max_boxes_limit;
   pd_pp_point_t *pAnchors;
+  float32_t conf_threshold_logit;   /* set by pd_model_pp_reset from conf_threshold */
 } pd_model_pp_static_param_t;
 
 
@@ -48,7 +49,7 @@ int32_t pd_model_pp_reset(pd_model_pp_static_param_t *pInput_static_param);
 
 int32_t pd_model_pp_process(pd_model_pp_in_t *pInput,
                         pd_postprocess_out_t *pOutput,
-                        pd_model_pp_static_param_t *pInput_static_param);
+                        const pd_model_pp_static_param_t *pInput_static_param);
 
 
 #ifdef __cplusplus
@@ -29,16 +29,20 @@ typedef struct spe_movenet_pp_in
 	float32_t *inBuff;
 } spe_movenet_pp_in_t;
 
+typedef struct spe_movenet_pp_in_int8
+{
+	int8_t *inBuff;
+} spe_movenet_pp_in_int8_t;
+
 
 
 typedef struct spe_movenet_pp_static_param {
-#ifdef _OLD_IMPL
-  float32_t *pTmpHeatMap;   /* Must be an array of size
-                               AI_SPE_MOVENET_PP_HEATMAP_WIDTH * AI_SPE_MOVENET_PP_HEATMAP_HEIGHT */
-#endif
   uint32_t  heatmap_width;
   uint32_t  heatmap_height;
   uint32_t  nb_keypoints;
+  uint32_t  subpixel_refine;        /* 1: peaks refined by a quadratic fit on their neighbours */
+  float32_t raw_output_scale;       /* int8 heat maps only */
+  int8_t    raw_output_zero_point;  /* int8 heat maps only */
 } spe_movenet_pp_static_param_t;
 
 
@@ -64,7 +68,20 @@ int32_t spe_movenet_pp_reset(spe_movenet_pp_static_param_t *pInput_static_param)
  */
 int32_t spe_movenet_pp_process(spe_movenet_pp_in_t *pInput,
                                spe_pp_out_t     *pOutput,
-                               spe_movenet_pp_static_param_t *pInput_static_param);
+                               const spe_movenet_pp_static_param_t *pInput_static_param);
+
+
+/*!
+ * @brief Movenet post processing for int8 heat maps
+ *
+ * @param [IN] Pointer on input data
+ *             Pointer on output data
+ *             pointer on static parameters
+ * @retval Error code
+ */
+int32_t spe_movenet_pp_process_int8(spe_movenet_pp_in_int8_t *pInput,
+                                    spe_pp_out_t     *pOutput,
+                                    const spe_movenet_pp_static_param_t *pInput_static_param);
 
 
 #ifdef __cplusplus
@@ -24,11 +24,27 @@ typedef enum {
 } e_sseg_data_type;
 
 
+/* Output map: class indexes (uint8, uint16 from 256 classes), or display pixels looked up
+ * in color_map, for instance to be written directly in an overlay layer */
+typedef enum {
+  AI_SSEG_OUT_INDEX = 0,
+  AI_SSEG_OUT_RGB565,
+  AI_SSEG_OUT_ARGB4444
+} e_sseg_out_format;
+
+#define AI_SSEG_DEEPLABV3_PP_MAX_COLORS    (256)
+
 typedef struct {
   size_t width;
   size_t height;
   uint32_t nb_classes;
   e_sseg_data_type type;
+  e_sseg_out_format out_format;
+  const uint32_t *color_map;   /* nb_classes ARGB8888 colors, for the pixels output formats */
+  uint32_t out_step;           /* 0 or 1: every pixel, n: one pixel out of n in both directions */
+  size_t out_width;            /* set by sseg_deeplabv3_pp_reset: output map size */
+  size_t out_height;
+  uint16_t palette[AI_SSEG_DEEPLABV3_PP_MAX_COLORS];   /* set by sseg_deeplabv3_pp_reset from color_map */
 } sseg_deeplabv3_pp_static_param_t;
 
 
@@ -43,7 +59,16 @@ int32_t sseg_deeplabv3_pp_reset(sseg_deeplabv3_pp_static_param_t *pInput_static_
 
 int32_t sseg_deeplabv3_pp_process(sseg_deeplabv3_pp_in_t *pInput,
                                       sseg_pp_out_t *pOutput,
-                                      sseg_deeplabv3_pp_static_param_t *pInput_static_param);
+                                      const sseg_deeplabv3_pp_static_param_t *pInput_static_param);
+
+/* Same as sseg_deeplabv3_pp_process on the model output rows [first_row, first_row + nb_rows[ only,
+ * to post-process the output by tiles of rows. pRawData is the start of the whole model output.
+ * The class histogram and extents are cleared when first_row is 0. */
+int32_t sseg_deeplabv3_pp_process_rows(sseg_deeplabv3_pp_in_t *pInput,
+                                       sseg_pp_out_t *pOutput,
+                                       const sseg_deeplabv3_pp_static_param_t *pInput_static_param,
+                                       uint32_t first_row,
+                                       uint32_t nb_rows);
 
 #ifdef __cplusplus
   }
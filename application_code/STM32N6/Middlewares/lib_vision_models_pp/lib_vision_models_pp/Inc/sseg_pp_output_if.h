@@ -24,9 +24,20 @@
 #define AI_SSEG_POSTPROCESS_ERROR                       (-2)
 
 
+/* Bounding extent of the pixels of a class, in pixels of the output map */
+typedef struct
+{
+  uint16_t x_min;
+  uint16_t y_min;
+  uint16_t x_max;
+  uint16_t y_max;
+} sseg_pp_extent_t;
+
 typedef struct
 {
   uint8_t *pOutBuff;
+  uint32_t *pClass_hist;              /* optional (or NULL): nb_classes pixels counts */
+  sseg_pp_extent_t *pClass_extents;   /* optional (or NULL): nb_classes extents, valid if the count is not 0 */
 } sseg_pp_out_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,32 @@
+/*---------------------------------------------------------------------------------------------
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file in
+ * the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *--------------------------------------------------------------------------------------------*/
+
+#ifndef __VISION_MODELS_NMS_IF_H__
+#define __VISION_MODELS_NMS_IF_H__
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+/* NMS modes, selected through the nms_mode field of the static parameters */
+/* ----------------------------------------------------------------------- */
+typedef enum vision_models_nms_mode {
+  AI_VISION_MODELS_NMS_MODE_EXHAUSTIVE = 0,  /* each kept box against all the lower confidence ones */
+  AI_VISION_MODELS_NMS_MODE_GRID             /* same results, candidates taken from a uniform grid,
+                                                for dense outputs with many boxes per class */
+} vision_models_nms_mode_e;
+
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif      /* __VISION_MODELS_NMS_IF_H__  */
@@ -0,0 +1,38 @@
+/*---------------------------------------------------------------------------------------------
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file in
+ * the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *--------------------------------------------------------------------------------------------*/
+
+#ifndef __VISION_MODELS_PP_CTX_IF_H__
+#define __VISION_MODELS_PP_CTX_IF_H__
+
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+/* Post-processing context */
+/* ----------------------- */
+/* Static parameters are only read by the *_pp_process functions: one set of parameters can be
+ * shared by several post-processing instances. The per-call temporaries of a post-processing
+ * that needs some live in a scratch arena owned by the caller, one per concurrent call, sized
+ * by the post-processing *_get_scratch_size function (or its compile-time size macro).
+ * The arena must be pointer aligned; its content does not need to be kept between calls. */
+typedef struct vision_models_pp_ctx {
+  void *pScratch;
+  uint32_t scratch_size;  /* in bytes */
+} vision_models_pp_ctx_t;
+
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif      /* __VISION_MODELS_PP_CTX_IF_H__  */
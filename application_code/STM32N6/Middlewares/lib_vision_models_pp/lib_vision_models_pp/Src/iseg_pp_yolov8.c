@@ -11,194 +11,194 @@
 #include "vision_models_pp.h"
 #include "iseg_pp_loc.h"
 
-/* Can't be removed if qsort is not re-written... */
-static int32_t AI_YOLOV8_SEG_PP_SORT_CLASS;
-
-static int32_t iseg_yolov8_nms_comparator_s8(const void *pa, const void *pb)
+/* Per-call temporaries in the scratch arena of the context */
+typedef struct
 {
-    iseg_postprocess_scratchBuffer_s8_t a = *(iseg_postprocess_scratchBuffer_s8_t *)pa;
-    iseg_postprocess_scratchBuffer_s8_t b = *(iseg_postprocess_scratchBuffer_s8_t *)pb;
+  iseg_postprocess_scratchBuffer_s8_t *pDetections;  /* nb_total_boxes records */
+  int32_t *pDetection_mask;                          /* nb_masks */
+  int8_t *pCoefs;                                    /* nb_total_boxes * nb_masks */
+} iseg_yolov8_pp_scratch_t;
 
-    int16_t diff = 0;
-    int8_t a_weighted_conf = -128;
-    int8_t b_weighted_conf = -128;
+static
+int32_t iseg_yolov8_pp_getScratch(const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                  vision_models_pp_ctx_t *pCtx,
+                                  iseg_yolov8_pp_scratch_t *pScratch)
+{
+  if ((pCtx == NULL) || (pCtx->pScratch == NULL) ||
+      (pCtx->scratch_size < iseg_yolov8_pp_get_scratch_size(pInput_static_param)))
+  {
+    return (AI_ISEG_POSTPROCESS_ERROR);
+  }
+  pScratch->pDetections = (iseg_postprocess_scratchBuffer_s8_t *)pCtx->pScratch;
+  pScratch->pDetection_mask = (int32_t *)&pScratch->pDetections[pInput_static_param->nb_total_boxes];
+  pScratch->pCoefs = (int8_t *)&pScratch->pDetection_mask[pInput_static_param->nb_masks];
 
-    if (a.class_index == AI_YOLOV8_SEG_PP_SORT_CLASS)
-    {
-        a_weighted_conf = a.conf;
-    }
+  return (AI_ISEG_POSTPROCESS_ERROR_NO);
+}
 
-    if (b.class_index == AI_YOLOV8_SEG_PP_SORT_CLASS)
-    {
-        b_weighted_conf = b.conf;
-    }
+static
+int32_t iseg_yolov8_pp_nmsFiltering_centroid_is8os8(iseg_postprocess_out_t *pOutput,
+                                                    const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                                    iseg_yolov8_pp_scratch_t *pScratch)
+{
+    vision_models_nms_is8(pScratch->pDetections,
+                          sizeof(iseg_postprocess_scratchBuffer_s8_t),
+                          pOutput->nb_detect,
+                          pInput_static_param->iou_threshold,
+                          pInput_static_param->max_boxes_limit,
+                          pInput_static_param->raw_output_zero_point,
+                          0.0f,   /* integer IoU */
+                          pInput_static_param->nms_mode);
 
-    diff = (int16_t)a_weighted_conf - (int16_t)b_weighted_conf;
+    return (AI_ISEG_POSTPROCESS_ERROR_NO);
+}
+/* Mask grid bound of a normalized box edge: pixel c belongs to the box when
+ * edge_min <= c < edge_max in mask coordinates */
+static inline int32_t iseg_yolov8_pp_maskBound(float32_t edge, int32_t size_masks)
+{
+  float32_t v = edge * (float32_t)size_masks;
 
-    if (diff < 0) return 1;
-    else if (diff > 0) return -1;
-    return 0;
+  v = MAX(MIN(v, (float32_t)size_masks), 0.0f);
+  return (int32_t)ceilf(v);
 }
 
+/* Decodes the binary mask of one detection from its int8 coefficients, on the whole mask
+ * grid, or in the BOX modes only inside the box (clipped to the mask grid), the other
+ * pixels being cleared */
 static
-int32_t iseg_yolov8_pp_nmsFiltering_centroid_is8os8(yolov8_seg_pp_static_param_t *pInput_static_param)
+void iseg_yolov8_pp_decodeMask_is8(int8_t *pRaw_masks,
+                                   int8_t *pCoefs,
+                                   int32_t *detection_mask,
+                                   iseg_postprocess_outBuffer_t *pDetection,
+                                   const yolov8_seg_pp_static_param_t *pInput_static_param)
 {
-  int32_t j, k, limit_counter, detections_per_class;//, limit_type;
-  iseg_postprocess_scratchBuffer_s8_t *pOutBuff_s8 = pInput_static_param->pTmpBuff;
+  int32_t nb_masks = pInput_static_param->nb_masks;
+  int32_t size_masks = pInput_static_param->size_masks;
+  int8_t mask_zp = pInput_static_param->mask_raw_output_zero_point;
+  int8_t raw_zp = pInput_static_param->raw_output_zero_point;
+  float32_t threshold_check = 0.5 / (pInput_static_param->mask_raw_output_scale * pInput_static_param->raw_output_scale);
+  int32_t threshold_check_s32 = (int32_t)(threshold_check+0.5f);
+  int32_t x0 = 0;
+  int32_t x1 = size_masks;
+  int32_t y0 = 0;
+  int32_t y1 = size_masks;
+#ifdef ARM_MATH_MVEF
+  uint32x4_t offset = vidupq_n_u32(0,1);
+  offset *= (uint32_t)nb_masks;
+#endif
+
+  if ((pInput_static_param->mask_mode == AI_ISEG_YOLOV8_PP_MASK_BOX) ||
+      (pInput_static_param->mask_mode == AI_ISEG_YOLOV8_PP_MASK_LAZY_BOX))
+  {
+    x0 = iseg_yolov8_pp_maskBound(pDetection->x_center - pDetection->width * 0.5f, size_masks);
+    x1 = iseg_yolov8_pp_maskBound(pDetection->x_center + pDetection->width * 0.5f, size_masks);
+    y0 = iseg_yolov8_pp_maskBound(pDetection->y_center - pDetection->height * 0.5f, size_masks);
+    y1 = iseg_yolov8_pp_maskBound(pDetection->y_center + pDetection->height * 0.5f, size_masks);
+    memset(pDetection->pMask, 0, size_masks * size_masks);
+  }
 
-    for (k = 0; k < pInput_static_param->nb_classes; ++k)
+  for (int32_t k = 0; k < nb_masks ; k++)
+  {
+    detection_mask[k] = ((int32_t)pCoefs[k] - raw_zp);
+  }
+
+  // Perform matrix multiplication on the box rows
+  for (int32_t i = y0; i < y1; i++)
+  {
+    int8_t *Raw_masks = &pRaw_masks[(i * size_masks + x0) * nb_masks];//(64x64x32)
+    uint8_t *binary_mask = &pDetection->pMask[i * size_masks + x0];
+#ifdef ARM_MATH_MVEF
+    int32_t iter_loop = (x1 - x0) >> 2;
+    while(iter_loop--)
     {
-        limit_counter = 0;
-        detections_per_class = 0;
-        AI_YOLOV8_SEG_PP_SORT_CLASS = k;
+      // Read for 4 ouputs
+      int32x4_t sum_product_s32x4 = vdupq_n_s32(0);
 
+      for (int32_t k = 0; k < nb_masks ; k++)
+      {
+        // Load 4 int8_t in int32x4_t register
+        int32x4_t rawMask = vldrbq_gather_offset_s32(Raw_masks, offset);
+        sum_product_s32x4 += detection_mask[k] * (rawMask - (int32_t)mask_zp);
 
-        /* Counts the number of detections with class k */
-        for (int32_t i = 0; i < pInput_static_param->nb_detect ; i ++)
-        {
-            if(pOutBuff_s8[i].class_index == k)
-            {
-                detections_per_class++;
-            }
-        }
+        Raw_masks++;
+      }
+      // Compare and store 4 results
+      mve_pred16_t p0 = vcmpgeq_n_s32(sum_product_s32x4, threshold_check_s32);
+      uint32x4_t outBinary = vpselq_u32(vdupq_n_u32(1), vdupq_n_u32(0), p0);
+      vstrbq_u32(binary_mask, outBinary);
 
-        if (detections_per_class > 0)
-        {
-            /* Sorts detections based on class k */
-            qsort(pOutBuff_s8,
-                  pInput_static_param->nb_detect,
-                  sizeof(iseg_postprocess_scratchBuffer_s8_t),
-                  iseg_yolov8_nms_comparator_s8);
-
-            for (int32_t i = 0; i < detections_per_class ; i ++)
-            {
-                if (pOutBuff_s8[i].conf == -128) continue;
-                int8_t *a = &pOutBuff_s8[i].x_center;
-                for (j = i + 1; j < detections_per_class; j ++)
-                {
-                    int8_t * b = &pOutBuff_s8[j].x_center;
-                    float32_t f_iou = vision_models_box_iou_is8(a, b, pInput_static_param->raw_output_zero_point);
-                    if (f_iou > pInput_static_param->iou_threshold)
-                    {
-                        pOutBuff_s8[j].conf = -128;
-                    }
-                }
-            }
-
-            /* Limits detections count */
-            for (int32_t i = 0; i < detections_per_class; i++)
-            {
-                if ((limit_counter < pInput_static_param->max_boxes_limit) &&
-                    (pOutBuff_s8[i].conf != -128))
-                {
-                    limit_counter++;
-                }
-                else
-                {
-                    pOutBuff_s8[i].conf = -128;
-                }
-            }
-        }
+      binary_mask+=4;
+      Raw_masks+=3*nb_masks;
     }
+    // Remaining
+    iter_loop = (x1 - x0) & 3;
+    while(iter_loop--)
+    {
+      int32_t sum_product = 0;
+      for (int32_t k = 0; k < nb_masks; k++)
+      {
+        sum_product += detection_mask[k] * ((int32_t)(*Raw_masks) - (int32_t)mask_zp);
 
-    return (AI_ISEG_POSTPROCESS_ERROR_NO);
+        Raw_masks++;
+      }
+      *binary_mask++ = (sum_product >= threshold_check_s32)?1:0;
+    }
+#else
+    for (int32_t j = x0; j < x1; j++)
+    {
+      int32_t sum_product = 0;
+      for (int32_t k = 0; k < nb_masks ; k++)
+      {
+        sum_product += detection_mask[k] * ((int32_t)(*Raw_masks) - (int32_t)mask_zp);
+
+        Raw_masks++;
+      }
+      *binary_mask++ = (sum_product >= threshold_check_s32)?1:0;
+    }
+#endif
+  }
 }
+
 static
 int32_t iseg_yolov8_pp_scoreFiltering_centroid_is8(yolov8_seg_pp_in_centroid_int8_t *pInput,
                                                    iseg_postprocess_out_t *pOutput,
-                                                   yolov8_seg_pp_static_param_t *pInput_static_param)
+                                                   const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                                   iseg_yolov8_pp_scratch_t *pScratch)
 {
   int32_t det_count = 0;
-  iseg_postprocess_scratchBuffer_s8_t *pOutBuff_s8 = pInput_static_param->pTmpBuff;
-  //int32_t  mask_length = 0;
-  //mask_length = pInput_static_param->size_masks * pInput_static_param->size_masks;
-  pOutput->nb_detect = MIN(pInput_static_param->nb_detect, pInput_static_param->max_boxes_limit);
-
-  // get masks
-  int8_t mask_zp = pInput_static_param->mask_raw_output_zero_point;
-  float32_t mask_scale = pInput_static_param->mask_raw_output_scale;
+  iseg_postprocess_scratchBuffer_s8_t *pOutBuff_s8 = pScratch->pDetections;
   int8_t raw_zp = pInput_static_param->raw_output_zero_point;
   float32_t raw_scale = pInput_static_param->raw_output_scale;
-  int8_t threshold_s8 = (int8_t)(pInput_static_param->conf_threshold / raw_scale + 0.5 + raw_zp);
-  float32_t threshold_check = 0.5 / (mask_scale * raw_scale);
-  int32_t threshold_check_s32 = (int32_t)(threshold_check+0.5f);
-#ifdef ARM_MATH_MVEF
-  uint32x4_t offset = vidupq_n_u32(0,1);
-  offset *= (uint32_t)pInput_static_param->nb_masks;
-#endif
+  int32_t threshold_s8 = pInput_static_param->conf_threshold_s8;
 
-  for (int32_t d = 0; d < pInput_static_param->nb_detect; d++)
+  for (int32_t d = 0; d < pOutput->nb_detect; d++)
     {
       if (pOutBuff_s8[d].conf >= threshold_s8 && det_count<pInput_static_param->max_boxes_limit) {
 
-        int32_t *detection_mask = (int32_t *)pInput_static_param->pMask;
-        uint8_t *binary_mask = pOutput->pOutBuff[det_count].pMask;
-        int8_t *Raw_masks = pInput->pRaw_masks;//(64x64x32)
-
-        pOutput->pOutBuff[det_count].x_center    = ((int32_t)pOutBuff_s8[d].x_center - raw_zp) * raw_scale;
-        pOutput->pOutBuff[det_count].y_center    = ((int32_t)pOutBuff_s8[d].y_center - raw_zp) * raw_scale;
-        pOutput->pOutBuff[det_count].width       = ((int32_t)pOutBuff_s8[d].width    - raw_zp) * raw_scale;
-        pOutput->pOutBuff[det_count].height      = ((int32_t)pOutBuff_s8[d].height   - raw_zp) * raw_scale;
-        pOutput->pOutBuff[det_count].conf        = ((int32_t)pOutBuff_s8[d].conf     - raw_zp) * raw_scale;
-        pOutput->pOutBuff[det_count].class_index =  (int32_t)pOutBuff_s8[d].class_index;
-
-        for (int32_t k = 0; k < pInput_static_param->nb_masks ; k++)
+        /* Detection i keeps its coefficients in scratch record i. Records are swapped,
+         * not copied, so that each one keeps its own coefficient buffer */
+        if (d != det_count)
         {
-          detection_mask[k] = ((int32_t)pOutBuff_s8[d].pMask[k] - raw_zp);
+          iseg_postprocess_scratchBuffer_s8_t tmp = pOutBuff_s8[det_count];
+          pOutBuff_s8[det_count] = pOutBuff_s8[d];
+          pOutBuff_s8[d] = tmp;
         }
-        // Perform matrix multiplication
 
-        for (int32_t i = 0; i < pInput_static_param->size_masks; i++)
+        pOutput->pOutBuff[det_count].x_center    = ((int32_t)pOutBuff_s8[det_count].x_center - raw_zp) * raw_scale;
+        pOutput->pOutBuff[det_count].y_center    = ((int32_t)pOutBuff_s8[det_count].y_center - raw_zp) * raw_scale;
+        pOutput->pOutBuff[det_count].width       = ((int32_t)pOutBuff_s8[det_count].width    - raw_zp) * raw_scale;
+        pOutput->pOutBuff[det_count].height      = ((int32_t)pOutBuff_s8[det_count].height   - raw_zp) * raw_scale;
+        pOutput->pOutBuff[det_count].conf        = ((int32_t)pOutBuff_s8[det_count].conf     - raw_zp) * raw_scale;
+        pOutput->pOutBuff[det_count].class_index =  (int32_t)pOutBuff_s8[det_count].class_index;
+
+        if ((pInput_static_param->mask_mode == AI_ISEG_YOLOV8_PP_MASK_FULL) ||
+            (pInput_static_param->mask_mode == AI_ISEG_YOLOV8_PP_MASK_BOX))
         {
-#ifdef ARM_MATH_MVEF
-            int32_t iter_loop = pInput_static_param->size_masks >> 2;
-            while(iter_loop--)
-            {
-              // Read for 4 ouputs
-                int32x4_t sum_product_s32x4 = vdupq_n_s32(0);
-
-                for (int32_t k = 0; k < pInput_static_param->nb_masks ; k++)
-                {
-                  // Load 4 int8_t in int32x4_t register
-                  int32x4_t rawMask = vldrbq_gather_offset_s32(Raw_masks, offset);
-                  sum_product_s32x4 += detection_mask[k] * (rawMask - (int32_t)mask_zp);
-
-                  Raw_masks++;
-                }
-                // Compare and store 4 results
-                mve_pred16_t p0 = vcmpgeq_n_s32(sum_product_s32x4, threshold_check_s32);
-                uint32x4_t outBinary = vpselq_u32(vdupq_n_u32(1), vdupq_n_u32(0), p0);
-                vstrbq_u32(binary_mask, outBinary);
-
-                binary_mask+=4;
-                Raw_masks+=3*pInput_static_param->nb_masks;
-            }
-            // Remaining
-            iter_loop = pInput_static_param->size_masks & 3;
-            while(iter_loop--)
-            {
-                int32_t sum_product = 0;
-                for (int32_t k = 0; k < pInput_static_param->nb_masks; k++)
-                {
-                  sum_product += detection_mask[k] * ((int32_t)(*Raw_masks) - (int32_t)mask_zp);
-
-                  Raw_masks++;
-                }
-                *binary_mask++ = (sum_product >= threshold_check_s32)?1:0;
-            }
-#else
-            for (int32_t j = 0; j < pInput_static_param->size_masks; j++)
-            {
-                int32_t sum_product = 0;
-                for (int32_t k = 0; k < pInput_static_param->nb_masks ; k++)
-                {
-                  sum_product += detection_mask[k] * ((int32_t)(*Raw_masks) - (int32_t)mask_zp);
-
-                  Raw_masks++;
-                }
-                *binary_mask++ = (sum_product >= threshold_check_s32)?1:0;
-            }
-#endif
+          iseg_yolov8_pp_decodeMask_is8(pInput->pRaw_masks,
+                                        pOutBuff_s8[det_count].pMask,
+                                        pScratch->pDetection_mask,
+                                        &pOutput->pOutBuff[det_count],
+                                        pInput_static_param);
         }
         det_count++;
       }
@@ -211,20 +211,21 @@ int32_t iseg_yolov8_pp_scoreFiltering_centroid_is8(yolov8_seg_pp_in_centroid_int
 
 static
 int32_t iseg_yolov8_pp_getNNBoxes_centroid_is8os8(yolov8_seg_pp_in_centroid_int8_t *pInput,
-                                                  yolov8_seg_pp_static_param_t *pInput_static_param)
+                                                  iseg_postprocess_out_t *pOutput,
+                                                  const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                                  iseg_yolov8_pp_scratch_t *pScratch)
 {
   int32_t error   = AI_ISEG_POSTPROCESS_ERROR_NO;
   //int8_t best_score = 0;
   //uint8_t class_index = 0;
-  iseg_postprocess_scratchBuffer_s8_t *pOutBuff_s8 = pInput_static_param->pTmpBuff;
+  iseg_postprocess_scratchBuffer_s8_t *pOutBuff_s8 = pScratch->pDetections;
+  int8_t *pCoefs = pScratch->pCoefs;
   int32_t nb_classes = pInput_static_param->nb_classes;
   int32_t nb_total_boxes = pInput_static_param->nb_total_boxes;
   int8_t *pRaw_detections = (int8_t *)pInput->pRaw_detections;
-  int8_t zero_point = pInput_static_param->raw_output_zero_point;
-  float32_t scale = pInput_static_param->raw_output_scale;
-  int8_t threshold_s8 = (int8_t)(pInput_static_param->conf_threshold / scale + 0.5 + zero_point);
+  int32_t threshold_s8 = pInput_static_param->conf_threshold_s8;
 
-  pInput_static_param->nb_detect = 0;
+  pOutput->nb_detect = 0;
   int32_t loop_cnt = nb_total_boxes;
 
   while (loop_cnt > 0)
@@ -249,11 +250,13 @@ int32_t iseg_yolov8_pp_getNNBoxes_centroid_is8os8(yolov8_seg_pp_in_centroid_int8
         pOutBuff_s8->height      = pRaw_detections[AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
         pOutBuff_s8->conf        = best_score[_i];
         pOutBuff_s8->class_index = class_index[_i];
+        pOutBuff_s8->pMask       = pCoefs;
         for (int32_t j = 0; j < pInput_static_param->nb_masks; j++)
         {
           pOutBuff_s8->pMask[j] =  pRaw_detections[(AI_YOLOV8_PP_CLASSPROB + nb_classes + j) * nb_total_boxes];
         }
-        pInput_static_param->nb_detect++;
+        pCoefs += pInput_static_param->nb_masks;
+        pOutput->nb_detect++;
         pOutBuff_s8++;
       }
       pRaw_detections++;
@@ -270,26 +273,45 @@ int32_t iseg_yolov8_pp_getNNBoxes_centroid_is8os8(yolov8_seg_pp_in_centroid_int8
 int32_t iseg_yolov8_pp_reset(yolov8_seg_pp_static_param_t *pInput_static_param)
 {
     /* Initializations */
-    pInput_static_param->nb_detect = 0;
+    pInput_static_param->conf_threshold_s8 =
+        vision_models_quantize_threshold_is8(pInput_static_param->conf_threshold,
+                                             pInput_static_param->raw_output_scale,
+                                             pInput_static_param->raw_output_zero_point);
 
     return (AI_ISEG_POSTPROCESS_ERROR_NO);
 }
 
+uint32_t iseg_yolov8_pp_get_scratch_size(const yolov8_seg_pp_static_param_t *pInput_static_param)
+{
+    return (uint32_t)AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(pInput_static_param->nb_total_boxes,
+                                                    pInput_static_param->nb_masks);
+}
+
 int32_t iseg_yolov8_pp_process(yolov8_seg_pp_in_centroid_int8_t *pInput,
                               iseg_postprocess_out_t *pOutput,
-                              yolov8_seg_pp_static_param_t *pInput_static_param)
+                              const yolov8_seg_pp_static_param_t *pInput_static_param,
+                              vision_models_pp_ctx_t *pCtx)
 {
     int32_t error   = AI_ISEG_POSTPROCESS_ERROR_NO;
+    iseg_yolov8_pp_scratch_t scratch;
+
+    pOutput->nb_detect = 0;
+    error = iseg_yolov8_pp_getScratch(pInput_static_param, pCtx, &scratch);
+    if (error != AI_ISEG_POSTPROCESS_ERROR_NO) return (error);
 
     /* Call Get NN boxes first */
     error = iseg_yolov8_pp_getNNBoxes_centroid_is8os8(pInput,
-                                                      pInput_static_param);
+                                                      pOutput,
+                                                      pInput_static_param,
+                                                      &scratch);
 
 
     if (error != AI_ISEG_POSTPROCESS_ERROR_NO) return (error);
 
     /* Then NMS */
-    error = iseg_yolov8_pp_nmsFiltering_centroid_is8os8(pInput_static_param);
+    error = iseg_yolov8_pp_nmsFiltering_centroid_is8os8(pOutput,
+                                                        pInput_static_param,
+                                                        &scratch);
 
 
     if (error != AI_ISEG_POSTPROCESS_ERROR_NO) return (error);
@@ -297,8 +319,32 @@ int32_t iseg_yolov8_pp_process(yolov8_seg_pp_in_centroid_int8_t *pInput,
     /* And score re-filtering */
    error = iseg_yolov8_pp_scoreFiltering_centroid_is8(pInput,
                                                       pOutput,
-                                                      pInput_static_param);
+                                                      pInput_static_param,
+                                                      &scratch);
     return (error);
 }
 
 
+
+int32_t iseg_yolov8_pp_decode_mask(yolov8_seg_pp_in_centroid_int8_t *pInput,
+                                   iseg_postprocess_out_t *pOutput,
+                                   const yolov8_seg_pp_static_param_t *pInput_static_param,
+                                   vision_models_pp_ctx_t *pCtx,
+                                   int32_t detection_index)
+{
+    iseg_yolov8_pp_scratch_t scratch;
+
+    if ((detection_index < 0) || (detection_index >= pOutput->nb_detect) ||
+        (iseg_yolov8_pp_getScratch(pInput_static_param, pCtx, &scratch) != AI_ISEG_POSTPROCESS_ERROR_NO))
+    {
+        return (AI_ISEG_POSTPROCESS_ERROR);
+    }
+
+    iseg_yolov8_pp_decodeMask_is8(pInput->pRaw_masks,
+                                  scratch.pDetections[detection_index].pMask,
+                                  scratch.pDetection_mask,
+                                  &pOutput->pOutBuff[detection_index],
+                                  pInput_static_param);
+
+    return (AI_ISEG_POSTPROCESS_ERROR_NO);
+}
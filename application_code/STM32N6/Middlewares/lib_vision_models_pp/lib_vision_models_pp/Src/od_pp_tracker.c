@@ -0,0 +1,377 @@
+/*---------------------------------------------------------------------------------------------
+ * Copyright (c) 2026 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file in
+ * the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *--------------------------------------------------------------------------------------------*/
+
+#include "od_tracker_pp_if.h"
+#include "vision_models_pp.h"
+
+
+#define AI_OD_TRACKER_PP_NONE       (-1)
+#define AI_OD_TRACKER_PP_DUPLICATE  (-2)
+
+
+/* Affinity of a detection to a track extrapolated to its frame:
+ * IoU when it reaches iou_threshold, otherwise a value below iou_threshold decreasing with
+ * the center distance (in box sizes) up to dist_threshold for each frame the track was
+ * extrapolated, 0 when they cannot be associated */
+static float32_t od_tracker_pp_affinity(od_tracker_pp_track_t *pTrack,
+                                        od_pp_outBuffer_t *pDet,
+                                        od_tracker_pp_static_param_t *pInput_static_param)
+{
+  if (pTrack->class_index != pDet->class_index)
+  {
+    return 0;
+  }
+
+  float32_t iou = vision_models_box_iou(&pTrack->x_center, &pDet->x_center);
+  if (iou >= pInput_static_param->iou_threshold)
+  {
+    return iou;
+  }
+
+  float32_t dist_threshold = pInput_static_param->dist_threshold * (float32_t) pTrack->nb_frames;
+  if (dist_threshold <= 0)
+  {
+    return 0;
+  }
+
+  float32_t dx = (pDet->x_center - pTrack->x_center) / ((pDet->width + pTrack->width) / 2);
+  float32_t dy = (pDet->y_center - pTrack->y_center) / ((pDet->height + pTrack->height) / 2);
+  float32_t dist2 = dx * dx + dy * dy;
+  if (dist2 >= dist_threshold * dist_threshold)
+  {
+    return 0;
+  }
+
+  float32_t dist;
+  arm_sqrt_f32(dist2, &dist);
+
+  return pInput_static_param->iou_threshold * (1 - dist / dist_threshold);
+}
+
+
+/* Pairs of highest affinity first */
+static void od_tracker_pp_assoc_greedy(int32_t nb_dets, od_tracker_pp_static_param_t *pInput_static_param)
+{
+  float32_t (*affinity)[AI_OD_TRACKER_PP_MAX_TRACKS] = pInput_static_param->affinity;
+  int32_t nb_tracks = pInput_static_param->nb_tracks;
+
+  while (1)
+  {
+    float32_t best_affinity = 0;
+    int32_t best_track = AI_OD_TRACKER_PP_NONE;
+    int32_t best_det = AI_OD_TRACKER_PP_NONE;
+
+    for (int32_t t = 0; t < nb_tracks; t++)
+    {
+      if (pInput_static_param->track_det[t] != AI_OD_TRACKER_PP_NONE)
+      {
+        continue;
+      }
+      for (int32_t d = 0; d < nb_dets; d++)
+      {
+        if ((affinity[t][d] > best_affinity) && (pInput_static_param->det_track[d] == AI_OD_TRACKER_PP_NONE))
+        {
+          best_affinity = affinity[t][d];
+          best_track = t;
+          best_det = d;
+        }
+      }
+    }
+
+    if (best_track == AI_OD_TRACKER_PP_NONE)
+    {
+      break;
+    }
+    pInput_static_param->det_track[best_det] = best_track;
+    pInput_static_param->track_det[best_track] = best_det;
+  }
+}
+
+
+/* Assignment maximizing the sum of the affinities: Hungarian method on the square cost
+ * matrix 1 - affinity, pairs that cannot be associated cost as much as leaving both alone */
+static void od_tracker_pp_assoc_optimal(int32_t nb_dets, od_tracker_pp_static_param_t *pInput_static_param)
+{
+  float32_t (*affinity)[AI_OD_TRACKER_PP_MAX_TRACKS] = pInput_static_param->affinity;
+  int32_t nb_tracks = pInput_static_param->nb_tracks;
+  int32_t n = MAX(nb_tracks, nb_dets);
+  /* 1-based, row 0 / column 0 are the virtual start of the augmenting paths */
+  float32_t u[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+  float32_t v[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+  float32_t minv[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+  int32_t row_of[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+  int32_t way[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+  uint8_t used[AI_OD_TRACKER_PP_OPTIMAL_MAX + 1];
+
+  for (int32_t j = 0; j <= n; j++)
+  {
+    u[j] = 0;
+    v[j] = 0;
+    row_of[j] = 0;
+  }
+
+  for (int32_t i = 1; i <= n; i++)
+  {
+    int32_t j0 = 0;
+
+    row_of[0] = i;
+    for (int32_t j = 0; j <= n; j++)
+    {
+      minv[j] = 3.0e38f;
+      used[j] = 0;
+    }
+    do
+    {
+      int32_t i0 = row_of[j0];
+      int32_t j1 = 0;
+      float32_t delta = 3.0e38f;
+
+      used[j0] = 1;
+      for (int32_t j = 1; j <= n; j++)
+      {
+        if (!used[j])
+        {
+          float32_t cost = ((i0 <= nb_tracks) && (j <= nb_dets)) ? 1 - affinity[i0 - 1][j - 1] : 1;
+          float32_t cur = cost - u[i0] - v[j];
+          if (cur < minv[j])
+          {
+            minv[j] = cur;
+            way[j] = j0;
+          }
+          if (minv[j] < delta)
+          {
+            delta = minv[j];
+            j1 = j;
+          }
+        }
+      }
+      for (int32_t j = 0; j <= n; j++)
+      {
+        if (used[j])
+        {
+          u[row_of[j]] += delta;
+          v[j] -= delta;
+        }
+        else
+        {
+          minv[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (row_of[j0] != 0);
+    do
+    {
+      int32_t j1 = way[j0];
+      row_of[j0] = row_of[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+
+  for (int32_t j = 1; j <= n; j++)
+  {
+    int32_t t = row_of[j] - 1;
+    int32_t d = j - 1;
+
+    if ((t < nb_tracks) && (d < nb_dets) && (affinity[t][d] > 0))
+    {
+      pInput_static_param->det_track[d] = t;
+      pInput_static_param->track_det[t] = d;
+    }
+  }
+}
+
+
+static void od_tracker_pp_step(od_tracker_pp_static_param_t *pInput_static_param)
+{
+  for (int32_t t = 0; t < pInput_static_param->nb_tracks; t++)
+  {
+    od_tracker_pp_track_t *pTrack = &pInput_static_param->tracks[t];
+
+    pTrack->x_center += pTrack->vx;
+    pTrack->y_center += pTrack->vy;
+    pTrack->nb_frames++;
+  }
+}
+
+
+static void od_tracker_pp_output(od_tracker_pp_out_t *pOutput,
+                                 od_tracker_pp_static_param_t *pInput_static_param)
+{
+  int32_t nb_out = 0;
+
+  for (int32_t t = 0; t < pInput_static_param->nb_tracks; t++)
+  {
+    od_tracker_pp_track_t *pTrack = &pInput_static_param->tracks[t];
+
+    if (pTrack->nb_hits >= pInput_static_param->min_hits)
+    {
+      od_tracker_pp_outBuffer_t *pOut = &pOutput->pOutBuff[nb_out++];
+
+      pOut->x_center = pTrack->x_center;
+      pOut->y_center = pTrack->y_center;
+      pOut->width = pTrack->width;
+      pOut->height = pTrack->height;
+      pOut->conf = pTrack->conf;
+      pOut->class_index = pTrack->class_index;
+      pOut->track_id = pTrack->track_id;
+      pOut->nb_missed = pTrack->nb_missed;
+    }
+  }
+  pOutput->nb_tracks = nb_out;
+}
+
+
+int32_t od_tracker_pp_reset(od_tracker_pp_static_param_t *pInput_static_param)
+{
+  pInput_static_param->nb_tracks = 0;
+  pInput_static_param->next_track_id = 1;
+
+  return (AI_OD_POSTPROCESS_ERROR_NO);
+}
+
+
+int32_t od_tracker_pp_update(od_pp_out_t *pInput,
+                             od_tracker_pp_out_t *pOutput,
+                             od_tracker_pp_static_param_t *pInput_static_param)
+{
+  od_pp_outBuffer_t *pDets = pInput->pOutBuff;
+  int32_t nb_dets = MIN(pInput->nb_detect, AI_OD_TRACKER_PP_MAX_TRACKS);
+  int32_t nb_tracks = pInput_static_param->nb_tracks;
+  float32_t alpha = pInput_static_param->alpha;
+  float32_t beta = pInput_static_param->beta;
+
+  od_tracker_pp_step(pInput_static_param);
+
+  for (int32_t i = 0; i < AI_OD_TRACKER_PP_MAX_TRACKS; i++)
+  {
+    pInput_static_param->det_track[i] = AI_OD_TRACKER_PP_NONE;
+    pInput_static_param->track_det[i] = AI_OD_TRACKER_PP_NONE;
+  }
+
+  for (int32_t t = 0; t < nb_tracks; t++)
+  {
+    for (int32_t d = 0; d < nb_dets; d++)
+    {
+      pInput_static_param->affinity[t][d] = od_tracker_pp_affinity(&pInput_static_param->tracks[t], &pDets[d],
+                                                                   pInput_static_param);
+    }
+  }
+
+  if ((pInput_static_param->assoc_mode == AI_OD_TRACKER_PP_ASSOC_OPTIMAL) &&
+      (nb_tracks <= AI_OD_TRACKER_PP_OPTIMAL_MAX) && (nb_dets <= AI_OD_TRACKER_PP_OPTIMAL_MAX))
+  {
+    od_tracker_pp_assoc_optimal(nb_dets, pInput_static_param);
+  }
+  else
+  {
+    od_tracker_pp_assoc_greedy(nb_dets, pInput_static_param);
+  }
+
+  /* Detections left overlapping a track are duplicates, they do not start a track */
+  for (int32_t d = 0; d < nb_dets; d++)
+  {
+    for (int32_t t = 0; (t < nb_tracks) && (pInput_static_param->det_track[d] == AI_OD_TRACKER_PP_NONE); t++)
+    {
+      if (pInput_static_param->affinity[t][d] >= pInput_static_param->iou_threshold)
+      {
+        pInput_static_param->det_track[d] = AI_OD_TRACKER_PP_DUPLICATE;
+      }
+    }
+  }
+
+  /* Alpha-beta filter on the center, smoothing of the size and confidence */
+  int32_t nb_kept = 0;
+  for (int32_t t = 0; t < nb_tracks; t++)
+  {
+    od_tracker_pp_track_t *pTrack = &pInput_static_param->tracks[t];
+    int32_t d = pInput_static_param->track_det[t];
+
+    if (d != AI_OD_TRACKER_PP_NONE)
+    {
+      od_pp_outBuffer_t *pDet = &pDets[d];
+      float32_t rx = pDet->x_center - pTrack->x_center;
+      float32_t ry = pDet->y_center - pTrack->y_center;
+      float32_t dt = (float32_t) pTrack->nb_frames;
+
+      if (pTrack->nb_hits == 1)
+      {
+        /* Second detection, the velocity is measured */
+        pTrack->vx += rx / dt;
+        pTrack->vy += ry / dt;
+      }
+      else
+      {
+        pTrack->vx += beta * rx / dt;
+        pTrack->vy += beta * ry / dt;
+      }
+      pTrack->x_center += alpha * rx;
+      pTrack->y_center += alpha * ry;
+      pTrack->width += alpha * (pDet->width - pTrack->width);
+      pTrack->height += alpha * (pDet->height - pTrack->height);
+      pTrack->conf += alpha * (pDet->conf - pTrack->conf);
+      pTrack->nb_hits++;
+      pTrack->nb_missed = 0;
+      pTrack->nb_frames = 0;
+    }
+    else
+    {
+      pTrack->nb_missed++;
+      /* Tentative tracks are dropped at their first miss */
+      if ((pTrack->nb_hits < pInput_static_param->min_hits) ||
+          (pTrack->nb_missed > pInput_static_param->max_missed))
+      {
+        continue;
+      }
+    }
+
+    if (nb_kept != t)
+    {
+      pInput_static_param->tracks[nb_kept] = *pTrack;
+    }
+    nb_kept++;
+  }
+
+  /* New tracks for the detections left */
+  for (int32_t d = 0; (d < nb_dets) && (nb_kept < AI_OD_TRACKER_PP_MAX_TRACKS); d++)
+  {
+    if (pInput_static_param->det_track[d] != AI_OD_TRACKER_PP_NONE)
+    {
+      continue;
+    }
+    od_tracker_pp_track_t *pTrack = &pInput_static_param->tracks[nb_kept++];
+
+    pTrack->x_center = pDets[d].x_center;
+    pTrack->y_center = pDets[d].y_center;
+    pTrack->width = pDets[d].width;
+    pTrack->height = pDets[d].height;
+    pTrack->conf = pDets[d].conf;
+    pTrack->class_index = pDets[d].class_index;
+    pTrack->vx = 0;
+    pTrack->vy = 0;
+    pTrack->track_id = pInput_static_param->next_track_id++;
+    pTrack->nb_hits = 1;
+    pTrack->nb_missed = 0;
+    pTrack->nb_frames = 0;
+  }
+  pInput_static_param->nb_tracks = nb_kept;
+
+  od_tracker_pp_output(pOutput, pInput_static_param);
+
+  return (AI_OD_POSTPROCESS_ERROR_NO);
+}
+
+
+int32_t od_tracker_pp_predict(od_tracker_pp_out_t *pOutput,
+                              od_tracker_pp_static_param_t *pInput_static_param)
+{
+  od_tracker_pp_step(pInput_static_param);
+  od_tracker_pp_output(pOutput, pInput_static_param);
+
+  return (AI_OD_POSTPROCESS_ERROR_NO);
+}
@@ -12,87 +12,38 @@
 #include "vision_models_pp.h"
 
 
-/* Can't be removed if qsort is not re-written... */
-static int32_t AI_YOLOV2_PP_SORT_CLASS;
-
-
-int32_t yolov2_nms_comparator(const void *pa, const void *pb)
-{
-    float32_t a = *((float32_t *)pa + AI_YOLOV2_PP_CLASSPROB + AI_YOLOV2_PP_SORT_CLASS);
-    float32_t b = *((float32_t *)pb + AI_YOLOV2_PP_CLASSPROB + AI_YOLOV2_PP_SORT_CLASS);
-    float32_t diff = 0;
-
-    diff = a - b;
-
-    if (diff < 0) return 1;
-    else if (diff > 0) return -1;
-    return 0;
-}
-
-
-int32_t yolov2_pp_nmsFiltering_centroid(yolov2_pp_in_t  *pInput,
-                                        yolov2_pp_static_param_t *pInput_static_param)
+int32_t yolov2_pp_nmsFiltering_centroid(od_pp_out_t *pOutput,
+                                        const yolov2_pp_static_param_t *pInput_static_param,
+                                        float32_t *pCandidates)
 {
-    int32_t i, j, k, limit_counter;
     int32_t anch_stride = (pInput_static_param->nb_classes + AI_YOLOV2_PP_CLASSPROB);
-    float32_t *pInbuff = (float32_t *)pInput->pRaw_detections;
 
-    for (k = 0; k < pInput_static_param->nb_classes; ++k)
-    {
-        limit_counter = 0;
-        AI_YOLOV2_PP_SORT_CLASS = k;
-
-        qsort(pInbuff,
-              pInput_static_param->nb_detect,
-              anch_stride * sizeof(float32_t),
-              (_Cmpfun *)yolov2_nms_comparator);
-        for (i = 0; i < (pInput_static_param->nb_detect * anch_stride) ; i += anch_stride)
-        {
-            if (pInbuff[i + AI_YOLOV2_PP_CLASSPROB + k] == 0) continue;
-            float32_t *a = &(pInbuff[i + AI_YOLOV2_PP_XCENTER]);
-            for (j = i + anch_stride; j < (pInput_static_param->nb_detect * anch_stride); j += anch_stride)
-            {
-                float32_t *b = &(pInbuff[j + AI_YOLOV2_PP_XCENTER]);
-                if (vision_models_box_iou(a, b) > pInput_static_param->iou_threshold)
-                {
-                    pInbuff[j + AI_YOLOV2_PP_CLASSPROB + k] = 0;
-                }
-            }
-        }
-        for (int32_t y = 0; y <= (pInput_static_param->nb_detect * anch_stride); y += anch_stride)
-        {
-            if ((limit_counter < pInput_static_param->max_boxes_limit) &&
-                (pInbuff[y + AI_YOLOV2_PP_CLASSPROB + k] != 0))
-            {
-                limit_counter++;
-            }
-            else
-            {
-                pInbuff[y + AI_YOLOV2_PP_CLASSPROB + k] = 0;
-            }
-        }
-    }
+    /* Per-class NMS on the decoded candidates, scored for every class */
+    vision_models_nms_class_f32(pCandidates,
+                                anch_stride * sizeof(float32_t),
+                                pOutput->nb_detect,
+                                AI_YOLOV2_PP_CLASSPROB * sizeof(float32_t),
+                                pInput_static_param->nb_classes,
+                                pInput_static_param->conf_threshold,
+                                pInput_static_param->iou_threshold,
+                                pInput_static_param->max_boxes_limit,
+                                pInput_static_param->nms_mode);
 
     return (AI_OD_POSTPROCESS_ERROR_NO);
 }
 
 
-int32_t yolov2_pp_scoreFiltering_centroid(yolov2_pp_in_t *pInput,
-                                          od_pp_out_t *pOutput,
-                                          yolov2_pp_static_param_t *pInput_static_param)
+int32_t yolov2_pp_scoreFiltering_centroid(od_pp_out_t *pOutput,
+                                          const yolov2_pp_static_param_t *pInput_static_param,
+                                          float32_t *pCandidates)
 {
     float32_t best_score;
     uint32_t class_index;
     int32_t det_count = 0;
     int32_t anch_stride = (pInput_static_param->nb_classes + AI_YOLOV2_PP_CLASSPROB);
+    float32_t *pInbuff = pCandidates;
 
-    if (pOutput->pOutBuff == NULL)
-    {
-      pOutput->pOutBuff = (od_pp_outBuffer_t *)pInput->pRaw_detections;
-    }
-    float32_t *pInbuff = (float32_t *)pInput->pRaw_detections;
-
-    for (int32_t i = 0; i < (pInput_static_param->nb_detect * anch_stride); i += anch_stride)
+    for (int32_t i = 0; i < (pOutput->nb_detect * anch_stride); i += anch_stride)
     {
         vision_models_maxi_if32ou32(&pInbuff[i + AI_YOLOV2_PP_CLASSPROB],
              pInput_static_param->nb_classes,
@@ -116,8 +67,12 @@ int32_t yolov2_pp_scoreFiltering_centroid(yolov2_pp_in_t *pInput,
 }
 
 
+/* Decodes the anchors above the threshold into the scratch arena, as records of the input layout
+ * with the activated objectness and class scores: the input tensor is only read */
 int32_t yolov2_pp_getNNBoxes_centroid(yolov2_pp_in_t *pInput,
-                                      yolov2_pp_static_param_t *pInput_static_param)
+                                      od_pp_out_t *pOutput,
+                                      const yolov2_pp_static_param_t *pInput_static_param,
+                                      float32_t *pCandidates)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     int32_t count = 0;
@@ -126,50 +81,49 @@ int32_t yolov2_pp_getNNBoxes_centroid(yolov2_pp_in_t *pInput,
     uint32_t class_index;
     int32_t anch_stride = (pInput_static_param->nb_classes + AI_YOLOV2_PP_CLASSPROB);
 
-    yolov2_pp_in_t *pOutput = pInput;
     float32_t grid_width_inv = 1.0f / pInput_static_param->grid_width;
     float32_t grid_height_inv = 1.0f / pInput_static_param->grid_height;
-    float32_t tmp_a[pInput_static_param->nb_classes];
     int32_t el_offset = 0;
     float32_t *pInbuff = (float32_t *)pInput->pRaw_detections;
-    float32_t *pOutbuff = (float32_t *)pOutput->pRaw_detections;
     for (int32_t row = 0; row < pInput_static_param->grid_width; ++row)
     {
         for (int32_t col = 0; col < pInput_static_param->grid_height; ++col)
         {
             for (int32_t anch = 0; anch < pInput_static_param->nb_anchors; ++anch)
             {
-                /* read and activate objectness */
-                pOutbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS] = vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS]);
+                /* The best score is at most the objectness: reject on its logit before any activation */
+                if (pInbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS] < pInput_static_param->conf_threshold_logit)
+                {
+                    el_offset += anch_stride;
+                    continue;
+                }
+
+                /* read and activate objectness, in the next candidate record */
+                float32_t *pCand = &pCandidates[count];
+                pCand[AI_YOLOV2_PP_OBJECTNESS] = vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS]);
 
                 /* activate array of classes pred */
                 vision_models_softmax_f(&pInbuff[el_offset + AI_YOLOV2_PP_CLASSPROB],
-                        &pOutbuff[el_offset + AI_YOLOV2_PP_CLASSPROB],
-                        pInput_static_param->nb_classes,
-                        tmp_a);
+                        &pCand[AI_YOLOV2_PP_CLASSPROB],
+                        pInput_static_param->nb_classes);
                 for (int32_t k = 0; k < pInput_static_param->nb_classes; k++)
                 {
-                    pOutbuff[el_offset + AI_YOLOV2_PP_CLASSPROB + k] = pOutbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS] *
-                                                                       pOutbuff[el_offset + AI_YOLOV2_PP_CLASSPROB + k];
+                    pCand[AI_YOLOV2_PP_CLASSPROB + k] = pCand[AI_YOLOV2_PP_OBJECTNESS] *
+                                                        pCand[AI_YOLOV2_PP_CLASSPROB + k];
                 }
 
-                vision_models_maxi_if32ou32(&pOutbuff[el_offset + AI_YOLOV2_PP_CLASSPROB],
+                vision_models_maxi_if32ou32(&pCand[AI_YOLOV2_PP_CLASSPROB],
                      pInput_static_param->nb_classes,
                      &best_score,
                      &class_index);
 
+                /* The record is kept above the threshold, overwritten by the next candidate otherwise */
                 if (best_score >= pInput_static_param->conf_threshold)
                 {
-                    pOutbuff[count + AI_YOLOV2_PP_OBJECTNESS] = pOutbuff[el_offset + AI_YOLOV2_PP_OBJECTNESS];
-                    for (int32_t k = 0; k < pInput_static_param->nb_classes; ++k)
-                    {
-                        pOutbuff[count + AI_YOLOV2_PP_CLASSPROB + k] = pOutbuff[el_offset + AI_YOLOV2_PP_CLASSPROB + k];
-                    }
-
-                    pOutbuff[count + AI_YOLOV2_PP_XCENTER] = (col + vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_XCENTER])) * grid_width_inv;
-                    pOutbuff[count + AI_YOLOV2_PP_YCENTER] = (row + vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_YCENTER])) * grid_height_inv;
-                    pOutbuff[count + AI_YOLOV2_PP_WIDTHREL] = (pInput_static_param->pAnchors[2 * anch] * expf(pInbuff[el_offset + AI_YOLOV2_PP_WIDTHREL])) * grid_width_inv;
-                    pOutbuff[count + AI_YOLOV2_PP_HEIGHTREL] = (pInput_static_param->pAnchors[2 * anch + 1] * expf(pInbuff[el_offset + AI_YOLOV2_PP_HEIGHTREL])) * grid_height_inv;
+                    pCand[AI_YOLOV2_PP_XCENTER] = (col + vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_XCENTER])) * grid_width_inv;
+                    pCand[AI_YOLOV2_PP_YCENTER] = (row + vision_models_sigmoid_f(pInbuff[el_offset + AI_YOLOV2_PP_YCENTER])) * grid_height_inv;
+                    pCand[AI_YOLOV2_PP_WIDTHREL] = (pInput_static_param->pAnchors[2 * anch] * expf(pInbuff[el_offset + AI_YOLOV2_PP_WIDTHREL])) * grid_width_inv;
+                    pCand[AI_YOLOV2_PP_HEIGHTREL] = (pInput_static_param->pAnchors[2 * anch + 1] * expf(pInbuff[el_offset + AI_YOLOV2_PP_HEIGHTREL])) * grid_height_inv;
 
                     count += anch_stride;
                     count_detect++;
@@ -180,7 +134,7 @@ int32_t yolov2_pp_getNNBoxes_centroid(yolov2_pp_in_t *pInput,
         }
     }
 
-    pInput_static_param->nb_detect = count_detect;
+    pOutput->nb_detect = count_detect;
     return (error);
 }
 
@@ -191,32 +145,54 @@ int32_t yolov2_pp_getNNBoxes_centroid(yolov2_pp_in_t *pInput,
 int32_t od_yolov2_pp_reset(yolov2_pp_static_param_t *pInput_static_param)
 {
     /* Initializations */
-    pInput_static_param->nb_detect = 0;
+    /* Class probabilities can round a few ulps above 1, the objectness bound keeps a margin */
+    pInput_static_param->conf_threshold_logit =
+        vision_models_logit_threshold_f(pInput_static_param->conf_threshold * (1.0f - 4.0f * FLT_EPSILON));
 
 	return (AI_OD_POSTPROCESS_ERROR_NO);
 }
 
 
+uint32_t od_yolov2_pp_get_scratch_size(const yolov2_pp_static_param_t *pInput_static_param)
+{
+    return (uint32_t)AI_OD_YOLOV2_PP_SCRATCH_SIZE(pInput_static_param->grid_width * pInput_static_param->grid_height *
+                                                  pInput_static_param->nb_anchors,
+                                                  pInput_static_param->nb_classes);
+}
+
+
 int32_t od_yolov2_pp_process(yolov2_pp_in_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov2_pp_static_param_t *pInput_static_param)
+                                    const yolov2_pp_static_param_t *pInput_static_param,
+                                    vision_models_pp_ctx_t *pCtx)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
 
+    pOutput->nb_detect = 0;
+    if ((pOutput->pOutBuff == NULL) || (pCtx == NULL) || (pCtx->pScratch == NULL) ||
+        (pCtx->scratch_size < od_yolov2_pp_get_scratch_size(pInput_static_param)))
+    {
+        return (AI_OD_POSTPROCESS_ERROR);
+    }
+    float32_t *pCandidates = (float32_t *)pCtx->pScratch;
+
     /* Call Get NN boxes first */
     error = yolov2_pp_getNNBoxes_centroid(pInput,
-                                          pInput_static_param);
+                                          pOutput,
+                                          pInput_static_param,
+                                          pCandidates);
     if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
 
     /* Then NMS */
-    error = yolov2_pp_nmsFiltering_centroid(pInput,
-                                            pInput_static_param);
+    error = yolov2_pp_nmsFiltering_centroid(pOutput,
+                                            pInput_static_param,
+                                            pCandidates);
     if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
 
     /* And score re-filtering */
-    error = yolov2_pp_scoreFiltering_centroid(pInput,
-                                              pOutput,
-                                              pInput_static_param);
+    error = yolov2_pp_scoreFiltering_centroid(pOutput,
+                                              pInput_static_param,
+                                              pCandidates);
 
     return (error);
 }
@@ -12,113 +12,26 @@
 #include "vision_models_pp.h"
 
 
-/* Can't be removed if qsort is not re-written... */
-static int32_t AI_YOLOV5_PP_SORT_CLASS;
-
-
-int32_t yolov5_nms_comparator(const void *pa, const void *pb)
-{
-    od_pp_outBuffer_t a = *(od_pp_outBuffer_t *)pa;
-    od_pp_outBuffer_t b = *(od_pp_outBuffer_t *)pb;
-
-    float32_t diff = 0.0;
-    float32_t a_weighted_conf = 0.0;
-    float32_t b_weighted_conf = 0.0;
-
-    if (a.class_index == AI_YOLOV5_PP_SORT_CLASS)
-    {
-        a_weighted_conf = a.conf;
-    }
-    else
-    {
-         a_weighted_conf = 0.0;
-    }
-
-    if (b.class_index == AI_YOLOV5_PP_SORT_CLASS)
-    {
-        b_weighted_conf = b.conf;
-    }
-    else
-    {
-         b_weighted_conf = 0.0;
-    }
-
-    diff = a_weighted_conf - b_weighted_conf;
-
-    if (diff < 0) return 1;
-    else if (diff > 0) return -1;
-    return 0;
-}
-
-
 int32_t yolov5_pp_nmsFiltering_centroid(od_pp_out_t *pOutput,
-                                        yolov5_pp_static_param_t *pInput_static_param)
+                                        const yolov5_pp_static_param_t *pInput_static_param)
 {
-    int32_t j, k, limit_counter, detections_per_class;
+    vision_models_nms_f32(pOutput->pOutBuff,
+                          sizeof(od_pp_outBuffer_t),
+                          pOutput->nb_detect,
+                          pInput_static_param->iou_threshold,
+                          pInput_static_param->max_boxes_limit,
+                          pInput_static_param->nms_mode);
 
-    for (k = 0; k < pInput_static_param->nb_classes; ++k)
-    {
-        limit_counter = 0;
-        detections_per_class = 0;
-        AI_YOLOV5_PP_SORT_CLASS = k;
-
-
-        /* Counts the number of detections with class k */
-        for (int32_t i = 0; i < pInput_static_param->nb_detect ; i ++)
-        {
-            if(pOutput->pOutBuff[i].class_index == k)
-            {
-                detections_per_class++;
-            }
-        }
-
-        if (detections_per_class > 0)
-        {
-            /* Sorts detections based on class k */
-            qsort(pOutput->pOutBuff,
-                  pInput_static_param->nb_detect,
-                  sizeof(od_pp_outBuffer_t),
-                  yolov5_nms_comparator);
-
-            for (int32_t i = 0; i < detections_per_class ; i ++)
-            {
-                if (pOutput->pOutBuff[i].conf == 0) continue;
-                float32_t *a = &(pOutput->pOutBuff[i].x_center);
-                for (j = i + 1; j < detections_per_class; j ++)
-                {
-                    float32_t *b = &(pOutput->pOutBuff[j].x_center);
-                    if (vision_models_box_iou(a, b) > pInput_static_param->iou_threshold)
-                    {
-                        pOutput->pOutBuff[j].conf = 0;
-                    }
-                }
-            }
-
-            /* Limits detections count */
-            for (int32_t i = 0; i < detections_per_class; i++)
-            {
-                if ((limit_counter < pInput_static_param->max_boxes_limit) &&
-                    (pOutput->pOutBuff[i].conf != 0))
-                {
-                    limit_counter++;
-                }
-                else
-                {
-                    pOutput->pOutBuff[i].conf = 0;
-                }
-            }
-        }
-    }
     return (AI_OD_POSTPROCESS_ERROR_NO);
 }
 
 
 int32_t yolov5_pp_scoreFiltering_centroid(od_pp_out_t *pOutput,
-                                          yolov5_pp_static_param_t *pInput_static_param)
+                                          const yolov5_pp_static_param_t *pInput_static_param)
 {
     int32_t det_count = 0;
 
-    for (int32_t i = 0; i < pInput_static_param->nb_detect; i++)
+    for (int32_t i = 0; i < pOutput->nb_detect; i++)
     {
         if (pOutput->pOutBuff[i].conf >= pInput_static_param->conf_threshold)
         {
@@ -139,7 +52,7 @@ int32_t yolov5_pp_scoreFiltering_centroid(od_pp_out_t *pOutput,
 
 int32_t yolov5_pp_getNNBoxes_centroid(yolov5_pp_in_centroid_t *pInput,
                                       od_pp_out_t *pOutput,
-                                      yolov5_pp_static_param_t *pInput_static_param)
+                                      const yolov5_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     float32_t best_score = 0;
@@ -150,7 +63,7 @@ int32_t yolov5_pp_getNNBoxes_centroid(yolov5_pp_in_centroid_t *pInput,
     int32_t detection_len = pInput_static_param->nb_classes + AI_YOLOV5_PP_BOX_STRIDE + 1;
     float32_t *pRaw_detections = (float32_t *)pInput->pRaw_detections;
 
-    pInput_static_param->nb_detect =0;
+    pOutput->nb_detect =0;
 
     for (int32_t i = 0; i < nb_total_boxes; i++)
     {
@@ -164,13 +77,13 @@ int32_t yolov5_pp_getNNBoxes_centroid(yolov5_pp_in_centroid_t *pInput,
 
             if (best_score >= pInput_static_param->conf_threshold)
             {
-                pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = pRaw_detections[i*detection_len + AI_YOLOV5_PP_XCENTER];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = pRaw_detections[i*detection_len + AI_YOLOV5_PP_YCENTER];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].width = pRaw_detections[i*detection_len + AI_YOLOV5_PP_WIDTHREL];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].height = pRaw_detections[i*detection_len + AI_YOLOV5_PP_HEIGHTREL];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].conf = best_score;
-                pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-                pInput_static_param->nb_detect++;
+                pOutput->pOutBuff[pOutput->nb_detect].x_center = pRaw_detections[i*detection_len + AI_YOLOV5_PP_XCENTER];
+                pOutput->pOutBuff[pOutput->nb_detect].y_center = pRaw_detections[i*detection_len + AI_YOLOV5_PP_YCENTER];
+                pOutput->pOutBuff[pOutput->nb_detect].width = pRaw_detections[i*detection_len + AI_YOLOV5_PP_WIDTHREL];
+                pOutput->pOutBuff[pOutput->nb_detect].height = pRaw_detections[i*detection_len + AI_YOLOV5_PP_HEIGHTREL];
+                pOutput->pOutBuff[pOutput->nb_detect].conf = best_score;
+                pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index;
+                pOutput->nb_detect++;
             }
 
         }
@@ -182,7 +95,7 @@ int32_t yolov5_pp_getNNBoxes_centroid(yolov5_pp_in_centroid_t *pInput,
 
 int32_t yolov5_pp_getNNBoxes_centroid_uint8(yolov5_pp_in_centroid_uint8_t *pInput,
                                       od_pp_out_t *pOutput,
-                                      yolov5_pp_static_param_t *pInput_static_param)
+                                      const yolov5_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     uint8_t best_score = 0;
@@ -196,14 +109,14 @@ int32_t yolov5_pp_getNNBoxes_centroid_uint8(yolov5_pp_in_centroid_uint8_t *pInpu
     uint8_t zero_point = pInput_static_param->raw_output_zero_point;
     float32_t scale = pInput_static_param->raw_output_scale;
 
-    pInput_static_param->nb_detect = 0;
+    pOutput->nb_detect = 0;
 
     // scale must be strictly positive
     if (scale <= 0.0f) {
         return AI_OD_POSTPROCESS_ERROR;
     }
 
-    uint8_t conf_threshold_u8 = MIN((uint32_t)(pInput_static_param->conf_threshold / scale + (int32_t)zero_point + 0.5f),255);
+    int32_t conf_threshold_u8 = pInput_static_param->conf_threshold_u8;
     for (int32_t i = 0; i < nb_total_boxes; i++)
     {
         confidence = pRaw_detections[ i*detection_len + AI_YOLOV5_PP_CONFIDENCE];
@@ -216,13 +129,13 @@ int32_t yolov5_pp_getNNBoxes_centroid_uint8(yolov5_pp_in_centroid_uint8_t *pInpu
 
             if (best_score >= conf_threshold_u8)
             {
-                pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_XCENTER] - (int32_t)zero_point);
-                pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_YCENTER ] - (int32_t)zero_point);
-                pOutput->pOutBuff[pInput_static_param->nb_detect].width = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_WIDTHREL] - (int32_t)zero_point);
-                pOutput->pOutBuff[pInput_static_param->nb_detect].height = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_HEIGHTREL ] - (int32_t)zero_point);
-                pOutput->pOutBuff[pInput_static_param->nb_detect].conf = scale * (float32_t)((int32_t)best_score - (int32_t)zero_point); //best_score_f;
-                pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-                pInput_static_param->nb_detect++;
+                pOutput->pOutBuff[pOutput->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_XCENTER] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_YCENTER ] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].width = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_WIDTHREL] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].height = scale * (float32_t)((int32_t)pRaw_detections[i*detection_len + AI_YOLOV5_PP_HEIGHTREL ] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].conf = scale * (float32_t)((int32_t)best_score - (int32_t)zero_point); //best_score_f;
+                pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index;
+                pOutput->nb_detect++;
             }
 
         }
@@ -237,7 +150,13 @@ int32_t yolov5_pp_getNNBoxes_centroid_uint8(yolov5_pp_in_centroid_uint8_t *pInpu
 int32_t od_yolov5_pp_reset(yolov5_pp_static_param_t *pInput_static_param)
 {
     /* Initializations */
-    pInput_static_param->nb_detect = 0;
+    if (pInput_static_param->raw_output_scale > 0.0f)
+    {
+        pInput_static_param->conf_threshold_u8 =
+            vision_models_quantize_threshold_iu8(pInput_static_param->conf_threshold,
+                                                 pInput_static_param->raw_output_scale,
+                                                 pInput_static_param->raw_output_zero_point);
+    }
 
     return (AI_OD_POSTPROCESS_ERROR_NO);
 }
@@ -245,7 +164,7 @@ int32_t od_yolov5_pp_reset(yolov5_pp_static_param_t *pInput_static_param)
 
 int32_t od_yolov5_pp_process(yolov5_pp_in_centroid_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov5_pp_static_param_t *pInput_static_param)
+                                    const yolov5_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
 
@@ -270,7 +189,7 @@ int32_t od_yolov5_pp_process(yolov5_pp_in_centroid_t *pInput,
 
 int32_t od_yolov5_pp_process_uint8(yolov5_pp_in_centroid_uint8_t *pInput,
                                          od_pp_out_t *pOutput,
-                                         yolov5_pp_static_param_t *pInput_static_param)
+                                         const yolov5_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
 
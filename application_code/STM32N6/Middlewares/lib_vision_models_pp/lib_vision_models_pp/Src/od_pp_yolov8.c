@@ -12,113 +12,26 @@
 #include "vision_models_pp.h"
 
 
-/* Can't be removed if qsort is not re-written... */
-static int32_t AI_YOLOV8_PP_SORT_CLASS;
-
-
-int32_t yolov8_nms_comparator(const void *pa, const void *pb)
-{
-    od_pp_outBuffer_t a = *(od_pp_outBuffer_t *)pa;
-    od_pp_outBuffer_t b = *(od_pp_outBuffer_t *)pb;
-
-    float32_t diff = 0.0;
-    float32_t a_weighted_conf = 0.0;
-    float32_t b_weighted_conf = 0.0;
-
-    if (a.class_index == AI_YOLOV8_PP_SORT_CLASS)
-    {
-        a_weighted_conf = a.conf;
-    }
-    else
-    {
-         a_weighted_conf = 0.0;
-    }
-
-    if (b.class_index == AI_YOLOV8_PP_SORT_CLASS)
-    {
-        b_weighted_conf = b.conf;
-    }
-    else
-    {
-         b_weighted_conf = 0.0;
-    }
-
-    diff = a_weighted_conf - b_weighted_conf;
-
-    if (diff < 0) return 1;
-    else if (diff > 0) return -1;
-    return 0;
-}
-
-
 int32_t yolov8_pp_nmsFiltering_centroid(od_pp_out_t *pOutput,
-                                        yolov8_pp_static_param_t *pInput_static_param)
+                                        const yolov8_pp_static_param_t *pInput_static_param)
 {
-    int32_t j, k, limit_counter, detections_per_class;
-
-    for (k = 0; k < pInput_static_param->nb_classes; ++k)
-    {
-        limit_counter = 0;
-        detections_per_class = 0;
-        AI_YOLOV8_PP_SORT_CLASS = k;
-
-
-        /* Counts the number of detections with class k */
-        for (int32_t i = 0; i < pInput_static_param->nb_detect ; i ++)
-        {
-            if(pOutput->pOutBuff[i].class_index == k)
-            {
-                detections_per_class++;
-            }
-        }
-
-        if (detections_per_class > 0)
-        {
-            /* Sorts detections based on class k */
-            qsort(pOutput->pOutBuff,
-                  pInput_static_param->nb_detect,
-                  sizeof(od_pp_outBuffer_t),
-                  yolov8_nms_comparator);
-
-            for (int32_t i = 0; i < detections_per_class ; i ++)
-            {
-                if (pOutput->pOutBuff[i].conf == 0) continue;
-                float32_t *a = &(pOutput->pOutBuff[i].x_center);
-                for (j = i + 1; j < detections_per_class; j ++)
-                {
-                    float32_t *b = &(pOutput->pOutBuff[j].x_center);
-                    if (vision_models_box_iou(a, b) > pInput_static_param->iou_threshold)
-                    {
-                        pOutput->pOutBuff[j].conf = 0;
-                    }
-                }
-            }
+    vision_models_nms_f32(pOutput->pOutBuff,
+                          sizeof(od_pp_outBuffer_t),
+                          pOutput->nb_detect,
+                          pInput_static_param->iou_threshold,
+                          pInput_static_param->max_boxes_limit,
+                          pInput_static_param->nms_mode);
 
-            /* Limits detections count */
-            for (int32_t i = 0; i < detections_per_class; i++)
-            {
-                if ((limit_counter < pInput_static_param->max_boxes_limit) &&
-                    (pOutput->pOutBuff[i].conf != 0))
-                {
-                    limit_counter++;
-                }
-                else
-                {
-                    pOutput->pOutBuff[i].conf = 0;
-                }
-            }
-        }
-    }
     return (AI_OD_POSTPROCESS_ERROR_NO);
 }
 
 
 int32_t yolov8_pp_scoreFiltering_centroid(od_pp_out_t *pOutput,
-                                          yolov8_pp_static_param_t *pInput_static_param)
+                                          const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t det_count = 0;
 
-    for (int32_t i = 0; i < pInput_static_param->nb_detect; i++)
+    for (int32_t i = 0; i < pOutput->nb_detect; i++)
     {
         if (pOutput->pOutBuff[i].conf >= pInput_static_param->conf_threshold)
         {
@@ -139,7 +52,7 @@ int32_t yolov8_pp_scoreFiltering_centroid(od_pp_out_t *pOutput,
 #ifdef AI_OD_YOLOV8_PP_MVEF_OPTIM
 int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
                                       od_pp_out_t *pOutput,
-                                      yolov8_pp_static_param_t *pInput_static_param)
+                                      const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     int32_t nb_classes = pInput_static_param->nb_classes;
@@ -147,7 +60,7 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
     float32_t *pRaw_detections = (float32_t *)pInput->pRaw_detections;
     int32_t remaining_boxes = nb_total_boxes;
 
-    pInput_static_param->nb_detect =0;
+    pOutput->nb_detect =0;
     for (int32_t i = 0; i < nb_total_boxes; i+=4)
     {
         float32_t best_score_array[4];
@@ -163,13 +76,13 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
 
             if (best_score_array[_i] >= pInput_static_param->conf_threshold)
             {
-                pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = pRaw_detections[i + _i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = pRaw_detections[i + _i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].width = pRaw_detections[i + _i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].height = pRaw_detections[i + _i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].conf = best_score_array[_i];
-                pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index_array[_i];
-                pInput_static_param->nb_detect++;
+                pOutput->pOutBuff[pOutput->nb_detect].x_center = pRaw_detections[i + _i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
+                pOutput->pOutBuff[pOutput->nb_detect].y_center = pRaw_detections[i + _i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
+                pOutput->pOutBuff[pOutput->nb_detect].width = pRaw_detections[i + _i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
+                pOutput->pOutBuff[pOutput->nb_detect].height = pRaw_detections[i + _i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
+                pOutput->pOutBuff[pOutput->nb_detect].conf = best_score_array[_i];
+                pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index_array[_i];
+                pOutput->nb_detect++;
             }
         }
         remaining_boxes-=4;
@@ -180,7 +93,7 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
 #else
 int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
                                       od_pp_out_t *pOutput,
-                                      yolov8_pp_static_param_t *pInput_static_param)
+                                      const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     float32_t best_score = 0;
@@ -189,7 +102,7 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
     int32_t nb_total_boxes = pInput_static_param->nb_total_boxes;
     float32_t *pRaw_detections = (float32_t *)pInput->pRaw_detections;
 
-    pInput_static_param->nb_detect =0;
+    pOutput->nb_detect =0;
     for (int32_t i = 0; i < nb_total_boxes; i++)
     {
         vision_models_maxi_tr_if32ou32(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
@@ -200,13 +113,13 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
 
         if (best_score >= pInput_static_param->conf_threshold)
         {
-            pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
-            pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
-            pOutput->pOutBuff[pInput_static_param->nb_detect].width = pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
-            pOutput->pOutBuff[pInput_static_param->nb_detect].height = pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
-            pOutput->pOutBuff[pInput_static_param->nb_detect].conf = best_score;
-            pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-            pInput_static_param->nb_detect++;
+            pOutput->pOutBuff[pOutput->nb_detect].x_center = pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
+            pOutput->pOutBuff[pOutput->nb_detect].y_center = pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
+            pOutput->pOutBuff[pOutput->nb_detect].width = pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
+            pOutput->pOutBuff[pOutput->nb_detect].height = pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
+            pOutput->pOutBuff[pOutput->nb_detect].conf = best_score;
+            pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index;
+            pOutput->nb_detect++;
         }
     }
 
@@ -214,10 +127,107 @@ int32_t yolov8_pp_getNNBoxes_centroid(yolov8_pp_in_centroid_t *pInput,
 }
 #endif
 
+int32_t yolov8_pp_nmsFiltering_centroid_is8(od_pp_scratchBuffer_s8_t *pScratch,
+                                            od_pp_out_t *pOutput,
+                                            const yolov8_pp_static_param_t *pInput_static_param)
+{
+    vision_models_nms_is8(pScratch,
+                          sizeof(od_pp_scratchBuffer_s8_t),
+                          pOutput->nb_detect,
+                          pInput_static_param->iou_threshold,
+                          pInput_static_param->max_boxes_limit,
+                          pInput_static_param->raw_output_zero_point,
+                          pInput_static_param->raw_output_scale,
+                          pInput_static_param->nms_mode);
+
+    return (AI_OD_POSTPROCESS_ERROR_NO);
+}
+
+
+/* Keeps the NMS survivors and dequantizes them. The scratch records are packed at the
+ * beginning of the output buffer: output record i overlaps scratch records 4i to 4i+3,
+ * so going backward only overwrites records already converted. */
+int32_t yolov8_pp_scoreFiltering_centroid_is8(od_pp_scratchBuffer_s8_t *pScratch,
+                                              od_pp_out_t *pOutput,
+                                              const yolov8_pp_static_param_t *pInput_static_param)
+{
+    int32_t det_count = 0;
+    int32_t zero_point = pInput_static_param->raw_output_zero_point;
+    float32_t scale = pInput_static_param->raw_output_scale;
+    int32_t conf_threshold_s8 = pInput_static_param->conf_threshold_s8;
+
+    for (int32_t i = 0; i < pOutput->nb_detect; i++)
+    {
+        if (pScratch[i].conf >= conf_threshold_s8)
+        {
+            pScratch[det_count] = pScratch[i];
+            det_count++;
+        }
+    }
+
+    for (int32_t i = det_count - 1; i >= 0; i--)
+    {
+        od_pp_scratchBuffer_s8_t det = pScratch[i];
+
+        pOutput->pOutBuff[i].x_center    = scale * (float32_t)((int32_t)det.x_center - zero_point);
+        pOutput->pOutBuff[i].y_center    = scale * (float32_t)((int32_t)det.y_center - zero_point);
+        pOutput->pOutBuff[i].width       = scale * (float32_t)((int32_t)det.width - zero_point);
+        pOutput->pOutBuff[i].height      = scale * (float32_t)((int32_t)det.height - zero_point);
+        pOutput->pOutBuff[i].conf        = scale * (float32_t)((int32_t)det.conf - zero_point);
+        pOutput->pOutBuff[i].class_index = det.class_index;
+    }
+    pOutput->nb_detect = det_count;
+
+    return (AI_OD_POSTPROCESS_ERROR_NO);
+}
+
 #ifdef AI_OD_YOLOV8_PP_MVEI_OPTIM
+int32_t yolov8_pp_getNNBoxes_centroid_is8(yolov8_pp_in_centroid_int8_t *pInput,
+                                          od_pp_scratchBuffer_s8_t *pScratch,
+                                          od_pp_out_t *pOutput,
+                                          const yolov8_pp_static_param_t *pInput_static_param)
+{
+    int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
+    int32_t nb_classes = pInput_static_param->nb_classes;
+    int32_t nb_total_boxes = pInput_static_param->nb_total_boxes;
+    int8_t *pRaw_detections = (int8_t *)pInput->pRaw_detections;
+    int32_t conf_threshold_s8 = pInput_static_param->conf_threshold_s8;
+    int32_t remaining_boxes = nb_total_boxes;
+    int8_t best_score_array[16];
+    uint8_t class_index_array[16];
+
+    pOutput->nb_detect = 0;
+    for (int32_t i = 0; i < nb_total_boxes; i+=16)
+    {
+        vision_models_maxi_tr_p_is8ou8(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
+                                       nb_classes,
+                                       nb_total_boxes,
+                                       best_score_array,
+                                       class_index_array,
+                                       remaining_boxes);
+        for (int _i = 0; _i < ((remaining_boxes>16)?16:remaining_boxes); _i++) {
+            if (best_score_array[_i] >= conf_threshold_s8)
+            {
+                pScratch->x_center    = pRaw_detections[i + _i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
+                pScratch->y_center    = pRaw_detections[i + _i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
+                pScratch->width       = pRaw_detections[i + _i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
+                pScratch->height      = pRaw_detections[i + _i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
+                pScratch->conf        = best_score_array[_i];
+                pScratch->class_index = class_index_array[_i];
+                pScratch++;
+                pOutput->nb_detect++;
+            }
+        }
+        remaining_boxes-=16;
+    }
+
+    return (error);
+}
+
+/* Class indexes above 255 do not fit the int8 records: boxes are dequantized */
 int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
                                            od_pp_out_t *pOutput,
-                                           yolov8_pp_static_param_t *pInput_static_param)
+                                           const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     int32_t class_index = 0;
@@ -227,80 +237,44 @@ int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
     int8_t zero_point = pInput_static_param->raw_output_zero_point;
     float32_t scale = pInput_static_param->raw_output_scale;
     float32_t best_score_f;
-
-    pInput_static_param->nb_detect =0;
     int32_t remaining_boxes = nb_total_boxes;
-#ifdef _YOLOV8_PP_INT8_CMP_INT8
-     int8_t conf_threshold_s8 = (int8_t)(pInput_static_param->conf_threshold / scale + 0.5f) + zero_point;
-#endif
-   if (nb_classes < 256) {
-        int8_t best_score_array[16];
-        uint8_t class_index_array[16];
-        for (int32_t i = 0; i < nb_total_boxes; i+=16)
-        {
-            vision_models_maxi_tr_p_is8ou8(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
-                                          nb_classes,
-                                          nb_total_boxes,
-                                          best_score_array,
-                                          class_index_array,
-                                          remaining_boxes);
-            for (int _i = 0; _i < ((remaining_boxes>16)?16:remaining_boxes); _i++) {
-
-#ifdef _YOLOV8_PP_INT8_CMP_INT8
-                if ( best_score_array[_i] >= conf_threshold_s8) {
-                best_score_f = scale * (float32_t)(best_score_array[_i] - zero_point);
-#else
-                best_score_f = scale * (float32_t)(best_score_array[_i] - zero_point);
-                if (best_score_f >= pInput_static_param->conf_threshold) {
-#endif
-                class_index = class_index_array[_i];
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_XCENTER * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_YCENTER * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].width = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].height = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].conf = best_score_f;
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-                    pInput_static_param->nb_detect++;
-                }
-            }
-            remaining_boxes-=16;
-        }
-    } else {
-        int8_t best_score_array[16];
-        uint16_t class_index_array[16];
-        for (int32_t i = 0; i < nb_total_boxes; i+=16)
-        {
-            vision_models_maxi_tr_p_is8ou16(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
-                                                nb_classes,
-                                                nb_total_boxes,
-                                                best_score_array,
-                                                class_index_array,
-                                                remaining_boxes);
-
-            for (int _i = 0; _i < ((remaining_boxes>16)?16:remaining_boxes); _i++) {
+    int8_t best_score_array[16];
+    uint16_t class_index_array[16];
+
+    pOutput->nb_detect =0;
+    for (int32_t i = 0; i < nb_total_boxes; i+=16)
+    {
+        vision_models_maxi_tr_p_is8ou16(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
+                                            nb_classes,
+                                            nb_total_boxes,
+                                            best_score_array,
+                                            class_index_array,
+                                            remaining_boxes);
+
+        for (int _i = 0; _i < ((remaining_boxes>16)?16:remaining_boxes); _i++) {
+            if (best_score_array[_i] >= pInput_static_param->conf_threshold_s8)
+            {
                 best_score_f = scale * (float32_t)(best_score_array[_i] - zero_point);
                 class_index = class_index_array[_i];
-                if (best_score_f >= pInput_static_param->conf_threshold)
-                {
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].width = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].height = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes] - (int32_t)zero_point);
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].conf = best_score_f;
-                    pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-                    pInput_static_param->nb_detect++;
-                }
+                pOutput->pOutBuff[pOutput->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_XCENTER * nb_total_boxes] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_YCENTER * nb_total_boxes] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].width = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].height = scale * (float32_t)((int32_t)pRaw_detections[i + _i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes] - (int32_t)zero_point);
+                pOutput->pOutBuff[pOutput->nb_detect].conf = best_score_f;
+                pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index;
+                pOutput->nb_detect++;
             }
-            remaining_boxes-=16;
         }
-
+        remaining_boxes-=16;
     }
+
     return (error);
 }
 #else
-int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
-                                           od_pp_out_t *pOutput,
-                                           yolov8_pp_static_param_t *pInput_static_param)
+int32_t yolov8_pp_getNNBoxes_centroid_is8(yolov8_pp_in_centroid_int8_t *pInput,
+                                          od_pp_scratchBuffer_s8_t *pScratch,
+                                          od_pp_out_t *pOutput,
+                                          const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
     int8_t best_score = 0;
@@ -308,11 +282,9 @@ int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
     int32_t nb_classes = pInput_static_param->nb_classes;
     int32_t nb_total_boxes = pInput_static_param->nb_total_boxes;
     int8_t *pRaw_detections = (int8_t *)pInput->pRaw_detections;
-    int8_t zero_point = pInput_static_param->raw_output_zero_point;
-    float32_t scale = pInput_static_param->raw_output_scale;
-    float32_t best_score_f;
+    int32_t conf_threshold_s8 = pInput_static_param->conf_threshold_s8;
 
-    pInput_static_param->nb_detect =0;
+    pOutput->nb_detect =0;
     for (int32_t i = 0; i < nb_total_boxes; i++)
     {
         vision_models_maxi_tr_is8ou8(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
@@ -320,16 +292,55 @@ int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
                                      nb_total_boxes,
                                      &best_score,
                                      &class_index);
-        best_score_f = scale * (float32_t)(best_score - zero_point);
-        if (best_score_f >= pInput_static_param->conf_threshold)
+        if (best_score >= conf_threshold_s8)
         {
-            pOutput->pOutBuff[pInput_static_param->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes] - (int32_t)zero_point);
-            pOutput->pOutBuff[pInput_static_param->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes] - (int32_t)zero_point);
-            pOutput->pOutBuff[pInput_static_param->nb_detect].width    = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes] - (int32_t)zero_point);
-            pOutput->pOutBuff[pInput_static_param->nb_detect].height   = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes] - (int32_t)zero_point);
-            pOutput->pOutBuff[pInput_static_param->nb_detect].conf     = best_score_f;
-            pOutput->pOutBuff[pInput_static_param->nb_detect].class_index = class_index;
-            pInput_static_param->nb_detect++;
+            pScratch->x_center    = pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
+            pScratch->y_center    = pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
+            pScratch->width       = pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
+            pScratch->height      = pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
+            pScratch->conf        = best_score;
+            pScratch->class_index = class_index;
+            pScratch++;
+            pOutput->nb_detect++;
+        }
+    }
+
+    return (error);
+}
+
+/* Class indexes above 255 do not fit the int8 records: boxes are dequantized */
+int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
+                                           od_pp_out_t *pOutput,
+                                           const yolov8_pp_static_param_t *pInput_static_param)
+{
+    int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
+    int8_t best_score = 0;
+    uint16_t class_index = 0;
+    int32_t nb_classes = pInput_static_param->nb_classes;
+    int32_t nb_total_boxes = pInput_static_param->nb_total_boxes;
+    int8_t *pRaw_detections = (int8_t *)pInput->pRaw_detections;
+    int8_t zero_point = pInput_static_param->raw_output_zero_point;
+    float32_t scale = pInput_static_param->raw_output_scale;
+    float32_t best_score_f;
+
+    pOutput->nb_detect =0;
+    for (int32_t i = 0; i < nb_total_boxes; i++)
+    {
+        vision_models_maxi_tr_is8ou16(&pRaw_detections[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes],
+                                      nb_classes,
+                                      nb_total_boxes,
+                                      &best_score,
+                                      &class_index);
+        if (best_score >= pInput_static_param->conf_threshold_s8)
+        {
+            best_score_f = scale * (float32_t)(best_score - zero_point);
+            pOutput->pOutBuff[pOutput->nb_detect].x_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes] - (int32_t)zero_point);
+            pOutput->pOutBuff[pOutput->nb_detect].y_center = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes] - (int32_t)zero_point);
+            pOutput->pOutBuff[pOutput->nb_detect].width    = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes] - (int32_t)zero_point);
+            pOutput->pOutBuff[pOutput->nb_detect].height   = scale * (float32_t)((int32_t)pRaw_detections[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes] - (int32_t)zero_point);
+            pOutput->pOutBuff[pOutput->nb_detect].conf     = best_score_f;
+            pOutput->pOutBuff[pOutput->nb_detect].class_index = class_index;
+            pOutput->nb_detect++;
         }
     }
 
@@ -343,7 +354,13 @@ int32_t yolov8_pp_getNNBoxes_centroid_int8(yolov8_pp_in_centroid_int8_t *pInput,
 int32_t od_yolov8_pp_reset(yolov8_pp_static_param_t *pInput_static_param)
 {
     /* Initializations */
-    pInput_static_param->nb_detect = 0;
+    if (pInput_static_param->raw_output_scale > 0.0f)
+    {
+        pInput_static_param->conf_threshold_s8 =
+            vision_models_quantize_threshold_is8(pInput_static_param->conf_threshold,
+                                                 pInput_static_param->raw_output_scale,
+                                                 pInput_static_param->raw_output_zero_point);
+    }
 
     return (AI_OD_POSTPROCESS_ERROR_NO);
 }
@@ -351,7 +368,7 @@ int32_t od_yolov8_pp_reset(yolov8_pp_static_param_t *pInput_static_param)
 
 int32_t od_yolov8_pp_process(yolov8_pp_in_centroid_t *pInput,
                                     od_pp_out_t *pOutput,
-                                    yolov8_pp_static_param_t *pInput_static_param)
+                                    const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
 
@@ -376,24 +393,52 @@ int32_t od_yolov8_pp_process(yolov8_pp_in_centroid_t *pInput,
 
 int32_t od_yolov8_pp_process_int8(yolov8_pp_in_centroid_int8_t *pInput,
                                          od_pp_out_t *pOutput,
-                                         yolov8_pp_static_param_t *pInput_static_param)
+                                         const yolov8_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_OD_POSTPROCESS_ERROR_NO;
 
+    if (pInput_static_param->nb_classes > UCHAR_MAX)
+    {
+        /* Call Get NN boxes first */
+        error = yolov8_pp_getNNBoxes_centroid_int8(pInput,
+                                                   pOutput,
+                                                   pInput_static_param);
+        if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
+
+        /* Then NMS */
+        error = yolov8_pp_nmsFiltering_centroid(pOutput,
+                                                pInput_static_param);
+        if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
+
+        /* And score re-filtering */
+        error = yolov8_pp_scoreFiltering_centroid(pOutput,
+                                                  pInput_static_param);
+
+        return (error);
+    }
+
+    /* Candidates stay quantized in packed records laid at the beginning of the output
+     * buffer, only the survivors are dequantized: the buffer only needs
+     * AI_OD_YOLOV8_PP_INT8_OUT_RECORDS records */
+    od_pp_scratchBuffer_s8_t *pScratch = (od_pp_scratchBuffer_s8_t *)pOutput->pOutBuff;
+
     /* Call Get NN boxes first */
-    error = yolov8_pp_getNNBoxes_centroid_int8(pInput,
-                                               pOutput,
-                                               pInput_static_param);
+    error = yolov8_pp_getNNBoxes_centroid_is8(pInput,
+                                              pScratch,
+                                              pOutput,
+                                              pInput_static_param);
     if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
 
     /* Then NMS */
-    error = yolov8_pp_nmsFiltering_centroid(pOutput,
-                                            pInput_static_param);
+    error = yolov8_pp_nmsFiltering_centroid_is8(pScratch,
+                                                pOutput,
+                                                pInput_static_param);
     if (error != AI_OD_POSTPROCESS_ERROR_NO) return (error);
 
     /* And score re-filtering */
-    error = yolov8_pp_scoreFiltering_centroid(pOutput,
-                                              pInput_static_param);
+    error = yolov8_pp_scoreFiltering_centroid_is8(pScratch,
+                                                  pOutput,
+                                                  pInput_static_param);
 
     return (error);
 }
@@ -15,12 +15,13 @@
   ******************************************************************************
   */
 
+#include <stdlib.h>
 #include "pd_model_pp_if.h"
 #include "vision_models_pp.h"
 #include "pd_pp_loc.h"
 
 
-static int32_t pd_pp_nms_comparator(const void *arg1, const void *arg2)
+static int pd_pp_nms_comparator(const void *arg1, const void *arg2)
 {
   const pd_pp_box_t *box1 = arg1;
   const pd_pp_box_t *box2 = arg2;
@@ -84,7 +85,7 @@ static float pd_pp_compute_iou(pd_pp_box_t *box0, pd_pp_box_t *box1)
 }
 static int32_t pd_pp_decode(pd_model_pp_in_t *pInput,
                                      pd_postprocess_out_t *pOutput,
-                                     pd_model_pp_static_param_t *pInput_static_param) {
+                                     const pd_model_pp_static_param_t *pInput_static_param) {
 
   pOutput->box_nb = 0;
 
@@ -100,9 +101,9 @@ static int32_t pd_pp_decode(pd_model_pp_in_t *pInput,
   for (uint32_t i = 0; i < pInput_static_param->nb_total_boxes; i++) {
     pd_pp_box_t *pBox = &pBoxes[box_nb]; //&pd_boxes[box_nb];
 
-    /* decode prob */
-    pBox->prob = 1.0f / (1.0f + expf(-pRawProbs[i]));
-    if (pBox->prob >= pInput_static_param->conf_threshold) {
+    /* reject on the logit, decode prob of the remaining boxes only */
+    if (pRawProbs[i] >= pInput_static_param->conf_threshold_logit) {
+      pBox->prob = vision_models_sigmoid_f(pRawProbs[i]);
       /* decode palm box */
       pBox->x_center = (pAnchors[i*2+0] * width  + pRawBoxes[i * in_struct_size + AI_PD_MODEL_PP_XCENTER]) / width;
       pBox->y_center = (pAnchors[i*2+1] * height + pRawBoxes[i * in_struct_size + AI_PD_MODEL_PP_YCENTER]) / height;
@@ -127,7 +128,7 @@ static int32_t pd_pp_decode(pd_model_pp_in_t *pInput,
 }
 
 static int pd_pp_nms(pd_postprocess_out_t *pOutput,
-                     pd_model_pp_static_param_t *pInput_static_param)
+                     const pd_model_pp_static_param_t *pInput_static_param)
 {
   int hand_nb = 0;
   int skip_box;
@@ -158,13 +159,15 @@ static int pd_pp_nms(pd_postprocess_out_t *pOutput,
 }
 int32_t pd_model_pp_reset(pd_model_pp_static_param_t *pInput_static_param)
 {
+  pInput_static_param->conf_threshold_logit = vision_models_logit_threshold_f(pInput_static_param->conf_threshold);
+
   return AI_PD_POSTPROCESS_ERROR_NO;
 }
 
 
 int32_t pd_model_pp_process(pd_model_pp_in_t *pInput,
                             pd_postprocess_out_t *pOutput,
-                            pd_model_pp_static_param_t *pInput_static_param)
+                            const pd_model_pp_static_param_t *pInput_static_param)
 {
   int32_t ret = AI_PD_POSTPROCESS_ERROR;
   ret = pd_pp_decode(pInput,
@@ -13,58 +13,134 @@
 
 
 
+/* Sub-pixel offset of a peak: vertex of the parabola through the peak and its two neighbours */
+static float32_t movenet_peak_offset(float32_t left, float32_t center, float32_t right)
+{
+  float32_t curvature = left - 2.0f * center + right;
+  float32_t offset;
+
+  if (curvature >= 0.0f)
+  {
+    return (0.0f);
+  }
+  offset = 0.5f * (left - right) / curvature;
+
+  return (MAX(-0.5f, MIN(0.5f, offset)));
+}
+
+
+static void movenet_set_keypoint(spe_pp_outBuffer_t *pKeyPoint,
+                                 uint32_t index,
+                                 float32_t proba,
+                                 float32_t x_offset,
+                                 float32_t y_offset,
+                                 const spe_movenet_pp_static_param_t *pInput_static_param)
+{
+  uint32_t width = pInput_static_param->heatmap_width;
+  uint32_t height = pInput_static_param->heatmap_height;
+
+  /* Heat maps are stored row by row, coordinates in the cartesian referential of the application code */
+  pKeyPoint->x_center = ((index % width + 0.5f + x_offset) / width);
+  pKeyPoint->y_center = ((index / width + 0.5f + y_offset) / height);
+  pKeyPoint->proba = proba;
+}
+
+
 int32_t movenet_heatmap_max(spe_movenet_pp_in_t *pInput,
                             spe_pp_out_t *pOutput,
-                            spe_movenet_pp_static_param_t *pInput_static_param)
+                            const spe_movenet_pp_static_param_t *pInput_static_param)
 {
-  uint32_t i;
-  float32_t x_center;
-  float32_t y_center;
-  float32_t proba;
-  uint32_t index;
+  float32_t proba[AI_VISION_MODELS_MAXI_COL_BLOCK];
+  uint32_t index[AI_VISION_MODELS_MAXI_COL_BLOCK];
   uint32_t width = pInput_static_param->heatmap_width;
   uint32_t height = pInput_static_param->heatmap_height;
-#ifdef _OLD_IMPL
-  float32_t *pTmpHeatMap = pInput_static_param->pTmpHeatMap;
-#endif
-  float32_t *pInputKp = pInput->inBuff;
+  int32_t nb_keypoints = pInput_static_param->nb_keypoints;
+  int32_t row_stride = width * nb_keypoints;
 
-  for (i = 0; i < pInput_static_param->nb_keypoints; i++)
+  for (int32_t k0 = 0; k0 < nb_keypoints; k0 += AI_VISION_MODELS_MAXI_COL_BLOCK)
   {
-#ifdef _OLD_IMPL
-     /* De-interleaves the heat maps */
-     pTmpHeatMap = pInput_static_param->pTmpHeatMap;
-     pInputKp = &(pInput->inBuff[i]);
-     for (uint32_t hm = 0; hm < (width * height); hm++)
-     {
-       *pTmpHeatMap++ = *pInputKp;
-       pInputKp += pInput_static_param->nb_keypoints;
-     }
-
-     /* Computes the argmax on the temporary heat map */
-     pTmpHeatMap = pInput_static_param->pTmpHeatMap;
-     vision_models_maxi_if32ou32((float32_t *) pTmpHeatMap,
-                        (uint32_t) width * height,
-                        (float32_t *) &proba,
-                        (uint32_t *) &index);
-#else
-
-    pInputKp = &(pInput->inBuff[i]);
-    vision_models_maxi_tr_if32ou32((float32_t *) pInputKp,
-                                   (uint32_t) width * height,
-                                   pInput_static_param->nb_keypoints,
-                                   (float32_t *) &proba,
-                                   (uint32_t *) &index);
-#endif
-
-    /* This is not cartesian referential, to be aligned with Python code */
-    y_center = ((index % height + 0.5f) / height);
-    x_center = ((index / height + 0.5f) / width);
-
-    /* Coordinates inversion for the application code that uses cartesian referential */
-    pOutput->pOutBuff[i].x_center = y_center;
-    pOutput->pOutBuff[i].y_center = x_center;
-    pOutput->pOutBuff[i].proba = proba;
+    uint32_t nb_cols = MIN(AI_VISION_MODELS_MAXI_COL_BLOCK, nb_keypoints - k0);
+
+    /* Heat maps are interleaved: argmax of all the keypoints in a single contiguous pass */
+    vision_models_maxi_col_if32ou32(&pInput->inBuff[k0],
+                                    width * height,
+                                    nb_keypoints,
+                                    nb_cols,
+                                    proba,
+                                    index);
+
+    for (uint32_t k = 0; k < nb_cols; k++)
+    {
+      float32_t *pPeak = &pInput->inBuff[index[k] * nb_keypoints + k0 + k];
+      float32_t x_offset = 0.0f;
+      float32_t y_offset = 0.0f;
+
+      if (pInput_static_param->subpixel_refine)
+      {
+        if ((index[k] % width > 0) && (index[k] % width < width - 1))
+        {
+          x_offset = movenet_peak_offset(pPeak[-nb_keypoints], *pPeak, pPeak[nb_keypoints]);
+        }
+        if ((index[k] / width > 0) && (index[k] / width < height - 1))
+        {
+          y_offset = movenet_peak_offset(pPeak[-row_stride], *pPeak, pPeak[row_stride]);
+        }
+      }
+      movenet_set_keypoint(&pOutput->pOutBuff[k0 + k], index[k], proba[k],
+                           x_offset, y_offset, pInput_static_param);
+    }
+  }
+
+  return (AI_SPE_POSTPROCESS_ERROR_NO);
+}
+
+
+int32_t movenet_heatmap_max_int8(spe_movenet_pp_in_int8_t *pInput,
+                                 spe_pp_out_t *pOutput,
+                                 const spe_movenet_pp_static_param_t *pInput_static_param)
+{
+  int16_t proba[AI_VISION_MODELS_MAXI_COL_BLOCK];
+  uint16_t index[AI_VISION_MODELS_MAXI_COL_BLOCK];
+  uint32_t width = pInput_static_param->heatmap_width;
+  uint32_t height = pInput_static_param->heatmap_height;
+  int32_t nb_keypoints = pInput_static_param->nb_keypoints;
+  int32_t row_stride = width * nb_keypoints;
+  float32_t scale = pInput_static_param->raw_output_scale;
+  int32_t zero_point = pInput_static_param->raw_output_zero_point;
+
+  for (int32_t k0 = 0; k0 < nb_keypoints; k0 += AI_VISION_MODELS_MAXI_COL_BLOCK)
+  {
+    uint32_t nb_cols = MIN(AI_VISION_MODELS_MAXI_COL_BLOCK, nb_keypoints - k0);
+
+    /* Heat maps are interleaved: argmax of all the keypoints in a single contiguous pass */
+    vision_models_maxi_col_is8ou16(&pInput->inBuff[k0],
+                                   width * height,
+                                   nb_keypoints,
+                                   nb_cols,
+                                   proba,
+                                   index);
+
+    for (uint32_t k = 0; k < nb_cols; k++)
+    {
+      int8_t *pPeak = &pInput->inBuff[index[k] * nb_keypoints + k0 + k];
+      float32_t x_offset = 0.0f;
+      float32_t y_offset = 0.0f;
+
+      /* The zero point cancels out of the offset, the scale is a common factor */
+      if (pInput_static_param->subpixel_refine)
+      {
+        if ((index[k] % width > 0) && (index[k] % width < width - 1))
+        {
+          x_offset = movenet_peak_offset(pPeak[-nb_keypoints], *pPeak, pPeak[nb_keypoints]);
+        }
+        if ((index[k] / width > 0) && (index[k] / width < height - 1))
+        {
+          y_offset = movenet_peak_offset(pPeak[-row_stride], *pPeak, pPeak[row_stride]);
+        }
+      }
+      movenet_set_keypoint(&pOutput->pOutBuff[k0 + k], index[k], scale * (proba[k] - zero_point),
+                           x_offset, y_offset, pInput_static_param);
+    }
   }
 
   return (AI_SPE_POSTPROCESS_ERROR_NO);
@@ -76,7 +152,7 @@ int32_t movenet_heatmap_max(spe_movenet_pp_in_t *pInput,
 int32_t spe_movenet_pp_reset(spe_movenet_pp_static_param_t *pInput_static_param)
 {
   /* Initializations */
-  // pInput_static_param->... no initialization
+  (void)pInput_static_param;   // pInput_static_param->... no initialization
 
 	return (AI_SPE_POSTPROCESS_ERROR_NO);
 }
@@ -84,7 +160,7 @@ int32_t spe_movenet_pp_reset(spe_movenet_pp_static_param_t *pInput_static_param)
 
 int32_t spe_movenet_pp_process(spe_movenet_pp_in_t *pInput,
                                      spe_pp_out_t *pOutput,
-                                     spe_movenet_pp_static_param_t *pInput_static_param)
+                                     const spe_movenet_pp_static_param_t *pInput_static_param)
 {
     int32_t error   = AI_SPE_POSTPROCESS_ERROR_NO;
 
@@ -95,3 +171,18 @@ int32_t spe_movenet_pp_process(spe_movenet_pp_in_t *pInput,
 
     return (error);
 }
+
+
+int32_t spe_movenet_pp_process_int8(spe_movenet_pp_in_int8_t *pInput,
+                                    spe_pp_out_t *pOutput,
+                                    const spe_movenet_pp_static_param_t *pInput_static_param)
+{
+    int32_t error   = AI_SPE_POSTPROCESS_ERROR_NO;
+
+     /* Extracts max value and indexes of each heatmap */
+    error = movenet_heatmap_max_int8(pInput,
+                                     pOutput,
+                                     pInput_static_param);
+
+    return (error);
+}
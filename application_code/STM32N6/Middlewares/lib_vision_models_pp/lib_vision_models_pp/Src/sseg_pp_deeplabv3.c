@@ -10,273 +10,230 @@
 #include "sseg_deeplabv3_pp_if.h"
 #include "vision_models_pp.h"
 
-#if 0 // Not used
-int32_t sseg_deeplabv3_pp_argmax_to_colormap(sseg_deeplabv3_pp_in_t *pInput,
-                                    sseg_pp_out_t *pOutput,
-                                    sseg_deeplabv3_pp_static_param_t *pInput_static_param)
-{
-  int32_t error   = AI_SSEG_POSTPROCESS_ERROR_NO;
-  uint32_t nb_classes = pInput_static_param->nb_classes;
-  uint8_t *out = pOutput->pOutBuff;
+/* Output pixels processed together: argmax of the tile, then the tile is written in the
+ * output format and accounted in the class statistics while its indexes are in cache */
+#define AI_SSEG_DEEPLABV3_PP_TILE    (32)
 
 
-  switch (pInput->type) {
-  case AI_SSEG_DATA_FLOAT:
-    {
-      float32_t *pSrc = (float32_t *)pInput->pRawData;
-      uint32_t _index_a[4];
-      float32_t _maxim_a[4];
-        for (size_t i = 0; i < (pInput_static_param->width * pInput_static_param->height) >> 2; i++)
-        {
-            vision_models_maxi_p_if32ou32(pSrc, nb_classes, nb_classes, _maxim_a, _index_a, 4);
-            pSrc+=4*nb_classes;
-            for (int p = 0; p < 4; p++) {
-                memcpy(out, &pInput_static_param->color_map[_index_a[p]], 3 * sizeof(uint8_t));
-                out+=3 * sizeof(uint8_t);
-            }
-        }
-        int remaing = (pInput_static_param->width * pInput_static_param->height) & 3;
-        while(remaing-- > 0) {
-          uint32_t index;
-          float32_t maxim;
-          vision_models_maxi_if32ou32(pSrc, nb_classes, &maxim, &index);
-          memcpy(out, &pInput_static_param->color_map[index], 3 * sizeof(uint8_t));
-          out+=3 * sizeof(uint8_t);
-        }
-    }
-    break;
-  case AI_SSEG_DATA_UINT8:
-    {
-      uint8_t *pSrc = (uint8_t *)pInput->pRawData;
-      if (nb_classes < 256) {
-        uint8_t _index_a[16];
-        uint8_t _maxim_a[16];
-        for (size_t i = 0; i < (pInput_static_param->width * pInput_static_param->height) >> 4; i++)
-        {
-            vision_models_maxi_p_iu8ou8(pSrc, nb_classes, nb_classes, _maxim_a, _index_a, 4);
-            pSrc+=16*nb_classes;
-            for (int p = 0; p < 16; p++) {
-                memcpy(out, &pInput_static_param->color_map[_index_a[p]], 3 * sizeof(uint8_t));
-                out+=3 * sizeof(uint8_t);
-            }
-        }
-        int remaing = (pInput_static_param->width * pInput_static_param->height) & 15;
-        while(remaing-- > 0) {
-          uint8_t index;
-          uint8_t maxim;
-          vision_models_maxi_iu8ou8(pSrc, nb_classes, &maxim, &index);
-          memcpy(out, &pInput_static_param->color_map[index], 3 * sizeof(uint8_t));
-          out+=3 * sizeof(uint8_t);
-        }
-      } else {
-        uint16_t _index_a[8];
-        uint8_t _maxim_a[8];
-        for (size_t i = 0; i < (pInput_static_param->width * pInput_static_param->height) >> 3; i++)
-        {
-            vision_models_maxi_p_iu8ou16(pSrc, nb_classes, nb_classes, _maxim_a, _index_a, 4);
-            pSrc+=8*nb_classes;
-            for (int p = 0; p < 8; p++) {
-                memcpy(out, &pInput_static_param->color_map[_index_a[p]], 3 * sizeof(uint8_t));
-                out+=3 * sizeof(uint8_t);
-            }
-        }
-        int remaing = (pInput_static_param->width * pInput_static_param->height) & 7;
-        while(remaing-- > 0) {
-          uint16_t index;
-          uint8_t maxim;
-          vision_models_maxi_iu8ou16(pSrc, nb_classes, &maxim, &index);
-          memcpy(out, &pInput_static_param->color_map[index], 3 * sizeof(uint8_t));
-          out+=3 * sizeof(uint8_t);
-        }
-      }
-    }
-    break;
-  default:
-    error = AI_SSEG_POSTPROCESS_ERROR;
-  }
-  return error;
+static uint16_t sseg_deeplabv3_pp_rgb565(uint32_t argb)
+{
+  return (uint16_t)(((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 3) & 0x001F));
+}
+
+static uint16_t sseg_deeplabv3_pp_argb4444(uint32_t argb)
+{
+  return (uint16_t)(((argb >> 16) & 0xF000) | ((argb >> 12) & 0x0F00) |
+                    ((argb >> 8) & 0x00F0) | ((argb >> 4) & 0x000F));
 }
-#endif
 
-int32_t sseg_deeplabv3_pp_argmax(sseg_deeplabv3_pp_in_t *pInput,
-                                 sseg_pp_out_t          *pOutput,
-                                 sseg_deeplabv3_pp_static_param_t *pInput_static_param)
+/* Class index of nb_pix pixels spaced by offset elements */
+static void sseg_deeplabv3_pp_argmax_tile(void *pSrc,
+                                          uint32_t nb_pix,
+                                          uint32_t offset,
+                                          uint16_t *pIndex,
+                                          const sseg_deeplabv3_pp_static_param_t *pInput_static_param)
 {
-  int32_t error   = AI_SSEG_POSTPROCESS_ERROR_NO;
   uint32_t nb_classes = pInput_static_param->nb_classes;
 
   switch (pInput_static_param->type) {
   case AI_SSEG_DATA_FLOAT:
     {
-      float32_t *pSrc = (float32_t *)pInput->pRawData;
-      int32_t loop = pInput_static_param->width * pInput_static_param->height;
+      float32_t *pRaw = (float32_t *)pSrc;
       float32_t _maxim_a[4];
-      if (nb_classes < 256) {
-        uint8_t *out = (uint8_t *)pOutput->pOutBuff;
-        while(loop > 0)
-        {
-            vision_models_maxi_p_if32ou8(pSrc, nb_classes, nb_classes, _maxim_a, out, 4);
-            pSrc+= 4*nb_classes;
-            out += 4;
-            loop-=4;
-        }
-      } else {
-        uint16_t *out = (uint16_t *)pOutput->pOutBuff;
-        while(loop > 0)
-        {
-            vision_models_maxi_p_if32ou16(pSrc, nb_classes, nb_classes, _maxim_a, (uint16_t *)out, 4);
-            pSrc+= 4*nb_classes;
-            out += 4;
-            loop-=4;
-        }
+      for (uint32_t i = 0; i < nb_pix; i += 4)
+      {
+        vision_models_maxi_p_if32ou16(pRaw + i * offset, nb_classes, offset, _maxim_a, &pIndex[i], nb_pix - i);
       }
     }
     break;
   case AI_SSEG_DATA_UINT8:
     {
-      uint8_t *pSrc = (uint8_t *)pInput->pRawData;
-      int32_t loop = pInput_static_param->width * pInput_static_param->height;
+      uint8_t *pRaw = (uint8_t *)pSrc;
       uint8_t _maxim_a[16];
       if (nb_classes < UCHAR_MAX) {
-        uint8_t *out = (uint8_t *)pOutput->pOutBuff;
-        while(loop > 0)
+        uint8_t _index_a[16];
+        for (uint32_t i = 0; i < nb_pix; i += 16)
         {
-            vision_models_maxi_p_iu8ou8(pSrc, nb_classes, nb_classes, _maxim_a, out, 16);
-            pSrc+=16*nb_classes;
-            out +=16;
-            loop-=16;
+          uint32_t nb = MIN(16, nb_pix - i);
+          vision_models_maxi_p_iu8ou8(pRaw + i * offset, nb_classes, offset, _maxim_a, _index_a, nb);
+          for (uint32_t k = 0; k < nb; k++) {
+            pIndex[i + k] = _index_a[k];
+          }
         }
       } else {
-        uint16_t *out = (uint16_t *)pOutput->pOutBuff;
-        while(loop > 0)
+        for (uint32_t i = 0; i < nb_pix; i += 8)
         {
-            vision_models_maxi_p_iu8ou16(pSrc, nb_classes, nb_classes, _maxim_a, out, 8);
-            pSrc+=8*nb_classes;
-            out +=8;
-            loop-=8;
+          vision_models_maxi_p_iu8ou16(pRaw + i * offset, nb_classes, offset, _maxim_a, &pIndex[i], nb_pix - i);
         }
       }
     }
     break;
   case AI_SSEG_DATA_INT8:
     {
-      int8_t *pSrc = (int8_t *)pInput->pRawData;
-      int32_t loop = pInput_static_param->width * pInput_static_param->height;
+      int8_t *pRaw = (int8_t *)pSrc;
       int8_t _maxim_a[16];
       if (nb_classes < UCHAR_MAX) {
-        uint8_t *out = (uint8_t *)pOutput->pOutBuff;
-        while(loop > 0)
+        uint8_t _index_a[16];
+        for (uint32_t i = 0; i < nb_pix; i += 16)
         {
-            vision_models_maxi_p_is8ou8(pSrc, nb_classes, nb_classes, _maxim_a, out, 16);
-            pSrc+=16*nb_classes;
-            out +=16;
-            loop-=16;
+          uint32_t nb = MIN(16, nb_pix - i);
+          vision_models_maxi_p_is8ou8(pRaw + i * offset, nb_classes, offset, _maxim_a, _index_a, nb);
+          for (uint32_t k = 0; k < nb; k++) {
+            pIndex[i + k] = _index_a[k];
+          }
         }
       } else {
-        uint16_t *out = (uint16_t *)pOutput->pOutBuff;
-        while(loop > 0)
+        for (uint32_t i = 0; i < nb_pix; i += 8)
         {
-            vision_models_maxi_p_is8ou16(pSrc, nb_classes, nb_classes, _maxim_a, out, 8);
-            pSrc+=8*nb_classes;
-            out +=8;
-            loop-=8;
+          vision_models_maxi_p_is8ou16(pRaw + i * offset, nb_classes, offset, _maxim_a, &pIndex[i], nb_pix - i);
         }
       }
     }
     break;
   default:
-    error = AI_SSEG_POSTPROCESS_ERROR;
+    break;
   }
-  return error;
 }
 
-#if 0 // Not used
-int32_t sseg_deeplabv3_pp_apply_color_map(sseg_deeplabv3_pp_in_t *pInput,
-                                          sseg_pp_out_t *pOutput,
-                                          sseg_deeplabv3_pp_static_param_t *pInput_static_param)
+/* Writes the tile at (x, y) of the output map and updates the class statistics */
+static void sseg_deeplabv3_pp_emit_tile(uint16_t *pIndex,
+                                        uint32_t nb_pix,
+                                        uint32_t x,
+                                        uint32_t y,
+                                        sseg_pp_out_t *pOutput,
+                                        const sseg_deeplabv3_pp_static_param_t *pInput_static_param)
 {
-  int32_t error   = AI_SSEG_POSTPROCESS_ERROR_NO;
-  uint32_t nb_classes = pInput_static_param->nb_classes;
-  size_t width = pInput_static_param->width;
-  size_t height = pInput_static_param->height;
-  uint8_t *out = pOutput->pOutBuff;
-  int32_t loop = width * height;
-  out += 3 * sizeof(uint8_t) * (width * height - 1) ;
+  uint32_t pos = y * pInput_static_param->out_width + x;
 
-  if (nb_classes < 256) {
-    uint8_t *pIdx = (uint8_t *)pOutput->pOutBuff;
-    pIdx += loop - 1;
-    while(loop > 0) {
-        memcpy(out, &pInput_static_param->color_map[*pIdx], 3 * sizeof(uint8_t));
-        out-=3 * sizeof(uint8_t);
-        pIdx--;
-        loop--;
+  if (pInput_static_param->out_format != AI_SSEG_OUT_INDEX) {
+    uint16_t *pOut = (uint16_t *)pOutput->pOutBuff + pos;
+    for (uint32_t i = 0; i < nb_pix; i++) {
+      pOut[i] = pInput_static_param->palette[pIndex[i]];
+    }
+  } else if (pInput_static_param->nb_classes <= AI_SSEG_DEEPLABV3_PP_MAX_COLORS) {
+    uint8_t *pOut = pOutput->pOutBuff + pos;
+    for (uint32_t i = 0; i < nb_pix; i++) {
+      pOut[i] = (uint8_t)pIndex[i];
     }
   } else {
-    uint16_t *pIdx = (uint16_t *)pOutput->pOutBuff;
-    pIdx += loop - 1;
-    while(loop > 0) {
-        memcpy(out, &pInput_static_param->color_map[*pIdx], 3 * sizeof(uint8_t));
-        out -=3 * sizeof(uint8_t);
-        pIdx--;
+    memcpy((uint16_t *)pOutput->pOutBuff + pos, pIndex, nb_pix * sizeof(uint16_t));
+  }
+
+  if ((pOutput->pClass_hist == NULL) && (pOutput->pClass_extents == NULL)) {
+    return;
+  }
+  /* Segmentation maps are made of long runs of the same class: one update per run */
+  uint32_t i = 0;
+  while (i < nb_pix) {
+    uint16_t class_index = pIndex[i];
+    uint32_t end = i + 1;
+    while ((end < nb_pix) && (pIndex[end] == class_index)) {
+      end++;
     }
+    if (pOutput->pClass_hist) {
+      pOutput->pClass_hist[class_index] += end - i;
+    }
+    if (pOutput->pClass_extents) {
+      sseg_pp_extent_t *pExtent = &pOutput->pClass_extents[class_index];
+      pExtent->x_min = MIN(pExtent->x_min, x + i);
+      pExtent->x_max = MAX(pExtent->x_max, x + end - 1);
+      pExtent->y_min = MIN(pExtent->y_min, y);
+      pExtent->y_max = MAX(pExtent->y_max, y);
+    }
+    i = end;
   }
-  return error;
 }
-#endif
-
 
 
 /* ----------------------       Exported routines      ---------------------- */
 
 int32_t sseg_deeplabv3_pp_reset(sseg_deeplabv3_pp_static_param_t *pInput_static_param)
 {
-    /* Initializations */
-    //sseg_deeplabv3_pp_static_param_t->... = 0;
+  if (pInput_static_param->out_step == 0) {
+    pInput_static_param->out_step = 1;
+  }
+  pInput_static_param->out_width = (pInput_static_param->width + pInput_static_param->out_step - 1) /
+                                   pInput_static_param->out_step;
+  pInput_static_param->out_height = (pInput_static_param->height + pInput_static_param->out_step - 1) /
+                                    pInput_static_param->out_step;
+
+  if (pInput_static_param->out_format != AI_SSEG_OUT_INDEX) {
+    if ((pInput_static_param->color_map == NULL) ||
+        (pInput_static_param->nb_classes > AI_SSEG_DEEPLABV3_PP_MAX_COLORS)) {
+      return (AI_SSEG_POSTPROCESS_ERROR);
+    }
+    for (uint32_t i = 0; i < pInput_static_param->nb_classes; i++) {
+      uint32_t argb = pInput_static_param->color_map[i];
+      pInput_static_param->palette[i] = (pInput_static_param->out_format == AI_SSEG_OUT_RGB565) ?
+                                        sseg_deeplabv3_pp_rgb565(argb) : sseg_deeplabv3_pp_argb4444(argb);
+    }
+  }
 
-    return (AI_SSEG_POSTPROCESS_ERROR_NO);
+  return (AI_SSEG_POSTPROCESS_ERROR_NO);
 }
 
 
-int32_t sseg_deeplabv3_pp_process(sseg_deeplabv3_pp_in_t *pInput,
-                                      sseg_pp_out_t *pOutput,
-                                      sseg_deeplabv3_pp_static_param_t *pInput_static_param)
+int32_t sseg_deeplabv3_pp_process_rows(sseg_deeplabv3_pp_in_t *pInput,
+                                       sseg_pp_out_t *pOutput,
+                                       const sseg_deeplabv3_pp_static_param_t *pInput_static_param,
+                                       uint32_t first_row,
+                                       uint32_t nb_rows)
 {
-  int32_t error   = AI_SSEG_POSTPROCESS_ERROR_NO;
-
-#if 0
- if (pInput_static_param->color_map) {
-  /* Call argmax and directly generate colormap */
-  error = sseg_deeplabv3_pp_argmax_to_colormap(pInput,
-                                                  pOutput,
-                                                  pInput_static_param);
-
-
- }
-#else
-  /* Call argmax */
-  error = sseg_deeplabv3_pp_argmax(pInput,
-                                   pOutput,
-                                   pInput_static_param);
+  uint32_t nb_classes = pInput_static_param->nb_classes;
+  uint32_t step = pInput_static_param->out_step;
+  uint32_t last_row = MIN(first_row + nb_rows, pInput_static_param->height);
+  uint32_t elem_size;
+  uint16_t _index_a[AI_SSEG_DEEPLABV3_PP_TILE];
 
-#if 0
- if (pInput_static_param->color_map) {
-  if (error != AI_SSEG_POSTPROCESS_ERROR_NO) {
-    return (error);
+  switch (pInput_static_param->type) {
+  case AI_SSEG_DATA_FLOAT:
+    elem_size = sizeof(float32_t);
+    break;
+  case AI_SSEG_DATA_UINT8:
+  case AI_SSEG_DATA_INT8:
+    elem_size = sizeof(uint8_t);
+    break;
+  default:
+    return (AI_SSEG_POSTPROCESS_ERROR);
   }
 
-  /* Then apply color map */
-  error = sseg_deeplabv3_pp_apply_color_map(pInput,
-                                               pOutput,
-                                               pInput_static_param);
- }
+  if (first_row == 0) {
+    if (pOutput->pClass_hist) {
+      memset(pOutput->pClass_hist, 0, nb_classes * sizeof(uint32_t));
+    }
+    if (pOutput->pClass_extents) {
+      for (uint32_t i = 0; i < nb_classes; i++) {
+        pOutput->pClass_extents[i].x_min = UINT16_MAX;
+        pOutput->pClass_extents[i].y_min = UINT16_MAX;
+        pOutput->pClass_extents[i].x_max = 0;
+        pOutput->pClass_extents[i].y_max = 0;
+      }
+    }
+  }
 
-  if (error != AI_SSEG_POSTPROCESS_ERROR_NO) {
-    return (error);
+  /* First row of the output grid in the tile */
+  uint32_t row = ((first_row + step - 1) / step) * step;
+  uint32_t offset = step * nb_classes;
+
+  for (; row < last_row; row += step) {
+    uint8_t *pRow = (uint8_t *)pInput->pRawData + (size_t)row * pInput_static_param->width * nb_classes * elem_size;
+    for (uint32_t x = 0; x < pInput_static_param->out_width; x += AI_SSEG_DEEPLABV3_PP_TILE) {
+      uint32_t nb_pix = MIN(AI_SSEG_DEEPLABV3_PP_TILE, pInput_static_param->out_width - x);
+      sseg_deeplabv3_pp_argmax_tile(pRow + (size_t)x * offset * elem_size, nb_pix, offset, _index_a,
+                                    pInput_static_param);
+      sseg_deeplabv3_pp_emit_tile(_index_a, nb_pix, x, row / step, pOutput, pInput_static_param);
+    }
   }
-#endif
-#endif
-    return (error);
+
+  return (AI_SSEG_POSTPROCESS_ERROR_NO);
 }
 
 
+int32_t sseg_deeplabv3_pp_process(sseg_deeplabv3_pp_in_t *pInput,
+                                      sseg_pp_out_t *pOutput,
+                                      const sseg_deeplabv3_pp_static_param_t *pInput_static_param)
+{
+  return sseg_deeplabv3_pp_process_rows(pInput, pOutput, pInput_static_param,
+                                        0, pInput_static_param->height);
+}
+
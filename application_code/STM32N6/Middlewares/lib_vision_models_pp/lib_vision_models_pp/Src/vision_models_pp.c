@@ -169,64 +169,64 @@ void vision_models_maxi_p_if32ou32(float32_t *arr, uint32_t len_arr, uint32_t of
   parallelize = MIN(4, parallelize);
   for (uint32_t k = 0; k < parallelize; k++)
   {
-    *index = 0;
-    *maxim = arr[k*offset];
+    float32_t *pArr = &arr[k*offset];
+    float32_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
     for (uint32_t i = 1; i < len_arr; i++)
     {
-      if (arr[k*offset+i] > *maxim)
+      if (pArr[i] > max_val)
       {
-        //printf("New max %f vs %f -> [%d] %f\r\n",arr[k*offset+i], *maxim,i,arr[k*offset+i]);
-        *maxim = arr[k*offset+i];
-        *index = i;
+        max_val = pArr[i];
+        max_idx = i;
       }
     }
-    maxim++;
-    index++;
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
 void vision_models_maxi_p_if32ou16(float32_t *arr, uint32_t len_arr, uint16_t offset, float32_t *maxim, uint16_t *index, uint32_t parallelize)
 {
   parallelize = MIN(4, parallelize);
-  for (uint16_t k = 0; k < parallelize; k++)
+  for (uint32_t k = 0; k < parallelize; k++)
   {
-    *index = 0;
-    *maxim = arr[k*offset];
+    float32_t *pArr = &arr[k*offset];
+    float32_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-    for (uint16_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
     {
-      if (arr[k*offset+i] > *maxim)
+      if (pArr[i] > max_val)
       {
-        //printf("New max %f vs %f -> [%d] %f\r\n",arr[k*offset+i], *maxim,i,arr[k*offset+i]);
-        *maxim = arr[k*offset+i];
-        *index = i;
+        max_val = pArr[i];
+        max_idx = i;
       }
     }
-    maxim++;
-    index++;
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
 void vision_models_maxi_p_if32ou8(float32_t *arr, uint32_t len_arr, uint32_t offset, float32_t *maxim, uint8_t *index, uint32_t parallelize)
 {
   parallelize = MIN(4, parallelize);
-  for (uint8_t k = 0; k < parallelize; k++)
+  for (uint32_t k = 0; k < parallelize; k++)
   {
-    *index = 0;
-    *maxim = arr[k*offset];
+    float32_t *pArr = &arr[k*offset];
+    float32_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-    for (uint8_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
     {
-      if (arr[k*offset+i] > *maxim)
+      if (pArr[i] > max_val)
       {
-        //printf("New max %f vs %f -> [%d] %f\r\n",arr[k*offset+i], *maxim,i,arr[k*offset+i]);
-        *maxim = arr[k*offset+i];
-        *index = i;
+        max_val = pArr[i];
+        max_idx = i;
       }
     }
-    maxim++;
-    index++;
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
@@ -460,7 +460,7 @@ void vision_models_maxi_p_iu8ou16(uint8_t *arr, uint32_t len_arr, uint32_t offse
   uint16x8_t u16x8_idx = vdupq_n_u16(0);
   uint16x8_t u16x8_offset = vidupq_n_u16(0,1) * (uint16_t)offset;
 
-  for (uint8_t i = 0; i < len_arr; i++)
+  for (uint32_t i = 0; i < len_arr; i++)
   {
     // load up to 16 int8
     uint16x8_t u16x8_val = vldrbq_gather_offset_z_u16(arr, u16x8_offset, p);
@@ -489,7 +489,7 @@ void vision_models_maxi_p_is8ou16(int8_t *arr, uint32_t len_arr, uint32_t offset
   uint16x8_t u16x8_idx = vdupq_n_u16(0);
   uint16x8_t u16x8_offset = vidupq_n_u16(0,1) * (uint16_t)offset;
 
-  for (uint8_t i = 0; i < len_arr; i++)
+  for (uint32_t i = 0; i < len_arr; i++)
   {
     // load up to 16 int8
     int16x8_t s16x8_val = vldrbq_gather_offset_z_s16(arr, u16x8_offset, p);
@@ -556,116 +556,88 @@ void vision_models_maxi_iu8ou16(uint8_t *arr, uint32_t len_arr, uint8_t *maxim,
 void vision_models_maxi_p_iu8ou8(uint8_t *arr, uint32_t len_arr, uint32_t offset, uint8_t *maxim, uint8_t *index, uint32_t parallelize)
 {
   parallelize = MIN(16, parallelize);
-  if(parallelize*offset < UCHAR_MAX) {
-  for (uint8_t k = 0; k < parallelize; k++)
-    {
-      *index = 0;
-      *maxim = arr[k*offset];
+  for (uint32_t k = 0; k < parallelize; k++)
+  {
+    uint8_t *pArr = &arr[k*offset];
+    uint8_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-      for (uint8_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
+    {
+      if (pArr[i] > max_val)
       {
-        if (arr[k*offset+i] > *maxim)
-        {
-          *maxim = arr[k*offset+i];
-          *index = i;
-        }
+        max_val = pArr[i];
+        max_idx = i;
       }
-      maxim++;
-      index++;
-    }
-  } else {
-    uint16_t _tmpIdx[8];
-    uint16_t _parallelize = MIN(8,parallelize);
-    vision_models_maxi_p_iu8ou16(arr,len_arr,offset,maxim,_tmpIdx,_parallelize);
-    maxim+=_parallelize;
-    for ( uint16_t i = 0; i <_parallelize; i++) {
-      *index++ = _tmpIdx[i];
-    }
-    parallelize-=_parallelize;
-    arr+=_parallelize*offset;
-    vision_models_maxi_p_iu8ou16(arr,len_arr,offset,maxim,_tmpIdx,parallelize);
-    for ( int i = 0; i < parallelize; i++) {
-      *index++ = _tmpIdx[i];
     }
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
 void vision_models_maxi_p_is8ou8(int8_t *arr, uint32_t len_arr, uint32_t offset, int8_t *maxim, uint8_t *index, uint32_t parallelize)
 {
   parallelize = MIN(16, parallelize);
-  if(parallelize*offset < UCHAR_MAX) {
-  for (uint8_t k = 0; k < parallelize; k++)
-    {
-      *index = 0;
-      *maxim = arr[k*offset];
+  for (uint32_t k = 0; k < parallelize; k++)
+  {
+    int8_t *pArr = &arr[k*offset];
+    int8_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-      for (uint8_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
+    {
+      if (pArr[i] > max_val)
       {
-        if (arr[k*offset+i] > *maxim)
-        {
-          *maxim = arr[k*offset+i];
-          *index = i;
-        }
+        max_val = pArr[i];
+        max_idx = i;
       }
-      maxim++;
-      index++;
-    }
-  } else {
-    uint16_t _tmpIdx[8];
-    uint16_t _parallelize = MIN(8,parallelize);
-    vision_models_maxi_p_is8ou16(arr,len_arr,offset,maxim,_tmpIdx,_parallelize);
-    maxim+=_parallelize;
-    for ( uint16_t i = 0; i <_parallelize; i++) {
-      *index++ = _tmpIdx[i];
-    }
-    parallelize-=_parallelize;
-    arr+=_parallelize*offset;
-    vision_models_maxi_p_is8ou16(arr,len_arr,offset,maxim,_tmpIdx,parallelize);
-    for ( int i = 0; i < parallelize; i++) {
-      *index++ = _tmpIdx[i];
     }
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
 void vision_models_maxi_p_iu8ou16(uint8_t *arr, uint32_t len_arr, uint32_t offset, uint8_t *maxim, uint16_t *index, uint32_t parallelize)
 {
   parallelize = MIN(8, parallelize);
-  for (uint8_t k = 0; k < parallelize; k++)
+  for (uint32_t k = 0; k < parallelize; k++)
   {
-    *index = 0;
-    *maxim = arr[k*offset];
+    uint8_t *pArr = &arr[k*offset];
+    uint8_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-    for (uint16_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
     {
-      if (arr[k*offset+i] > *maxim)
+      if (pArr[i] > max_val)
       {
-        *maxim = arr[k*offset+i];
-        *index = i;
+        max_val = pArr[i];
+        max_idx = i;
       }
     }
-    maxim++;
-    index++;
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
 void vision_models_maxi_p_is8ou16(int8_t *arr, uint32_t len_arr, uint32_t offset, int8_t *maxim, uint16_t *index, uint32_t parallelize)
 {
   parallelize = MIN(8, parallelize);
-  for (uint8_t k = 0; k < parallelize; k++)
+  for (uint32_t k = 0; k < parallelize; k++)
   {
-    *index = 0;
-    *maxim = arr[k*offset];
+    int8_t *pArr = &arr[k*offset];
+    int8_t max_val = pArr[0];
+    uint32_t max_idx = 0;
 
-    for (uint16_t i = 1; i < len_arr; i++)
+    for (uint32_t i = 1; i < len_arr; i++)
     {
-      if (arr[k*offset+i] > *maxim)
+      if (pArr[i] > max_val)
       {
-        *maxim = arr[k*offset+i];
-        *index = i;
+        max_val = pArr[i];
+        max_idx = i;
       }
     }
-    maxim++;
-    index++;
+    maxim[k] = max_val;
+    index[k] = max_idx;
   }
 
 }
@@ -877,27 +849,129 @@ void vision_models_maxi_tr_is8ou16(int8_t *arr, uint32_t len_arr, uint32_t offse
   }
 }
 
+/* return max value and it's index of each column of a row-major array, in a single pass on the rows:
+ * each row is read contiguously, maxim and index hold the running extrema of the nb_cols columns */
+#ifdef AI_SPE_MOVENET_PP_MVEF_OPTIM
+void vision_models_maxi_col_if32ou32(float32_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, float32_t *maxim, uint32_t *index)
+{
+  memcpy(maxim, arr, nb_cols * sizeof(float32_t));
+  memset(index, 0, nb_cols * sizeof(uint32_t));
+
+  for (uint32_t i = 1; i < nb_rows; i++)
+  {
+    float32_t *pSrc = &arr[i * row_stride];
+    uint32x4_t u32x4_idx = vdupq_n_u32(i);
+    int32_t iter = nb_cols;
+    uint32_t k = 0;
+
+    while (iter > 0)
+    {
+      mve_pred16_t p = vctp32q(iter);
+      // load up to 4 float32_t of the row and the running max of their columns
+      float32x4_t f32x4_val = vldrwq_z_f32(&pSrc[k], p);
+      float32x4_t f32x4_max_val = vldrwq_z_f32(&maxim[k], p);
+      // Compare according to p to create p0
+      mve_pred16_t p0 = vcmpgtq_m_f32(f32x4_val, f32x4_max_val, p);
+
+      /* according to p0: store the new extrema and their index */
+      vstrwq_p_f32(&maxim[k], f32x4_val, p0);
+      vstrwq_p_u32(&index[k], u32x4_idx, p0);
+      k += 4;
+      iter -= 4;
+    }
+  }
+}
+#else
+void vision_models_maxi_col_if32ou32(float32_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, float32_t *maxim, uint32_t *index)
+{
+  memcpy(maxim, arr, nb_cols * sizeof(float32_t));
+  memset(index, 0, nb_cols * sizeof(uint32_t));
+
+  for (uint32_t i = 1; i < nb_rows; i++)
+  {
+    float32_t *pSrc = &arr[i * row_stride];
+
+    for (uint32_t k = 0; k < nb_cols; k++)
+    {
+      if (pSrc[k] > maxim[k])
+      {
+        maxim[k] = pSrc[k];
+        index[k] = i;
+      }
+    }
+  }
+}
+#endif
+/* int8 values are kept in int16 so that values and indexes share the MVE lanes */
+#ifdef AI_SPE_MOVENET_PP_MVEI_OPTIM
+void vision_models_maxi_col_is8ou16(int8_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, int16_t *maxim, uint16_t *index)
+{
+  for (uint32_t k = 0; k < nb_cols; k++)
+  {
+    maxim[k] = arr[k];
+    index[k] = 0;
+  }
+
+  for (uint32_t i = 1; i < nb_rows; i++)
+  {
+    int8_t *pSrc = &arr[i * row_stride];
+    uint16x8_t u16x8_idx = vdupq_n_u16((uint16_t) i);
+    int32_t iter = nb_cols;
+    uint32_t k = 0;
+
+    while (iter > 0)
+    {
+      mve_pred16_t p = vctp16q(iter);
+      // load up to 8 int8 of the row, widened to int16, and the running max of their columns
+      int16x8_t s16x8_val = vldrbq_z_s16(&pSrc[k], p);
+      int16x8_t s16x8_max_val = vldrhq_z_s16(&maxim[k], p);
+      // Compare according to p to create p0
+      mve_pred16_t p0 = vcmpgtq_m_s16(s16x8_val, s16x8_max_val, p);
+
+      /* according to p0: store the new extrema and their index */
+      vstrhq_p_s16(&maxim[k], s16x8_val, p0);
+      vstrhq_p_u16(&index[k], u16x8_idx, p0);
+      k += 8;
+      iter -= 8;
+    }
+  }
+}
+#else
+/* Without MVE the running extrema of a row pass stay in memory: one strided scan per column,
+ * as vision_models_maxi_tr_is8ou16, is as fast and does not depend on the compiler */
+void vision_models_maxi_col_is8ou16(int8_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, int16_t *maxim, uint16_t *index)
+{
+  for (uint32_t k = 0; k < nb_cols; k++)
+  {
+    int8_t max_val;
+
+    vision_models_maxi_tr_is8ou16(&arr[k], nb_rows, row_stride, &max_val, &index[k]);
+    maxim[k] = max_val;
+  }
+}
+#endif
+
 float32_t vision_models_sigmoid_f(float32_t x)
 {
   return (1.0f / (1.0f + expf(-x)));
 }
 
 
-void vision_models_softmax_f(float32_t *input_x, float32_t *output_x, int32_t len_x, float32_t *tmp_x)
+/* Output can be the input itself, each element is only read before being written */
+void vision_models_softmax_f(float32_t *input_x, float32_t *output_x, int32_t len_x)
 {
   float32_t sum = 0;
 
   for (int32_t i = 0; i < len_x; ++i)
   {
-    tmp_x[i] = expf(input_x[i]);
-    sum = sum + tmp_x[i];
+    output_x[i] = expf(input_x[i]);
+    sum = sum + output_x[i];
   }
   sum = 1.0f / sum;
   for (int32_t i = 0; i < len_x; ++i)
   {
-    tmp_x[i] *= sum;
+    output_x[i] *= sum;
   }
-  memcpy(output_x, tmp_x, len_x * sizeof(float32_t));
 }
 
 
@@ -988,6 +1062,721 @@ float32_t vision_models_box_iou_is8(int8_t *a, int8_t *b, int8_t zp)
   float32_t ret = ((float32_t)I / (float32_t)U);
   return ret;
 }
+//***************nms ********
+/* Common head of the detection records handled by the NMS engine */
+typedef struct
+{
+  float32_t box[4];
+  float32_t conf;
+  int32_t   class_index;
+} vision_models_nms_f32_t;
+
+typedef struct
+{
+  int8_t  box[4];
+  int8_t  conf;
+  uint8_t class_index;
+} vision_models_nms_is8_t;
+
+#define VISION_MODELS_NMS_CONF_NULL_F32     (0.0f)
+#define VISION_MODELS_NMS_CONF_NULL_S8      (-128)
+#define VISION_MODELS_NMS_SORT_INSERTION    (8)
+#define VISION_MODELS_NMS_SORT_STACK_DEPTH  (32)
+
+/* Confidence of a float record, conf_offset bytes from its start: the conf field of the
+ * engine records, or the score of one class for the per-class NMS */
+#define VISION_MODELS_NMS_CONF_F32(pRecord, conf_offset) \
+  (*(float32_t *)&((uint8_t *)(pRecord))[conf_offset])
+#define VISION_MODELS_NMS_CONF_OFFSET_F32   (4 * sizeof(float32_t))
+
+/* key is the byte offset of the confidence for the per-class sort, unused otherwise */
+typedef int32_t (*vision_models_nms_before_t)(const uint8_t *pA, const uint8_t *pB, uint32_t key);
+
+/* Sort order: class index ascending, then confidence descending */
+static int32_t vision_models_nms_before_f32(const uint8_t *pA, const uint8_t *pB, uint32_t key)
+{
+  const vision_models_nms_f32_t *a = (const vision_models_nms_f32_t *)pA;
+  const vision_models_nms_f32_t *b = (const vision_models_nms_f32_t *)pB;
+
+  (void)key;
+  if (a->class_index != b->class_index) return (a->class_index < b->class_index);
+  return (a->conf > b->conf);
+}
+
+static int32_t vision_models_nms_before_is8(const uint8_t *pA, const uint8_t *pB, uint32_t key)
+{
+  const vision_models_nms_is8_t *a = (const vision_models_nms_is8_t *)pA;
+  const vision_models_nms_is8_t *b = (const vision_models_nms_is8_t *)pB;
+
+  (void)key;
+  if (a->class_index != b->class_index) return (a->class_index < b->class_index);
+  return (a->conf > b->conf);
+}
+
+/* Sort order of the per-class NMS: score of the class at offset key descending */
+static int32_t vision_models_nms_before_score_f32(const uint8_t *pA, const uint8_t *pB, uint32_t key)
+{
+  return (VISION_MODELS_NMS_CONF_F32(pA, key) > VISION_MODELS_NMS_CONF_F32(pB, key));
+}
+
+/* Records holding an int32 or a pointer are word sized and aligned, packed int8 records
+ * are swapped byte per byte */
+static inline void vision_models_nms_swap(uint8_t *pA, uint8_t *pB, uint32_t size)
+{
+  if ((size & 3) == 0)
+  {
+    uint32_t *pA32 = (uint32_t *)pA;
+    uint32_t *pB32 = (uint32_t *)pB;
+
+    for (uint32_t w = 0; w < (size >> 2); w++)
+    {
+      uint32_t tmp = pA32[w];
+      pA32[w] = pB32[w];
+      pB32[w] = tmp;
+    }
+  }
+  else
+  {
+    for (uint32_t b = 0; b < size; b++)
+    {
+      uint8_t tmp = pA[b];
+      pA[b] = pB[b];
+      pB[b] = tmp;
+    }
+  }
+}
+
+/* In place, non recursive quick sort with a bounded stack: the larger partition is
+ * pushed and the smaller one processed first, small partitions end up in insertion sort */
+static void vision_models_nms_sort(uint8_t *pBase, uint32_t size, int32_t nb,
+                                   vision_models_nms_before_t pBefore, uint32_t key)
+{
+  int32_t stack[2 * VISION_MODELS_NMS_SORT_STACK_DEPTH];
+  int32_t top = 0;
+  int32_t lo = 0;
+  int32_t hi = nb - 1;
+
+  if (nb < 2) return;
+
+  for (;;)
+  {
+    while ((hi - lo) > VISION_MODELS_NMS_SORT_INSERTION)
+    {
+      int32_t mid = lo + ((hi - lo) >> 1);
+      int32_t i = lo;
+      int32_t j = hi + 1;
+
+      /* Median of three becomes the pivot, kept at lo during the partition */
+      if (pBefore(&pBase[mid * size], &pBase[lo * size], key)) vision_models_nms_swap(&pBase[mid * size], &pBase[lo * size], size);
+      if (pBefore(&pBase[hi * size], &pBase[lo * size], key)) vision_models_nms_swap(&pBase[hi * size], &pBase[lo * size], size);
+      if (pBefore(&pBase[hi * size], &pBase[mid * size], key)) vision_models_nms_swap(&pBase[hi * size], &pBase[mid * size], size);
+      vision_models_nms_swap(&pBase[mid * size], &pBase[lo * size], size);
+
+      for (;;)
+      {
+        do { i++; } while ((i <= hi) && pBefore(&pBase[i * size], &pBase[lo * size], key));
+        do { j--; } while (pBefore(&pBase[lo * size], &pBase[j * size], key));
+        if (i >= j) break;
+        vision_models_nms_swap(&pBase[i * size], &pBase[j * size], size);
+      }
+      vision_models_nms_swap(&pBase[lo * size], &pBase[j * size], size);
+
+      if ((j - lo) > (hi - j))
+      {
+        stack[top++] = lo;
+        stack[top++] = j - 1;
+        lo = j + 1;
+      }
+      else
+      {
+        stack[top++] = j + 1;
+        stack[top++] = hi;
+        hi = j - 1;
+      }
+    }
+
+    for (int32_t i = lo + 1; i <= hi; i++)
+    {
+      for (int32_t j = i; (j > lo) && pBefore(&pBase[j * size], &pBase[(j - 1) * size], key); j--)
+      {
+        vision_models_nms_swap(&pBase[j * size], &pBase[(j - 1) * size], size);
+      }
+    }
+
+    if (top == 0) break;
+    hi = stack[--top];
+    lo = stack[--top];
+  }
+}
+
+
+/* Suppression test of two int8 records. With a scale, the decision must be the one of the float
+ * IoU of the dequantized boxes, computed by the dequantizing paths, even when the IoU is the
+ * threshold itself. The exact IoU is the ratio of the integer intersection and union, compared
+ * in 64 bits with the threshold as num / 2^VISION_MODELS_NMS_IOU_SHIFT. The float IoU of boxes
+ * of at least one step only differs from it by rounding, about 2^-10 relative at worst, so only
+ * the pairs closer to the threshold than 2^-VISION_MODELS_NMS_IOU_MARGIN_SHIFT relative are
+ * decided by the float expression; thresholds out of [2^-6, 1] and empty boxes always are.
+ * Without scale, integer IoU. */
+#define VISION_MODELS_NMS_IOU_SHIFT         (20)
+#define VISION_MODELS_NMS_IOU_MARGIN_SHIFT  (8)
+#define VISION_MODELS_NMS_IOU_NUM_MIN       (1 << (VISION_MODELS_NMS_IOU_SHIFT - 6))
+#define VISION_MODELS_NMS_IOU_NUM_MAX       (1 << VISION_MODELS_NMS_IOU_SHIFT)
+
+typedef struct
+{
+  float32_t threshold;
+  int64_t   num;          /* threshold * 2^VISION_MODELS_NMS_IOU_SHIFT, 0 when only the float IoU is used */
+  int8_t    zero_point;
+  float32_t scale;
+} vision_models_nms_iou_is8_t;
+
+/* Kept box of the suppression loop: twice its edges and four times its area in steps from
+ * the zero point, as box_intersection_is8 / box_union_is8, and its dequantized box */
+typedef struct
+{
+  int8_t    *q;
+  int32_t   exact;        /* integer decision possible */
+  int32_t   left, right, top, bottom;
+  int32_t   area;
+  float32_t f[4];
+} vision_models_nms_box_is8_t;
+
+static inline void vision_models_nms_iou_init_is8(vision_models_nms_iou_is8_t *pIou, float32_t iou_threshold,
+                                                  int8_t zero_point, float32_t scale)
+{
+  float32_t num_f = iou_threshold * (float32_t)VISION_MODELS_NMS_IOU_NUM_MAX;
+
+  pIou->threshold = iou_threshold;
+  pIou->zero_point = zero_point;
+  pIou->scale = scale;
+  pIou->num = 0;
+  if ((scale > 0.0f) && (num_f >= (float32_t)VISION_MODELS_NMS_IOU_NUM_MIN) &&
+      (num_f <= (float32_t)VISION_MODELS_NMS_IOU_NUM_MAX))
+  {
+    pIou->num = (int64_t)(num_f + 0.5f);
+  }
+}
+
+static inline void vision_models_nms_dequantize_box_is8(const int8_t *pBox, int8_t zero_point,
+                                                        float32_t scale, float32_t *pBox_f)
+{
+  for (int32_t k = 0; k < 4; k++)
+  {
+    pBox_f[k] = scale * (float32_t)((int32_t)pBox[k] - zero_point);
+  }
+}
+
+static inline void vision_models_nms_box_init_is8(vision_models_nms_is8_t *pA,
+                                                  const vision_models_nms_iou_is8_t *pIou,
+                                                  vision_models_nms_box_is8_t *pA_box)
+{
+  int32_t x = 2 * ((int32_t)pA->box[0] - pIou->zero_point);
+  int32_t y = 2 * ((int32_t)pA->box[1] - pIou->zero_point);
+  int32_t w = (int32_t)pA->box[2] - pIou->zero_point;
+  int32_t h = (int32_t)pA->box[3] - pIou->zero_point;
+
+  pA_box->q = pA->box;
+  pA_box->exact = (pIou->num != 0) && (w > 0) && (h > 0);
+  pA_box->left = x - w;
+  pA_box->right = x + w;
+  pA_box->top = y - h;
+  pA_box->bottom = y + h;
+  pA_box->area = 4 * w * h;
+  if (pIou->scale > 0.0f)
+  {
+    vision_models_nms_dequantize_box_is8(pA->box, pIou->zero_point, pIou->scale, pA_box->f);
+  }
+}
+
+static inline int32_t vision_models_nms_suppress_is8(const vision_models_nms_box_is8_t *pA_box,
+                                                     vision_models_nms_is8_t *pB,
+                                                     const vision_models_nms_iou_is8_t *pIou)
+{
+  float32_t b_f[4];
+
+  if (pIou->scale <= 0.0f)
+  {
+    return (vision_models_box_iou_is8(pA_box->q, pB->box, pIou->zero_point) > pIou->threshold);
+  }
+
+  int32_t w = (int32_t)pB->box[2] - pIou->zero_point;
+  int32_t h = (int32_t)pB->box[3] - pIou->zero_point;
+
+  if (pA_box->exact && (w > 0) && (h > 0))
+  {
+    int32_t x = 2 * ((int32_t)pB->box[0] - pIou->zero_point);
+    int32_t y = 2 * ((int32_t)pB->box[1] - pIou->zero_point);
+    int32_t ov_w = MIN(pA_box->right, x + w) - MAX(pA_box->left, x - w);
+    int32_t ov_h = MIN(pA_box->bottom, y + h) - MAX(pA_box->top, y - h);
+
+    /* Disjoint boxes: the float IoU is at most rounding, below the threshold */
+    if ((ov_w <= 0) || (ov_h <= 0)) return 0;
+
+    /* Intersection and union in quarter steps, at most 2^20 */
+    int32_t I = ov_w * ov_h;
+    int32_t U = pA_box->area + 4 * w * h - I;
+    int64_t rhs = pIou->num * U;
+    int64_t diff = ((int64_t)I << VISION_MODELS_NMS_IOU_SHIFT) - rhs;
+    int64_t margin = rhs >> VISION_MODELS_NMS_IOU_MARGIN_SHIFT;
+
+    if (diff > margin) return 1;
+    if (diff < -margin) return 0;
+  }
+
+  vision_models_nms_dequantize_box_is8(pB->box, pIou->zero_point, pIou->scale, b_f);
+  return (vision_models_box_iou((float32_t *)pA_box->f, b_f) > pIou->threshold);
+}
+
+
+/* Exhaustive suppression of the bucket [first, last): every kept box is compared with
+ * all the lower confidence boxes of its class */
+static void vision_models_nms_bucket_f32(uint8_t *pBase, uint32_t size, int32_t first, int32_t last,
+                                         float32_t iou_threshold, int32_t max_boxes_limit, uint32_t conf_offset)
+{
+  int32_t limit_counter = 0;
+
+  for (int32_t i = first; i < last; i++)
+  {
+    vision_models_nms_f32_t *pA = (vision_models_nms_f32_t *)&pBase[i * size];
+    if (VISION_MODELS_NMS_CONF_F32(pA, conf_offset) == VISION_MODELS_NMS_CONF_NULL_F32) continue;
+
+    /* Limits detections count */
+    if (limit_counter >= max_boxes_limit)
+    {
+      VISION_MODELS_NMS_CONF_F32(pA, conf_offset) = VISION_MODELS_NMS_CONF_NULL_F32;
+      continue;
+    }
+    limit_counter++;
+
+    for (int32_t j = i + 1; j < last; j++)
+    {
+      vision_models_nms_f32_t *pB = (vision_models_nms_f32_t *)&pBase[j * size];
+      if ((VISION_MODELS_NMS_CONF_F32(pB, conf_offset) != VISION_MODELS_NMS_CONF_NULL_F32) &&
+          (vision_models_box_iou(pA->box, pB->box) > iou_threshold))
+      {
+        VISION_MODELS_NMS_CONF_F32(pB, conf_offset) = VISION_MODELS_NMS_CONF_NULL_F32;
+      }
+    }
+  }
+}
+
+static void vision_models_nms_bucket_is8(uint8_t *pBase, uint32_t size, int32_t first, int32_t last,
+                                         const vision_models_nms_iou_is8_t *pIou, int32_t max_boxes_limit)
+{
+  int32_t limit_counter = 0;
+
+  for (int32_t i = first; i < last; i++)
+  {
+    vision_models_nms_is8_t *pA = (vision_models_nms_is8_t *)&pBase[i * size];
+    if (pA->conf == VISION_MODELS_NMS_CONF_NULL_S8) continue;
+
+    /* Limits detections count */
+    if (limit_counter >= max_boxes_limit)
+    {
+      pA->conf = VISION_MODELS_NMS_CONF_NULL_S8;
+      continue;
+    }
+    limit_counter++;
+
+    vision_models_nms_box_is8_t a_box;
+    vision_models_nms_box_init_is8(pA, pIou, &a_box);
+    for (int32_t j = i + 1; j < last; j++)
+    {
+      vision_models_nms_is8_t *pB = (vision_models_nms_is8_t *)&pBase[j * size];
+      if ((pB->conf != VISION_MODELS_NMS_CONF_NULL_S8) &&
+          vision_models_nms_suppress_is8(&a_box, pB, pIou))
+      {
+        pB->conf = VISION_MODELS_NMS_CONF_NULL_S8;
+      }
+    }
+  }
+}
+
+/* Grid suppression.
+ * Greedy NMS keeps a box when no kept box of higher confidence overlaps it more than the
+ * threshold, so the bucket is walked once and each box is only tested against the kept
+ * ones. Kept boxes are moved to the front of the bucket and linked in the cell holding
+ * their center, a box can only intersect the kept boxes whose center lies within half
+ * its size plus half the largest kept size, only these cells are visited. Boxes without
+ * intersection have a null IoU, which never passes the threshold: results are the same
+ * as the exhaustive path. Kept boxes beyond the grid capacity are tested one by one. */
+#define VISION_MODELS_NMS_GRID_SIZE      (16)
+#define VISION_MODELS_NMS_GRID_MAX_KEPT  (256)
+#define VISION_MODELS_NMS_GRID_NONE      (-1)
+
+static inline int32_t vision_models_nms_grid_cell_f32(float32_t v)
+{
+  /* Normalized coordinates, out of range values land in the border cells */
+  if (v <= 0.0f) return 0;
+  if (v >= 1.0f) return (VISION_MODELS_NMS_GRID_SIZE - 1);
+  return (int32_t)(v * VISION_MODELS_NMS_GRID_SIZE);
+}
+
+static inline int32_t vision_models_nms_grid_cell_is8(int32_t v)
+{
+  /* Quantized coordinates: the grid spans the int8 range */
+  v = MAX(MIN(v, SCHAR_MAX), SCHAR_MIN);
+  return ((v - SCHAR_MIN) * VISION_MODELS_NMS_GRID_SIZE) >> 8;
+}
+
+static void vision_models_nms_grid_f32(uint8_t *pBase, uint32_t size, int32_t first, int32_t last,
+                                       float32_t iou_threshold, int32_t max_boxes_limit, uint32_t conf_offset)
+{
+  int16_t heads[VISION_MODELS_NMS_GRID_SIZE * VISION_MODELS_NMS_GRID_SIZE];
+  int16_t next[VISION_MODELS_NMS_GRID_MAX_KEPT];
+  int32_t nb_kept = 0;
+  float32_t max_w = 0.0f;
+  float32_t max_h = 0.0f;
+
+  for (int32_t c = 0; c < (VISION_MODELS_NMS_GRID_SIZE * VISION_MODELS_NMS_GRID_SIZE); c++)
+  {
+    heads[c] = VISION_MODELS_NMS_GRID_NONE;
+  }
+
+  for (int32_t i = first; i < last; i++)
+  {
+    vision_models_nms_f32_t *pA = (vision_models_nms_f32_t *)&pBase[i * size];
+    int32_t suppressed = 0;
+
+    if (VISION_MODELS_NMS_CONF_F32(pA, conf_offset) == VISION_MODELS_NMS_CONF_NULL_F32) continue;
+
+    /* Limits detections count */
+    if (nb_kept >= max_boxes_limit)
+    {
+      VISION_MODELS_NMS_CONF_F32(pA, conf_offset) = VISION_MODELS_NMS_CONF_NULL_F32;
+      continue;
+    }
+
+    /* Search window, widened by one cell to absorb rounding */
+    float32_t half_w = (MAX(pA->box[2], 0.0f) + max_w) * 0.5f;
+    float32_t half_h = (MAX(pA->box[3], 0.0f) + max_h) * 0.5f;
+    int32_t cx0 = MAX(vision_models_nms_grid_cell_f32(pA->box[0] - half_w) - 1, 0);
+    int32_t cx1 = MIN(vision_models_nms_grid_cell_f32(pA->box[0] + half_w) + 1, VISION_MODELS_NMS_GRID_SIZE - 1);
+    int32_t cy0 = MAX(vision_models_nms_grid_cell_f32(pA->box[1] - half_h) - 1, 0);
+    int32_t cy1 = MIN(vision_models_nms_grid_cell_f32(pA->box[1] + half_h) + 1, VISION_MODELS_NMS_GRID_SIZE - 1);
+
+    for (int32_t cy = cy0; (cy <= cy1) && !suppressed; cy++)
+    {
+      for (int32_t cx = cx0; (cx <= cx1) && !suppressed; cx++)
+      {
+        for (int32_t k = heads[cy * VISION_MODELS_NMS_GRID_SIZE + cx]; k != VISION_MODELS_NMS_GRID_NONE; k = next[k])
+        {
+          vision_models_nms_f32_t *pB = (vision_models_nms_f32_t *)&pBase[(first + k) * size];
+          if (vision_models_box_iou(pA->box, pB->box) > iou_threshold)
+          {
+            suppressed = 1;
+            break;
+          }
+        }
+      }
+    }
+    for (int32_t k = VISION_MODELS_NMS_GRID_MAX_KEPT; (k < nb_kept) && !suppressed; k++)
+    {
+      vision_models_nms_f32_t *pB = (vision_models_nms_f32_t *)&pBase[(first + k) * size];
+      suppressed = (vision_models_box_iou(pA->box, pB->box) > iou_threshold);
+    }
+
+    if (suppressed)
+    {
+      VISION_MODELS_NMS_CONF_F32(pA, conf_offset) = VISION_MODELS_NMS_CONF_NULL_F32;
+      continue;
+    }
+
+    /* Records between the kept ones and i are all suppressed, swapping keeps the order */
+    if (i != (first + nb_kept))
+    {
+      vision_models_nms_swap(&pBase[(first + nb_kept) * size], &pBase[i * size], size);
+      pA = (vision_models_nms_f32_t *)&pBase[(first + nb_kept) * size];
+    }
+    if (nb_kept < VISION_MODELS_NMS_GRID_MAX_KEPT)
+    {
+      int32_t c = vision_models_nms_grid_cell_f32(pA->box[1]) * VISION_MODELS_NMS_GRID_SIZE
+                  + vision_models_nms_grid_cell_f32(pA->box[0]);
+      next[nb_kept] = heads[c];
+      heads[c] = (int16_t)nb_kept;
+    }
+    max_w = MAX(max_w, pA->box[2]);
+    max_h = MAX(max_h, pA->box[3]);
+    nb_kept++;
+  }
+}
+
+static void vision_models_nms_grid_is8(uint8_t *pBase, uint32_t size, int32_t first, int32_t last,
+                                       const vision_models_nms_iou_is8_t *pIou, int32_t max_boxes_limit)
+{
+  int8_t zero_point = pIou->zero_point;
+  int16_t heads[VISION_MODELS_NMS_GRID_SIZE * VISION_MODELS_NMS_GRID_SIZE];
+  int16_t next[VISION_MODELS_NMS_GRID_MAX_KEPT];
+  int32_t nb_kept = 0;
+  int32_t max_w = 0;
+  int32_t max_h = 0;
+
+  for (int32_t c = 0; c < (VISION_MODELS_NMS_GRID_SIZE * VISION_MODELS_NMS_GRID_SIZE); c++)
+  {
+    heads[c] = VISION_MODELS_NMS_GRID_NONE;
+  }
+
+  for (int32_t i = first; i < last; i++)
+  {
+    vision_models_nms_is8_t *pA = (vision_models_nms_is8_t *)&pBase[i * size];
+    int32_t suppressed = 0;
+
+    if (pA->conf == VISION_MODELS_NMS_CONF_NULL_S8) continue;
+
+    /* Limits detections count */
+    if (nb_kept >= max_boxes_limit)
+    {
+      pA->conf = VISION_MODELS_NMS_CONF_NULL_S8;
+      continue;
+    }
+
+    /* Integer search window, exact */
+    int32_t half_w = (MAX(pA->box[2] - zero_point, 0) + max_w + 1) >> 1;
+    int32_t half_h = (MAX(pA->box[3] - zero_point, 0) + max_h + 1) >> 1;
+    int32_t cx0 = vision_models_nms_grid_cell_is8(pA->box[0] - half_w);
+    int32_t cx1 = vision_models_nms_grid_cell_is8(pA->box[0] + half_w);
+    int32_t cy0 = vision_models_nms_grid_cell_is8(pA->box[1] - half_h);
+    int32_t cy1 = vision_models_nms_grid_cell_is8(pA->box[1] + half_h);
+    vision_models_nms_box_is8_t a_box;
+
+    vision_models_nms_box_init_is8(pA, pIou, &a_box);
+
+    for (int32_t cy = cy0; (cy <= cy1) && !suppressed; cy++)
+    {
+      for (int32_t cx = cx0; (cx <= cx1) && !suppressed; cx++)
+      {
+        for (int32_t k = heads[cy * VISION_MODELS_NMS_GRID_SIZE + cx]; k != VISION_MODELS_NMS_GRID_NONE; k = next[k])
+        {
+          vision_models_nms_is8_t *pB = (vision_models_nms_is8_t *)&pBase[(first + k) * size];
+          if (vision_models_nms_suppress_is8(&a_box, pB, pIou))
+          {
+            suppressed = 1;
+            break;
+          }
+        }
+      }
+    }
+    for (int32_t k = VISION_MODELS_NMS_GRID_MAX_KEPT; (k < nb_kept) && !suppressed; k++)
+    {
+      vision_models_nms_is8_t *pB = (vision_models_nms_is8_t *)&pBase[(first + k) * size];
+      suppressed = vision_models_nms_suppress_is8(&a_box, pB, pIou);
+    }
+
+    if (suppressed)
+    {
+      pA->conf = VISION_MODELS_NMS_CONF_NULL_S8;
+      continue;
+    }
+
+    /* Records between the kept ones and i are all suppressed, swapping keeps the order */
+    if (i != (first + nb_kept))
+    {
+      vision_models_nms_swap(&pBase[(first + nb_kept) * size], &pBase[i * size], size);
+      pA = (vision_models_nms_is8_t *)&pBase[(first + nb_kept) * size];
+    }
+    if (nb_kept < VISION_MODELS_NMS_GRID_MAX_KEPT)
+    {
+      int32_t c = vision_models_nms_grid_cell_is8(pA->box[1]) * VISION_MODELS_NMS_GRID_SIZE
+                  + vision_models_nms_grid_cell_is8(pA->box[0]);
+      next[nb_kept] = heads[c];
+      heads[c] = (int16_t)nb_kept;
+    }
+    max_w = MAX(max_w, pA->box[2] - zero_point);
+    max_h = MAX(max_h, pA->box[3] - zero_point);
+    nb_kept++;
+  }
+}
+
+
+void vision_models_nms_f32(void *pDetections, uint32_t detection_size, int32_t nb_detect,
+                           float32_t iou_threshold, int32_t max_boxes_limit,
+                           vision_models_nms_mode_e nms_mode)
+{
+  uint8_t *pBase = (uint8_t *)pDetections;
+  int32_t first = 0;
+
+  /* One sort gathers the classes in contiguous buckets, each ordered by confidence */
+  vision_models_nms_sort(pBase, detection_size, nb_detect, vision_models_nms_before_f32, 0);
+
+  while (first < nb_detect)
+  {
+    int32_t class_index = ((vision_models_nms_f32_t *)&pBase[first * detection_size])->class_index;
+    int32_t last = first + 1;
+
+    while ((last < nb_detect) &&
+           (((vision_models_nms_f32_t *)&pBase[last * detection_size])->class_index == class_index))
+    {
+      last++;
+    }
+
+    if (nms_mode == AI_VISION_MODELS_NMS_MODE_GRID)
+    {
+      vision_models_nms_grid_f32(pBase, detection_size, first, last, iou_threshold, max_boxes_limit,
+                                 VISION_MODELS_NMS_CONF_OFFSET_F32);
+    }
+    else
+    {
+      vision_models_nms_bucket_f32(pBase, detection_size, first, last, iou_threshold, max_boxes_limit,
+                                   VISION_MODELS_NMS_CONF_OFFSET_F32);
+    }
+    first = last;
+  }
+}
+
+
+void vision_models_nms_is8(void *pDetections, uint32_t detection_size, int32_t nb_detect,
+                           float32_t iou_threshold, int32_t max_boxes_limit, int8_t zero_point,
+                           float32_t scale, vision_models_nms_mode_e nms_mode)
+{
+  uint8_t *pBase = (uint8_t *)pDetections;
+  int32_t first = 0;
+  vision_models_nms_iou_is8_t iou;
+
+  vision_models_nms_iou_init_is8(&iou, iou_threshold, zero_point, scale);
+
+  /* One sort gathers the classes in contiguous buckets, each ordered by confidence */
+  vision_models_nms_sort(pBase, detection_size, nb_detect, vision_models_nms_before_is8, 0);
+
+  while (first < nb_detect)
+  {
+    uint8_t class_index = ((vision_models_nms_is8_t *)&pBase[first * detection_size])->class_index;
+    int32_t last = first + 1;
+
+    while ((last < nb_detect) &&
+           (((vision_models_nms_is8_t *)&pBase[last * detection_size])->class_index == class_index))
+    {
+      last++;
+    }
+
+    if (nms_mode == AI_VISION_MODELS_NMS_MODE_GRID)
+    {
+      vision_models_nms_grid_is8(pBase, detection_size, first, last, &iou, max_boxes_limit);
+    }
+    else
+    {
+      vision_models_nms_bucket_is8(pBase, detection_size, first, last, &iou, max_boxes_limit);
+    }
+    first = last;
+  }
+}
+
+
+void vision_models_nms_class_f32(void *pCandidates, uint32_t candidate_size, int32_t nb_detect,
+                                 uint32_t scores_offset, int32_t nb_classes, float32_t conf_threshold,
+                                 float32_t iou_threshold, int32_t max_boxes_limit,
+                                 vision_models_nms_mode_e nms_mode)
+{
+  uint8_t *pBase = (uint8_t *)pCandidates;
+
+  for (int32_t k = 0; k < nb_classes; k++)
+  {
+    uint32_t conf_offset = scores_offset + k * sizeof(float32_t);
+    int32_t nb = 0;
+
+    /* Scores below the threshold are never output. They would sort after the others, so they
+     * can neither suppress an output one nor take its place in the limit: only the candidates
+     * of the class above the threshold are gathered, sorted and suppressed */
+    for (int32_t i = 0; i < nb_detect; i++)
+    {
+      if (VISION_MODELS_NMS_CONF_F32(&pBase[i * candidate_size], conf_offset) >= conf_threshold)
+      {
+        if (i != nb)
+        {
+          vision_models_nms_swap(&pBase[nb * candidate_size], &pBase[i * candidate_size], candidate_size);
+        }
+        nb++;
+      }
+    }
+
+    vision_models_nms_sort(pBase, candidate_size, nb, vision_models_nms_before_score_f32, conf_offset);
+
+    if (nms_mode == AI_VISION_MODELS_NMS_MODE_GRID)
+    {
+      vision_models_nms_grid_f32(pBase, candidate_size, 0, nb, iou_threshold, max_boxes_limit, conf_offset);
+    }
+    else
+    {
+      vision_models_nms_bucket_f32(pBase, candidate_size, 0, nb, iou_threshold, max_boxes_limit, conf_offset);
+    }
+  }
+}
+
+
+int32_t vision_models_quantize_threshold_is8(float32_t threshold, float32_t scale, int32_t zero_point)
+{
+  float32_t q_f = threshold / scale + (float32_t)zero_point;
+  int32_t q;
+
+  /* Rounded estimate, then fixed with the dequantizing expression */
+  q_f = MAX(MIN(q_f, (float32_t)(SCHAR_MAX + 1)), (float32_t)SCHAR_MIN);
+  q = (int32_t)ceilf(q_f);
+  while ((q > SCHAR_MIN) && (scale * (float32_t)(q - 1 - zero_point) >= threshold))
+  {
+    q--;
+  }
+  while ((q <= SCHAR_MAX) && (scale * (float32_t)(q - zero_point) < threshold))
+  {
+    q++;
+  }
+  return q;
+}
+
+int32_t vision_models_quantize_threshold_iu8(float32_t threshold, float32_t scale, int32_t zero_point)
+{
+  float32_t q_f = threshold / scale + (float32_t)zero_point;
+  int32_t q;
+
+  /* Rounded estimate, then fixed with the dequantizing expression */
+  q_f = MAX(MIN(q_f, (float32_t)(UCHAR_MAX + 1)), 0.0f);
+  q = (int32_t)ceilf(q_f);
+  while ((q > 0) && (scale * (float32_t)(q - 1 - zero_point) >= threshold))
+  {
+    q--;
+  }
+  while ((q <= UCHAR_MAX) && (scale * (float32_t)(q - zero_point) < threshold))
+  {
+    q++;
+  }
+  return q;
+}
+
+float32_t vision_models_logit_threshold_f(float32_t threshold)
+{
+  /* sigmoid(lo) is 0 and sigmoid(hi) is 1 */
+  float32_t lo = -128.0f;
+  float32_t hi = 128.0f;
+
+  if (threshold <= 0.0f)
+  {
+    return -INFINITY;
+  }
+  if (threshold > 1.0f)
+  {
+    return INFINITY;
+  }
+  /* Bisection down to adjacent floats with the activation expression, so that the
+   * logit compare and the sigmoid compare select the same values */
+  while (nextafterf(lo, hi) < hi)
+  {
+    float32_t mid = lo + (hi - lo) * 0.5f;
+
+    if ((mid <= lo) || (mid >= hi))
+    {
+      mid = nextafterf(lo, hi);
+    }
+    if (vision_models_sigmoid_f(mid) >= threshold)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid;
+    }
+  }
+  return hi;
+}
+
 void transpose_flattened_2D(float32_t *arr, int32_t rows, int32_t cols, float32_t *tmp_x)
 {
   int32_t i, j, k;
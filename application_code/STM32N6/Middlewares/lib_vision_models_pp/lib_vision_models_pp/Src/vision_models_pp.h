@@ -22,17 +22,18 @@
 
 
 #include "arm_math.h"
+#include "vision_models_nms_if.h"
 
 #ifdef ARM_MATH_MVEF
 #define AI_OD_YOLOV5_PP_MVEF_OPTIM
 #define AI_OD_YOLOV8_PP_MVEF_OPTIM
 #define AI_SPE_MOVENET_PP_MVEF_OPTIM
 #define AI_SSEG_DEEPLAB_PP_MVEF_OPTIM
-//#define AI_MPE_YOLOV8_PP_MVEF_OPTIM
 #endif
 #ifdef ARM_MATH_MVEI
 #define AI_OD_YOLOV5_PP_MVEI_OPTIM
 #define AI_OD_YOLOV8_PP_MVEI_OPTIM
+#define AI_SPE_MOVENET_PP_MVEI_OPTIM
 #endif
 
 #ifndef MIN
@@ -43,9 +44,6 @@
   #define MAX(x,y) ((x) > (y) ? (x) : (y))
 #endif
 
-typedef int32_t _Cmpfun(const void *, const void *);
-extern void qsort(void *, size_t, size_t, _Cmpfun *);
-
 
 void vision_models_maxi_if32ou32(float32_t *arr, uint32_t len_arr, float32_t *maxim, uint32_t *index);
 
@@ -75,11 +73,58 @@ void vision_models_maxi_tr_p_is8ou8(int8_t *arr, uint32_t len_arr, uint32_t offs
 void vision_models_maxi_tr_is8ou8(int8_t *arr, uint32_t len_arr, uint32_t nb_total_boxes, int8_t *maxim, uint8_t *index);
 void vision_models_maxi_tr_is8ou16(int8_t *arr, uint32_t len_arr, uint32_t nb_total_boxes, int8_t *maxim, uint16_t *index);
 
+/* Max value and index of each of the nb_cols columns of a row-major array, in a single pass reading
+ * the rows contiguously (one strided pass per column for the int8 variant without MVE).
+ * Ties keep the first row. The int8 variant supports up to 65536 rows. */
+#define AI_VISION_MODELS_MAXI_COL_BLOCK (32)   /* columns handled per pass by the callers */
+void vision_models_maxi_col_if32ou32(float32_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, float32_t *maxim, uint32_t *index);
+void vision_models_maxi_col_is8ou16(int8_t *arr, uint32_t nb_rows, uint32_t row_stride, uint32_t nb_cols, int16_t *maxim, uint16_t *index);
+
 float32_t vision_models_sigmoid_f(float32_t x);
-void vision_models_softmax_f(float32_t *input_x, float32_t *output_x, int32_t len_x, float32_t *tmp_x);
+void vision_models_softmax_f(float32_t *input_x, float32_t *output_x, int32_t len_x);
 float32_t vision_models_box_iou(float32_t *a, float32_t *b);
 float32_t vision_models_box_iou_is8(int8_t *a, int8_t *b, int8_t zp);
 
+/* Shared NMS engine.
+ * Detection records are processed in place, they must begin with the box (4 values),
+ * the confidence and the class index, as od_pp_outBuffer_t / mpe_pp_outBuffer_t (float)
+ * and od_pp_scratchBuffer_s8_t / iseg_postprocess_scratchBuffer_s8_t (int8) do. detection_size is the record size.
+ * Records are grouped per class by decreasing confidence, suppressed ones get a null
+ * confidence (0 for float, -128 for int8) and at most max_boxes_limit are kept per class.
+ * nms_mode picks the suppression strategy, both give the same detections.
+ * int8 boxes share zero_point. With a scale, the exact integer IoU is compared with the
+ * threshold and the pairs within rounding distance of it use the float IoU of the dequantized
+ * boxes, so that the kept boxes are exactly those of a dequantizing path; with a null scale,
+ * the integer IoU is used. */
+void vision_models_nms_f32(void *pDetections, uint32_t detection_size, int32_t nb_detect,
+                           float32_t iou_threshold, int32_t max_boxes_limit,
+                           vision_models_nms_mode_e nms_mode);
+void vision_models_nms_is8(void *pDetections, uint32_t detection_size, int32_t nb_detect,
+                           float32_t iou_threshold, int32_t max_boxes_limit, int8_t zero_point,
+                           float32_t scale, vision_models_nms_mode_e nms_mode);
+/* Per-class NMS of candidates scored for every class (Tiny YOLOv2, SSD): the NMS of each class
+ * runs on the candidates whose score of that class is at least conf_threshold, a candidate
+ * can survive in several classes. Candidates are records of candidate_size bytes beginning
+ * with the box, the nb_classes float scores start scores_offset bytes from the record start.
+ * Records are reordered, suppressed scores and those beyond max_boxes_limit are set to 0:
+ * the best remaining score of a candidate gives its class. */
+void vision_models_nms_class_f32(void *pCandidates, uint32_t candidate_size, int32_t nb_detect,
+                                 uint32_t scores_offset, int32_t nb_classes, float32_t conf_threshold,
+                                 float32_t iou_threshold, int32_t max_boxes_limit,
+                                 vision_models_nms_mode_e nms_mode);
+
+/* Smallest int8 value q such that scale * (q - zero_point) >= threshold, computed with the
+ * same float expression as the dequantizing paths so both select the same values.
+ * Returns SCHAR_MAX + 1 when no int8 value passes. */
+int32_t vision_models_quantize_threshold_is8(float32_t threshold, float32_t scale, int32_t zero_point);
+/* Same for uint8 values, returns UCHAR_MAX + 1 when no uint8 value passes. */
+int32_t vision_models_quantize_threshold_iu8(float32_t threshold, float32_t scale, int32_t zero_point);
+/* Smallest float x such that vision_models_sigmoid_f(x) >= threshold: the threshold of a score
+ * activated by a sigmoid, in the domain of its logit. Computed once at reset time, it lets the
+ * decoders reject candidates with a single compare and activate the survivors only.
+ * Returns -INFINITY when every value passes, INFINITY when none does. */
+float32_t vision_models_logit_threshold_f(float32_t threshold);
+
 void transpose_flattened_2D(float32_t *arr, int32_t rows, int32_t cols, float32_t *tmp_x);
 void dequantize(int32_t* arr, float32_t* tmp, int32_t n, int32_t zero_point, float32_t scale);
 
@@ -21,6 +21,8 @@
 #include "app_cam.h"
 #include "app_config.h"
 #include "crop_img.h"
+#include "app_pipe.h"
+#include "app_postprocess.h"
 
 #if defined(USE_IMX335_SENSOR)
   #define GAMMA_CONVERSION 0
@@ -31,6 +33,12 @@
 #endif
 
 extern int32_t cameraFrameReceived;
+#if APP_PIPELINE_MODE
+extern app_pipe_t nn_pipe;
+#endif
+#if APP_TRACKER
+extern int32_t displayFrameReceived;
+#endif
 
 static void DCMIPP_PipeInitDisplay(CMW_CameraInit_t *camConf, uint32_t *bg_width, uint32_t *bg_height)
 {
@@ -189,7 +197,18 @@ int CMW_CAMERA_PIPE_FrameEventCallback(uint32_t pipe)
   {
     case DCMIPP_PIPE2 :
       cameraFrameReceived++;
+#if APP_PIPELINE_MODE
+      /* Continuous capture: the new address is taken at the next frame start */
+      HAL_DCMIPP_PIPE_SetMemoryAddress(CMW_CAMERA_GetDCMIPPHandle(), DCMIPP_PIPE2, DCMIPP_MEMORY_ADDRESS_0,
+                                       (uint32_t) app_pipe_frame_done(&nn_pipe));
+#endif
       break;
+#if APP_TRACKER
+    case DCMIPP_PIPE1 :
+      /* Tracker steps follow the displayed frames */
+      displayFrameReceived++;
+      break;
+#endif
   }
   return 0;
 }
@@ -0,0 +1,133 @@
+ /**
+ ******************************************************************************
+ * @file    app_pipe.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+#include "app_pipe.h"
+#include <assert.h>
+#include <stddef.h>
+
+void app_pipe_init(app_pipe_t *pipe, uint8_t *buffers[APP_PIPE_NB_BUFFERS])
+{
+  for (int32_t i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    pipe->buffers[i] = buffers[i];
+    pipe->state[i] = APP_PIPE_FREE;
+    pipe->frame_id[i] = 0;
+  }
+  pipe->state[0] = APP_PIPE_CAPTURE;
+  pipe->capture_idx = 0;
+  pipe->next_frame_id = 1;
+  pipe->nb_dropped = 0;
+}
+
+/**
+ * @brief Buffer to give to the camera when the capture starts
+ */
+uint8_t *app_pipe_capture_buffer(app_pipe_t *pipe)
+{
+  return pipe->buffers[pipe->capture_idx];
+}
+
+/**
+ * @brief Publishes the captured frame and returns the buffer for the next capture
+ *        (a free one, else the one holding the oldest ready frame, which is dropped).
+ *        If all the other buffers are held, the captured frame is dropped and its
+ *        buffer is captured again.
+ */
+uint8_t *app_pipe_frame_done(app_pipe_t *pipe)
+{
+  int32_t next = -1;
+  uint32_t frame_id = pipe->next_frame_id++;
+
+  for (int32_t i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    if (pipe->state[i] == APP_PIPE_FREE)
+    {
+      next = i;
+      break;
+    }
+  }
+  if (next < 0)
+  {
+    for (int32_t i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+    {
+      if ((pipe->state[i] == APP_PIPE_READY) &&
+          ((next < 0) || (pipe->frame_id[i] < pipe->frame_id[next])))
+      {
+        next = i;
+      }
+    }
+  }
+
+  if (next < 0)
+  {
+    pipe->nb_dropped++;
+    return pipe->buffers[pipe->capture_idx];
+  }
+  if (pipe->state[next] == APP_PIPE_READY)
+  {
+    pipe->nb_dropped++;
+  }
+
+  pipe->state[pipe->capture_idx] = APP_PIPE_READY;
+  pipe->frame_id[pipe->capture_idx] = frame_id;
+  pipe->state[next] = APP_PIPE_CAPTURE;
+  pipe->capture_idx = next;
+
+  return pipe->buffers[next];
+}
+
+/**
+ * @brief Takes the newest ready frame, older ready frames are dropped
+ * @retval Buffer index to release, -1 when no frame is ready
+ */
+int32_t app_pipe_acquire(app_pipe_t *pipe, uint8_t **buffer, uint32_t *frame_id)
+{
+  int32_t newest = -1;
+
+  for (int32_t i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    if ((pipe->state[i] == APP_PIPE_READY) &&
+        ((newest < 0) || (pipe->frame_id[i] > pipe->frame_id[newest])))
+    {
+      newest = i;
+    }
+  }
+  if (newest < 0)
+  {
+    return -1;
+  }
+
+  for (int32_t i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    if ((i != newest) && (pipe->state[i] == APP_PIPE_READY))
+    {
+      pipe->state[i] = APP_PIPE_FREE;
+      pipe->nb_dropped++;
+    }
+  }
+  pipe->state[newest] = APP_PIPE_HELD;
+  *buffer = pipe->buffers[newest];
+  *frame_id = pipe->frame_id[newest];
+
+  return newest;
+}
+
+void app_pipe_release(app_pipe_t *pipe, int32_t idx)
+{
+  assert(pipe->state[idx] == APP_PIPE_HELD);
+  pipe->state[idx] = APP_PIPE_FREE;
+}
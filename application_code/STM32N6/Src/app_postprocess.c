@@ -21,12 +21,41 @@
 #include "app_config.h"
 #include <assert.h>
 
-#if POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V5_UU
+#if POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V2_UF
+#define YOLOV2_ANCHOR_BOXES (AI_OBJDETECT_YOLOV2_PP_GRID_WIDTH * AI_OBJDETECT_YOLOV2_PP_GRID_HEIGHT * \
+                             AI_OBJDETECT_YOLOV2_PP_NB_ANCHORS)
+static od_pp_outBuffer_t out_detections[YOLOV2_ANCHOR_BOXES];
+/* Scratch arena of the post-processing call: the decoded candidates with their class scores */
+static uint32_t yolov2_scratch[(AI_OD_YOLOV2_PP_SCRATCH_SIZE(YOLOV2_ANCHOR_BOXES,
+                                                             AI_OBJDETECT_YOLOV2_PP_NB_CLASSES) + 3) / 4];
+static vision_models_pp_ctx_t yolov2_ctx = { yolov2_scratch, sizeof(yolov2_scratch) };
+#elif POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V5_UU
 static od_pp_outBuffer_t out_detections[AI_OBJDETECT_YOLOV5_PP_TOTAL_BOXES];
-#elif POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V8_UF || POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V8_UI
+#elif POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V8_UF
 static od_pp_outBuffer_t out_detections[AI_OBJDETECT_YOLOV8_PP_TOTAL_BOXES];
+#elif POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V8_UI
+/* Packed int8 candidates, then the dequantized detections */
+static od_pp_outBuffer_t out_detections[AI_OD_YOLOV8_PP_INT8_OUT_RECORDS(AI_OBJDETECT_YOLOV8_PP_TOTAL_BOXES,
+                                                                         AI_OBJDETECT_YOLOV8_PP_NB_CLASSES,
+                                                                         AI_OBJDETECT_YOLOV8_PP_MAX_BOXES_LIMIT)];
+#elif POSTPROCESS_TYPE == POSTPROCESS_OD_ST_YOLOX_UF
+#define YOLOX_LEVEL_BOXES(w, h) ((w) * (h) * AI_OBJDETECT_YOLOVX_PP_NB_ANCHORS)
+#define YOLOX_L_BOXES YOLOX_LEVEL_BOXES(AI_OBJDETECT_YOLOVX_PP_L_GRID_WIDTH, AI_OBJDETECT_YOLOVX_PP_L_GRID_HEIGHT)
+#define YOLOX_M_BOXES YOLOX_LEVEL_BOXES(AI_OBJDETECT_YOLOVX_PP_M_GRID_WIDTH, AI_OBJDETECT_YOLOVX_PP_M_GRID_HEIGHT)
+#define YOLOX_S_BOXES YOLOX_LEVEL_BOXES(AI_OBJDETECT_YOLOVX_PP_S_GRID_WIDTH, AI_OBJDETECT_YOLOVX_PP_S_GRID_HEIGHT)
+static od_pp_outBuffer_t out_detections[YOLOX_L_BOXES + YOLOX_M_BOXES + YOLOX_S_BOXES];
+/* Scratch arena of the post-processing call: the decoded candidates of one level at a time */
+#define YOLOX_LM_BOXES ((YOLOX_L_BOXES > YOLOX_M_BOXES) ? YOLOX_L_BOXES : YOLOX_M_BOXES)
+#define YOLOX_MAX_LEVEL_BOXES ((YOLOX_LM_BOXES > YOLOX_S_BOXES) ? YOLOX_LM_BOXES : YOLOX_S_BOXES)
+static uint32_t yolox_scratch[(AI_OD_ST_YOLOX_PP_SCRATCH_SIZE(YOLOX_MAX_LEVEL_BOXES,
+                                                              AI_OBJDETECT_YOLOVX_PP_NB_CLASSES) + 3) / 4];
+static vision_models_pp_ctx_t yolox_ctx = { yolox_scratch, sizeof(yolox_scratch) };
 #elif POSTPROCESS_TYPE == POSTPROCESS_OD_ST_SSD_UF
 static od_pp_outBuffer_t out_detections[AI_OD_SSD_ST_PP_TOTAL_DETECTIONS];
+/* Scratch arena of the post-processing call: the candidate boxes with their class scores */
+static uint32_t ssd_st_scratch[(AI_OD_SSD_ST_PP_SCRATCH_SIZE(AI_OD_SSD_ST_PP_TOTAL_DETECTIONS,
+                                                             AI_OD_SSD_ST_PP_NB_CLASSES) + 3) / 4];
+static vision_models_pp_ctx_t ssd_st_ctx = { ssd_st_scratch, sizeof(ssd_st_scratch) };
 #elif POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
 static mpe_pp_outBuffer_t out_detections[AI_MPE_YOLOV8_PP_TOTAL_BOXES];
 static mpe_pp_keyPoints_t out_keyPoints[AI_MPE_YOLOV8_PP_TOTAL_BOXES * AI_POSE_PP_POSE_KEYPOINTS_NB];
@@ -41,11 +70,25 @@ static spe_pp_outBuffer_t out_detections[AI_POSE_PP_POSE_KEYPOINTS_NB];
 #elif POSTPROCESS_TYPE == POSTPROCESS_ISEG_YOLO_V8_UI
 uint8_t _iseg_mask[AI_YOLOV8_SEG_PP_MASK_SIZE * AI_YOLOV8_SEG_PP_MASK_SIZE * AI_YOLOV8_SEG_PP_MAX_BOXES_LIMIT];
 iseg_postprocess_outBuffer_t out_detections[AI_YOLOV8_SEG_PP_MAX_BOXES_LIMIT];
-iseg_postprocess_scratchBuffer_s8_t scratch_detections[AI_YOLOV8_SEG_PP_TOTAL_BOXES];
-float32_t _out_buf_mask[AI_YOLOV8_SEG_PP_MASK_NB];
-int8_t _out_buf_mask_s8[AI_YOLOV8_SEG_PP_MASK_NB * AI_YOLOV8_SEG_PP_TOTAL_BOXES];
+/* Scratch arena of the post-processing call, words for the alignment of its records */
+static uint32_t iseg_scratch[(AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(AI_YOLOV8_SEG_PP_TOTAL_BOXES,
+                                                             AI_YOLOV8_SEG_PP_MASK_NB) + 3) / 4];
+static vision_models_pp_ctx_t iseg_ctx = { iseg_scratch, sizeof(iseg_scratch) };
 #elif POSTPROCESS_TYPE == POSTPROCESS_SSEG_DEEPLAB_V3_UF
-static uint8_t out_sseg_map[AI_SSEG_DEEPLABV3_PP_WIDTH * AI_SSEG_DEEPLABV3_PP_HEIGHT];
+#ifndef AI_SSEG_DEEPLABV3_PP_OUT_STEP
+#define AI_SSEG_DEEPLABV3_PP_OUT_STEP (1)
+#endif
+#define SSEG_OUT_SIZE (((AI_SSEG_DEEPLABV3_PP_WIDTH + AI_SSEG_DEEPLABV3_PP_OUT_STEP - 1) / AI_SSEG_DEEPLABV3_PP_OUT_STEP) * \
+                       ((AI_SSEG_DEEPLABV3_PP_HEIGHT + AI_SSEG_DEEPLABV3_PP_OUT_STEP - 1) / AI_SSEG_DEEPLABV3_PP_OUT_STEP))
+#ifdef AI_SSEG_DEEPLABV3_PP_COLOR_MAP
+/* ARGB4444 pixels, ready for the overlay layer */
+static const uint32_t sseg_color_map[AI_SSEG_DEEPLABV3_PP_NB_CLASSES] = AI_SSEG_DEEPLABV3_PP_COLOR_MAP;
+static uint16_t out_sseg_map[SSEG_OUT_SIZE];
+#else
+static uint8_t out_sseg_map[SSEG_OUT_SIZE];
+#endif
+static uint32_t out_sseg_hist[AI_SSEG_DEEPLABV3_PP_NB_CLASSES];
+static sseg_pp_extent_t out_sseg_extents[AI_SSEG_DEEPLABV3_PP_NB_CLASSES];
 #endif
 
 int32_t app_postprocess_init(void *params_postprocess)
@@ -151,6 +194,9 @@ int32_t app_postprocess_init(void *params_postprocess)
   params->heatmap_width = AI_SPE_MOVENET_POSTPROC_HEATMAP_WIDTH;
   params->heatmap_height = AI_SPE_MOVENET_POSTPROC_HEATMAP_HEIGHT;
   params->nb_keypoints = AI_POSE_PP_POSE_KEYPOINTS_NB;
+#ifdef AI_SPE_MOVENET_POSTPROC_SUBPIXEL_REFINE
+  params->subpixel_refine = AI_SPE_MOVENET_POSTPROC_SUBPIXEL_REFINE;
+#endif
   error = spe_movenet_pp_reset(params);
 #elif POSTPROCESS_TYPE == POSTPROCESS_ISEG_YOLO_V8_UI
   int32_t error = AI_ISEG_POSTPROCESS_ERROR_NO;
@@ -166,11 +212,6 @@ int32_t app_postprocess_init(void *params_postprocess)
   params->nb_masks = AI_YOLOV8_SEG_PP_MASK_NB;
   params->mask_raw_output_zero_point = AI_YOLOV8_SEG_MASK_ZERO_POINT;
   params->mask_raw_output_scale = AI_YOLOV8_SEG_MASK_SCALE;
-  params->pMask = _out_buf_mask;
-  params->pTmpBuff = scratch_detections;
-  for (size_t i = 0; i < AI_YOLOV8_SEG_PP_TOTAL_BOXES; i++) {
-    scratch_detections[i].pMask = &_out_buf_mask_s8[i * AI_YOLOV8_SEG_PP_MASK_NB];
-  }
   for (size_t i = 0; i < AI_YOLOV8_SEG_PP_MAX_BOXES_LIMIT; i++) {
     out_detections[i].pMask = &_iseg_mask[i * AI_YOLOV8_SEG_PP_MASK_SIZE * AI_YOLOV8_SEG_PP_MASK_SIZE];
   }
@@ -182,6 +223,13 @@ int32_t app_postprocess_init(void *params_postprocess)
   params->width = AI_SSEG_DEEPLABV3_PP_WIDTH;
   params->height = AI_SSEG_DEEPLABV3_PP_HEIGHT;
   params->type = AI_SSEG_DATA_UINT8;
+  params->out_step = AI_SSEG_DEEPLABV3_PP_OUT_STEP;
+#ifdef AI_SSEG_DEEPLABV3_PP_COLOR_MAP
+  params->out_format = AI_SSEG_OUT_ARGB4444;
+  params->color_map = sseg_color_map;
+#else
+  params->out_format = AI_SSEG_OUT_INDEX;
+#endif
   error = sseg_deeplabv3_pp_reset(params);
 #else
   #error "PostProcessing type not supported"
@@ -195,11 +243,13 @@ int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *p
 #if POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V2_UF
   assert(nb_input == 1);
   int32_t error = AI_OD_POSTPROCESS_ERROR_NO;
+  od_pp_out_t *pObjDetOutput = (od_pp_out_t *) pOutput;
+  pObjDetOutput->pOutBuff = out_detections;
   yolov2_pp_in_t pp_input = {
     .pRaw_detections = (float32_t *) pInput[0]
   };
-  error = od_yolov2_pp_process(&pp_input, (od_pp_out_t *) pOutput,
-                               (yolov2_pp_static_param_t *) pInput_param);
+  error = od_yolov2_pp_process(&pp_input, pObjDetOutput,
+                               (yolov2_pp_static_param_t *) pInput_param, &yolov2_ctx);
 #elif POSTPROCESS_TYPE == POSTPROCESS_OD_YOLO_V5_UU
   assert(nb_input == 1);
   int32_t error = AI_OD_POSTPROCESS_ERROR_NO;
@@ -234,13 +284,14 @@ int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *p
   assert(nb_input == 3);
   int32_t error = AI_OD_POSTPROCESS_ERROR_NO;
   od_pp_out_t *pObjDetOutput = (od_pp_out_t *) pOutput;
+  pObjDetOutput->pOutBuff = out_detections;
   st_yolox_pp_in_t pp_input = {
       .pRaw_detections_S = (float32_t *) pInput[0],
       .pRaw_detections_L = (float32_t *) pInput[1],
       .pRaw_detections_M = (float32_t *) pInput[2],
   };
   error = od_st_yolox_pp_process(&pp_input, pObjDetOutput,
-                                 (st_yolox_pp_static_param_t *) pInput_param);
+                                 (st_yolox_pp_static_param_t *) pInput_param, &yolox_ctx);
 #elif POSTPROCESS_TYPE == POSTPROCESS_OD_ST_SSD_UF
   assert(nb_input == 3);
   int32_t error = AI_OD_POSTPROCESS_ERROR_NO;
@@ -254,7 +305,7 @@ int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *p
       .pScores = (float32_t *) inputArray[0],
   };
   error = od_ssd_st_pp_process(&pp_input, pObjDetOutput,
-                              (ssd_st_pp_static_param_t *) pInput_param);
+                              (ssd_st_pp_static_param_t *) pInput_param, &ssd_st_ctx);
 #elif POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
   assert(nb_input == 1);
   int32_t error = AI_MPE_PP_ERROR_NO;
@@ -299,12 +350,14 @@ int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *p
       .pRaw_masks = (int8_t *) pInput[1]
   };
   error = iseg_yolov8_pp_process(&pp_input, pOutput,
-                                 (yolov8_seg_pp_static_param_t *) pInput_param);
+                                 (yolov8_seg_pp_static_param_t *) pInput_param, &iseg_ctx);
 #elif POSTPROCESS_TYPE == POSTPROCESS_SSEG_DEEPLAB_V3_UF
   assert(nb_input == 1);
   int32_t error = AI_SSEG_POSTPROCESS_ERROR_NO;
   sseg_pp_out_t *pSsegOutput = (sseg_pp_out_t *) pOutput;
-  pSsegOutput->pOutBuff = out_sseg_map;
+  pSsegOutput->pOutBuff = (uint8_t *) out_sseg_map;
+  pSsegOutput->pClass_hist = out_sseg_hist;
+  pSsegOutput->pClass_extents = out_sseg_extents;
   sseg_deeplabv3_pp_in_t pp_input = {
     .pRawData = (float32_t *) pInput[0]
   };
@@ -316,3 +369,16 @@ int32_t app_postprocess_run(void *pInput[], int nb_input, void *pOutput, void *p
 
   return error;
 }
+
+int32_t app_tracker_init(od_tracker_pp_static_param_t *params_tracker)
+{
+  params_tracker->iou_threshold = APP_TRACKER_IOU_THRESHOLD;
+  params_tracker->dist_threshold = APP_TRACKER_DIST_THRESHOLD;
+  params_tracker->alpha = APP_TRACKER_ALPHA;
+  params_tracker->beta = APP_TRACKER_BETA;
+  params_tracker->min_hits = APP_TRACKER_MIN_HITS;
+  params_tracker->max_missed = APP_TRACKER_MAX_MISSED;
+  params_tracker->assoc_mode = AI_OD_TRACKER_PP_ASSOC_GREEDY;
+
+  return od_tracker_pp_reset(params_tracker);
+}
@@ -0,0 +1,185 @@
+ /**
+ ******************************************************************************
+ * @file    app_roi.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+#include "app_roi.h"
+#include <assert.h>
+#include <stddef.h>
+
+void app_roi_init(app_roi_batch_t *batch, const app_roi_net_t *net, const app_roi_input_t *input,
+                  uint8_t *slots[APP_ROI_NB_SLOTS])
+{
+  batch->net = *net;
+  batch->input = *input;
+  batch->crop = app_roi_crop_resize;
+  for (int32_t i = 0; i < APP_ROI_NB_SLOTS; i++)
+  {
+    batch->slots[i] = slots[i];
+  }
+  batch->nb_rois = 0;
+}
+
+/**
+ * @brief Converts a detection box, normalized to the frame, to the pixels it covers
+ * @retval 0 on success, -1 if less than one pixel of the box is inside the frame
+ */
+int32_t app_roi_box_to_rect(const od_pp_outBuffer_t *box, uint32_t frame_width, uint32_t frame_height,
+                            app_roi_rect_t *rect)
+{
+  float32_t x0 = (box->x_center - box->width / 2) * (float32_t) frame_width;
+  float32_t y0 = (box->y_center - box->height / 2) * (float32_t) frame_height;
+  float32_t x1 = (box->x_center + box->width / 2) * (float32_t) frame_width;
+  float32_t y1 = (box->y_center + box->height / 2) * (float32_t) frame_height;
+
+  x0 = x0 > 0 ? x0 : 0;
+  y0 = y0 > 0 ? y0 : 0;
+  x1 = x1 < (float32_t) frame_width ? x1 : (float32_t) frame_width;
+  y1 = y1 < (float32_t) frame_height ? y1 : (float32_t) frame_height;
+
+  if ((x1 - x0 < 1.0f) || (y1 - y0 < 1.0f))
+  {
+    return -1;
+  }
+
+  rect->x0 = (uint32_t) x0;
+  rect->y0 = (uint32_t) y0;
+  rect->width = (uint32_t) x1 - rect->x0;
+  rect->height = (uint32_t) y1 - rect->y0;
+
+  return 0;
+}
+
+/**
+ * @brief Crops a ROI of the frame and resizes it with the nearest neighbor method to
+ *        lines [y_start, y_end) of the NN input. The channels of RGB888 frames are swapped
+ *        when their order is not the one of the NN input.
+ */
+void app_roi_crop_resize(const app_roi_frame_t *frame, const app_roi_rect_t *rect,
+                         const app_roi_input_t *input, uint8_t *dst, uint32_t y_start, uint32_t y_end)
+{
+  /* 16.16 ratios, output pixels sample the source at their center */
+  const uint32_t x_ratio = (rect->width << 16) / input->width;
+  const uint32_t y_ratio = (rect->height << 16) / input->height;
+  const uint32_t r_idx = input->bgr ? 2 : 0;
+  const uint32_t b_idx = 2 - r_idx;
+
+  assert((rect->x0 + rect->width <= frame->width) && (rect->y0 + rect->height <= frame->height));
+
+  for (uint32_t y = y_start; y < y_end; y++)
+  {
+    const uint8_t *pIn = frame->pixels + (rect->y0 + ((y * y_ratio + y_ratio / 2) >> 16)) * frame->pitch;
+    uint8_t *pOut = dst + y * input->width * ROI_NN_BPP;
+    uint32_t sx = x_ratio / 2;
+
+    if (frame->bpp == 2)
+    {
+      const uint16_t *pRow = (const uint16_t *) pIn + rect->x0;
+
+      for (uint32_t x = 0; x < input->width; x++, sx += x_ratio, pOut += ROI_NN_BPP)
+      {
+        uint16_t p = pRow[sx >> 16];
+        uint8_t r5 = p >> 11;
+        uint8_t g6 = (p >> 5) & 0x3F;
+        uint8_t b5 = p & 0x1F;
+
+        pOut[r_idx] = (r5 << 3) | (r5 >> 2);
+        pOut[1] = (g6 << 2) | (g6 >> 4);
+        pOut[b_idx] = (b5 << 3) | (b5 >> 2);
+      }
+    }
+    else
+    {
+      const uint8_t *pRow = pIn + rect->x0 * 3;
+      const uint32_t swap = (frame->bgr != input->bgr);
+
+      for (uint32_t x = 0; x < input->width; x++, sx += x_ratio, pOut += ROI_NN_BPP)
+      {
+        const uint8_t *p = pRow + (sx >> 16) * 3;
+
+        pOut[0] = p[swap ? 2 : 0];
+        pOut[1] = p[1];
+        pOut[2] = p[swap ? 0 : 2];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Runs the second network over the boxes of a frame, back-to-back: the crop of
+ *        ROI k + 1 is done band per band while the inference of ROI k progresses.
+ *        The ROIs are computed before the first inference, so the boxes may live in
+ *        memory the second network reuses.
+ * @retval Number of ROIs inferred, net.result() was called with the index of their box
+ */
+uint32_t app_roi_run(app_roi_batch_t *batch, const app_roi_frame_t *frame,
+                     const od_pp_outBuffer_t *boxes, uint32_t nb_boxes)
+{
+  const app_roi_net_t *net = &batch->net;
+  const uint32_t height = batch->input.height;
+  uint32_t nb_rois = 0;
+
+  for (uint32_t i = 0; (i < nb_boxes) && (nb_rois < APP_ROI_MAX_ROIS); i++)
+  {
+    if (app_roi_box_to_rect(&boxes[i], frame->width, frame->height, &batch->rects[nb_rois]) == 0)
+    {
+      batch->box_idx[nb_rois++] = i;
+    }
+  }
+  batch->nb_rois = nb_rois;
+
+  if (nb_rois == 0)
+  {
+    return 0;
+  }
+
+  batch->crop(frame, &batch->rects[0], &batch->input, batch->slots[0], 0, height);
+
+  for (uint32_t k = 0; k < nb_rois; k++)
+  {
+    int32_t done = 0;
+
+    net->start(net->ctx, batch->slots[k % APP_ROI_NB_SLOTS]);
+
+    if (k + 1 < nb_rois)
+    {
+      uint8_t *next_slot = batch->slots[(k + 1) % APP_ROI_NB_SLOTS];
+
+      for (uint32_t y = 0; y < height; y += APP_ROI_CROP_BAND)
+      {
+        uint32_t y_end = (y + APP_ROI_CROP_BAND) < height ? (y + APP_ROI_CROP_BAND) : height;
+
+        batch->crop(frame, &batch->rects[k + 1], &batch->input, next_slot, y, y_end);
+        if (!done)
+        {
+          done = net->poll(net->ctx);
+        }
+      }
+    }
+
+    while (!done)
+    {
+      done = net->poll(net->ctx);
+      if (!done && (net->idle != NULL))
+      {
+        net->idle(net->ctx);
+      }
+    }
+
+    net->result(net->ctx, batch->box_idx[k]);
+  }
+
+  return nb_rois;
+}
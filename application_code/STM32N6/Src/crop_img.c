@@ -32,4 +32,71 @@ void img_crop(uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
     memcpy(pOut, pIn + (i * src_stride), dst_line_size);
     pOut += dst_line_size;
   }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Removes the line padding of an image in its own buffer.
+ *        Lines move towards the start of the buffer, a line may overlap its source.
+ */
+void img_crop_inplace(uint8_t *image, const uint32_t src_stride,
+                      const uint16_t dst_width, const uint16_t height,
+                      const uint16_t dst_bpp)
+{
+  const uint32_t dst_line_size = (dst_width * dst_bpp);
+  uint8_t *pOut = image + dst_line_size;
+
+  assert(src_stride >= dst_line_size);
+
+  /* First line is already in place */
+  for (uint32_t i = 1; i < height; i++)
+  {
+    memmove(pOut, image + (i * src_stride), dst_line_size);
+    pOut += dst_line_size;
+  }
+}
+
+/**
+ * @brief Checks that a padded frame of frame_len bytes written at the NN input address may be
+ *        packed in place: beyond the NN input, it must only cover activations of the same memory
+ *        pool (dead between inferences) and no output buffer, which the application still reads.
+ */
+int img_crop_inplace_fits(const LL_Buffer_InfoTypeDef *nn_in_info,
+                          const LL_Buffer_InfoTypeDef *internal_info,
+                          const LL_Buffer_InfoTypeDef *output_info,
+                          const uint32_t frame_len)
+{
+  const uint32_t frame_end = nn_in_info->offset_start + frame_len;
+  uint32_t covered = nn_in_info->offset_end;
+  int extended = 1;
+
+  /* Extend the covered range with the activations it reaches, they may be listed in any order */
+  while ((covered < frame_end) && extended)
+  {
+    extended = 0;
+    for (const LL_Buffer_InfoTypeDef *info = internal_info; info != NULL && info->name != NULL; info++)
+    {
+      if (!info->is_user_allocated && !info->is_param &&
+          (LL_Buffer_addr_base(info) == LL_Buffer_addr_base(nn_in_info)) &&
+          (info->offset_start <= covered) && (info->offset_end > covered))
+      {
+        covered = info->offset_end;
+        extended = 1;
+      }
+    }
+  }
+  if (covered < frame_end)
+  {
+    return 0;
+  }
+
+  for (const LL_Buffer_InfoTypeDef *info = output_info; info != NULL && info->name != NULL; info++)
+  {
+    if ((LL_Buffer_addr_base(info) == LL_Buffer_addr_base(nn_in_info)) &&
+        (info->offset_start < frame_end) && (info->offset_end > nn_in_info->offset_end))
+    {
+      return 0;
+    }
+  }
+
+  return 1;
+}
@@ -28,14 +28,19 @@
 #include "app_cam.h"
 #include "main.h"
 #include <stdio.h>
+#include <string.h>
 #include "stm32n6xx_hal_rif.h"
 #include "app_config.h"
 #include "crop_img.h"
+#include "app_pipe.h"
+#include "app_roi.h"
 #include "stlogo.h"
 
 CLASSES_TABLE;
 
 #define MAX_NUMBER_OUTPUT 5
+/* Detections kept for display while the next inference overwrites the NN outputs */
+#define MAX_NUMBER_DISPLAYED 64
 
 typedef struct
 {
@@ -103,8 +108,8 @@ od_pp_out_t pp_output;
 
 #define ALIGN_TO_16(value) (((value) + 15) & ~15)
 
-/* for models not multiple of 16; needs a working buffer */
-#if (NN_WIDTH * NN_BPP) != ALIGN_TO_16(NN_WIDTH * NN_BPP)
+/* for models not multiple of 16; working buffer used when the padded frame does not fit in place */
+#if !APP_PIPELINE_MODE && !APP_ROI_CLASSIFIER && ((NN_WIDTH * NN_BPP) != ALIGN_TO_16(NN_WIDTH * NN_BPP))
 #define DCMIPP_OUT_NN_LEN (ALIGN_TO_16(NN_WIDTH * NN_BPP) * NN_HEIGHT)
 #define DCMIPP_OUT_NN_BUFF_LEN (DCMIPP_OUT_NN_LEN + 32 - DCMIPP_OUT_NN_LEN%32)
 
@@ -114,6 +119,71 @@ uint8_t dcmipp_out_nn[DCMIPP_OUT_NN_BUFF_LEN];
 uint8_t *dcmipp_out_nn;
 #endif
 
+#if APP_PIPELINE_MODE
+#define NN_PIPE_BUFF_LEN (ALIGN_TO_16(NN_WIDTH * NN_BPP) * NN_HEIGHT)
+
+/* NN pipe capture ring */
+__attribute__ ((section (".psram_bss")))
+__attribute__ ((aligned (32)))
+uint8_t nn_pipe_buffer[APP_PIPE_NB_BUFFERS][NN_PIPE_BUFF_LEN + 32 - NN_PIPE_BUFF_LEN%32];
+app_pipe_t nn_pipe;
+
+/* Results of the last inference, tagged with their frame id */
+static od_pp_outBuffer_t display_detections[MAX_NUMBER_DISPLAYED];
+static od_pp_out_t display_output = { .pOutBuff = display_detections };
+static uint32_t display_frame_id;
+static uint32_t display_inference_ms;
+#endif
+
+#if APP_ROI_CLASSIFIER
+#define ROI_NN_LEN (ROI_NN_WIDTH * ROI_NN_HEIGHT * ROI_NN_BPP)
+
+/* Second stage network, its activations share the memory pools of the detector */
+LL_ATON_DECLARE_NAMED_NN_INSTANCE_AND_INTERFACE(classifier);
+
+typedef struct
+{
+  NN_Instance_TypeDef *nn;
+  uint8_t *nn_in;
+  uint32_t nn_in_len;
+  float32_t *nn_out;
+  uint32_t nn_out_len;
+  od_pp_outBuffer_t *detections;
+  int started;
+  int wfe;
+} roi_net_ctx_t;
+
+/* ROI k + 1 is cropped in a slot while the classifier runs ROI k from its input buffer */
+__attribute__ ((aligned (32)))
+static uint8_t roi_slots[APP_ROI_NB_SLOTS][ROI_NN_LEN + 32 - ROI_NN_LEN%32];
+static app_roi_batch_t roi_batch;
+static roi_net_ctx_t roi_net_ctx;
+#if !APP_PIPELINE_MODE
+/* The classifier overwrites the NN outputs the detections may live in */
+static od_pp_outBuffer_t roi_detections[MAX_NUMBER_DISPLAYED];
+static od_pp_out_t roi_output = { .pOutBuff = roi_detections };
+
+/* NN frame the ROIs are cropped from, both networks reuse the NN input buffer */
+#define ROI_FRAME_LEN (ALIGN_TO_16(NN_WIDTH * NN_BPP) * NN_HEIGHT)
+__attribute__ ((section (".psram_bss")))
+__attribute__ ((aligned (32)))
+static uint8_t roi_frame[ROI_FRAME_LEN + 32 - ROI_FRAME_LEN%32];
+#endif
+#endif
+
+#if APP_TRACKER
+/* Display pipe frames since the last tracker step */
+volatile int32_t displayFrameReceived;
+static od_tracker_pp_static_param_t tracker_params;
+static od_tracker_pp_outBuffer_t tracker_tracks[AI_OD_TRACKER_PP_MAX_TRACKS];
+static od_tracker_pp_out_t tracker_output = { .pOutBuff = tracker_tracks };
+static uint32_t display_track_ids[MAX_NUMBER_DISPLAYED];
+#if !APP_PIPELINE_MODE
+static od_pp_outBuffer_t tracker_detections[MAX_NUMBER_DISPLAYED];
+static od_pp_out_t tracker_display = { .pOutBuff = tracker_detections };
+#endif
+#endif
+
 /* Lcd Background Buffer */
 __attribute__ ((section (".psram_bss")))
 __attribute__ ((aligned (32)))
@@ -127,12 +197,24 @@ static int lcd_fg_buffer_rd_idx;
 static void SystemClock_Config(void);
 static void NPURam_enable(void);
 static void NPUCache_config(void);
-static void Display_NetworkOutput(od_pp_out_t *p_postprocess, uint32_t inference_ms);
+static void Display_NetworkOutput(od_pp_out_t *p_postprocess, const uint32_t *track_ids, uint32_t inference_ms);
 static void LCD_init(void);
 static void Security_Config(void);
 static void set_clk_sleep_mode(void);
 static void IAC_Config(void);
 static void Display_WelcomeScreen(void);
+#if APP_ROI_CLASSIFIER
+static void ROI_Init(void);
+static void ROI_Classify(od_pp_out_t *p_detections, const uint8_t *nn_frame, uint32_t pitch_nn);
+static void ROI_NetStart(void *ctx, uint8_t *input);
+static int32_t ROI_NetPoll(void *ctx);
+static void ROI_NetIdle(void *ctx);
+static void ROI_NetResult(void *ctx, uint32_t box_idx);
+#endif
+#if APP_TRACKER
+static void Tracker_Step(od_pp_out_t *p_detections);
+static void Tracker_Output(od_pp_out_t *p_display, uint32_t *track_ids);
+#endif
 
 /**
   * @brief  Main program
@@ -214,6 +296,13 @@ int main(void)
   /*** Post Processing Init ***************************************************/
   app_postprocess_init(&pp_params);
 
+#if APP_ROI_CLASSIFIER
+  ROI_Init();
+#endif
+#if APP_TRACKER
+  app_tracker_init(&tracker_params);
+#endif
+
   /*** Camera Init ************************************************************/
 
   CAM_Init(&lcd_bg_area.XSize, &lcd_bg_area.YSize, &pitch_nn);
@@ -223,31 +312,191 @@ int main(void)
   /* Start LCD Display camera pipe stream */
   CAM_DisplayPipe_Start(lcd_bg_buffer, CMW_MODE_CONTINUOUS);
 
+#if APP_PIPELINE_MODE
+  uint8_t *nn_pipe_buffers[APP_PIPE_NB_BUFFERS];
+  for (int i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    nn_pipe_buffers[i] = nn_pipe_buffer[i];
+  }
+  app_pipe_init(&nn_pipe, nn_pipe_buffers);
+
+  /* Start NN camera continuous capture, app_pipe_frame_done() rotates the buffers */
+  CAM_NNPipe_Start(app_pipe_capture_buffer(&nn_pipe), CMW_MODE_CONTINUOUS);
+
+  LL_ATON_RT_RuntimeInit();
+
   /*** App Loop ***************************************************************/
+  /* The NPU runs frame k while the CPU draws the results of frame k-1 and the camera
+   * captures frame k+1. Post processing reads the NN outputs so it runs as soon as the
+   * inference is done, before the next inference is started. */
+  LL_ATON_RT_RetValues_t ll_aton_rt_ret = LL_ATON_RT_DONE;
+  uint32_t nn_frame_id = 0;
+#if APP_ROI_CLASSIFIER
+  uint8_t *nn_frame = NULL;
+  int32_t nn_frame_idx = -1;
+#endif
+  uint32_t ts[2] = { 0 };
+  int nn_running = 0;
+  int display_pending = 0;
+
   while (1)
   {
     CAM_IspUpdate();
 
-    if (pitch_nn != (NN_WIDTH * NN_BPP))
+    if (!nn_running)
     {
-      /* Start NN camera single capture Snapshot */
-      CAM_NNPipe_Start(dcmipp_out_nn, CMW_MODE_SNAPSHOT);
+      uint8_t *frame;
+      int32_t frame_idx;
+
+      __disable_irq();
+      frame_idx = app_pipe_acquire(&nn_pipe, &frame, &nn_frame_id);
+      __enable_irq();
+
+      if (frame_idx >= 0)
+      {
+        SCB_InvalidateDCache_by_Addr(frame, NN_PIPE_BUFF_LEN);
+        img_crop(frame, nn_in, pitch_nn, NN_WIDTH, NN_HEIGHT, NN_BPP);
+        SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
+
+#if APP_ROI_CLASSIFIER
+        /* Held until the ROIs of its detections are cropped */
+        nn_frame = frame;
+        nn_frame_idx = frame_idx;
+#else
+        __disable_irq();
+        app_pipe_release(&nn_pipe, frame_idx);
+        __enable_irq();
+#endif
+
+        ts[0] = HAL_GetTick();
+        LL_ATON_RT_Init_Network(&NN_Instance_Default);
+        /* Start the first epoch block so that the NPU works during the draw */
+        ll_aton_rt_ret = LL_ATON_RT_RunEpochBlock(&NN_Instance_Default);
+        nn_running = 1;
+      }
     }
-    else
+
+    if (display_pending)
+    {
+#if APP_TRACKER
+      Display_NetworkOutput(&display_output, display_track_ids, display_inference_ms);
+#else
+      Display_NetworkOutput(&display_output, NULL, display_inference_ms);
+#endif
+      display_pending = 0;
+    }
+
+    if (!nn_running)
+    {
+      /* Nothing to run, wait for the next frame */
+      while (cameraFrameReceived == 0) {};
+      cameraFrameReceived = 0;
+      continue;
+    }
+
+    if (ll_aton_rt_ret != LL_ATON_RT_DONE)
+    {
+      if (ll_aton_rt_ret == LL_ATON_RT_WFE)
+      {
+        LL_ATON_OSAL_WFE();
+      }
+      ll_aton_rt_ret = LL_ATON_RT_RunEpochBlock(&NN_Instance_Default);
+      if (ll_aton_rt_ret != LL_ATON_RT_DONE)
+      {
+        continue;
+      }
+    }
+
+    ts[1] = HAL_GetTick();
+    LL_ATON_RT_DeInit_Network(&NN_Instance_Default);
+    nn_running = 0;
+
+    int32_t ret = app_postprocess_run((void **) nn_out, number_output, &pp_output, &pp_params);
+    assert(ret == 0);
+
+    /* Detections may live in the NN outputs, keep a copy for the display */
+    assert(nn_frame_id > display_frame_id);
+    display_output.nb_detect = pp_output.nb_detect < MAX_NUMBER_DISPLAYED ? pp_output.nb_detect : MAX_NUMBER_DISPLAYED;
+    memcpy(display_detections, pp_output.pOutBuff, display_output.nb_detect * sizeof(od_pp_outBuffer_t));
+#if APP_ROI_CLASSIFIER
+    ROI_Classify(&display_output, nn_frame, pitch_nn);
+    __disable_irq();
+    app_pipe_release(&nn_pipe, nn_frame_idx);
+    __enable_irq();
+#endif
+#if APP_TRACKER
+    Tracker_Step(&display_output);
+    Tracker_Output(&display_output, display_track_ids);
+#endif
+    display_frame_id = nn_frame_id;
+    display_inference_ms = ts[1] - ts[0];
+    display_pending = 1;
+
+    /* Discard nn_out region (used by pp_input and pp_outputs variables) to avoid Dcache evictions during nn inference */
+    for (int i = 0; i < number_output; i++)
+    {
+      float32_t *tmp = nn_out[i];
+      SCB_InvalidateDCache_by_Addr(tmp, nn_out_len[i]);
+    }
+  }
+#else
+  /* For models not multiple of 16, the padded frame is captured in the NN input buffer itself,
+   * overflowing on activations that are dead between inferences, and its lines are packed in place.
+   * When it would overwrite anything else, it is captured in dcmipp_out_nn and cropped into nn_in.
+   * With the ROI classifier, it is captured in roi_frame, which the networks do not overwrite */
+  uint8_t *nn_capture = nn_in;
+#if APP_ROI_CLASSIFIER
+  nn_capture = roi_frame;
+#else
+  if ((pitch_nn != (NN_WIDTH * NN_BPP)) &&
+      !img_crop_inplace_fits(&nn_in_info[0], LL_ATON_Internal_Buffers_Info_Default(), nn_out_info,
+                             pitch_nn * NN_HEIGHT))
+  {
+    nn_capture = dcmipp_out_nn;
+  }
+#endif
+
+#if APP_TRACKER
+  uint32_t tracker_step = 0;
+  uint32_t tracker_inference_ms = 0;
+#endif
+
+  /*** App Loop ***************************************************************/
+  while (1)
+  {
+    CAM_IspUpdate();
+
+#if APP_TRACKER
+    if ((tracker_step++ % APP_TRACKER_DETECT_PERIOD) != 0)
     {
-      /* Start NN camera single capture Snapshot */
-      CAM_NNPipe_Start(nn_in, CMW_MODE_SNAPSHOT);
+      /* Detector skipped, the tracks are extrapolated to the next displayed frame */
+      while (displayFrameReceived == 0) {};
+      Tracker_Step(NULL);
+      Tracker_Output(&tracker_display, display_track_ids);
+      Display_NetworkOutput(&tracker_display, display_track_ids, tracker_inference_ms);
+      continue;
     }
+#endif
+
+    /* Start NN camera single capture Snapshot */
+    CAM_NNPipe_Start(nn_capture, CMW_MODE_SNAPSHOT);
 
     while (cameraFrameReceived == 0) {};
     cameraFrameReceived = 0;
 
     uint32_t ts[2] = { 0 };
 
-    if (pitch_nn != (NN_WIDTH * NN_BPP))
+    if ((pitch_nn != (NN_WIDTH * NN_BPP)) || (nn_capture != nn_in))
     {
-      SCB_InvalidateDCache_by_Addr(dcmipp_out_nn, sizeof(dcmipp_out_nn));
-      img_crop(dcmipp_out_nn, nn_in, pitch_nn, NN_WIDTH, NN_HEIGHT, NN_BPP);
+      SCB_InvalidateDCache_by_Addr(nn_capture, pitch_nn * NN_HEIGHT);
+      if (nn_capture == nn_in)
+      {
+        img_crop_inplace(nn_in, pitch_nn, NN_WIDTH, NN_HEIGHT, NN_BPP);
+      }
+      else
+      {
+        img_crop(nn_capture, nn_in, pitch_nn, NN_WIDTH, NN_HEIGHT, NN_BPP);
+      }
       SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
     }
 
@@ -259,7 +508,21 @@ int main(void)
     int32_t ret = app_postprocess_run((void **) nn_out, number_output, &pp_output, &pp_params);
     assert(ret == 0);
 
-    Display_NetworkOutput(&pp_output, ts[1] - ts[0]);
+    od_pp_out_t *p_detections = &pp_output;
+#if APP_ROI_CLASSIFIER
+    roi_output.nb_detect = pp_output.nb_detect < MAX_NUMBER_DISPLAYED ? pp_output.nb_detect : MAX_NUMBER_DISPLAYED;
+    memcpy(roi_detections, pp_output.pOutBuff, roi_output.nb_detect * sizeof(od_pp_outBuffer_t));
+    ROI_Classify(&roi_output, roi_frame, pitch_nn);
+    p_detections = &roi_output;
+#endif
+#if APP_TRACKER
+    Tracker_Step(p_detections);
+    Tracker_Output(&tracker_display, display_track_ids);
+    tracker_inference_ms = ts[1] - ts[0];
+    Display_NetworkOutput(&tracker_display, display_track_ids, ts[1] - ts[0]);
+#else
+    Display_NetworkOutput(p_detections, NULL, ts[1] - ts[0]);
+#endif
     /* Discard nn_out region (used by pp_input and pp_outputs variables) to avoid Dcache evictions during nn inference */
     for (int i = 0; i < number_output; i++)
     {
@@ -267,8 +530,192 @@ int main(void)
       SCB_InvalidateDCache_by_Addr(tmp, nn_out_len[i]);
     }
   }
+#endif
+}
+
+#if APP_ROI_CLASSIFIER
+static void ROI_Init(void)
+{
+  const LL_Buffer_InfoTypeDef *in_info = LL_ATON_Input_Buffers_Info_classifier();
+  const LL_Buffer_InfoTypeDef *out_info = LL_ATON_Output_Buffers_Info_classifier();
+  const app_roi_net_t net = {
+    .ctx = &roi_net_ctx,
+    .start = ROI_NetStart,
+    .poll = ROI_NetPoll,
+    .idle = ROI_NetIdle,
+    .result = ROI_NetResult,
+  };
+  const app_roi_input_t input = {
+    .width = ROI_NN_WIDTH,
+    .height = ROI_NN_HEIGHT,
+    .bgr = (COLOR_MODE == COLOR_BGR),
+  };
+  uint8_t *slots[APP_ROI_NB_SLOTS];
+
+  roi_net_ctx.nn = &NN_Instance_classifier;
+  roi_net_ctx.nn_in = (uint8_t *) LL_Buffer_addr_start(&in_info[0]);
+  roi_net_ctx.nn_in_len = LL_Buffer_len(&in_info[0]);
+  roi_net_ctx.nn_out = (float32_t *) LL_Buffer_addr_start(&out_info[0]);
+  roi_net_ctx.nn_out_len = LL_Buffer_len(&out_info[0]);
+  assert(roi_net_ctx.nn_in_len == ROI_NN_LEN);
+  /* The classifier labels are the ones of classes_table */
+  assert(roi_net_ctx.nn_out_len / sizeof(float32_t) <= NB_CLASSES);
+
+  for (int i = 0; i < APP_ROI_NB_SLOTS; i++)
+  {
+    slots[i] = roi_slots[i];
+  }
+  app_roi_init(&roi_batch, &net, &input, slots);
+}
+
+/**
+ * @brief Replaces the class and confidence of the first APP_ROI_MAX_ROIS detections by the
+ *        top-1 of the classifier run on their crop of the NN frame they were detected in.
+ *        The detections must not live in NPU memory.
+ * @param nn_frame NN pipe capture, with lines of pitch_nn bytes, that the camera no longer
+ *        writes and whose cache lines were invalidated after the capture
+ */
+static void ROI_Classify(od_pp_out_t *p_detections, const uint8_t *nn_frame, uint32_t pitch_nn)
+{
+  const app_roi_frame_t frame = {
+    .pixels = nn_frame,
+    .width = NN_WIDTH,
+    .height = NN_HEIGHT,
+    .pitch = pitch_nn,
+    .bpp = NN_BPP,
+    .bgr = (COLOR_MODE == COLOR_BGR),
+  };
+
+  roi_net_ctx.detections = p_detections->pOutBuff;
+  roi_net_ctx.started = 0;
+
+#if !APP_PIPELINE_MODE
+  /* LL_ATON_RT_Main() of the detector de-initializes the runtime */
+  LL_ATON_RT_RuntimeInit();
+#endif
+  app_roi_run(&roi_batch, &frame, p_detections->pOutBuff, p_detections->nb_detect);
+  if (roi_net_ctx.started)
+  {
+    LL_ATON_RT_DeInit_Network(&NN_Instance_classifier);
+  }
+#if !APP_PIPELINE_MODE
+  LL_ATON_RT_RuntimeDeInit();
+#endif
+}
+
+static void ROI_NetStart(void *ctx, uint8_t *input)
+{
+  roi_net_ctx_t *c = (roi_net_ctx_t *) ctx;
+
+  /* Network I/O are fixed by the epoch controller blob */
+  memcpy(c->nn_in, input, c->nn_in_len);
+  SCB_CleanInvalidateDCache_by_Addr(c->nn_in, c->nn_in_len);
+
+  /* Back-to-back inferences only reset the network */
+  if (c->started)
+  {
+    LL_ATON_RT_Reset_Network(c->nn);
+  }
+  else
+  {
+    LL_ATON_RT_Init_Network(c->nn);
+    c->started = 1;
+  }
+}
+
+static int32_t ROI_NetPoll(void *ctx)
+{
+  roi_net_ctx_t *c = (roi_net_ctx_t *) ctx;
+  LL_ATON_RT_RetValues_t ll_aton_rt_ret = LL_ATON_RT_RunEpochBlock(c->nn);
+
+  c->wfe = (ll_aton_rt_ret == LL_ATON_RT_WFE);
+
+  return ll_aton_rt_ret == LL_ATON_RT_DONE;
+}
+
+static void ROI_NetIdle(void *ctx)
+{
+  roi_net_ctx_t *c = (roi_net_ctx_t *) ctx;
+
+  if (c->wfe)
+  {
+    LL_ATON_OSAL_WFE();
+  }
 }
 
+static void ROI_NetResult(void *ctx, uint32_t box_idx)
+{
+  roi_net_ctx_t *c = (roi_net_ctx_t *) ctx;
+  uint32_t nb_classes = c->nn_out_len / sizeof(float32_t);
+  uint32_t best = 0;
+
+  SCB_InvalidateDCache_by_Addr(c->nn_out, c->nn_out_len);
+  for (uint32_t i = 1; i < nb_classes; i++)
+  {
+    if (c->nn_out[i] > c->nn_out[best])
+    {
+      best = i;
+    }
+  }
+  c->detections[box_idx].class_index = best;
+  c->detections[box_idx].conf = c->nn_out[best];
+}
+#endif
+
+#if APP_TRACKER
+/**
+ * @brief Moves the tracker to the last displayed frame: the tracks are extrapolated over the
+ *        frames displayed since the previous step, then updated with the detections if any
+ * @param p_detections detections of the frame, NULL when the detector did not run
+ */
+static void Tracker_Step(od_pp_out_t *p_detections)
+{
+  int32_t nb_frames;
+
+  __disable_irq();
+  nb_frames = displayFrameReceived;
+  displayFrameReceived = 0;
+  __enable_irq();
+
+  for (int32_t i = 1; i < nb_frames; i++)
+  {
+    od_tracker_pp_predict(&tracker_output, &tracker_params);
+  }
+
+  if (p_detections)
+  {
+    od_tracker_pp_update(p_detections, &tracker_output, &tracker_params);
+  }
+  else
+  {
+    od_tracker_pp_predict(&tracker_output, &tracker_params);
+  }
+}
+
+/**
+ * @brief Copies the confirmed tracks to a display buffer of MAX_NUMBER_DISPLAYED detections
+ */
+static void Tracker_Output(od_pp_out_t *p_display, uint32_t *track_ids)
+{
+  int32_t nb_tracks = tracker_output.nb_tracks < MAX_NUMBER_DISPLAYED ? tracker_output.nb_tracks : MAX_NUMBER_DISPLAYED;
+
+  for (int32_t i = 0; i < nb_tracks; i++)
+  {
+    od_tracker_pp_outBuffer_t *track = &tracker_output.pOutBuff[i];
+    od_pp_outBuffer_t *box = &p_display->pOutBuff[i];
+
+    box->x_center = track->x_center;
+    box->y_center = track->y_center;
+    box->width = track->width;
+    box->height = track->height;
+    box->conf = track->conf;
+    box->class_index = track->class_index;
+    track_ids[i] = track->track_id;
+  }
+  p_display->nb_detect = nb_tracks;
+}
+#endif
+
 static void NPURam_enable(void)
 {
   __HAL_RCC_NPU_CLK_ENABLE();
@@ -364,9 +811,10 @@ void IAC_IRQHandler(void)
 * @brief Display Neural Network output classification results as well as other performances informations
 *
 * @param p_postprocess pointer to postprocessing output
+* @param track_ids track id of each detection, NULL if not tracked
 * @param inference_ms inference time in ms
 */
-static void Display_NetworkOutput(od_pp_out_t *p_postprocess, uint32_t inference_ms)
+static void Display_NetworkOutput(od_pp_out_t *p_postprocess, const uint32_t *track_ids, uint32_t inference_ms)
 {
 
   od_pp_outBuffer_t *rois = p_postprocess->pOutBuff;
@@ -390,7 +838,14 @@ static void Display_NetworkOutput(od_pp_out_t *p_postprocess, uint32_t inference
     width = ((x0 + width) < lcd_bg_area.X0 + lcd_bg_area.XSize) ? width : (lcd_bg_area.X0 + lcd_bg_area.XSize - x0 - 1);
     height = ((y0 + height) < lcd_bg_area.Y0 + lcd_bg_area.YSize) ? height : (lcd_bg_area.Y0 + lcd_bg_area.YSize - y0 - 1);
     UTIL_LCD_DrawRect(x0, y0, width, height, colors[rois[i].class_index % NUMBER_COLORS]);
-    UTIL_LCDEx_PrintfAt(x0, y0, LEFT_MODE, classes_table[rois[i].class_index]);
+    if (track_ids)
+    {
+      UTIL_LCDEx_PrintfAt(x0, y0, LEFT_MODE, "%s #%u", classes_table[rois[i].class_index], track_ids[i]);
+    }
+    else
+    {
+      UTIL_LCDEx_PrintfAt(x0, y0, LEFT_MODE, classes_table[rois[i].class_index]);
+    }
     UTIL_LCDEx_PrintfAt(-x0-width, y0, RIGHT_MODE, "%.0f%%", rois[i].conf*100.0f);
   }
 
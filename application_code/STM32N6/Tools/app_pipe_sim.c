@@ -0,0 +1,248 @@
+ /**
+ ******************************************************************************
+ * @file    app_pipe_sim.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host simulation of the APP_PIPELINE_MODE loop of main.c, built on the real app_pipe.c
+ * with mocked stage latencies. Checks that every displayed result comes from the frame
+ * it is tagged with, that frame ids increase, and compares the throughput with the
+ * sequential loop.
+ * The NPU follows the order of main.c: LL_ATON_RT_Init_Network() then one
+ * LL_ATON_RT_RunEpochBlock() start the first epoch block before the draw, the next blocks
+ * are only started by the polling loop after the draw. The inference is split in
+ * epoch_blocks blocks of equal length (1 when the network runs on the epoch controller).
+ * "late start" is the same loop with the first LL_ATON_RT_RunEpochBlock() after the draw.
+ * "held" keeps the frame held until its results are out, as with APP_ROI_CLASSIFIER, and checks
+ * that the camera did not overwrite it meanwhile.
+ *
+ * From application_code/STM32N6:
+ *   gcc -O2 -Wall -IInc Tools/app_pipe_sim.c Src/app_pipe.c -o app_pipe_sim && ./app_pipe_sim
+ */
+#include "app_pipe.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_FRAMES 3000
+#define SIM_BUFF_LEN 16
+
+typedef struct
+{
+  const char *name;
+  /* Stage latencies in us */
+  uint32_t camera_period;
+  uint32_t copy;
+  uint32_t inference;
+  uint32_t epoch_blocks;
+  uint32_t postprocess;
+  uint32_t display;
+} sim_config_t;
+
+typedef struct
+{
+  uint32_t nb_displayed;
+  uint32_t nb_dropped;
+  uint64_t end_time;
+  uint64_t latency_sum;
+  uint64_t latency_max;
+} sim_result_t;
+
+static uint8_t sim_buffers[APP_PIPE_NB_BUFFERS][SIM_BUFF_LEN];
+static app_pipe_t sim_pipe;
+static uint8_t *sim_capture;
+static uint32_t sim_cam_frame;
+
+/* Frame k is captured during ((k - 1) * period, k * period] and gets id k */
+static uint64_t sim_frame_end(const sim_config_t *cfg, uint32_t id)
+{
+  return (uint64_t) id * cfg->camera_period;
+}
+
+/* Camera interrupts up to time t: the DMA wrote the frame tag, then the ISR rotates the ring */
+static void sim_camera_until(const sim_config_t *cfg, uint64_t t)
+{
+  while (sim_frame_end(cfg, sim_cam_frame + 1) <= t)
+  {
+    sim_cam_frame++;
+    memcpy(sim_capture, &sim_cam_frame, sizeof(sim_cam_frame));
+    sim_capture = app_pipe_frame_done(&sim_pipe);
+  }
+}
+
+static sim_result_t sim_pipelined(const sim_config_t *cfg, int start_before_draw, int hold)
+{
+  sim_result_t res = { 0 };
+  uint8_t *buffers[APP_PIPE_NB_BUFFERS];
+  uint8_t nn_in[SIM_BUFF_LEN];
+  uint64_t t = 0;
+  uint64_t npu_end = 0;
+  uint64_t npu_left = 0;
+  uint32_t nn_frame_id = 0;
+  uint32_t nn_input_tag = 0;
+  uint32_t display_frame_id = 0;
+  uint32_t display_tag = 0;
+  uint8_t *nn_frame = NULL;
+  int32_t nn_frame_idx = -1;
+  int nn_running = 0;
+  int display_pending = 0;
+
+  for (int i = 0; i < APP_PIPE_NB_BUFFERS; i++)
+  {
+    buffers[i] = sim_buffers[i];
+    memset(sim_buffers[i], 0, SIM_BUFF_LEN);
+  }
+  app_pipe_init(&sim_pipe, buffers);
+  sim_capture = app_pipe_capture_buffer(&sim_pipe);
+  sim_cam_frame = 0;
+
+  while (res.nb_displayed < SIM_FRAMES)
+  {
+    sim_camera_until(cfg, t);
+
+    if (!nn_running)
+    {
+      uint8_t *frame;
+      int32_t frame_idx = app_pipe_acquire(&sim_pipe, &frame, &nn_frame_id);
+
+      if (frame_idx >= 0)
+      {
+        /* Frames captured during the copy must not land in the held buffer */
+        memcpy(nn_in, frame, SIM_BUFF_LEN);
+        t += cfg->copy;
+        sim_camera_until(cfg, t);
+        assert(memcmp(nn_in, frame, SIM_BUFF_LEN) == 0);
+        if (hold)
+        {
+          nn_frame = frame;
+          nn_frame_idx = frame_idx;
+        }
+        else
+        {
+          app_pipe_release(&sim_pipe, frame_idx);
+        }
+
+        memcpy(&nn_input_tag, nn_in, sizeof(nn_input_tag));
+        /* The first epoch block runs on the NPU while the CPU draws */
+        uint32_t block = start_before_draw ? cfg->inference / cfg->epoch_blocks : 0;
+        npu_end = t + block;
+        npu_left = cfg->inference - block;
+        nn_running = 1;
+      }
+    }
+
+    if (display_pending)
+    {
+      t += cfg->display;
+      assert(display_tag == display_frame_id);
+      uint64_t latency = t - sim_frame_end(cfg, display_frame_id);
+      res.latency_sum += latency;
+      res.latency_max = latency > res.latency_max ? latency : res.latency_max;
+      res.nb_displayed++;
+      display_pending = 0;
+    }
+
+    if (!nn_running)
+    {
+      /* Wait for the next frame */
+      uint64_t next = sim_frame_end(cfg, sim_cam_frame + 1);
+      t = next > t ? next : t;
+      continue;
+    }
+
+    /* WFE until the started block is done, the polling loop then chains the other blocks.
+     * Camera interrupts are served meanwhile */
+    t = npu_end > t ? npu_end : t;
+    t += npu_left;
+    sim_camera_until(cfg, t);
+    nn_running = 0;
+
+    t += cfg->postprocess;
+    if (hold)
+    {
+      sim_camera_until(cfg, t);
+      assert(memcmp(nn_in, nn_frame, SIM_BUFF_LEN) == 0);
+      app_pipe_release(&sim_pipe, nn_frame_idx);
+    }
+    assert(nn_frame_id > display_frame_id);
+    display_frame_id = nn_frame_id;
+    display_tag = nn_input_tag;
+    display_pending = 1;
+  }
+
+  res.nb_dropped = sim_pipe.nb_dropped;
+  res.end_time = t;
+  return res;
+}
+
+static sim_result_t sim_sequential(const sim_config_t *cfg)
+{
+  sim_result_t res = { 0 };
+  uint64_t t = 0;
+
+  while (res.nb_displayed < SIM_FRAMES)
+  {
+    /* Snapshot: the capture starts with the next frame */
+    uint64_t start = (t + cfg->camera_period - 1) / cfg->camera_period * cfg->camera_period;
+    uint64_t frame_end = start + cfg->camera_period;
+
+    t = frame_end + cfg->copy + cfg->inference + cfg->postprocess + cfg->display;
+    uint64_t latency = t - frame_end;
+    res.latency_sum += latency;
+    res.latency_max = latency > res.latency_max ? latency : res.latency_max;
+    res.nb_displayed++;
+  }
+
+  res.end_time = t;
+  return res;
+}
+
+static void sim_print(const char *loop, const sim_result_t *res)
+{
+  printf("  %-10s %6.1f fps  latency avg %5.1f ms max %5.1f ms  dropped %u\n", loop,
+         res->nb_displayed * 1e6 / res->end_time,
+         res->latency_sum / 1e3 / res->nb_displayed,
+         res->latency_max / 1e3,
+         res->nb_dropped);
+}
+
+int main(void)
+{
+  const sim_config_t configs[] = {
+    /* name                          camera  copy  inference  blocks  postprocess  display */
+    { "yolov2 224 @30fps",           33333,  400,  12000,     1,      2000,        9000 },
+    { "yolov8 256 @30fps",           33333,  600,  22000,     1,      6000,        9000 },
+    { "yolov8 256 @30fps, 4 blocks", 33333,  600,  22000,     4,      6000,        9000 },
+    { "yolov8 256 @60fps",           16667,  600,  22000,     1,      6000,        9000 },
+    { "npu bound @30fps",            33333,  600,  45000,     1,      3000,        9000 },
+    { "cpu bound @30fps",            33333,  600,  10000,     1,      20000,       25000 },
+  };
+
+  for (uint32_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+  {
+    sim_result_t seq = sim_sequential(&configs[i]);
+    sim_result_t late = sim_pipelined(&configs[i], 0, 0);
+    sim_result_t pipe = sim_pipelined(&configs[i], 1, 0);
+    sim_result_t held = sim_pipelined(&configs[i], 1, 1);
+
+    printf("%s\n", configs[i].name);
+    sim_print("sequential", &seq);
+    sim_print("late start", &late);
+    sim_print("pipelined", &pipe);
+    sim_print("held", &held);
+  }
+
+  return 0;
+}
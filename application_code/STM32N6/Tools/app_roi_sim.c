@@ -0,0 +1,312 @@
+ /**
+ ******************************************************************************
+ * @file    app_roi_sim.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host reference of the APP_ROI_CLASSIFIER second stage, built on the real app_roi.c with a
+ * mocked NPU and mocked stage latencies.
+ * - Checks the crop geometry against an exact reference on a frame encoding its coordinates.
+ * - Checks that the channels of RGB888 frames are swapped only when their order differs from
+ *   the NN input one (the NN pipe frames are captured in the order of COLOR_MODE).
+ * - Checks that the batched run gives every box the result of its own crop, and never writes
+ *   a slot the NPU reads: the mocked inference hashes its input slot when it completes.
+ * - Compares the throughput with one LL_ATON_RT_Main() call per crop, which crops into the
+ *   NN input and initializes the runtime and the network for every ROI.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -IInc -I$L/Inc -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/app_roi_sim.c Src/app_roi.c \
+ *       -o app_roi_sim && ./app_roi_sim
+ */
+#include "app_roi.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_FRAME_WIDTH 800
+#define SIM_FRAME_HEIGHT 480
+#define SIM_FRAMES 200
+#define SIM_MAX_INPUT (224 * 224 * ROI_NN_BPP)
+
+typedef struct
+{
+  const char *name;
+  uint32_t nn_width;
+  uint32_t nn_height;
+  uint32_t nb_boxes;
+  /* Latencies in ns */
+  uint32_t crop_per_pixel;
+  uint32_t copy_per_byte;
+  uint32_t runtime_init;
+  uint32_t network_init;
+  uint32_t inference;
+} sim_config_t;
+
+typedef struct
+{
+  const sim_config_t *cfg;
+  uint64_t t;
+  uint64_t npu_end;
+  uint8_t *running_input;
+  int runtime_ready;
+  int started;
+  uint32_t results[APP_ROI_MAX_ROIS];
+} sim_net_t;
+
+static uint8_t sim_frame[SIM_FRAME_HEIGHT][SIM_FRAME_WIDTH * 3];
+static uint8_t sim_slots[APP_ROI_NB_SLOTS][SIM_MAX_INPUT];
+static uint8_t sim_nn_in[SIM_MAX_INPUT];
+static sim_net_t sim_net;
+static app_roi_input_t sim_input;
+
+static uint32_t sim_hash(const uint8_t *data, uint32_t len)
+{
+  uint32_t h = 2166136261u;
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+static uint32_t sim_input_len(void)
+{
+  return sim_input.width * sim_input.height * ROI_NN_BPP;
+}
+
+/* Mocked NPU: the inference result is the hash of its input, read when it completes */
+static void sim_start(void *ctx, uint8_t *input)
+{
+  sim_net_t *net = (sim_net_t *) ctx;
+
+  /* Copy to the fixed NN input, then Init_Network (first ROI) or Reset_Network */
+  net->t += (uint64_t) net->cfg->copy_per_byte * sim_input_len();
+  if (!net->runtime_ready)
+  {
+    net->t += net->cfg->runtime_init;
+    net->runtime_ready = 1;
+  }
+  net->t += net->cfg->network_init;
+  net->started = 1;
+  net->running_input = input;
+  net->npu_end = net->t + net->cfg->inference;
+}
+
+static int32_t sim_poll(void *ctx)
+{
+  sim_net_t *net = (sim_net_t *) ctx;
+
+  return net->t >= net->npu_end;
+}
+
+static void sim_idle(void *ctx)
+{
+  sim_net_t *net = (sim_net_t *) ctx;
+
+  net->t = net->npu_end > net->t ? net->npu_end : net->t;
+}
+
+static void sim_result(void *ctx, uint32_t box_idx)
+{
+  sim_net_t *net = (sim_net_t *) ctx;
+
+  assert(box_idx < APP_ROI_MAX_ROIS);
+  net->results[box_idx] = sim_hash(net->running_input, sim_input_len());
+}
+
+/* Real crop, charged to the simulated clock */
+static void sim_crop(const app_roi_frame_t *frame, const app_roi_rect_t *rect, const app_roi_input_t *input,
+                     uint8_t *dst, uint32_t y_start, uint32_t y_end)
+{
+  app_roi_crop_resize(frame, rect, input, dst, y_start, y_end);
+  sim_net.t += (uint64_t) sim_net.cfg->crop_per_pixel * input->width * (y_end - y_start);
+}
+
+static void sim_boxes(od_pp_outBuffer_t *boxes, uint32_t nb_boxes)
+{
+  for (uint32_t i = 0; i < nb_boxes; i++)
+  {
+    boxes[i].x_center = (float32_t) rand() / RAND_MAX * 1.1f - 0.05f;
+    boxes[i].y_center = (float32_t) rand() / RAND_MAX * 1.1f - 0.05f;
+    boxes[i].width = 0.02f + (float32_t) rand() / RAND_MAX * 0.4f;
+    boxes[i].height = 0.02f + (float32_t) rand() / RAND_MAX * 0.4f;
+    boxes[i].conf = 1.0f;
+    boxes[i].class_index = 0;
+  }
+}
+
+/* Pixel (x, y) of the frame encodes its coordinates */
+static void sim_fill_frame(void)
+{
+  for (uint32_t y = 0; y < SIM_FRAME_HEIGHT; y++)
+  {
+    for (uint32_t x = 0; x < SIM_FRAME_WIDTH; x++)
+    {
+      sim_frame[y][3 * x] = x & 0xFF;
+      sim_frame[y][3 * x + 1] = y & 0xFF;
+      sim_frame[y][3 * x + 2] = (x >> 8) | ((y >> 8) << 4);
+    }
+  }
+}
+
+/* Output pixels sample the source pixel under their center, within one pixel of rounding */
+static void sim_check_geometry(const app_roi_rect_t *rect, const uint8_t *dst)
+{
+  for (uint32_t y = 0; y < sim_input.height; y++)
+  {
+    for (uint32_t x = 0; x < sim_input.width; x++)
+    {
+      const uint8_t *p = dst + (y * sim_input.width + x) * ROI_NN_BPP;
+      int32_t sx = p[0] | ((p[2] & 0x0F) << 8);
+      int32_t sy = p[1] | ((p[2] >> 4) << 8);
+      int32_t ex = rect->x0 + ((2 * x + 1) * rect->width) / (2 * sim_input.width);
+      int32_t ey = rect->y0 + ((2 * y + 1) * rect->height) / (2 * sim_input.height);
+
+      assert(sx >= (int32_t) rect->x0 && sx < (int32_t) (rect->x0 + rect->width));
+      assert(sy >= (int32_t) rect->y0 && sy < (int32_t) (rect->y0 + rect->height));
+      assert(abs(sx - ex) <= 1 && abs(sy - ey) <= 1);
+    }
+  }
+}
+
+/* Every byte of the crop comes from the channel of the same color in the frame */
+static void sim_check_channels(app_roi_frame_t *frame)
+{
+  const app_roi_rect_t rect = { 0, 0, SIM_FRAME_WIDTH, SIM_FRAME_HEIGHT };
+  app_roi_input_t input = { 96, 96, 0 };
+
+  for (uint32_t order = 0; order < 4; order++)
+  {
+    frame->bgr = order & 1;
+    input.bgr = order >> 1;
+    app_roi_crop_resize(frame, &rect, &input, sim_nn_in, 0, input.height);
+    for (uint32_t y = 0; y < input.height; y++)
+    {
+      for (uint32_t x = 0; x < input.width; x++)
+      {
+        const uint8_t *p = sim_nn_in + (y * input.width + x) * ROI_NN_BPP;
+        const uint8_t *src = &sim_frame[(2 * y + 1) * SIM_FRAME_HEIGHT / (2 * input.height)]
+                                       [3 * ((2 * x + 1) * SIM_FRAME_WIDTH / (2 * input.width))];
+        uint32_t swap = (frame->bgr != input.bgr);
+
+        assert((p[0] == src[swap ? 2 : 0]) && (p[1] == src[1]) && (p[2] == src[swap ? 0 : 2]));
+      }
+    }
+  }
+  frame->bgr = 0;
+}
+
+/* Reference: one LL_ATON_RT_Main() per crop, the crop written in the NN input */
+static uint64_t sim_per_crop(const sim_config_t *cfg, const app_roi_frame_t *frame,
+                             const od_pp_outBuffer_t *boxes, uint32_t nb_boxes, uint32_t *results)
+{
+  uint64_t t = 0;
+  uint32_t nb_rois = 0;
+
+  for (uint32_t i = 0; (i < nb_boxes) && (nb_rois < APP_ROI_MAX_ROIS); i++)
+  {
+    app_roi_rect_t rect;
+
+    if (app_roi_box_to_rect(&boxes[i], frame->width, frame->height, &rect) != 0)
+    {
+      continue;
+    }
+    nb_rois++;
+    app_roi_crop_resize(frame, &rect, &sim_input, sim_nn_in, 0, sim_input.height);
+    sim_check_geometry(&rect, sim_nn_in);
+    t += (uint64_t) cfg->crop_per_pixel * sim_input.width * sim_input.height;
+    t += cfg->runtime_init + cfg->network_init + cfg->inference;
+    results[i] = sim_hash(sim_nn_in, sim_input_len());
+  }
+  return t;
+}
+
+int main(void)
+{
+  const sim_config_t configs[] = {
+    /* name                      w    h  boxes  crop/px copy/B  rt_init  nn_init  inference */
+    { "96x96, 4 boxes",         96,  96,  4,     20,     1,      150000,  40000,   900000 },
+    { "128x128, 8 boxes",      128, 128,  8,     20,     1,      150000,  40000,   1600000 },
+    { "128x128, 16 boxes",     128, 128, 16,     20,     1,      150000,  40000,   1600000 },
+    { "224x224, 8 boxes",      224, 224,  8,     20,     1,      150000,  40000,   4500000 },
+    { "crop bound 224, 8 boxes", 224, 224, 8,    60,     1,      150000,  40000,   1000000 },
+  };
+  app_roi_frame_t frame = {
+    .pixels = &sim_frame[0][0],
+    .width = SIM_FRAME_WIDTH,
+    .height = SIM_FRAME_HEIGHT,
+    .pitch = SIM_FRAME_WIDTH * 3,
+    .bpp = 3,
+    .bgr = 0,
+  };
+
+  sim_fill_frame();
+  sim_check_channels(&frame);
+
+  for (uint32_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+  {
+    const sim_config_t *cfg = &configs[c];
+    const app_roi_net_t net = { &sim_net, sim_start, sim_poll, sim_idle, sim_result };
+    uint8_t *slots[APP_ROI_NB_SLOTS];
+    app_roi_batch_t batch;
+    uint64_t t_batch = 0;
+    uint64_t t_per_crop = 0;
+    uint32_t nb_rois = 0;
+
+    sim_input.width = cfg->nn_width;
+    sim_input.height = cfg->nn_height;
+    sim_input.bgr = 0;
+    for (int i = 0; i < APP_ROI_NB_SLOTS; i++)
+    {
+      slots[i] = sim_slots[i];
+    }
+    app_roi_init(&batch, &net, &sim_input, slots);
+    batch.crop = sim_crop;
+    srand(c);
+
+    for (uint32_t f = 0; f < SIM_FRAMES; f++)
+    {
+      od_pp_outBuffer_t boxes[APP_ROI_MAX_ROIS];
+      uint32_t ref[APP_ROI_MAX_ROIS];
+
+      sim_boxes(boxes, cfg->nb_boxes);
+      memset(ref, 0, sizeof(ref));
+      memset(&sim_net, 0, sizeof(sim_net));
+      sim_net.cfg = cfg;
+
+      t_per_crop += sim_per_crop(cfg, &frame, boxes, cfg->nb_boxes, ref);
+
+      nb_rois += app_roi_run(&batch, &frame, boxes, cfg->nb_boxes);
+      t_batch += sim_net.t;
+
+      for (uint32_t k = 0; k < batch.nb_rois; k++)
+      {
+        uint32_t i = batch.box_idx[k];
+        assert(sim_net.results[i] == ref[i]);
+      }
+    }
+
+    printf("%s (%u ROIs)\n", cfg->name, nb_rois);
+    printf("  per crop  %7.2f ms/frame  %7.1f ROI/s\n", t_per_crop / 1e6 / SIM_FRAMES, nb_rois * 1e9 / t_per_crop);
+    printf("  batched   %7.2f ms/frame  %7.1f ROI/s  x%.2f\n", t_batch / 1e6 / SIM_FRAMES, nb_rois * 1e9 / t_batch,
+           (double) t_per_crop / t_batch);
+  }
+
+  return 0;
+}
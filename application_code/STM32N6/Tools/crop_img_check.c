@@ -0,0 +1,268 @@
+ /**
+ ******************************************************************************
+ * @file    crop_img_check.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check of the in-place capture of padded NN frames (models whose NN_WIDTH * NN_BPP is not
+ * a multiple of 16), built on the real crop_img.c.
+ * - img_crop_inplace() against img_crop() for odd widths, 1 to 4 bytes per pixel, DCMIPP pitches
+ *   (line size aligned to 16, and one more 16 bytes).
+ * - img_crop_inplace_fits() on synthetic buffer tables: the padded frame may only spill onto
+ *   activations of the input memory pool, never onto a gap, a parameter, another pool or an output.
+ * - img_crop_inplace_fits() on the buffer tables of the bundled Model/network.c (parsed from the
+ *   source, as network.c needs the target headers): the largest padded frame that fits in place,
+ *   and the odd widths of its input that main.c captures in place or in dcmipp_out_nn.
+ * The program returns 1 on a failure.
+ *
+ * From application_code/STM32N6:
+ *   gcc -O2 -Wall -DLL_ATON_PLATFORM=LL_ATON_PLAT_EC_TRACE -DLL_ATON_OSAL=LL_ATON_OSAL_BARE_METAL \
+ *       -IInc -IMiddlewares/AI_Runtime/Npu/ll_aton -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/crop_img_check.c Src/crop_img.c \
+ *       -o crop_img_check && ./crop_img_check
+ */
+#include "crop_img.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_ALIGN_TO_16(value) (((value) + 15) & ~15)
+#define CHECK_MAX_LINE 1024
+#define CHECK_MAX_HEIGHT 8
+#define CHECK_MAX_BUFFERS 512
+#define CHECK_POOL_A 0x34200000UL
+#define CHECK_POOL_B 0x34300000UL
+
+static uint8_t frame[CHECK_MAX_LINE * CHECK_MAX_HEIGHT];
+static uint8_t packed[CHECK_MAX_LINE * CHECK_MAX_HEIGHT];
+
+static int check_crop(void)
+{
+  int32_t nb_cases = 0, nb_differ = 0;
+
+  for (uint16_t bpp = 1; bpp <= 4; bpp++)
+  {
+    for (uint16_t width = 1; width <= 225; width += 2)
+    {
+      for (uint16_t height = 1; height <= CHECK_MAX_HEIGHT; height++)
+      {
+        for (uint32_t extra = 0; extra <= 16; extra += 16)
+        {
+          uint32_t pitch = CHECK_ALIGN_TO_16(width * bpp) + extra;
+
+          for (uint32_t i = 0; i < pitch * height; i++)
+          {
+            frame[i] = (uint8_t) (i * 31 + width + bpp);
+          }
+          img_crop(frame, packed, pitch, width, height, bpp);
+          img_crop_inplace(frame, pitch, width, height, bpp);
+          nb_differ += memcmp(frame, packed, width * bpp * height) != 0;
+          nb_cases++;
+        }
+      }
+    }
+  }
+  printf("img_crop_inplace: %d of %d width/bpp/height/pitch cases differ from img_crop\n",
+         (int) nb_differ, (int) nb_cases);
+
+  return nb_differ == 0;
+}
+
+static LL_Buffer_InfoTypeDef check_buffer(const char *name, uintptr_t pool, uint32_t start, uint32_t end,
+                                          uint8_t is_param)
+{
+  LL_Buffer_InfoTypeDef info = { 0 };
+
+  info.name = name;
+  info.addr_base.i = pool;
+  info.offset_start = start;
+  info.offset_end = end;
+  info.offset_limit = end + 64;
+  info.is_param = is_param;
+  return info;
+}
+
+static int check_fits_tables(void)
+{
+  /* Input [1000, 2000) of pool A; the frame is 1500 bytes unless stated otherwise */
+  const LL_Buffer_InfoTypeDef input[] = { check_buffer("in", CHECK_POOL_A, 1000, 2000, 0), { 0 } };
+  const LL_Buffer_InfoTypeDef no_output[] = { { 0 } };
+  const struct
+  {
+    const char *name;
+    LL_Buffer_InfoTypeDef internal[4];
+    LL_Buffer_InfoTypeDef output[2];
+    uint32_t frame_len;
+    int expected;
+  } cases[] = {
+    { "no padding", { { 0 } }, { { 0 } }, 1000, 1 },
+    { "no activation after the input", { { 0 } }, { { 0 } }, 1500, 0 },
+    { "one activation", { check_buffer("a", CHECK_POOL_A, 1800, 3000, 0) }, { { 0 } }, 1500, 1 },
+    { "chained, listed in reverse", { check_buffer("b", CHECK_POOL_A, 2400, 2600, 0),
+                                      check_buffer("a", CHECK_POOL_A, 2000, 2400, 0) }, { { 0 } }, 1500, 1 },
+    { "gap between activations", { check_buffer("a", CHECK_POOL_A, 2000, 2200, 0),
+                                   check_buffer("b", CHECK_POOL_A, 2300, 3000, 0) }, { { 0 } }, 1500, 0 },
+    { "activation too short", { check_buffer("a", CHECK_POOL_A, 2000, 2400, 0) }, { { 0 } }, 1500, 0 },
+    { "parameter after the input", { check_buffer("w", CHECK_POOL_A, 2000, 3000, 1) }, { { 0 } }, 1500, 0 },
+    { "activation of another pool", { check_buffer("a", CHECK_POOL_B, 2000, 3000, 0) }, { { 0 } }, 1500, 0 },
+    { "output in the overflow", { check_buffer("a", CHECK_POOL_A, 2000, 4000, 0) },
+                                { check_buffer("o", CHECK_POOL_A, 2400, 2410, 0) }, 1500, 0 },
+    { "output beyond the frame", { check_buffer("a", CHECK_POOL_A, 2000, 4000, 0) },
+                                 { check_buffer("o", CHECK_POOL_A, 2500, 2600, 0) }, 1500, 1 },
+    { "output of another pool", { check_buffer("a", CHECK_POOL_A, 2000, 4000, 0) },
+                                { check_buffer("o", CHECK_POOL_B, 2000, 2600, 0) }, 1500, 1 },
+  };
+  int ok = 1;
+
+  for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    int fits = img_crop_inplace_fits(&input[0], cases[i].internal, cases[i].output, cases[i].frame_len);
+
+    printf("  %-32s %-8s %s\n", cases[i].name, fits ? "in place" : "aside", (fits == cases[i].expected) ? "ok" : "WRONG");
+    ok &= (fits == cases[i].expected);
+  }
+  ok &= img_crop_inplace_fits(&input[0], NULL, no_output, 1000);
+
+  return ok;
+}
+
+/* Buffer tables of Model/network.c, read from the generated initializers */
+static LL_Buffer_InfoTypeDef net_buffers[3][CHECK_MAX_BUFFERS];
+static char net_names[3][CHECK_MAX_BUFFERS][96];
+
+static int check_parse_network(const char *path)
+{
+  const char *tables[3] = { "LL_ATON_Input_Buffers_Info_Default(void)", "LL_ATON_Output_Buffers_Info_Default(void)",
+                            "LL_ATON_Internal_Buffers_Info_Default(void)" };
+  char line[4096];
+  int32_t table = -1, nb = 0;
+  FILE *f = fopen(path, "r");
+
+  if (f == NULL)
+  {
+    return 0;
+  }
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    LL_Buffer_InfoTypeDef *pInfo = (table >= 0 && nb > 0) ? &net_buffers[table][nb - 1] : NULL;
+    char *p;
+    unsigned long value;
+
+    for (int32_t t = 0; t < 3; t++)
+    {
+      if (strstr(line, tables[t]) != NULL)
+      {
+        table = t;
+        nb = 0;
+        pInfo = NULL;
+      }
+    }
+    if (table < 0)
+    {
+      continue;
+    }
+    if (((p = strstr(line, ".name = \"")) != NULL) && (nb < CHECK_MAX_BUFFERS - 1))
+    {
+      char *q = strchr(p + 9, '"');
+
+      snprintf(net_names[table][nb], sizeof(net_names[table][nb]), "%.*s", (int) (q - p - 9), p + 9);
+      net_buffers[table][nb].name = net_names[table][nb];
+      nb++;
+    }
+    else if (pInfo != NULL && (p = strstr(line, ".addr_base = {(unsigned char *)(")) != NULL)
+    {
+      pInfo->addr_base.i = (uintptr_t) strtoul(p + 32, NULL, 0);
+    }
+    else if (pInfo != NULL && sscanf(line, " .offset_start = %lu", &value) == 1)
+    {
+      pInfo->offset_start = value;
+    }
+    else if (pInfo != NULL && sscanf(line, " .offset_end = %lu", &value) == 1)
+    {
+      pInfo->offset_end = value;
+    }
+    else if (pInfo != NULL && sscanf(line, " .offset_limit = %lu", &value) == 1)
+    {
+      pInfo->offset_limit = value;
+    }
+    else if (pInfo != NULL && sscanf(line, " .is_user_allocated = %lu", &value) == 1)
+    {
+      pInfo->is_user_allocated = value;
+    }
+    else if (pInfo != NULL && sscanf(line, " .is_param = %lu", &value) == 1)
+    {
+      pInfo->is_param = value;
+    }
+  }
+  fclose(f);
+
+  return (net_buffers[0][0].name != NULL) && (net_buffers[2][0].name != NULL);
+}
+
+static int check_fits_network(const char *path)
+{
+  const LL_Buffer_InfoTypeDef *pIn = &net_buffers[0][0];
+  uint32_t in_len, line, height, max_pitch = 0;
+  int bpp = 3;
+
+  if (!check_parse_network(path))
+  {
+    printf("%s: buffer tables not found\n", path);
+    return 0;
+  }
+  /* Input of the bundled network: height x width x 3 bytes, square */
+  in_len = pIn->offset_end - pIn->offset_start;
+  for (height = 1; height * height * bpp < in_len; height++) {};
+  line = in_len / height;
+  printf("%s: input %s, %u lines of %u bytes at 0x%08lx + %u\n", path, pIn->name, (unsigned) height,
+         (unsigned) line, (unsigned long) pIn->addr_base.i, (unsigned) pIn->offset_start);
+
+  for (uint32_t pitch = line; pitch <= 4 * line; pitch += 16)
+  {
+    if (img_crop_inplace_fits(pIn, net_buffers[2], net_buffers[1], pitch * height))
+    {
+      max_pitch = pitch;
+    }
+  }
+  printf("  largest padded pitch captured in place: %u bytes (%u per line beyond the input)\n",
+         (unsigned) max_pitch, (unsigned) (max_pitch - line));
+
+  /* Odd widths of the same height: NN_WIDTH * NN_BPP not a multiple of 16 */
+  for (uint32_t width = (line / bpp) - 7; width <= (line / bpp) + 8; width += 2)
+  {
+    uint32_t pitch = CHECK_ALIGN_TO_16(width * bpp);
+    LL_Buffer_InfoTypeDef in = *pIn;
+
+    in.offset_end = in.offset_start + width * bpp * height;
+    printf("  width %3u: pitch %4u, %s\n", (unsigned) width, (unsigned) pitch,
+           img_crop_inplace_fits(&in, net_buffers[2], net_buffers[1], pitch * height) ?
+           "captured in place" : "captured in dcmipp_out_nn");
+  }
+
+  return max_pitch >= line;
+}
+
+int main(int argc, char **argv)
+{
+  int ok = 1;
+
+  ok &= check_crop();
+  printf("img_crop_inplace_fits, synthetic tables:\n");
+  ok &= check_fits_tables();
+  ok &= check_fits_network(argc > 1 ? argv[1] : "Model/network.c");
+  printf("%s\n", ok ? "OK" : "FAILED");
+
+  return !ok;
+}
@@ -0,0 +1,315 @@
+ /**
+ ******************************************************************************
+ * @file    od_tracker_sim.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host reference of the APP_TRACKER stage, built on the real od_pp_tracker.c. It replays
+ * synthetic trajectories with a deterministic noisy detector that misses detections and
+ * adds false positives, the detector running every k frames.
+ * - Checks that every object keeps one track id, and that its smoothed or extrapolated
+ *   box follows the ground truth.
+ * - Checks that the optimal association solves a case the greedy one gets wrong.
+ * - Compares the box count flicker of the raw detections and of the tracks.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/od_tracker_sim.c \
+ *       $L/Src/od_pp_tracker.c $L/Src/vision_models_pp.c -lm -o od_tracker_sim && ./od_tracker_sim
+ */
+#include "od_tracker_pp_if.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_FRAMES 600
+#define SIM_MAX_OBJECTS 8
+#define SIM_MAX_DETECTIONS (SIM_MAX_OBJECTS + 2)
+/* Detector runs before the checks, objects missed at start are not confirmed yet */
+#define SIM_WARMUP 8
+
+typedef struct
+{
+  const char *name;
+  uint32_t nb_objects;
+  float32_t noise;            /* center noise, in box sizes */
+  uint32_t miss_per_256;      /* detections missed */
+  uint32_t false_per_256;     /* false positives per frame */
+  uint32_t detect_period;     /* detector run every detect_period frames */
+  od_tracker_pp_assoc_mode_e assoc_mode;
+} sim_config_t;
+
+typedef struct
+{
+  float32_t x0, y0;           /* trajectory: bouncing on the frame borders */
+  float32_t vx, vy;
+  float32_t width, height;
+  int32_t class_index;
+} sim_object_t;
+
+static uint32_t sim_seed;
+
+/* Deterministic on every host */
+static uint32_t sim_rand(void)
+{
+  sim_seed = sim_seed * 1664525u + 1013904223u;
+  return sim_seed >> 8;
+}
+
+static float32_t sim_uniform(void)
+{
+  return (float32_t) (sim_rand() & 0xFFFF) / 65536.0f - 0.5f;
+}
+
+static float32_t sim_bounce(float32_t p0, float32_t v, float32_t half, uint32_t frame)
+{
+  float32_t range = 1.0f - 2 * half;
+  float32_t p = fmodf(p0 - half + v * frame, 2 * range);
+
+  p = p < 0 ? p + 2 * range : p;
+  return half + (p < range ? p : 2 * range - p);
+}
+
+static void sim_truth(const sim_object_t *obj, uint32_t frame, od_pp_outBuffer_t *box)
+{
+  box->x_center = sim_bounce(obj->x0, obj->vx, obj->width / 2, frame);
+  box->y_center = sim_bounce(obj->y0, obj->vy, obj->height / 2, frame);
+  box->width = obj->width;
+  box->height = obj->height;
+  box->conf = 1.0f;
+  box->class_index = obj->class_index;
+}
+
+static float32_t sim_iou(const float32_t *a, const float32_t *b)
+{
+  float32_t w = fminf(a[0] + a[2] / 2, b[0] + b[2] / 2) - fmaxf(a[0] - a[2] / 2, b[0] - b[2] / 2);
+  float32_t h = fminf(a[1] + a[3] / 2, b[1] + b[3] / 2) - fmaxf(a[1] - a[3] / 2, b[1] - b[3] / 2);
+  float32_t i = (w > 0 && h > 0) ? w * h : 0;
+
+  return i / (a[2] * a[3] + b[2] * b[3] - i);
+}
+
+static void sim_params(od_tracker_pp_static_param_t *params, od_tracker_pp_assoc_mode_e assoc_mode)
+{
+  params->iou_threshold = 0.3f;
+  params->dist_threshold = 1.0f;
+  params->alpha = 0.6f;
+  params->beta = 0.3f;
+  params->min_hits = 2;
+  params->max_missed = 3;
+  params->assoc_mode = assoc_mode;
+  od_tracker_pp_reset(params);
+}
+
+/* Greedy: the pair of highest IoU is associated first, track 1 misses its detection and
+ * the other detection, overlapping track 2, is a duplicate.
+ * Optimal: each detection continues a track. */
+static void sim_check_assoc(void)
+{
+  static od_tracker_pp_static_param_t params;
+  od_tracker_pp_outBuffer_t out_buff[AI_OD_TRACKER_PP_MAX_TRACKS];
+  od_tracker_pp_out_t out = { .pOutBuff = out_buff };
+  od_pp_outBuffer_t tracks[2] = {
+    { 0.40f, 0.5f, 0.2f, 0.4f, 0.9f, 0 },
+    { 0.60f, 0.5f, 0.2f, 0.4f, 0.9f, 0 },
+  };
+  od_pp_outBuffer_t dets[2] = {
+    { 0.53f, 0.5f, 0.2f, 0.4f, 0.9f, 0 },   /* IoU 0.48 with track 2, 0.21 with track 1 */
+    { 0.68f, 0.5f, 0.2f, 0.4f, 0.8f, 0 },   /* IoU 0.43 with track 2 only */
+  };
+  od_pp_out_t in;
+
+  for (int mode = AI_OD_TRACKER_PP_ASSOC_GREEDY; mode <= AI_OD_TRACKER_PP_ASSOC_OPTIMAL; mode++)
+  {
+    sim_params(&params, mode);
+    params.min_hits = 1;
+    params.iou_threshold = 0.1f;
+    params.dist_threshold = 0;
+    params.beta = 0;
+    in.pOutBuff = tracks;
+    in.nb_detect = 2;
+    od_tracker_pp_update(&in, &out, &params);
+    in.pOutBuff = dets;
+    od_tracker_pp_update(&in, &out, &params);
+
+    assert(params.next_track_id == 3);
+    assert(out.nb_tracks == 2);
+    assert(out_buff[0].track_id == 1 && out_buff[1].track_id == 2);
+    assert(out_buff[1].nb_missed == 0);
+    assert(out_buff[0].nb_missed == (mode == AI_OD_TRACKER_PP_ASSOC_GREEDY ? 1 : 0));
+  }
+  printf("association: greedy continues one track, optimal both\n");
+}
+
+static void sim_run(const sim_config_t *cfg)
+{
+  static od_tracker_pp_static_param_t params;
+  od_tracker_pp_outBuffer_t out_buff[AI_OD_TRACKER_PP_MAX_TRACKS];
+  od_tracker_pp_out_t out = { .pOutBuff = out_buff };
+  od_pp_outBuffer_t dets[SIM_MAX_DETECTIONS];
+  sim_object_t objects[SIM_MAX_OBJECTS];
+  uint32_t ids[SIM_MAX_OBJECTS] = { 0 };
+  uint32_t id_switches = 0;
+  uint32_t nb_off = 0;
+  uint32_t det_flicker = 0;
+  uint32_t track_flicker = 0;
+  double det_err = 0, track_err = 0;
+  uint32_t nb_det_err = 0, nb_track_err = 0;
+  double sum_iou = 0;
+  double min_iou = 1;
+
+  sim_seed = 1;
+  for (uint32_t o = 0; o < cfg->nb_objects; o++)
+  {
+    /* Objects in their own horizontal lane, not to cross */
+    objects[o].width = 0.06f + 0.04f * (sim_uniform() + 0.5f);
+    objects[o].height = 0.6f / cfg->nb_objects;
+    objects[o].x0 = 0.5f + 0.8f * sim_uniform();
+    objects[o].y0 = (o + 0.5f) / cfg->nb_objects;
+    objects[o].vx = 0.004f + 0.006f * (sim_uniform() + 0.5f);
+    objects[o].vx = (o & 1) ? -objects[o].vx : objects[o].vx;
+    objects[o].vy = 0;
+    objects[o].class_index = o % 2;
+  }
+
+  sim_params(&params, cfg->assoc_mode);
+
+  uint32_t last_det_count = cfg->nb_objects;
+  uint32_t last_track_count = cfg->nb_objects;
+  for (uint32_t f = 0; f < SIM_FRAMES; f++)
+  {
+    int detect = (f % cfg->detect_period) == 0;
+
+    if (detect)
+    {
+      od_pp_out_t in = { .pOutBuff = dets, .nb_detect = 0 };
+
+      for (uint32_t o = 0; o < cfg->nb_objects; o++)
+      {
+        od_pp_outBuffer_t *det = &dets[in.nb_detect];
+
+        if ((sim_rand() & 0xFF) < cfg->miss_per_256)
+        {
+          continue;
+        }
+        sim_truth(&objects[o], f, det);
+        det->x_center += cfg->noise * det->width * sim_uniform() * 2;
+        det->y_center += cfg->noise * det->height * sim_uniform() * 2;
+        det->width *= 1 + 0.2f * sim_uniform();
+        det->height *= 1 + 0.2f * sim_uniform();
+        det->conf = 0.7f + 0.5f * sim_uniform();
+        det_err += fabsf(det->x_center - sim_bounce(objects[o].x0, objects[o].vx, objects[o].width / 2, f));
+        nb_det_err++;
+        in.nb_detect++;
+      }
+      if ((sim_rand() & 0xFF) < cfg->false_per_256)
+      {
+        od_pp_outBuffer_t *det = &dets[in.nb_detect++];
+
+        det->x_center = 0.5f + 0.9f * sim_uniform();
+        det->y_center = 0.5f + 0.9f * sim_uniform();
+        det->width = 0.08f;
+        det->height = 0.08f;
+        det->conf = 0.6f;
+        det->class_index = 0;
+      }
+      det_flicker += (uint32_t) in.nb_detect != last_det_count;
+      last_det_count = in.nb_detect;
+
+      od_tracker_pp_update(&in, &out, &params);
+    }
+    else
+    {
+      od_tracker_pp_predict(&out, &params);
+    }
+
+    /* Output count stable once the tracks are confirmed */
+    if (f >= SIM_WARMUP * cfg->detect_period)
+    {
+      track_flicker += (uint32_t) out.nb_tracks != last_track_count;
+    }
+    last_track_count = out.nb_tracks;
+
+    /* Each object is followed by the output track of its class of highest IoU */
+    for (uint32_t o = 0; (o < cfg->nb_objects) && (f >= SIM_WARMUP * cfg->detect_period); o++)
+    {
+      od_pp_outBuffer_t truth;
+      float32_t best_iou = 0;
+      int32_t best = -1;
+
+      sim_truth(&objects[o], f, &truth);
+      for (int32_t t = 0; t < out.nb_tracks; t++)
+      {
+        float32_t iou = sim_iou(&truth.x_center, &out_buff[t].x_center);
+        if ((out_buff[t].class_index == truth.class_index) && (iou > best_iou))
+        {
+          best_iou = iou;
+          best = t;
+        }
+      }
+      if (best < 0)
+      {
+        nb_off++;
+        continue;
+      }
+      if ((ids[o] != 0) && (ids[o] != out_buff[best].track_id))
+      {
+        id_switches++;
+      }
+      ids[o] = out_buff[best].track_id;
+      min_iou = best_iou < min_iou ? best_iou : min_iou;
+      sum_iou += best_iou;
+      track_err += fabsf(out_buff[best].x_center - truth.x_center);
+      nb_track_err++;
+    }
+  }
+
+  printf("%s\n", cfg->name);
+  printf("  id switches %u, no overlapping track %u / %u, IoU mean %.2f min %.2f\n", id_switches, nb_off,
+         nb_off + nb_track_err, sum_iou / nb_track_err, min_iou);
+  printf("  x error: detections %.4f, tracks %.4f\n", det_err / nb_det_err, track_err / nb_track_err);
+  printf("  count changes: detections %u, tracks %u\n", det_flicker, track_flicker);
+  printf("  detector runs %.0f%% of the frames\n", 100.0 / cfg->detect_period);
+
+  assert(id_switches == 0);
+  /* Extrapolated boxes overshoot for a few frames when an object bounces */
+  assert(nb_off * 100 < nb_off + nb_track_err);
+  assert(sum_iou / nb_track_err > 0.6);
+  assert(track_flicker * 4 < det_flicker || det_flicker == 0);
+}
+
+int main(void)
+{
+  const sim_config_t configs[] = {
+    /* name                                      objects  noise  miss  false  period  association */
+    { "clean, every frame",                        4,     0.00f,   0,     0,    1,  AI_OD_TRACKER_PP_ASSOC_GREEDY },
+    { "noisy, every frame, greedy",                6,     0.15f,  20,    20,    1,  AI_OD_TRACKER_PP_ASSOC_GREEDY },
+    { "noisy, every frame, optimal",               6,     0.15f,  20,    20,    1,  AI_OD_TRACKER_PP_ASSOC_OPTIMAL },
+    { "noisy, every 2 frames",                     6,     0.15f,  20,    20,    2,  AI_OD_TRACKER_PP_ASSOC_GREEDY },
+    { "noisy, every 3 frames",                     6,     0.15f,  20,    20,    3,  AI_OD_TRACKER_PP_ASSOC_OPTIMAL },
+    { "noisy, every 4 frames, 8 objects",          8,     0.10f,  20,    20,    4,  AI_OD_TRACKER_PP_ASSOC_GREEDY },
+  };
+
+  sim_check_assoc();
+
+  for (uint32_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+  {
+    sim_run(&configs[c]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,336 @@
+ /**
+ ******************************************************************************
+ * @file    pp_argmax_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check and benchmark of the single-pass argmax of the MoveNet and YOLOv8 pose post processing,
+ * built on the real lib_vision_models_pp sources, against the previous per-keypoint / per-box path
+ * that reads the whole output once per keypoint with a stride.
+ * - Checks that both paths give the same keypoints and detections, float and int8.
+ * - Checks that the sub-pixel refinement brings the keypoints closer to Gaussian peaks placed
+ *   between the heat map cells.
+ * - Reports the best time per call of both paths over BENCH_RUNS interleaved runs. Host timings
+ *   only give the trend and vary with the compiler: the gain on target depends on the heat map
+ *   size against the data cache. Without MVE the int8 heat maps keep the per-keypoint scan.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_argmax_bench.c $L/Src/spe_movenet_pp.c \
+ *       $L/Src/mpe_pp_yolov8.c $L/Src/vision_models_pp.c -lm -o pp_argmax_bench && ./pp_argmax_bench
+ */
+#include "spe_movenet_pp_if.h"
+#include "mpe_yolov8_pp_if.h"
+#include "od_pp_loc.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_HM_SIZE 48
+#define BENCH_KEYPOINTS 17
+#define BENCH_HM_LEN (BENCH_HM_SIZE * BENCH_HM_SIZE * BENCH_KEYPOINTS)
+#define BENCH_BOXES 1344
+#define BENCH_MAX_CLASSES 3
+#define BENCH_RAW_LEN ((AI_YOLOV8_PP_CLASSID + 3 * BENCH_KEYPOINTS + BENCH_MAX_CLASSES) * BENCH_BOXES)
+#define BENCH_RUNS 200
+
+/* Box extraction step of mpe_pp_yolov8.c */
+int32_t mpe_yolo_pp_getNNBoxes_centroid(mpe_yolov8_pp_in_centroid_t *pInput, mpe_pp_out_t *pOutput,
+                                        mpe_yolov8_pp_static_param_t *pInput_static_param);
+
+static float32_t bench_hm[BENCH_HM_LEN];
+static int8_t bench_hm_s8[BENCH_HM_LEN];
+static float32_t bench_raw[BENCH_RAW_LEN];
+static mpe_pp_outBuffer_t bench_det[2][BENCH_BOXES];
+static mpe_pp_keyPoints_t bench_kp[2][BENCH_BOXES * BENCH_KEYPOINTS];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Previous MoveNet path: one strided argmax per keypoint */
+static void ref_movenet(float32_t *hm, spe_pp_outBuffer_t *out, const spe_movenet_pp_static_param_t *params)
+{
+  uint32_t width = params->heatmap_width;
+  uint32_t height = params->heatmap_height;
+
+  for (uint32_t i = 0; i < params->nb_keypoints; i++)
+  {
+    float32_t proba;
+    uint32_t index;
+
+    vision_models_maxi_tr_if32ou32(&hm[i], width * height, params->nb_keypoints, &proba, &index);
+    out[i].x_center = ((index % height + 0.5f) / height);
+    out[i].y_center = ((index / height + 0.5f) / width);
+    out[i].proba = proba;
+  }
+}
+
+static void ref_movenet_int8(int8_t *hm, spe_pp_outBuffer_t *out, const spe_movenet_pp_static_param_t *params)
+{
+  uint32_t width = params->heatmap_width;
+  uint32_t height = params->heatmap_height;
+
+  for (uint32_t i = 0; i < params->nb_keypoints; i++)
+  {
+    int8_t proba;
+    uint16_t index;
+
+    vision_models_maxi_tr_is8ou16(&hm[i], width * height, params->nb_keypoints, &proba, &index);
+    out[i].x_center = ((index % height + 0.5f) / height);
+    out[i].y_center = ((index / height + 0.5f) / width);
+    out[i].proba = params->raw_output_scale * (proba - params->raw_output_zero_point);
+  }
+}
+
+/* Previous YOLOv8 pose path: one strided argmax over the classes per box */
+static void ref_mpe(float32_t *raw, mpe_pp_out_t *out, const mpe_yolov8_pp_static_param_t *params)
+{
+  int32_t nb_total_boxes = params->nb_total_boxes;
+
+  out->nb_detect = 0;
+  for (int32_t i = 0; i < nb_total_boxes; i++)
+  {
+    float32_t best_score;
+    uint32_t class_index;
+
+    vision_models_maxi_tr_if32ou32(&raw[i + AI_YOLOV8_PP_CLASSPROB * nb_total_boxes], params->nb_classes,
+                                   nb_total_boxes, &best_score, &class_index);
+    if (best_score >= params->conf_threshold)
+    {
+      mpe_pp_outBuffer_t *pDet = &out->pOutBuff[out->nb_detect];
+
+      pDet->x_center = raw[i + AI_YOLOV8_PP_XCENTER * nb_total_boxes];
+      pDet->y_center = raw[i + AI_YOLOV8_PP_YCENTER * nb_total_boxes];
+      pDet->width = raw[i + AI_YOLOV8_PP_WIDTHREL * nb_total_boxes];
+      pDet->height = raw[i + AI_YOLOV8_PP_HEIGHTREL * nb_total_boxes];
+      pDet->conf = best_score;
+      pDet->class_index = class_index;
+      for (uint32_t j = 0; j < params->nb_keypoints; j++)
+      {
+        pDet->pKeyPoints[j].x = raw[i + (AI_YOLOV8_PP_CLASSID + 3 * j + 0) * nb_total_boxes];
+        pDet->pKeyPoints[j].y = raw[i + (AI_YOLOV8_PP_CLASSID + 3 * j + 1) * nb_total_boxes];
+        pDet->pKeyPoints[j].conf = raw[i + (AI_YOLOV8_PP_CLASSID + 3 * j + 2) * nb_total_boxes];
+      }
+      out->nb_detect++;
+    }
+  }
+}
+
+static float32_t bench_rand(void)
+{
+  return (float32_t) rand() / RAND_MAX;
+}
+
+/* Quantized heat maps with few distinct values, so that ties are frequent */
+static void bench_fill_heatmaps(float32_t scale, int8_t zero_point)
+{
+  for (uint32_t i = 0; i < BENCH_HM_LEN; i++)
+  {
+    bench_hm_s8[i] = (int8_t) (rand() % 64 - 128);
+    bench_hm[i] = scale * (bench_hm_s8[i] - zero_point);
+  }
+}
+
+/* Gaussian blob of each keypoint centered on (cx, cy), in heat map cells */
+static void bench_fill_peaks(float32_t *cx, float32_t *cy)
+{
+  for (uint32_t k = 0; k < BENCH_KEYPOINTS; k++)
+  {
+    cx[k] = 1.0f + bench_rand() * (BENCH_HM_SIZE - 3);
+    cy[k] = 1.0f + bench_rand() * (BENCH_HM_SIZE - 3);
+  }
+  for (uint32_t y = 0; y < BENCH_HM_SIZE; y++)
+  {
+    for (uint32_t x = 0; x < BENCH_HM_SIZE; x++)
+    {
+      for (uint32_t k = 0; k < BENCH_KEYPOINTS; k++)
+      {
+        float32_t dx = x + 0.5f - cx[k];
+        float32_t dy = y + 0.5f - cy[k];
+
+        bench_hm[(y * BENCH_HM_SIZE + x) * BENCH_KEYPOINTS + k] = expf(-(dx * dx + dy * dy) / (2 * 1.5f * 1.5f));
+      }
+    }
+  }
+}
+
+static void check_movenet(void)
+{
+  spe_movenet_pp_static_param_t params = {
+    .heatmap_width = BENCH_HM_SIZE,
+    .heatmap_height = BENCH_HM_SIZE,
+    .nb_keypoints = BENCH_KEYPOINTS,
+    .raw_output_scale = 0.0039f,
+    .raw_output_zero_point = -128,
+  };
+  spe_pp_outBuffer_t out[BENCH_KEYPOINTS];
+  spe_pp_outBuffer_t ref[BENCH_KEYPOINTS];
+  spe_pp_out_t pp_out = { out };
+  spe_movenet_pp_in_t pp_in = { bench_hm };
+  spe_movenet_pp_in_int8_t pp_in_s8 = { bench_hm_s8 };
+  float32_t err_cell = 0;
+  float32_t err_subpixel = 0;
+
+  spe_movenet_pp_reset(&params);
+
+  for (int t = 0; t < 50; t++)
+  {
+    bench_fill_heatmaps(params.raw_output_scale, params.raw_output_zero_point);
+    ref_movenet(bench_hm, ref, &params);
+    spe_movenet_pp_process(&pp_in, &pp_out, &params);
+    assert(memcmp(out, ref, sizeof(out)) == 0);
+
+    ref_movenet_int8(bench_hm_s8, ref, &params);
+    spe_movenet_pp_process_int8(&pp_in_s8, &pp_out, &params);
+    assert(memcmp(out, ref, sizeof(out)) == 0);
+  }
+
+  for (int t = 0; t < 50; t++)
+  {
+    float32_t cx[BENCH_KEYPOINTS];
+    float32_t cy[BENCH_KEYPOINTS];
+
+    bench_fill_peaks(cx, cy);
+    for (uint32_t refine = 0; refine < 2; refine++)
+    {
+      params.subpixel_refine = refine;
+      spe_movenet_pp_process(&pp_in, &pp_out, &params);
+      for (uint32_t k = 0; k < BENCH_KEYPOINTS; k++)
+      {
+        float32_t err = hypotf(out[k].x_center * BENCH_HM_SIZE - cx[k], out[k].y_center * BENCH_HM_SIZE - cy[k]);
+
+        *(refine ? &err_subpixel : &err_cell) += err;
+      }
+    }
+  }
+  params.subpixel_refine = 0;
+  err_cell /= 50 * BENCH_KEYPOINTS;
+  err_subpixel /= 50 * BENCH_KEYPOINTS;
+  printf("MoveNet %ux%ux%u: same keypoints, float and int8\n", BENCH_HM_SIZE, BENCH_HM_SIZE, BENCH_KEYPOINTS);
+  printf("  mean keypoint error: cell %.3f, sub-pixel %.3f heat map cells\n", err_cell, err_subpixel);
+  assert(err_subpixel < err_cell / 2);
+
+  double best[5] = { 1e30, 1e30, 1e30, 1e30, 1e30 };
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    double t[6];
+
+    params.subpixel_refine = 0;
+    t[0] = bench_now();
+    ref_movenet(bench_hm, ref, &params);
+    t[1] = bench_now();
+    spe_movenet_pp_process(&pp_in, &pp_out, &params);
+    t[2] = bench_now();
+    ref_movenet_int8(bench_hm_s8, ref, &params);
+    t[3] = bench_now();
+    spe_movenet_pp_process_int8(&pp_in_s8, &pp_out, &params);
+    t[4] = bench_now();
+    params.subpixel_refine = 1;
+    spe_movenet_pp_process(&pp_in, &pp_out, &params);
+    t[5] = bench_now();
+    for (int i = 0; i < 5; i++)
+    {
+      best[i] = MIN(best[i], t[i + 1] - t[i]);
+    }
+  }
+
+  printf("  float per keypoint %8.1f us  single pass %8.1f us  x%.2f  (sub-pixel %8.1f us)\n",
+         best[0], best[1], best[0] / best[1], best[4]);
+  printf("  int8  per keypoint %8.1f us  single pass %8.1f us  x%.2f\n",
+         best[2], best[3], best[2] / best[3]);
+}
+
+static void check_mpe(int32_t nb_classes)
+{
+  mpe_yolov8_pp_static_param_t params = {
+    .nb_classes = nb_classes,
+    .nb_total_boxes = BENCH_BOXES,
+    .max_boxes_limit = 10,
+    .conf_threshold = 0.75f,
+    .iou_threshold = 0.5f,
+    .nb_keypoints = BENCH_KEYPOINTS,
+  };
+  mpe_pp_out_t out[2] = { { bench_det[0] }, { bench_det[1] } };
+  mpe_yolov8_pp_in_centroid_t pp_in = { bench_raw };
+  int32_t nb_detect[2];
+
+  for (int d = 0; d < 2; d++)
+  {
+    for (int i = 0; i < BENCH_BOXES; i++)
+    {
+      bench_det[d][i].pKeyPoints = &bench_kp[d][i * BENCH_KEYPOINTS];
+    }
+  }
+  for (uint32_t i = 0; i < BENCH_RAW_LEN; i++)
+  {
+    bench_raw[i] = bench_rand();
+  }
+  /* Scores in steps of 1/16 for ties */
+  for (int32_t i = AI_YOLOV8_PP_CLASSPROB * BENCH_BOXES; i < (AI_YOLOV8_PP_CLASSPROB + nb_classes) * BENCH_BOXES; i++)
+  {
+    bench_raw[i] = floorf(bench_raw[i] * 16) / 16;
+  }
+
+  mpe_yolov8_pp_reset(&params);
+  ref_mpe(bench_raw, &out[0], &params);
+  nb_detect[0] = out[0].nb_detect;
+  mpe_yolo_pp_getNNBoxes_centroid(&pp_in, &out[1], &params);
+  nb_detect[1] = out[1].nb_detect;
+
+  assert(nb_detect[0] == nb_detect[1]);
+  for (int32_t i = 0; i < nb_detect[0]; i++)
+  {
+    assert(memcmp(&bench_det[0][i], &bench_det[1][i], offsetof(mpe_pp_outBuffer_t, pKeyPoints)) == 0);
+    assert(memcmp(bench_det[0][i].pKeyPoints, bench_det[1][i].pKeyPoints,
+                  BENCH_KEYPOINTS * sizeof(mpe_pp_keyPoints_t)) == 0);
+  }
+
+  double best[2] = { 1e30, 1e30 };
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    double t0 = bench_now();
+    ref_mpe(bench_raw, &out[0], &params);
+    double t1 = bench_now();
+    mpe_yolo_pp_getNNBoxes_centroid(&pp_in, &out[1], &params);
+    double t2 = bench_now();
+
+    best[0] = MIN(best[0], t1 - t0);
+    best[1] = MIN(best[1], t2 - t1);
+  }
+
+  printf("YOLOv8 pose %u boxes, %d classes: same %d detections before NMS\n", BENCH_BOXES, nb_classes, nb_detect[0]);
+  printf("  per box %8.1f us  single pass %8.1f us  x%.2f\n", best[0], best[1], best[0] / best[1]);
+}
+
+int main(void)
+{
+  srand(1);
+  check_movenet();
+  check_mpe(1);
+  check_mpe(BENCH_MAX_CLASSES);
+
+  return 0;
+}
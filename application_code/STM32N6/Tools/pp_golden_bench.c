@@ -0,0 +1,1379 @@
+ /**
+ ******************************************************************************
+ * @file    pp_golden_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Regression check and benchmark of every lib_vision_models_pp post-processing, built on the
+ * real sources, to validate a new implementation (an optimized decoder, a Helium path) against
+ * the outputs of the baseline sources.
+ * - Each post-processing is run on deterministic synthetic raw outputs of the model layout,
+ *   with a sparse, a medium and a dense share of the candidates above the threshold for the
+ *   detectors. The raw outputs only depend on the generator below, not on the C library.
+ * - The outputs are hashed (FNV-1a 64) with their floats rounded to 1/4096, the detections in any
+ *   order, and compared to the golden table: a different detection count, box, class, keypoint or
+ *   mask fails.
+ * - The golden table holds the outputs of the baseline sources (commit 609044d). The intended
+ *   changes of outputs since then, and the post-processing the baseline does not have, are listed
+ *   with their reason in a second table that replaces the golden values.
+ * - The median and best time of a process call are reported (input copies excluded, some
+ *   decoders working in place in their input).
+ * Options: -u prints the outputs that differ from the golden table, to paste in the table of the
+ * intended changes with their reason; any other argument only runs the cases whose name contains it.
+ * The program returns 1 when an output differs from its golden value.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_golden_bench.c $L/Src/od_pp_yolov8.c \
+ *       $L/Src/od_pp_yolov5.c $L/Src/od_pp_yolov2.c $L/Src/od_pp_st_yolox.c $L/Src/od_pp_centernet.c \
+ *       $L/Src/od_pp_ssd.c $L/Src/od_pp_ssd_st.c $L/Src/od_pp_tracker.c $L/Src/mpe_pp_yolov8.c \
+ *       $L/Src/iseg_pp_yolov8.c $L/Src/spe_movenet_pp.c $L/Src/sseg_pp_deeplabv3.c $L/Src/pd_pp_model.c \
+ *       $L/Src/vision_models_pp.c -lm -o pp_golden_bench && ./pp_golden_bench
+ *
+ * The golden table is printed by -u of the build on the baseline sources, with -DBENCH_BASELINE for
+ * their API (-Wno-unused-variable) and without od_pp_tracker.c:
+ *   git worktree add /tmp/baseline 609044d
+ *   L=/tmp/baseline/application_code/STM32N6/Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -DBENCH_BASELINE ... (same line) && ./pp_golden_bench -u
+ */
+#include "iseg_yolov8_pp_if.h"
+#include "mpe_yolov8_pp_if.h"
+#include "od_centernet_pp_if.h"
+#include "od_ssd_pp_if.h"
+#include "od_ssd_st_pp_if.h"
+#include "od_st_yolox_pp_if.h"
+#ifndef BENCH_BASELINE
+#include "od_tracker_pp_if.h"
+#endif
+#include "od_yolov2_pp_if.h"
+#include "od_yolov5_pp_if.h"
+#include "od_yolov8_pp_if.h"
+#include "pd_model_pp_if.h"
+#include "pd_pp_loc.h"
+#include "spe_movenet_pp_if.h"
+#include "sseg_deeplabv3_pp_if.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 15
+#define BENCH_MAX_BOXES 4096
+#define BENCH_MAX_DETECT 100
+#define BENCH_THRESHOLD 0.5f
+
+#define YOLOV8_BOXES 1344           /* 256x256 input: 32x32 + 16x16 + 8x8 */
+#define YOLOV8_CLASSES 80
+#define YOLOV5_BOXES (3 * YOLOV8_BOXES)
+#define YOLOV5_CLASSES 80
+#define YOLOV2_GRID 13
+#define YOLOV2_ANCHORS 5
+#define YOLOV2_CLASSES 20
+#define YOLOX_CLASSES 20
+#define CENTERNET_GRID 64
+#define CENTERNET_CLASSES 20
+#define SSD_BOXES 3000
+#define SSD_CLASSES 21
+#define MPE_KEYPOINTS 17
+#define ISEG_CLASSES 80
+#define ISEG_MASKS 32
+#define ISEG_MASK_SIZE 64
+#define ISEG_MAX_DETECT 20
+#define SPE_HEATMAP 48
+#define SPE_KEYPOINTS 17
+#define SSEG_SIZE 257
+#define SSEG_CLASSES 21
+#define PD_BOXES 2016
+#define PD_KEYPOINTS 7
+#define PD_BOX_LEN (AI_PD_MODEL_PP_KEYPOINTS + 2 * PD_KEYPOINTS)
+#define TRACKER_FRAMES 60
+
+#define BENCH_RAW_MAX (SSEG_SIZE * SSEG_SIZE * SSEG_CLASSES)
+
+#ifdef BENCH_BASELINE
+/* API of the baseline sources: no scratch arena (the instance segmentation temporaries are
+ * given by the static parameters), no object tracker, int8 MoveNet or segmentation pixel formats */
+typedef struct
+{
+  void *pScratch;
+  uint32_t scratch_size;
+} vision_models_pp_ctx_t;
+#define AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(nb_total_boxes, nb_masks) 8
+#define AI_OD_SSD_PP_SCRATCH_SIZE(nb_detections, nb_classes) 8
+#define iseg_yolov8_pp_get_scratch_size(pParams) 0
+#define od_ssd_pp_get_scratch_size(pParams) 0
+#define od_ssd_st_pp_get_scratch_size(pParams) 0
+#define od_yolov2_pp_get_scratch_size(pParams) 0
+#define od_st_yolox_pp_get_scratch_size(pParams) 0
+#define od_centernet_pp_get_scratch_size(pParams) 0
+#define BENCH_CTX(pCtx)
+typedef enum {
+  AI_SSEG_OUT_INDEX = 0,
+  AI_SSEG_OUT_RGB565,
+  AI_SSEG_OUT_ARGB4444
+} e_sseg_out_format;
+typedef struct
+{
+  uint16_t x_min;
+  uint16_t y_min;
+  uint16_t x_max;
+  uint16_t y_max;
+} sseg_pp_extent_t;
+#else
+#define BENCH_CTX(pCtx) , (pCtx)
+#endif
+
+typedef struct
+{
+  int32_t nb;                 /* detections, or tracks of the last frame */
+  uint64_t hash;
+  double us[BENCH_RUNS];
+} bench_result_t;
+
+typedef struct
+{
+  const char *name;
+  void (*run)(float32_t density, bench_result_t *pRes);
+  int by_density;             /* 0: outputs independent of the share of candidates */
+} bench_case_t;
+
+typedef struct
+{
+  const char *name;
+  const char *density;
+  int32_t nb;
+  uint64_t hash;
+} bench_golden_t;
+
+static const struct
+{
+  const char *name;
+  float32_t value;
+} densities[] = {
+  { "sparse", 0.005f },
+  { "medium", 0.02f },
+  { "dense", 0.1f },
+};
+
+/* Outputs of the baseline sources (commit 609044d), printed by -u of the BENCH_BASELINE build */
+static const bench_golden_t goldens[] = {
+  { "od_yolov8", "sparse", 3, 0xF488D92F51AC786BULL },
+  { "od_yolov8", "medium", 19, 0xB4E4FD1EFF1C67ACULL },
+  { "od_yolov8", "dense", 138, 0xCDBE704D9F20010DULL },
+  { "od_yolov8_int8", "sparse", 3, 0xD9C42FE063A02723ULL },
+  { "od_yolov8_int8", "medium", 19, 0xA7E369BCC70E5F1FULL },
+  { "od_yolov8_int8", "dense", 138, 0x0DA9443852CC1E72ULL },
+  { "od_yolov5", "sparse", 13, 0x093409FE06A843B5ULL },
+  { "od_yolov5", "medium", 77, 0xF2040EEA2E8E1698ULL },
+  { "od_yolov5", "dense", 413, 0x22B27D9F7779E1DBULL },
+  { "od_yolov5_uint8", "sparse", 13, 0x0A26499A2C8DDD94ULL },
+  { "od_yolov5_uint8", "medium", 77, 0xDCAA0A9D1BC8A72DULL },
+  { "od_yolov5_uint8", "dense", 413, 0x5A782CC3C086DA2EULL },
+  { "od_yolov2", "sparse", 2, 0x66ED9BB985193B54ULL },
+  { "od_yolov2", "medium", 20, 0xE75D25C4DAA350D0ULL },
+  { "od_yolov2", "dense", 83, 0xBC0682807F29C66DULL },
+  { "od_st_yolox", "sparse", 8, 0x4A3BA123EF41A4B5ULL },
+  { "od_st_yolox", "medium", 34, 0x88F0D9976D947AE2ULL },
+  { "od_st_yolox", "dense", 150, 0xFFD82A64C694F0D5ULL },
+  { "od_centernet", "sparse", 17, 0x48C7F7475CEB7E1BULL },
+  { "od_centernet", "medium", 71, 0x7D8CDF5C253A3E95ULL },
+  { "od_centernet", "dense", 252, 0x2FD5A6A620FB4DA1ULL },
+  { "od_ssd", "sparse", 11, 0xD4812C85FFE95B3AULL },
+  { "od_ssd", "medium", 61, 0xF7C546A601C1DBC6ULL },
+  { "od_ssd", "dense", 315, 0x9A78A10DC3B18772ULL },
+  { "od_ssd_st", "sparse", 11, 0xF42851962875550BULL },
+  { "od_ssd_st", "medium", 60, 0xA40BE97642F947E2ULL },
+  { "od_ssd_st", "dense", 307, 0x816A49CE42100888ULL },
+  { "mpe_yolov8", "sparse", 6, 0x5C532D7A93BA2096ULL },
+  { "mpe_yolov8", "medium", 26, 0xB28E547BC1E940E8ULL },
+  { "mpe_yolov8", "dense", 100, 0xD113EC16A2C4D39EULL },
+  { "iseg_yolov8", "sparse", 4, 0xF2A87292DB6F557FULL },
+  { "iseg_yolov8", "medium", 20, 0x1DA60D60E55E9F08ULL },
+  { "iseg_yolov8", "dense", 20, 0x4747DD983D94EF8BULL },
+  { "spe_movenet", "-", 17, 0x38C49CA7FE7B46A6ULL },
+  { "sseg_deeplabv3", "-", 21, 0x490E33F038353FADULL },
+  { "sseg_deeplabv3_uint8", "-", 21, 0xE10E323611805818ULL },
+  { "sseg_deeplabv3_int8", "-", 21, 0xC3C116885F313573ULL },
+  { "pd_model", "sparse", 8, 0x1025B4B606B6EBB9ULL },
+  { "pd_model", "medium", 33, 0x31E141E1FE1483B9ULL },
+  { "pd_model", "dense", 100, 0xF2D8ED0B3A9A8A1FULL },
+};
+
+/* Intended changes of outputs since the baseline, and post-processing it does not have, printed
+ * by -u of the current build: they replace the golden values above */
+static const bench_golden_t changes[] = {
+  /* More than max_boxes_limit detections survive the NMS: the baseline outputs the first ones in
+   * the order left by its last per-class sort (by decreasing class index here), the shared NMS
+   * engine the first ones by class, then by decreasing confidence */
+  { "iseg_yolov8", "medium", 20, 0x885507386F27724AULL },
+  { "iseg_yolov8", "dense", 20, 0xF0FFD8569402F280ULL },
+  /* Object tracker, MoveNet sub-pixel refinement and int8 MoveNet: new */
+  { "od_tracker", "sparse", 1, 0x2E98AB99C921D3CEULL },
+  { "od_tracker", "medium", 3, 0x7E443CE676D29FD7ULL },
+  { "od_tracker", "dense", 11, 0x564524A3E4464861ULL },
+  { "spe_movenet_refine", "-", 17, 0x1B3CFA08D370E576ULL },
+  { "spe_movenet_int8", "-", 17, 0x6E57F4FE8A2EF1C8ULL },
+};
+
+static float32_t raw_f[BENCH_RAW_MAX];
+static float32_t work_f[BENCH_RAW_MAX];
+static int8_t raw_s8[BENCH_RAW_MAX];
+static int8_t work_s8[BENCH_RAW_MAX];
+
+static od_pp_outBuffer_t od_out[BENCH_MAX_BOXES];
+static mpe_pp_outBuffer_t mpe_out[YOLOV8_BOXES];
+static mpe_pp_keyPoints_t mpe_kps[YOLOV8_BOXES][MPE_KEYPOINTS];
+static iseg_postprocess_outBuffer_t iseg_out[ISEG_MAX_DETECT];
+static uint8_t iseg_masks[ISEG_MAX_DETECT][ISEG_MASK_SIZE * ISEG_MASK_SIZE];
+static uint64_t iseg_scratch[(AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(YOLOV8_BOXES, ISEG_MASKS) + 7) / 8];
+static uint64_t ssd_scratch[(AI_OD_SSD_PP_SCRATCH_SIZE(SSD_BOXES, SSD_CLASSES) + 7) / 8];
+/* Tiny YOLOv2, ST YOLOX and CenterNet: their arena is smaller than their input */
+static uint64_t od_scratch[(BENCH_RAW_MAX * sizeof(float32_t) + 7) / 8];
+static spe_pp_outBuffer_t spe_out[SPE_KEYPOINTS];
+static uint16_t sseg_out[SSEG_SIZE * SSEG_SIZE];
+static uint32_t sseg_hist[SSEG_CLASSES];
+static sseg_pp_extent_t sseg_extents[SSEG_CLASSES];
+static uint32_t sseg_colors[SSEG_CLASSES];
+static pd_pp_point_t pd_anchors[PD_BOXES];
+static pd_pp_box_t pd_out[PD_BOXES];
+static pd_pp_point_t pd_kps[PD_BOXES][PD_KEYPOINTS];
+#ifdef BENCH_BASELINE
+static iseg_postprocess_scratchBuffer_s8_t iseg_records[YOLOV8_BOXES];
+static int8_t iseg_coefs[YOLOV8_BOXES][ISEG_MASKS];
+static int32_t iseg_mask_tmp[ISEG_MASKS];
+static uint8_t sseg_index[SSEG_SIZE * SSEG_SIZE];
+#else
+static od_tracker_pp_static_param_t tracker;
+static od_pp_outBuffer_t tracker_dets[TRACKER_FRAMES][AI_OD_TRACKER_PP_MAX_TRACKS];
+static int32_t tracker_nb_dets[TRACKER_FRAMES];
+static od_tracker_pp_outBuffer_t tracker_out[AI_OD_TRACKER_PP_MAX_TRACKS];
+#endif
+
+static uint32_t bench_state;
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* xorshift32: the same raw outputs on every host and target */
+static uint32_t bench_next(void)
+{
+  bench_state ^= bench_state << 13;
+  bench_state ^= bench_state >> 17;
+  bench_state ^= bench_state << 5;
+  return bench_state;
+}
+
+static float32_t bench_rand(void)
+{
+  return (bench_next() >> 8) * (1.0f / 16777216.0f);
+}
+
+static int32_t bench_int(int32_t n)
+{
+  return (int32_t) (bench_next() % (uint32_t) n);
+}
+
+/* Sum of 4 uniforms (Irwin-Hall): close enough to a normal, and no libm */
+static float32_t bench_normal(float32_t mean, float32_t sigma)
+{
+  float32_t s = bench_rand() + bench_rand() + bench_rand() + bench_rand();
+
+  return mean + (s - 2.0f) * 1.7320508f * sigma;
+}
+
+static void quantize_s8(const float32_t *pSrc, int8_t *pDst, uint32_t n, float32_t scale, int32_t zero_point)
+{
+  for (uint32_t i = 0; i < n; i++)
+  {
+    int32_t q = (int32_t) floorf(pSrc[i] / scale + 0.5f) + zero_point;
+    pDst[i] = (int8_t) MAX(MIN(q, INT8_MAX), INT8_MIN);
+  }
+}
+
+static void quantize_u8(const float32_t *pSrc, uint8_t *pDst, uint32_t n, float32_t scale)
+{
+  for (uint32_t i = 0; i < n; i++)
+  {
+    int32_t q = (int32_t) floorf(pSrc[i] / scale + 0.5f);
+    pDst[i] = (uint8_t) MAX(MIN(q, UINT8_MAX), 0);
+  }
+}
+
+/* ----------------------------- Output hashes ----------------------------- */
+
+static uint64_t hash_bytes(uint64_t h, const void *p, size_t n)
+{
+  const uint8_t *pByte = p;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    h ^= pByte[i];
+    h *= 0x100000001B3ULL;
+  }
+  return h;
+}
+
+static uint64_t hash_int(uint64_t h, int32_t v)
+{
+  return hash_bytes(h, &v, sizeof(v));
+}
+
+/* Rounded to 1/4096, so that a different rounding of the last bits does not fail */
+static uint64_t hash_float(uint64_t h, float32_t v)
+{
+  float32_t q = floorf(v * 4096.0f + 0.5f);
+
+  if (!(q == q))
+  {
+    return hash_int(h, INT32_MIN);
+  }
+  return hash_int(h, (int32_t) MAX(MIN(q, 1e9f), -1e9f));
+}
+
+static uint64_t hash_box(uint64_t h, float32_t x_center, float32_t y_center, float32_t width, float32_t height,
+                         float32_t conf, int32_t class_index)
+{
+  h = hash_float(h, x_center);
+  h = hash_float(h, y_center);
+  h = hash_float(h, width);
+  h = hash_float(h, height);
+  h = hash_float(h, conf);
+  return hash_int(h, class_index);
+}
+
+static int hash_cmp(const void *a, const void *b)
+{
+  uint64_t ha = *(const uint64_t *) a;
+  uint64_t hb = *(const uint64_t *) b;
+
+  return (ha > hb) - (ha < hb);
+}
+
+/* Hash of nb detections hashed one by one in det_hashes: their order in the output is not
+ * specified, the hashes are sorted */
+static uint64_t det_hashes[BENCH_MAX_BOXES];
+
+static uint64_t hash_detections(int32_t nb)
+{
+  qsort(det_hashes, nb, sizeof(uint64_t), hash_cmp);
+  return hash_bytes(hash_int(0xCBF29CE484222325ULL, nb), det_hashes, nb * sizeof(uint64_t));
+}
+
+static uint64_t hash_od(const od_pp_out_t *pOut)
+{
+  for (int32_t i = 0; i < pOut->nb_detect; i++)
+  {
+    const od_pp_outBuffer_t *pBox = &pOut->pOutBuff[i];
+    det_hashes[i] = hash_box(0xCBF29CE484222325ULL, pBox->x_center, pBox->y_center, pBox->width, pBox->height,
+                             pBox->conf, pBox->class_index);
+  }
+  return hash_detections(pOut->nb_detect);
+}
+
+#define BENCH_TIMED(pRes, r, call)                 \
+  do {                                             \
+    double t0 = bench_now();                       \
+    int32_t error = (call);                        \
+    (pRes)->us[r] = bench_now() - t0;              \
+    assert(error == 0);                            \
+  } while (0)
+
+/* ----------------------------- Raw outputs ------------------------------- */
+
+/* YOLOv8 layout, channel-major [4 + nb_classes + nb_extra][nb_boxes]: relative box, class
+ * scores, then the keypoints or mask coefficients. Candidates get one class above the threshold
+ * with probability density */
+static void fill_yolov8(float32_t *p, int32_t nb, int32_t nb_classes, int32_t nb_extra, float32_t density)
+{
+  for (int32_t i = 0; i < nb; i++)
+  {
+    int32_t hit = bench_rand() < density;
+    int32_t best = bench_int(nb_classes);
+
+    p[0 * nb + i] = bench_rand();
+    p[1 * nb + i] = bench_rand();
+    p[2 * nb + i] = 0.02f + 0.2f * bench_rand();
+    p[3 * nb + i] = 0.02f + 0.2f * bench_rand();
+    for (int32_t c = 0; c < nb_classes; c++)
+    {
+      p[(4 + c) * nb + i] = (hit && (c == best)) ? 0.6f + 0.4f * bench_rand() : 0.4f * bench_rand();
+    }
+    for (int32_t e = 0; e < nb_extra; e++)
+    {
+      p[(4 + nb_classes + e) * nb + i] = bench_rand();
+    }
+  }
+}
+
+/* YOLOv5 layout, box-major [nb_boxes][5 + nb_classes]: box, confidence, class scores */
+static void fill_yolov5(float32_t *p, int32_t nb, int32_t nb_classes, float32_t density)
+{
+  for (int32_t i = 0; i < nb; i++, p += 5 + nb_classes)
+  {
+    int32_t hit = bench_rand() < density;
+    int32_t best = bench_int(nb_classes);
+
+    p[0] = bench_rand();
+    p[1] = bench_rand();
+    p[2] = 0.02f + 0.2f * bench_rand();
+    p[3] = 0.02f + 0.2f * bench_rand();
+    p[4] = hit ? 0.8f + 0.2f * bench_rand() : 0.6f * bench_rand();
+    for (int32_t c = 0; c < nb_classes; c++)
+    {
+      p[5 + c] = (hit && (c == best)) ? 0.8f + 0.2f * bench_rand() : 0.4f * bench_rand();
+    }
+  }
+}
+
+/* Tiny YOLOv2 and ST YOLOX layout, per anchor [x, y, w, h, objectness, classes] logits */
+static void fill_yolo_logits(float32_t *p, int32_t nb, int32_t nb_classes, float32_t density)
+{
+  for (int32_t i = 0; i < nb; i++, p += 5 + nb_classes)
+  {
+    int32_t best = bench_int(nb_classes);
+
+    p[0] = bench_normal(0.0f, 1.0f);
+    p[1] = bench_normal(0.0f, 1.0f);
+    p[2] = bench_normal(0.0f, 0.5f);
+    p[3] = bench_normal(0.0f, 0.5f);
+    p[4] = (bench_rand() < density) ? bench_normal(3.0f, 1.0f) : bench_normal(-5.0f, 1.5f);
+    for (int32_t c = 0; c < nb_classes; c++)
+    {
+      p[5 + c] = bench_normal(-2.0f, 1.0f) + ((c == best) ? 8.0f : 0.0f);
+    }
+  }
+}
+
+/* SSD class scores [nb_boxes][nb_classes], class 0 being the background */
+static void fill_ssd_scores(float32_t *p, int32_t nb, int32_t nb_classes, float32_t density)
+{
+  for (int32_t i = 0; i < nb; i++, p += nb_classes)
+  {
+    int32_t hit = bench_rand() < density;
+    int32_t best = 1 + bench_int(nb_classes - 1);
+
+    for (int32_t c = 0; c < nb_classes; c++)
+    {
+      p[c] = (hit && (c == best)) ? 0.6f + 0.4f * bench_rand() : 0.4f * bench_rand();
+    }
+  }
+}
+
+/* ----------------------------- Object detection -------------------------- */
+
+static void run_od_yolov8(float32_t density, bench_result_t *pRes)
+{
+  yolov8_pp_static_param_t params = {
+    .nb_classes = YOLOV8_CLASSES,
+    .nb_total_boxes = YOLOV8_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+  };
+  yolov8_pp_in_centroid_t pp_in = { work_f };
+  od_pp_out_t pp_out = { od_out, 0 };
+  uint32_t len = (4 + YOLOV8_CLASSES) * YOLOV8_BOXES;
+
+  fill_yolov8(raw_f, YOLOV8_BOXES, YOLOV8_CLASSES, 0, density);
+  od_yolov8_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_yolov8_pp_process(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+static void run_od_yolov8_int8(float32_t density, bench_result_t *pRes)
+{
+  yolov8_pp_static_param_t params = {
+    .nb_classes = YOLOV8_CLASSES,
+    .nb_total_boxes = YOLOV8_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .raw_output_scale = 1.0f / 255.0f,
+    .raw_output_zero_point = -128,
+  };
+  yolov8_pp_in_centroid_int8_t pp_in = { work_s8 };
+  od_pp_out_t pp_out = { od_out, 0 };
+  uint32_t len = (4 + YOLOV8_CLASSES) * YOLOV8_BOXES;
+
+  fill_yolov8(raw_f, YOLOV8_BOXES, YOLOV8_CLASSES, 0, density);
+  quantize_s8(raw_f, raw_s8, len, params.raw_output_scale, params.raw_output_zero_point);
+  od_yolov8_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_s8, raw_s8, len);
+    BENCH_TIMED(pRes, r, od_yolov8_pp_process_int8(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+static void run_od_yolov5(float32_t density, bench_result_t *pRes)
+{
+  yolov5_pp_static_param_t params = {
+    .nb_classes = YOLOV5_CLASSES,
+    .nb_total_boxes = YOLOV5_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+  };
+  yolov5_pp_in_centroid_t pp_in = { work_f };
+  od_pp_out_t pp_out = { od_out, 0 };
+  uint32_t len = (5 + YOLOV5_CLASSES) * YOLOV5_BOXES;
+
+  fill_yolov5(raw_f, YOLOV5_BOXES, YOLOV5_CLASSES, density);
+  od_yolov5_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_yolov5_pp_process(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+static void run_od_yolov5_uint8(float32_t density, bench_result_t *pRes)
+{
+  yolov5_pp_static_param_t params = {
+    .nb_classes = YOLOV5_CLASSES,
+    .nb_total_boxes = YOLOV5_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .raw_output_scale = 1.0f / 255.0f,
+    .raw_output_zero_point = 0,
+  };
+  yolov5_pp_in_centroid_uint8_t pp_in = { (uint8_t *) work_s8 };
+  od_pp_out_t pp_out = { od_out, 0 };
+  uint32_t len = (5 + YOLOV5_CLASSES) * YOLOV5_BOXES;
+
+  fill_yolov5(raw_f, YOLOV5_BOXES, YOLOV5_CLASSES, density);
+  quantize_u8(raw_f, (uint8_t *) raw_s8, len, params.raw_output_scale);
+  od_yolov5_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_s8, raw_s8, len);
+    BENCH_TIMED(pRes, r, od_yolov5_pp_process_uint8(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+static void run_od_yolov2(float32_t density, bench_result_t *pRes)
+{
+  static const float32_t anchors[2 * YOLOV2_ANCHORS] = {
+    0.9f, 1.1f, 2.0f, 3.5f, 4.2f, 2.6f, 6.5f, 6.8f, 10.1f, 9.4f
+  };
+  yolov2_pp_static_param_t params = {
+    .nb_classes = YOLOV2_CLASSES,
+    .nb_anchors = YOLOV2_ANCHORS,
+    .grid_width = YOLOV2_GRID,
+    .grid_height = YOLOV2_GRID,
+    .nb_input_boxes = YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .pAnchors = anchors,
+  };
+  yolov2_pp_in_t pp_in = { work_f };
+  od_pp_out_t pp_out = { od_out, 0 };
+  vision_models_pp_ctx_t ctx = { od_scratch, sizeof(od_scratch) };
+  uint32_t len = (5 + YOLOV2_CLASSES) * YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS;
+
+  fill_yolo_logits(raw_f, YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS, YOLOV2_CLASSES, density);
+  od_yolov2_pp_reset(&params);
+  assert(od_yolov2_pp_get_scratch_size(&params) <= sizeof(od_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_yolov2_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+static void run_od_st_yolox(float32_t density, bench_result_t *pRes)
+{
+  static const float32_t anchors[2] = { 0.5f, 0.5f };
+  st_yolox_pp_static_param_t params = {
+    .nb_classes = YOLOX_CLASSES,
+    .nb_anchors = 1,
+    .grid_width_L = 32, .grid_height_L = 32,
+    .grid_width_M = 16, .grid_height_M = 16,
+    .grid_width_S = 8, .grid_height_S = 8,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .pAnchors_L = anchors,
+    .pAnchors_M = anchors,
+    .pAnchors_S = anchors,
+  };
+  uint32_t len_L = 32 * 32 * (5 + YOLOX_CLASSES);
+  uint32_t len_M = 16 * 16 * (5 + YOLOX_CLASSES);
+  st_yolox_pp_in_t pp_in = { work_f, work_f + len_L, work_f + len_L + len_M };
+  od_pp_out_t pp_out = { od_out, 0 };
+  vision_models_pp_ctx_t ctx = { od_scratch, sizeof(od_scratch) };
+  uint32_t len = (5 + YOLOX_CLASSES) * YOLOV8_BOXES;
+
+  fill_yolo_logits(raw_f, YOLOV8_BOXES, YOLOX_CLASSES, density);
+  od_st_yolox_pp_reset(&params);
+  assert(od_st_yolox_pp_get_scratch_size(&params) <= sizeof(od_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_st_yolox_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+/* CenterNet layout [grid_height][grid_width][conf, w, h, x offset, y offset, classes, 1] */
+static void run_od_centernet(float32_t density, bench_result_t *pRes)
+{
+  centernet_pp_static_param_t params = {
+    .nb_classifs = CENTERNET_CLASSES,
+    .grid_width = CENTERNET_GRID,
+    .grid_height = CENTERNET_GRID,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .optim = AI_OD_CENTERNET_PP_OPTIM_NORMAL,
+  };
+  centernet_pp_in_t pp_in = { work_f };
+  od_pp_out_t pp_out = { od_out, 0 };
+  vision_models_pp_ctx_t ctx = { od_scratch, sizeof(od_scratch) };
+  uint32_t stride = CENTERNET_CLASSES + 6;
+  uint32_t len = stride * CENTERNET_GRID * CENTERNET_GRID;
+
+  for (uint32_t i = 0; i < CENTERNET_GRID * CENTERNET_GRID; i++)
+  {
+    float32_t *p = &raw_f[i * stride];
+    p[0] = (bench_rand() < density) ? 0.6f + 0.4f * bench_rand() : 0.3f * bench_rand();
+    p[1] = 1.0f + 6.0f * bench_rand();
+    p[2] = 1.0f + 6.0f * bench_rand();
+    for (uint32_t k = 3; k < stride; k++)
+    {
+      p[k] = bench_rand();
+    }
+  }
+  od_centernet_pp_reset(&params);
+  assert(od_centernet_pp_get_scratch_size(&params) <= sizeof(od_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_centernet_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+/* Boxes (yc, xc, h, w) offsets and anchors, then scores */
+static void run_od_ssd(float32_t density, bench_result_t *pRes)
+{
+  ssd_pp_static_param_t params = {
+    .nb_classes = SSD_CLASSES,
+    .nb_detections = SSD_BOXES,
+    .XY_scale = 10.0f,
+    .WH_scale = 5.0f,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+  };
+  ssd_pp_in_centroid_t pp_in = { work_f, work_f + 4 * SSD_BOXES, work_f + 8 * SSD_BOXES };
+  od_pp_out_t pp_out = { od_out, 0 };
+  vision_models_pp_ctx_t ctx = { ssd_scratch, sizeof(ssd_scratch) };
+  uint32_t len = (8 + SSD_CLASSES) * SSD_BOXES;
+
+  for (uint32_t i = 0; i < 4 * SSD_BOXES; i++)
+  {
+    raw_f[i] = bench_normal(0.0f, 1.0f);
+  }
+  for (uint32_t i = 0; i < SSD_BOXES; i++)
+  {
+    float32_t *pAnchor = &raw_f[4 * SSD_BOXES + 4 * i];
+    pAnchor[0] = bench_rand();
+    pAnchor[1] = bench_rand();
+    pAnchor[2] = 0.05f + 0.3f * bench_rand();
+    pAnchor[3] = 0.05f + 0.3f * bench_rand();
+  }
+  fill_ssd_scores(raw_f + 8 * SSD_BOXES, SSD_BOXES, SSD_CLASSES, density);
+  od_ssd_pp_reset(&params);
+  assert(od_ssd_pp_get_scratch_size(&params) <= sizeof(ssd_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_ssd_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+/* Boxes (xmin, ymin, xmax, ymax) offsets and corner anchors, then scores */
+static void run_od_ssd_st(float32_t density, bench_result_t *pRes)
+{
+  ssd_st_pp_static_param_t params = {
+    .nb_classes = SSD_CLASSES,
+    .nb_detections = SSD_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+  };
+  ssd_st_pp_in_centroid_t pp_in = { work_f, work_f + 4 * SSD_BOXES, work_f + 8 * SSD_BOXES };
+  od_pp_out_t pp_out = { od_out, 0 };
+  vision_models_pp_ctx_t ctx = { ssd_scratch, sizeof(ssd_scratch) };
+  uint32_t len = (8 + SSD_CLASSES) * SSD_BOXES;
+
+  for (uint32_t i = 0; i < 4 * SSD_BOXES; i++)
+  {
+    raw_f[i] = bench_normal(0.0f, 0.1f);
+  }
+  for (uint32_t i = 0; i < SSD_BOXES; i++)
+  {
+    float32_t *pAnchor = &raw_f[4 * SSD_BOXES + 4 * i];
+    pAnchor[0] = 0.7f * bench_rand();
+    pAnchor[1] = 0.7f * bench_rand();
+    pAnchor[2] = pAnchor[0] + 0.05f + 0.25f * bench_rand();
+    pAnchor[3] = pAnchor[1] + 0.05f + 0.25f * bench_rand();
+  }
+  fill_ssd_scores(raw_f + 8 * SSD_BOXES, SSD_BOXES, SSD_CLASSES, density);
+  od_ssd_st_pp_reset(&params);
+  assert(od_ssd_st_pp_get_scratch_size(&params) <= sizeof(ssd_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, od_ssd_st_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_od(&pp_out);
+}
+
+#ifndef BENCH_BASELINE
+/* Tracks of a few objects moving across the frame, detected with noise, misses and false
+ * positives: the number of objects follows the density */
+static void run_od_tracker(float32_t density, bench_result_t *pRes)
+{
+  int32_t nb_objects = 1 + (int32_t) (density * 100.0f);   /* 1, 3 and 11 objects */
+  float32_t objects[AI_OD_TRACKER_PP_MAX_TRACKS][6];
+  od_tracker_pp_out_t pp_out = { tracker_out, 0 };
+  uint64_t h = 0xCBF29CE484222325ULL;
+
+  for (int32_t o = 0; o < nb_objects; o++)
+  {
+    objects[o][0] = 0.1f + 0.8f * bench_rand();
+    objects[o][1] = 0.1f + 0.8f * bench_rand();
+    objects[o][2] = bench_normal(0.0f, 0.004f);
+    objects[o][3] = bench_normal(0.0f, 0.004f);
+    objects[o][4] = 0.05f + 0.1f * bench_rand();
+    objects[o][5] = 0.05f + 0.1f * bench_rand();
+  }
+  for (int32_t f = 0; f < TRACKER_FRAMES; f++)
+  {
+    int32_t nb = 0;
+    for (int32_t o = 0; o < nb_objects; o++)
+    {
+      if (bench_rand() < 0.9f)
+      {
+        tracker_dets[f][nb++] = (od_pp_outBuffer_t) {
+          objects[o][0] + f * objects[o][2] + bench_normal(0.0f, 0.003f),
+          objects[o][1] + f * objects[o][3] + bench_normal(0.0f, 0.003f),
+          objects[o][4], objects[o][5], 0.5f + 0.5f * bench_rand(), 0
+        };
+      }
+    }
+    if ((bench_rand() < 0.2f) && (nb < AI_OD_TRACKER_PP_MAX_TRACKS))
+    {
+      tracker_dets[f][nb++] = (od_pp_outBuffer_t) { bench_rand(), bench_rand(), 0.1f, 0.1f, 0.5f, 0 };
+    }
+    tracker_nb_dets[f] = nb;
+  }
+
+  tracker.iou_threshold = 0.3f;
+  tracker.dist_threshold = 1.0f;
+  tracker.alpha = 0.6f;
+  tracker.beta = 0.3f;
+  tracker.min_hits = 3;
+  tracker.max_missed = 5;
+  tracker.assoc_mode = AI_OD_TRACKER_PP_ASSOC_GREEDY;
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    double t = 0;
+    od_tracker_pp_reset(&tracker);
+    for (int32_t f = 0; f < TRACKER_FRAMES; f++)
+    {
+      od_pp_out_t dets = { tracker_dets[f], tracker_nb_dets[f] };
+      double t0 = bench_now();
+      int32_t error = od_tracker_pp_update(&dets, &pp_out, &tracker);
+      t += bench_now() - t0;
+      assert(error == AI_OD_POSTPROCESS_ERROR_NO);
+      if (r == BENCH_RUNS - 1)
+      {
+        h = hash_int(h, pp_out.nb_tracks);
+        for (int32_t i = 0; i < pp_out.nb_tracks; i++)
+        {
+          const od_tracker_pp_outBuffer_t *pTrack = &pp_out.pOutBuff[i];
+          h = hash_box(h, pTrack->x_center, pTrack->y_center, pTrack->width, pTrack->height, pTrack->conf,
+                       pTrack->class_index);
+          h = hash_int(h, (int32_t) pTrack->track_id);
+          h = hash_int(h, pTrack->nb_missed);
+        }
+      }
+    }
+    pRes->us[r] = t / TRACKER_FRAMES;
+  }
+  pRes->nb = pp_out.nb_tracks;
+  pRes->hash = h;
+}
+#endif
+
+/* ----------------------------- Pose, segmentation, palm ------------------ */
+
+static void run_mpe_yolov8(float32_t density, bench_result_t *pRes)
+{
+  mpe_yolov8_pp_static_param_t params = {
+    .nb_classes = 1,
+    .nb_total_boxes = YOLOV8_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .nb_keypoints = MPE_KEYPOINTS,
+  };
+  mpe_yolov8_pp_in_centroid_t pp_in = { work_f };
+  mpe_pp_out_t pp_out = { mpe_out, 0 };
+  uint32_t len = (5 + 3 * MPE_KEYPOINTS) * YOLOV8_BOXES;
+
+  for (int32_t i = 0; i < YOLOV8_BOXES; i++)
+  {
+    mpe_out[i].pKeyPoints = mpe_kps[i];
+  }
+  fill_yolov8(raw_f, YOLOV8_BOXES, 1, 3 * MPE_KEYPOINTS, density);
+  mpe_yolov8_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, mpe_yolov8_pp_process(&pp_in, &pp_out, &params));
+  }
+
+  for (int32_t i = 0; i < pp_out.nb_detect; i++)
+  {
+    const mpe_pp_outBuffer_t *pBox = &pp_out.pOutBuff[i];
+    uint64_t h = hash_box(0xCBF29CE484222325ULL, pBox->x_center, pBox->y_center, pBox->width, pBox->height,
+                          pBox->conf, pBox->class_index);
+    for (int32_t k = 0; k < MPE_KEYPOINTS; k++)
+    {
+      h = hash_float(h, pBox->pKeyPoints[k].x);
+      h = hash_float(h, pBox->pKeyPoints[k].y);
+      h = hash_float(h, pBox->pKeyPoints[k].conf);
+    }
+    det_hashes[i] = h;
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_detections(pp_out.nb_detect);
+}
+
+/* Raw detections [4 + classes + mask coefficients][nb_boxes] then the masks prototypes
+ * [size][size][nb_masks], int8 */
+static void run_iseg_yolov8(float32_t density, bench_result_t *pRes)
+{
+  yolov8_seg_pp_static_param_t params = {
+    .nb_classes = ISEG_CLASSES,
+    .nb_total_boxes = YOLOV8_BOXES,
+    .max_boxes_limit = ISEG_MAX_DETECT,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.5f,
+    .nb_masks = ISEG_MASKS,
+    .size_masks = ISEG_MASK_SIZE,
+    .raw_output_zero_point = -128,
+    .raw_output_scale = 1.0f / 255.0f,
+    .mask_raw_output_zero_point = 0,
+    .mask_raw_output_scale = 1.0f / 32.0f,
+#ifndef BENCH_BASELINE
+    .mask_mode = AI_ISEG_YOLOV8_PP_MASK_FULL,
+#endif
+  };
+  uint32_t len_det = (4 + ISEG_CLASSES + ISEG_MASKS) * YOLOV8_BOXES;
+  uint32_t len = len_det + ISEG_MASK_SIZE * ISEG_MASK_SIZE * ISEG_MASKS;
+  yolov8_seg_pp_in_centroid_int8_t pp_in = { work_s8, work_s8 + len_det };
+  iseg_postprocess_out_t pp_out = { iseg_out, 0 };
+  vision_models_pp_ctx_t ctx = { iseg_scratch, sizeof(iseg_scratch) };
+
+  for (int32_t i = 0; i < ISEG_MAX_DETECT; i++)
+  {
+    iseg_out[i].pMask = iseg_masks[i];
+  }
+#ifdef BENCH_BASELINE
+  params.pMask = (float32_t *) iseg_mask_tmp;
+  params.pTmpBuff = iseg_records;
+  for (int32_t i = 0; i < YOLOV8_BOXES; i++)
+  {
+    iseg_records[i].pMask = iseg_coefs[i];
+  }
+#endif
+  fill_yolov8(raw_f, YOLOV8_BOXES, ISEG_CLASSES, ISEG_MASKS, density);
+  quantize_s8(raw_f, raw_s8, len_det, params.raw_output_scale, params.raw_output_zero_point);
+  for (uint32_t i = len_det; i < len; i++)
+  {
+    raw_s8[i] = (int8_t) (bench_int(256) - 128);
+  }
+  iseg_yolov8_pp_reset(&params);
+  assert(iseg_yolov8_pp_get_scratch_size(&params) <= sizeof(iseg_scratch));
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_s8, raw_s8, len);
+    BENCH_TIMED(pRes, r, iseg_yolov8_pp_process(&pp_in, &pp_out, &params BENCH_CTX(&ctx)));
+  }
+
+  for (int32_t i = 0; i < pp_out.nb_detect; i++)
+  {
+    const iseg_postprocess_outBuffer_t *pBox = &pp_out.pOutBuff[i];
+    uint64_t h = hash_box(0xCBF29CE484222325ULL, pBox->x_center, pBox->y_center, pBox->width, pBox->height,
+                          pBox->conf, pBox->class_index);
+    det_hashes[i] = hash_bytes(h, pBox->pMask, ISEG_MASK_SIZE * ISEG_MASK_SIZE);
+  }
+  pRes->nb = pp_out.nb_detect;
+  pRes->hash = hash_detections(pp_out.nb_detect);
+}
+
+/* Heat maps [height][width][nb_keypoints], one cone per keypoint over some noise */
+static void fill_movenet(void)
+{
+  for (int32_t k = 0; k < SPE_KEYPOINTS; k++)
+  {
+    int32_t px = bench_int(SPE_HEATMAP);
+    int32_t py = bench_int(SPE_HEATMAP);
+    for (int32_t y = 0; y < SPE_HEATMAP; y++)
+    {
+      for (int32_t x = 0; x < SPE_HEATMAP; x++)
+      {
+        int32_t d2 = (x - px) * (x - px) + (y - py) * (y - py);
+        float32_t v = 0.05f * bench_rand() + MAX(0.0f, 1.0f - d2 / 36.0f) * 0.9f;
+        raw_f[(y * SPE_HEATMAP + x) * SPE_KEYPOINTS + k] = v;
+      }
+    }
+  }
+}
+
+static uint64_t hash_movenet(const spe_pp_out_t *pOut)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+
+  for (int32_t k = 0; k < SPE_KEYPOINTS; k++)
+  {
+    h = hash_float(h, pOut->pOutBuff[k].x_center);
+    h = hash_float(h, pOut->pOutBuff[k].y_center);
+    h = hash_float(h, pOut->pOutBuff[k].proba);
+  }
+  return h;
+}
+
+static void run_spe_movenet_f(uint32_t subpixel_refine, bench_result_t *pRes)
+{
+  spe_movenet_pp_static_param_t params = {
+    .heatmap_width = SPE_HEATMAP,
+    .heatmap_height = SPE_HEATMAP,
+    .nb_keypoints = SPE_KEYPOINTS,
+  };
+  spe_movenet_pp_in_t pp_in = { work_f };
+  spe_pp_out_t pp_out = { spe_out };
+  uint32_t len = SPE_HEATMAP * SPE_HEATMAP * SPE_KEYPOINTS;
+
+#ifndef BENCH_BASELINE
+  params.subpixel_refine = subpixel_refine;
+#endif
+  fill_movenet();
+  spe_movenet_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, spe_movenet_pp_process(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = SPE_KEYPOINTS;
+  pRes->hash = hash_movenet(&pp_out);
+}
+
+static void run_spe_movenet(float32_t density, bench_result_t *pRes)
+{
+  run_spe_movenet_f(0, pRes);
+}
+
+#ifndef BENCH_BASELINE
+static void run_spe_movenet_refine(float32_t density, bench_result_t *pRes)
+{
+  run_spe_movenet_f(1, pRes);
+}
+
+static void run_spe_movenet_int8(float32_t density, bench_result_t *pRes)
+{
+  spe_movenet_pp_static_param_t params = {
+    .heatmap_width = SPE_HEATMAP,
+    .heatmap_height = SPE_HEATMAP,
+    .nb_keypoints = SPE_KEYPOINTS,
+    .subpixel_refine = 1,
+    .raw_output_scale = 1.0f / 255.0f,
+    .raw_output_zero_point = -128,
+  };
+  spe_movenet_pp_in_int8_t pp_in = { work_s8 };
+  spe_pp_out_t pp_out = { spe_out };
+  uint32_t len = SPE_HEATMAP * SPE_HEATMAP * SPE_KEYPOINTS;
+
+  fill_movenet();
+  quantize_s8(raw_f, raw_s8, len, params.raw_output_scale, params.raw_output_zero_point);
+  spe_movenet_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_s8, raw_s8, len);
+    BENCH_TIMED(pRes, r, spe_movenet_pp_process_int8(&pp_in, &pp_out, &params));
+  }
+  pRes->nb = SPE_KEYPOINTS;
+  pRes->hash = hash_movenet(&pp_out);
+}
+#endif
+
+#ifdef BENCH_BASELINE
+/* Outputs the baseline has no option for, derived from its class map as documented: pixels of
+ * the color map, class histogram and extents */
+static void sseg_derive(e_sseg_out_format out_format)
+{
+  for (uint32_t c = 0; c < SSEG_CLASSES; c++)
+  {
+    sseg_hist[c] = 0;
+    sseg_extents[c] = (sseg_pp_extent_t) { UINT16_MAX, UINT16_MAX, 0, 0 };
+  }
+  for (uint32_t i = 0; i < SSEG_SIZE * SSEG_SIZE; i++)
+  {
+    uint32_t argb = sseg_colors[sseg_index[i]];
+    sseg_pp_extent_t *pExtent = &sseg_extents[sseg_index[i]];
+
+    if (out_format == AI_SSEG_OUT_INDEX)
+    {
+      ((uint8_t *) sseg_out)[i] = sseg_index[i];
+    }
+    else if (out_format == AI_SSEG_OUT_RGB565)
+    {
+      sseg_out[i] = (uint16_t) (((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 3) & 0x001F));
+    }
+    else
+    {
+      sseg_out[i] = (uint16_t) (((argb >> 16) & 0xF000) | ((argb >> 12) & 0x0F00) | ((argb >> 8) & 0x00F0) |
+                                ((argb >> 4) & 0x000F));
+    }
+    sseg_hist[sseg_index[i]]++;
+    pExtent->x_min = MIN(pExtent->x_min, i % SSEG_SIZE);
+    pExtent->x_max = MAX(pExtent->x_max, i % SSEG_SIZE);
+    pExtent->y_min = MIN(pExtent->y_min, i / SSEG_SIZE);
+    pExtent->y_max = MAX(pExtent->y_max, i / SSEG_SIZE);
+  }
+}
+#endif
+
+/* Blobs of classes: each pixel favours the class of its 16x16 block, with noise */
+static void run_sseg(e_sseg_data_type type, e_sseg_out_format out_format, bench_result_t *pRes)
+{
+#ifdef BENCH_BASELINE
+  sseg_deeplabv3_pp_static_param_t params = {
+    .width = SSEG_SIZE,
+    .height = SSEG_SIZE,
+    .nb_classes = SSEG_CLASSES,
+    .type = type,
+  };
+  sseg_pp_out_t pp_out = { sseg_index };
+#else
+  sseg_deeplabv3_pp_static_param_t params = {
+    .width = SSEG_SIZE,
+    .height = SSEG_SIZE,
+    .nb_classes = SSEG_CLASSES,
+    .type = type,
+    .out_format = out_format,
+    .color_map = sseg_colors,
+  };
+  sseg_pp_out_t pp_out = { (uint8_t *) sseg_out, sseg_hist, sseg_extents };
+#endif
+  void *pWork = (type == AI_SSEG_DATA_FLOAT) ? (void *) work_f : (void *) work_s8;
+  void *pRaw = (type == AI_SSEG_DATA_FLOAT) ? (void *) raw_f : (void *) raw_s8;
+  sseg_deeplabv3_pp_in_t pp_in = { pWork };
+  uint32_t len = SSEG_SIZE * SSEG_SIZE * SSEG_CLASSES;
+  size_t len_bytes = len * ((type == AI_SSEG_DATA_FLOAT) ? sizeof(float32_t) : 1);
+  uint64_t h;
+
+  for (uint32_t c = 0; c < SSEG_CLASSES; c++)
+  {
+    sseg_colors[c] = 0x80000000u | (bench_next() & 0x00FFFFFFu);
+  }
+  for (uint32_t y = 0; y < SSEG_SIZE; y++)
+  {
+    for (uint32_t x = 0; x < SSEG_SIZE; x++)
+    {
+      uint32_t block_class = ((x / 16) * 7 + (y / 16) * 3) % SSEG_CLASSES;
+      for (uint32_t c = 0; c < SSEG_CLASSES; c++)
+      {
+        int32_t v = bench_int(100) + ((c == block_class) ? 60 : 0);
+        uint32_t i = (y * SSEG_SIZE + x) * SSEG_CLASSES + c;
+        raw_f[i] = v * 0.037f - 2.0f;
+        raw_s8[i] = (type == AI_SSEG_DATA_UINT8) ? (int8_t) (uint8_t) v : (int8_t) (v - 128);
+      }
+    }
+  }
+  assert(sseg_deeplabv3_pp_reset(&params) == AI_SSEG_POSTPROCESS_ERROR_NO);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(pWork, pRaw, len_bytes);
+    BENCH_TIMED(pRes, r, sseg_deeplabv3_pp_process(&pp_in, &pp_out, &params));
+  }
+#ifdef BENCH_BASELINE
+  sseg_derive(out_format);
+#endif
+
+  h = hash_bytes(0xCBF29CE484222325ULL, sseg_out,
+                 SSEG_SIZE * SSEG_SIZE * ((out_format == AI_SSEG_OUT_INDEX) ? 1 : 2));
+  h = hash_bytes(h, sseg_hist, sizeof(sseg_hist));
+  for (uint32_t c = 0; c < SSEG_CLASSES; c++)
+  {
+    if (sseg_hist[c])
+    {
+      h = hash_bytes(h, &sseg_extents[c], sizeof(sseg_pp_extent_t));
+    }
+  }
+  pRes->nb = SSEG_CLASSES;
+  pRes->hash = h;
+}
+
+static void run_sseg_float(float32_t density, bench_result_t *pRes)
+{
+  run_sseg(AI_SSEG_DATA_FLOAT, AI_SSEG_OUT_ARGB4444, pRes);
+}
+
+static void run_sseg_uint8(float32_t density, bench_result_t *pRes)
+{
+  run_sseg(AI_SSEG_DATA_UINT8, AI_SSEG_OUT_INDEX, pRes);
+}
+
+static void run_sseg_int8(float32_t density, bench_result_t *pRes)
+{
+  run_sseg(AI_SSEG_DATA_INT8, AI_SSEG_OUT_RGB565, pRes);
+}
+
+/* Palm detector: score logits [nb_boxes], then boxes and keypoints [nb_boxes][4 + 2 * nb_keypoints]
+ * in pixels relative to their anchor */
+static void run_pd_model(float32_t density, bench_result_t *pRes)
+{
+  pd_model_pp_static_param_t params = {
+    .width = 192,
+    .height = 192,
+    .nb_keypoints = PD_KEYPOINTS,
+    .conf_threshold = BENCH_THRESHOLD,
+    .iou_threshold = 0.3f,
+    .nb_total_boxes = PD_BOXES,
+    .max_boxes_limit = BENCH_MAX_DETECT,
+    .pAnchors = pd_anchors,
+  };
+  pd_model_pp_in_t pp_in = { work_f, work_f + PD_BOXES };
+  pd_postprocess_out_t pp_out = { pd_out, 0 };
+  uint32_t len = PD_BOXES * (1 + PD_BOX_LEN);
+
+  for (int32_t i = 0; i < PD_BOXES; i++)
+  {
+    float32_t *pBox = &raw_f[PD_BOXES + i * PD_BOX_LEN];
+    raw_f[i] = (bench_rand() < density) ? bench_normal(3.0f, 1.0f) : bench_normal(-6.0f, 1.5f);
+    pBox[AI_PD_MODEL_PP_XCENTER] = bench_normal(0.0f, 10.0f);
+    pBox[AI_PD_MODEL_PP_YCENTER] = bench_normal(0.0f, 10.0f);
+    pBox[AI_PD_MODEL_PP_WIDTHREL] = 10.0f + 40.0f * bench_rand();
+    pBox[AI_PD_MODEL_PP_HEIGHTREL] = 10.0f + 40.0f * bench_rand();
+    for (int32_t k = AI_PD_MODEL_PP_KEYPOINTS; k < PD_BOX_LEN; k++)
+    {
+      pBox[k] = bench_normal(0.0f, 20.0f);
+    }
+    pd_anchors[i].x = bench_rand();
+    pd_anchors[i].y = bench_rand();
+    pd_out[i].pKps = pd_kps[i];
+  }
+  pd_model_pp_reset(&params);
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    memcpy(work_f, raw_f, len * sizeof(float32_t));
+    BENCH_TIMED(pRes, r, pd_model_pp_process(&pp_in, &pp_out, &params));
+  }
+
+  for (uint32_t i = 0; i < pp_out.box_nb; i++)
+  {
+    const pd_pp_box_t *pBox = &pp_out.pOutData[i];
+    uint64_t h = hash_box(0xCBF29CE484222325ULL, pBox->x_center, pBox->y_center, pBox->width, pBox->height,
+                          pBox->prob, 0);
+    for (int32_t k = 0; k < PD_KEYPOINTS; k++)
+    {
+      h = hash_float(h, pBox->pKps[k].x);
+      h = hash_float(h, pBox->pKps[k].y);
+    }
+    det_hashes[i] = h;
+  }
+  pRes->nb = (int32_t) pp_out.box_nb;
+  pRes->hash = hash_detections((int32_t) pp_out.box_nb);
+}
+
+static const bench_case_t cases[] = {
+  { "od_yolov8", run_od_yolov8, 1 },
+  { "od_yolov8_int8", run_od_yolov8_int8, 1 },
+  { "od_yolov5", run_od_yolov5, 1 },
+  { "od_yolov5_uint8", run_od_yolov5_uint8, 1 },
+  { "od_yolov2", run_od_yolov2, 1 },
+  { "od_st_yolox", run_od_st_yolox, 1 },
+  { "od_centernet", run_od_centernet, 1 },
+  { "od_ssd", run_od_ssd, 1 },
+  { "od_ssd_st", run_od_ssd_st, 1 },
+#ifndef BENCH_BASELINE
+  { "od_tracker", run_od_tracker, 1 },
+#endif
+  { "mpe_yolov8", run_mpe_yolov8, 1 },
+  { "iseg_yolov8", run_iseg_yolov8, 1 },
+  { "spe_movenet", run_spe_movenet, 0 },
+#ifndef BENCH_BASELINE
+  { "spe_movenet_refine", run_spe_movenet_refine, 0 },
+  { "spe_movenet_int8", run_spe_movenet_int8, 0 },
+#endif
+  { "sseg_deeplabv3", run_sseg_float, 0 },
+  { "sseg_deeplabv3_uint8", run_sseg_uint8, 0 },
+  { "sseg_deeplabv3_int8", run_sseg_int8, 0 },
+  { "pd_model", run_pd_model, 1 },
+};
+
+static int bench_cmp(const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return (da > db) - (da < db);
+}
+
+static const bench_golden_t *find_golden(const bench_golden_t *pTable, size_t nb, const char *name,
+                                         const char *density)
+{
+  for (size_t i = 0; i < nb; i++)
+  {
+    if ((strcmp(pTable[i].name, name) == 0) && (strcmp(pTable[i].density, density) == 0))
+    {
+      return &pTable[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  static bench_golden_t results[sizeof(cases) / sizeof(cases[0]) * 3];
+  static bench_result_t res;
+  const char *filter = NULL;
+  int update = 0;
+  int nb_results = 0;
+  int nb_outputs = 0;
+  int nb_failed = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-u") == 0)
+    {
+      update = 1;
+    }
+    else
+    {
+      filter = argv[i];
+    }
+  }
+
+  printf("%-22s %-7s %6s %12s %12s\n", "post-processing", "density", "output", "median", "best");
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+  {
+    int nb_densities = cases[c].by_density ? (int) (sizeof(densities) / sizeof(densities[0])) : 1;
+
+    if (filter && !strstr(cases[c].name, filter))
+    {
+      continue;
+    }
+    for (int d = 0; d < nb_densities; d++)
+    {
+      const char *density = cases[c].by_density ? densities[d].name : "-";
+      const bench_golden_t *pBaseline = find_golden(goldens, sizeof(goldens) / sizeof(goldens[0]), cases[c].name,
+                                                    density);
+      const bench_golden_t *pGolden = find_golden(changes, sizeof(changes) / sizeof(changes[0]), cases[c].name,
+                                                  density);
+      const char *status;
+
+      bench_state = 0x2545F491u;
+      cases[c].run(cases[c].by_density ? densities[d].value : 0.0f, &res);
+      qsort(res.us, BENCH_RUNS, sizeof(double), bench_cmp);
+
+#ifdef BENCH_BASELINE
+      pGolden = NULL;
+#endif
+      if (pGolden == NULL)
+      {
+        pGolden = pBaseline;
+      }
+      if (pGolden == NULL)
+      {
+        status = "no golden";
+        nb_failed++;
+      }
+      else if ((pGolden->nb != res.nb) || (pGolden->hash != res.hash))
+      {
+        status = "MISMATCH";
+        nb_failed++;
+      }
+      else
+      {
+        status = (pGolden == pBaseline) ? "ok" : "ok, intended change";
+      }
+      printf("%-22s %-7s %6d %9.1f us %9.1f us  %s\n", cases[c].name, density, (int) res.nb,
+             res.us[BENCH_RUNS / 2], res.us[0], status);
+      nb_outputs++;
+#ifndef BENCH_BASELINE
+      if ((pBaseline != NULL) && (pBaseline->nb == res.nb) && (pBaseline->hash == res.hash))
+      {
+        continue;   /* not a change */
+      }
+#endif
+      results[nb_results++] = (bench_golden_t) { cases[c].name, density, res.nb, res.hash };
+    }
+  }
+
+  if (update)
+  {
+#ifdef BENCH_BASELINE
+    printf("\nstatic const bench_golden_t goldens[] = {\n");
+#else
+    printf("\nstatic const bench_golden_t changes[] = {\n");
+#endif
+    for (int i = 0; i < nb_results; i++)
+    {
+      printf("  { \"%s\", \"%s\", %d, 0x%016llXULL },\n", results[i].name, results[i].density,
+             (int) results[i].nb, (unsigned long long) results[i].hash);
+    }
+    printf("};\n");
+    return 0;
+  }
+
+  printf("%d of %d outputs differ from their golden value\n", nb_failed, nb_outputs);
+  return nb_failed ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+ /**
+ ******************************************************************************
+ * @file    pp_iseg_mask_check.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Check of the YOLOv8 instance segmentation mask modes against the previous mask decoder, built
+ * on the real sources. Each frame is post-processed in the four mask modes; the lazy ones then
+ * decode every detection with iseg_yolov8_pp_decode_mask. The reference is the full grid decoding
+ * of the previous versions, copied below, run on the coefficients the scratch arena keeps for
+ * each detection.
+ * - FULL and LAZY: the masks must be identical to the reference.
+ * - BOX and LAZY_BOX: the pixels inside the box must be identical to the reference, the others
+ *   cleared.
+ * - All the modes must output the same boxes.
+ * 8400 anchors, 80 classes, 32 prototypes of 160x160, 10 frames. The program returns 1 on a
+ * difference; the process time of each mode is reported (LAZY modes: process plus the decoding
+ * of every detection).
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_iseg_mask_check.c $L/Src/iseg_pp_yolov8.c \
+ *       $L/Src/vision_models_pp.c -lm -o pp_iseg_mask_check && ./pp_iseg_mask_check
+ */
+#include "iseg_yolov8_pp_if.h"
+#include "vision_models_pp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK_BOXES 8400
+#define CHECK_CLASSES 80
+#define CHECK_MASKS 32
+#define CHECK_MASK_SIZE 160
+#define CHECK_MAX_DETECT 32
+#define CHECK_FRAMES 10
+#define CHECK_MODES 4
+#define CHECK_DET_LEN ((4 + CHECK_CLASSES + CHECK_MASKS) * CHECK_BOXES)
+#define CHECK_PROTO_LEN (CHECK_MASK_SIZE * CHECK_MASK_SIZE * CHECK_MASKS)
+
+static const char *mode_names[CHECK_MODES] = { "FULL", "BOX", "LAZY", "LAZY_BOX" };
+
+static int8_t raw[CHECK_DET_LEN + CHECK_PROTO_LEN];
+static uint64_t scratch[(AI_ISEG_YOLOV8_PP_SCRATCH_SIZE(CHECK_BOXES, CHECK_MASKS) + 7) / 8];
+static iseg_postprocess_outBuffer_t out[CHECK_MODES][CHECK_MAX_DETECT];
+static uint8_t masks[CHECK_MODES][CHECK_MAX_DETECT][CHECK_MASK_SIZE * CHECK_MASK_SIZE];
+static uint8_t ref_mask[CHECK_MASK_SIZE * CHECK_MASK_SIZE];
+
+static double check_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int8_t check_q(int32_t q)
+{
+  return (int8_t) MAX(MIN(q, SCHAR_MAX), SCHAR_MIN);
+}
+
+/* Raw detections [4 + classes + mask coefficients][nb_boxes] (scale 1/255, zero point -128),
+ * about 1 anchor out of 300 above the threshold, then random prototypes */
+static void check_fill(uint32_t seed)
+{
+  srand(seed);
+  for (int32_t i = 0; i < CHECK_BOXES; i++)
+  {
+    int32_t hit = (rand() % 300) == 0;
+
+    raw[0 * CHECK_BOXES + i] = check_q(-128 + rand() % 256);
+    raw[1 * CHECK_BOXES + i] = check_q(-128 + rand() % 256);
+    raw[2 * CHECK_BOXES + i] = check_q(-123 + rand() % 120);
+    raw[3 * CHECK_BOXES + i] = check_q(-123 + rand() % 120);
+    for (int32_t c = 0; c < CHECK_CLASSES; c++)
+    {
+      raw[(4 + c) * CHECK_BOXES + i] = check_q(-128 + rand() % 60);
+    }
+    if (hit)
+    {
+      raw[(4 + rand() % CHECK_CLASSES) * CHECK_BOXES + i] = check_q(20 + rand() % 100);
+    }
+    for (int32_t k = 0; k < CHECK_MASKS; k++)
+    {
+      raw[(4 + CHECK_CLASSES + k) * CHECK_BOXES + i] = check_q(-128 + rand() % 256);
+    }
+  }
+  for (int32_t i = 0; i < CHECK_PROTO_LEN; i++)
+  {
+    raw[CHECK_DET_LEN + i] = check_q(-128 + rand() % 256);
+  }
+}
+
+/* Mask decoding of the previous versions: whole grid, from the int8 coefficients */
+static void ref_decode(const int8_t *pRaw_masks, const int8_t *pCoefs, uint8_t *binary_mask,
+                       const yolov8_seg_pp_static_param_t *pInput_static_param)
+{
+  int8_t mask_zp = pInput_static_param->mask_raw_output_zero_point;
+  int8_t raw_zp = pInput_static_param->raw_output_zero_point;
+  float32_t threshold_check = 0.5 / (pInput_static_param->mask_raw_output_scale * pInput_static_param->raw_output_scale);
+  int32_t threshold_check_s32 = (int32_t)(threshold_check+0.5f);
+  int32_t detection_mask[CHECK_MASKS];
+  const int8_t *Raw_masks = pRaw_masks;
+
+  for (int32_t k = 0; k < pInput_static_param->nb_masks; k++)
+  {
+    detection_mask[k] = ((int32_t)pCoefs[k] - raw_zp);
+  }
+  for (int32_t i = 0; i < pInput_static_param->size_masks; i++)
+  {
+    for (int32_t j = 0; j < pInput_static_param->size_masks; j++)
+    {
+      int32_t sum_product = 0;
+      for (int32_t k = 0; k < pInput_static_param->nb_masks; k++)
+      {
+        sum_product += detection_mask[k] * ((int32_t)(*Raw_masks) - (int32_t)mask_zp);
+        Raw_masks++;
+      }
+      *binary_mask++ = (sum_product >= threshold_check_s32)?1:0;
+    }
+  }
+}
+
+/* Box bounds in mask coordinates, as documented: pixel c is inside when min <= c < max */
+static int32_t check_bound(float32_t edge)
+{
+  float32_t v = MAX(MIN(edge * CHECK_MASK_SIZE, (float32_t) CHECK_MASK_SIZE), 0.0f);
+
+  return (int32_t) ceilf(v);
+}
+
+int main(void)
+{
+  double t[CHECK_MODES] = { 0 };
+  int32_t nb_frames_differ = 0, nb_detections = 0;
+  int64_t box_pixels = 0, mask_pixels = 0;
+
+  for (uint32_t frame = 1; frame <= CHECK_FRAMES; frame++)
+  {
+    int differ = 0;
+    int32_t nb_detect[CHECK_MODES];
+
+    check_fill(frame);
+    for (int32_t m = 0; m < CHECK_MODES; m++)
+    {
+      yolov8_seg_pp_static_param_t params = {
+        .nb_classes = CHECK_CLASSES,
+        .nb_total_boxes = CHECK_BOXES,
+        .max_boxes_limit = CHECK_MAX_DETECT,
+        .conf_threshold = 0.5f,
+        .iou_threshold = 0.5f,
+        .nb_masks = CHECK_MASKS,
+        .size_masks = CHECK_MASK_SIZE,
+        .raw_output_zero_point = -128,
+        .raw_output_scale = 1.0f / 255.0f,
+        .mask_raw_output_zero_point = 0,
+        .mask_raw_output_scale = 1.0f / 32.0f,
+        .mask_mode = (yolov8_seg_pp_mask_mode_e) m,
+      };
+      yolov8_seg_pp_in_centroid_int8_t pp_in = { raw, raw + CHECK_DET_LEN };
+      iseg_postprocess_out_t pp_out = { out[m], 0 };
+      vision_models_pp_ctx_t ctx = { scratch, sizeof(scratch) };
+      const iseg_postprocess_scratchBuffer_s8_t *pRecords = (const iseg_postprocess_scratchBuffer_s8_t *) scratch;
+      double t0;
+
+      for (int32_t i = 0; i < CHECK_MAX_DETECT; i++)
+      {
+        out[m][i].pMask = masks[m][i];
+        memset(masks[m][i], 0xA5, sizeof(masks[m][i]));   /* pixels left unwritten are caught */
+      }
+      iseg_yolov8_pp_reset(&params);
+
+      t0 = check_now();
+      if (iseg_yolov8_pp_process(&pp_in, &pp_out, &params, &ctx) != AI_ISEG_POSTPROCESS_ERROR_NO) return 1;
+      if (m >= AI_ISEG_YOLOV8_PP_MASK_LAZY)
+      {
+        for (int32_t d = 0; d < pp_out.nb_detect; d++)
+        {
+          if (iseg_yolov8_pp_decode_mask(&pp_in, &pp_out, &params, &ctx, d) != AI_ISEG_POSTPROCESS_ERROR_NO) return 1;
+        }
+      }
+      t[m] += check_now() - t0;
+      nb_detect[m] = pp_out.nb_detect;
+
+      /* Boxes of every mode are those of FULL */
+      if (nb_detect[m] != nb_detect[0])
+      {
+        differ = 1;
+        continue;
+      }
+      for (int32_t d = 0; d < pp_out.nb_detect; d++)
+      {
+        const iseg_postprocess_outBuffer_t *pDet = &out[m][d];
+        int32_t box = (m == AI_ISEG_YOLOV8_PP_MASK_BOX) || (m == AI_ISEG_YOLOV8_PP_MASK_LAZY_BOX);
+        int32_t x0 = check_bound(pDet->x_center - pDet->width * 0.5f);
+        int32_t x1 = check_bound(pDet->x_center + pDet->width * 0.5f);
+        int32_t y0 = check_bound(pDet->y_center - pDet->height * 0.5f);
+        int32_t y1 = check_bound(pDet->y_center + pDet->height * 0.5f);
+
+        differ |= (pDet->x_center != out[0][d].x_center) || (pDet->y_center != out[0][d].y_center) ||
+                  (pDet->width != out[0][d].width) || (pDet->height != out[0][d].height) ||
+                  (pDet->conf != out[0][d].conf) || (pDet->class_index != out[0][d].class_index);
+
+        ref_decode(raw + CHECK_DET_LEN, pRecords[d].pMask, ref_mask, &params);
+        for (int32_t y = 0; y < CHECK_MASK_SIZE; y++)
+        {
+          for (int32_t x = 0; x < CHECK_MASK_SIZE; x++)
+          {
+            int32_t inside = (x >= x0) && (x < x1) && (y >= y0) && (y < y1);
+            uint8_t expected = (box && !inside) ? 0 : ref_mask[y * CHECK_MASK_SIZE + x];
+
+            differ |= (masks[m][d][y * CHECK_MASK_SIZE + x] != expected);
+            if (m == AI_ISEG_YOLOV8_PP_MASK_BOX)
+            {
+              box_pixels += inside;
+              mask_pixels += inside && expected;
+            }
+          }
+        }
+      }
+    }
+    nb_detections += nb_detect[0];
+    nb_frames_differ += differ;
+    printf("frame %2u  detections %2d  %s\n", (unsigned) frame, (int) nb_detect[0], differ ? "DIFFER" : "ok");
+  }
+
+  printf("%d detections, %lld pixels inside the boxes, %lld of them set\n", (int) nb_detections,
+         (long long) box_pixels, (long long) mask_pixels);
+  for (int32_t m = 0; m < CHECK_MODES; m++)
+  {
+    printf("%-9s %8.2f ms per frame\n", mode_names[m], t[m] / 1e3 / CHECK_FRAMES);
+  }
+  printf("%s\n", nb_frames_differ ? "FAILED: the masks differ from the previous decoder" : "OK");
+
+  return nb_frames_differ != 0;
+}
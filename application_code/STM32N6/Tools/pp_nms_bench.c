@@ -0,0 +1,491 @@
+ /**
+ ******************************************************************************
+ * @file    pp_nms_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check and benchmark of the shared NMS engine of lib_vision_models_pp against the per-class
+ * NMS it replaced, for N in {100, 1k, 8k} candidates and C in {1, 80} classes.
+ * - Best class NMS (YOLOv5, YOLOv8, ST YOLOX, pose, seg): vision_models_nms_f32, exhaustive and
+ *   grid modes, against the qsort per class of the previous YOLOv8 post-processing.
+ * - Per-class NMS (Tiny YOLOv2, SSD, ST SSD): vision_models_nms_class_f32, exhaustive and grid
+ *   modes, against the quick sort of the candidates per class of the previous SSD
+ *   post-processing, followed by the same best class score filtering. The candidates have up to
+ *   3 classes with a non-zero score, so one box can survive in several classes.
+ * The references are copied from the previous sources. The confidences are distinct, so that
+ * the unstable sorts of both sides give the same order. The kept detections must be the same
+ * (compared sorted by class, confidence then box); the program returns 1 when they differ.
+ * Timings are the best of BENCH_RUNS runs, input copies excluded.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_nms_bench.c $L/Src/vision_models_pp.c \
+ *       -lm -o pp_nms_bench && ./pp_nms_bench
+ */
+#include "od_pp_output_if.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 3
+#define BENCH_MAX_N 8000
+#define BENCH_MAX_C 80
+#define BENCH_IOU 0.5f
+#define BENCH_MAX_BOXES_LIMIT 100
+#define BENCH_CONF_THRESHOLD 0.25f
+
+/* Per-class candidates: box (4) then the scores of every class */
+#define CAND_SCORES 4
+#define CAND_MAX_STRIDE (CAND_SCORES + BENCH_MAX_C)
+
+static od_pp_outBuffer_t det_raw[BENCH_MAX_N];
+static od_pp_outBuffer_t det_work[BENCH_MAX_N];
+static float32_t cand_raw[BENCH_MAX_N * CAND_MAX_STRIDE];
+static float32_t cand_work[BENCH_MAX_N * CAND_MAX_STRIDE];
+static float32_t ref_boxes[BENCH_MAX_N * 4];
+static float32_t ref_scores[BENCH_MAX_N * BENCH_MAX_C];
+static od_pp_outBuffer_t out_ref[BENCH_MAX_N];
+static od_pp_outBuffer_t out_new[BENCH_MAX_N];
+static int32_t perm[BENCH_MAX_N * BENCH_MAX_C];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static float32_t bench_rand(void)
+{
+  return (float32_t) rand() / RAND_MAX;
+}
+
+/* Distinct confidences: a random permutation of n levels spread over [low, 1) */
+static void bench_levels(int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+  {
+    perm[i] = i;
+  }
+  for (int32_t i = n - 1; i > 0; i--)
+  {
+    int32_t j = rand() % (i + 1);
+    int32_t t = perm[i];
+
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+}
+
+static float32_t bench_level(int32_t i, int32_t n, float32_t low)
+{
+  return low + (1.0f - low) * ((float32_t) perm[i] + 0.5f) / (float32_t) n;
+}
+
+/* Boxes of a 1x1 frame, clustered around a few objects so that they overlap */
+static void bench_box(float32_t *pBox)
+{
+  float32_t cx = (float32_t) (rand() % 12) / 12.0f + 0.04f;
+  float32_t cy = (float32_t) (rand() % 9) / 9.0f + 0.05f;
+
+  pBox[0] = cx + 0.04f * (bench_rand() - 0.5f);
+  pBox[1] = cy + 0.04f * (bench_rand() - 0.5f);
+  pBox[2] = 0.03f + 0.12f * bench_rand();
+  pBox[3] = 0.03f + 0.12f * bench_rand();
+}
+
+static int bench_compare(const void *pa, const void *pb)
+{
+  const od_pp_outBuffer_t *a = pa;
+  const od_pp_outBuffer_t *b = pb;
+
+  if (a->class_index != b->class_index) return a->class_index - b->class_index;
+  if (a->conf != b->conf) return (a->conf < b->conf) ? 1 : -1;
+  if (a->x_center != b->x_center) return (a->x_center < b->x_center) ? -1 : 1;
+  return (a->y_center < b->y_center) ? -1 : (a->y_center > b->y_center);
+}
+
+/* Returns 1 when both sets of detections are the same */
+static int bench_same(od_pp_outBuffer_t *pA, int32_t nb_a, od_pp_outBuffer_t *pB, int32_t nb_b)
+{
+  if (nb_a != nb_b)
+  {
+    return 0;
+  }
+  qsort(pA, nb_a, sizeof(*pA), bench_compare);
+  qsort(pB, nb_b, sizeof(*pB), bench_compare);
+  return memcmp(pA, pB, nb_a * sizeof(*pA)) == 0;
+}
+
+/* Kept detections of a best class NMS: the non-null confidences */
+static int32_t bench_kept(const od_pp_outBuffer_t *pDet, int32_t nb, od_pp_outBuffer_t *pOut)
+{
+  int32_t count = 0;
+
+  for (int32_t i = 0; i < nb; i++)
+  {
+    if (pDet[i].conf != 0)
+    {
+      pOut[count++] = pDet[i];
+    }
+  }
+  return count;
+}
+
+/* ------------------ Previous YOLOv8 NMS (qsort per class) ------------------ */
+
+static int32_t ref_sort_class;
+
+static int ref_yolov8_comparator(const void *pa, const void *pb)
+{
+  od_pp_outBuffer_t a = *(od_pp_outBuffer_t *)pa;
+  od_pp_outBuffer_t b = *(od_pp_outBuffer_t *)pb;
+  float32_t a_weighted_conf = (a.class_index == ref_sort_class) ? a.conf : 0.0f;
+  float32_t b_weighted_conf = (b.class_index == ref_sort_class) ? b.conf : 0.0f;
+  float32_t diff = a_weighted_conf - b_weighted_conf;
+
+  if (diff < 0) return 1;
+  else if (diff > 0) return -1;
+  return 0;
+}
+
+static void ref_yolov8_nms(od_pp_outBuffer_t *pDet, int32_t nb_detect, int32_t nb_classes)
+{
+  for (int32_t k = 0; k < nb_classes; ++k)
+  {
+    int32_t limit_counter = 0;
+    int32_t detections_per_class = 0;
+
+    ref_sort_class = k;
+    for (int32_t i = 0; i < nb_detect; i++)
+    {
+      detections_per_class += (pDet[i].class_index == k);
+    }
+    if (detections_per_class == 0)
+    {
+      continue;
+    }
+    qsort(pDet, nb_detect, sizeof(od_pp_outBuffer_t), ref_yolov8_comparator);
+
+    for (int32_t i = 0; i < detections_per_class; i++)
+    {
+      if (pDet[i].conf == 0) continue;
+      for (int32_t j = i + 1; j < detections_per_class; j++)
+      {
+        if (vision_models_box_iou(&pDet[i].x_center, &pDet[j].x_center) > BENCH_IOU)
+        {
+          pDet[j].conf = 0;
+        }
+      }
+    }
+    for (int32_t i = 0; i < detections_per_class; i++)
+    {
+      if ((limit_counter < BENCH_MAX_BOXES_LIMIT) && (pDet[i].conf != 0))
+      {
+        limit_counter++;
+      }
+      else
+      {
+        pDet[i].conf = 0;
+      }
+    }
+  }
+}
+
+/* --------------- Previous SSD NMS (quick sort of each class) --------------- */
+
+static int32_t ref_ssd_partition(float32_t *pScores, float32_t *pBoxes, int32_t first, int32_t last,
+                                 int32_t sort_class, int32_t nb_classes, float32_t *pTmp)
+{
+  float32_t pivot = pScores[first * nb_classes + sort_class];
+  int32_t i = first - 1;
+  int32_t j = last + 1;
+
+  while (i < j)
+  {
+    do
+    {
+      i++;
+    } while ((pScores[i * nb_classes + sort_class] > pivot) && (i < last));
+    do
+    {
+      j--;
+    } while (pScores[j * nb_classes + sort_class] < pivot);
+
+    if (i < j)
+    {
+      memcpy(pTmp, &pScores[i * nb_classes], nb_classes * sizeof(*pScores));
+      memcpy(&pScores[i * nb_classes], &pScores[j * nb_classes], nb_classes * sizeof(*pScores));
+      memcpy(&pScores[j * nb_classes], pTmp, nb_classes * sizeof(*pScores));
+
+      memcpy(pTmp, &pBoxes[i * 4], 4 * sizeof(*pTmp));
+      memcpy(&pBoxes[i * 4], &pBoxes[j * 4], 4 * sizeof(*pTmp));
+      memcpy(&pBoxes[j * 4], pTmp, 4 * sizeof(*pTmp));
+    }
+  }
+  return j;
+}
+
+static void ref_ssd_sort(float32_t *pScores, float32_t *pBoxes, int32_t first, int32_t last,
+                         int32_t sort_class, int32_t nb_classes, float32_t *pTmp)
+{
+  if (first < last)
+  {
+    int32_t pivot = ref_ssd_partition(pScores, pBoxes, first, last, sort_class, nb_classes, pTmp);
+
+    ref_ssd_sort(pScores, pBoxes, first, pivot, sort_class, nb_classes, pTmp);
+    ref_ssd_sort(pScores, pBoxes, pivot + 1, last, sort_class, nb_classes, pTmp);
+  }
+}
+
+static int32_t ref_ssd_nms(float32_t *pScores, float32_t *pBoxes, int32_t nb_detect, int32_t nb_classes,
+                           od_pp_outBuffer_t *pOut)
+{
+  float32_t tmp[BENCH_MAX_C > 4 ? BENCH_MAX_C : 4];
+  int32_t count = 0;
+
+  for (int32_t k = 0; k < nb_classes; ++k)
+  {
+    int32_t limit_counter = 0;
+
+    ref_ssd_sort(pScores, pBoxes, 0, nb_detect - 1, k, nb_classes, tmp);
+    for (int32_t i = 0; i < nb_detect; ++i)
+    {
+      if (pScores[i * nb_classes + k] == 0)
+      {
+        continue;
+      }
+      for (int32_t j = i + 1; j < nb_detect; ++j)
+      {
+        if (vision_models_box_iou(&pBoxes[4 * i], &pBoxes[4 * j]) > BENCH_IOU)
+        {
+          pScores[j * nb_classes + k] = 0;
+        }
+      }
+    }
+    for (int32_t i = 0; i < nb_detect; ++i)
+    {
+      if ((pScores[i * nb_classes + k] != 0) && (limit_counter < BENCH_MAX_BOXES_LIMIT))
+      {
+        limit_counter++;
+      }
+      else
+      {
+        pScores[i * nb_classes + k] = 0;
+      }
+    }
+  }
+
+  for (int32_t i = 0; i < nb_detect; ++i)
+  {
+    float32_t best_score;
+    uint32_t class_index;
+
+    vision_models_maxi_if32ou32(&pScores[i * nb_classes], nb_classes, &best_score, &class_index);
+    if (best_score >= BENCH_CONF_THRESHOLD)
+    {
+      memcpy(&pOut[count].x_center, &pBoxes[4 * i], 4 * sizeof(float32_t));
+      pOut[count].conf = best_score;
+      pOut[count].class_index = class_index;
+      count++;
+    }
+  }
+  return count;
+}
+
+/* Per-class NMS of the engine, followed by the same best class score filtering */
+static int32_t new_class_nms(float32_t *pCand, int32_t nb_detect, int32_t nb_classes,
+                             vision_models_nms_mode_e mode, od_pp_outBuffer_t *pOut)
+{
+  int32_t stride = CAND_SCORES + nb_classes;
+  int32_t count = 0;
+
+  vision_models_nms_class_f32(pCand, stride * sizeof(float32_t), nb_detect, CAND_SCORES * sizeof(float32_t),
+                              nb_classes, BENCH_CONF_THRESHOLD, BENCH_IOU, BENCH_MAX_BOXES_LIMIT, mode);
+  for (int32_t i = 0; i < nb_detect; ++i)
+  {
+    float32_t best_score;
+    uint32_t class_index;
+
+    vision_models_maxi_if32ou32(&pCand[i * stride + CAND_SCORES], nb_classes, &best_score, &class_index);
+    if (best_score >= BENCH_CONF_THRESHOLD)
+    {
+      memcpy(&pOut[count].x_center, &pCand[i * stride], 4 * sizeof(float32_t));
+      pOut[count].conf = best_score;
+      pOut[count].class_index = class_index;
+      count++;
+    }
+  }
+  return count;
+}
+
+/* ------------------------------- Cases ------------------------------------ */
+
+static void fill_best_class(int32_t n, int32_t nb_classes)
+{
+  bench_levels(n);
+  for (int32_t i = 0; i < n; i++)
+  {
+    bench_box(&det_raw[i].x_center);
+    det_raw[i].conf = bench_level(i, n, BENCH_CONF_THRESHOLD);
+    det_raw[i].class_index = rand() % nb_classes;
+  }
+}
+
+/* Up to 3 classes per candidate with a non-zero score, some of them below the threshold,
+ * at least one above it as the decoders only keep those candidates */
+static void fill_per_class(int32_t n, int32_t nb_classes)
+{
+  int32_t stride = CAND_SCORES + nb_classes;
+
+  bench_levels(n * nb_classes);
+  for (int32_t i = 0; i < n; i++)
+  {
+    float32_t *pCand = &cand_raw[i * stride];
+    int32_t hits = 1 + rand() % 3;
+
+    bench_box(pCand);
+    memset(&pCand[CAND_SCORES], 0, nb_classes * sizeof(float32_t));
+    for (int32_t h = 0; h < hits; h++)
+    {
+      int32_t k = rand() % nb_classes;
+      float32_t level = bench_level(i * nb_classes + k, n * nb_classes, 0.01f);
+
+      pCand[CAND_SCORES + k] = (h == 0) ? MAX(level, BENCH_CONF_THRESHOLD + level * 1e-3f) : level;
+    }
+  }
+}
+
+static int run_best_class(int32_t n, int32_t nb_classes)
+{
+  double best[3] = { 1e30, 1e30, 1e30 };
+  int32_t nb_ref = 0, nb_new = 0;
+  int same = 1;
+
+  fill_best_class(n, nb_classes);
+  for (int32_t v = 0; v < 3; v++)
+  {
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+      double t0;
+
+      memcpy(det_work, det_raw, n * sizeof(od_pp_outBuffer_t));
+      t0 = bench_now();
+      if (v == 0)
+      {
+        ref_yolov8_nms(det_work, n, nb_classes);
+      }
+      else
+      {
+        vision_models_nms_f32(det_work, sizeof(od_pp_outBuffer_t), n, BENCH_IOU, BENCH_MAX_BOXES_LIMIT,
+                              (v == 1) ? AI_VISION_MODELS_NMS_MODE_EXHAUSTIVE : AI_VISION_MODELS_NMS_MODE_GRID);
+      }
+      best[v] = MIN(best[v], bench_now() - t0);
+    }
+    if (v == 0)
+    {
+      nb_ref = bench_kept(det_work, n, out_ref);
+    }
+    else
+    {
+      nb_new = bench_kept(det_work, n, out_new);
+      same &= bench_same(out_ref, nb_ref, out_new, nb_new);
+    }
+  }
+
+  printf("best class  N=%-5d C=%-3d kept %4d %12.1f us %12.1f us (x%5.1f) %12.1f us (x%5.1f)  %s\n",
+         (int) n, (int) nb_classes, (int) nb_ref, best[0], best[1], best[0] / best[1], best[2],
+         best[0] / best[2], same ? "ok" : "DIFFER");
+  return same;
+}
+
+static int run_per_class(int32_t n, int32_t nb_classes)
+{
+  int32_t stride = CAND_SCORES + nb_classes;
+  double best[3] = { 1e30, 1e30, 1e30 };
+  int32_t nb_ref = 0, nb_new = 0;
+  int same = 1;
+
+  fill_per_class(n, nb_classes);
+  for (int32_t v = 0; v < 3; v++)
+  {
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+      double t0;
+
+      if (v == 0)
+      {
+        for (int32_t i = 0; i < n; i++)
+        {
+          memcpy(&ref_boxes[4 * i], &cand_raw[i * stride], 4 * sizeof(float32_t));
+          memcpy(&ref_scores[i * nb_classes], &cand_raw[i * stride + CAND_SCORES], nb_classes * sizeof(float32_t));
+        }
+        t0 = bench_now();
+        nb_ref = ref_ssd_nms(ref_scores, ref_boxes, n, nb_classes, out_ref);
+      }
+      else
+      {
+        memcpy(cand_work, cand_raw, n * stride * sizeof(float32_t));
+        t0 = bench_now();
+        nb_new = new_class_nms(cand_work, n, nb_classes,
+                               (v == 1) ? AI_VISION_MODELS_NMS_MODE_EXHAUSTIVE : AI_VISION_MODELS_NMS_MODE_GRID,
+                               out_new);
+      }
+      best[v] = MIN(best[v], bench_now() - t0);
+    }
+    if (v != 0)
+    {
+      same &= bench_same(out_ref, nb_ref, out_new, nb_new);
+    }
+  }
+
+  printf("per class   N=%-5d C=%-3d kept %4d %12.1f us %12.1f us (x%5.1f) %12.1f us (x%5.1f)  %s\n",
+         (int) n, (int) nb_classes, (int) nb_ref, best[0], best[1], best[0] / best[1], best[2],
+         best[0] / best[2], same ? "ok" : "DIFFER");
+  return same;
+}
+
+int main(void)
+{
+  const int32_t sizes[] = { 100, 1000, 8000 };
+  const int32_t classes[] = { 1, 80 };
+  int ok = 1;
+
+  srand(1);
+  printf("NMS                             kept     previous      exhaustive                 grid\n");
+  for (int32_t c = 0; c < 2; c++)
+  {
+    for (int32_t s = 0; s < 3; s++)
+    {
+      ok &= run_best_class(sizes[s], classes[c]);
+    }
+  }
+  for (int32_t c = 0; c < 2; c++)
+  {
+    for (int32_t s = 0; s < 3; s++)
+    {
+      ok &= run_per_class(sizes[s], classes[c]);
+    }
+  }
+  printf("%s\n", ok ? "OK" : "FAILED: the kept detections differ");
+
+  return !ok;
+}
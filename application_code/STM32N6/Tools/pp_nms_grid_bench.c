@@ -0,0 +1,266 @@
+ /**
+ ******************************************************************************
+ * @file    pp_nms_grid_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Stress check and benchmark of the grid NMS mode of lib_vision_models_pp against the exhaustive
+ * one, on dense outputs of 2k to 8.4k boxes, built on the real sources.
+ * - Scenes: uniform random boxes, a crowded parking lot (rows of same-size cars, heavily
+ *   overlapping candidates per car) and large boxes spanning many grid cells, partly outside
+ *   the [0, 1] image plane.
+ * - Engines: float (vision_models_nms_f32) and int8 (vision_models_nms_is8, with the float IoU of
+ *   the dequantized boxes of YOLOv8 and the integer IoU of YOLOv8 seg) best class NMS with
+ *   1 and 4 classes, and the per-class NMS of Tiny YOLOv2 / SSD (vision_models_nms_class_f32)
+ *   with 4 classes.
+ * - max_boxes_limit of 30, 300 (beyond the kept boxes linked in the grid) and no limit.
+ * The grid mode moves the kept records to the front of their class, so the record buffers of
+ * both modes are compared sorted: the same records must be kept and the same confidences or
+ * class scores nulled. The program returns 1 when they differ. Timings are the best of BENCH_RUNS
+ * runs, input copies excluded.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_nms_grid_bench.c $L/Src/vision_models_pp.c \
+ *       -lm -o pp_nms_grid_bench && ./pp_nms_grid_bench
+ */
+#include "od_pp_loc.h"
+#include "od_pp_output_if.h"
+#include "vision_models_pp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 5
+#define BENCH_MAX_N 8400
+#define BENCH_IOU 0.5f
+#define BENCH_CLASS_NB 4
+#define BENCH_CONF_THRESHOLD 0.3f
+
+/* int8 boxes: scale 1/200, zero point -100 (coordinates from -0.14 to 1.135) */
+#define BENCH_S8_SCALE (1.0f / 200.0f)
+#define BENCH_S8_ZP (-100)
+
+/* Per-class candidates: box then the scores of the classes */
+#define CAND_STRIDE (4 + BENCH_CLASS_NB)
+
+typedef enum {
+  SCENE_UNIFORM,
+  SCENE_PARKING,
+  SCENE_LARGE,
+  SCENE_NB
+} bench_scene_e;
+
+static const char *scene_names[SCENE_NB] = { "uniform", "parking", "large" };
+
+static od_pp_outBuffer_t f32_raw[BENCH_MAX_N];
+static od_pp_outBuffer_t f32_work[2][BENCH_MAX_N];
+static od_pp_scratchBuffer_s8_t s8_raw[BENCH_MAX_N];
+static od_pp_scratchBuffer_s8_t s8_work[2][BENCH_MAX_N];
+static float32_t cand_raw[BENCH_MAX_N * CAND_STRIDE];
+static float32_t cand_work[2][BENCH_MAX_N * CAND_STRIDE];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static float32_t bench_rand(void)
+{
+  return (float32_t) rand() / RAND_MAX;
+}
+
+static void bench_box(bench_scene_e scene, float32_t *pBox)
+{
+  switch (scene)
+  {
+    case SCENE_UNIFORM:
+      pBox[0] = bench_rand();
+      pBox[1] = bench_rand();
+      pBox[2] = 0.01f + 0.08f * bench_rand();
+      pBox[3] = 0.01f + 0.08f * bench_rand();
+      break;
+    case SCENE_PARKING:
+    {
+      /* 12 rows of 25 cars, each detected several times with some jitter */
+      int32_t car = rand() % 300;
+
+      pBox[0] = (0.5f + (car % 25)) / 25.0f + 0.008f * (bench_rand() - 0.5f);
+      pBox[1] = (0.5f + (car / 25)) / 12.0f + 0.01f * (bench_rand() - 0.5f);
+      pBox[2] = 0.036f + 0.006f * bench_rand();
+      pBox[3] = 0.07f + 0.01f * bench_rand();
+      break;
+    }
+    default:
+      pBox[0] = 1.2f * bench_rand() - 0.1f;
+      pBox[1] = 1.2f * bench_rand() - 0.1f;
+      pBox[2] = 0.05f + 0.9f * bench_rand();
+      pBox[3] = 0.05f + 0.9f * bench_rand();
+      break;
+  }
+}
+
+static int8_t bench_quantize(float32_t v)
+{
+  int32_t q = (int32_t) lroundf(v / BENCH_S8_SCALE) + BENCH_S8_ZP;
+
+  return (int8_t) MAX(MIN(q, SCHAR_MAX), SCHAR_MIN);
+}
+
+static void bench_fill(bench_scene_e scene, int32_t n, int32_t nb_classes)
+{
+  for (int32_t i = 0; i < n; i++)
+  {
+    float32_t *pCand = &cand_raw[i * CAND_STRIDE];
+
+    bench_box(scene, &f32_raw[i].x_center);
+    f32_raw[i].conf = 0.05f + 0.95f * bench_rand();
+    f32_raw[i].class_index = rand() % nb_classes;
+
+    s8_raw[i].x_center = bench_quantize(f32_raw[i].x_center);
+    s8_raw[i].y_center = bench_quantize(f32_raw[i].y_center);
+    s8_raw[i].width = bench_quantize(f32_raw[i].width);
+    s8_raw[i].height = bench_quantize(f32_raw[i].height);
+    s8_raw[i].conf = (int8_t) (rand() % 256 - 128);
+    s8_raw[i].class_index = (uint8_t) f32_raw[i].class_index;
+
+    memcpy(pCand, &f32_raw[i].x_center, 4 * sizeof(float32_t));
+    for (int32_t k = 0; k < BENCH_CLASS_NB; k++)
+    {
+      pCand[4 + k] = (bench_rand() < 0.4f) ? bench_rand() : 0.0f;
+    }
+  }
+}
+
+static size_t record_size;
+
+static int bench_compare(const void *pa, const void *pb)
+{
+  return memcmp(pa, pb, record_size);
+}
+
+/* Returns 1 when both buffers hold the same records, in any order */
+static int bench_same(void *pA, void *pB, int32_t n, size_t size)
+{
+  record_size = size;
+  qsort(pA, n, size, bench_compare);
+  qsort(pB, n, size, bench_compare);
+  return !memcmp(pA, pB, n * size);
+}
+
+/* Runs both modes of one engine, returns 1 when they give the same records */
+static int bench_modes(const char *pEngine, bench_scene_e scene, int32_t n, int32_t nb_classes, int32_t limit)
+{
+  double best[2] = { 1e30, 1e30 };
+  size_t bytes;
+  int32_t kept = 0;
+  int same;
+
+  for (int32_t m = 0; m < 2; m++)
+  {
+    vision_models_nms_mode_e mode = m ? AI_VISION_MODELS_NMS_MODE_GRID : AI_VISION_MODELS_NMS_MODE_EXHAUSTIVE;
+
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+      double t0;
+
+      if (pEngine[0] == 'f')
+      {
+        bytes = n * sizeof(od_pp_outBuffer_t);
+        memcpy(f32_work[m], f32_raw, bytes);
+        t0 = bench_now();
+        vision_models_nms_f32(f32_work[m], sizeof(od_pp_outBuffer_t), n, BENCH_IOU, limit, mode);
+      }
+      else if (pEngine[0] == 'i')
+      {
+        bytes = n * sizeof(od_pp_scratchBuffer_s8_t);
+        memcpy(s8_work[m], s8_raw, bytes);
+        t0 = bench_now();
+        vision_models_nms_is8(s8_work[m], sizeof(od_pp_scratchBuffer_s8_t), n, BENCH_IOU, limit,
+                              BENCH_S8_ZP, strcmp(pEngine, "int8") ? 0.0f : BENCH_S8_SCALE, mode);
+      }
+      else
+      {
+        bytes = n * CAND_STRIDE * sizeof(float32_t);
+        memcpy(cand_work[m], cand_raw, bytes);
+        t0 = bench_now();
+        vision_models_nms_class_f32(cand_work[m], CAND_STRIDE * sizeof(float32_t), n, 4 * sizeof(float32_t),
+                                    BENCH_CLASS_NB, BENCH_CONF_THRESHOLD, BENCH_IOU, limit, mode);
+      }
+      best[m] = MIN(best[m], bench_now() - t0);
+    }
+  }
+
+  if (pEngine[0] == 'f')
+  {
+    same = bench_same(f32_work[0], f32_work[1], n, sizeof(od_pp_outBuffer_t));
+    for (int32_t i = 0; i < n; i++) kept += (f32_work[0][i].conf != 0);
+  }
+  else if (pEngine[0] == 'i')
+  {
+    same = bench_same(s8_work[0], s8_work[1], n, sizeof(od_pp_scratchBuffer_s8_t));
+    for (int32_t i = 0; i < n; i++) kept += (s8_work[0][i].conf != SCHAR_MIN);
+  }
+  else
+  {
+    same = bench_same(cand_work[0], cand_work[1], n, CAND_STRIDE * sizeof(float32_t));
+    for (int32_t i = 0; i < n * CAND_STRIDE; i++) kept += ((i % CAND_STRIDE) >= 4) && (cand_work[0][i] >= BENCH_CONF_THRESHOLD);
+  }
+
+  printf("%-9s %-8s %5d %2d %5d %6d %10.1f us %10.1f us  x%5.1f  %s\n", pEngine, scene_names[scene], (int) n,
+         (int) nb_classes, (int) limit, (int) kept, best[0], best[1], best[0] / best[1], same ? "ok" : "DIFFER");
+  return same;
+}
+
+int main(void)
+{
+  const int32_t sizes[] = { 2000, 4000, 8400 };
+  const int32_t classes[] = { 1, BENCH_CLASS_NB };
+  int ok = 1;
+
+  srand(1);
+  printf("engine    scene        N  C limit   kept   exhaustive         grid\n");
+  for (int32_t scene = 0; scene < SCENE_NB; scene++)
+  {
+    for (int32_t s = 0; s < 3; s++)
+    {
+      for (int32_t c = 0; c < 2; c++)
+      {
+        const int32_t limits[] = { 30, 300, sizes[s] };
+
+        bench_fill((bench_scene_e) scene, sizes[s], classes[c]);
+        for (int32_t l = 0; l < 3; l++)
+        {
+          ok &= bench_modes("float", (bench_scene_e) scene, sizes[s], classes[c], limits[l]);
+          ok &= bench_modes("int8", (bench_scene_e) scene, sizes[s], classes[c], limits[l]);
+          ok &= bench_modes("int8-int", (bench_scene_e) scene, sizes[s], classes[c], limits[l]);
+          if (c == 1)
+          {
+            ok &= bench_modes("per-class", (bench_scene_e) scene, sizes[s], classes[c], limits[l]);
+          }
+        }
+      }
+    }
+  }
+  printf("%s\n", ok ? "OK" : "FAILED: the grid and exhaustive modes differ");
+
+  return !ok;
+}
@@ -0,0 +1,378 @@
+ /**
+ ******************************************************************************
+ * @file    pp_reentrancy_check.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Reentrancy check of the post-processing taking a scratch arena, built on the real sources:
+ * Tiny YOLOv2, ST YOLOX, CenterNet (accuracy mode, which upsamples its confidence map), SSD,
+ * ST SSD and YOLOv8 instance segmentation.
+ * CHECK_THREADS threads share one set of static parameters and one input per post-processing;
+ * each has its own output buffer and scratch arena. Every thread runs every post-processing
+ * CHECK_ITERS times and compares its outputs to those of a single-threaded run, and the shared
+ * inputs must be unchanged at the end. The program returns 1 on a difference.
+ * Built with -fsanitize=thread, ThreadSanitizer also reports any access to shared state.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O1 -g -Wall -fsanitize=thread -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_reentrancy_check.c $L/Src/od_pp_yolov2.c \
+ *       $L/Src/od_pp_st_yolox.c $L/Src/od_pp_centernet.c $L/Src/od_pp_ssd.c $L/Src/od_pp_ssd_st.c \
+ *       $L/Src/iseg_pp_yolov8.c $L/Src/vision_models_pp.c -lm -pthread \
+ *       -o pp_reentrancy_check && ./pp_reentrancy_check
+ */
+#include "od_centernet_pp_if.h"
+#include "od_ssd_pp_if.h"
+#include "od_ssd_st_pp_if.h"
+#include "od_st_yolox_pp_if.h"
+#include "od_yolov2_pp_if.h"
+#include "iseg_yolov8_pp_if.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_THREADS 4
+#define CHECK_ITERS 20
+#define CHECK_MAX_OUT 4096
+
+#define YOLOV2_GRID 13
+#define YOLOV2_ANCHORS 5
+#define YOLOV2_CLASSES 3
+#define YOLOV2_LEN (YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS * (5 + YOLOV2_CLASSES))
+#define YOLOX_CLASSES 2
+#define YOLOX_BOXES (32 * 32 + 16 * 16 + 8 * 8)
+#define YOLOX_LEN (YOLOX_BOXES * (5 + YOLOX_CLASSES))
+#define CENTERNET_GRID 48
+#define CENTERNET_CLASSES 8
+#define CENTERNET_LEN (CENTERNET_GRID * CENTERNET_GRID * (CENTERNET_CLASSES + 6))
+#define SSD_BOXES 1500
+#define SSD_CLASSES 6
+#define SSD_LEN ((8 + SSD_CLASSES) * SSD_BOXES)
+#define ISEG_BOXES 2100
+#define ISEG_CLASSES 8
+#define ISEG_MASKS 32
+#define ISEG_MASK_SIZE 40
+#define ISEG_MAX_DETECT 16
+#define ISEG_DET_LEN ((4 + ISEG_CLASSES + ISEG_MASKS) * ISEG_BOXES)
+#define ISEG_LEN (ISEG_DET_LEN + ISEG_MASK_SIZE * ISEG_MASK_SIZE * ISEG_MASKS)
+#define CHECK_SCRATCH_SIZE (1024 * 1024)
+
+typedef enum {
+  CASE_YOLOV2,
+  CASE_ST_YOLOX,
+  CASE_CENTERNET,
+  CASE_SSD,
+  CASE_SSD_ST,
+  CASE_ISEG,
+  CASE_NB
+} check_case_e;
+
+static const char *case_names[CASE_NB] = { "od_yolov2", "od_st_yolox", "od_centernet", "od_ssd", "od_ssd_st",
+                                           "iseg_yolov8" };
+
+/* Shared inputs and their copy */
+static float32_t yolov2_in[YOLOV2_LEN];
+static float32_t yolox_in[YOLOX_LEN];
+static float32_t centernet_in[CENTERNET_LEN];
+static float32_t ssd_in[SSD_LEN];
+static float32_t ssd_st_in[SSD_LEN];
+static int8_t iseg_in[ISEG_LEN];
+static float32_t yolov2_copy[YOLOV2_LEN];
+static float32_t yolox_copy[YOLOX_LEN];
+static float32_t centernet_copy[CENTERNET_LEN];
+static float32_t ssd_copy[SSD_LEN];
+static float32_t ssd_st_copy[SSD_LEN];
+static int8_t iseg_copy[ISEG_LEN];
+
+/* Shared static parameters, only written by the resets before the threads start */
+static yolov2_pp_static_param_t yolov2_params;
+static st_yolox_pp_static_param_t yolox_params;
+static centernet_pp_static_param_t centernet_params;
+static ssd_pp_static_param_t ssd_params;
+static ssd_st_pp_static_param_t ssd_st_params;
+static yolov8_seg_pp_static_param_t iseg_params;
+
+/* Per thread outputs and arenas, the last one holds the single-threaded reference */
+typedef struct {
+  od_pp_outBuffer_t od_out[CHECK_MAX_OUT];
+  iseg_postprocess_outBuffer_t iseg_out[ISEG_MAX_DETECT];
+  uint8_t iseg_masks[ISEG_MAX_DETECT][ISEG_MASK_SIZE * ISEG_MASK_SIZE];
+  uint64_t scratch[CHECK_SCRATCH_SIZE / 8];
+  int32_t nb_detect;
+} check_slot_t;
+
+static check_slot_t slots[CHECK_THREADS + 1];
+static check_slot_t refs[CASE_NB];
+static int32_t nb_differ[CHECK_THREADS];
+
+static float32_t check_rand(void)
+{
+  return (float32_t) rand() / RAND_MAX;
+}
+
+static int8_t check_q(int32_t q)
+{
+  return (int8_t) MAX(MIN(q, SCHAR_MAX), SCHAR_MIN);
+}
+
+static void check_fill(void)
+{
+  static const float32_t yolov2_anchors[2 * YOLOV2_ANCHORS] = { 0.9f, 1.1f, 2.0f, 3.5f, 4.2f, 2.6f, 6.5f, 6.8f, 10.1f, 9.4f };
+  static const float32_t yolox_anchors[2] = { 0.5f, 0.5f };
+
+  srand(1);
+  for (int32_t i = 0; i < YOLOV2_LEN; i++) yolov2_in[i] = 8.0f * check_rand() - 5.0f;
+  for (int32_t i = 0; i < YOLOX_LEN; i++) yolox_in[i] = 8.0f * check_rand() - 5.0f;
+  for (int32_t i = 0; i < CENTERNET_GRID * CENTERNET_GRID; i++)
+  {
+    float32_t *p = &centernet_in[i * (CENTERNET_CLASSES + 6)];
+
+    p[0] = (check_rand() < 0.1f) ? 0.6f + 0.4f * check_rand() : 0.3f * check_rand();
+    p[1] = 1.0f + 6.0f * check_rand();
+    p[2] = 1.0f + 6.0f * check_rand();
+    for (int32_t k = 3; k < CENTERNET_CLASSES + 6; k++) p[k] = check_rand();
+  }
+  for (int32_t i = 0; i < SSD_BOXES; i++)
+  {
+    float32_t *pAnchor = &ssd_in[4 * SSD_BOXES + 4 * i];
+
+    for (int32_t k = 0; k < 4; k++) ssd_in[4 * i + k] = 0.2f * check_rand() - 0.1f;
+    pAnchor[0] = 0.7f * check_rand();
+    pAnchor[1] = 0.7f * check_rand();
+    pAnchor[2] = 0.05f + 0.25f * check_rand();
+    pAnchor[3] = 0.05f + 0.25f * check_rand();
+    for (int32_t k = 0; k < SSD_CLASSES; k++)
+    {
+      ssd_in[8 * SSD_BOXES + i * SSD_CLASSES + k] = (check_rand() < 0.05f) ? 0.5f + 0.5f * check_rand() : 0.3f * check_rand();
+    }
+  }
+  memcpy(ssd_st_in, ssd_in, sizeof(ssd_in));
+  for (int32_t i = 0; i < SSD_BOXES; i++)
+  {
+    /* ST SSD anchors are corners */
+    ssd_st_in[4 * SSD_BOXES + 4 * i + 2] += ssd_st_in[4 * SSD_BOXES + 4 * i];
+    ssd_st_in[4 * SSD_BOXES + 4 * i + 3] += ssd_st_in[4 * SSD_BOXES + 4 * i + 1];
+  }
+  for (int32_t i = 0; i < ISEG_BOXES; i++)
+  {
+    iseg_in[0 * ISEG_BOXES + i] = check_q(-128 + rand() % 256);
+    iseg_in[1 * ISEG_BOXES + i] = check_q(-128 + rand() % 256);
+    iseg_in[2 * ISEG_BOXES + i] = check_q(-123 + rand() % 120);
+    iseg_in[3 * ISEG_BOXES + i] = check_q(-123 + rand() % 120);
+    for (int32_t c = 0; c < ISEG_CLASSES; c++) iseg_in[(4 + c) * ISEG_BOXES + i] = check_q(-128 + rand() % 60);
+    if ((rand() % 100) == 0) iseg_in[(4 + rand() % ISEG_CLASSES) * ISEG_BOXES + i] = check_q(20 + rand() % 100);
+    for (int32_t k = 0; k < ISEG_MASKS; k++) iseg_in[(4 + ISEG_CLASSES + k) * ISEG_BOXES + i] = check_q(-128 + rand() % 256);
+  }
+  for (int32_t i = ISEG_DET_LEN; i < ISEG_LEN; i++) iseg_in[i] = check_q(-128 + rand() % 256);
+
+  memcpy(yolov2_copy, yolov2_in, sizeof(yolov2_in));
+  memcpy(yolox_copy, yolox_in, sizeof(yolox_in));
+  memcpy(centernet_copy, centernet_in, sizeof(centernet_in));
+  memcpy(ssd_copy, ssd_in, sizeof(ssd_in));
+  memcpy(ssd_st_copy, ssd_st_in, sizeof(ssd_st_in));
+  memcpy(iseg_copy, iseg_in, sizeof(iseg_in));
+
+  yolov2_params = (yolov2_pp_static_param_t) {
+    .nb_classes = YOLOV2_CLASSES, .nb_anchors = YOLOV2_ANCHORS,
+    .grid_width = YOLOV2_GRID, .grid_height = YOLOV2_GRID,
+    .nb_input_boxes = YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS,
+    .max_boxes_limit = 50, .conf_threshold = 0.3f, .iou_threshold = 0.4f, .pAnchors = yolov2_anchors,
+  };
+  yolox_params = (st_yolox_pp_static_param_t) {
+    .nb_classes = YOLOX_CLASSES, .nb_anchors = 1,
+    .grid_width_L = 32, .grid_height_L = 32, .grid_width_M = 16, .grid_height_M = 16,
+    .grid_width_S = 8, .grid_height_S = 8,
+    .max_boxes_limit = 50, .conf_threshold = 0.3f, .iou_threshold = 0.4f,
+    .pAnchors_L = yolox_anchors, .pAnchors_M = yolox_anchors, .pAnchors_S = yolox_anchors,
+  };
+  centernet_params = (centernet_pp_static_param_t) {
+    .nb_classifs = CENTERNET_CLASSES, .grid_width = CENTERNET_GRID, .grid_height = CENTERNET_GRID,
+    .max_boxes_limit = 50, .conf_threshold = 0.5f, .iou_threshold = 0.5f,
+    .optim = AI_OD_CENTERNET_PP_OPTIM_ACCURACY,
+  };
+  ssd_params = (ssd_pp_static_param_t) {
+    .nb_classes = SSD_CLASSES, .nb_detections = SSD_BOXES, .XY_scale = 10.0f, .WH_scale = 5.0f,
+    .max_boxes_limit = 50, .conf_threshold = 0.5f, .iou_threshold = 0.5f,
+  };
+  ssd_st_params = (ssd_st_pp_static_param_t) {
+    .nb_classes = SSD_CLASSES, .nb_detections = SSD_BOXES,
+    .max_boxes_limit = 50, .conf_threshold = 0.5f, .iou_threshold = 0.5f,
+  };
+  iseg_params = (yolov8_seg_pp_static_param_t) {
+    .nb_classes = ISEG_CLASSES, .nb_total_boxes = ISEG_BOXES, .max_boxes_limit = ISEG_MAX_DETECT,
+    .conf_threshold = 0.5f, .iou_threshold = 0.5f, .nb_masks = ISEG_MASKS, .size_masks = ISEG_MASK_SIZE,
+    .raw_output_zero_point = -128, .raw_output_scale = 1.0f / 255.0f,
+    .mask_raw_output_zero_point = 0, .mask_raw_output_scale = 1.0f / 32.0f,
+    .mask_mode = AI_ISEG_YOLOV8_PP_MASK_FULL,
+  };
+  od_yolov2_pp_reset(&yolov2_params);
+  od_st_yolox_pp_reset(&yolox_params);
+  od_centernet_pp_reset(&centernet_params);
+  od_ssd_pp_reset(&ssd_params);
+  od_ssd_st_pp_reset(&ssd_st_params);
+  iseg_yolov8_pp_reset(&iseg_params);
+
+  assert(od_yolov2_pp_get_scratch_size(&yolov2_params) <= CHECK_SCRATCH_SIZE);
+  assert(od_st_yolox_pp_get_scratch_size(&yolox_params) <= CHECK_SCRATCH_SIZE);
+  assert(od_centernet_pp_get_scratch_size(&centernet_params) <= CHECK_SCRATCH_SIZE);
+  assert(od_ssd_pp_get_scratch_size(&ssd_params) <= CHECK_SCRATCH_SIZE);
+  assert(od_ssd_st_pp_get_scratch_size(&ssd_st_params) <= CHECK_SCRATCH_SIZE);
+  assert(iseg_yolov8_pp_get_scratch_size(&iseg_params) <= CHECK_SCRATCH_SIZE);
+}
+
+/* Runs one post-processing into a slot, returns its error code */
+static int32_t check_run(check_case_e c, check_slot_t *pSlot)
+{
+  vision_models_pp_ctx_t ctx = { pSlot->scratch, sizeof(pSlot->scratch) };
+  od_pp_out_t od = { pSlot->od_out, 0 };
+  int32_t error;
+
+  switch (c)
+  {
+    case CASE_YOLOV2:
+    {
+      yolov2_pp_in_t in = { yolov2_in };
+      error = od_yolov2_pp_process(&in, &od, &yolov2_params, &ctx);
+      break;
+    }
+    case CASE_ST_YOLOX:
+    {
+      st_yolox_pp_in_t in = { yolox_in, yolox_in + 32 * 32 * (5 + YOLOX_CLASSES),
+                              yolox_in + (32 * 32 + 16 * 16) * (5 + YOLOX_CLASSES) };
+      error = od_st_yolox_pp_process(&in, &od, &yolox_params, &ctx);
+      break;
+    }
+    case CASE_CENTERNET:
+    {
+      centernet_pp_in_t in = { centernet_in };
+      error = od_centernet_pp_process(&in, &od, &centernet_params, &ctx);
+      break;
+    }
+    case CASE_SSD:
+    {
+      ssd_pp_in_centroid_t in = { ssd_in, ssd_in + 4 * SSD_BOXES, ssd_in + 8 * SSD_BOXES };
+      error = od_ssd_pp_process(&in, &od, &ssd_params, &ctx);
+      break;
+    }
+    case CASE_SSD_ST:
+    {
+      ssd_st_pp_in_centroid_t in = { ssd_st_in, ssd_st_in + 4 * SSD_BOXES, ssd_st_in + 8 * SSD_BOXES };
+      error = od_ssd_st_pp_process(&in, &od, &ssd_st_params, &ctx);
+      break;
+    }
+    default:
+    {
+      yolov8_seg_pp_in_centroid_int8_t in = { iseg_in, iseg_in + ISEG_DET_LEN };
+      iseg_postprocess_out_t out = { pSlot->iseg_out, 0 };
+
+      for (int32_t i = 0; i < ISEG_MAX_DETECT; i++)
+      {
+        pSlot->iseg_out[i].pMask = pSlot->iseg_masks[i];
+      }
+      error = iseg_yolov8_pp_process(&in, &out, &iseg_params, &ctx);
+      pSlot->nb_detect = out.nb_detect;
+      return error;
+    }
+  }
+  pSlot->nb_detect = od.nb_detect;
+
+  return error;
+}
+
+/* Returns 1 when the slot holds the reference outputs of the post-processing */
+static int check_same(check_case_e c, const check_slot_t *pSlot)
+{
+  const check_slot_t *pRef = &refs[c];
+
+  if (pSlot->nb_detect != pRef->nb_detect)
+  {
+    return 0;
+  }
+  if (c != CASE_ISEG)
+  {
+    return memcmp(pSlot->od_out, pRef->od_out, pRef->nb_detect * sizeof(od_pp_outBuffer_t)) == 0;
+  }
+  for (int32_t d = 0; d < pRef->nb_detect; d++)
+  {
+    const iseg_postprocess_outBuffer_t *pA = &pSlot->iseg_out[d];
+    const iseg_postprocess_outBuffer_t *pB = &pRef->iseg_out[d];
+
+    if ((pA->x_center != pB->x_center) || (pA->y_center != pB->y_center) || (pA->width != pB->width) ||
+        (pA->height != pB->height) || (pA->conf != pB->conf) || (pA->class_index != pB->class_index) ||
+        memcmp(pSlot->iseg_masks[d], pRef->iseg_masks[d], sizeof(pSlot->iseg_masks[d])))
+    {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static void *check_thread(void *pArg)
+{
+  int32_t t = (int32_t) (intptr_t) pArg;
+
+  for (int32_t it = 0; it < CHECK_ITERS; it++)
+  {
+    for (int32_t c = 0; c < CASE_NB; c++)
+    {
+      int32_t error = check_run((check_case_e) c, &slots[t]);
+
+      nb_differ[t] += (error != 0) || !check_same((check_case_e) c, &slots[t]);
+    }
+  }
+
+  return NULL;
+}
+
+int main(void)
+{
+  pthread_t threads[CHECK_THREADS];
+  int32_t total = 0;
+  int inputs_same;
+
+  check_fill();
+  for (int32_t c = 0; c < CASE_NB; c++)
+  {
+    if (check_run((check_case_e) c, &refs[c]) != 0)
+    {
+      printf("%s: error\n", case_names[c]);
+      return 1;
+    }
+    printf("%-12s %4d detections\n", case_names[c], (int) refs[c].nb_detect);
+  }
+
+  for (int32_t t = 0; t < CHECK_THREADS; t++)
+  {
+    pthread_create(&threads[t], NULL, check_thread, (void *) (intptr_t) t);
+  }
+  for (int32_t t = 0; t < CHECK_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+    total += nb_differ[t];
+  }
+
+  inputs_same = !memcmp(yolov2_in, yolov2_copy, sizeof(yolov2_in)) && !memcmp(yolox_in, yolox_copy, sizeof(yolox_in)) &&
+                !memcmp(centernet_in, centernet_copy, sizeof(centernet_in)) && !memcmp(ssd_in, ssd_copy, sizeof(ssd_in)) &&
+                !memcmp(ssd_st_in, ssd_st_copy, sizeof(ssd_st_in)) && !memcmp(iseg_in, iseg_copy, sizeof(iseg_in));
+  printf("%d threads x %d iterations: %d outputs differ from the single-threaded run, shared inputs %s\n",
+         CHECK_THREADS, CHECK_ITERS, (int) total, inputs_same ? "unchanged" : "MODIFIED");
+  printf("%s\n", (total == 0 && inputs_same) ? "OK" : "FAILED");
+
+  return !(total == 0 && inputs_same);
+}
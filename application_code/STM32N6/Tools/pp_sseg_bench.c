@@ -0,0 +1,243 @@
+ /**
+ ******************************************************************************
+ * @file    pp_sseg_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check and benchmark of the DeepLabV3 streaming post-processing on a 257x257x21 output,
+ * built on the real lib_vision_models_pp sources.
+ * - Reference: argmax into a class index map, then the separate loops of a display overlay
+ *   (ARGB4444 color lookup) and of the class histogram and extents.
+ * - Streaming: a single sseg_deeplabv3_pp_process writing the overlay pixels and the class
+ *   statistics, processed at once or by tiles of rows, and with one pixel out of 2.
+ * Outputs, and the class index map output, are checked identical for float32, uint8 and int8
+ * outputs.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_sseg_bench.c $L/Src/sseg_pp_deeplabv3.c \
+ *       $L/Src/vision_models_pp.c -lm -o pp_sseg_bench && ./pp_sseg_bench
+ */
+#include "sseg_deeplabv3_pp_if.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 20
+#define SSEG_W 257
+#define SSEG_H 257
+#define SSEG_C 21
+#define SSEG_PIX (SSEG_W * SSEG_H)
+#define SSEG_ROW_TILE 16
+
+static float32_t raw_f[SSEG_PIX * SSEG_C];
+static uint8_t raw_u8[SSEG_PIX * SSEG_C];
+static int8_t raw_s8[SSEG_PIX * SSEG_C];
+static uint32_t color_map[SSEG_C];
+
+static uint8_t ref_map[SSEG_PIX];
+static uint16_t ref_overlay[SSEG_PIX];
+static uint32_t ref_hist[SSEG_C];
+static sseg_pp_extent_t ref_extents[SSEG_C];
+
+static uint16_t out_overlay[SSEG_PIX];
+static uint32_t out_hist[SSEG_C];
+static sseg_pp_extent_t out_extents[SSEG_C];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Blobs of classes: each pixel favours the class of its 16x16 block, with noise */
+static void fill_inputs(void)
+{
+  for (int y = 0; y < SSEG_H; y++)
+  {
+    for (int x = 0; x < SSEG_W; x++)
+    {
+      int block_class = ((x / 16) * 7 + (y / 16) * 3) % SSEG_C;
+      for (int c = 0; c < SSEG_C; c++)
+      {
+        int v = (rand() % 100) + ((c == block_class) ? 60 : 0);
+        int i = (y * SSEG_W + x) * SSEG_C + c;
+        raw_u8[i] = (uint8_t) v;
+        raw_s8[i] = (int8_t) (v - 128);
+        raw_f[i] = v * 0.037f - 2.0f;
+      }
+    }
+  }
+  for (int c = 0; c < SSEG_C; c++)
+  {
+    color_map[c] = 0x80000000u | ((uint32_t) rand() & 0x00FFFFFFu);
+  }
+}
+
+static uint32_t ref_class(e_sseg_data_type type, int pix)
+{
+  uint32_t best = 0;
+
+  for (uint32_t c = 1; c < SSEG_C; c++)
+  {
+    int i = pix * SSEG_C;
+    int greater = (type == AI_SSEG_DATA_FLOAT) ? (raw_f[i + c] > raw_f[i + best]) :
+                  (type == AI_SSEG_DATA_UINT8) ? (raw_u8[i + c] > raw_u8[i + best]) :
+                  (raw_s8[i + c] > raw_s8[i + best]);
+    if (greater)
+    {
+      best = c;
+    }
+  }
+  return best;
+}
+
+/* Argmax map, then the overlay and statistics loops of the application */
+static void reference(e_sseg_data_type type, uint32_t step)
+{
+  uint32_t out_w = (SSEG_W + step - 1) / step;
+  uint32_t out_h = (SSEG_H + step - 1) / step;
+
+  for (uint32_t y = 0; y < out_h; y++)
+  {
+    for (uint32_t x = 0; x < out_w; x++)
+    {
+      ref_map[y * out_w + x] = (uint8_t) ref_class(type, y * step * SSEG_W + x * step);
+    }
+  }
+  for (uint32_t i = 0; i < out_w * out_h; i++)
+  {
+    uint32_t argb = color_map[ref_map[i]];
+    ref_overlay[i] = (uint16_t) (((argb >> 16) & 0xF000) | ((argb >> 12) & 0x0F00) | ((argb >> 8) & 0x00F0) |
+                                 ((argb >> 4) & 0x000F));
+  }
+  memset(ref_hist, 0, sizeof(ref_hist));
+  for (int c = 0; c < SSEG_C; c++)
+  {
+    ref_extents[c] = (sseg_pp_extent_t) { UINT16_MAX, UINT16_MAX, 0, 0 };
+  }
+  for (uint32_t y = 0; y < out_h; y++)
+  {
+    for (uint32_t x = 0; x < out_w; x++)
+    {
+      sseg_pp_extent_t *e = &ref_extents[ref_map[y * out_w + x]];
+      ref_hist[ref_map[y * out_w + x]]++;
+      e->x_min = MIN(e->x_min, x);
+      e->x_max = MAX(e->x_max, x);
+      e->y_min = MIN(e->y_min, y);
+      e->y_max = MAX(e->y_max, y);
+    }
+  }
+}
+
+static void streaming(void *raw, sseg_deeplabv3_pp_static_param_t *params, uint32_t row_tile)
+{
+  sseg_deeplabv3_pp_in_t pp_in = { raw };
+  sseg_pp_out_t pp_out = { (uint8_t *) out_overlay, out_hist, out_extents };
+
+  for (uint32_t row = 0; row < SSEG_H; row += row_tile)
+  {
+    int32_t error = sseg_deeplabv3_pp_process_rows(&pp_in, &pp_out, params, row, row_tile);
+    assert(error == AI_SSEG_POSTPROCESS_ERROR_NO);
+  }
+}
+
+static void bench(const char *name, e_sseg_data_type type, void *raw, uint32_t step)
+{
+  sseg_deeplabv3_pp_static_param_t params = {
+    .width = SSEG_W,
+    .height = SSEG_H,
+    .nb_classes = SSEG_C,
+    .type = type,
+    .out_format = AI_SSEG_OUT_ARGB4444,
+    .color_map = color_map,
+    .out_step = step,
+  };
+  uint32_t nb_out;
+  double t0, t1, t2, t3;
+
+  assert(sseg_deeplabv3_pp_reset(&params) == AI_SSEG_POSTPROCESS_ERROR_NO);
+  nb_out = params.out_width * params.out_height;
+
+  reference(type, step);
+  for (uint32_t row_tile = 1; row_tile <= SSEG_H; row_tile += SSEG_ROW_TILE)
+  {
+    memset(out_overlay, 0, sizeof(out_overlay));
+    streaming(raw, &params, row_tile);
+    assert(memcmp(out_overlay, ref_overlay, nb_out * sizeof(uint16_t)) == 0);
+    assert(memcmp(out_hist, ref_hist, sizeof(ref_hist)) == 0);
+    for (int c = 0; c < SSEG_C; c++)
+    {
+      if (ref_hist[c])
+      {
+        assert(memcmp(&out_extents[c], &ref_extents[c], sizeof(sseg_pp_extent_t)) == 0);
+      }
+    }
+  }
+
+  /* Class index map output */
+  sseg_deeplabv3_pp_static_param_t params_index = params;
+  sseg_deeplabv3_pp_in_t pp_in = { raw };
+  sseg_pp_out_t pp_out = { (uint8_t *) out_overlay, NULL, NULL };
+  params_index.out_format = AI_SSEG_OUT_INDEX;
+  assert(sseg_deeplabv3_pp_reset(&params_index) == AI_SSEG_POSTPROCESS_ERROR_NO);
+  assert(sseg_deeplabv3_pp_process(&pp_in, &pp_out, &params_index) == AI_SSEG_POSTPROCESS_ERROR_NO);
+  assert(memcmp(out_overlay, ref_map, nb_out) == 0);
+
+  t0 = bench_now();
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    reference(type, step);
+  }
+  t1 = bench_now();
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    streaming(raw, &params, SSEG_H);
+  }
+  t2 = bench_now();
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    streaming(raw, &params, SSEG_ROW_TILE);
+  }
+  t3 = bench_now();
+
+  printf("%-8s step %u %3ux%-3u: reference %6.2f ms  streaming %6.2f ms (x%.2f)  by %d rows %6.2f ms\n",
+         name, step, (unsigned) params.out_width, (unsigned) params.out_height,
+         (t1 - t0) / BENCH_RUNS / 1e3, (t2 - t1) / BENCH_RUNS / 1e3, (t1 - t0) / (t2 - t1), SSEG_ROW_TILE,
+         (t3 - t2) / BENCH_RUNS / 1e3);
+}
+
+int main(void)
+{
+  srand(1);
+  fill_inputs();
+
+  printf("DeepLabV3 %dx%dx%d, ARGB4444 overlay + class histogram and extents, same outputs\n",
+         SSEG_W, SSEG_H, SSEG_C);
+  for (uint32_t step = 1; step <= 2; step++)
+  {
+    bench("float32", AI_SSEG_DATA_FLOAT, raw_f, step);
+    bench("uint8", AI_SSEG_DATA_UINT8, raw_u8, step);
+    bench("int8", AI_SSEG_DATA_INT8, raw_s8, step);
+  }
+
+  return 0;
+}
@@ -0,0 +1,358 @@
+ /**
+ ******************************************************************************
+ * @file    pp_threshold_bench.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check and benchmark of the early rejection of the lib_vision_models_pp decoders, built on
+ * the real sources. The confidence threshold is converted once at reset time into the domain of the
+ * raw model output, so that most candidates are rejected with a single compare.
+ * - Checks that the logit and quantized thresholds select exactly the values whose activated or
+ *   dequantized score passes the threshold.
+ * - Checks that the palm detector, Tiny YOLOv2 and ST YOLOX keep the same detections as when
+ *   every candidate is activated, and reports the candidates per second of both.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_threshold_bench.c $L/Src/pd_pp_model.c \
+ *       $L/Src/od_pp_yolov2.c $L/Src/od_pp_st_yolox.c $L/Src/vision_models_pp.c -lm \
+ *       -o pp_threshold_bench && ./pp_threshold_bench
+ */
+#include "pd_model_pp_if.h"
+#include "pd_pp_loc.h"
+#include "od_yolov2_pp_if.h"
+#include "od_st_yolox_pp_if.h"
+#include "od_pp_loc.h"
+#include "vision_models_pp.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 200
+
+/* Palm detector 192x192 */
+#define PD_BOXES 2016
+#define PD_KEYPOINTS 7
+#define PD_BOX_LEN (AI_PD_MODEL_PP_KEYPOINTS + 2 * PD_KEYPOINTS)
+
+/* Tiny YOLOv2 and ST YOLOX, with a tail of the objectness logits above the threshold */
+#define YOLO_NB_CLASSES 1
+#define YOLO_ANCH_LEN (AI_YOLOV2_PP_CLASSPROB + YOLO_NB_CLASSES)
+#define YOLOV2_GRID 7
+#define YOLOV2_ANCHORS 5
+#define YOLOV2_LEN (YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS * YOLO_ANCH_LEN)
+#define YOLOX_LEN_L (32 * 32 * YOLO_ANCH_LEN)
+#define YOLOX_LEN_M (16 * 16 * YOLO_ANCH_LEN)
+#define YOLOX_LEN_S (8 * 8 * YOLO_ANCH_LEN)
+
+static float32_t pd_probs[PD_BOXES];
+static float32_t pd_boxes[PD_BOXES * PD_BOX_LEN];
+static pd_pp_point_t pd_anchors[PD_BOXES];
+static pd_pp_box_t pd_out[2][PD_BOXES];
+static pd_pp_point_t pd_kps[2][PD_BOXES][PD_KEYPOINTS];
+
+static float32_t yolo_raw[YOLOX_LEN_L + YOLOX_LEN_M + YOLOX_LEN_S];
+static float32_t yolo_work[YOLOX_LEN_L + YOLOX_LEN_M + YOLOX_LEN_S];
+static od_pp_outBuffer_t yolo_out[2][YOLOX_LEN_L / YOLO_ANCH_LEN];
+/* ST YOLOX arena, for its largest level: larger than the Tiny YOLOv2 one */
+static uint64_t yolo_scratch[(AI_OD_ST_YOLOX_PP_SCRATCH_SIZE(32 * 32, YOLO_NB_CLASSES) + 7) / 8];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static float32_t bench_rand(void)
+{
+  return (float32_t) rand() / RAND_MAX;
+}
+
+/* Normal draw, Box-Muller */
+static float32_t bench_normal(float32_t mean, float32_t sigma)
+{
+  float32_t u = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  float32_t v = bench_rand();
+
+  return mean + sigma * sqrtf(-2.0f * logf(u)) * cosf(2.0f * PI * v);
+}
+
+static void check_thresholds(void)
+{
+  const float32_t fixed[] = { 1e-6f, 0.25f, 0.5f, 0.6f, 0.999999f, 1.0f };
+
+  for (int t = 0; t < 1000; t++)
+  {
+    float32_t threshold = (t < 6) ? fixed[t] : bench_rand();
+    float32_t logit = vision_models_logit_threshold_f(threshold);
+
+    if (threshold <= 0.0f)
+    {
+      continue;
+    }
+    assert(vision_models_sigmoid_f(logit) >= threshold);
+    assert(vision_models_sigmoid_f(nextafterf(logit, -INFINITY)) < threshold);
+    for (int i = 0; i < 1000; i++)
+    {
+      float32_t x = bench_normal(logit, (i & 1) ? 1e-5f : 4.0f);
+
+      assert((x >= logit) == (vision_models_sigmoid_f(x) >= threshold));
+    }
+  }
+  assert(vision_models_logit_threshold_f(0.0f) == -INFINITY);
+  assert(vision_models_logit_threshold_f(1.5f) == INFINITY);
+
+  for (int t = 0; t < 10000; t++)
+  {
+    float32_t scale = 0.001f + bench_rand() * 0.05f;
+    float32_t threshold = bench_rand() * 1.2f - 0.1f;
+    int32_t zp_s8 = rand() % 256 - 128;
+    int32_t zp_u8 = rand() % 256;
+    int32_t q_s8 = vision_models_quantize_threshold_is8(threshold, scale, zp_s8);
+    int32_t q_u8 = vision_models_quantize_threshold_iu8(threshold, scale, zp_u8);
+
+    for (int32_t q = 0; q < 256; q++)
+    {
+      assert((q - 128 >= q_s8) == (scale * (float32_t) (q - 128 - zp_s8) >= threshold));
+      assert((q >= q_u8) == (scale * (float32_t) (q - zp_u8) >= threshold));
+    }
+  }
+  printf("Thresholds: logit, int8 and uint8 select the same values as the activated scores\n");
+}
+
+/* Palm detector decoding loop, previous version with every probability activated before the
+ * compare, or with the rejection on the logit of pd_pp_model.c */
+static uint32_t ref_pd_decode(pd_pp_box_t *pBoxes, const pd_model_pp_static_param_t *params, int early)
+{
+  float32_t width = params->width;
+  float32_t height = params->height;
+  uint32_t box_nb = 0;
+
+  for (uint32_t i = 0; i < params->nb_total_boxes; i++)
+  {
+    pd_pp_box_t *pBox = &pBoxes[box_nb];
+
+    if (early && pd_probs[i] < params->conf_threshold_logit)
+    {
+      continue;
+    }
+    pBox->prob = 1.0f / (1.0f + expf(-pd_probs[i]));
+    if (pBox->prob >= params->conf_threshold)
+    {
+      pBox->x_center = (pd_anchors[i].x * width + pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_XCENTER]) / width;
+      pBox->y_center = (pd_anchors[i].y * height + pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_YCENTER]) / height;
+      pBox->width = pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_WIDTHREL] / width;
+      pBox->height = pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_HEIGHTREL] / height;
+      for (uint32_t j = 0; j < params->nb_keypoints; j++)
+      {
+        pBox->pKps[j].x = (pd_anchors[i].x * width + pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_KEYPOINTS + 2 * j]) / width;
+        pBox->pKps[j].y = (pd_anchors[i].y * height + pd_boxes[i * PD_BOX_LEN + AI_PD_MODEL_PP_KEYPOINTS + 2 * j + 1]) / height;
+      }
+      box_nb++;
+    }
+  }
+  return box_nb;
+}
+
+static int pd_cmp(const void *a, const void *b)
+{
+  const pd_pp_box_t *box_a = a;
+  const pd_pp_box_t *box_b = b;
+
+  return (box_a->prob < box_b->prob) - (box_a->prob > box_b->prob);
+}
+
+static void check_pd(void)
+{
+  pd_model_pp_static_param_t params = {
+    .width = 192,
+    .height = 192,
+    .nb_keypoints = PD_KEYPOINTS,
+    .conf_threshold = 0.5f,
+    .iou_threshold = 2.0f,          /* NMS keeps every box, to compare the decoding */
+    .nb_total_boxes = PD_BOXES,
+    .max_boxes_limit = PD_BOXES,
+    .pAnchors = pd_anchors,
+  };
+  pd_model_pp_in_t pp_in = { pd_probs, pd_boxes };
+  pd_postprocess_out_t pp_out = { pd_out[1], 0 };
+  uint32_t ref_nb;
+
+  for (int i = 0; i < PD_BOXES; i++)
+  {
+    pd_probs[i] = bench_normal(-6.0f, 3.0f);
+    pd_anchors[i].x = bench_rand();
+    pd_anchors[i].y = bench_rand();
+    pd_out[0][i].pKps = pd_kps[0][i];
+    pd_out[1][i].pKps = pd_kps[1][i];
+  }
+  for (int i = 0; i < PD_BOXES * PD_BOX_LEN; i++)
+  {
+    pd_boxes[i] = bench_normal(0.0f, 20.0f);
+  }
+  pd_model_pp_reset(&params);
+
+  ref_nb = ref_pd_decode(pd_out[0], &params, 0);
+  pd_model_pp_process(&pp_in, &pp_out, &params);
+  assert(ref_nb == pp_out.box_nb);
+  qsort(pd_out[0], ref_nb, sizeof(pd_pp_box_t), pd_cmp);
+  for (uint32_t i = 0; i < ref_nb; i++)
+  {
+    assert(memcmp(&pd_out[0][i], &pd_out[1][i], offsetof(pd_pp_box_t, pKps)) == 0);
+    assert(memcmp(pd_out[0][i].pKps, pd_out[1][i].pKps, sizeof(pd_kps[0][0])) == 0);
+  }
+  assert(ref_pd_decode(pd_out[1], &params, 1) == ref_nb);
+
+  double t0 = bench_now();
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    ref_pd_decode(pd_out[0], &params, 0);
+  }
+  double t1 = bench_now();
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    ref_pd_decode(pd_out[1], &params, 1);
+  }
+  double t2 = bench_now();
+
+  printf("Palm detector %d anchors, %u above the threshold: same boxes\n", PD_BOXES, ref_nb);
+  printf("  activate all %7.1f Mcand/s  early rejection %7.1f Mcand/s  x%.2f\n",
+         PD_BOXES * BENCH_RUNS / (t1 - t0), PD_BOXES * BENCH_RUNS / (t2 - t1), (t1 - t0) / (t2 - t1));
+}
+
+static void yolo_fill(float32_t *raw, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i += YOLO_ANCH_LEN)
+  {
+    for (uint32_t k = 0; k < YOLO_ANCH_LEN; k++)
+    {
+      raw[i + k] = bench_normal(0.0f, 1.0f);
+    }
+    raw[i + AI_YOLOV2_PP_OBJECTNESS] = bench_normal(-5.0f, 2.5f);
+  }
+}
+
+static int yolo_same(const od_pp_out_t *a, const od_pp_out_t *b)
+{
+  return (a->nb_detect == b->nb_detect) &&
+         (memcmp(a->pOutBuff, b->pOutBuff, a->nb_detect * sizeof(od_pp_outBuffer_t)) == 0);
+}
+
+/* Previous behaviour: the logit threshold at -INFINITY activates every candidate */
+static void check_yolov2(void)
+{
+  const float32_t anchors[2 * YOLOV2_ANCHORS] = { 0.9f, 1.1f, 2.1f, 2.6f, 3.4f, 5.4f, 6.1f, 8.9f, 9.5f, 10.2f };
+  yolov2_pp_static_param_t params = {
+    .nb_classes = YOLO_NB_CLASSES,
+    .nb_anchors = YOLOV2_ANCHORS,
+    .grid_width = YOLOV2_GRID,
+    .grid_height = YOLOV2_GRID,
+    .nb_input_boxes = YOLOV2_GRID * YOLOV2_GRID,
+    .max_boxes_limit = 10,
+    .conf_threshold = 0.6f,
+    .iou_threshold = 0.3f,
+    .pAnchors = anchors,
+  };
+  yolov2_pp_in_t pp_in = { yolo_work };
+  od_pp_out_t pp_out[2] = { { yolo_out[0], 0 }, { yolo_out[1], 0 } };
+  vision_models_pp_ctx_t ctx = { yolo_scratch, sizeof(yolo_scratch) };
+  float32_t logit;
+  double t[2] = { 0 };
+
+  od_yolov2_pp_reset(&params);
+  assert(od_yolov2_pp_get_scratch_size(&params) <= sizeof(yolo_scratch));
+  logit = params.conf_threshold_logit;
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    yolo_fill(yolo_raw, YOLOV2_LEN);
+    for (int v = 0; v < 2; v++)
+    {
+      params.conf_threshold_logit = v ? logit : -INFINITY;
+      memcpy(yolo_work, yolo_raw, YOLOV2_LEN * sizeof(float32_t));
+      double t0 = bench_now();
+      od_yolov2_pp_process(&pp_in, &pp_out[v], &params, &ctx);
+      t[v] += bench_now() - t0;
+    }
+    assert(yolo_same(&pp_out[0], &pp_out[1]));
+  }
+
+  uint32_t nb_cand = YOLOV2_GRID * YOLOV2_GRID * YOLOV2_ANCHORS * BENCH_RUNS;
+  printf("Tiny YOLOv2 %dx%dx%d: same detections\n", YOLOV2_GRID, YOLOV2_GRID, YOLOV2_ANCHORS);
+  printf("  activate all %7.1f Mcand/s  early rejection %7.1f Mcand/s  x%.2f\n",
+         nb_cand / t[0], nb_cand / t[1], t[0] / t[1]);
+}
+
+static void check_st_yolox(void)
+{
+  const float32_t anchors[2] = { 0.5f, 0.5f };
+  st_yolox_pp_static_param_t params = {
+    .nb_classes = YOLO_NB_CLASSES,
+    .nb_anchors = 1,
+    .grid_width_L = 32, .grid_height_L = 32,
+    .grid_width_M = 16, .grid_height_M = 16,
+    .grid_width_S = 8, .grid_height_S = 8,
+    .max_boxes_limit = 100,
+    .conf_threshold = 0.6f,
+    .iou_threshold = 0.5f,
+    .pAnchors_L = anchors,
+    .pAnchors_M = anchors,
+    .pAnchors_S = anchors,
+  };
+  st_yolox_pp_in_t pp_in = { yolo_work, yolo_work + YOLOX_LEN_L, yolo_work + YOLOX_LEN_L + YOLOX_LEN_M };
+  od_pp_out_t pp_out[2] = { { yolo_out[0], 0 }, { yolo_out[1], 0 } };
+  vision_models_pp_ctx_t ctx = { yolo_scratch, sizeof(yolo_scratch) };
+  float32_t logit;
+  double t[2] = { 0 };
+
+  od_st_yolox_pp_reset(&params);
+  assert(od_st_yolox_pp_get_scratch_size(&params) <= sizeof(yolo_scratch));
+  logit = params.conf_threshold_logit;
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    yolo_fill(yolo_raw, YOLOX_LEN_L + YOLOX_LEN_M + YOLOX_LEN_S);
+    for (int v = 0; v < 2; v++)
+    {
+      params.conf_threshold_logit = v ? logit : -INFINITY;
+      memcpy(yolo_work, yolo_raw, sizeof(yolo_raw));
+      double t0 = bench_now();
+      od_st_yolox_pp_process(&pp_in, &pp_out[v], &params, &ctx);
+      t[v] += bench_now() - t0;
+    }
+    assert(yolo_same(&pp_out[0], &pp_out[1]));
+  }
+
+  uint32_t nb_cand = (32 * 32 + 16 * 16 + 8 * 8) * BENCH_RUNS;
+  printf("ST YOLOX 32x32 + 16x16 + 8x8: same detections\n");
+  printf("  activate all %7.1f Mcand/s  early rejection %7.1f Mcand/s  x%.2f\n",
+         nb_cand / t[0], nb_cand / t[1], t[0] / t[1]);
+}
+
+int main(void)
+{
+  srand(1);
+  check_thresholds();
+  check_pd();
+  check_yolov2();
+  check_st_yolox();
+
+  return 0;
+}
@@ -0,0 +1,235 @@
+ /**
+ ******************************************************************************
+ * @file    pp_yolov8_int8_check.c
+ * @author  GPM Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Tensor-level bit-exactness check of the quantized YOLOv8 detection path, built on the real
+ * sources: od_yolov8_pp_process_int8, which keeps the candidates in int8 until the NMS survivors,
+ * against od_yolov8_pp_process on the dequantized tensor, which is what the int8 path did before.
+ * - 180 synthetic int8 tensors: 1, 3 and 80 classes, 400, 2100 and 8400 anchors, exhaustive and
+ *   grid NMS, 10 seeds each. Boxes are clustered around a few objects: half of the candidates
+ *   move the object box by a few quantization steps, the others keep its center with a width
+ *   of 1, 1/2 or 2/5 of the object one, so that many pairs have an IoU equal to the threshold
+ *   (0.4 or 0.5), which the float IoU of the dequantized boxes may round either way.
+ * - The outputs (count, boxes, confidences, classes, in order) must be bit-identical; the program
+ *   returns 1 when one differs. The int8 path writes to an output buffer of exactly
+ *   AI_OD_YOLOV8_PP_INT8_OUT_RECORDS records, whose size is reported with the one of the float path.
+ * - The time of both paths is reported, and the time of their NMS alone: the same candidates,
+ *   as int8 records for vision_models_nms_is8 and dequantized for vision_models_nms_f32.
+ *
+ * From application_code/STM32N6:
+ *   L=Middlewares/lib_vision_models_pp/lib_vision_models_pp
+ *   gcc -O2 -Wall -I$L/Inc -I$L/Src -ISTM32Cube_FW_N6/Drivers/CMSIS/DSP/Include \
+ *       -ISTM32Cube_FW_N6/Drivers/CMSIS/Core/Include Tools/pp_yolov8_int8_check.c $L/Src/od_pp_yolov8.c \
+ *       $L/Src/vision_models_pp.c -lm -o pp_yolov8_int8_check && ./pp_yolov8_int8_check
+ */
+#include "od_yolov8_pp_if.h"
+#include "od_pp_loc.h"
+#include "vision_models_pp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK_MAX_BOXES 8400
+#define CHECK_MAX_CLASSES 80
+#define CHECK_SEEDS 10
+#define CHECK_OBJECTS 24
+#define CHECK_SCALE (1.0f / 255.0f)
+#define CHECK_ZP (-128)
+
+static int8_t raw_s8[(4 + CHECK_MAX_CLASSES) * CHECK_MAX_BOXES];
+static float32_t raw_f[(4 + CHECK_MAX_CLASSES) * CHECK_MAX_BOXES];
+static od_pp_outBuffer_t out_f[CHECK_MAX_BOXES];
+static od_pp_scratchBuffer_s8_t nms_s8[CHECK_MAX_BOXES];
+static od_pp_outBuffer_t nms_f[CHECK_MAX_BOXES];
+
+static double check_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int8_t check_q(int32_t q)
+{
+  return (int8_t) MAX(MIN(q, SCHAR_MAX), SCHAR_MIN);
+}
+
+/* Channel-major [4 + nb_classes][nb]: the objects have a quantized box, their candidates move
+ * it by a few steps or shrink its width; about a third of the anchors are candidates of one object */
+static void check_fill(int32_t nb, int32_t nb_classes, uint32_t seed)
+{
+  int32_t objects[CHECK_OBJECTS][5];
+
+  srand(seed);
+  for (int32_t o = 0; o < CHECK_OBJECTS; o++)
+  {
+    objects[o][0] = -100 + rand() % 200;   /* x_center, y_center */
+    objects[o][1] = -100 + rand() % 200;
+    objects[o][2] = CHECK_ZP + 10 * (1 + rand() % 6);   /* width, a multiple of 10 steps, height */
+    objects[o][3] = CHECK_ZP + 10 + rand() % 50;
+    objects[o][4] = rand() % nb_classes;
+  }
+  for (int32_t i = 0; i < nb; i++)
+  {
+    int32_t o = rand() % CHECK_OBJECTS;
+    int32_t hit = (rand() % 3) == 0;
+
+    if (rand() % 2)
+    {
+      for (int32_t k = 0; k < 4; k++)
+      {
+        raw_s8[k * nb + i] = check_q(objects[o][k] + rand() % 7 - 3);
+      }
+    }
+    else
+    {
+      const int32_t num[3] = { 10, 5, 4 };
+      int32_t w = objects[o][2] - CHECK_ZP;
+
+      raw_s8[0 * nb + i] = check_q(objects[o][0]);
+      raw_s8[1 * nb + i] = check_q(objects[o][1]);
+      raw_s8[2 * nb + i] = check_q(CHECK_ZP + w * num[rand() % 3] / 10);
+      raw_s8[3 * nb + i] = check_q(objects[o][3]);
+    }
+    for (int32_t c = 0; c < nb_classes; c++)
+    {
+      raw_s8[(4 + c) * nb + i] = check_q(-128 + rand() % 40);
+    }
+    if (hit)
+    {
+      raw_s8[(4 + objects[o][4]) * nb + i] = check_q(-60 + rand() % 188);
+    }
+  }
+  for (int32_t i = 0; i < (4 + nb_classes) * nb; i++)
+  {
+    raw_f[i] = CHECK_SCALE * (float32_t) ((int32_t) raw_s8[i] - CHECK_ZP);
+  }
+}
+
+/* Candidates of the best class score, as the int8 path selects them: NMS time of both record types */
+static void check_nms(int32_t nb, const yolov8_pp_static_param_t *pParams, double *pT_s8, double *pT_f)
+{
+  int32_t nb_cand = 0;
+  double t0;
+
+  for (int32_t i = 0; i < nb; i++)
+  {
+    int32_t best = 0;
+
+    for (int32_t c = 1; c < pParams->nb_classes; c++)
+    {
+      best = (raw_s8[(4 + c) * nb + i] > raw_s8[(4 + best) * nb + i]) ? c : best;
+    }
+    if (raw_s8[(4 + best) * nb + i] < pParams->conf_threshold_s8) continue;
+    nms_s8[nb_cand].x_center = raw_s8[0 * nb + i];
+    nms_s8[nb_cand].y_center = raw_s8[1 * nb + i];
+    nms_s8[nb_cand].width = raw_s8[2 * nb + i];
+    nms_s8[nb_cand].height = raw_s8[3 * nb + i];
+    nms_s8[nb_cand].conf = raw_s8[(4 + best) * nb + i];
+    nms_s8[nb_cand].class_index = (uint8_t) best;
+    nms_f[nb_cand].x_center = raw_f[0 * nb + i];
+    nms_f[nb_cand].y_center = raw_f[1 * nb + i];
+    nms_f[nb_cand].width = raw_f[2 * nb + i];
+    nms_f[nb_cand].height = raw_f[3 * nb + i];
+    nms_f[nb_cand].conf = raw_f[(4 + best) * nb + i];
+    nms_f[nb_cand].class_index = best;
+    nb_cand++;
+  }
+
+  t0 = check_now();
+  vision_models_nms_is8(nms_s8, sizeof(od_pp_scratchBuffer_s8_t), nb_cand, pParams->iou_threshold,
+                        pParams->max_boxes_limit, pParams->raw_output_zero_point, pParams->raw_output_scale,
+                        pParams->nms_mode);
+  *pT_s8 += check_now() - t0;
+  t0 = check_now();
+  vision_models_nms_f32(nms_f, sizeof(od_pp_outBuffer_t), nb_cand, pParams->iou_threshold,
+                        pParams->max_boxes_limit, pParams->nms_mode);
+  *pT_f += check_now() - t0;
+}
+
+int main(void)
+{
+  const int32_t classes[] = { 1, 3, CHECK_MAX_CLASSES };
+  const int32_t boxes[] = { 400, 2100, CHECK_MAX_BOXES };
+  double t_s8 = 0, t_f = 0, t_nms_s8 = 0, t_nms_f = 0;
+  int32_t nb_cases = 0, nb_differ = 0;
+
+  for (int32_t c = 0; c < 3; c++)
+  {
+    for (int32_t b = 0; b < 3; b++)
+    {
+      for (int32_t mode = 0; mode < 2; mode++)
+      {
+        int32_t differ = 0, detections = 0;
+
+        for (uint32_t seed = 1; seed <= CHECK_SEEDS; seed++)
+        {
+          yolov8_pp_static_param_t params = {
+            .nb_classes = classes[c],
+            .nb_total_boxes = boxes[b],
+            .max_boxes_limit = 100,
+            .conf_threshold = 0.4f,
+            .iou_threshold = (seed & 1) ? 0.4f : 0.5f,
+            .raw_output_scale = CHECK_SCALE,
+            .raw_output_zero_point = CHECK_ZP,
+            .nms_mode = mode ? AI_VISION_MODELS_NMS_MODE_GRID : AI_VISION_MODELS_NMS_MODE_EXHAUSTIVE,
+          };
+          int32_t out_records = AI_OD_YOLOV8_PP_INT8_OUT_RECORDS(boxes[b], classes[c], params.max_boxes_limit);
+          od_pp_outBuffer_t *out_s8 = malloc(out_records * sizeof(od_pp_outBuffer_t));
+          yolov8_pp_in_centroid_int8_t in_s8 = { raw_s8 };
+          yolov8_pp_in_centroid_t in_f = { raw_f };
+          od_pp_out_t res_s8 = { out_s8, 0 };
+          od_pp_out_t res_f = { out_f, 0 };
+          double t0;
+
+          if (out_s8 == NULL) return 1;
+
+          check_fill(boxes[b], classes[c], seed);
+          od_yolov8_pp_reset(&params);
+
+          t0 = check_now();
+          if (od_yolov8_pp_process_int8(&in_s8, &res_s8, &params) != AI_OD_POSTPROCESS_ERROR_NO) return 1;
+          t_s8 += check_now() - t0;
+          t0 = check_now();
+          if (od_yolov8_pp_process(&in_f, &res_f, &params) != AI_OD_POSTPROCESS_ERROR_NO) return 1;
+          t_f += check_now() - t0;
+
+          differ += (res_s8.nb_detect != res_f.nb_detect) ||
+                    memcmp(out_s8, out_f, res_f.nb_detect * sizeof(od_pp_outBuffer_t));
+          detections += res_f.nb_detect;
+          nb_cases++;
+          free(out_s8);
+
+          check_nms(boxes[b], &params, &t_nms_s8, &t_nms_f);
+        }
+        printf("classes %2d  anchors %4d  %-10s  detections %5d  output buffer %6u / %6u bytes  %s\n",
+               (int) classes[c], (int) boxes[b], mode ? "grid" : "exhaustive", (int) detections,
+               (unsigned) (AI_OD_YOLOV8_PP_INT8_OUT_RECORDS(boxes[b], classes[c], 100) * sizeof(od_pp_outBuffer_t)),
+               (unsigned) (boxes[b] * sizeof(od_pp_outBuffer_t)), differ ? "DIFFER" : "ok");
+        nb_differ += differ;
+      }
+    }
+  }
+
+  printf("int8 path %.1f ms, dequantized float path %.1f ms\n", t_s8 / 1e3, t_f / 1e3);
+  printf("NMS alone: int8 records %.1f ms, float records %.1f ms\n", t_nms_s8 / 1e3, t_nms_f / 1e3);
+  printf("%d of %d tensors differ\n", (int) nb_differ, (int) nb_cases);
+
+  return nb_differ != 0;
+}
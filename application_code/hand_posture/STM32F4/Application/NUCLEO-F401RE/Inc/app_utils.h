@@ -23,36 +23,15 @@
 #include "stm32f4xx_hal.h"
 #include "vl53lmz_api.h"
 #include "network.h"
+#include "handposture_pipeline.h"
 
 #include <stdbool.h>
 
 /* Exported macro ------------------------------------------------------------*/
 
 /* Network-related macro ---------*/
-/* Maximum number of zones */
-#define SENSOR__MAX_NB_OF_ZONES                   (64)
 /* Max distance software limit */
 #define HANDPOSTURE_APP_MAX_DISTANCE_MM           (400)
-/* Used if the zone is not valid */
-#define DEFAULT_RANGING_VALUE                     (4000)
-/* Used if the zone is not valid */
-#define DEFAULT_SIGNAL_VALUE                      (0)
-/* Median */
-#define NORMALIZATION_RANGING_CENTER              (295)
-/* Interquartile range */
-#define NORMALIZATION_RANGING_IQR                 (196)
-/* Median */
-#define NORMALIZATION_SIGNAL_CENTER               (281)
-/* Interquartile range */
-#define NORMALIZATION_SIGNAL_IQR                  (452)
-/* Number of output class filtering */
-#define LABEL_FILTER_N                            (3)
-/* Keep last class valid until a new one is detected */
-#define KEEP_LAST_VALID                           (1)
-/* Conversion from 14.2 fixed point values to floating point */
-#define FIXED_POINT_14_2_TO_FLOAT                 (4.0)
-/* Conversion from 21.11 fixed point values to floating point */
-#define FIXED_POINT_21_11_TO_FLOAT                (2048.0)
 
 /* Communication-related macro ---*/
 /* UART buffer size */
@@ -196,24 +175,6 @@ typedef struct {
   int calibrate;
 } CommandData_t;
 
-typedef struct {
-  long timestamp_ms;
-  uint8_t target_status[SENSOR__MAX_NB_OF_ZONES];
-  uint8_t nb_targets[SENSOR__MAX_NB_OF_ZONES];
-  float ranging[SENSOR__MAX_NB_OF_ZONES];
-  float peak[SENSOR__MAX_NB_OF_ZONES]; /* Distance [mm] */
-} HANDPOSTURE_Input_Data_t;
-
-typedef struct {
-  /* Internals */
-  uint8_t is_valid_frame;
-  uint8_t previous_label;
-  uint8_t label_count;
-  /* Outputs */
-  uint8_t model_output;
-  uint8_t handposture_label;
-} HANDPOSTURE_Data_t;
-
 typedef struct
 {
   /* App context */
@@ -229,10 +190,18 @@ typedef struct
   bool params_modif;
 
   /* NN context */
-  HANDPOSTURE_Input_Data_t HANDPOSTURE_Input_Data;
   HANDPOSTURE_Data_t AI_Data;
+#if QUANTIZED_MODEL
+  int8_t aiInData[AI_NETWORK_IN_1_SIZE];
+  int8_t aiOutData[AI_NETWORK_OUT_1_SIZE];
+  /* Dequantization of the NN output */
+  float aiOutScale;
+  int32_t aiOutZeroPoint;
+#else
+  HANDPOSTURE_Input_Data_t HANDPOSTURE_Input_Data;
   float aiInData[AI_NETWORK_IN_1_SIZE];
   float aiOutData[AI_NETWORK_OUT_1_SIZE];
+#endif
 
   /* Comm context */
   volatile char Uart_RXBuffer[UART_BUFFER_SIZE];
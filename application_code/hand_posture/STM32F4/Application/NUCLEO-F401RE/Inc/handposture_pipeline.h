@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ * @file    handposture_pipeline.h
+ * @author  MCD Application Team
+ * @brief   Hand posture pre-processing and post-processing, without HAL dependency
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+#ifndef INC_HANDPOSTURE_PIPELINE_H_
+#define INC_HANDPOSTURE_PIPELINE_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "vl53lmz_api.h"
+#include "ai_model_config.h"
+
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+/* Maximum number of zones */
+#define SENSOR__MAX_NB_OF_ZONES                   (64)
+/* Used if the zone is not valid */
+#define DEFAULT_RANGING_VALUE                     (4000)
+/* Used if the zone is not valid */
+#define DEFAULT_SIGNAL_VALUE                      (0)
+/* Median */
+#define NORMALIZATION_RANGING_CENTER              (295)
+/* Interquartile range */
+#define NORMALIZATION_RANGING_IQR                 (196)
+/* Median */
+#define NORMALIZATION_SIGNAL_CENTER               (281)
+/* Interquartile range */
+#define NORMALIZATION_SIGNAL_IQR                  (452)
+/* Number of output class filtering */
+#define LABEL_FILTER_N                            (3)
+/* Keep last class valid until a new one is detected */
+#define KEEP_LAST_VALID                           (1)
+/* Conversion from 14.2 fixed point values to floating point */
+#define FIXED_POINT_14_2_TO_FLOAT                 (4.0)
+/* Conversion from 21.11 fixed point values to floating point */
+#define FIXED_POINT_21_11_TO_FLOAT                (2048.0)
+/* Model with int8 input and output: the frames are validated and quantized with integer operations only.
+   Can be set in ai_model_config.h */
+#ifndef QUANTIZED_MODEL
+#define QUANTIZED_MODEL                           (0)
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  long timestamp_ms;
+  uint8_t target_status[SENSOR__MAX_NB_OF_ZONES];
+  uint8_t nb_targets[SENSOR__MAX_NB_OF_ZONES];
+  float ranging[SENSOR__MAX_NB_OF_ZONES];
+  float peak[SENSOR__MAX_NB_OF_ZONES]; /* Distance [mm] */
+} HANDPOSTURE_Input_Data_t;
+
+typedef struct {
+  /* Internals */
+  uint8_t is_valid_frame;
+  uint8_t previous_label;
+  uint8_t label_count;
+  /* Outputs */
+  uint8_t model_output;
+  uint8_t handposture_label;
+} HANDPOSTURE_Data_t;
+
+/* Quantization of a fixed-point sensor value:
+   q = zero_point + ((raw - offset) * multiplier) >> shift, saturated to int8 */
+typedef struct {
+  int32_t offset;
+  int32_t multiplier;
+  int32_t shift;
+  int32_t zero_point;
+} HANDPOSTURE_QuantParams_t;
+
+/* Integer pipeline configuration, computed from the quantization parameters of the model */
+typedef struct {
+  HANDPOSTURE_QuantParams_t ranging;
+  HANDPOSTURE_QuantParams_t peak;
+  /* Quantized values of an invalid zone */
+  int8_t default_ranging;
+  int8_t default_peak;
+  /* Output threshold in the quantized output domain */
+  int32_t out_threshold;
+} HANDPOSTURE_Quant_t;
+
+/* Exported functions ------------------------------------------------------- */
+/* Float pipeline */
+int HandPosture_CopyInputData(HANDPOSTURE_Input_Data_t *, const VL53LMZ_ResultsData *, long);
+int HandPosture_ValidateFrame(HANDPOSTURE_Data_t *, HANDPOSTURE_Input_Data_t *);
+int HandPosture_NormalizeData(float *, const HANDPOSTURE_Input_Data_t *);
+int HandPosture_OutputSelection(const float *, uint32_t, HANDPOSTURE_Data_t *);
+/* Integer pipeline */
+int HandPosture_QuantInit(HANDPOSTURE_Quant_t *, float, int32_t, float, int32_t);
+int HandPosture_ValidateAndQuantizeFrame(const HANDPOSTURE_Quant_t *, HANDPOSTURE_Data_t *,
+                                         const VL53LMZ_ResultsData *, int8_t *);
+int HandPosture_OutputSelectionInt8(const HANDPOSTURE_Quant_t *, const int8_t *, uint32_t, HANDPOSTURE_Data_t *);
+
+#endif /* INC_HANDPOSTURE_PIPELINE_H_ */
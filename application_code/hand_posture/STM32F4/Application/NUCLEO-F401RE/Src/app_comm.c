@@ -335,7 +335,11 @@ static void Comm_PrintTerm(AppConfig_TypeDef *App_Config)
 		printf("Class #%d {%s} : %f                                           \r\n",
 				i,
 				classes_table[i],
+#if QUANTIZED_MODEL
+				App_Config->aiOutScale * (App_Config->aiOutData[i] - App_Config->aiOutZeroPoint));
+#else
 				App_Config->aiOutData[i]);
+#endif
 	}
 
 }
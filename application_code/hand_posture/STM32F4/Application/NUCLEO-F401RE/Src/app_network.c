@@ -26,12 +26,6 @@
 /* Global variables ----------------------------------------------------------*/
 extern AppConfig_TypeDef App_Config;
 
-/* Private macro -------------------------------------------------------------*/
-#define RANGING_OK_5                              (5U)
-#define RANGING_OK_9                              (9U)
-
-#define THRESHOLD_NN_OUTPUT                       (0.9)
-
 /* Private variables ---------------------------------------------------------*/
 /* Declare AI variables */
 static float pool0[AI_NETWORK_DATA_ACTIVATION_1_SIZE];
@@ -50,77 +44,18 @@ static ai_buffer* ai_output;
 #else
   static float* data_outs[AI_NETWORK_OUT_NUM] = {NULL};
 #endif
+#if QUANTIZED_MODEL
+/* Integer pre-processing and post-processing configuration */
+static HANDPOSTURE_Quant_t quant;
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
-/* Post processing functions */
-static int argmax(const float *, uint32_t, float);
-static int label_filter(int, HANDPOSTURE_Data_t *);
 /* AI functions */
 static int AI_Init(void);
-static int AI_Run(float *pIn, float *pOut);
-static int AI_CopyInputData(HANDPOSTURE_Input_Data_t *HANDPOSTURE_Input_Data, VL53LMZ_ResultsData *pRangingData);
-/* Frame validation */
-static int ValidateFrame(HANDPOSTURE_Data_t *AI_Data, HANDPOSTURE_Input_Data_t *Input_AI_Data);
-/* Data normalization */
-static int NormalizeData(float *normalized_data, HANDPOSTURE_Input_Data_t *Input_AI_Data);
-/* Output post-processing */
-static int output_selection(const float * data, uint32_t len, HANDPOSTURE_Data_t *AI_Data);
+static int AI_Run(void *pIn, void *pOut);
 
 /* Private function definitions ----------------------------------------------*/
 
-/**
- * @brief  Get the index of the maximum value in a vector if it is higher than a threshold
- * @param  values Vector
- * @param  len Length of the vector
- * @param  threshold Threshold to be exceeded by the maximum value
- * @retval Index of the maximum value, or 0 if the highest value is lower than the threshold
- */
-static int argmax(const float *values, uint32_t len, float threshold)
-{
-  float max_value = values[0];
-  uint32_t max_index = 0;
-  for (uint32_t i = 1; i < len; i++)
-  {
-    if (values[i] > max_value && values[i] > threshold)
-    {
-      max_value = values[i];
-      max_index = i;
-    }
-  }
-  return(max_index);
-}
-
-/**
- * @brief  Filter the NN output to avoid the classifier output to toggle
- * @param  current_label Index of the label from the argmax function
- * @param  AI_Data Data structure to save the result
- * @retval 0
- */
-static int label_filter(int current_label, HANDPOSTURE_Data_t *AI_Data)
-{
-  if (current_label == AI_Data->previous_label)
-  {
-    if (AI_Data->label_count < LABEL_FILTER_N)
-      AI_Data->label_count++;
-    else if (AI_Data->label_count == LABEL_FILTER_N)
-      AI_Data->handposture_label = current_label;
-    else
-      AI_Data->label_count = 0;
-  }
-  else
-  {
-    AI_Data->label_count = 0;
-#if KEEP_LAST_VALID == 0
-    /* This line to reset the valid Posture if a different posture is detected,
-    by removing this line, we save the previous valid posture until a new valid one is detected */
-    AI_Data->handposture_label = 0;
-#endif
-  }
-
-  AI_Data->previous_label = current_label;
-  return(0);
-}
-
 /**
  * @brief  AI Model init function
  * @param  None
@@ -166,6 +101,34 @@ static int AI_Init(void)
   }
 #endif
 
+#if QUANTIZED_MODEL
+  {
+    ai_buffer_format fmt_in = AI_BUFFER_FORMAT(&ai_input[0]);
+    ai_buffer_format fmt_out = AI_BUFFER_FORMAT(&ai_output[0]);
+    float in_scale, out_scale;
+    int32_t in_zero_point, out_zero_point;
+
+    /* The model input and output must be signed 8-bit quantized tensors */
+    if (AI_BUFFER_FMT_GET_TYPE(fmt_in) != AI_BUFFER_FMT_TYPE_Q || !AI_BUFFER_FMT_GET_SIGN(fmt_in)
+        || AI_BUFFER_FMT_GET_BITS(fmt_in) != 8 || AI_BUFFER_FMT_GET_TYPE(fmt_out) != AI_BUFFER_FMT_TYPE_Q
+        || !AI_BUFFER_FMT_GET_SIGN(fmt_out) || AI_BUFFER_FMT_GET_BITS(fmt_out) != 8)
+    {
+      return(-1);
+    }
+
+    in_scale = AI_BUFFER_META_INFO_INTQ_GET_SCALE(ai_input[0].meta_info, 0);
+    in_zero_point = AI_BUFFER_META_INFO_INTQ_GET_ZEROPOINT(ai_input[0].meta_info, 0);
+    out_scale = AI_BUFFER_META_INFO_INTQ_GET_SCALE(ai_output[0].meta_info, 0);
+    out_zero_point = AI_BUFFER_META_INFO_INTQ_GET_ZEROPOINT(ai_output[0].meta_info, 0);
+    if (HandPosture_QuantInit(&quant, in_scale, in_zero_point, out_scale, out_zero_point) < 0)
+    {
+      return(-1);
+    }
+    App_Config.aiOutScale = out_scale;
+    App_Config.aiOutZeroPoint = out_zero_point;
+  }
+#endif
+
   return(0);
 }
 
@@ -175,7 +138,7 @@ static int AI_Init(void)
  * @param  pOut Pointer to output data
  * @retval 0 if succeeded, 1 if failed
  */
-static int AI_Run(float *pIn, float *pOut)
+static int AI_Run(void *pIn, void *pOut)
 {
   ai_i32 batch;
   ai_input[0].data = AI_HANDLE_PTR(pIn);
@@ -184,127 +147,6 @@ static int AI_Run(float *pIn, float *pOut)
   return(batch<=0);
 }
 
-/**
- * @brief  Format data from L5 driver to Gesture algorithm
- * @param  HANDPOSTURE_Input_Data Pointer to destination
- * @param  pRangingData Pointer to source
- * @retval 0
- */
-static int AI_CopyInputData(HANDPOSTURE_Input_Data_t *HANDPOSTURE_Input_Data, VL53LMZ_ResultsData *pRangingData)
-{
-  int idx;
-
-  HANDPOSTURE_Input_Data->timestamp_ms = (int32_t) HAL_GetTick();
-  for (int i = 0; i < SENSOR__MAX_NB_OF_ZONES; i++)
-  {
-    /* Use SENSOR_ROTATION_180 macro to rotate the data */
-    #if SENSOR_ROTATION_180
-      idx = SENSOR__MAX_NB_OF_ZONES - i;
-    #else
-      idx = i;
-    #endif
-    HANDPOSTURE_Input_Data->ranging[idx] = pRangingData->distance_mm[idx]/FIXED_POINT_14_2_TO_FLOAT; /* Signed 14.2 */
-    HANDPOSTURE_Input_Data->peak[idx] = pRangingData->signal_per_spad[idx]/FIXED_POINT_21_11_TO_FLOAT; /* Unsigned 21.11 */
-    HANDPOSTURE_Input_Data->target_status[idx] = pRangingData->target_status[idx];
-    HANDPOSTURE_Input_Data->nb_targets[idx] = pRangingData->nb_target_detected[idx];
-  }
-
-  return(0);
-}
-
-/**
- * @brief  Is it a valid frame ?
- * @param  AI_Data Pointer save the result of the frame validation
- * @param  Input_AI_Data Pointer to frame data structure
- * @retval 0
- */
-static int ValidateFrame(HANDPOSTURE_Data_t *AI_Data, HANDPOSTURE_Input_Data_t *Input_AI_Data)
-{
-  bool valid;
-  int idx;
-  float min = 4000.0;
-
-  /* Find minimum valid distance */
-  for (idx = 0; idx < SENSOR__MAX_NB_OF_ZONES; idx++){
-    if ((Input_AI_Data->nb_targets[idx] > 0)
-      && (Input_AI_Data->target_status[idx] == RANGING_OK_5 || Input_AI_Data->target_status[idx] == RANGING_OK_9)
-      && Input_AI_Data->ranging[idx] < min)
-    {
-      min = Input_AI_Data->ranging[idx];
-    }
-  }
-
-  if (min < MAX_DISTANCE && min > MIN_DISTANCE)
-    AI_Data->is_valid_frame = 1;
-  else
-    AI_Data->is_valid_frame = 0;
-
-  for (idx = 0; idx <SENSOR__MAX_NB_OF_ZONES; idx++)
-  {
-    /* Check if the data is valid */
-    valid = (Input_AI_Data->nb_targets[idx] > 0)
-        && (Input_AI_Data->target_status[idx] == RANGING_OK_5 || Input_AI_Data->target_status[idx] == RANGING_OK_9)
-        && (Input_AI_Data->ranging[idx] < min + BACKGROUND_REMOVAL);
-
-    /* If not valid, load default value */
-    if (!valid)
-    {
-      Input_AI_Data->ranging[idx] = DEFAULT_RANGING_VALUE;
-      Input_AI_Data->peak[idx] = DEFAULT_SIGNAL_VALUE;
-    }
-  }
-  return(0);
-}
-
-/**
- * @brief  Normalize the data
- * @param  normalized_data Destination of the normalized data
- * @param  Input_AI_Data Source of the data to normalize
- * @retval 0
- */
-static int NormalizeData(float *normalized_data, HANDPOSTURE_Input_Data_t *Input_AI_Data)
-{
-  int idx;
-  for (idx = 0; idx <SENSOR__MAX_NB_OF_ZONES; idx++)
-  {
-    /* Signed 14.2 */
-    normalized_data[2*idx] = (Input_AI_Data->ranging[idx] - NORMALIZATION_RANGING_CENTER) / NORMALIZATION_RANGING_IQR;
-    /* Unsigned 21.11 */
-    normalized_data[2*idx + 1] = (Input_AI_Data->peak[idx] - NORMALIZATION_SIGNAL_CENTER) / NORMALIZATION_SIGNAL_IQR;
-  }
-
-  return(0);
-}
-
-/**
- * @brief  Get the output class from the NN output vector
- * @param  data NN output vector
- * @param  len Length of the NN output vector
- * @param  AI_Data AI data to update
- * @retval 0
- */
-static int output_selection(const float *data, uint32_t len, HANDPOSTURE_Data_t *AI_Data)
-{
-  int current_label = 0;
-
-  /* If the frame is valid, get the chosen label out of the NN output */
-  if (AI_Data->is_valid_frame)
-  {
-    /* In this example we are using an ArgMax function, but another function can be developed */
-    current_label = argmax(data, len, THRESHOLD_NN_OUTPUT);
-  }
-  /* If the frame is not valid, set the output label as 0 */
-  else
-  {
-    current_label = 0;
-  }
-
-  /* Filtering */
-  label_filter(current_label, AI_Data);
-
-  return(0);
-}
-
 /* Public function definitions -----------------------------------------------*/
 
 /**
@@ -333,17 +175,27 @@ void Network_Preprocess(AppConfig_TypeDef *App_Config)
   /* If a new data need to be pre-processed */
   if (App_Config->new_data_received)
   {
+#if QUANTIZED_MODEL
+    /* Validate the ranging data and write the quantized NN input in the same pass */
+    if (HandPosture_ValidateAndQuantizeFrame(&quant, &(App_Config->AI_Data), &(App_Config->RangingData),
+                                             App_Config->aiInData) < 0)
+    {
+      printf("HandPosture_ValidateAndQuantizeFrame failed\n");
+      Error_Handler();
+    }
+#else
     /* Copy the ranging data into the NN input buffer */
-    if (AI_CopyInputData(&(App_Config->HANDPOSTURE_Input_Data), &(App_Config->RangingData)) < 0)
+    if (HandPosture_CopyInputData(&(App_Config->HANDPOSTURE_Input_Data), &(App_Config->RangingData),
+                                  (int32_t) HAL_GetTick()) < 0)
     {
-      printf("AI_CopyInputData failed\n");
+      printf("HandPosture_CopyInputData failed\n");
       Error_Handler();
     }
 
     /* Validate NN input data */
-    if (ValidateFrame(&(App_Config->AI_Data), &(App_Config->HANDPOSTURE_Input_Data)) < 0)
+    if (HandPosture_ValidateFrame(&(App_Config->AI_Data), &(App_Config->HANDPOSTURE_Input_Data)) < 0)
     {
-      printf("ValidateFrame failed\n");
+      printf("HandPosture_ValidateFrame failed\n");
       Error_Handler();
     }
 
@@ -351,12 +203,13 @@ void Network_Preprocess(AppConfig_TypeDef *App_Config)
     if (App_Config->AI_Data.is_valid_frame)
     {
       /* Normalize NN input data */
-      if (NormalizeData(App_Config->aiInData, &(App_Config->HANDPOSTURE_Input_Data)) < 0)
+      if (HandPosture_NormalizeData(App_Config->aiInData, &(App_Config->HANDPOSTURE_Input_Data)) < 0)
       {
-        printf("NormalizeData failed\n");
+        printf("HandPosture_NormalizeData failed\n");
         Error_Handler();
       }
     }
+#endif
   }
 
 }
@@ -380,7 +233,11 @@ void Network_Inference(AppConfig_TypeDef *App_Config)
   }
   else
   {
+#if QUANTIZED_MODEL
+	  for (int i = 0; i<AI_NETWORK_OUT_1_SIZE; i++) App_Config->aiOutData[i] = (int8_t) App_Config->aiOutZeroPoint;
+#else
 	  for (int i = 0; i<AI_NETWORK_OUT_1_SIZE; i++) App_Config->aiOutData[i] = 0;
+#endif
   }
 
 }
@@ -396,7 +253,12 @@ void Network_Postprocess(AppConfig_TypeDef *App_Config)
   if (App_Config->new_data_received)
   {
     /* Get class from the NN output vector */
-    if (output_selection(App_Config->aiOutData, AI_NETWORK_OUT_1_SIZE, &(App_Config->AI_Data)) < 0)
+#if QUANTIZED_MODEL
+    if (HandPosture_OutputSelectionInt8(&quant, App_Config->aiOutData, AI_NETWORK_OUT_1_SIZE,
+                                        &(App_Config->AI_Data)) < 0)
+#else
+    if (HandPosture_OutputSelection(App_Config->aiOutData, AI_NETWORK_OUT_1_SIZE, &(App_Config->AI_Data)) < 0)
+#endif
     {
       printf("AI_Run failed\n");
       Error_Handler();
@@ -0,0 +1,424 @@
+/**
+ ******************************************************************************
+ * @file    handposture_pipeline.c
+ * @author  MCD Application Team
+ * @brief   Hand posture pre-processing and post-processing, without HAL dependency
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "handposture_pipeline.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+/* Private macro -------------------------------------------------------------*/
+#define RANGING_OK_5                              (5U)
+#define RANGING_OK_9                              (9U)
+
+#define THRESHOLD_NN_OUTPUT                       (0.9)
+
+/* Value of 1 in the fixed-point formats of the ranging data */
+#define FIXED_POINT_14_2_ONE                      (4)
+#define FIXED_POINT_21_11_ONE                     (2048)
+/* Minimum distance search initial value */
+#define RANGING_MIN_INIT                          (4000)
+
+/* Private function prototypes -----------------------------------------------*/
+static int argmax(const float *, uint32_t, float);
+static int argmax_int8(const int8_t *, uint32_t, int32_t);
+static int label_filter(int, HANDPOSTURE_Data_t *);
+static int QuantParamsInit(HANDPOSTURE_QuantParams_t *, int32_t, int32_t, int32_t, float, int32_t);
+static int8_t Quantize(const HANDPOSTURE_QuantParams_t *, int32_t);
+
+/* Private function definitions ----------------------------------------------*/
+
+/**
+ * @brief  Get the index of the maximum value in a vector if it is higher than a threshold
+ * @param  values Vector
+ * @param  len Length of the vector
+ * @param  threshold Threshold to be exceeded by the maximum value
+ * @retval Index of the maximum value, or 0 if the highest value is lower than the threshold
+ */
+static int argmax(const float *values, uint32_t len, float threshold)
+{
+  float max_value = values[0];
+  uint32_t max_index = 0;
+  for (uint32_t i = 1; i < len; i++)
+  {
+    if (values[i] > max_value && values[i] > threshold)
+    {
+      max_value = values[i];
+      max_index = i;
+    }
+  }
+  return(max_index);
+}
+
+/**
+ * @brief  Get the index of the maximum value in a quantized vector if it is higher than a threshold
+ * @param  values Quantized vector
+ * @param  len Length of the vector
+ * @param  threshold Quantized threshold to be exceeded by the maximum value
+ * @retval Index of the maximum value, or 0 if the highest value is lower than the threshold
+ */
+static int argmax_int8(const int8_t *values, uint32_t len, int32_t threshold)
+{
+  int32_t max_value = values[0];
+  uint32_t max_index = 0;
+  for (uint32_t i = 1; i < len; i++)
+  {
+    if (values[i] > max_value && values[i] > threshold)
+    {
+      max_value = values[i];
+      max_index = i;
+    }
+  }
+  return(max_index);
+}
+
+/**
+ * @brief  Filter the NN output to avoid the classifier output to toggle
+ * @param  current_label Index of the label from the argmax function
+ * @param  AI_Data Data structure to save the result
+ * @retval 0
+ */
+static int label_filter(int current_label, HANDPOSTURE_Data_t *AI_Data)
+{
+  if (current_label == AI_Data->previous_label)
+  {
+    if (AI_Data->label_count < LABEL_FILTER_N)
+      AI_Data->label_count++;
+    else if (AI_Data->label_count == LABEL_FILTER_N)
+      AI_Data->handposture_label = current_label;
+    else
+      AI_Data->label_count = 0;
+  }
+  else
+  {
+    AI_Data->label_count = 0;
+#if KEEP_LAST_VALID == 0
+    /* This line to reset the valid Posture if a different posture is detected,
+    by removing this line, we save the previous valid posture until a new valid one is detected */
+    AI_Data->handposture_label = 0;
+#endif
+  }
+
+  AI_Data->previous_label = current_label;
+  return(0);
+}
+
+/**
+ * @brief  Compute the integer quantization of a normalized fixed-point sensor value
+ * @param  quant Quantization parameters to compute
+ * @param  fixed_point_one Value of 1 in the fixed-point format of the sensor value
+ * @param  center Normalization center
+ * @param  iqr Normalization interquartile range
+ * @param  in_scale Scale of the quantized NN input
+ * @param  in_zero_point Zero point of the quantized NN input
+ * @retval 0 if succeeded, -1 if the scale cannot be represented
+ */
+static int QuantParamsInit(HANDPOSTURE_QuantParams_t *quant, int32_t fixed_point_one, int32_t center, int32_t iqr,
+                           float in_scale, int32_t in_zero_point)
+{
+  int exponent;
+  float mantissa;
+
+  /* q - zero_point = (raw / one - center) / iqr / in_scale = (raw - center * one) * real */
+  mantissa = frexpf(1.0f / ((float) fixed_point_one * iqr * in_scale), &exponent);
+  if (!(mantissa > 0.0f) || (31 - exponent) < 1 || (31 - exponent) > 62)
+  {
+    return(-1);
+  }
+
+  /* real = multiplier * 2^-shift, the multiplier in [2^30, 2^31) keeps the 24 bits of the float mantissa */
+  quant->offset = center * fixed_point_one;
+  quant->multiplier = (int32_t) ldexpf(mantissa, 31);
+  quant->shift = 31 - exponent;
+  quant->zero_point = in_zero_point;
+
+  return(0);
+}
+
+/**
+ * @brief  Quantize a fixed-point sensor value
+ * @param  quant Quantization parameters
+ * @param  raw Fixed-point sensor value
+ * @retval Quantized normalized value
+ */
+static inline int8_t Quantize(const HANDPOSTURE_QuantParams_t *quant, int32_t raw)
+{
+  int64_t acc = (int64_t) (raw - quant->offset) * quant->multiplier;
+
+  /* Rounded to nearest */
+  acc = ((acc + ((int64_t) 1 << (quant->shift - 1))) >> quant->shift) + quant->zero_point;
+  if (acc > INT8_MAX)
+    acc = INT8_MAX;
+  else if (acc < INT8_MIN)
+    acc = INT8_MIN;
+
+  return((int8_t) acc);
+}
+
+/* Public function definitions -----------------------------------------------*/
+
+/**
+ * @brief  Format data from L5 driver to Gesture algorithm
+ * @param  HANDPOSTURE_Input_Data Pointer to destination
+ * @param  pRangingData Pointer to source
+ * @param  timestamp_ms Timestamp of the frame
+ * @retval 0
+ */
+int HandPosture_CopyInputData(HANDPOSTURE_Input_Data_t *HANDPOSTURE_Input_Data, const VL53LMZ_ResultsData *pRangingData,
+                              long timestamp_ms)
+{
+  int idx;
+
+  HANDPOSTURE_Input_Data->timestamp_ms = timestamp_ms;
+  for (int i = 0; i < SENSOR__MAX_NB_OF_ZONES; i++)
+  {
+    /* Use SENSOR_ROTATION_180 macro to rotate the data */
+    #if SENSOR_ROTATION_180
+      idx = SENSOR__MAX_NB_OF_ZONES - 1 - i;
+    #else
+      idx = i;
+    #endif
+    HANDPOSTURE_Input_Data->ranging[i] = pRangingData->distance_mm[idx]/FIXED_POINT_14_2_TO_FLOAT; /* Signed 14.2 */
+    HANDPOSTURE_Input_Data->peak[i] = pRangingData->signal_per_spad[idx]/FIXED_POINT_21_11_TO_FLOAT; /* Unsigned 21.11 */
+    HANDPOSTURE_Input_Data->target_status[i] = pRangingData->target_status[idx];
+    HANDPOSTURE_Input_Data->nb_targets[i] = pRangingData->nb_target_detected[idx];
+  }
+
+  return(0);
+}
+
+/**
+ * @brief  Is it a valid frame ?
+ * @param  AI_Data Pointer save the result of the frame validation
+ * @param  Input_AI_Data Pointer to frame data structure
+ * @retval 0
+ */
+int HandPosture_ValidateFrame(HANDPOSTURE_Data_t *AI_Data, HANDPOSTURE_Input_Data_t *Input_AI_Data)
+{
+  bool valid;
+  int idx;
+  float min = RANGING_MIN_INIT;
+
+  /* Find minimum valid distance */
+  for (idx = 0; idx < SENSOR__MAX_NB_OF_ZONES; idx++){
+    if ((Input_AI_Data->nb_targets[idx] > 0)
+      && (Input_AI_Data->target_status[idx] == RANGING_OK_5 || Input_AI_Data->target_status[idx] == RANGING_OK_9)
+      && Input_AI_Data->ranging[idx] < min)
+    {
+      min = Input_AI_Data->ranging[idx];
+    }
+  }
+
+  if (min < MAX_DISTANCE && min > MIN_DISTANCE)
+    AI_Data->is_valid_frame = 1;
+  else
+    AI_Data->is_valid_frame = 0;
+
+  for (idx = 0; idx <SENSOR__MAX_NB_OF_ZONES; idx++)
+  {
+    /* Check if the data is valid */
+    valid = (Input_AI_Data->nb_targets[idx] > 0)
+        && (Input_AI_Data->target_status[idx] == RANGING_OK_5 || Input_AI_Data->target_status[idx] == RANGING_OK_9)
+        && (Input_AI_Data->ranging[idx] < min + BACKGROUND_REMOVAL);
+
+    /* If not valid, load default value */
+    if (!valid)
+    {
+      Input_AI_Data->ranging[idx] = DEFAULT_RANGING_VALUE;
+      Input_AI_Data->peak[idx] = DEFAULT_SIGNAL_VALUE;
+    }
+  }
+  return(0);
+}
+
+/**
+ * @brief  Normalize the data
+ * @param  normalized_data Destination of the normalized data
+ * @param  Input_AI_Data Source of the data to normalize
+ * @retval 0
+ */
+int HandPosture_NormalizeData(float *normalized_data, const HANDPOSTURE_Input_Data_t *Input_AI_Data)
+{
+  int idx;
+  for (idx = 0; idx <SENSOR__MAX_NB_OF_ZONES; idx++)
+  {
+    /* Signed 14.2 */
+    normalized_data[2*idx] = (Input_AI_Data->ranging[idx] - NORMALIZATION_RANGING_CENTER) / NORMALIZATION_RANGING_IQR;
+    /* Unsigned 21.11 */
+    normalized_data[2*idx + 1] = (Input_AI_Data->peak[idx] - NORMALIZATION_SIGNAL_CENTER) / NORMALIZATION_SIGNAL_IQR;
+  }
+
+  return(0);
+}
+
+/**
+ * @brief  Get the output class from the NN output vector
+ * @param  data NN output vector
+ * @param  len Length of the NN output vector
+ * @param  AI_Data AI data to update
+ * @retval 0
+ */
+int HandPosture_OutputSelection(const float *data, uint32_t len, HANDPOSTURE_Data_t *AI_Data)
+{
+  int current_label = 0;
+
+  /* If the frame is valid, get the chosen label out of the NN output */
+  if (AI_Data->is_valid_frame)
+  {
+    /* In this example we are using an ArgMax function, but another function can be developed */
+    current_label = argmax(data, len, THRESHOLD_NN_OUTPUT);
+  }
+  /* If the frame is not valid, set the output label as 0 */
+  else
+  {
+    current_label = 0;
+  }
+
+  /* Filtering */
+  label_filter(current_label, AI_Data);
+
+  return(0);
+}
+
+/**
+ * @brief  Compute the integer pipeline configuration
+ * @param  quant Configuration to compute
+ * @param  in_scale Scale of the int8 NN input
+ * @param  in_zero_point Zero point of the int8 NN input
+ * @param  out_scale Scale of the int8 NN output
+ * @param  out_zero_point Zero point of the int8 NN output
+ * @retval 0 if succeeded, -1 if a scale is not supported
+ */
+int HandPosture_QuantInit(HANDPOSTURE_Quant_t *quant, float in_scale, int32_t in_zero_point, float out_scale,
+                          int32_t out_zero_point)
+{
+  if (QuantParamsInit(&quant->ranging, FIXED_POINT_14_2_ONE, NORMALIZATION_RANGING_CENTER, NORMALIZATION_RANGING_IQR,
+                      in_scale, in_zero_point) < 0
+      || QuantParamsInit(&quant->peak, FIXED_POINT_21_11_ONE, NORMALIZATION_SIGNAL_CENTER, NORMALIZATION_SIGNAL_IQR,
+                         in_scale, in_zero_point) < 0
+      || !(out_scale > 0.0f))
+  {
+    return(-1);
+  }
+  quant->default_ranging = Quantize(&quant->ranging, DEFAULT_RANGING_VALUE * FIXED_POINT_14_2_ONE);
+  quant->default_peak = Quantize(&quant->peak, DEFAULT_SIGNAL_VALUE * FIXED_POINT_21_11_ONE);
+
+  /* value > THRESHOLD_NN_OUTPUT <=> q > zero_point + THRESHOLD_NN_OUTPUT / scale */
+  quant->out_threshold = (int32_t) floorf(out_zero_point + (float) THRESHOLD_NN_OUTPUT / out_scale);
+  if (quant->out_threshold > INT8_MAX)
+  {
+    quant->out_threshold = INT8_MAX;
+  }
+
+  return(0);
+}
+
+/**
+ * @brief  Validate the frame and write the quantized NN input directly from the sensor fixed-point data
+ * @param  quant Integer pipeline configuration
+ * @param  AI_Data Pointer save the result of the frame validation
+ * @param  pRangingData Pointer to source
+ * @param  pInData Pointer to the quantized NN input
+ * @retval 0
+ */
+int HandPosture_ValidateAndQuantizeFrame(const HANDPOSTURE_Quant_t *quant, HANDPOSTURE_Data_t *AI_Data,
+                                         const VL53LMZ_ResultsData *pRangingData, int8_t *pInData)
+{
+  uint64_t valid_zones = 0;
+  int32_t min = RANGING_MIN_INIT * FIXED_POINT_14_2_ONE;
+  int32_t limit;
+  int idx, zone;
+
+  /* Find the zones with a valid target and the minimum valid distance, in 14.2 */
+  for (idx = 0; idx < SENSOR__MAX_NB_OF_ZONES; idx++)
+  {
+    if ((pRangingData->nb_target_detected[idx] > 0)
+      && (pRangingData->target_status[idx] == RANGING_OK_5 || pRangingData->target_status[idx] == RANGING_OK_9))
+    {
+      valid_zones |= (uint64_t) 1 << idx;
+      if (pRangingData->distance_mm[idx] < min)
+      {
+        min = pRangingData->distance_mm[idx];
+      }
+    }
+  }
+
+  if (min < MAX_DISTANCE * FIXED_POINT_14_2_ONE && min > MIN_DISTANCE * FIXED_POINT_14_2_ONE)
+    AI_Data->is_valid_frame = 1;
+  else
+    AI_Data->is_valid_frame = 0;
+
+  /* The NN input is only needed for a valid frame */
+  if (!AI_Data->is_valid_frame)
+  {
+    return(0);
+  }
+
+  limit = min + BACKGROUND_REMOVAL * FIXED_POINT_14_2_ONE;
+  for (idx = 0; idx < SENSOR__MAX_NB_OF_ZONES; idx++)
+  {
+    /* Use SENSOR_ROTATION_180 macro to rotate the data */
+    #if SENSOR_ROTATION_180
+      zone = SENSOR__MAX_NB_OF_ZONES - 1 - idx;
+    #else
+      zone = idx;
+    #endif
+
+    /* Background removal: zones without valid target or too far behind the closest one get the default values */
+    if (((valid_zones >> zone) & 1U) && pRangingData->distance_mm[zone] < limit)
+    {
+      /* Signed 14.2 */
+      pInData[2*idx] = Quantize(&quant->ranging, pRangingData->distance_mm[zone]);
+      /* Unsigned 21.11, the values above INT32_MAX saturate the quantized input anyway */
+      pInData[2*idx + 1] = Quantize(&quant->peak, (pRangingData->signal_per_spad[zone] > INT32_MAX)
+                                    ? INT32_MAX : (int32_t) pRangingData->signal_per_spad[zone]);
+    }
+    else
+    {
+      pInData[2*idx] = quant->default_ranging;
+      pInData[2*idx + 1] = quant->default_peak;
+    }
+  }
+
+  return(0);
+}
+
+/**
+ * @brief  Get the output class from the quantized NN output vector
+ * @param  quant Integer pipeline configuration
+ * @param  data Quantized NN output vector
+ * @param  len Length of the NN output vector
+ * @param  AI_Data AI data to update
+ * @retval 0
+ */
+int HandPosture_OutputSelectionInt8(const HANDPOSTURE_Quant_t *quant, const int8_t *data, uint32_t len,
+                                    HANDPOSTURE_Data_t *AI_Data)
+{
+  int current_label = 0;
+
+  /* If the frame is valid, get the chosen label out of the NN output */
+  if (AI_Data->is_valid_frame)
+  {
+    current_label = argmax_int8(data, len, quant->out_threshold);
+  }
+
+  /* Filtering */
+  label_filter(current_label, AI_Data);
+
+  return(0);
+}
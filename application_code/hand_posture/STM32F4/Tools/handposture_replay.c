@@ -0,0 +1,426 @@
+/**
+ ******************************************************************************
+ * @file    handposture_replay.c
+ * @author  MCD Application Team
+ * @brief   Host replay of recorded ToF frames through the hand posture pipeline
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Feeds recorded VL53LMZ frames through the float and the int8 pipelines of handposture_pipeline.c, with a mock
+ * network in place of the X-CUBE-AI model (a fixed pseudo-random dense layer and a softmax, float or int8).
+ * - The recording is the "RAN,..." CSV output of Comm_PrintEvk (gesture_gui mode); the distances and the signal
+ *   rates are printed in mm and kcps/spad, they are converted back to the 14.2 and 21.11 formats of the driver.
+ * - For each stage the host latency per frame is given; it only gives the trend, the target cycles must be
+ *   measured on the board.
+ * - The label stability: label changes before and after the label filter, shortest and mean duration of a
+ *   filtered label.
+ * - The int8 pipeline must give the same frame validity as the float one, and its inputs must be within one step
+ *   of the quantized float inputs, otherwise the program returns 1.
+ * Usage:
+ *   handposture_replay [-v] [file.csv]   replay a recording (stdin by default), -v prints the labels of each frame
+ *   handposture_replay -g frames         write a synthetic recording of a hand moving over a background
+ *
+ * Built with Tools/Makefile: make -C Tools && Tools/build/handposture_replay -g 2000 | Tools/build/handposture_replay
+ */
+#include "handposture_pipeline.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_NB_OUT          (NB_CLASSES)
+#define REPLAY_NB_IN           (2 * SENSOR__MAX_NB_OF_ZONES)
+#define REPLAY_LINE_SIZE       (4096)
+/* Comm_PrintEvk layout: 51 global fields, then 6 fields per zone */
+#define REPLAY_CSV_ZONE_FIELD  (51)
+#define REPLAY_CSV_NB_FIELDS   (REPLAY_CSV_ZONE_FIELD + 6 * SENSOR__MAX_NB_OF_ZONES)
+
+/* Quantization of the mock int8 network */
+#define REPLAY_IN_SCALE        (0.08f)
+#define REPLAY_IN_ZERO_POINT   (-109)
+#define REPLAY_OUT_SCALE       (1.0f / 256.0f)
+#define REPLAY_OUT_ZERO_POINT  (-128)
+
+enum
+{
+  STAGE_COPY,
+  STAGE_VALIDATE,
+  STAGE_NORMALIZE,
+  STAGE_NETWORK,
+  STAGE_OUTPUT,
+  STAGE_Q_VALIDATE,
+  STAGE_Q_NETWORK,
+  STAGE_Q_OUTPUT,
+  STAGE_NB
+};
+
+static const char *stage_names[STAGE_NB] = {
+  "float  copy input", "float  validate frame", "float  normalize", "float  mock network", "float  output selection",
+  "int8   validate+quantize", "int8   mock network", "int8   output selection"
+};
+
+typedef struct
+{
+  uint32_t nb_frames;
+  uint32_t nb_valid;
+  uint32_t raw_changes;
+  uint32_t label_changes;
+  uint32_t run_length;
+  uint32_t min_run;
+  uint32_t nb_runs;
+  uint32_t histogram[NB_CLASSES];
+  uint8_t last_raw;
+  uint8_t last_label;
+} replay_stats_t;
+
+static float mock_weights[REPLAY_NB_OUT][REPLAY_NB_IN];
+static double stage_ns[STAGE_NB];
+
+static double replay_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void mock_init(void)
+{
+  uint32_t state = 1U;
+
+  for (int c = 0; c < REPLAY_NB_OUT; c++)
+  {
+    for (int i = 0; i < REPLAY_NB_IN; i++)
+    {
+      state = state * 1664525U + 1013904223U;
+      mock_weights[c][i] = ((int32_t)(state >> 16) - 32768) / 16384.0f;
+    }
+  }
+}
+
+static void mock_softmax(const float *in, float *out)
+{
+  float max = -INFINITY, sum = 0.0f;
+
+  for (int c = 0; c < REPLAY_NB_OUT; c++)
+  {
+    out[c] = 0.0f;
+    for (int i = 0; i < REPLAY_NB_IN; i++)
+    {
+      out[c] += mock_weights[c][i] * in[i];
+    }
+    max = (out[c] > max) ? out[c] : max;
+  }
+  for (int c = 0; c < REPLAY_NB_OUT; c++)
+  {
+    out[c] = expf(out[c] - max);
+    sum += out[c];
+  }
+  for (int c = 0; c < REPLAY_NB_OUT; c++)
+  {
+    out[c] /= sum;
+  }
+}
+
+static void mock_network_int8(const int8_t *in, int8_t *out)
+{
+  float in_f[REPLAY_NB_IN], out_f[REPLAY_NB_OUT];
+
+  for (int i = 0; i < REPLAY_NB_IN; i++)
+  {
+    in_f[i] = REPLAY_IN_SCALE * (in[i] - REPLAY_IN_ZERO_POINT);
+  }
+  mock_softmax(in_f, out_f);
+  for (int c = 0; c < REPLAY_NB_OUT; c++)
+  {
+    long q = lroundf(out_f[c] / REPLAY_OUT_SCALE) + REPLAY_OUT_ZERO_POINT;
+    out[c] = (int8_t)((q > INT8_MAX) ? INT8_MAX : q);
+  }
+}
+
+static int8_t quantize_ref(float value)
+{
+  long q = lroundf(value / REPLAY_IN_SCALE) + REPLAY_IN_ZERO_POINT;
+
+  return (int8_t)((q > INT8_MAX) ? INT8_MAX : (q < INT8_MIN) ? INT8_MIN : q);
+}
+
+/* One "RAN,..." line of Comm_PrintEvk, returns 0 if it is a frame */
+static int parse_frame(char *line, VL53LMZ_ResultsData *frame)
+{
+  char *fields[REPLAY_CSV_NB_FIELDS];
+  int nb = 0;
+
+  if (strncmp(line, "RAN,", 4) != 0)
+  {
+    return -1;
+  }
+  for (char *p = line; nb < REPLAY_CSV_NB_FIELDS; nb++)
+  {
+    fields[nb] = p;
+    p = strchr(p, ',');
+    if (p == NULL)
+    {
+      nb++;
+      break;
+    }
+    *p++ = '\0';
+  }
+  if (nb < REPLAY_CSV_NB_FIELDS)
+  {
+    return -1;
+  }
+
+  memset(frame, 0, sizeof(*frame));
+  for (int z = 0; z < SENSOR__MAX_NB_OF_ZONES; z++)
+  {
+    char **f = &fields[REPLAY_CSV_ZONE_FIELD + 6 * z];
+    double signal = atof(f[3]);
+
+    frame->target_status[z] = (uint8_t)atoi(f[0]);
+    frame->nb_target_detected[z] = (uint8_t)atoi(f[1]);
+    frame->distance_mm[z] = (int16_t)lround(atof(f[2]) * FIXED_POINT_14_2_TO_FLOAT);
+    frame->signal_per_spad[z] = (signal > 0.0) ? (uint32_t)llround(signal * FIXED_POINT_21_11_TO_FLOAT) : 0U;
+  }
+
+  return 0;
+}
+
+/* Same layout as Comm_PrintEvk */
+static void print_frame(uint32_t frame_count, const VL53LMZ_ResultsData *frame)
+{
+  printf("RAN,%5ld,%3d,%10ld,,,,,,,%4d,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,", (long)frame_count, 0,
+         (long)(frame_count * 100), 0);
+  for (int z = 0; z < SENSOR__MAX_NB_OF_ZONES; z++)
+  {
+    printf(",%2d,%2d,%4.0f,%6.0f,%1d,%1d", frame->target_status[z], frame->nb_target_detected[z],
+           frame->distance_mm[z] / FIXED_POINT_14_2_TO_FLOAT, frame->signal_per_spad[z] / FIXED_POINT_21_11_TO_FLOAT,
+           0, 1);
+  }
+  printf("\n");
+}
+
+/* A hand comes over a background at 1 to 2 m, stays a while at 15 to 35 cm with one of three shapes, then goes */
+static void generate(uint32_t nb_frames)
+{
+  VL53LMZ_ResultsData frame;
+  uint32_t state = 12345U;
+
+  memset(&frame, 0, sizeof(frame));
+  for (uint32_t n = 0; n < nb_frames; n++)
+  {
+    uint32_t phase = n % 120U;
+    int hand = (phase >= 20U) && (phase < 100U);
+    int shape = (n / 120U) % 3;
+    int dist_hand = 180 + (int)((phase * 7U) % 120U);
+    int cx = 3 + (int)((n / 40U) % 2U), cy = 3 + (int)((n / 60U) % 2U);
+
+    for (int z = 0; z < SENSOR__MAX_NB_OF_ZONES; z++)
+    {
+      int x = z % 8, y = z / 8, dx = x - cx, dy = y - cy;
+      int in_hand = hand && ((shape == 0) ? (dx * dx + dy * dy <= 5)
+                             : (shape == 1) ? (abs(dx) <= 1 && dy >= -3 && dy <= 2)
+                             : (abs(dx) <= 2 && abs(dy) <= 1));
+      double dist, signal;
+
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      dist = in_hand ? dist_hand + 4 * (dx * dx + dy * dy) + (int)(state % 15U) : 1000 + (int)(state % 1000U);
+      signal = in_hand ? 800 + (int)((state >> 10) % 2000U) : 20 + (int)((state >> 10) % 100U);
+      frame.nb_target_detected[z] = ((state >> 20) % 25U) ? 1 : 0;
+      frame.target_status[z] = ((state >> 24) % 20U) ? (((state >> 28) & 1U) ? 5 : 9) : 255;
+      frame.distance_mm[z] = (int16_t)(dist * FIXED_POINT_14_2_TO_FLOAT);
+      frame.signal_per_spad[z] = (uint32_t)(signal * FIXED_POINT_21_11_TO_FLOAT);
+    }
+    print_frame(n, &frame);
+  }
+}
+
+static void stats_update(replay_stats_t *s, const HANDPOSTURE_Data_t *d)
+{
+  s->nb_valid += d->is_valid_frame;
+  s->histogram[d->handposture_label]++;
+  if (s->nb_frames > 0)
+  {
+    s->raw_changes += (d->previous_label != s->last_raw);
+    if (d->handposture_label != s->last_label)
+    {
+      s->label_changes++;
+      s->min_run = (s->nb_runs == 0 || s->run_length < s->min_run) ? s->run_length : s->min_run;
+      s->nb_runs++;
+      s->run_length = 0;
+    }
+  }
+  s->run_length++;
+  s->last_raw = d->previous_label;
+  s->last_label = d->handposture_label;
+  s->nb_frames++;
+}
+
+static void stats_print(const char *name, const replay_stats_t *s)
+{
+  printf("%-5s valid %5.1f%% | label changes per 100 frames: raw %5.1f filtered %5.1f | filtered label duration: "
+         "min %u mean %.1f frames\n",
+         name, 100.0 * s->nb_valid / s->nb_frames, 100.0 * s->raw_changes / s->nb_frames,
+         100.0 * s->label_changes / s->nb_frames, (s->nb_runs > 0) ? s->min_run : s->nb_frames,
+         (double)s->nb_frames / (s->nb_runs + 1));
+  printf("      labels:");
+  for (int c = 0; c < NB_CLASSES; c++)
+  {
+    printf(" %u", s->histogram[c]);
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  static char line[REPLAY_LINE_SIZE];
+  VL53LMZ_ResultsData frame;
+  HANDPOSTURE_Input_Data_t input;
+  HANDPOSTURE_Data_t data_f = { 0 }, data_q = { 0 };
+  HANDPOSTURE_Quant_t quant;
+  replay_stats_t stats_f = { 0 }, stats_q = { 0 };
+  float in_f[REPLAY_NB_IN], out_f[REPLAY_NB_OUT];
+  int8_t in_q[REPLAY_NB_IN], out_q[REPLAY_NB_OUT];
+  uint32_t nb_validity_diff = 0, nb_input_diff = 0, nb_label_diff = 0, max_input_diff = 0;
+  int verbose = 0, argi = 1;
+  FILE *in = stdin;
+  double t0, t_frame = 0.0, t_overhead;
+
+  if (argc > 2 && strcmp(argv[1], "-g") == 0)
+  {
+    generate((uint32_t)strtoul(argv[2], NULL, 0));
+    return 0;
+  }
+  if (argi < argc && strcmp(argv[argi], "-v") == 0)
+  {
+    verbose = 1;
+    argi++;
+  }
+  if (argi < argc && (in = fopen(argv[argi], "r")) == NULL)
+  {
+    perror(argv[argi]);
+    return 1;
+  }
+
+  mock_init();
+  if (HandPosture_QuantInit(&quant, REPLAY_IN_SCALE, REPLAY_IN_ZERO_POINT, REPLAY_OUT_SCALE,
+                            REPLAY_OUT_ZERO_POINT) < 0)
+  {
+    printf("HandPosture_QuantInit failed\n");
+    return 1;
+  }
+
+  /* Cost of the time measurement, removed from each stage */
+  t0 = replay_now();
+  for (int i = 0; i < 1000; i++)
+  {
+    (void)replay_now();
+  }
+  t_overhead = (replay_now() - t0) / 1000.0;
+
+#define TIMED(stage, call)                                    \
+  do                                                          \
+  {                                                           \
+    double t_ = replay_now();                                 \
+    call;                                                     \
+    stage_ns[stage] += replay_now() - t_ - t_overhead;        \
+  } while (0)
+
+  while (fgets(line, sizeof(line), in) != NULL)
+  {
+    if (parse_frame(line, &frame) != 0)
+    {
+      continue;
+    }
+    t0 = replay_now();
+
+    /* Float pipeline, as Network_Preprocess, Network_Inference and Network_Postprocess */
+    TIMED(STAGE_COPY, HandPosture_CopyInputData(&input, &frame, (long)stats_f.nb_frames));
+    TIMED(STAGE_VALIDATE, HandPosture_ValidateFrame(&data_f, &input));
+    if (data_f.is_valid_frame)
+    {
+      TIMED(STAGE_NORMALIZE, HandPosture_NormalizeData(in_f, &input));
+      TIMED(STAGE_NETWORK, mock_softmax(in_f, out_f));
+    }
+    TIMED(STAGE_OUTPUT, HandPosture_OutputSelection(out_f, REPLAY_NB_OUT, &data_f));
+
+    /* Int8 pipeline */
+    TIMED(STAGE_Q_VALIDATE, HandPosture_ValidateAndQuantizeFrame(&quant, &data_q, &frame, in_q));
+    if (data_q.is_valid_frame)
+    {
+      TIMED(STAGE_Q_NETWORK, mock_network_int8(in_q, out_q));
+    }
+    TIMED(STAGE_Q_OUTPUT, HandPosture_OutputSelectionInt8(&quant, out_q, REPLAY_NB_OUT, &data_q));
+
+    t_frame += replay_now() - t0;
+
+    /* The int8 input must be the float input quantized, within one step */
+    nb_validity_diff += (data_f.is_valid_frame != data_q.is_valid_frame);
+    if (data_f.is_valid_frame && data_q.is_valid_frame)
+    {
+      for (int i = 0; i < REPLAY_NB_IN; i++)
+      {
+        uint32_t diff = (uint32_t)abs(quantize_ref(in_f[i]) - in_q[i]);
+        nb_input_diff += (diff != 0U);
+        max_input_diff = (diff > max_input_diff) ? diff : max_input_diff;
+      }
+    }
+    nb_label_diff += (data_f.handposture_label != data_q.handposture_label);
+
+    if (verbose)
+    {
+      printf("%u,%d,%d,%d,%d,%d\n", stats_f.nb_frames, data_f.is_valid_frame, data_f.previous_label,
+             data_f.handposture_label, data_q.previous_label, data_q.handposture_label);
+    }
+    stats_update(&stats_f, &data_f);
+    stats_update(&stats_q, &data_q);
+  }
+  if (in != stdin)
+  {
+    fclose(in);
+  }
+  if (stats_f.nb_frames == 0)
+  {
+    printf("no frame\n");
+    return 1;
+  }
+
+  printf("%u frames, %u valid\n", stats_f.nb_frames, stats_f.nb_valid);
+  printf("host latency per frame (ns, the validated stages per valid frame):\n");
+  for (int s = 0; s < STAGE_NB; s++)
+  {
+    uint32_t n = (s == STAGE_NORMALIZE || s == STAGE_NETWORK) ? stats_f.nb_valid
+                 : (s == STAGE_Q_NETWORK) ? stats_q.nb_valid : stats_f.nb_frames;
+    printf("  %-26s %8.1f\n", stage_names[s], (n > 0) ? stage_ns[s] / n : 0.0);
+  }
+  printf("  pre-processing float %.1f int8 %.1f, whole frame %.1f\n",
+         (stage_ns[STAGE_COPY] + stage_ns[STAGE_VALIDATE] + stage_ns[STAGE_NORMALIZE]) / stats_f.nb_frames,
+         stage_ns[STAGE_Q_VALIDATE] / stats_f.nb_frames, t_frame / stats_f.nb_frames);
+  stats_print("float", &stats_f);
+  stats_print("int8", &stats_q);
+  printf("int8 vs float: validity differs %u, inputs differ %u (max %u step), filtered label differs %u frames\n",
+         nb_validity_diff, nb_input_diff, max_input_diff, nb_label_diff);
+
+  if (nb_validity_diff != 0U || max_input_diff > 1U)
+  {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+
+  return 0;
+}
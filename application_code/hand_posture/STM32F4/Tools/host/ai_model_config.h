@@ -0,0 +1,42 @@
+/**
+ ******************************************************************************
+ * @file    ai_model_config.h
+ * @author  MCD Application Team
+ * @brief   Model configuration for the host build of the hand posture pipeline
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Same values as the file generated by the deploy.py script for the default model.
+ * Use MODEL_CONFIG_DIR=<dir> with make to build with another generated file. */
+#ifndef __AI_MODEL_CONFIG_H__
+#define __AI_MODEL_CONFIG_H__
+
+#define NB_CLASSES          (8)
+
+#define INPUT_HEIGHT        (8)
+#define INPUT_WIDTH         (8)
+#define INPUT_CHANNELS      (2)
+
+#define CLASSES_TABLE const char* classes_table[NB_CLASSES] = {\
+   "None" ,   "FlatHand" ,   "Like" ,   "Love" ,   "Dislike" ,   "BreakTime" ,\
+   "CrossHands" ,   "Fist"};\
+
+#define EVK_LABEL_TABLE const int evk_label_table[NB_CLASSES] = {\
+   0 ,   20 ,   21 ,   24 ,   25 ,   27 ,\
+   28 ,   32};\
+
+#define BACKGROUND_REMOVAL (120)
+#define MAX_DISTANCE (350)
+#define MIN_DISTANCE (150)
+
+#endif      /* __AI_MODEL_CONFIG_H__ */
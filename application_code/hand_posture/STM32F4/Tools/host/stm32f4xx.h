@@ -0,0 +1,2 @@
+/* Host build: the VL53LMZ platform header includes the device header, nothing of it is used by the hand posture
+ * pipeline */
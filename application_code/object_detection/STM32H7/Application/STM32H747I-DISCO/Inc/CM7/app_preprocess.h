@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file    app_preprocess.h
+ * @author  MCD Application Team
+ * @brief   Header for app_preprocess.c module
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __APP_PREPROCESS_H
+#define __APP_PREPROCESS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ai_model_config.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Resampling method of the camera frame to the NN input resolution */
+#define PP_RESIZE_NEAREST   (1)
+#define PP_RESIZE_BILINEAR  (2)
+
+#ifndef PP_RESIZE_MODE
+#define PP_RESIZE_MODE    PP_RESIZE_NEAREST
+#endif
+
+/* Normalisation of float32 NN inputs: value = PP_FLOAT_SCALE * pixel + PP_FLOAT_OFFSET */
+#ifndef PP_FLOAT_SCALE
+#define PP_FLOAT_SCALE    (1.0f / 255.0f)
+#endif
+#ifndef PP_FLOAT_OFFSET
+#define PP_FLOAT_OFFSET   (0.0f)
+#endif
+
+#define PREPROC_OK      (0)
+#define PREPROC_ERROR   (-1)
+
+/* Size in bytes of the line buffer needed for a NN input width:
+ * two horizontally resampled source rows (bilinear) and one output row (float32 input) */
+#define PREPROC_LINE_BUFFER_SIZE(dst_width) \
+  ((dst_width) * 3 * (2 * sizeof(uint16_t) + sizeof(uint8_t)))
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t src_width;         /* RGB565 source frame */
+  uint32_t src_height;
+  uint32_t dst_width;         /* NN input tensor */
+  uint32_t dst_height;
+  uint32_t color_mode;        /* RGB_FORMAT, BGR_FORMAT or GRAYSCALE_FORMAT */
+  uint32_t input_type;        /* UINT8_FORMAT, INT8_FORMAT or FLOAT32_FORMAT */
+  uint32_t resize_mode;       /* PP_RESIZE_NEAREST or PP_RESIZE_BILINEAR */
+  float float_scale;          /* FLOAT32_FORMAT: value = float_scale * pixel + float_offset */
+  float float_offset;
+  uint8_t *line_buffer;       /* PREPROC_LINE_BUFFER_SIZE(dst_width) bytes, ideally in internal SRAM */
+} Preproc_Config_TypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+int32_t Preproc_Run(const Preproc_Config_TypeDef *cfg, const uint16_t *src, void *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__APP_PREPROCESS_H */
@@ -138,11 +138,6 @@
     #define CAM_FRAME_BUFFER_SIZE (CAM_RES_WIDTH * CAM_RES_HEIGHT * RGB_565_BPP + 32 - (CAM_RES_WIDTH * CAM_RES_HEIGHT * RGB_565_BPP)%32)
   #endif
 #endif
-#if (AI_NETWORK_WIDTH * AI_NETWORK_HEIGHT * RGB_565_BPP)%32 == 0
-  #define RESCALED_FRAME_BUFFER_SIZE (AI_NETWORK_WIDTH * AI_NETWORK_HEIGHT * RGB_565_BPP)
-#else
-  #define RESCALED_FRAME_BUFFER_SIZE (AI_NETWORK_WIDTH * AI_NETWORK_HEIGHT * RGB_565_BPP + 32 - (AI_NETWORK_WIDTH * AI_NETWORK_HEIGHT * RGB_565_BPP)%32)
-#endif
 #if AI_NET_INPUT_SIZE_BYTES%32 == 0
   #define AI_INPUT_BUFFER_SIZE AI_NET_INPUT_SIZE_BYTES
 #else
@@ -155,17 +150,6 @@
 #endif
 #define AI_ACTIVATION_BUFFER_SIZE AI_ACTIVATION_SIZE_BYTES
 
-/*******************/
-/****PFC defines****/
-/*******************/
-/*The Pixel Format Conversion method:
-* 1: HW_PFC : PFC performed by mean of HW engine like DMA2D
-* 2: SW_PFC : PFC is performed by mean of SW routine and LUT
-*/
-#define HW_PFC 1
-#define SW_PFC 2
-
-
 typedef enum 
 {
   FRAME_CAPTURE    = 0x00,
@@ -205,10 +189,6 @@ typedef struct
   uint32_t mirror_flip;
   uint32_t cropping_enable;
   
-  /**Pre-Processing context**/
-  uint32_t red_blue_swap;
-  uint32_t PixelFormatConv;
- 
   /**Display context**/
   volatile uint32_t lcd_sync;
   
@@ -242,7 +222,6 @@ typedef struct
   void* nn_output_buffer[AI_NETWORK_OUT_NUM];
   void* nn_input_buffer;
   void** activation_buffer;
-  uint8_t* rescaled_image_buffer;
   uint8_t* camera_capture_buffer;
   uint8_t* camera_capture_buffer_no_borders;
   uint8_t *lcd_frame_read_buff;
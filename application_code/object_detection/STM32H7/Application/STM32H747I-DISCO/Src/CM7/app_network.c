@@ -19,6 +19,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "app_network.h"
 #include "app_utility.h"
+#include "app_preprocess.h"
 #include "layers.h"
 #include <stdio.h>
 #include <string.h>
@@ -28,95 +29,51 @@
 /* Private defines -----------------------------------------------------------*/
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+/* Line buffer of the fused preprocessing, in internal SRAM */
+__attribute__ ((aligned (32)))
+static uint8_t Preproc_Line_Buffer[PREPROC_LINE_BUFFER_SIZE(AI_NETWORK_WIDTH)];
+
 /* Global variables ----------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
-static void ImageResize(image_t *, image_t *);
-static void PixelFormatConversion(AppConfig_TypeDef *, image_t *, image_t *);
-static void Pixel_RB_Swap(void *, void *, uint32_t );
-static void PixelValueConversion(AppConfig_TypeDef *, void *);
 static void Output_Dequantize(AppConfig_TypeDef* );
 
 
 /* Functions Definition ------------------------------------------------------*/
-/**
- * @brief Run preprocessing stages on captured frame
- * @param App_Config_Ptr pointer to application context
- */
 /**
  * @brief Run preprocessing stages on captured frame
  * @param App_Config_Ptr pointer to application context
  */
 void Network_Preprocess(AppConfig_TypeDef *App_Config_Ptr)
 { 
-  image_t src_img;
-  image_t dst_img;
+  Preproc_Config_TypeDef preproc_cfg;
   
   App_Config_Ptr->Tfps_start =Utility_GetTimeStamp();
 
-  src_img.data=App_Config_Ptr->camera_capture_buffer;
 #if ASPECT_RATIO_MODE == ASPECT_RATIO_PADDING
-  src_img.w=CAM_RES_WITH_BORDERS;
-  src_img.h=CAM_RES_WITH_BORDERS;
-#else
-  src_img.w=CAM_RES_WIDTH;
-  src_img.h=CAM_RES_HEIGHT;
-#endif
-  src_img.bpp=IMAGE_BPP_RGB565;
-  dst_img.data=App_Config_Ptr->rescaled_image_buffer;
-  dst_img.w=AI_NETWORK_WIDTH;
-  dst_img.h=AI_NETWORK_HEIGHT;
-  dst_img.bpp=IMAGE_BPP_RGB565;
-  
-  /**********************/
-  /****Image resizing****/
-  /**********************/
-  ImageResize(&src_img, &dst_img);
-  
-  if(App_Config_Ptr->PixelFormatConv == HW_PFC)
-    /******************************************************************************************/
-    /****Coherency purpose: clean the source buffer area in L1 D-Cache before DMA2D reading****/
-    /******************************************************************************************/
-    Utility_DCache_Coherency_Maintenance((void *)(App_Config_Ptr->rescaled_image_buffer), RESCALED_FRAME_BUFFER_SIZE, CLEAN);
-  
-
-  src_img.data=App_Config_Ptr->rescaled_image_buffer;
-  src_img.w=AI_NETWORK_WIDTH;
-  src_img.h=AI_NETWORK_HEIGHT;
-  src_img.bpp=IMAGE_BPP_RGB565;
-  dst_img.data=App_Config_Ptr->nn_input_buffer;
-  dst_img.w=AI_NETWORK_WIDTH;
-  dst_img.h=AI_NETWORK_HEIGHT;
-
-#if PP_COLOR_MODE == RGB_FORMAT
-  dst_img.bpp = IMAGE_BPP_RGB888;
-#elif PP_COLOR_MODE == BGR_FORMAT
-  dst_img.bpp = IMAGE_BPP_RGB888;
-#elif PP_COLOR_MODE == GRAYSCALE_FORMAT
-  dst_img.bpp = IMAGE_BPP_GRAYSCALE;
+  preproc_cfg.src_width=CAM_RES_WITH_BORDERS;
+  preproc_cfg.src_height=CAM_RES_WITH_BORDERS;
 #else
- #error Color format no supported
+  preproc_cfg.src_width=CAM_RES_WIDTH;
+  preproc_cfg.src_height=CAM_RES_HEIGHT;
 #endif
-  
-  /*************************************/
-  /****Image Pixel Format Conversion****/
-  /*************************************/
-  PixelFormatConversion(App_Config_Ptr, &src_img, &dst_img);
-  
-  if(App_Config_Ptr->PixelFormatConv == HW_PFC)
+  preproc_cfg.dst_width=AI_NETWORK_WIDTH;
+  preproc_cfg.dst_height=AI_NETWORK_HEIGHT;
+  preproc_cfg.color_mode=PP_COLOR_MODE;
+  preproc_cfg.input_type=App_Config_Ptr->nn_input_type;
+  preproc_cfg.resize_mode=PP_RESIZE_MODE;
+  preproc_cfg.float_scale=PP_FLOAT_SCALE;
+  preproc_cfg.float_offset=PP_FLOAT_OFFSET;
+  preproc_cfg.line_buffer=Preproc_Line_Buffer;
+
+  /******************************************************************/
+  /****Resize, pixel format and value conversion in a single pass****/
+  /******************************************************************/
+  if (Preproc_Run(&preproc_cfg, (const uint16_t *) App_Config_Ptr->camera_capture_buffer,
+                  App_Config_Ptr->nn_input_buffer) != PREPROC_OK)
   {
-    /**************************************************************************************/
-    /****Coherency purpose: invalidate the source area in L1 D-Cache before CPU reading****/
-    /**************************************************************************************/
-    Utility_DCache_Coherency_Maintenance((void *)(App_Config_Ptr->activation_buffer[AI_NETWORK_INPUTS_IN_ACTIVATIONS_INDEX]),
-										AI_NETWORK_INPUTS_IN_ACTIVATIONS_SIZE + 32 - (AI_NETWORK_INPUTS_IN_ACTIVATIONS_SIZE%32),
-									   INVALIDATE);
+    while (1);
   }
-  
-  /***********************************************************/
-  /*********Pixel value convertion and normalisation**********/
-  /***********************************************************/
-  PixelValueConversion(App_Config_Ptr, (void*)(App_Config_Ptr->nn_input_buffer));
 }
 
 
@@ -277,159 +234,3 @@ static void Output_Dequantize(AppConfig_TypeDef *App_Config_Ptr)
     }  
   }
 }
-
-/**
- * @brief Performs image (or selected Region Of Interest) resizing
- * @param src Pointer to source image
- * @param dst Pointer to destination image
- */
-static void ImageResize(image_t *src, image_t *dst)
-{
-  if (STM32Ipl_Downscale(src, dst, 0) != stm32ipl_err_Ok)
-  {
-    while (1);
-  }
-}
-
-/**
- * @brief Performs a pixel format conversion either by HW or SW
- * @param App_Config_Ptr Pointer to application context
- * @param src Pointer to source image
- * @param dst Pointer to destination image
- */
-static void PixelFormatConversion(AppConfig_TypeDef *App_Config_Ptr, image_t *src, image_t *dst)
-{
-  image_t *src_img = src;
-  image_t *dst_img = dst;
-  uint32_t rb_swap = App_Config_Ptr->red_blue_swap;
-  
-  switch (App_Config_Ptr->PixelFormatConv)
-  {
-  case HW_PFC: /* Use DMA2D to perform pixel format convertion from RGB565 to RGB888 */
-    
-    if((src_img->bpp == IMAGE_BPP_RGB565) && (dst_img->bpp == IMAGE_BPP_RGB888))
-    {
-      /* DMA2D transfer with PFC */
-      Utility_Dma2d_Memcpy((uint32_t *)(src_img->data),
-                         (uint32_t *)(dst_img->data),
-                         0,
-                         0,
-                         src_img->w,
-                         src_img->h,
-                         dst_img->w,
-                         DMA2D_INPUT_RGB565,
-                         DMA2D_OUTPUT_RGB888,
-                         1,
-                         rb_swap);
-    }
-    else if((src_img->bpp == IMAGE_BPP_RGB888) && (dst_img->bpp == IMAGE_BPP_BGR888))
-    {
-      /* DMA2D transfer with PFC */
-      Utility_Dma2d_Memcpy((uint32_t *)(src_img->data),
-                         (uint32_t *)(dst_img->data),
-                         0,
-                         0,
-                         src_img->w,
-                         src_img->h,
-                         dst_img->w,
-                         DMA2D_INPUT_RGB888,
-                         DMA2D_OUTPUT_RGB888,
-                         1,
-                         rb_swap);
-    }
-    else
-    {
-      while (1);
-    }
-    
-    break;
-    
-  case SW_PFC: /* Use SW routine to perform pixel format convertion from RGB565 to grayscale */
-   
-    if (rb_swap != 0)
-    {
-      uint32_t nb_pixels = dst_img->w * dst_img->h;
-      Pixel_RB_Swap(src_img->data, dst_img->data, nb_pixels);
-    }
-    
-    if (STM32Ipl_ConvertRev(src_img, dst_img, 0) != stm32ipl_err_Ok)
-    {
-      while (1);
-    }
-    break;
-    
-    
-  default:
-    while(1);
-    break;
-  }
-}
-
-/**
- * @brief  Performs pixel R & B swapping
- * @param  pSrc            Pointer to source buffer
- * @param  pDst            Pointer to destination buffer
- * @param  pixels          Number of pixels
- */
-static void Pixel_RB_Swap(void *pSrc, void *pDst, uint32_t pixels)
-{
-  struct rgb_Src
-  {
-    uint8_t r, g, b;
-  };
-  
-  struct rgb_Dst
-  {
-    uint8_t r, g, b;
-  };
-  
-  uint8_t tmp_r;
-  
-  struct rgb_Src *pivot = (struct rgb_Src *) pSrc;
-  struct rgb_Dst *dest = (struct rgb_Dst *) pDst;
-  
-  for (int i = pixels-1; i >= 0; i--)
-  {
-    tmp_r=pivot[i].r;
-    
-    dest[i].r = pivot[i].b;
-    dest[i].b = tmp_r;
-    dest[i].g = pivot[i].g;
-  }
-}
-
-/**
-* @brief  Performs pixel conversion in format expected by NN input
-* @param  App_Config_Ptr Pointer to the application context
-* @param  pSrc           Pointer to source buffer
-* @retval None
-*/
-void PixelValueConversion(AppConfig_TypeDef *App_Config_Ptr, void *pSrc)
-{
-  /**Check data format expected by the model input and perform the right conversion**/
-  if(App_Config_Ptr->nn_input_type == UINT8_FORMAT)
-  {
-	  /*Nothing to do*/
-  }
-  else if(App_Config_Ptr->nn_input_type == INT8_FORMAT)
-  {
-	/*Conversion format from uint8 to int8*/
-	const uint32_t nb_pixels = AI_NETWORK_WIDTH * AI_NETWORK_HEIGHT * AI_NETWORK_CHANNEL;
-	uint8_t *source = (uint8_t *)pSrc;
-	uint8_t unsigned_input_value;
-	int8_t *destination = (int8_t *) App_Config_Ptr->nn_input_buffer;
-	int8_t signed_input_value;
-
-
-	for (int32_t i = 0; i < nb_pixels; i++)
-	{
-		unsigned_input_value= (uint8_t)source[i];
-		signed_input_value= ((int16_t)unsigned_input_value)-128;
-		destination[i]= signed_input_value;
-	}
-  }
-  else
-  {
-	  while(1);
-  }
-}
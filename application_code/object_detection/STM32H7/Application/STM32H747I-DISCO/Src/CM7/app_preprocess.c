@@ -0,0 +1,274 @@
+/**
+ ******************************************************************************
+ * @file    app_preprocess.c
+ * @author  MCD Application Team
+ * @brief   Fused NN input preprocessing
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_preprocess.h"
+#include <stddef.h>
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
+#define PREPROC_ROW_NONE (-1)
+
+/* Private macros ------------------------------------------------------------*/
+/* RGB565 to 8-bit channels, MSBs replicated into the LSBs as the DMA2D and STM32IPL do */
+#define PREPROC_RGB565_TO_R8(p) ((((p) >> 8) & 0xF8) | (((p) >> 13) & 0x07))
+#define PREPROC_RGB565_TO_G8(p) ((((p) >> 3) & 0xFC) | (((p) >> 9) & 0x03))
+#define PREPROC_RGB565_TO_B8(p) ((((p) << 3) & 0xF8) | (((p) >> 2) & 0x07))
+
+/* Same luma as STM32IPL COLOR_RGB888_TO_Y */
+#define PREPROC_RGB888_TO_Y(r8, g8, b8) ((((r8) * 38) + ((g8) * 75) + ((b8) * 15)) >> 7)
+
+/* Private variables ---------------------------------------------------------*/
+/* Global variables ----------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static inline void Preproc_ExpandPixel(uint16_t pixel, uint32_t color_mode, uint8_t *pOut);
+static void Preproc_NearestRow(const uint16_t *pSrcRow, uint32_t dst_width, uint32_t w_ratio,
+                               uint32_t color_mode, uint32_t channels, uint8_t xor_mask, uint8_t *pOut);
+static void Preproc_BilinearFillRow(const uint16_t *pSrcRow, const Preproc_Config_TypeDef *cfg,
+                                    uint32_t channels, int32_t x_start, int32_t x_step, uint16_t *pLine);
+static int32_t Preproc_BilinearCoord(int32_t start, int32_t step, uint32_t i, uint32_t size,
+                                     uint32_t *i0, uint32_t *i1);
+
+/* Functions Definition ------------------------------------------------------*/
+/**
+ * @brief Converts an RGB565 frame to the NN input tensor in a single pass: resampling to the
+ *        NN resolution, channel order (PP_COLOR_MODE) and value format (nn_input_type).
+ *        The frame is processed row by row, the NN input is written once.
+ *        PP_RESIZE_NEAREST gives the same tensor as the former STM32Ipl_Downscale, DMA2D or
+ *        STM32Ipl_ConvertRev, and uint8 to int8 chain (checked by Tools/preproc_check.c).
+ * @param cfg Preprocessing configuration
+ * @param src RGB565 source frame
+ * @param dst NN input tensor (uint8, int8 or float32 according to cfg->input_type)
+ * @retval PREPROC_OK on success, PREPROC_ERROR on invalid configuration
+ */
+int32_t Preproc_Run(const Preproc_Config_TypeDef *cfg, const uint16_t *src, void *dst)
+{
+  uint32_t channels;
+  uint32_t row_len;
+  uint8_t xor_mask;
+  int is_float;
+
+  if ((cfg == NULL) || (src == NULL) || (dst == NULL))
+    return PREPROC_ERROR;
+
+  if ((cfg->src_width < 1) || (cfg->src_height < 1) || (cfg->dst_width < 1) || (cfg->dst_height < 1))
+    return PREPROC_ERROR;
+
+  if ((cfg->color_mode == RGB_FORMAT) || (cfg->color_mode == BGR_FORMAT))
+    channels = 3;
+  else if (cfg->color_mode == GRAYSCALE_FORMAT)
+    channels = 1;
+  else
+    return PREPROC_ERROR;
+
+  if ((cfg->input_type != UINT8_FORMAT) && (cfg->input_type != INT8_FORMAT) && (cfg->input_type != FLOAT32_FORMAT))
+    return PREPROC_ERROR;
+
+  if ((cfg->resize_mode != PP_RESIZE_NEAREST) && (cfg->resize_mode != PP_RESIZE_BILINEAR))
+    return PREPROC_ERROR;
+
+  is_float = (cfg->input_type == FLOAT32_FORMAT);
+  if ((is_float || (cfg->resize_mode == PP_RESIZE_BILINEAR)) && (cfg->line_buffer == NULL))
+    return PREPROC_ERROR;
+
+  row_len = cfg->dst_width * channels;
+  /* int8 input: pixel - 128 is a flip of the sign bit */
+  xor_mask = (cfg->input_type == INT8_FORMAT) ? 0x80 : 0x00;
+
+  /* Line buffer: 2 resampled source rows, then the output row for float32 inputs */
+  uint16_t *pLine[2] = { (uint16_t *) cfg->line_buffer, (uint16_t *) cfg->line_buffer + row_len };
+  int32_t line_row[2] = { PREPROC_ROW_NONE, PREPROC_ROW_NONE };
+  uint8_t *pFloatRow = cfg->line_buffer + 2 * row_len * sizeof(uint16_t);
+
+  /* Nearest: same 16.16 ratios as STM32Ipl_Downscale */
+  uint32_t w_ratio = ((cfg->src_width << 16) / cfg->dst_width) + 1;
+  uint32_t h_ratio = ((cfg->src_height << 16) / cfg->dst_height) + 1;
+
+  /* Bilinear: pixel centers aligned, 16.16 source coordinates */
+  int32_t x_step = (int32_t) ((cfg->src_width << 16) / cfg->dst_width);
+  int32_t y_step = (int32_t) ((cfg->src_height << 16) / cfg->dst_height);
+  int32_t x_start = x_step / 2 - 0x8000;
+  int32_t y_start = y_step / 2 - 0x8000;
+
+  for (uint32_t y = 0; y < cfg->dst_height; y++)
+  {
+    uint8_t *pOut = is_float ? pFloatRow : (uint8_t *) dst + y * row_len;
+
+    if (cfg->resize_mode == PP_RESIZE_NEAREST)
+    {
+      const uint16_t *pSrcRow = src + ((y * h_ratio) >> 16) * cfg->src_width;
+
+      Preproc_NearestRow(pSrcRow, cfg->dst_width, w_ratio, cfg->color_mode, channels, xor_mask, pOut);
+    }
+    else
+    {
+      uint32_t y0, y1;
+      int32_t wy = Preproc_BilinearCoord(y_start, y_step, y, cfg->src_height, &y0, &y1);
+
+      /* Moving down, the bottom row of the previous output row is often the top one of this row */
+      if (line_row[0] != (int32_t) y0)
+      {
+        if (line_row[1] == (int32_t) y0)
+        {
+          uint16_t *pTmp = pLine[0];
+          pLine[0] = pLine[1];
+          pLine[1] = pTmp;
+          line_row[1] = line_row[0];
+        }
+        else
+        {
+          Preproc_BilinearFillRow(src + y0 * cfg->src_width, cfg, channels, x_start, x_step, pLine[0]);
+        }
+        line_row[0] = (int32_t) y0;
+      }
+      if (line_row[1] != (int32_t) y1)
+      {
+        Preproc_BilinearFillRow(src + y1 * cfg->src_width, cfg, channels, x_start, x_step, pLine[1]);
+        line_row[1] = (int32_t) y1;
+      }
+
+      for (uint32_t i = 0; i < row_len; i++)
+      {
+        uint32_t v = (pLine[0][i] * (uint32_t) (256 - wy) + pLine[1][i] * (uint32_t) wy + 0x8000) >> 16;
+        pOut[i] = (uint8_t) v ^ xor_mask;
+      }
+    }
+
+    if (is_float)
+    {
+      float *pOutF = (float *) dst + y * row_len;
+
+      for (uint32_t i = 0; i < row_len; i++)
+      {
+        pOutF[i] = cfg->float_scale * (float) pFloatRow[i] + cfg->float_offset;
+      }
+    }
+  }
+
+  return PREPROC_OK;
+}
+
+/**
+ * @brief Writes the channels of an RGB565 pixel in the NN input order
+ * @param pixel RGB565 pixel
+ * @param color_mode RGB_FORMAT, BGR_FORMAT or GRAYSCALE_FORMAT
+ * @param pOut Output channels
+ */
+static inline void Preproc_ExpandPixel(uint16_t pixel, uint32_t color_mode, uint8_t *pOut)
+{
+  uint8_t r = PREPROC_RGB565_TO_R8(pixel);
+  uint8_t g = PREPROC_RGB565_TO_G8(pixel);
+  uint8_t b = PREPROC_RGB565_TO_B8(pixel);
+
+  if (color_mode == RGB_FORMAT)
+  {
+    pOut[0] = r;
+    pOut[1] = g;
+    pOut[2] = b;
+  }
+  else if (color_mode == BGR_FORMAT)
+  {
+    pOut[0] = b;
+    pOut[1] = g;
+    pOut[2] = r;
+  }
+  else
+  {
+    pOut[0] = PREPROC_RGB888_TO_Y(r, g, b);
+  }
+}
+
+/**
+ * @brief Resamples one output row with the nearest neighbor method
+ * @param pSrcRow Source row
+ * @param dst_width Output width
+ * @param w_ratio 16.16 horizontal ratio
+ * @param color_mode RGB_FORMAT, BGR_FORMAT or GRAYSCALE_FORMAT
+ * @param channels Number of output channels
+ * @param xor_mask 0x80 for int8 output, 0 otherwise
+ * @param pOut Output row
+ */
+static void Preproc_NearestRow(const uint16_t *pSrcRow, uint32_t dst_width, uint32_t w_ratio,
+                               uint32_t color_mode, uint32_t channels, uint8_t xor_mask, uint8_t *pOut)
+{
+  uint32_t sx = 0;
+
+  for (uint32_t x = 0; x < dst_width; x++)
+  {
+    Preproc_ExpandPixel(pSrcRow[sx >> 16], color_mode, pOut);
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      pOut[c] ^= xor_mask;
+    }
+    pOut += channels;
+    sx += w_ratio;
+  }
+}
+
+/**
+ * @brief Resamples horizontally one source row into the line buffer (channels x 256)
+ * @param pSrcRow Source row
+ * @param cfg Preprocessing configuration
+ * @param channels Number of output channels
+ * @param x_start 16.16 source coordinate of the first output pixel
+ * @param x_step 16.16 horizontal step
+ * @param pLine Line buffer row
+ */
+static void Preproc_BilinearFillRow(const uint16_t *pSrcRow, const Preproc_Config_TypeDef *cfg,
+                                    uint32_t channels, int32_t x_start, int32_t x_step, uint16_t *pLine)
+{
+  uint8_t left[3];
+  uint8_t right[3];
+
+  for (uint32_t x = 0; x < cfg->dst_width; x++)
+  {
+    uint32_t x0, x1;
+    int32_t wx = Preproc_BilinearCoord(x_start, x_step, x, cfg->src_width, &x0, &x1);
+
+    Preproc_ExpandPixel(pSrcRow[x0], cfg->color_mode, left);
+    Preproc_ExpandPixel(pSrcRow[x1], cfg->color_mode, right);
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      *pLine++ = (uint16_t) (left[c] * (256 - wx) + right[c] * wx);
+    }
+  }
+}
+
+/**
+ * @brief Computes the two source indexes around an output index and the 8-bit weight of the second one
+ * @param start 16.16 source coordinate of output index 0
+ * @param step 16.16 step
+ * @param i Output index
+ * @param size Source size
+ * @param i0 First source index
+ * @param i1 Second source index
+ * @retval Weight of i1 (0..255)
+ */
+static int32_t Preproc_BilinearCoord(int32_t start, int32_t step, uint32_t i, uint32_t size,
+                                     uint32_t *i0, uint32_t *i1)
+{
+  int32_t s = start + (int32_t) i * step;
+  int32_t s_max = (int32_t) ((size - 1) << 16);
+
+  s = (s < 0) ? 0 : ((s > s_max) ? s_max : s);
+  *i0 = (uint32_t) s >> 16;
+  *i1 = (*i0 + 1 < size) ? *i0 + 1 : *i0;
+
+  return (s >> 8) & 0xFF;
+}
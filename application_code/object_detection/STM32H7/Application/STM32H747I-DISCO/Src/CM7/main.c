@@ -44,11 +44,6 @@ __attribute__((section(".CapturedImage_Buffer_SDRAM")))
 __attribute__ ((aligned (32)))
 uint8_t CapturedImage_Buffer[CAM_FRAME_BUFFER_SIZE];
 
-/***Buffer to store the rescaled frame***/
-__attribute__((section(".RescaledImage_Buffer_AXIRAM")))
-__attribute__ ((aligned (32)))
-uint8_t RescaledImage_Buffer[RESCALED_FRAME_BUFFER_SIZE];
-
  /***Buffer to store the NN input frame***/
 __attribute__((section(".NN_InputImage_Buffer")))
 __attribute__ ((aligned (32)))
@@ -226,19 +221,6 @@ static void Software_Init(AppConfig_TypeDef *App_Config_Ptr)
 
   App_Config_Ptr->nn_output_labels=classes_table;
   
-  /*Preproc*/
-#if PP_COLOR_MODE == RGB_FORMAT
-  App_Config_Ptr->red_blue_swap = 1; /* See UM2611 section 3.2.6 Pixel data order */
-#else
-  App_Config_Ptr->red_blue_swap = 0;
-#endif
-  
-#if PP_COLOR_MODE == GRAYSCALE_FORMAT
-  App_Config_Ptr->PixelFormatConv=SW_PFC;
-#else
-  App_Config_Ptr->PixelFormatConv=HW_PFC;
-#endif
-  
   /*Postproc initialization*/
   App_Config_Ptr->error = AI_OBJDETECT_POSTPROCESS_ERROR_NO;
 
@@ -259,7 +241,6 @@ static void Software_Init(AppConfig_TypeDef *App_Config_Ptr)
   App_Config_Ptr->nn_output_buffer[0]=NN_OutputData_Buffer;
   App_Config_Ptr->camera_capture_buffer = CapturedImage_Buffer;
   App_Config_Ptr->camera_capture_buffer_no_borders = App_Config_Ptr->camera_capture_buffer+((CAM_RES_WIDTH - CAM_RES_HEIGHT)/2)*CAM_RES_WIDTH*RGB_565_BPP;
-  App_Config_Ptr->rescaled_image_buffer = RescaledImage_Buffer;
   App_Config_Ptr->activation_buffer = NN_Activation_Buffer;
   App_Config_Ptr->lcd_frame_read_buff=lcd_display_global_memory;
   App_Config_Ptr->lcd_frame_write_buff=lcd_display_global_memory + SDRAM_BANK_SIZE;
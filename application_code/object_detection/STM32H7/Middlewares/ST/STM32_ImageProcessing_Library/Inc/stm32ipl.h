@@ -227,6 +227,12 @@ stm32ipl_err_t STM32Ipl_Binary(const image_t *src, image_t *dst, const list_t *t
 stm32ipl_err_t STM32Ipl_FindBlobs(const image_t *img, list_t *out, const rectangle_t *roi, const list_t *thresholds,
 		uint8_t x_stride, uint8_t y_stride, uint16_t area_threshold, uint16_t pixels_threshold, bool merge,
 		uint8_t margin, bool invert, uint32_t maxBlobs);
+/**
+ * @brief Same blobs as STM32Ipl_FindBlobs() with strides of 1 (rectangle, pixels, centroid, rotation,
+ * roundness, code, count), in the same order. The perimeter and the corners are NOT computed: they are 0.
+ */
+stm32ipl_err_t STM32Ipl_FindBlobsFast(const image_t *img, list_t *out, const rectangle_t *roi, const list_t *thresholds,
+		uint16_t area_threshold, uint16_t pixels_threshold, bool merge, uint8_t margin, bool invert, uint32_t maxBlobs);
 /** @} */
 
 /**
@@ -297,6 +303,8 @@ stm32ipl_err_t STM32Ipl_HistEqClahe(image_t *img, float clipLimit, const image_t
  */
 stm32ipl_err_t STM32Ipl_MeanFilter(image_t *img, uint8_t kSize, bool threshold, int32_t offset, bool invert,
 		const image_t *mask);
+stm32ipl_err_t STM32Ipl_BoxFilter(image_t *img, uint8_t kSize, bool threshold, int32_t offset, bool invert,
+		const image_t *mask);
 stm32ipl_err_t STM32Ipl_MedianFilter(image_t *img, uint8_t kSize, float percentile, bool threshold, int32_t offset,
 bool invert, const image_t *mask);
 stm32ipl_err_t STM32Ipl_ModeFilter(image_t *img, uint8_t kSize, bool threshold, int32_t offset, bool invert,
@@ -308,6 +316,7 @@ stm32ipl_err_t STM32Ipl_BilateralFilter(image_t *img, uint8_t kSize, float color
 stm32ipl_err_t STM32Ipl_Morph(image_t *img, uint8_t kSize, const int32_t *krn, float mul, int32_t add, bool threshold,
 		int32_t offset, bool invert, const image_t *mask);
 stm32ipl_err_t STM32Ipl_Gaussian(image_t *img, uint8_t kSize, bool threshold, bool unsharp, const image_t *mask);
+stm32ipl_err_t STM32Ipl_FastGaussian(image_t *img, uint8_t kSize, bool threshold, bool unsharp, const image_t *mask);
 stm32ipl_err_t STM32Ipl_Laplacian(image_t *img, uint8_t kSize, bool sharpen, const image_t *mask);
 stm32ipl_err_t STM32Ipl_Sobel(image_t *img, uint8_t kSize, bool sharpen, const image_t *mask);
 stm32ipl_err_t STM32Ipl_Scharr(image_t *img, uint8_t kSize, bool sharpen, const image_t *mask);
@@ -434,6 +443,8 @@ stm32ipl_err_t STM32Ipl_LoadEyeCascade(cascade_t *cascade);
 #endif /* STM32IPL_ENABLE_EYE_CASCADE */
 stm32ipl_err_t STM32Ipl_DetectObject(const image_t *img, array_t **out, const rectangle_t *roi, cascade_t *cascade,
 		float scaleFactor, float threshold);
+stm32ipl_err_t STM32Ipl_DetectObjectFast(const image_t *img, array_t **out, const rectangle_t *roi,
+		cascade_t *cascade, float scaleFactor, float threshold);
 #endif /* STM32IPL_ENABLE_OBJECT_DETECTION */
 /** @} */
 
@@ -483,6 +494,8 @@ stm32ipl_err_t STM32Ipl_Crop(const image_t *src, image_t *dst, uint32_t x, uint3
 stm32ipl_err_t STM32Ipl_Resize(const image_t *src, image_t *dst, const rectangle_t *roi);
 stm32ipl_err_t STM32Ipl_Downscale(const image_t *src, image_t *dst, bool reversed);
 stm32ipl_err_t STM32Ipl_Downscale_bilinear(const image_t *src, image_t *dst);
+stm32ipl_err_t STM32Ipl_Resize_bilinear(const image_t *src, image_t *dst);
+stm32ipl_err_t STM32Ipl_Resize_area(const image_t *src, image_t *dst);
 /** @} */
 
 /**
@@ -235,6 +235,8 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
 		bool (*threshold_cb)(void*, find_blobs_list_lnk_data_t*), void *threshold_cb_arg,
 		bool (*merge_cb)(void*, find_blobs_list_lnk_data_t*, find_blobs_list_lnk_data_t*), void *merge_cb_arg,
 		unsigned int x_hist_bins_max, unsigned int y_hist_bins_max, uint32_t max_blobs); // STM32IPL: max_blobs parameter added.
+bool imlib_find_blobs_rle(list_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert,
+		unsigned int area_threshold, unsigned int pixels_threshold, bool merge, int margin, uint32_t max_blobs); // STM32IPL
 
 // Shape Detection
 void imlib_find_lines(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
@@ -128,6 +128,86 @@ static float calc_roundness(float blob_a, float blob_b, float blob_c)
     return IM_DIV(roundness_min, roundness_max);
 }
 
+// STM32IPL: merge step of imlib_find_blobs(), shared with imlib_find_blobs_rle().
+static void find_blobs_merge(list_t *out, int margin,
+                             bool (*merge_cb)(void*,find_blobs_list_lnk_data_t*,find_blobs_list_lnk_data_t*), void *merge_cb_arg,
+                             unsigned int x_hist_bins_max, unsigned int y_hist_bins_max)
+{
+    for(;;) {
+        bool merge_occured = false;
+
+        list_t out_temp;
+        list_init(&out_temp, sizeof(find_blobs_list_lnk_data_t));
+
+        while(list_size(out)) {
+            find_blobs_list_lnk_data_t lnk_blob;
+            list_pop_front(out, &lnk_blob);
+
+            for (size_t k = 0, l = list_size(out); k < l; k++) {
+                find_blobs_list_lnk_data_t tmp_blob;
+                list_pop_front(out, &tmp_blob);
+
+                rectangle_t temp;
+                temp.x = IM_MAX(IM_MIN(tmp_blob.rect.x - margin, INT16_MAX), INT16_MIN);
+                temp.y = IM_MAX(IM_MIN(tmp_blob.rect.y - margin, INT16_MAX), INT16_MIN);
+                temp.w = IM_MAX(IM_MIN(tmp_blob.rect.w + (margin * 2), INT16_MAX), 0);
+                temp.h = IM_MAX(IM_MIN(tmp_blob.rect.h + (margin * 2), INT16_MAX), 0);
+
+                if (rectangle_overlap(&(lnk_blob.rect), &temp)
+                && ((merge_cb_arg == NULL) || merge_cb(merge_cb_arg, &lnk_blob, &tmp_blob))) {
+                    // Have to merge these first before merging rects.
+                    if (x_hist_bins_max) merge_bins(lnk_blob.rect.x, lnk_blob.rect.x + lnk_blob.rect.w - 1, &lnk_blob.x_hist_bins, &lnk_blob.x_hist_bins_count,
+                                                    tmp_blob.rect.x, tmp_blob.rect.x + tmp_blob.rect.w - 1, &tmp_blob.x_hist_bins, &tmp_blob.x_hist_bins_count,
+                                                    x_hist_bins_max);
+                    if (y_hist_bins_max) merge_bins(lnk_blob.rect.y, lnk_blob.rect.y + lnk_blob.rect.h - 1, &lnk_blob.y_hist_bins, &lnk_blob.y_hist_bins_count,
+                                                    tmp_blob.rect.y, tmp_blob.rect.y + tmp_blob.rect.h - 1, &tmp_blob.y_hist_bins, &tmp_blob.y_hist_bins_count,
+                                                    y_hist_bins_max);
+                    // Merge corners...
+                    for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                        float z_dst = (lnk_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]) +
+                                      (lnk_blob.corners[i].y * sin_table[FIND_BLOBS_ANGLE_RESOLUTION*i]);
+                        float z_src = (tmp_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]) +
+                                      (tmp_blob.corners[i].y * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]);
+                        if (z_src < z_dst) {
+                            lnk_blob.corners[i].x = tmp_blob.corners[i].x;
+                            lnk_blob.corners[i].y = tmp_blob.corners[i].y;
+                        }
+                    }
+                    // Merge rects...
+                    rectangle_united(&(lnk_blob.rect), &(tmp_blob.rect));
+                    // Merge counters...
+                    lnk_blob.pixels += tmp_blob.pixels; // won't overflow
+                    lnk_blob.perimeter += tmp_blob.perimeter; // won't overflow
+                    lnk_blob.code |= tmp_blob.code; // won't overflow
+                    lnk_blob.count += tmp_blob.count; // won't overflow
+                    // Merge accumulators...
+                    lnk_blob.centroid_x_acc += tmp_blob.centroid_x_acc;
+                    lnk_blob.centroid_y_acc += tmp_blob.centroid_y_acc;
+                    lnk_blob.rotation_acc_x += tmp_blob.rotation_acc_x;
+                    lnk_blob.rotation_acc_y += tmp_blob.rotation_acc_y;
+                    lnk_blob.roundness_acc += tmp_blob.roundness_acc;
+                    // Compute current values...
+                    lnk_blob.centroid_x = lnk_blob.centroid_x_acc / lnk_blob.pixels;
+                    lnk_blob.centroid_y = lnk_blob.centroid_y_acc / lnk_blob.pixels;
+                    lnk_blob.rotation = fast_atan2f(lnk_blob.rotation_acc_y / lnk_blob.pixels,
+                                                    lnk_blob.rotation_acc_x / lnk_blob.pixels);
+                    lnk_blob.roundness = lnk_blob.roundness_acc / lnk_blob.pixels;
+                    merge_occured = true;
+                } else {
+                	list_push_back(out, &tmp_blob);
+                }
+            }
+            list_push_back(&out_temp, &lnk_blob);
+        }
+
+        list_copy(out, &out_temp);
+
+        if (!merge_occured) {
+            break;
+        }
+    }
+}
+
 // STM32IPL: max_blobs parameter added.
 void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
                       list_t *thresholds, bool invert, unsigned int area_threshold, unsigned int pixels_threshold,
@@ -1376,80 +1456,417 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
     fb_free(); // bitmap
 
     if (merge) {
-        for(;;) {
-            bool merge_occured = false;
-
-            list_t out_temp;
-            list_init(&out_temp, sizeof(find_blobs_list_lnk_data_t));
-
-            while(list_size(out)) {
-                find_blobs_list_lnk_data_t lnk_blob;
-                list_pop_front(out, &lnk_blob);
-
-                for (size_t k = 0, l = list_size(out); k < l; k++) {
-                    find_blobs_list_lnk_data_t tmp_blob;
-                    list_pop_front(out, &tmp_blob);
-
-                    rectangle_t temp;
-                    temp.x = IM_MAX(IM_MIN(tmp_blob.rect.x - margin, INT16_MAX), INT16_MIN);
-                    temp.y = IM_MAX(IM_MIN(tmp_blob.rect.y - margin, INT16_MAX), INT16_MIN);
-                    temp.w = IM_MAX(IM_MIN(tmp_blob.rect.w + (margin * 2), INT16_MAX), 0);
-                    temp.h = IM_MAX(IM_MIN(tmp_blob.rect.h + (margin * 2), INT16_MAX), 0);
-
-                    if (rectangle_overlap(&(lnk_blob.rect), &temp)
-                    && ((merge_cb_arg == NULL) || merge_cb(merge_cb_arg, &lnk_blob, &tmp_blob))) {
-                        // Have to merge these first before merging rects.
-                        if (x_hist_bins_max) merge_bins(lnk_blob.rect.x, lnk_blob.rect.x + lnk_blob.rect.w - 1, &lnk_blob.x_hist_bins, &lnk_blob.x_hist_bins_count,
-                                                        tmp_blob.rect.x, tmp_blob.rect.x + tmp_blob.rect.w - 1, &tmp_blob.x_hist_bins, &tmp_blob.x_hist_bins_count,
-                                                        x_hist_bins_max);
-                        if (y_hist_bins_max) merge_bins(lnk_blob.rect.y, lnk_blob.rect.y + lnk_blob.rect.h - 1, &lnk_blob.y_hist_bins, &lnk_blob.y_hist_bins_count,
-                                                        tmp_blob.rect.y, tmp_blob.rect.y + tmp_blob.rect.h - 1, &tmp_blob.y_hist_bins, &tmp_blob.y_hist_bins_count,
-                                                        y_hist_bins_max);
-                        // Merge corners...
-                        for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
-                            float z_dst = (lnk_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]) +
-                                          (lnk_blob.corners[i].y * sin_table[FIND_BLOBS_ANGLE_RESOLUTION*i]);
-                            float z_src = (tmp_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]) +
-                                          (tmp_blob.corners[i].y * cos_table[FIND_BLOBS_ANGLE_RESOLUTION*i]);
-                            if (z_src < z_dst) {
-                                lnk_blob.corners[i].x = tmp_blob.corners[i].x;
-                                lnk_blob.corners[i].y = tmp_blob.corners[i].y;
-                            }
-                        }
-                        // Merge rects...
-                        rectangle_united(&(lnk_blob.rect), &(tmp_blob.rect));
-                        // Merge counters...
-                        lnk_blob.pixels += tmp_blob.pixels; // won't overflow
-                        lnk_blob.perimeter += tmp_blob.perimeter; // won't overflow
-                        lnk_blob.code |= tmp_blob.code; // won't overflow
-                        lnk_blob.count += tmp_blob.count; // won't overflow
-                        // Merge accumulators...
-                        lnk_blob.centroid_x_acc += tmp_blob.centroid_x_acc;
-                        lnk_blob.centroid_y_acc += tmp_blob.centroid_y_acc;
-                        lnk_blob.rotation_acc_x += tmp_blob.rotation_acc_x;
-                        lnk_blob.rotation_acc_y += tmp_blob.rotation_acc_y;
-                        lnk_blob.roundness_acc += tmp_blob.roundness_acc;
-                        // Compute current values...
-                        lnk_blob.centroid_x = lnk_blob.centroid_x_acc / lnk_blob.pixels;
-                        lnk_blob.centroid_y = lnk_blob.centroid_y_acc / lnk_blob.pixels;
-                        lnk_blob.rotation = fast_atan2f(lnk_blob.rotation_acc_y / lnk_blob.pixels,
-                                                        lnk_blob.rotation_acc_x / lnk_blob.pixels);
-                        lnk_blob.roundness = lnk_blob.roundness_acc / lnk_blob.pixels;
-                        merge_occured = true;
-                    } else {
-                    	list_push_back(out, &tmp_blob);
+        find_blobs_merge(out, margin, merge_cb, merge_cb_arg, x_hist_bins_max, y_hist_bins_max); // STM32IPL
+    }
+}
+
+// STM32IPL: run-length version of imlib_find_blobs().
+//
+// Each row is encoded as runs of pixels passing the same threshold (a pixel belongs to the first
+// threshold it passes, as the bitmap of imlib_find_blobs() gives it to the blobs of the first one),
+// and the runs of two consecutive rows which overlap are joined with a union-find on labels holding
+// the blob accumulators. A blob is complete as soon as a row does not continue it, the labels that
+// are no longer referenced are reused, so the memory only depends on the roi width.
+// The corners and the perimeter of imlib_find_blobs() depend on the order its flood fill visits the
+// pixels; they are not computed: they are 0 in the blobs found.
+
+#define FIND_BLOBS_RLE_NONE 0xFFFF
+
+typedef struct find_blobs_rle_run {
+    int16_t l, r;
+    uint16_t label;
+    uint8_t cls; // Threshold index + 1.
+} find_blobs_rle_run_t;
+
+typedef struct find_blobs_rle_label {
+    uint16_t parent;
+    uint8_t cls;
+    int16_t x, y; // First pixel in raster order, sets the order of the blobs in the output list.
+    int16_t left, top, right, bottom; // Bounding rectangle.
+    int row; // Last row of the label runs.
+    int pixels, cx, cy;
+    long long a, b, c;
+} find_blobs_rle_label_t;
+
+typedef struct find_blobs_rle_candidate {
+    uint64_t key;
+    find_blobs_list_lnk_data_t blob;
+} find_blobs_rle_candidate_t;
+
+typedef struct find_blobs_rle {
+    find_blobs_rle_label_t *labels;
+    uint16_t *free_labels;
+    uint16_t *live_labels; // Labels in use, roots or not.
+    int free_n, live_n;
+    uint8_t lut[256]; // Class of the Binary and Grayscale pixels.
+    find_blobs_rle_candidate_t *candidates; // Blobs found, sorted by threshold then first pixel.
+    uint32_t candidates_n, candidates_max;
+    unsigned int area_threshold, pixels_threshold;
+} find_blobs_rle_t;
+
+static uint16_t find_blobs_rle_find(find_blobs_rle_t *rle, uint16_t label)
+{
+    while (rle->labels[label].parent != label) {
+        rle->labels[label].parent = rle->labels[rle->labels[label].parent].parent;
+        label = rle->labels[label].parent;
+    }
+
+    return label;
+}
+
+static uint16_t find_blobs_rle_new(find_blobs_rle_t *rle, int x, int y, uint8_t cls)
+{
+    uint16_t label = rle->free_labels[--rle->free_n];
+    find_blobs_rle_label_t *p = &rle->labels[label];
+
+    p->parent = label;
+    p->cls = cls;
+    p->x = x;
+    p->y = y;
+    p->left = x;
+    p->top = y;
+    p->right = x;
+    p->bottom = y;
+    p->pixels = 0;
+    p->cx = 0;
+    p->cy = 0;
+    p->a = 0;
+    p->b = 0;
+    p->c = 0;
+    rle->live_labels[rle->live_n++] = label;
+
+    return label;
+}
+
+// Joins the blobs of two roots, the one seen first in raster order keeps the accumulators.
+static uint16_t find_blobs_rle_union(find_blobs_rle_t *rle, uint16_t l0, uint16_t l1)
+{
+    if (l0 == l1) {
+        return l0;
+    }
+
+    find_blobs_rle_label_t *p0 = &rle->labels[l0];
+    find_blobs_rle_label_t *p1 = &rle->labels[l1];
+
+    if ((p1->y < p0->y) || ((p1->y == p0->y) && (p1->x < p0->x))) {
+        find_blobs_rle_label_t *p = p0; p0 = p1; p1 = p;
+        uint16_t l = l0; l0 = l1; l1 = l;
+    }
+
+    p0->left = IM_MIN(p0->left, p1->left);
+    p0->top = IM_MIN(p0->top, p1->top);
+    p0->right = IM_MAX(p0->right, p1->right);
+    p0->bottom = IM_MAX(p0->bottom, p1->bottom);
+    p0->pixels += p1->pixels;
+    p0->cx += p1->cx;
+    p0->cy += p1->cy;
+    p0->a += p1->a;
+    p0->b += p1->b;
+    p0->c += p1->c;
+
+    p1->parent = l0;
+
+    return l0;
+}
+
+// Adds the run [left, right] of row y to a root, same accumulation as the flood fill of imlib_find_blobs().
+static void find_blobs_rle_add(find_blobs_rle_label_t *p, int left, int right, int y)
+{
+    int sum = sum_m_to_n(left, right);
+    int sum_2 = sum_2_m_to_n(left, right);
+    int cnt = right - left + 1;
+
+    p->left = IM_MIN(p->left, left);
+    p->top = IM_MIN(p->top, y);
+    p->right = IM_MAX(p->right, right);
+    p->bottom = IM_MAX(p->bottom, y);
+    p->pixels += cnt;
+    p->cx += sum;
+    p->cy += y * cnt;
+    p->a += sum_2;
+    p->b += y * sum;
+    p->c += y * y * cnt;
+}
+
+// Turns a complete blob into a find_blobs_list_lnk_data_t and keeps it if it is among the first ones.
+static void find_blobs_rle_emit(find_blobs_rle_t *rle, find_blobs_rle_label_t *p)
+{
+    // The extreme corners of imlib_find_blobs() give its rectangle.
+    rectangle_t rect;
+    rect.x = p->left;
+    rect.y = p->top;
+    rect.w = p->right - p->left + 1;
+    rect.h = p->bottom - p->top + 1;
+
+    if (((rect.w * rect.h) < rle->area_threshold) || (p->pixels < rle->pixels_threshold)) {
+        return;
+    }
+
+    uint64_t key = (((uint64_t) p->cls) << 32) | (((uint32_t) p->y) << 16) | ((uint32_t) p->x);
+    uint32_t pos = rle->candidates_n;
+
+    while (pos && (rle->candidates[pos - 1].key > key)) {
+        pos--;
+    }
+
+    if (pos == rle->candidates_max) {
+        return;
+    }
+
+    if (rle->candidates_n == rle->candidates_max) {
+        rle->candidates_n--;
+    }
+
+    memmove(&rle->candidates[pos + 1], &rle->candidates[pos], (rle->candidates_n - pos) * sizeof(find_blobs_rle_candidate_t));
+    rle->candidates_n++;
+    rle->candidates[pos].key = key;
+
+    // Same statistics as imlib_find_blobs().
+    find_blobs_list_lnk_data_t *lnk_blob = &rle->candidates[pos].blob;
+    float b_mx = p->cx / ((float) p->pixels);
+    float b_my = p->cy / ((float) p->pixels);
+    int mx = fast_roundf(b_mx); // x centroid
+    int my = fast_roundf(b_my); // y centroid
+    int small_blob_a = p->a - ((mx * p->cx) + (mx * p->cx)) + (p->pixels * mx * mx);
+    int small_blob_b = p->b - ((mx * p->cy) + (my * p->cx)) + (p->pixels * mx * my);
+    int small_blob_c = p->c - ((my * p->cy) + (my * p->cy)) + (p->pixels * my * my);
+
+    memset(lnk_blob->corners, 0, FIND_BLOBS_CORNERS_RESOLUTION * sizeof(point_t)); // Not computed.
+    memcpy(&lnk_blob->rect, &rect, sizeof(rectangle_t));
+    lnk_blob->pixels = p->pixels;
+    lnk_blob->perimeter = 0; // Not computed.
+    lnk_blob->code = 1 << (p->cls - 1);
+    lnk_blob->count = 1;
+    lnk_blob->centroid_x = b_mx;
+    lnk_blob->centroid_y = b_my;
+    lnk_blob->rotation = (small_blob_a != small_blob_c) ? (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
+    lnk_blob->roundness = calc_roundness(small_blob_a, small_blob_b, small_blob_c);
+    lnk_blob->x_hist_bins_count = 0;
+    lnk_blob->x_hist_bins = NULL;
+    lnk_blob->y_hist_bins_count = 0;
+    lnk_blob->y_hist_bins = NULL;
+    // These store the current average accumulation.
+    lnk_blob->centroid_x_acc = lnk_blob->centroid_x * lnk_blob->pixels;
+    lnk_blob->centroid_y_acc = lnk_blob->centroid_y * lnk_blob->pixels;
+    lnk_blob->rotation_acc_x = cosf(lnk_blob->rotation) * lnk_blob->pixels;
+    lnk_blob->rotation_acc_y = sinf(lnk_blob->rotation) * lnk_blob->pixels;
+    lnk_blob->roundness_acc = lnk_blob->roundness * lnk_blob->pixels;
+}
+
+// Gives each pixel of row y in the roi the index + 1 of the first threshold it passes, 0 for none;
+// Binary and Grayscale pixels are looked up in lut.
+static void find_blobs_rle_classes(uint8_t *cls_row, image_t *ptr, rectangle_t *roi, int y, const uint8_t *lut,
+                                   color_thresholds_list_lnk_data_t *thresholds, int thresholds_n, bool invert)
+{
+    switch(ptr->bpp) {
+        case IMAGE_BPP_BINARY: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
+            for (int x = 0; x < roi->w; x++) {
+                cls_row[x] = lut[IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, roi->x + x)];
+            }
+            break;
+        }
+        case IMAGE_BPP_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y) + roi->x;
+            for (int x = 0; x < roi->w; x++) {
+                cls_row[x] = lut[row_ptr[x]];
+            }
+            break;
+        }
+        case IMAGE_BPP_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
+            for (int x = 0; x < roi->w; x++) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, roi->x + x);
+                // Lab conversion done once for all the thresholds.
+                uint8_t l = COLOR_RGB565_TO_L(pixel);
+                int8_t a = COLOR_RGB565_TO_A(pixel);
+                int8_t b = COLOR_RGB565_TO_B(pixel);
+                uint8_t cls = 0;
+                for (int t = 0; t < thresholds_n; t++) {
+                    color_thresholds_list_lnk_data_t *th = &thresholds[t];
+                    if (((th->LMin <= l) && (l <= th->LMax) && (th->AMin <= a) && (a <= th->AMax)
+                    && (th->BMin <= b) && (b <= th->BMax)) ^ invert) {
+                        cls = t + 1;
+                        break;
                     }
                 }
-                list_push_back(&out_temp, &lnk_blob);
+                cls_row[x] = cls;
             }
+            break;
+        }
+        case IMAGE_BPP_RGB888: {
+            rgb888_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y);
+            for (int x = 0; x < roi->w; x++) {
+                rgb888_t pixel = IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, roi->x + x);
+                // Lab conversion done once for all the thresholds.
+                uint8_t l = COLOR_RGB888_TO_L(pixel);
+                int8_t a = COLOR_RGB888_TO_A(pixel);
+                int8_t b = COLOR_RGB888_TO_B(pixel);
+                uint8_t cls = 0;
+                for (int t = 0; t < thresholds_n; t++) {
+                    color_thresholds_list_lnk_data_t *th = &thresholds[t];
+                    if (((th->LMin <= l) && (l <= th->LMax) && (th->AMin <= a) && (a <= th->AMax)
+                    && (th->BMin <= b) && (b <= th->BMax)) ^ invert) {
+                        cls = t + 1;
+                        break;
+                    }
+                }
+                cls_row[x] = cls;
+            }
+            break;
+        }
+        default: {
+            memset(cls_row, 0, roi->w);
+            break;
+        }
+    }
+}
+
+// Same blobs as imlib_find_blobs() with x_stride and y_stride of 1, no callbacks and no histograms,
+// in the same order, without corners and perimeter (0). Returns false when there is not enough memory.
+bool imlib_find_blobs_rle(list_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert,
+                          unsigned int area_threshold, unsigned int pixels_threshold,
+                          bool merge, int margin, uint32_t max_blobs)
+{
+    list_init(out, sizeof(find_blobs_list_lnk_data_t));
+
+    if (!max_blobs) {
+        return true;
+    }
 
-            list_copy(out, &out_temp);
+    int thresholds_n = IM_MIN(list_size(thresholds), 32);
+    int labels_n = roi->w * 2; // At most one label per run of the previous and current rows.
+    int runs_n = roi->w;
+    uint64_t size = (((uint64_t) max_blobs) * sizeof(find_blobs_rle_candidate_t))
+                  + (labels_n * (sizeof(find_blobs_rle_label_t) + (2 * sizeof(uint16_t))))
+                  + (thresholds_n * sizeof(color_thresholds_list_lnk_data_t)) + 4 // runs alignment
+                  + (2 * runs_n * sizeof(find_blobs_rle_run_t)) + (roi->w * sizeof(uint8_t));
 
-            if (!merge_occured) {
+    if (size > fb_avail()) {
+        return false;
+    }
+
+    find_blobs_rle_t rle;
+    rle.candidates = fb_alloc(size, FB_ALLOC_NO_HINT);
+    rle.candidates_n = 0;
+    rle.candidates_max = max_blobs;
+    rle.labels = (find_blobs_rle_label_t *) (rle.candidates + max_blobs);
+    rle.free_labels = (uint16_t *) (rle.labels + labels_n);
+    rle.live_labels = rle.free_labels + labels_n;
+    rle.area_threshold = area_threshold;
+    rle.pixels_threshold = pixels_threshold;
+    color_thresholds_list_lnk_data_t *lnk_thresholds = (color_thresholds_list_lnk_data_t *) (rle.live_labels + labels_n);
+    find_blobs_rle_run_t *prev_runs = (find_blobs_rle_run_t *) (((uintptr_t) (lnk_thresholds + thresholds_n) + 3) & ~3);
+    find_blobs_rle_run_t *runs = prev_runs + runs_n;
+    uint8_t *cls_row = (uint8_t *) (runs + runs_n);
+    int prev_n = 0;
+
+    for (int i = 0; i < labels_n; i++) {
+        rle.free_labels[i] = labels_n - 1 - i;
+    }
+    rle.free_n = labels_n;
+    rle.live_n = 0;
+
+    list_lnk_t *it = iterator_start_from_head(thresholds);
+    for (int t = 0; t < thresholds_n; t++, it = iterator_next(it)) {
+        iterator_get(thresholds, it, &lnk_thresholds[t]);
+    }
+
+    for (int pixel = 0; pixel < 256; pixel++) {
+        uint8_t cls = 0;
+        for (int t = 0; t < thresholds_n; t++) {
+            if (COLOR_THRESHOLD_GRAYSCALE(pixel, &lnk_thresholds[t], invert)) {
+                cls = t + 1;
                 break;
             }
         }
+        rle.lut[pixel] = cls;
     }
+
+    int y_max = roi->y + roi->h - 1;
+
+    for (int y = roi->y; y <= y_max; y++) {
+        find_blobs_rle_classes(cls_row, ptr, roi, y, rle.lut, lnk_thresholds, thresholds_n, invert);
+
+        // Runs of the row, x relative to the roi.
+        int n = 0;
+        for (int x = 0; x < roi->w;) {
+            uint8_t cls = cls_row[x];
+            int left = x;
+            while ((++x < roi->w) && (cls_row[x] == cls));
+            if (cls) {
+                runs[n].l = left;
+                runs[n].r = x - 1;
+                runs[n].cls = cls;
+                n++;
+            }
+        }
+
+        // Labels: each run joins the blobs of the runs of the same threshold it touches on the previous row.
+        for (int i = 0, p = 0; i < n; i++) {
+            find_blobs_rle_run_t *run = &runs[i];
+            uint16_t label = FIND_BLOBS_RLE_NONE;
+
+            while ((p < prev_n) && (prev_runs[p].r < run->l)) {
+                p++;
+            }
+
+            for (int q = p; (q < prev_n) && (prev_runs[q].l <= run->r); q++) {
+                if (prev_runs[q].cls == run->cls) {
+                    uint16_t root = find_blobs_rle_find(&rle, prev_runs[q].label);
+                    label = (label == FIND_BLOBS_RLE_NONE) ? root : find_blobs_rle_union(&rle, label, root);
+                }
+            }
+
+            if (label == FIND_BLOBS_RLE_NONE) {
+                label = find_blobs_rle_new(&rle, roi->x + run->l, y, run->cls);
+            }
+
+            find_blobs_rle_add(&rle.labels[label], roi->x + run->l, roi->x + run->r, y);
+            run->label = label;
+        }
+
+        // The blobs that have no run on this row are complete; the other runs get their root label.
+        for (int i = 0; i < n; i++) {
+            runs[i].label = find_blobs_rle_find(&rle, runs[i].label);
+            rle.labels[runs[i].label].row = y;
+        }
+
+        int live_n = 0;
+        for (int i = 0; i < rle.live_n; i++) {
+            uint16_t label = rle.live_labels[i];
+            find_blobs_rle_label_t *lp = &rle.labels[label];
+
+            if ((lp->parent == label) && (lp->row == y)) {
+                rle.live_labels[live_n++] = label;
+            } else {
+                if (lp->parent == label) {
+                    find_blobs_rle_emit(&rle, lp);
+                }
+                rle.free_labels[rle.free_n++] = label;
+            }
+        }
+        rle.live_n = live_n;
+
+        find_blobs_rle_run_t *tmp_runs = prev_runs; prev_runs = runs; runs = tmp_runs;
+        prev_n = n;
+    }
+
+    for (int i = 0; i < rle.live_n; i++) {
+        find_blobs_rle_emit(&rle, &rle.labels[rle.live_labels[i]]);
+    }
+
+    for (uint32_t i = 0; i < rle.candidates_n; i++) {
+        list_push_back(out, &rle.candidates[i].blob);
+    }
+
+    fb_free(); // rle
+
+    if (merge) {
+        find_blobs_merge(out, margin, NULL, NULL, 0, 0);
+    }
+
+    return true;
 }
 
 #ifndef STM32IPL
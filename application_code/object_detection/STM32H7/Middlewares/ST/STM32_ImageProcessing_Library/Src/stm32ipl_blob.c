@@ -75,6 +75,54 @@ stm32ipl_err_t STM32Ipl_FindBlobs(const image_t *img, list_t *out, const rectang
 	return stm32ipl_err_Ok;
 }
 
+/**
+ * @brief Finds all blobs (connected pixel regions that pass a color threshold test) in an image
+ * and returns a list of find_blobs_list_lnk_data_t objects which describe each blob found.
+ * Same blobs, in the same order, as STM32Ipl_FindBlobs() with xStride and yStride set to 1, but found
+ * in one pass over the image whatever the number of thresholds: the rows are run-length encoded and
+ * the overlapping runs of consecutive rows joined, so the time only depends on the number of pixels and
+ * runs, not on the size and shape of the blobs. The perimeter and the corners of STM32Ipl_FindBlobs()
+ * depend on the order its flood fill visits the pixels: they are not computed, the perimeter and the
+ * corners of the blobs found are 0. The speed-up only holds without merging: the merge step is the same
+ * as STM32Ipl_FindBlobs() and may dominate, so a search with merging can take about the same time.
+ * The memory used is about 140 bytes per roi column, plus the room for maxBlobs objects.
+ * The supported formats are Binary, Grayscale, RGB565, RGB888.
+ * @param img				Image; if it is not valid, an error is returned.
+ * @param out				List of find_blobs_list_lnk_data_t objects representing the blobs found.
+ * @param roi				Optional region of interest of the source image where the functions operates;
+ * when defined, it must be contained in the source image and have positive dimensions, otherwise
+ * an error is returned; when not defined, the whole image is considered.
+ * @param thresholds		List of color_thresholds_list_lnk_data_t objects. It is possible to pass up to
+ * 32 threshold objects in one call.
+ * @param areaThreshold		Filter out the blobs with bounding box area lesser than areaThreshold.
+ * @param pixelsThreshold	Filter out the blobs with the pixel are lesser than pixelsThreshold.
+ * @param merge				When true, all not filtered out blobs with bounding rectangles intersecting each other are merged.
+ * @param margin			Value used to increase or decrease the size of the bounding rectangles for blobs during the intersection test.
+ * For example, with a margin of one, blobs with bounding rectangles that are one pixel away from each other will be merged.
+ * @param invert			Inverts the thresholding operation such that, instead of matching pixels inside of some known color bounds pixels,
+ * are matched those that are outside of the known color bounds.
+ * @param maxBlobs			Maximum number of blob objects that can be found; it must be a positive number (minimum value is 1).
+ * @return					stm32ipl_err_Ok on success, stm32ipl_err_OutOfMemory when the working memory cannot be allocated.
+ */
+stm32ipl_err_t STM32Ipl_FindBlobsFast(const image_t *img, list_t *out, const rectangle_t *roi, const list_t *thresholds,
+		uint16_t areaThreshold, uint16_t pixelsThreshold, bool merge, uint8_t margin, bool invert, uint32_t maxBlobs)
+{
+	rectangle_t realRoi;
+
+	STM32IPL_CHECK_VALID_IMAGE(img)
+	STM32IPL_CHECK_FORMAT(img, STM32IPL_IF_ALL)
+	STM32IPL_GET_REAL_ROI(img, roi, &realRoi)
+
+	if (!thresholds || !out || (list_size((list_t*)thresholds) == 0))
+		return stm32ipl_err_InvalidParameter;
+
+	if (!imlib_find_blobs_rle(out, (image_t*)img, &realRoi, (list_t*)thresholds, invert, areaThreshold,
+			pixelsThreshold, merge, margin, maxBlobs))
+		return stm32ipl_err_OutOfMemory;
+
+	return stm32ipl_err_Ok;
+}
+
 #ifdef __cplusplus
 }
 #endif
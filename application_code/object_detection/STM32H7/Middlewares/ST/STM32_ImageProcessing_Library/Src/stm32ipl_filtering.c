@@ -16,6 +16,7 @@
  ******************************************************************************
  */
 
+#include <string.h>
 #include "stm32ipl.h"
 #include "stm32ipl_imlib_int.h"
 
@@ -339,6 +340,416 @@ stm32ipl_err_t STM32Ipl_Gaussian(image_t *img, uint8_t kSize, bool threshold, bo
 	return stm32ipl_err_Ok;
 }
 
+/* Reciprocal of a box kernel area: the rounded mean of a sum of 8-bit values is
+ * ((sum + half) * mul) >> shift, exact for any kernel area up to 2^22. */
+typedef struct _boxfilter_div_t
+{
+	uint32_t mul;
+	uint32_t shift;
+	uint32_t half;
+} boxfilter_div_t;
+
+static void boxfilter_div_init(boxfilter_div_t *div, uint32_t area)
+{
+	uint32_t log2Area = 0;
+
+	while ((1UL << log2Area) < area)
+		log2Area++;
+
+	/* (sum + half) < 256 * area <= 2^shift / area keeps the truncation error below 1 / area. */
+	div->shift = 8 + 2 * log2Area;
+	div->mul = (uint32_t) (((1ULL << div->shift) + area - 1) / area);
+	div->half = area / 2;
+}
+
+static inline uint32_t boxfilter_div(const boxfilter_div_t *div, uint32_t sum)
+{
+	return (uint32_t) (((uint64_t) (sum + div->half) * div->mul) >> div->shift);
+}
+
+/* Adds weight times the channels of the image row y to the column sums:
+ * one value per pixel for Grayscale, R5, G6, B5 values for RGB565. */
+static void boxfilter_col_add(uint32_t *colSum, const image_t *img, uint32_t y, uint32_t weight)
+{
+	if (img->bpp == IMAGE_BPP_GRAYSCALE) {
+		const uint8_t *row = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+
+		for (uint32_t x = 0; x < (uint32_t) img->w; x++)
+			colSum[x] += weight * row[x];
+	} else {
+		const uint16_t *row = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+
+		for (uint32_t x = 0; x < (uint32_t) img->w; x++, colSum += 3) {
+			uint32_t pixel = row[x];
+
+			colSum[0] += weight * COLOR_RGB565_TO_R5(pixel);
+			colSum[1] += weight * COLOR_RGB565_TO_G6(pixel);
+			colSum[2] += weight * COLOR_RGB565_TO_B5(pixel);
+		}
+	}
+}
+
+/* Slides the column sums down by one row: adds the row yIn and removes the row yOut. */
+static void boxfilter_col_update(uint32_t *colSum, const image_t *img, uint32_t yIn, uint32_t yOut)
+{
+	if (img->bpp == IMAGE_BPP_GRAYSCALE) {
+		const uint8_t *rowIn = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, yIn);
+		const uint8_t *rowOut = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, yOut);
+
+		for (uint32_t x = 0; x < (uint32_t) img->w; x++)
+			colSum[x] += (uint32_t) rowIn[x] - rowOut[x];
+	} else {
+		const uint16_t *rowIn = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, yIn);
+		const uint16_t *rowOut = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, yOut);
+
+		for (uint32_t x = 0; x < (uint32_t) img->w; x++, colSum += 3) {
+			uint32_t in = rowIn[x];
+			uint32_t out = rowOut[x];
+
+			colSum[0] += COLOR_RGB565_TO_R5(in) - COLOR_RGB565_TO_R5(out);
+			colSum[1] += COLOR_RGB565_TO_G6(in) - COLOR_RGB565_TO_G6(out);
+			colSum[2] += COLOR_RGB565_TO_B5(in) - COLOR_RGB565_TO_B5(out);
+		}
+	}
+}
+
+/* Horizontal running sums of the column sums, written as rounded means to the output row.
+ * colSum is preceded by r + 1 and followed by r copies of the border columns. */
+static void boxfilter_row(const image_t *img, uint32_t *colSum, uint32_t r, const boxfilter_div_t *div,
+		void *out)
+{
+	uint32_t w = img->w;
+
+	if (img->bpp == IMAGE_BPP_GRAYSCALE) {
+		uint32_t *pad = colSum - (r + 1);
+		uint8_t *outRow = out;
+		uint32_t acc = 0;
+
+		for (uint32_t i = 0; i <= r; i++)
+			pad[i] = colSum[0];
+
+		for (uint32_t i = 0; i < r; i++)
+			colSum[w + i] = colSum[w - 1];
+
+		for (uint32_t i = 1; i <= (2 * r + 1); i++)
+			acc += pad[i];
+
+		outRow[0] = boxfilter_div(div, acc);
+
+		for (uint32_t x = 1; x < w; x++) {
+			acc += pad[x + 2 * r + 1] - pad[x];
+			outRow[x] = boxfilter_div(div, acc);
+		}
+	} else {
+		uint32_t *pad = colSum - 3 * (r + 1);
+		uint16_t *outRow = out;
+		uint32_t rAcc = 0;
+		uint32_t gAcc = 0;
+		uint32_t bAcc = 0;
+
+		for (uint32_t i = 0; i <= r; i++)
+			memcpy(pad + 3 * i, colSum, 3 * sizeof(uint32_t));
+
+		for (uint32_t i = 0; i < r; i++)
+			memcpy(colSum + 3 * (w + i), colSum + 3 * (w - 1), 3 * sizeof(uint32_t));
+
+		for (uint32_t i = 1; i <= (2 * r + 1); i++) {
+			rAcc += pad[3 * i];
+			gAcc += pad[3 * i + 1];
+			bAcc += pad[3 * i + 2];
+		}
+
+		outRow[0] = COLOR_R5_G6_B5_TO_RGB565(boxfilter_div(div, rAcc), boxfilter_div(div, gAcc),
+				boxfilter_div(div, bAcc));
+
+		for (uint32_t x = 1; x < w; x++) {
+			const uint32_t *in = pad + 3 * (x + 2 * r + 1);
+			const uint32_t *out = pad + 3 * x;
+
+			rAcc += in[0] - out[0];
+			gAcc += in[1] - out[1];
+			bAcc += in[2] - out[2];
+			outRow[x] = COLOR_R5_G6_B5_TO_RGB565(boxfilter_div(div, rAcc), boxfilter_div(div, gAcc),
+					boxfilter_div(div, bAcc));
+		}
+	}
+}
+
+/* Options applied to the filtered rows, relative to the source image. */
+typedef struct _boxfilter_post_t
+{
+	const image_t *src;
+	const image_t *mask;
+	bool threshold;
+	int32_t offset;
+	bool invert;
+	bool unsharp;
+} boxfilter_post_t;
+
+static inline int32_t boxfilter_unsharp(int32_t src, int32_t blur, int32_t max)
+{
+	int32_t v = 2 * src - blur;
+
+	return (v < 0) ? 0 : ((v > max) ? max : v);
+}
+
+/* Applies unsharp masking, adaptive thresholding and the mask to the filtered row y, as imlib_morph() does. */
+static void boxfilter_post_row(const boxfilter_post_t *post, uint32_t y, void *out)
+{
+	const image_t *src = post->src;
+
+	if (src->bpp == IMAGE_BPP_GRAYSCALE) {
+		const uint8_t *srcRow = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, y);
+		uint8_t *outRow = out;
+
+		for (uint32_t x = 0; x < (uint32_t) src->w; x++) {
+			int32_t pixel = outRow[x];
+
+			if (post->mask && !image_get_mask_pixel((image_t*)post->mask, x, y)) {
+				outRow[x] = srcRow[x];
+				continue;
+			}
+
+			if (post->unsharp)
+				pixel = boxfilter_unsharp(srcRow[x], pixel, COLOR_GRAYSCALE_MAX);
+
+			if (post->threshold) {
+				if (((pixel - post->offset) < srcRow[x]) ^ post->invert)
+					pixel = COLOR_GRAYSCALE_BINARY_MAX;
+				else
+					pixel = COLOR_GRAYSCALE_BINARY_MIN;
+			}
+
+			outRow[x] = pixel;
+		}
+	} else {
+		const uint16_t *srcRow = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, y);
+		uint16_t *outRow = out;
+
+		for (uint32_t x = 0; x < (uint32_t) src->w; x++) {
+			int32_t pixel = outRow[x];
+			int32_t srcPixel = srcRow[x];
+
+			if (post->mask && !image_get_mask_pixel((image_t*)post->mask, x, y)) {
+				outRow[x] = srcPixel;
+				continue;
+			}
+
+			if (post->unsharp)
+				pixel = COLOR_R5_G6_B5_TO_RGB565(
+						boxfilter_unsharp(COLOR_RGB565_TO_R5(srcPixel), COLOR_RGB565_TO_R5(pixel), COLOR_R5_MAX),
+						boxfilter_unsharp(COLOR_RGB565_TO_G6(srcPixel), COLOR_RGB565_TO_G6(pixel), COLOR_G6_MAX),
+						boxfilter_unsharp(COLOR_RGB565_TO_B5(srcPixel), COLOR_RGB565_TO_B5(pixel), COLOR_B5_MAX));
+
+			if (post->threshold) {
+				if (((COLOR_RGB565_TO_Y(pixel) - post->offset) < COLOR_RGB565_TO_Y(srcPixel)) ^ post->invert)
+					pixel = COLOR_RGB565_BINARY_MAX;
+				else
+					pixel = COLOR_RGB565_BINARY_MIN;
+			}
+
+			outRow[x] = pixel;
+		}
+	}
+}
+
+/* In place ((r*2)+1)x((r*2)+1) box filter with replicated borders. The column sums slide down one row
+ * per output row and each output row is a horizontal running sum of them: the cost per pixel does
+ * not depend on r. A filtered row is written back once the source row is out of every window,
+ * so only r + 2 filtered rows are buffered. post can be null. */
+static stm32ipl_err_t boxfilter_apply(image_t *img, uint32_t r, const boxfilter_post_t *post)
+{
+	uint32_t w = img->w;
+	uint32_t h = img->h;
+	uint32_t nbCh = (img->bpp == IMAGE_BPP_GRAYSCALE) ? 1 : 3;
+	uint32_t lineLen = (img->bpp == IMAGE_BPP_GRAYSCALE) ? IMAGE_GRAYSCALE_LINE_LEN_BYTES(img) :
+			IMAGE_RGB565_LINE_LEN_BYTES(img);
+	uint32_t nbRows = r + 2;
+	uint32_t padLen = (w + 2 * r + 1) * nbCh;
+	boxfilter_div_t div;
+	uint32_t *buffer;
+	uint32_t *colSum;
+	uint8_t *rows;
+
+	buffer = xalloc0(padLen * sizeof(uint32_t) + nbRows * lineLen);
+	if (!buffer)
+		return stm32ipl_err_OutOfMemory;
+
+	colSum = buffer + (r + 1) * nbCh;
+	rows = (uint8_t*) (buffer + padLen);
+
+	boxfilter_div_init(&div, (2 * r + 1) * (2 * r + 1));
+
+	/* Window of the first row: the rows above the image replicate the first one. */
+	boxfilter_col_add(colSum, img, 0, r + 1);
+	for (uint32_t j = 1; j <= r; j++)
+		boxfilter_col_add(colSum, img, IM_MIN(j, h - 1), 1);
+
+	for (uint32_t y = 0; y < h; y++) {
+		uint8_t *out = rows + (y % nbRows) * lineLen;
+
+		if (y > 0)
+			boxfilter_col_update(colSum, img, IM_MIN(y + r, h - 1), (y > (r + 1)) ? (y - r - 1) : 0);
+
+		boxfilter_row(img, colSum, r, &div, out);
+
+		if (post)
+			boxfilter_post_row(post, y, out);
+
+		if (y > r) {
+			/* The source row y - r - 1 has left the window: transfer its filtered values. */
+			memcpy(img->data + (y - r - 1) * lineLen, rows + ((y - r - 1) % nbRows) * lineLen, lineLen);
+		}
+	}
+
+	/* Copy the remaining rows from the buffer. */
+	for (uint32_t y = (h > (r + 1)) ? (h - r - 1) : 0; y < h; y++)
+		memcpy(img->data + y * lineLen, rows + (y % nbRows) * lineLen, lineLen);
+
+	xfree(buffer);
+
+	return stm32ipl_err_Ok;
+}
+
+/**
+ * @brief Applies a mean blurring filter to an image, with the same kernel as STM32Ipl_MeanFilter(),
+ * but with running sums: the processing time per pixel does not depend on the kernel size.
+ * The result is the rounded mean of the kernel pixels (per channel for RGB565), while
+ * STM32Ipl_MeanFilter() truncates it. The borders are replicated.
+ * (kSize + 2) image rows and (img->w + 2 * kSize + 1) sums per channel are allocated.
+ * The supported formats are Grayscale, RGB565.
+ * @param img		Image; if it is not valid, an error is returned.
+ * @param kSize		Kernel size; use 1 (3x3 kernel), 2 (5x5 kernel), ..., n (((n*2)+1)x((n*2)+1) kernel).
+ * @param threshold True enables adaptive thresholding of the image, which sets pixels to one or zero
+ * based on a pixel’s brightness in relation to the brightness of the kernel of pixels around them.
+ * @param offset	Negative value sets more pixels to 1 as you make it more negative, while a
+ * positive value only sets the sharpest contrast changes to 1.
+ * @param invert	True inverts the binary image resulting output.
+ * @param mask 		Optional image to be used as a pixel level mask for the operation.
+ * The mask must have the same resolution as the source image. Only the source pixels that
+ * have the corresponding mask pixels set are considered.
+ * The pointer to the mask can be null: in this case all the source image pixels are considered.
+ * @return			stm32ipl_err_Ok on success, error otherwise.
+ */
+stm32ipl_err_t STM32Ipl_BoxFilter(image_t *img, uint8_t kSize, bool threshold, int32_t offset, bool invert,
+		const image_t *mask)
+{
+	boxfilter_post_t post;
+
+	STM32IPL_CHECK_VALID_IMAGE(img)
+	STM32IPL_CHECK_FORMAT(img, stm32ipl_if_grayscale | stm32ipl_if_rgb565)
+
+	if (mask) {
+		STM32IPL_CHECK_VALID_IMAGE(mask)
+		STM32IPL_CHECK_FORMAT(mask, STM32IPL_IF_ALL)
+		STM32IPL_CHECK_SAME_SIZE(img, mask)
+	}
+
+	post.src = img;
+	post.mask = mask;
+	post.threshold = threshold;
+	post.offset = offset;
+	post.invert = invert;
+	post.unsharp = false;
+
+	return boxfilter_apply(img, kSize, (threshold || mask) ? &post : NULL);
+}
+
+/* Radii of three box filters whose cascade has the variance kSize / 2 of the binomial kernel of
+ * STM32Ipl_Gaussian(): the widths are the two odd values around the ideal one, mixed to get the
+ * nearest variance (P. Kovesi, "Fast Almost-Gaussian Filtering", 2010). */
+static void gaussianbox_radii(uint32_t kSize, uint32_t *radii)
+{
+	uint32_t var12 = 6 * kSize;		/* 12 * variance */
+	uint32_t wl = 1;
+	uint32_t num;
+	uint32_t den;
+	uint32_t m;
+
+	while (((wl + 1) * (wl + 1)) <= ((var12 / 3) + 1))
+		wl++;
+
+	if (!(wl & 1))
+		wl--;
+
+	/* Number of boxes of width wl, the others have width wl + 2. */
+	num = 3 * wl * wl + 12 * wl + 9 - var12;
+	den = 4 * wl + 4;
+	m = IM_MIN((2 * num + den) / (2 * den), 3);
+
+	for (uint32_t i = 0; i < 3; i++)
+		radii[i] = ((i < m) ? (wl - 1) : (wl + 1)) / 2;
+}
+
+/**
+ * @brief Convolves the image by an approximation of the Gaussian kernel of STM32Ipl_Gaussian():
+ * three box filters with running sums are cascaded, so the processing time per pixel does not
+ * depend on the kernel size. The kernel has the same variance (kSize / 2) as the binomial one
+ * of STM32Ipl_Gaussian() and the borders are replicated.
+ * Besides the box filter buffers (see STM32Ipl_BoxFilter()), a copy of the image is allocated
+ * when threshold, unsharp or mask are used.
+ * The supported formats are Grayscale, RGB565.
+ * @param img		Image; if it is not valid, an error is returned.
+ * @param kSize		Kernel size; use 1 (3x3 kernel), 2 (5x5 kernel), ..., n (((n*2)+1)x((n*2)+1) kernel).
+ * @param threshold	True enables adaptive thresholding of the image, which sets pixels to one or zero
+ * based on a pixel’s brightness in relation to the brightness of the kernel of pixels around them.
+ * @param unsharp	True improves image sharpness on edges.
+ * @param mask 		Optional image to be used as a pixel level mask for the operation.
+ * The mask must have the same resolution as the source image. Only the source pixels that
+ * have the corresponding mask pixels set are considered.
+ * The pointer to the mask can be null: in this case all the source image pixels are considered.
+ * @return			stm32ipl_err_Ok on success, error otherwise.
+ */
+stm32ipl_err_t STM32Ipl_FastGaussian(image_t *img, uint8_t kSize, bool threshold, bool unsharp, const image_t *mask)
+{
+	boxfilter_post_t post;
+	image_t src;
+	uint32_t radii[3];
+	uint32_t size;
+	stm32ipl_err_t res = stm32ipl_err_Ok;
+
+	STM32IPL_CHECK_VALID_IMAGE(img)
+	STM32IPL_CHECK_FORMAT(img, stm32ipl_if_grayscale | stm32ipl_if_rgb565)
+
+	if (mask) {
+		STM32IPL_CHECK_VALID_IMAGE(mask)
+		STM32IPL_CHECK_FORMAT(mask, STM32IPL_IF_ALL)
+		STM32IPL_CHECK_SAME_SIZE(img, mask)
+	}
+
+	gaussianbox_radii(kSize, radii);
+
+	if (!threshold && !unsharp && !mask) {
+		for (uint32_t i = 0; (i < 3) && (res == stm32ipl_err_Ok); i++)
+			res = boxfilter_apply(img, radii[i], NULL);
+
+		return res;
+	}
+
+	/* The options are relative to the source pixels, that the first passes overwrite. */
+	size = STM32Ipl_ImageDataSize(img);
+	src = *img;
+	src.data = xalloc(size);
+	if (!src.data)
+		return stm32ipl_err_OutOfMemory;
+
+	memcpy(src.data, img->data, size);
+
+	post.src = &src;
+	post.mask = mask;
+	post.threshold = threshold;
+	post.offset = 0;
+	post.invert = false;
+	post.unsharp = unsharp;
+
+	for (uint32_t i = 0; (i < 3) && (res == stm32ipl_err_Ok); i++)
+		res = boxfilter_apply(img, radii[i], (i == 2) ? &post : NULL);
+
+	xfree(src.data);
+
+	return res;
+}
+
 /**
  * @brief Convolves the image by a edge detecting laplacian kernel.
  * The supported formats are Binary, Grayscale, RGB565, RGB888.
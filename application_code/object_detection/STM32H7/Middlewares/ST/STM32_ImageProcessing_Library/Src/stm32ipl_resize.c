@@ -16,9 +16,51 @@
  ******************************************************************************
  */
 
+#include <string.h>
 #include "stm32ipl.h"
 #include "stm32ipl_imlib_int.h"
 
+/* Two 16-bit lanes arithmetic used by the separable resize kernels: Cortex-M DSP instructions
+ * when available, portable C otherwise. */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define RESIZE_SMUAD(x, y)		__SMUAD((x), (y))
+#define RESIZE_SMLAD(x, y, sum)	__SMLAD((x), (y), (sum))
+#define RESIZE_PKHBT(lo, hi)	__PKHBT((lo), (hi), 16)
+#define RESIZE_PKHTB(hi, lo)	__PKHTB((hi), (lo), 16)
+#else
+#define RESIZE_SMUAD(x, y)		((uint32_t)((int32_t)(int16_t)(x) * (int16_t)(y) + \
+									(int32_t)(int16_t)((x) >> 16) * (int16_t)((y) >> 16)))
+#define RESIZE_SMLAD(x, y, sum)	((sum) + RESIZE_SMUAD((x), (y)))
+#define RESIZE_PKHBT(lo, hi)	(((lo) & 0xFFFFUL) | ((hi) << 16))
+#define RESIZE_PKHTB(hi, lo)	(((hi) & 0xFFFF0000UL) | ((lo) >> 16))
+#endif
+
+/* Bilinear weights: Q7 horizontally so that the interpolated rows fit signed 16-bit lanes,
+ * Q11 vertically. */
+#define RESIZE_WX_BITS		7
+#define RESIZE_WY_BITS		11
+#define RESIZE_WX_ONE		(1UL << RESIZE_WX_BITS)
+#define RESIZE_WY_ONE		(1UL << RESIZE_WY_BITS)
+#define RESIZE_BL_SHIFT		(RESIZE_WX_BITS + RESIZE_WY_BITS)
+
+/* Bilinear horizontal tap: the two source columns and their packed weights. */
+typedef struct _resize_tap_t
+{
+	uint16_t x0;
+	uint16_t x1;
+	uint32_t w;		/* (RESIZE_WX_ONE - wx) | (wx << 16) */
+} resize_tap_t;
+
+/* Area horizontal span: the source columns covered by a destination column; their weights
+ * (overlap lengths) are stored from offset in the weight table. */
+typedef struct _resize_span_t
+{
+	uint16_t start;
+	uint16_t count;
+	uint32_t offset;
+} resize_span_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -447,6 +489,479 @@ stm32ipl_err_t STM32Ipl_Downscale_bilinear(const image_t *src, image_t *dst)
 }
 
 
+/* Unaligned 32-bit load. */
+static inline uint32_t resize_load32(const void *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+/* Two RGB565 pixels packed in one word to one word per channel holding the 8-bit values of
+ * both pixels (first pixel in the low lane), with the same bit replication as COLOR_RGB565_TO_x8. */
+static inline void resize_rgb565x2_expand(uint32_t p, uint32_t *r, uint32_t *g, uint32_t *b)
+{
+	uint32_t r5 = (p >> 11) & 0x001F001FUL;
+	uint32_t g6 = (p >> 5) & 0x003F003FUL;
+	uint32_t b5 = p & 0x001F001FUL;
+
+	*r = (r5 << 3) | ((r5 >> 2) & 0x00070007UL);
+	*g = (g6 << 2) | ((g6 >> 4) & 0x00030003UL);
+	*b = (b5 << 3) | ((b5 >> 2) & 0x00070007UL);
+}
+
+/* Number of channels processed by the separable kernels, 0 when the format is not supported. */
+static uint32_t resize_channels(const image_t *img)
+{
+	switch (img->bpp) {
+		case IMAGE_BPP_GRAYSCALE:
+			return 1;
+		case IMAGE_BPP_RGB565:
+		case IMAGE_BPP_RGB888:
+			return 3;
+		default:
+			return 0;
+	}
+}
+
+/* Writes a row of 8-bit channels to the destination image row. */
+static void resize_store_row(const image_t *dst, uint32_t y, const uint8_t *channels)
+{
+	if (dst->bpp == IMAGE_BPP_RGB565) {
+		uint16_t *dstRow = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, y);
+
+		for (uint32_t x = 0; x < (uint32_t) dst->w; x++, channels += 3)
+			dstRow[x] = COLOR_R8_G8_B8_TO_RGB565(channels[0], channels[1], channels[2]);
+	}
+}
+
+/* Center aligned 16.16 source coordinate of the destination index i, clamped to the source.
+ * Returns the 16-bit fractional part, i0 and i1 are the surrounding source indexes. */
+static uint32_t resize_bilinear_coord(int32_t start, int32_t step, uint32_t i, uint32_t size, uint32_t *i0,
+		uint32_t *i1)
+{
+	int32_t s = start + (int32_t) i * step;
+	int32_t sMax = (int32_t) ((size - 1) << 16);
+
+	s = (s < 0) ? 0 : ((s > sMax) ? sMax : s);
+	*i0 = (uint32_t) s >> 16;
+	*i1 = (*i0 + 1 < size) ? *i0 + 1 : *i0;
+
+	return (uint32_t) s & 0xFFFF;
+}
+
+/* Horizontal bilinear pass of a source row: Q7 scaled channels. */
+static void resize_bilinear_row(const image_t *src, uint32_t y, const resize_tap_t *taps, uint32_t dstW,
+		int16_t *out)
+{
+	switch (src->bpp) {
+		case IMAGE_BPP_GRAYSCALE: {
+			const uint8_t *srcRow = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, taps++)
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, srcRow[taps->x0] | ((uint32_t) srcRow[taps->x1] << 16));
+			break;
+		}
+
+		case IMAGE_BPP_RGB565: {
+			const uint16_t *srcRow = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, taps++) {
+				uint32_t r, g, b;
+
+				resize_rgb565x2_expand(srcRow[taps->x0] | ((uint32_t) srcRow[taps->x1] << 16), &r, &g, &b);
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, r);
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, g);
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, b);
+			}
+			break;
+		}
+
+		case IMAGE_BPP_RGB888: {
+			const uint8_t *srcRow = (const uint8_t *) IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, taps++) {
+				const uint8_t *p0 = srcRow + taps->x0 * 3;
+				const uint8_t *p1 = srcRow + taps->x1 * 3;
+
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, p0[0] | ((uint32_t) p1[0] << 16));
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, p0[1] | ((uint32_t) p1[1] << 16));
+				*out++ = (int16_t) RESIZE_SMUAD(taps->w, p0[2] | ((uint32_t) p1[2] << 16));
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+/* Vertical bilinear pass: blends two horizontally interpolated rows (4-byte aligned) with
+ * the Q11 weight wy of the bottom one, two values per iteration. */
+static void resize_bilinear_blend(const int16_t *top, const int16_t *bottom, uint32_t len, uint32_t wy,
+		uint8_t *out)
+{
+	uint32_t w = (RESIZE_WY_ONE - wy) | (wy << 16);
+	uint32_t half = 1UL << (RESIZE_BL_SHIFT - 1);
+	uint32_t i;
+
+	for (i = 0; (i + 1) < len; i += 2) {
+		uint32_t t = resize_load32(top + i);
+		uint32_t b = resize_load32(bottom + i);
+
+		out[i] = (uint8_t) ((RESIZE_SMUAD(w, RESIZE_PKHBT(t, b)) + half) >> RESIZE_BL_SHIFT);
+		out[i + 1] = (uint8_t) ((RESIZE_SMUAD(w, RESIZE_PKHTB(b, t)) + half) >> RESIZE_BL_SHIFT);
+	}
+
+	if (i < len)
+		out[i] = (uint8_t) ((top[i] * (RESIZE_WY_ONE - wy) + bottom[i] * wy + half) >> RESIZE_BL_SHIFT);
+}
+
+/* Vertical bilinear pass of RGB565 images: blends two horizontally interpolated rows of R, G, B
+ * channels and packs each pixel straight to the destination row. */
+static void resize_bilinear_blend_rgb565(const int16_t *top, const int16_t *bottom, uint32_t dstW, uint32_t wy,
+		uint16_t *out)
+{
+	uint32_t w = (RESIZE_WY_ONE - wy) | (wy << 16);
+	uint32_t half = 1UL << (RESIZE_BL_SHIFT - 1);
+
+	for (uint32_t x = 0; x < dstW; x++, top += 3, bottom += 3) {
+		uint32_t r = (RESIZE_SMUAD(w, ((uint16_t) top[0] | ((uint32_t) bottom[0] << 16))) + half) >> RESIZE_BL_SHIFT;
+		uint32_t g = (RESIZE_SMUAD(w, ((uint16_t) top[1] | ((uint32_t) bottom[1] << 16))) + half) >> RESIZE_BL_SHIFT;
+		uint32_t b = (RESIZE_SMUAD(w, ((uint16_t) top[2] | ((uint32_t) bottom[2] << 16))) + half) >> RESIZE_BL_SHIFT;
+
+		*out++ = COLOR_R8_G8_B8_TO_RGB565(r, g, b);
+	}
+}
+
+/**
+ * @brief Resizes the source image to the destination image with a separable, fixed-point Bilinear method.
+ * Pixel centers are aligned (as OpenCV INTER_LINEAR does); the horizontal taps are computed once,
+ * each source row is interpolated horizontally once and kept while it is needed by the next destination row.
+ * The inner loops use the Cortex-M DSP SIMD instructions when available.
+ * The two images must have the same format. The destination image data buffer must be already allocated
+ * by the user and its size must be large enough to contain the resized pixels. Both upscale and downscale
+ * are supported; for large downscale ratios prefer STM32Ipl_Resize_area() that does not alias.
+ * The source width and height must be smaller than 32768.
+ * The supported formats are Grayscale, RGB565, RGB888.
+ * @param src 	Source image; it must be valid, otherwise an error is returned.
+ * @param dst 	Destination image; it must be valid, otherwise an error is returned;
+ * its width and height must be greater than zero.
+ * @return		stm32ipl_err_Ok on success, error otherwise.
+ */
+stm32ipl_err_t STM32Ipl_Resize_bilinear(const image_t *src, image_t *dst)
+{
+	uint32_t channels;
+	uint32_t rowLen;
+	uint32_t rowSize;
+	uint8_t *buffer;
+	resize_tap_t *taps;
+	int16_t *rows[2];
+	int32_t rowsY[2] = { -1, -1 };
+	int32_t xStep;
+	int32_t yStep;
+	int32_t xStart;
+	int32_t yStart;
+
+	STM32IPL_CHECK_VALID_IMAGE(src)
+	STM32IPL_CHECK_VALID_IMAGE(dst)
+	STM32IPL_CHECK_FORMAT(src, stm32ipl_if_grayscale | stm32ipl_if_rgb565 | stm32ipl_if_rgb888)
+	STM32IPL_CHECK_SAME_FORMAT(src, dst)
+
+	if ((src->w < 1) || (src->h < 1) || (dst->w < 1) || (dst->h < 1))
+		return stm32ipl_err_InvalidParameter;
+
+	/* 16.16 source coordinates must fit signed 32 bits. */
+	if ((src->w > INT16_MAX) || (src->h > INT16_MAX))
+		return stm32ipl_err_WrongSize;
+
+	channels = resize_channels(src);
+	rowLen = dst->w * channels;
+	rowSize = ((rowLen * sizeof(int16_t)) + 3) & ~3UL;
+
+	buffer = xalloc(dst->w * sizeof(resize_tap_t) + 2 * rowSize);
+	if (!buffer)
+		return stm32ipl_err_OutOfMemory;
+
+	taps = (resize_tap_t*) buffer;
+	rows[0] = (int16_t*) (buffer + dst->w * sizeof(resize_tap_t));
+	rows[1] = (int16_t*) ((uint8_t*) rows[0] + rowSize);
+
+	xStep = (int32_t) (((uint32_t) src->w << 16) / dst->w);
+	yStep = (int32_t) (((uint32_t) src->h << 16) / dst->h);
+	xStart = xStep / 2 - 0x8000;
+	yStart = yStep / 2 - 0x8000;
+
+	for (uint32_t x = 0; x < (uint32_t) dst->w; x++) {
+		uint32_t x0, x1;
+		uint32_t frac = resize_bilinear_coord(xStart, xStep, x, src->w, &x0, &x1);
+		uint32_t wx = (frac + (1UL << (15 - RESIZE_WX_BITS))) >> (16 - RESIZE_WX_BITS);
+
+		taps[x].x0 = x0;
+		taps[x].x1 = x1;
+		taps[x].w = (RESIZE_WX_ONE - wx) | (wx << 16);
+	}
+
+	for (uint32_t y = 0; y < (uint32_t) dst->h; y++) {
+		uint32_t y0, y1;
+		uint32_t frac = resize_bilinear_coord(yStart, yStep, y, src->h, &y0, &y1);
+		uint32_t wy = (frac + (1UL << (15 - RESIZE_WY_BITS))) >> (16 - RESIZE_WY_BITS);
+
+		/* Moving down, the bottom row of the previous destination row is often the top one of this row. */
+		if (rowsY[0] != (int32_t) y0) {
+			if (rowsY[1] == (int32_t) y0) {
+				int16_t *tmp = rows[0];
+				rows[0] = rows[1];
+				rows[1] = tmp;
+				rowsY[1] = rowsY[0];
+			} else {
+				resize_bilinear_row(src, y0, taps, dst->w, rows[0]);
+			}
+			rowsY[0] = (int32_t) y0;
+		}
+		if (rowsY[1] != (int32_t) y1) {
+			resize_bilinear_row(src, y1, taps, dst->w, rows[1]);
+			rowsY[1] = (int32_t) y1;
+		}
+
+		if (dst->bpp == IMAGE_BPP_RGB565) {
+			resize_bilinear_blend_rgb565(rows[0], rows[1], dst->w, wy, IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, y));
+		} else {
+			resize_bilinear_blend(rows[0], rows[1], rowLen, wy, dst->data + y * rowLen);
+		}
+	}
+
+	xfree(buffer);
+
+	return stm32ipl_err_Ok;
+}
+
+/* Horizontal area pass of a source row: per channel sum of the covered source values weighted by
+ * their overlap, two source pixels per iteration. */
+static void resize_area_row(const image_t *src, uint32_t y, const resize_span_t *spans, const uint16_t *weights,
+		uint32_t dstW, uint32_t *out)
+{
+	switch (src->bpp) {
+		case IMAGE_BPP_GRAYSCALE: {
+			const uint8_t *srcRow = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, spans++) {
+				const uint8_t *s = srcRow + spans->start;
+				const uint16_t *w = weights + spans->offset;
+				uint32_t sum = 0;
+				uint32_t k;
+
+				for (k = 0; (k + 1) < spans->count; k += 2)
+					sum = RESIZE_SMLAD(resize_load32(w + k), s[k] | ((uint32_t) s[k + 1] << 16), sum);
+				if (k < spans->count)
+					sum += w[k] * s[k];
+
+				*out++ = sum;
+			}
+			break;
+		}
+
+		case IMAGE_BPP_RGB565: {
+			const uint16_t *srcRow = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, spans++) {
+				const uint16_t *s = srcRow + spans->start;
+				const uint16_t *w = weights + spans->offset;
+				uint32_t sumR = 0;
+				uint32_t sumG = 0;
+				uint32_t sumB = 0;
+				uint32_t k;
+
+				for (k = 0; (k + 1) < spans->count; k += 2) {
+					uint32_t wk = resize_load32(w + k);
+					uint32_t r, g, b;
+
+					resize_rgb565x2_expand(s[k] | ((uint32_t) s[k + 1] << 16), &r, &g, &b);
+					sumR = RESIZE_SMLAD(wk, r, sumR);
+					sumG = RESIZE_SMLAD(wk, g, sumG);
+					sumB = RESIZE_SMLAD(wk, b, sumB);
+				}
+				if (k < spans->count) {
+					sumR += w[k] * COLOR_RGB565_TO_R8(s[k]);
+					sumG += w[k] * COLOR_RGB565_TO_G8(s[k]);
+					sumB += w[k] * COLOR_RGB565_TO_B8(s[k]);
+				}
+
+				*out++ = sumR;
+				*out++ = sumG;
+				*out++ = sumB;
+			}
+			break;
+		}
+
+		case IMAGE_BPP_RGB888: {
+			const uint8_t *srcRow = (const uint8_t *) IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(src, y);
+
+			for (uint32_t x = 0; x < dstW; x++, spans++) {
+				const uint8_t *s = srcRow + spans->start * 3;
+				const uint16_t *w = weights + spans->offset;
+				uint32_t sum0 = 0;
+				uint32_t sum1 = 0;
+				uint32_t sum2 = 0;
+				uint32_t k;
+
+				for (k = 0; (k + 1) < spans->count; k += 2, s += 6) {
+					uint32_t wk = resize_load32(w + k);
+
+					sum0 = RESIZE_SMLAD(wk, s[0] | ((uint32_t) s[3] << 16), sum0);
+					sum1 = RESIZE_SMLAD(wk, s[1] | ((uint32_t) s[4] << 16), sum1);
+					sum2 = RESIZE_SMLAD(wk, s[2] | ((uint32_t) s[5] << 16), sum2);
+				}
+				if (k < spans->count) {
+					sum0 += w[k] * s[0];
+					sum1 += w[k] * s[1];
+					sum2 += w[k] * s[2];
+				}
+
+				*out++ = sum0;
+				*out++ = sum1;
+				*out++ = sum2;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief Resizes the source image to the destination image with a separable, fixed-point Area (box) method:
+ * each destination pixel is the exact mean of the source area it covers, partially covered pixels being weighted
+ * by their coverage (as OpenCV INTER_AREA does). It is the method of choice for downscaling, as it does not alias.
+ * The horizontal spans are computed once, each source row is summed horizontally once.
+ * The inner loops use the Cortex-M DSP SIMD instructions when available.
+ * The two images must have the same format. The destination image data buffer must be already allocated
+ * by the user and its size must be large enough to contain the resized pixels.
+ * The source image must have less than 2^23 pixels and width and height smaller than 32768.
+ * The supported formats are Grayscale, RGB565, RGB888.
+ * @param src 	Source image; it must be valid, otherwise an error is returned.
+ * @param dst 	Destination image; it must be valid, otherwise an error is returned;
+ * its width and height must be greater than zero and smaller than 32768.
+ * @return		stm32ipl_err_Ok on success, error otherwise.
+ */
+stm32ipl_err_t STM32Ipl_Resize_area(const image_t *src, image_t *dst)
+{
+	uint32_t channels;
+	uint32_t rowLen;
+	uint32_t srcW;
+	uint32_t srcH;
+	uint32_t dstW;
+	uint32_t dstH;
+	uint32_t area;
+	uint32_t nbWeights;
+	uint32_t shift;
+	uint64_t recip;
+	uint8_t *buffer;
+	resize_span_t *spans;
+	uint16_t *weights;
+	uint32_t *hRow;
+	uint32_t *acc;
+	uint8_t *outRow;
+	int32_t hRowY = -1;
+
+	STM32IPL_CHECK_VALID_IMAGE(src)
+	STM32IPL_CHECK_VALID_IMAGE(dst)
+	STM32IPL_CHECK_FORMAT(src, stm32ipl_if_grayscale | stm32ipl_if_rgb565 | stm32ipl_if_rgb888)
+	STM32IPL_CHECK_SAME_FORMAT(src, dst)
+
+	if ((src->w < 1) || (src->h < 1) || (dst->w < 1) || (dst->h < 1))
+		return stm32ipl_err_InvalidParameter;
+
+	srcW = src->w;
+	srcH = src->h;
+	dstW = dst->w;
+	dstH = dst->h;
+	area = srcW * srcH;
+
+	/* Weights (overlaps) must fit signed 16-bit lanes, sums must fit 32 bits. */
+	if ((srcW > INT16_MAX) || (srcH > INT16_MAX) || (dstW > INT16_MAX) || (dstH > INT16_MAX) || (area >= (1UL << 23)))
+		return stm32ipl_err_WrongSize;
+
+	channels = resize_channels(src);
+	rowLen = dstW * channels;
+	nbWeights = srcW + dstW;
+
+	buffer = xalloc(dstW * sizeof(resize_span_t) + 2 * rowLen * sizeof(uint32_t) + nbWeights * sizeof(uint16_t) + rowLen);
+	if (!buffer)
+		return stm32ipl_err_OutOfMemory;
+
+	spans = (resize_span_t*) buffer;
+	hRow = (uint32_t*) (spans + dstW);
+	acc = hRow + rowLen;
+	weights = (uint16_t*) (acc + rowLen);
+	outRow = (uint8_t*) (weights + nbWeights);
+
+	/* Source column i covers [i * dstW, (i + 1) * dstW), destination column x covers [x * srcW, (x + 1) * srcW). */
+	for (uint32_t x = 0, offset = 0; x < dstW; x++) {
+		uint32_t begin = x * srcW;
+		uint32_t end = begin + srcW;
+		uint32_t i = begin / dstW;
+
+		spans[x].start = i;
+		spans[x].offset = offset;
+		for (; i * dstW < end; i++) {
+			uint32_t lo = (i * dstW > begin) ? i * dstW : begin;
+			uint32_t hi = ((i + 1) * dstW < end) ? (i + 1) * dstW : end;
+
+			weights[offset++] = hi - lo;
+		}
+		spans[x].count = offset - spans[x].offset;
+	}
+
+	/* Rounded division by the area as a multiplication: with 2^shift > 256 * area^2 the result is exact. */
+	for (shift = 8; (1ULL << ((shift - 8) / 2)) <= area; shift += 2)
+		;
+	recip = ((1ULL << shift) + area - 1) / area;
+
+	for (uint32_t y = 0; y < dstH; y++) {
+		uint32_t begin = y * srcH;
+		uint32_t end = begin + srcH;
+		uint32_t first = 1;
+
+		for (uint32_t i = begin / dstH; i * dstH < end; i++) {
+			uint32_t lo = (i * dstH > begin) ? i * dstH : begin;
+			uint32_t hi = ((i + 1) * dstH < end) ? (i + 1) * dstH : end;
+			uint32_t wy = hi - lo;
+
+			/* The last source row of a destination row is the first one of the next. */
+			if (hRowY != (int32_t) i) {
+				resize_area_row(src, i, spans, weights, dstW, hRow);
+				hRowY = (int32_t) i;
+			}
+
+			if (first) {
+				for (uint32_t k = 0; k < rowLen; k++)
+					acc[k] = wy * hRow[k];
+				first = 0;
+			} else {
+				for (uint32_t k = 0; k < rowLen; k++)
+					acc[k] += wy * hRow[k];
+			}
+		}
+
+		{
+			uint8_t *out = (dst->bpp == IMAGE_BPP_RGB565) ? outRow : dst->data + y * rowLen;
+
+			for (uint32_t k = 0; k < rowLen; k++)
+				out[k] = (uint8_t) (((uint64_t) (acc[k] + area / 2) * recip) >> shift);
+
+			resize_store_row(dst, y, out);
+		}
+	}
+
+	xfree(buffer);
+
+	return stm32ipl_err_Ok;
+}
+
 
 #ifdef __cplusplus
 }
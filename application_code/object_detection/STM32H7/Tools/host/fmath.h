@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file    fmath.h
+ * @author  MCD Application Team
+ * @brief   Host replacement of the STM32IPL fmath.h, whose inline functions
+ *          use Cortex-M FPU instructions: portable C versions of them
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+#ifndef __FMATH_H__
+#define __FMATH_H__
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <float.h>
+#include "common.h"
+
+float fast_atanf(float x);
+float fast_atan2f(float y, float x);
+float fast_expf(float x);
+float fast_cbrtf(float d);
+float fast_log(float x);
+float fast_log2(float x);
+float fast_powf(float a, float b);
+void fast_get_min_max(float *data, size_t data_len, float *p_min, float *p_max);
+extern const float cos_table[360];
+extern const float sin_table[360];
+
+/* Same results as the vsqrt, vcvt (round toward zero) and vcvtr (round to nearest even) instructions */
+static inline float fast_sqrtf(float x)
+{
+  return sqrtf(x);
+}
+
+static inline int fast_floorf(float x)
+{
+  return (int) x;
+}
+
+static inline int fast_ceilf(float x)
+{
+  return (int) (x + 0.9999f);
+}
+
+static inline int fast_roundf(float x)
+{
+  return (int) nearbyintf(x);
+}
+
+static inline float fast_fabsf(float x)
+{
+  return fabsf(x);
+}
+
+#endif /* __FMATH_H__ */
@@ -0,0 +1,346 @@
+/**
+ ******************************************************************************
+ * @file    preproc_check.c
+ * @author  MCD Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Host check of Preproc_Run, built on the real app_preprocess.c and STM32IPL sources, for RGB,
+ * BGR and grayscale NN inputs in uint8, int8 and float32, on camera frames of random pixels
+ * downscaled to common and odd NN input sizes.
+ * - Nearest against the former chain of Network_Preprocess: STM32Ipl_Downscale to RGB565, then
+ *   the DMA2D RGB565 to RGB888 conversion (red/blue swap for RGB_FORMAT, see UM2611 section 3.2.6)
+ *   or STM32Ipl_ConvertRev to grayscale, then uint8 - 128 for int8. The DMA2D is modelled as the
+ *   reference manual describes its RGB565 expansion: the MSBs are replicated into the LSBs, and
+ *   RGB888 is stored blue first. The tensors must be bit-identical.
+ * - Bilinear, which has no former equivalent, against a per-pixel recomputation of the documented
+ *   interpolation (pixel centers aligned, 8-bit weights, no line buffer): bit-identical. The
+ *   largest difference to an exact interpolation in double precision is reported and bounded.
+ * - float32 against float_scale * pixel + float_offset of the uint8 tensor of the same resize
+ *   mode, for two normalisations: bit-identical.
+ * The program returns 1 on a difference.
+ *
+ * From application_code/object_detection/STM32H7:
+ *   IPL=Middlewares/ST/STM32_ImageProcessing_Library
+ *   APP=Application/STM32H747I-DISCO
+ *   gcc -O2 -DSTM32IPL -include Tools/host/fmath.h -I$IPL/Inc -I$APP/Inc/CM7 -IDrivers/CMSIS/Core/Include \
+ *       -IDrivers/CMSIS/Core/DSP/Include Tools/preproc_check.c $APP/Src/CM7/app_preprocess.c \
+ *       $IPL/Src/stm32ipl_resize.c $IPL/Src/stm32ipl_convert.c $IPL/Src/stm32ipl.c \
+ *       $IPL/Src/stm32ipl_mem_alloc.c $IPL/Src/umm_malloc.c \
+ *       -lm -no-pie -Wl,--unresolved-symbols=ignore-all -o preproc_check && ./preproc_check
+ * (the unresolved symbols belong to STM32IPL functions the harness does not call).
+ */
+#include "stm32ipl.h"
+#include "app_preprocess.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_MAX_SRC     (640 * 480)
+#define CHECK_MAX_DST     (320 * 320)
+#define CHECK_MEM_SIZE    (64 * 1024)
+#define CHECK_SEEDS       4
+/* 8-bit weights: at most 1 / 256 of the full scale per direction away from the exact interpolation */
+#define CHECK_BILINEAR_MAX_DIFF 2
+
+#define CHECK_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define CHECK_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+static const uint32_t color_modes[] = { RGB_FORMAT, BGR_FORMAT, GRAYSCALE_FORMAT };
+static const char *color_names[] = { "", "RGB", "BGR", "gray" };
+static const char *type_names[] = { "", "uint8", "int8", "float32" };
+
+static uint8_t check_mem[CHECK_MEM_SIZE] __attribute__((aligned(8)));
+static uint16_t frame[CHECK_MAX_SRC];
+static uint16_t rescaled[CHECK_MAX_DST];
+static uint8_t ref[CHECK_MAX_DST * 3];
+static uint8_t out_u8[CHECK_MAX_DST * 3];
+static float out_f[CHECK_MAX_DST * 3];
+static uint8_t line_buffer[PREPROC_LINE_BUFFER_SIZE(320)];
+
+/* Random pixels, with a few flat runs so that neighbours are also equal sometimes */
+static void check_fill(uint32_t width, uint32_t height, uint32_t seed)
+{
+  uint16_t pixel = 0;
+
+  srand(seed);
+  for (uint32_t i = 0; i < width * height; i++)
+  {
+    if (rand() % 4)
+    {
+      pixel = (uint16_t) (rand() ^ (rand() << 8));
+    }
+    frame[i] = pixel;
+  }
+}
+
+/* DMA2D RGB565 to RGB888 pixel format conversion: 5 and 6-bit channels expanded by copying their
+ * MSBs into the LSBs, 24-bit pixels stored blue first, red first with the red/blue swap */
+static void check_dma2d_rgb565_to_rgb888(const uint16_t *pSrc, uint8_t *pDst, uint32_t nb_pixels, int rb_swap)
+{
+  for (uint32_t i = 0; i < nb_pixels; i++)
+  {
+    uint32_t r5 = (pSrc[i] >> 11) & 0x1F, g6 = (pSrc[i] >> 5) & 0x3F, b5 = pSrc[i] & 0x1F;
+    uint8_t r8 = (uint8_t) ((r5 << 3) | (r5 >> 2));
+    uint8_t g8 = (uint8_t) ((g6 << 2) | (g6 >> 4));
+    uint8_t b8 = (uint8_t) ((b5 << 3) | (b5 >> 2));
+
+    pDst[3 * i + 0] = rb_swap ? r8 : b8;
+    pDst[3 * i + 1] = g8;
+    pDst[3 * i + 2] = rb_swap ? b8 : r8;
+  }
+}
+
+/* Former Network_Preprocess: ImageResize, PixelFormatConversion and PixelValueConversion */
+static int check_former_chain(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h,
+                              uint32_t color_mode, uint32_t input_type, uint8_t *pOut)
+{
+  image_t src, dst;
+  uint32_t len = dst_w * dst_h * ((color_mode == GRAYSCALE_FORMAT) ? 1 : 3);
+
+  STM32Ipl_Init(&src, src_w, src_h, IMAGE_BPP_RGB565, frame);
+  STM32Ipl_Init(&dst, dst_w, dst_h, IMAGE_BPP_RGB565, rescaled);
+  if (STM32Ipl_Downscale(&src, &dst, 0) != stm32ipl_err_Ok)
+    return 0;
+
+  if (color_mode == GRAYSCALE_FORMAT)
+  {
+    STM32Ipl_Init(&src, dst_w, dst_h, IMAGE_BPP_RGB565, rescaled);
+    STM32Ipl_Init(&dst, dst_w, dst_h, IMAGE_BPP_GRAYSCALE, pOut);
+    if (STM32Ipl_ConvertRev(&src, &dst, 0) != stm32ipl_err_Ok)
+      return 0;
+  }
+  else
+  {
+    check_dma2d_rgb565_to_rgb888(rescaled, pOut, dst_w * dst_h, color_mode == RGB_FORMAT);
+  }
+
+  if (input_type == INT8_FORMAT)
+  {
+    for (uint32_t i = 0; i < len; i++)
+    {
+      pOut[i] = (uint8_t) (int8_t) (((int16_t) pOut[i]) - 128);
+    }
+  }
+
+  return 1;
+}
+
+static void check_expand(uint16_t pixel, uint32_t color_mode, uint8_t *pOut)
+{
+  uint8_t rgb[3];
+
+  check_dma2d_rgb565_to_rgb888(&pixel, rgb, 1, 1);
+  if (color_mode == RGB_FORMAT)
+  {
+    memcpy(pOut, rgb, 3);
+  }
+  else if (color_mode == BGR_FORMAT)
+  {
+    pOut[0] = rgb[2];
+    pOut[1] = rgb[1];
+    pOut[2] = rgb[0];
+  }
+  else
+  {
+    pOut[0] = COLOR_RGB888_TO_Y(rgb[0], rgb[1], rgb[2]);
+  }
+}
+
+/* Source index and 8-bit weight of the next one for output index i, pixel centers aligned */
+static uint32_t check_bilinear_coord(uint32_t i, uint32_t src_size, uint32_t dst_size, uint32_t *w)
+{
+  int32_t step = (int32_t) ((src_size << 16) / dst_size);
+  int32_t s = step / 2 - 0x8000 + (int32_t) i * step;
+
+  s = CHECK_MAX(CHECK_MIN(s, (int32_t) ((src_size - 1) << 16)), 0);
+  *w = (s >> 8) & 0xFF;
+
+  return (uint32_t) s >> 16;
+}
+
+/* Bilinear recomputed pixel by pixel: horizontal then vertical 8-bit weights, rounded once */
+static void check_bilinear_ref(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h,
+                               uint32_t color_mode, uint32_t input_type, uint8_t *pOut)
+{
+  uint32_t channels = (color_mode == GRAYSCALE_FORMAT) ? 1 : 3;
+
+  for (uint32_t y = 0; y < dst_h; y++)
+  {
+    uint32_t wy, y0 = check_bilinear_coord(y, src_h, dst_h, &wy);
+    uint32_t y1 = CHECK_MIN(y0 + 1, src_h - 1);
+
+    for (uint32_t x = 0; x < dst_w; x++)
+    {
+      uint32_t wx, x0 = check_bilinear_coord(x, src_w, dst_w, &wx);
+      uint32_t x1 = CHECK_MIN(x0 + 1, src_w - 1);
+      uint8_t p00[3], p01[3], p10[3], p11[3];
+
+      check_expand(frame[y0 * src_w + x0], color_mode, p00);
+      check_expand(frame[y0 * src_w + x1], color_mode, p01);
+      check_expand(frame[y1 * src_w + x0], color_mode, p10);
+      check_expand(frame[y1 * src_w + x1], color_mode, p11);
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        uint32_t top = p00[c] * (256 - wx) + p01[c] * wx;
+        uint32_t bottom = p10[c] * (256 - wx) + p11[c] * wx;
+        uint32_t v = (top * (256 - wy) + bottom * wy + 0x8000) >> 16;
+
+        pOut[(y * dst_w + x) * channels + c] = (uint8_t) v ^ ((input_type == INT8_FORMAT) ? 0x80 : 0);
+      }
+    }
+  }
+}
+
+/* Largest difference between a uint8 bilinear tensor and the exact interpolation */
+static int32_t check_bilinear_exact_diff(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h,
+                                         uint32_t color_mode, const uint8_t *pTensor)
+{
+  uint32_t channels = (color_mode == GRAYSCALE_FORMAT) ? 1 : 3;
+  int32_t max_diff = 0;
+
+  for (uint32_t y = 0; y < dst_h; y++)
+  {
+    double sy = fmin(fmax((y + 0.5) * src_h / dst_h - 0.5, 0.0), src_h - 1.0);
+    uint32_t y0 = (uint32_t) sy, y1 = CHECK_MIN(y0 + 1, src_h - 1);
+    double fy = sy - y0;
+
+    for (uint32_t x = 0; x < dst_w; x++)
+    {
+      double sx = fmin(fmax((x + 0.5) * src_w / dst_w - 0.5, 0.0), src_w - 1.0);
+      uint32_t x0 = (uint32_t) sx, x1 = CHECK_MIN(x0 + 1, src_w - 1);
+      double fx = sx - x0;
+      uint8_t p00[3], p01[3], p10[3], p11[3];
+
+      check_expand(frame[y0 * src_w + x0], color_mode, p00);
+      check_expand(frame[y0 * src_w + x1], color_mode, p01);
+      check_expand(frame[y1 * src_w + x0], color_mode, p10);
+      check_expand(frame[y1 * src_w + x1], color_mode, p11);
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        double v = (p00[c] * (1 - fx) + p01[c] * fx) * (1 - fy) + (p10[c] * (1 - fx) + p11[c] * fx) * fy;
+        int32_t diff = abs((int32_t) lround(v) - (int32_t) pTensor[(y * dst_w + x) * channels + c]);
+
+        max_diff = CHECK_MAX(max_diff, diff);
+      }
+    }
+  }
+
+  return max_diff;
+}
+
+static int check_run(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h, uint32_t color_mode,
+                     uint32_t input_type, uint32_t resize_mode, float scale, float offset, void *pOut)
+{
+  Preproc_Config_TypeDef cfg = {
+    .src_width = src_w,
+    .src_height = src_h,
+    .dst_width = dst_w,
+    .dst_height = dst_h,
+    .color_mode = color_mode,
+    .input_type = input_type,
+    .resize_mode = resize_mode,
+    .float_scale = scale,
+    .float_offset = offset,
+    .line_buffer = line_buffer,
+  };
+
+  return Preproc_Run(&cfg, frame, pOut) == PREPROC_OK;
+}
+
+int main(void)
+{
+  const uint32_t sizes[][4] = {
+    { 640, 480, 224, 224 }, { 640, 480, 192, 192 }, { 640, 480, 256, 256 }, { 640, 480, 320, 320 },
+    { 480, 480, 224, 224 }, { 640, 480, 320, 240 }, { 640, 480, 101, 77 }, { 333, 211, 97, 53 },
+  };
+  const float norms[][2] = { { 1.0f / 255.0f, 0.0f }, { 1.0f / 127.5f, -1.0f } };
+  int32_t nb_cases = 0, nb_differ = 0, bilinear_max_diff = 0;
+
+  STM32Ipl_InitLib(check_mem, CHECK_MEM_SIZE);
+
+  for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    uint32_t src_w = sizes[s][0], src_h = sizes[s][1], dst_w = sizes[s][2], dst_h = sizes[s][3];
+
+    for (uint32_t m = 0; m < sizeof(color_modes) / sizeof(color_modes[0]); m++)
+    {
+      uint32_t color_mode = color_modes[m];
+      uint32_t len = dst_w * dst_h * ((color_mode == GRAYSCALE_FORMAT) ? 1 : 3);
+      int32_t differ[4] = { 0 }, exact_diff = 0;
+
+      for (uint32_t seed = 1; seed <= CHECK_SEEDS; seed++)
+      {
+        check_fill(src_w, src_h, seed * 7919 + s);
+
+        /* uint8 and int8: nearest against the former chain, bilinear against the recomputation */
+        for (uint32_t t = UINT8_FORMAT; t <= INT8_FORMAT; t++)
+        {
+          if (!check_run(src_w, src_h, dst_w, dst_h, color_mode, t, PP_RESIZE_NEAREST, 0, 0, out_u8) ||
+              !check_former_chain(src_w, src_h, dst_w, dst_h, color_mode, t, ref))
+            return 1;
+          differ[t] |= memcmp(out_u8, ref, len) != 0;
+
+          if (!check_run(src_w, src_h, dst_w, dst_h, color_mode, t, PP_RESIZE_BILINEAR, 0, 0, out_u8))
+            return 1;
+          check_bilinear_ref(src_w, src_h, dst_w, dst_h, color_mode, t, ref);
+          differ[t] |= memcmp(out_u8, ref, len) != 0;
+          if (t == UINT8_FORMAT)
+          {
+            exact_diff = CHECK_MAX(exact_diff, check_bilinear_exact_diff(src_w, src_h, dst_w, dst_h, color_mode, out_u8));
+          }
+        }
+
+        /* float32: the normalised uint8 tensor of the same resize mode */
+        for (uint32_t r = PP_RESIZE_NEAREST; r <= PP_RESIZE_BILINEAR; r++)
+        {
+          if (!check_run(src_w, src_h, dst_w, dst_h, color_mode, UINT8_FORMAT, r, 0, 0, out_u8))
+            return 1;
+          for (uint32_t n = 0; n < sizeof(norms) / sizeof(norms[0]); n++)
+          {
+            if (!check_run(src_w, src_h, dst_w, dst_h, color_mode, FLOAT32_FORMAT, r, norms[n][0], norms[n][1], out_f))
+              return 1;
+            for (uint32_t i = 0; i < len; i++)
+            {
+              float expected = norms[n][0] * (float) out_u8[i] + norms[n][1];
+
+              differ[FLOAT32_FORMAT] |= memcmp(&out_f[i], &expected, sizeof(float)) != 0;
+            }
+          }
+        }
+      }
+
+      printf("%3ux%3u -> %3ux%3u %-4s", (unsigned) src_w, (unsigned) src_h, (unsigned) dst_w, (unsigned) dst_h,
+             color_names[color_mode]);
+      for (uint32_t t = UINT8_FORMAT; t <= FLOAT32_FORMAT; t++)
+      {
+        printf("  %s %s", type_names[t], differ[t] ? "DIFFER" : "ok");
+        nb_differ += differ[t];
+        nb_cases++;
+      }
+      printf("  bilinear vs exact: max diff %d\n", (int) exact_diff);
+      bilinear_max_diff = CHECK_MAX(bilinear_max_diff, exact_diff);
+    }
+  }
+
+  STM32Ipl_DeInitLib();
+
+  printf("%d of %d size/color/type cases differ, bilinear at most %d from the exact interpolation\n",
+         (int) nb_differ, (int) nb_cases, (int) bilinear_max_diff);
+  nb_differ += (bilinear_max_diff > CHECK_BILINEAR_MAX_DIFF);
+  printf("%s\n", nb_differ ? "FAILED" : "OK");
+
+  return nb_differ != 0;
+}
@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ * @file    stm32ipl_blob_bench.c
+ * @author  MCD Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Benchmark of STM32Ipl_FindBlobsFast() against STM32Ipl_FindBlobs() with strides of 1, on synthetic
+ * 320x240 frames of many small objects (disks, rings, stripes and scattered pixels) and on a frame of
+ * large tangled regions, in Grayscale and RGB565, with two overlapping thresholds, with and without merging.
+ * The blob lists must be identical (rectangle, pixels, code, count, centroid, rotation, roundness), and the
+ * corners and perimeter of STM32Ipl_FindBlobsFast(), which it does not compute, must be 0. Timings are the best
+ * of BENCH_RUNS runs on the host and only meaningful relatively to each other; they vary by 10-20% from one run
+ * to the next, so compare the totals per format and merge setting: only the searches without merging are faster.
+ *
+ * From application_code/object_detection/STM32H7:
+ *   IPL=Middlewares/ST/STM32_ImageProcessing_Library
+ *   gcc -O2 -DSTM32IPL -include Tools/host/fmath.h -I$IPL/Inc \
+ *       -IApplication/STM32H747I-DISCO/Inc/CM7 -IDrivers/CMSIS/Core/Include -IDrivers/CMSIS/Core/DSP/Include \
+ *       Tools/stm32ipl_blob_bench.c $IPL/Src/stm32ipl_blob.c $IPL/Src/blob.c $IPL/Src/collections.c \
+ *       $IPL/Src/rectangle.c $IPL/Src/fmath.c $IPL/Src/sincos_tab.c $IPL/Src/lab_tab.c $IPL/Src/xyz_tab.c \
+ *       $IPL/Src/imlib.c $IPL/Src/stm32ipl_rect.c $IPL/Src/stm32ipl.c $IPL/Src/stm32ipl_mem_alloc.c $IPL/Src/umm_malloc.c \
+ *       -lm -no-pie -Wl,--unresolved-symbols=ignore-all -o blob_bench && ./blob_bench
+ * (the unresolved symbols belong to STM32IPL functions the harness does not call; Tools/host/fmath.h
+ * replaces the Cortex-M inline assembly of the library one).
+ */
+#include "stm32ipl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WIDTH       320
+#define BENCH_HEIGHT      240
+#define BENCH_NB_IMAGES   4
+#define BENCH_MEM_SIZE    (2 * 1024 * 1024)
+#define BENCH_MAX_BLOBS   2000
+#define BENCH_RUNS        5
+
+typedef stm32ipl_err_t (*bench_find_t)(const image_t *img, list_t *out, bool merge);
+
+static uint8_t bench_mem[BENCH_MEM_SIZE] __attribute__((aligned(8)));
+static uint32_t bench_seed = 1;
+
+static uint32_t bench_rand(void)
+{
+  bench_seed = bench_seed * 1664525 + 1013904223;
+  return bench_seed >> 8;
+}
+
+/* Gray levels of the objects: the thresholds are [150, 220] and [200, 255] */
+static void bench_synthetic(uint8_t *img, int index)
+{
+  bench_seed = 1 + index * 7919;
+
+  if (index == BENCH_NB_IMAGES - 1)
+  {
+    /* Large regions with holes and thin branches, in two overlapping gray ranges */
+    for (int y = 0; y < BENCH_HEIGHT; y++)
+      for (int x = 0; x < BENCH_WIDTH; x++)
+      {
+        double v = sin(x * 0.11) + sin(y * 0.07) + sin((x + y) * 0.05) + sin((x - 2 * y) * 0.031) +
+                   (bench_rand() % 100) / 80.0 - 0.6;
+        img[y * BENCH_WIDTH + x] = v > 0.4 ? 210 : (v > 0 ? 160 : 60);
+      }
+    return;
+  }
+
+  for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+    img[i] = 40 + bench_rand() % 60;
+
+  for (int i = 0; i < 200 + 200 * index; i++)
+  {
+    int cx = bench_rand() % BENCH_WIDTH, cy = bench_rand() % BENCH_HEIGHT;
+    int r = 1 + bench_rand() % (3 + 3 * index);
+    int in = (bench_rand() % 3) ? r : r / 2;
+    int value = 150 + bench_rand() % 106;
+    int shape = bench_rand() % 4;
+
+    for (int y = cy - r; y <= cy + r; y++)
+      for (int x = cx - r; x <= cx + r; x++)
+      {
+        int d = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        int on = shape == 0 ? d <= r * r : shape == 1 ? (d <= r * r && d >= in * in) :
+                 shape == 2 ? ((x + y) & 2) == 0 : (bench_rand() % 4) == 0;
+
+        if (on && x >= 0 && y >= 0 && x < BENCH_WIDTH && y < BENCH_HEIGHT)
+          img[y * BENCH_WIDTH + x] = value;
+      }
+  }
+}
+
+static list_t bench_thresholds;
+static rectangle_t bench_roi;
+
+static stm32ipl_err_t bench_find(const image_t *img, list_t *out, bool merge)
+{
+  return STM32Ipl_FindBlobs(img, out, &bench_roi, &bench_thresholds, 1, 1, 4, 3, merge, 2, false, BENCH_MAX_BLOBS);
+}
+
+static stm32ipl_err_t bench_find_fast(const image_t *img, list_t *out, bool merge)
+{
+  return STM32Ipl_FindBlobsFast(img, out, &bench_roi, &bench_thresholds, 4, 3, merge, 2, false, BENCH_MAX_BLOBS);
+}
+
+static double bench_run(bench_find_t find, const image_t *img, list_t *out, bool merge)
+{
+  double best = 0;
+
+  for (int run = 0; run < BENCH_RUNS; run++)
+  {
+    struct timespec t0, t1;
+    double ms;
+
+    if (run)
+      list_free(out);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (find(img, out, merge) != stm32ipl_err_Ok)
+    {
+      printf("blob search failed\n");
+      exit(1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+    if (!run || ms < best)
+      best = ms;
+  }
+
+  return best;
+}
+
+/* Returns 1 when the lists are the same, and the corners and perimeter of the blobs of b are 0 */
+static int bench_same(list_t *a, list_t *b)
+{
+  static const point_t no_corners[FIND_BLOBS_CORNERS_RESOLUTION];
+  list_lnk_t *ia, *ib;
+
+  if (list_size(a) != list_size(b))
+    return 0;
+
+  for (ia = iterator_start_from_head(a), ib = iterator_start_from_head(b); ia; ia = iterator_next(ia), ib = iterator_next(ib))
+  {
+    find_blobs_list_lnk_data_t ba, bb;
+
+    iterator_get(a, ia, &ba);
+    iterator_get(b, ib, &bb);
+    if (memcmp(&ba.rect, &bb.rect, sizeof(rectangle_t)) || ba.pixels != bb.pixels || ba.code != bb.code || ba.count != bb.count || ba.centroid_x != bb.centroid_x || ba.centroid_y != bb.centroid_y ||
+        ba.rotation != bb.rotation || ba.roundness != bb.roundness)
+      return 0;
+    if (memcmp(bb.corners, no_corners, sizeof(bb.corners)) || bb.perimeter != 0)
+      return 0;
+  }
+
+  return 1;
+}
+
+int main(void)
+{
+  color_thresholds_list_lnk_data_t th[2] = {
+    { 150, 220, -128, 127, -128, 127 },
+    { 200, 255, -128, 127, -128, 127 },
+  };
+  double total_ref = 0, total_fast = 0;
+  double case_ref[2][2] = { { 0 } }, case_fast[2][2] = { { 0 } };
+  int case_blobs[2][2] = { { 0 } };
+  int failed = 0;
+  uint8_t *gray = malloc(BENCH_WIDTH * BENCH_HEIGHT);
+  uint16_t *rgb565 = malloc(BENCH_WIDTH * BENCH_HEIGHT * 2);
+
+  STM32Ipl_InitLib(bench_mem, BENCH_MEM_SIZE);
+  list_init(&bench_thresholds, sizeof(color_thresholds_list_lnk_data_t));
+  list_push_back(&bench_thresholds, &th[0]);
+  list_push_back(&bench_thresholds, &th[1]);
+
+  printf("image        format     merge  blobs        FindBlobs  FindBlobsFast\n");
+  for (int n = 0; n < BENCH_NB_IMAGES; n++)
+  {
+    bench_synthetic(gray, n);
+    for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+      rgb565[i] = COLOR_R8_G8_B8_TO_RGB565(gray[i], gray[i], gray[i]);
+
+    /* The last image is searched in a region of interest */
+    bench_roi.x = (n == BENCH_NB_IMAGES - 1) ? 17 : 0;
+    bench_roi.y = (n == BENCH_NB_IMAGES - 1) ? 9 : 0;
+    bench_roi.w = BENCH_WIDTH - 2 * bench_roi.x;
+    bench_roi.h = BENCH_HEIGHT - 2 * bench_roi.y;
+
+    for (int f = 0; f < 2; f++)
+    {
+      image_t img;
+
+      STM32Ipl_Init(&img, BENCH_WIDTH, BENCH_HEIGHT, f ? IMAGE_BPP_RGB565 : IMAGE_BPP_GRAYSCALE,
+                    f ? (uint8_t *) rgb565 : gray);
+
+      for (int merge = 0; merge < 2; merge++)
+      {
+        list_t ref, fast;
+
+        /* The Lab lightness of the RGB565 gray levels is on [0, 100] */
+        th[0].LMin = f ? 58 : 150;
+        th[0].LMax = f ? 86 : 220;
+        th[1].LMin = f ? 78 : 200;
+        th[1].LMax = f ? 100 : 255;
+        list_clear(&bench_thresholds);
+        list_push_back(&bench_thresholds, &th[0]);
+        list_push_back(&bench_thresholds, &th[1]);
+
+        double ref_ms = bench_run(bench_find, &img, &ref, merge);
+        double fast_ms = bench_run(bench_find_fast, &img, &fast, merge);
+        int same = bench_same(&ref, &fast);
+
+        printf("synthetic %d  %-10s %-5s %6d %-6s %7.2f ms %11.2f ms\n", n, f ? "RGB565" : "Grayscale",
+               merge ? "yes" : "no", (int) list_size(&ref), same ? "" : "DIFFER", ref_ms, fast_ms);
+        total_ref += ref_ms;
+        total_fast += fast_ms;
+        case_ref[f][merge] += ref_ms;
+        case_fast[f][merge] += fast_ms;
+        case_blobs[f][merge] += (int) list_size(&ref);
+        failed |= !same;
+        list_free(&ref);
+        list_free(&fast);
+      }
+    }
+  }
+
+  for (int f = 0; f < 2; f++)
+  {
+    for (int merge = 0; merge < 2; merge++)
+    {
+      printf("all images   %-10s %-5s %6d        %7.2f ms %11.2f ms (x%.2f)\n", f ? "RGB565" : "Grayscale",
+             merge ? "yes" : "no", case_blobs[f][merge], case_ref[f][merge], case_fast[f][merge],
+             case_ref[f][merge] / case_fast[f][merge]);
+    }
+  }
+  printf("total %39.2f ms %11.2f ms (x%.2f)\n", total_ref, total_fast, total_ref / total_fast);
+  printf("%s\n", failed ? "FAILED: the blobs differ" : "OK");
+
+  list_free(&bench_thresholds);
+  STM32Ipl_DeInitLib();
+  free(gray);
+  free(rgb565);
+
+  return failed;
+}
@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ * @file    stm32ipl_filter_bench.c
+ * @author  MCD Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Benchmark and accuracy harness of the STM32IPL running sum filters on a noisy 640x480 frame,
+ * in Grayscale and RGB565, for growing kernel sizes:
+ * - STM32Ipl_BoxFilter() against the rounded mean of the kernel computed with an integral image
+ *   (max diff must be 0) and against STM32Ipl_MeanFilter(), which truncates the mean;
+ * - STM32Ipl_FastGaussian() against STM32Ipl_Gaussian() (PSNR of the three box approximation);
+ *   kSize stops at 4, as the 16.16 normalization factor of STM32Ipl_Gaussian() underflows from 5.
+ * The differences are those of the channel values of the format (R5, G6, B5 for RGB565).
+ * Timings are those of the host and only meaningful relatively to each other.
+ *
+ * From application_code/object_detection/STM32H7:
+ *   IPL=Middlewares/ST/STM32_ImageProcessing_Library
+ *   gcc -O2 -DSTM32IPL -include Tools/host/fmath.h -I$IPL/Inc -IApplication/STM32H747I-DISCO/Inc/CM7 \
+ *       -IDrivers/CMSIS/Core/Include -IDrivers/CMSIS/Core/DSP/Include Tools/stm32ipl_filter_bench.c \
+ *       $IPL/Src/stm32ipl_filtering.c $IPL/Src/filter.c $IPL/Src/imlib.c $IPL/Src/stm32ipl.c \
+ *       $IPL/Src/stm32ipl_mem_alloc.c $IPL/Src/umm_malloc.c \
+ *       -lm -no-pie -Wl,--unresolved-symbols=ignore-all -o filter_bench && ./filter_bench
+ * (the unresolved symbols belong to STM32IPL functions the harness does not call; Tools/host/fmath.h
+ * replaces the Cortex-M inline assembly of the library one).
+ */
+#include "stm32ipl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WIDTH     640
+#define BENCH_HEIGHT    480
+#define BENCH_MEM_SIZE  (1024 * 1024)
+#define BENCH_RUNS      3
+
+typedef stm32ipl_err_t (*bench_filter_t)(image_t *img, uint8_t kSize);
+
+static uint8_t bench_mem[BENCH_MEM_SIZE] __attribute__((aligned(8)));
+
+static stm32ipl_err_t bench_mean(image_t *img, uint8_t kSize)
+{
+  return STM32Ipl_MeanFilter(img, kSize, false, 0, false, NULL);
+}
+
+static stm32ipl_err_t bench_box(image_t *img, uint8_t kSize)
+{
+  return STM32Ipl_BoxFilter(img, kSize, false, 0, false, NULL);
+}
+
+static stm32ipl_err_t bench_gaussian(image_t *img, uint8_t kSize)
+{
+  return STM32Ipl_Gaussian(img, kSize, false, false, NULL);
+}
+
+static stm32ipl_err_t bench_fast_gaussian(image_t *img, uint8_t kSize)
+{
+  return STM32Ipl_FastGaussian(img, kSize, false, false, NULL);
+}
+
+/* Value of channel c of pixel i, in the bits of the format */
+static int bench_channel(const image_t *img, uint32_t i, uint32_t c)
+{
+  if (img->bpp == IMAGE_BPP_GRAYSCALE)
+    return img->data[i];
+
+  uint16_t p = ((uint16_t *) img->data)[i];
+  return c == 0 ? COLOR_RGB565_TO_R5(p) : (c == 1 ? COLOR_RGB565_TO_G6(p) : COLOR_RGB565_TO_B5(p));
+}
+
+static int bench_channel_max(const image_t *img, uint32_t c)
+{
+  return img->bpp == IMAGE_BPP_GRAYSCALE ? 255 : (c == 1 ? 63 : 31);
+}
+
+static void bench_set(image_t *img, uint32_t i, const int *v)
+{
+  if (img->bpp == IMAGE_BPP_GRAYSCALE)
+    img->data[i] = v[0];
+  else
+    ((uint16_t *) img->data)[i] = COLOR_R5_G6_B5_TO_RGB565(v[0], v[1], v[2]);
+}
+
+/* Smooth gradients and sharp edges with uniform noise, as a low light camera frame */
+static void bench_fill(image_t *img, uint32_t channels)
+{
+  uint32_t seed = 12345;
+
+  for (int y = 0; y < img->h; y++)
+  {
+    for (int x = 0; x < img->w; x++)
+    {
+      double v[3];
+      int q[3];
+
+      v[0] = 127.5 + 100 * cos((x * x + y * y) * M_PI / (8.0 * img->w));
+      v[1] = 255.0 * x / (img->w - 1);
+      v[2] = ((x / 37 + y / 29) & 1) ? 200 : 50;
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        seed = seed * 1664525 + 1013904223;
+        double n = v[c] + ((int) (seed >> 24) - 128) * 0.25;
+        int max = bench_channel_max(img, c);
+        q[c] = (int) fmin(fmax(n * max / 255.0 + 0.5, 0), max);
+      }
+      bench_set(img, y * img->w + x, q);
+    }
+  }
+}
+
+/* Rounded mean of the ((k*2)+1)x((k*2)+1) kernel with replicated borders, from an integral image */
+static void bench_reference(const image_t *src, image_t *ref, int k, uint32_t channels)
+{
+  int w = src->w, h = src->h, iw = w + 2 * k + 1;
+  int64_t *ii = malloc(sizeof(int64_t) * iw * (h + 2 * k + 1));
+  int64_t area = (int64_t) (2 * k + 1) * (2 * k + 1);
+  int v[3];
+
+  for (uint32_t c = 0; c < channels; c++)
+  {
+    for (int y = 0; y <= h + 2 * k; y++)
+    {
+      for (int x = 0; x < iw; x++)
+      {
+        int64_t s = 0;
+        if (x > 0 && y > 0)
+        {
+          int sx = x - 1 - k, sy = y - 1 - k;
+          sx = sx < 0 ? 0 : (sx >= w ? w - 1 : sx);
+          sy = sy < 0 ? 0 : (sy >= h ? h - 1 : sy);
+          s = bench_channel(src, sy * w + sx, c) + ii[(y - 1) * iw + x] + ii[y * iw + x - 1] - ii[(y - 1) * iw + x - 1];
+        }
+        ii[y * iw + x] = s;
+      }
+    }
+    for (int y = 0; y < h; y++)
+    {
+      for (int x = 0; x < w; x++)
+      {
+        int x1 = x + 2 * k + 1, y1 = y + 2 * k + 1;
+        int64_t s = ii[y1 * iw + x1] - ii[y * iw + x1] - ii[y1 * iw + x] + ii[y * iw + x];
+        int64_t q = (s + area / 2) / area;
+        if (channels == 1)
+          ref->data[y * w + x] = q;
+        else
+        {
+          /* Merge the channel into the pixel computed so far */
+          uint16_t *p = (uint16_t *) ref->data + y * w + x;
+          v[0] = c == 0 ? q : COLOR_RGB565_TO_R5(*p);
+          v[1] = c == 1 ? q : COLOR_RGB565_TO_G6(*p);
+          v[2] = c == 2 ? q : COLOR_RGB565_TO_B5(*p);
+          *p = COLOR_R5_G6_B5_TO_RGB565(v[0], v[1], v[2]);
+        }
+      }
+    }
+  }
+  free(ii);
+}
+
+static double bench_psnr(const image_t *a, const image_t *b, uint32_t channels, int *max_diff)
+{
+  double se = 0;
+
+  *max_diff = 0;
+  for (int i = 0; i < a->w * a->h; i++)
+  {
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      int d = bench_channel(a, i, c) - bench_channel(b, i, c);
+      double e = d * 255.0 / bench_channel_max(a, c);
+      se += e * e;
+      *max_diff = abs(d) > *max_diff ? abs(d) : *max_diff;
+    }
+  }
+  se /= (double) a->w * a->h * channels;
+
+  return se == 0 ? INFINITY : 10 * log10(255.0 * 255.0 / se);
+}
+
+/* Best time of BENCH_RUNS runs, the output is left in dst */
+static double bench_run(bench_filter_t filter, const image_t *src, image_t *dst, uint8_t kSize, size_t size)
+{
+  double best = INFINITY;
+
+  for (int r = 0; r < BENCH_RUNS; r++)
+  {
+    struct timespec t0, t1;
+
+    memcpy(dst->data, src->data, size);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (filter(dst, kSize) != stm32ipl_err_Ok)
+    {
+      printf("  filter failed\n");
+      exit(1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    best = fmin(best, (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+  }
+
+  return best;
+}
+
+int main(void)
+{
+  const struct { image_bpp_t bpp; const char *name; uint32_t channels; } formats[] = {
+    { IMAGE_BPP_GRAYSCALE, "Grayscale", 1 },
+    { IMAGE_BPP_RGB565, "RGB565", 3 },
+  };
+  const uint8_t boxSizes[] = { 1, 2, 4, 8, 16, 32 };
+  const uint8_t gaussianSizes[] = { 1, 2, 3, 4 };
+  int failed = 0;
+
+  STM32Ipl_InitLib(bench_mem, BENCH_MEM_SIZE);
+
+  for (uint32_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+  {
+    size_t size = BENCH_WIDTH * BENCH_HEIGHT * (formats[f].channels == 1 ? 1 : 2);
+    image_t src, a, b, ref;
+
+    STM32Ipl_Init(&src, BENCH_WIDTH, BENCH_HEIGHT, formats[f].bpp, malloc(size));
+    STM32Ipl_Init(&a, BENCH_WIDTH, BENCH_HEIGHT, formats[f].bpp, malloc(size));
+    STM32Ipl_Init(&b, BENCH_WIDTH, BENCH_HEIGHT, formats[f].bpp, malloc(size));
+    STM32Ipl_Init(&ref, BENCH_WIDTH, BENCH_HEIGHT, formats[f].bpp, malloc(size));
+    bench_fill(&src, formats[f].channels);
+
+    printf("%s %dx%d, mean filter\n", formats[f].name, src.w, src.h);
+    printf("  kSize   MeanFilter    BoxFilter   vs reference   vs MeanFilter\n");
+    for (uint32_t k = 0; k < sizeof(boxSizes) / sizeof(boxSizes[0]); k++)
+    {
+      int ref_diff, mean_diff;
+      double mean_ms = bench_run(bench_mean, &src, &a, boxSizes[k], size);
+      double box_ms = bench_run(bench_box, &src, &b, boxSizes[k], size);
+
+      bench_reference(&src, &ref, boxSizes[k], formats[f].channels);
+      bench_psnr(&b, &ref, formats[f].channels, &ref_diff);
+      bench_psnr(&b, &a, formats[f].channels, &mean_diff);
+      printf("  %5d %9.2f ms %9.2f ms   max diff %3d   max diff %3d\n", boxSizes[k], mean_ms, box_ms, ref_diff,
+             mean_diff);
+      failed |= ref_diff != 0;
+    }
+
+    printf("%s %dx%d, Gaussian\n", formats[f].name, src.w, src.h);
+    printf("  kSize     Gaussian FastGaussian   vs Gaussian\n");
+    for (uint32_t k = 0; k < sizeof(gaussianSizes) / sizeof(gaussianSizes[0]); k++)
+    {
+      int max_diff;
+      double gaussian_ms = bench_run(bench_gaussian, &src, &a, gaussianSizes[k], size);
+      double fast_ms = bench_run(bench_fast_gaussian, &src, &b, gaussianSizes[k], size);
+      double psnr = bench_psnr(&b, &a, formats[f].channels, &max_diff);
+
+      printf("  %5d %9.2f ms %9.2f ms   PSNR %6.2f dB  max diff %3d\n", gaussianSizes[k], gaussian_ms, fast_ms, psnr,
+             max_diff);
+    }
+
+    free(src.data);
+    free(a.data);
+    free(b.data);
+    free(ref.data);
+  }
+
+  STM32Ipl_DeInitLib();
+
+  printf("%s\n", failed ? "FAILED: BoxFilter differs from the reference" : "OK");
+
+  return failed;
+}
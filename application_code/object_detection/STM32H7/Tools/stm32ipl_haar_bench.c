@@ -0,0 +1,273 @@
+/**
+ ******************************************************************************
+ * @file    stm32ipl_haar_bench.c
+ * @author  MCD Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Benchmark of STM32Ipl_DetectObjectFast() against STM32Ipl_DetectObject() with the frontal face and
+ * eye cascades, on a fixed image set: the detections must be identical, only the time changes.
+ * The image set is the list of binary PGM (P5) files given as arguments or, when there is none,
+ * BENCH_NB_IMAGES synthetic 640x480 frames of drawn faces at several sizes over a textured, noisy
+ * background. Each image is processed in Grayscale and in RGB565.
+ * Timings are the best of BENCH_RUNS runs on the host and only meaningful relatively to each other.
+ *
+ * From application_code/object_detection/STM32H7:
+ *   IPL=Middlewares/ST/STM32_ImageProcessing_Library
+ *   gcc -O2 -DSTM32IPL -DSTM32IPL_ENABLE_OBJECT_DETECTION -DSTM32IPL_ENABLE_FRONTAL_FACE_CASCADE \
+ *       -DSTM32IPL_ENABLE_EYE_CASCADE -include Tools/host/fmath.h -I$IPL/Inc \
+ *       -IApplication/STM32H747I-DISCO/Inc/CM7 -IDrivers/CMSIS/Core/Include -IDrivers/CMSIS/Core/DSP/Include \
+ *       Tools/stm32ipl_haar_bench.c $IPL/Src/stm32ipl_object_det.c $IPL/Src/haar.c $IPL/Src/integral_mw.c \
+ *       $IPL/Src/rectangle.c $IPL/Src/stm32ipl_rect.c $IPL/Src/array.c $IPL/Src/imlib.c $IPL/Src/stm32ipl.c \
+ *       $IPL/Src/stm32ipl_mem_alloc.c $IPL/Src/umm_malloc.c \
+ *       -lm -no-pie -Wl,--unresolved-symbols=ignore-all -o haar_bench && ./haar_bench
+ * (the unresolved symbols belong to STM32IPL functions the harness does not call; Tools/host/fmath.h
+ * replaces the Cortex-M inline assembly of the library one).
+ */
+#include "stm32ipl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WIDTH       640
+#define BENCH_HEIGHT      480
+#define BENCH_NB_IMAGES   4
+#define BENCH_MEM_SIZE    (2 * 1024 * 1024)
+#define BENCH_SCALE       1.25f
+#define BENCH_THRESHOLD   0.5f
+#define BENCH_RUNS        5
+
+typedef stm32ipl_err_t (*bench_detect_t)(const image_t *img, array_t **out, const rectangle_t *roi,
+                                         cascade_t *cascade, float scaleFactor, float threshold);
+
+static uint8_t bench_mem[BENCH_MEM_SIZE] __attribute__((aligned(8)));
+static uint32_t bench_seed = 1;
+
+static uint32_t bench_rand(void)
+{
+  bench_seed = bench_seed * 1664525 + 1013904223;
+  return bench_seed >> 8;
+}
+
+static void bench_ellipse(uint8_t *img, int cx, int cy, int rx, int ry, int value)
+{
+  for (int y = cy - ry; y <= cy + ry; y++)
+  {
+    for (int x = cx - rx; x <= cx + rx; x++)
+    {
+      double dx = (double) (x - cx) / rx, dy = (double) (y - cy) / ry;
+      if (x >= 0 && y >= 0 && x < BENCH_WIDTH && y < BENCH_HEIGHT && dx * dx + dy * dy <= 1.0)
+        img[y * BENCH_WIDTH + x] = value;
+    }
+  }
+}
+
+/* Face of height 2 * r centered on (cx, cy): skin oval, eyebrows, eyes, nose shadow and mouth */
+static void bench_face(uint8_t *img, int cx, int cy, int r, int skin)
+{
+  bench_ellipse(img, cx, cy, r * 3 / 4, r, skin);
+  bench_ellipse(img, cx - r * 3 / 8, cy - r * 3 / 8, r / 5, r / 14 + 1, skin / 3);
+  bench_ellipse(img, cx + r * 3 / 8, cy - r * 3 / 8, r / 5, r / 14 + 1, skin / 3);
+  bench_ellipse(img, cx - r * 3 / 8, cy - r / 5, r / 6, r / 10 + 1, skin / 4);
+  bench_ellipse(img, cx + r * 3 / 8, cy - r / 5, r / 6, r / 10 + 1, skin / 4);
+  bench_ellipse(img, cx, cy + r / 6, r / 10 + 1, r / 5, skin * 3 / 4);
+  bench_ellipse(img, cx, cy + r / 2, r / 3, r / 12 + 1, skin / 3);
+}
+
+/* 3x3 mean, applied twice, to soften the drawing as a camera would */
+static void bench_blur(uint8_t *img)
+{
+  uint8_t *tmp = malloc(BENCH_WIDTH * BENCH_HEIGHT);
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    memcpy(tmp, img, BENCH_WIDTH * BENCH_HEIGHT);
+    for (int y = 1; y < BENCH_HEIGHT - 1; y++)
+      for (int x = 1; x < BENCH_WIDTH - 1; x++)
+      {
+        int s = 0;
+        for (int j = -1; j <= 1; j++)
+          for (int i = -1; i <= 1; i++)
+            s += tmp[(y + j) * BENCH_WIDTH + x + i];
+        img[y * BENCH_WIDTH + x] = s / 9;
+      }
+  }
+  free(tmp);
+}
+
+static void bench_synthetic(uint8_t *img, int index)
+{
+  bench_seed = 1 + index * 7919;
+
+  for (int y = 0; y < BENCH_HEIGHT; y++)
+    for (int x = 0; x < BENCH_WIDTH; x++)
+      img[y * BENCH_WIDTH + x] = (uint8_t) (90 + 50 * sin(x * (0.01 + 0.01 * index)) * cos(y * 0.013) +
+                                            (((x / 53 + y / 41 + index) & 1) ? 25 : 0));
+
+  for (int i = 0; i < 3 + index; i++)
+  {
+    int r = 20 + bench_rand() % 90;
+    bench_face(img, r + bench_rand() % (BENCH_WIDTH - 2 * r), r + bench_rand() % (BENCH_HEIGHT - 2 * r), r,
+               170 + bench_rand() % 70);
+  }
+  bench_blur(img);
+
+  for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+  {
+    int v = img[i] + (int) (bench_rand() % 17) - 8;
+    img[i] = v < 0 ? 0 : (v > 255 ? 255 : v);
+  }
+}
+
+/* Loads a binary PGM, resized (nearest) to BENCH_WIDTH x BENCH_HEIGHT */
+static int bench_load_pgm(const char *path, uint8_t *img)
+{
+  FILE *f = fopen(path, "rb");
+  int w, h, max;
+
+  if (!f || fscanf(f, "P5 %d %d %d", &w, &h, &max) != 3 || max > 255)
+  {
+    if (f)
+      fclose(f);
+    return -1;
+  }
+  fgetc(f);
+
+  uint8_t *data = malloc(w * h);
+  int ok = fread(data, 1, w * h, f) == (size_t) (w * h);
+  fclose(f);
+  for (int y = 0; ok && y < BENCH_HEIGHT; y++)
+    for (int x = 0; x < BENCH_WIDTH; x++)
+      img[y * BENCH_WIDTH + x] = data[(y * h / BENCH_HEIGHT) * w + x * w / BENCH_WIDTH];
+  free(data);
+
+  return ok ? 0 : -1;
+}
+
+static double bench_detect(bench_detect_t detect, const image_t *img, cascade_t *cascade, array_t **out)
+{
+  double best = 0;
+
+  for (int run = 0; run < BENCH_RUNS; run++)
+  {
+    struct timespec t0, t1;
+    double ms;
+
+    if (run)
+      array_free(*out);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (detect(img, out, NULL, cascade, BENCH_SCALE, BENCH_THRESHOLD) != stm32ipl_err_Ok)
+    {
+      printf("detection failed\n");
+      exit(1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+    if (!run || ms < best)
+      best = ms;
+  }
+
+  return best;
+}
+
+static int bench_same(array_t *a, array_t *b)
+{
+  if (array_length(a) != array_length(b))
+    return 0;
+
+  for (int i = 0; i < array_length(a); i++)
+    if (memcmp(array_at(a, i), array_at(b, i), sizeof(rectangle_t)))
+      return 0;
+
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  const struct { const char *name; stm32ipl_err_t (*load)(cascade_t *); } cascades[] = {
+    { "face", STM32Ipl_LoadFaceCascade },
+    { "eye", STM32Ipl_LoadEyeCascade },
+  };
+  int nb_images = argc > 1 ? argc - 1 : BENCH_NB_IMAGES;
+  double total_ref = 0, total_fast = 0;
+  int failed = 0;
+  uint8_t *gray = malloc(BENCH_WIDTH * BENCH_HEIGHT);
+  uint16_t *rgb565 = malloc(BENCH_WIDTH * BENCH_HEIGHT * 2);
+
+  STM32Ipl_InitLib(bench_mem, BENCH_MEM_SIZE);
+
+  printf("image          format     cascade  detections   DetectObject  DetectObjectFast\n");
+  for (int n = 0; n < nb_images; n++)
+  {
+    char name[32];
+
+    if (argc > 1)
+    {
+      if (bench_load_pgm(argv[n + 1], gray))
+      {
+        printf("cannot read %s\n", argv[n + 1]);
+        return 1;
+      }
+      snprintf(name, sizeof(name), "%.14s", strrchr(argv[n + 1], '/') ? strrchr(argv[n + 1], '/') + 1 : argv[n + 1]);
+    }
+    else
+    {
+      bench_synthetic(gray, n);
+      snprintf(name, sizeof(name), "synthetic %d", n);
+    }
+
+    for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+      rgb565[i] = COLOR_R8_G8_B8_TO_RGB565(gray[i], gray[i], gray[i]);
+
+    for (int f = 0; f < 2; f++)
+    {
+      image_t img;
+
+      STM32Ipl_Init(&img, BENCH_WIDTH, BENCH_HEIGHT, f ? IMAGE_BPP_RGB565 : IMAGE_BPP_GRAYSCALE,
+                    f ? (uint8_t *) rgb565 : gray);
+
+      for (uint32_t c = 0; c < sizeof(cascades) / sizeof(cascades[0]); c++)
+      {
+        cascade_t cascade;
+        array_t *ref, *fast;
+
+        cascades[c].load(&cascade);
+        double ref_ms = bench_detect(STM32Ipl_DetectObject, &img, &cascade, &ref);
+        double fast_ms = bench_detect(STM32Ipl_DetectObjectFast, &img, &cascade, &fast);
+        int same = bench_same(ref, fast);
+
+        printf("%-14s %-10s %-8s %4d %-7s %9.1f ms %14.1f ms\n", name, f ? "RGB565" : "Grayscale", cascades[c].name,
+               array_length(ref), same ? "" : "DIFFER", ref_ms, fast_ms);
+        total_ref += ref_ms;
+        total_fast += fast_ms;
+        failed |= !same;
+        array_free(ref);
+        array_free(fast);
+      }
+    }
+  }
+
+  printf("total %49.1f ms %14.1f ms (x%.2f)\n", total_ref, total_fast, total_ref / total_fast);
+  printf("%s\n", failed ? "FAILED: the detections differ" : "OK");
+
+  STM32Ipl_DeInitLib();
+  free(gray);
+  free(rgb565);
+
+  return failed;
+}
@@ -0,0 +1,226 @@
+/**
+ ******************************************************************************
+ * @file    stm32ipl_resize_bench.c
+ * @author  MCD Application Team
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2019 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Benchmark and PSNR harness of the STM32IPL resize functions for 640x480 camera frames
+ * downscaled to common NN input sizes, in Grayscale, RGB565 and RGB888.
+ * The reference is the exact area mean of the source, computed in double precision:
+ * STM32Ipl_Resize_area() must match it (max diff 0), the other methods show their aliasing.
+ * The test frame mixes smooth gradients, sharp edges and a zone plate, the worst case for aliasing.
+ * Timings are the best of BENCH_RUNS runs on the host and only meaningful relatively to each other.
+ *
+ * From application_code/object_detection/STM32H7:
+ *   IPL=Middlewares/ST/STM32_ImageProcessing_Library
+ *   gcc -O2 -DSTM32IPL -I$IPL/Inc -IApplication/STM32H747I-DISCO/Inc/CM7 -IDrivers/CMSIS/Core/Include \
+ *       -IDrivers/CMSIS/Core/DSP/Include Tools/stm32ipl_resize_bench.c $IPL/Src/stm32ipl_resize.c \
+ *       $IPL/Src/stm32ipl.c $IPL/Src/stm32ipl_mem_alloc.c $IPL/Src/umm_malloc.c \
+ *       -lm -no-pie -Wl,--unresolved-symbols=ignore-all -o resize_bench && ./resize_bench
+ * (the unresolved symbols belong to STM32IPL functions the harness does not call).
+ */
+#include "stm32ipl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SRC_WIDTH   640
+#define BENCH_SRC_HEIGHT  480
+#define BENCH_MEM_SIZE    (256 * 1024)
+#define BENCH_RUNS        200
+
+typedef stm32ipl_err_t (*bench_resize_t)(const image_t *src, image_t *dst);
+
+typedef struct
+{
+  const char *name;
+  bench_resize_t resize;
+} bench_method_t;
+
+static uint8_t bench_mem[BENCH_MEM_SIZE] __attribute__((aligned(8)));
+
+static stm32ipl_err_t bench_nearest(const image_t *src, image_t *dst)
+{
+  return STM32Ipl_Downscale(src, dst, false);
+}
+
+/* 8-bit value of channel c of pixel i */
+static uint8_t bench_channel(const image_t *img, uint32_t i, uint32_t c)
+{
+  switch (img->bpp)
+  {
+    case IMAGE_BPP_GRAYSCALE:
+      return img->data[i];
+    case IMAGE_BPP_RGB565:
+    {
+      uint16_t p = ((uint16_t *) img->data)[i];
+      return c == 0 ? COLOR_RGB565_TO_R8(p) : (c == 1 ? COLOR_RGB565_TO_G8(p) : COLOR_RGB565_TO_B8(p));
+    }
+    default:
+      return img->data[3 * i + c];
+  }
+}
+
+static void bench_set(image_t *img, uint32_t i, const uint8_t *v)
+{
+  switch (img->bpp)
+  {
+    case IMAGE_BPP_GRAYSCALE:
+      img->data[i] = v[0];
+      break;
+    case IMAGE_BPP_RGB565:
+      ((uint16_t *) img->data)[i] = COLOR_R8_G8_B8_TO_RGB565(v[0], v[1], v[2]);
+      break;
+    default:
+      memcpy(img->data + 3 * i, v, 3);
+      break;
+  }
+}
+
+static void bench_fill(image_t *img)
+{
+  for (int y = 0; y < img->h; y++)
+  {
+    for (int x = 0; x < img->w; x++)
+    {
+      double dx = x - img->w / 2.0, dy = y - img->h / 2.0;
+      uint8_t v[3];
+
+      v[0] = (uint8_t) (127.5 + 127.5 * cos((dx * dx + dy * dy) * M_PI / (2.0 * img->w)));
+      v[1] = (uint8_t) (255 * x / (img->w - 1));
+      v[2] = ((x / 37 + y / 29) & 1) ? 230 : 20;
+      bench_set(img, y * img->w + x, v);
+    }
+  }
+}
+
+/* Exact area mean, the channels of the source format then quantized as the destination format */
+static void bench_reference(const image_t *src, image_t *ref, uint32_t channels)
+{
+  double sx = (double) src->w / ref->w, sy = (double) src->h / ref->h;
+
+  for (int y = 0; y < ref->h; y++)
+  {
+    for (int x = 0; x < ref->w; x++)
+    {
+      uint8_t v[3];
+
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        double sum = 0;
+
+        for (int j = (int) floor(y * sy); j < src->h && j < (y + 1) * sy; j++)
+        {
+          double wy = fmin(j + 1, (y + 1) * sy) - fmax(j, y * sy);
+          for (int i = (int) floor(x * sx); i < src->w && i < (x + 1) * sx; i++)
+          {
+            double wx = fmin(i + 1, (x + 1) * sx) - fmax(i, x * sx);
+            sum += wx * wy * bench_channel(src, j * src->w + i, c);
+          }
+        }
+        v[c] = (uint8_t) floor(sum / (sx * sy) + 0.5 + 1e-9);
+      }
+      bench_set(ref, y * ref->w + x, v);
+    }
+  }
+}
+
+static double bench_psnr(const image_t *a, const image_t *b, uint32_t channels, int *max_diff)
+{
+  double se = 0;
+
+  *max_diff = 0;
+  for (int i = 0; i < a->w * a->h; i++)
+  {
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      int d = bench_channel(a, i, c) - bench_channel(b, i, c);
+      se += d * d;
+      *max_diff = abs(d) > *max_diff ? abs(d) : *max_diff;
+    }
+  }
+  se /= (double) a->w * a->h * channels;
+
+  return se == 0 ? INFINITY : 10 * log10(255.0 * 255.0 / se);
+}
+
+int main(void)
+{
+  const bench_method_t methods[] = {
+    { "nearest (Downscale)", bench_nearest },
+    { "float bilinear (Downscale_bilinear)", STM32Ipl_Downscale_bilinear },
+    { "bilinear (Resize_bilinear)", STM32Ipl_Resize_bilinear },
+    { "area (Resize_area)", STM32Ipl_Resize_area },
+  };
+  const struct { image_bpp_t bpp; const char *name; uint32_t channels; } formats[] = {
+    { IMAGE_BPP_GRAYSCALE, "Grayscale", 1 },
+    { IMAGE_BPP_RGB565, "RGB565", 3 },
+    { IMAGE_BPP_RGB888, "RGB888", 3 },
+  };
+  const int sizes[][2] = { { 224, 224 }, { 256, 256 }, { 320, 240 }, { 320, 320 } };
+
+  STM32Ipl_InitLib(bench_mem, BENCH_MEM_SIZE);
+
+  for (uint32_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+  {
+    image_t src, dst, ref;
+
+    STM32Ipl_Init(&src, BENCH_SRC_WIDTH, BENCH_SRC_HEIGHT, formats[f].bpp, malloc(BENCH_SRC_WIDTH * BENCH_SRC_HEIGHT * 3));
+    bench_fill(&src);
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      STM32Ipl_Init(&dst, sizes[s][0], sizes[s][1], formats[f].bpp, malloc(sizes[s][0] * sizes[s][1] * 3));
+      STM32Ipl_Init(&ref, sizes[s][0], sizes[s][1], formats[f].bpp, malloc(sizes[s][0] * sizes[s][1] * 3));
+      bench_reference(&src, &ref, formats[f].channels);
+
+      printf("%s %dx%d -> %dx%d\n", formats[f].name, src.w, src.h, dst.w, dst.h);
+      for (uint32_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+      {
+        int max_diff;
+        double us = 0;
+
+        for (int run = 0; run < BENCH_RUNS; run++)
+        {
+          struct timespec t0, t1;
+          double t;
+
+          clock_gettime(CLOCK_MONOTONIC, &t0);
+          if (methods[m].resize(&src, &dst) != stm32ipl_err_Ok)
+          {
+            printf("  %s failed\n", methods[m].name);
+            return 1;
+          }
+          clock_gettime(CLOCK_MONOTONIC, &t1);
+
+          t = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+          if (!run || t < us)
+            us = t;
+        }
+        double psnr = bench_psnr(&dst, &ref, formats[f].channels, &max_diff);
+        printf("  %-36s %8.1f us  PSNR %6.2f dB  max diff %3d\n", methods[m].name, us, psnr, max_diff);
+      }
+      free(dst.data);
+      free(ref.data);
+    }
+    free(src.data);
+  }
+
+  STM32Ipl_DeInitLib();
+
+  return 0;
+}
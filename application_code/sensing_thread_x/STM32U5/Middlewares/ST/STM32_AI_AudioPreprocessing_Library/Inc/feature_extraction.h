@@ -125,6 +125,34 @@ typedef struct
   float32_t *pScratch;                       /*!< points to the temporary calculation buffer of length NumMels */
 } MfccTypeDef;
 
+/**
+ * @brief Instance structure for the fixed-point Log-MelSpectrogram function.
+ *        Set pRfft, pWindow, pCoefficients and the scratch buffers, the other fields are set by Init
+ *        from the floating-point Log-MelSpectrogram configuration.
+ */
+typedef struct
+{
+  arm_rfft_instance_q31 *pRfft;              /*!< points to the q31 real FFT instance */
+  q31_t *pWindow;                            /*!< points to the q31 window function of length FrameLen */
+  q31_t *pCoefficients;                      /*!< points to the q31 mel filter weights, same length as the float ones */
+  uint32_t *pStartIndices;                   /*!< points to the mel filter start indexes */
+  uint32_t *pStopIndices;                    /*!< points to the mel filter stop indexes */
+  uint32_t NumMels;                          /*!< number of Mel bands */
+  Spectrogram_TypeTypedef Type;              /*!< spectrum type */
+  LogMelSpectrogram_ScaleTypedef LogFormula; /*!< returned mel energy scale (dB or Log) */
+  uint32_t FrameLen;                         /*!< length of the input signal. */
+  uint32_t FFTLen;                           /*!< length of the real FFT. */
+  uint32_t pad_left;                         /*!< zero padding on the left of the window . */
+  uint32_t pad_right;                        /*!< zero padding on the right of the window . */
+  uint32_t BandBits;                         /*!< bits of the spectrum in a mel band, leaving the accumulation headroom */
+  int32_t Log2Offset;                        /*!< log2 (Q16) of the mel energy scaling: weights scaling, FFT length and Ref */
+  int32_t Log2Min;                           /*!< lowest log2 (Q16) mel energy: -TopdB when dB scaled is used */
+  int32_t OutScale;                          /*!< log2 (Q16) to output quantization step (Q16) */
+  int32_t OutOffset;                         /*!< output quantization offset */
+  q31_t *pScratch1;                          /*!< points to a temporary calculation buffer of length FFTLen */
+  q31_t *pScratch2;                          /*!< points to a temporary calculation buffer of length 2 * FFTLen */
+} LogMelSpectrogramFixedTypeDef;
+
 /* Utilities */
 void buf_to_float(int16_t *pInSignal, float32_t *pOutSignal, uint32_t len);
 void buf_to_float_normed(int16_t *pInSignal, float32_t *pOutSignal, uint32_t len);
@@ -136,6 +164,17 @@ void LogMelSpectrogramColumn(LogMelSpectrogramTypeDef *S, float32_t *pInSignal,
 void LogMelSpectrogramColumn_q15_Q8(LogMelSpectrogramTypeDef *S, int16_t *pInSignal, int8_t *pOutCol,int8_t offset,float32_t inv_scale);
 void MfccColumn(MfccTypeDef *S, float32_t *pInSignal, float32_t *pOutCol);
 
+/* Multi-column calculation functions, (mel x time) output */
+void LogMelSpectrogram_q15_Q8(LogMelSpectrogramTypeDef *S, int16_t *pInSignal, uint32_t HopLen, uint32_t NumCols,
+                              int8_t *pOutSpectro, uint32_t OutStride, int8_t offset, float32_t inv_scale);
+
+/* Fixed-point functions */
+int32_t LogMelSpectrogramFixed_Init(LogMelSpectrogramFixedTypeDef *S, LogMelSpectrogramTypeDef *pConf);
+void LogMelSpectrogramFixed_SetQuantization(LogMelSpectrogramFixedTypeDef *S, int8_t offset, float32_t inv_scale);
+void LogMelSpectrogramFixedColumn_q15_Q8(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, int8_t *pOutCol);
+void LogMelSpectrogramFixed_q15_Q8(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, uint32_t HopLen,
+                                   uint32_t NumCols, int8_t *pOutSpectro, uint32_t OutStride);
+
 /**
  * @} end of groupFeature
  */
@@ -24,6 +24,25 @@
 
 #define NORM_Q15  (1.0F/32768.0F)
 
+#define LOG2_FLT_MIN_Q16  (-126 * 65536) /*!< log2(FLT_MIN), floor of the log of a null mel energy */
+
+/* log2(1 + i / 32) in Q16 */
+static const int32_t log2_q16_table[33] = {
+       0,   2909,   5732,   8473,  11136,  13727,  16248,  18704,
+   21098,  23433,  25711,  27936,  30109,  32234,  34312,  36346,
+   38336,  40286,  42196,  44068,  45904,  47705,  49472,  51207,
+   52911,  54584,  56229,  57845,  59434,  60997,  62534,  64047,
+   65536,
+};
+
+static void LogMelSpectrogramFixedColumn(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, int8_t *pOutCol,
+                                        uint32_t OutStride);
+static __INLINE uint32_t clz64(uint64_t x);
+static __INLINE int32_t log2_q16(uint64_t x);
+static __INLINE uint32_t sqrt_u64(uint64_t x);
+static __INLINE uint64_t power_q31(q31_t *pBin);
+static __INLINE int8_t quantize_log2_q16(LogMelSpectrogramFixedTypeDef *S, int32_t log2_mel);
+
 /**
  * @defgroup groupFeature Feature Extraction
  * @brief Spectral feature extraction functions
@@ -284,6 +303,99 @@ void LogMelSpectrogramColumn_q15_Q8(LogMelSpectrogramTypeDef *S, int16_t *pInSig
   }
 }
 
+/**
+ * @brief      Quantized Log-Mel Spectrogram of consecutive columns
+ *
+ * Same output as NumCols calls of LogMelSpectrogramColumn_q15_Q8 on frames HopLen samples
+ * apart, written in the (mel x time) layout: the window is applied while converting the
+ * samples, the spectrum is computed in one pass over the FFT bins and the scaling, log,
+ * threshold and quantization are done in the pass over the mel bands.
+ *
+ * @param      *S           points to an instance of the floating-point Log-Mel structure.
+ * @param      *pInSignal   points to the input signal, of length (NumCols - 1) * HopLen + FrameLen.
+ * @param      HopLen       number of samples between two columns.
+ * @param      NumCols      number of columns to compute.
+ * @param      *pOutSpectro points to the first output column: mel band i of column j is
+ *                          written at pOutSpectro[i * OutStride + j].
+ * @param      OutStride    length of an output row, typ. the number of columns of the spectrogram.
+ * @param      offset       output zero point.
+ * @param      inv_scale    inverse of the output quantization step.
+ * @return     None
+ */
+void LogMelSpectrogram_q15_Q8(LogMelSpectrogramTypeDef *S, int16_t *pInSignal, uint32_t HopLen, uint32_t NumCols,
+                              int8_t *pOutSpectro, uint32_t OutStride, int8_t offset, float32_t inv_scale)
+{
+  SpectrogramTypeDef *p_spectro = S->MelSpectrogramConf->SpectrogramConf;
+  MelFilterTypeDef *p_mel       = S->MelSpectrogramConf->MelFilter;
+  float32_t *p_in               = p_spectro->pScratch1 + p_spectro->pad_left;
+  float32_t *p_bins             = p_spectro->pScratch2;
+  uint32_t frame_len            = p_spectro->FrameLen;
+  uint32_t n_bins               = p_spectro->FFTLen / 2;
+  uint32_t is_magnitude         = (p_spectro->Type == SPECTRUM_TYPE_MAGNITUDE);
+  uint32_t is_db                = (S->LogFormula == LOGMELSPECTROGRAM_SCALE_DB);
+  float32_t ref                 = S->Ref;
+  float32_t top_dB              = S->TopdB;
+
+  for (uint32_t col = 0; col < NumCols; col++)
+  {
+    int16_t *p_frame   = pInSignal + col * HopLen;
+    float32_t *p_coefs = p_mel->pCoefficients;
+    float32_t last_energy;
+
+    /* Zero pad left and right, the FFT input is modified by each column */
+    memset(p_spectro->pScratch1, 0, p_spectro->pad_left * sizeof(*p_in));
+    memset(p_in + frame_len, 0, p_spectro->pad_right * sizeof(*p_in));
+
+    /* Scaled and windowed input signal */
+    for (uint32_t i = 0; i < frame_len; i++)
+    {
+      p_in[i] = ((float32_t)p_frame[i] * NORM_Q15) * p_spectro->pWindow[i];
+    }
+
+    arm_rfft_fast_f32(p_spectro->pRfft, p_spectro->pScratch1, p_bins, 0);
+
+    /* Power or magnitude spectrum, in place: bin k only depends on the FFT outputs 2k and 2k+1 */
+    last_energy = p_bins[1] * p_bins[1];
+    p_bins[0]   = p_bins[0] * p_bins[0];
+    for (uint32_t k = 1; k < n_bins; k++)
+    {
+      p_bins[k] = p_bins[2 * k] * p_bins[2 * k] + p_bins[2 * k + 1] * p_bins[2 * k + 1];
+    }
+    p_bins[n_bins] = last_energy;
+    if (is_magnitude)
+    {
+      for (uint32_t k = 0; k <= n_bins; k++)
+      {
+        arm_sqrt_f32(p_bins[k], &p_bins[k]);
+        p_spectro->spectro_sum += p_bins[k];
+      }
+    }
+
+    /* Mel Filter Banks Application, scaling, log, threshold and quantization */
+    for (uint32_t i = 0; i < p_mel->NumMels; i++)
+    {
+      float32_t mel = 0.0f;
+
+      for (uint32_t j = p_mel->pStartIndices[i]; j <= p_mel->pStopIndices[i]; j++)
+      {
+        mel += p_bins[j] * (*p_coefs++);
+      }
+      mel /= ref;
+      mel = (mel <= 0.0f) ? FLT_MIN : mel;
+      if (is_db)
+      {
+        mel = 10.0f * log10f(mel);
+        mel = (mel < -top_dB) ? (-top_dB) : mel;
+      }
+      else
+      {
+        mel = logf(mel);
+      }
+      pOutSpectro[i * OutStride + col] = (int8_t)__SSAT((int32_t)roundf(mel * inv_scale + (float) offset), 8);
+    }
+  }
+}
+
 /**
  * @brief      Mel-Frequency Cepstral Coefficients (MFCCs) column
  *
@@ -302,6 +414,312 @@ void MfccColumn(MfccTypeDef *S, float32_t *pInSignal, float32_t *pOutCol)
   DCT(S->pDCT, tmp_buffer, pOutCol);
 }
 
+/**
+ * @brief      Fixed-point Log-Mel Spectrogram initialization
+ *
+ * Converts the window and the mel filter weights of the floating-point configuration to
+ * the pWindow and pCoefficients buffers, and initializes the q31 real FFT.
+ * The output quantization is then set by LogMelSpectrogramFixed_SetQuantization.
+ *
+ * @param      *S          points to an instance of the fixed-point Log-Mel structure.
+ * @param      *pConf      points to the floating-point Log-Mel configuration to reproduce.
+ * @return     0 if successful or -1 if there is an error.
+ */
+int32_t LogMelSpectrogramFixed_Init(LogMelSpectrogramFixedTypeDef *S, LogMelSpectrogramTypeDef *pConf)
+{
+  SpectrogramTypeDef *p_spectro = pConf->MelSpectrogramConf->SpectrogramConf;
+  MelFilterTypeDef *p_mel       = pConf->MelSpectrogramConf->MelFilter;
+  uint32_t n_coefs              = 0;
+  uint32_t max_width            = 0;
+  float32_t max_coef            = 0.0f;
+  float32_t log2_min;
+  int32_t coef_exp;
+
+  S->pStartIndices = p_mel->pStartIndices;
+  S->pStopIndices  = p_mel->pStopIndices;
+  S->NumMels       = p_mel->NumMels;
+  S->Type          = p_spectro->Type;
+  S->LogFormula    = pConf->LogFormula;
+  S->FrameLen      = p_spectro->FrameLen;
+  S->FFTLen        = p_spectro->FFTLen;
+  S->pad_left      = p_spectro->pad_left;
+  S->pad_right     = p_spectro->pad_right;
+
+  if (arm_rfft_init_q31(S->pRfft, S->FFTLen, 0, 1) != ARM_MATH_SUCCESS)
+  {
+    return -1;
+  }
+
+  /* q31 window: a q15 one leaves a leakage floor about 96 dB below the peak of a column */
+  for (uint32_t i = 0; i < S->FrameLen; i++)
+  {
+    int64_t w = (int64_t)roundf(ldexpf(p_spectro->pWindow[i], 31));
+    S->pWindow[i] = (q31_t)((w > INT32_MAX) ? INT32_MAX : ((w < INT32_MIN) ? INT32_MIN : w));
+  }
+
+  for (uint32_t i = 0; i < S->NumMels; i++)
+  {
+    if (S->pStartIndices[i] <= S->pStopIndices[i])
+    {
+      uint32_t width = S->pStopIndices[i] - S->pStartIndices[i] + 1;
+      n_coefs += width;
+      max_width = (width > max_width) ? width : max_width;
+    }
+  }
+  for (uint32_t i = 0; i < n_coefs; i++)
+  {
+    max_coef = (p_mel->pCoefficients[i] > max_coef) ? p_mel->pCoefficients[i] : max_coef;
+  }
+  if (max_coef <= 0.0f)
+  {
+    return -1;
+  }
+
+  /* Weights scaled by 2^coef_exp: the largest one in [0.5, 1) */
+  (void)frexpf(max_coef, &coef_exp);
+  coef_exp = -coef_exp;
+  for (uint32_t i = 0; i < n_coefs; i++)
+  {
+    int64_t coef = (int64_t)roundf(ldexpf(p_mel->pCoefficients[i], 31 + coef_exp));
+    S->pCoefficients[i] = (q31_t)((coef > INT32_MAX) ? INT32_MAX : ((coef < 0) ? 0 : coef));
+  }
+
+  /* Weights below 1.0 and spectrum below 2^BandBits: a band sum fits in 64 bits */
+  S->BandBits = 33U - (32U - __CLZ(max_width));
+
+  S->Log2Offset = (31 + coef_exp) * 65536 + (int32_t)roundf(log2f(pConf->Ref) * 65536.0f);
+
+  /* The q31 RFFT output is downscaled by FFTLen */
+  S->Log2Offset -= (int32_t)((31U - __CLZ(S->FFTLen)) << 16) * ((S->Type == SPECTRUM_TYPE_POWER) ? 2 : 1);
+
+  S->Log2Min = INT32_MIN;
+  if (S->LogFormula == LOGMELSPECTROGRAM_SCALE_DB)
+  {
+    log2_min = -pConf->TopdB / (10.0f * log10f(2.0f)) * 65536.0f;
+    S->Log2Min = (log2_min > (float32_t)LOG2_FLT_MIN_Q16) ? (int32_t)log2_min : INT32_MIN;
+  }
+
+  LogMelSpectrogramFixed_SetQuantization(S, 0, 1.0f);
+
+  return 0;
+}
+
+/**
+ * @brief      Fixed-point Log-Mel Spectrogram output quantization
+ *
+ * @param      *S          points to an instance of the fixed-point Log-Mel structure.
+ * @param      offset      output zero point.
+ * @param      inv_scale   inverse of the output quantization step.
+ */
+void LogMelSpectrogramFixed_SetQuantization(LogMelSpectrogramFixedTypeDef *S, int8_t offset, float32_t inv_scale)
+{
+  float32_t log2_unit = (S->LogFormula == LOGMELSPECTROGRAM_SCALE_DB) ? (10.0f * log10f(2.0f)) : logf(2.0f);
+
+  S->OutScale  = (int32_t)roundf(inv_scale * log2_unit * 65536.0f);
+  S->OutOffset = offset;
+}
+
+/**
+ * @brief      Fixed-point Log-Mel Spectrogram column
+ *
+ * Integer equivalent of LogMelSpectrogramColumn_q15_Q8, within one output step:
+ * the windowed frame is scaled to the full q31 range before the q31 RFFT (block floating
+ * point), each mel band is accumulated in 64 bits on its spectrum scaled to BandBits, and
+ * the log is a table interpolation of log2.
+ *
+ * @param      *S          points to an instance of the fixed-point Log-Mel structure.
+ * @param      *pInSignal  points to input signal frame of length FrameLen.
+ * @param      *pOutCol    points to the quantized output Log-Mel Spectrogram column.
+ * @return     None
+ */
+void LogMelSpectrogramFixedColumn_q15_Q8(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, int8_t *pOutCol)
+{
+  LogMelSpectrogramFixedColumn(S, pInSignal, pOutCol, 1U);
+}
+
+/**
+ * @brief      Fixed-point quantized Log-Mel Spectrogram of consecutive columns
+ *
+ * Same output as NumCols calls of LogMelSpectrogramFixedColumn_q15_Q8 on frames HopLen
+ * samples apart, written in the (mel x time) layout.
+ *
+ * @param      *S           points to an instance of the fixed-point Log-Mel structure.
+ * @param      *pInSignal   points to the input signal, of length (NumCols - 1) * HopLen + FrameLen.
+ * @param      HopLen       number of samples between two columns.
+ * @param      NumCols      number of columns to compute.
+ * @param      *pOutSpectro points to the first output column: mel band i of column j is
+ *                          written at pOutSpectro[i * OutStride + j].
+ * @param      OutStride    length of an output row, typ. the number of columns of the spectrogram.
+ * @return     None
+ */
+void LogMelSpectrogramFixed_q15_Q8(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, uint32_t HopLen,
+                                   uint32_t NumCols, int8_t *pOutSpectro, uint32_t OutStride)
+{
+  for (uint32_t col = 0; col < NumCols; col++)
+  {
+    LogMelSpectrogramFixedColumn(S, pInSignal + col * HopLen, pOutSpectro + col, OutStride);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/* Fixed-point Log-Mel Spectrogram column, mel band i written at pOutCol[i * OutStride] */
+static void LogMelSpectrogramFixedColumn(LogMelSpectrogramFixedTypeDef *S, int16_t *pInSignal, int8_t *pOutCol,
+                                        uint32_t OutStride)
+{
+  q31_t *p_in         = S->pScratch1 + S->pad_left;
+  q31_t *p_fft        = S->pScratch2;
+  uint32_t *p_mag     = (uint32_t *)S->pScratch1;
+  q31_t *p_coefs      = S->pCoefficients;
+  uint32_t frame_len  = S->FrameLen;
+  uint32_t n_fft      = S->FFTLen;
+  uint32_t is_power   = (S->Type == SPECTRUM_TYPE_POWER);
+  uint32_t max_abs    = 0;
+  uint32_t in_shift;
+  int32_t col_exp;
+
+  /* Zero pad left and right */
+  memset(S->pScratch1, 0, S->pad_left * sizeof(*p_in));
+  memset(p_in + frame_len, 0, S->pad_right * sizeof(*p_in));
+
+  /* Window: q15 x q31 in Q30 */
+  for (uint32_t i = 0; i < frame_len; i++)
+  {
+    q31_t x = (q31_t)(((int64_t)pInSignal[i] * S->pWindow[i]) >> 16);
+    p_in[i] = x;
+    max_abs |= (uint32_t)((x < 0) ? -x : x);
+  }
+
+  if (max_abs == 0U)
+  {
+    for (uint32_t i = 0; i < S->NumMels; i++)
+    {
+      pOutCol[i * OutStride] = quantize_log2_q16(S, LOG2_FLT_MIN_Q16);
+    }
+    return;
+  }
+
+  /* Block floating point: the frame in full scale, i.e. 2^(in_shift-1) in q31 */
+  in_shift = __CLZ(max_abs) - 1U;
+  for (uint32_t i = 0; i < frame_len; i++)
+  {
+    p_in[i] = (q31_t)((uint32_t)p_in[i] << in_shift);
+  }
+
+  arm_rfft_q31(S->pRfft, S->pScratch1, p_fft);
+
+  /* Exponent of the bin powers (Q62) or magnitudes (Q31) */
+  if (is_power)
+  {
+    col_exp = 62 + 2 * ((int32_t)in_shift - 1);
+  }
+  else
+  {
+    col_exp = 31 + ((int32_t)in_shift - 1);
+    for (uint32_t k = 0; k <= n_fft / 2; k++)
+    {
+      p_mag[k] = sqrt_u64(power_q31(&p_fft[2 * k]));
+    }
+  }
+
+  /* Mel Filter Banks Application, each band scaled to its largest bin */
+  for (uint32_t i = 0; i < S->NumMels; i++)
+  {
+    uint32_t start_idx = S->pStartIndices[i];
+    uint32_t stop_idx  = S->pStopIndices[i];
+    int32_t log2_mel   = LOG2_FLT_MIN_Q16;
+    uint64_t bins      = 0;
+    uint64_t sum       = 0;
+    uint32_t shift;
+
+    if ((start_idx > stop_idx) || (stop_idx > n_fft / 2))
+    {
+      pOutCol[i * OutStride] = quantize_log2_q16(S, log2_mel);
+      continue;
+    }
+
+    for (uint32_t j = start_idx; j <= stop_idx; j++)
+    {
+      bins |= is_power ? power_q31(&p_fft[2 * j]) : p_mag[j];
+    }
+    shift = 64U - clz64(bins | 1U);
+    shift = (shift > S->BandBits) ? (shift - S->BandBits) : 0U;
+
+    for (uint32_t j = start_idx; j <= stop_idx; j++)
+    {
+      uint64_t bin = is_power ? power_q31(&p_fft[2 * j]) : p_mag[j];
+      sum += (uint64_t)(uint32_t)(*p_coefs++) * (uint32_t)(bin >> shift);
+    }
+
+    if (sum != 0U)
+    {
+      log2_mel = log2_q16(sum) - S->Log2Offset - (col_exp - (int32_t)shift) * 65536;
+    }
+    pOutCol[i * OutStride] = quantize_log2_q16(S, log2_mel);
+  }
+}
+
+static __INLINE uint32_t clz64(uint64_t x)
+{
+  uint32_t high = (uint32_t)(x >> 32);
+
+  return (high != 0U) ? __CLZ(high) : (32U + __CLZ((uint32_t)x));
+}
+
+/* log2 of a non-null x in Q16, within 2e-4 */
+static __INLINE int32_t log2_q16(uint64_t x)
+{
+  uint32_t msb  = 63U - clz64(x);
+  uint32_t mant = (uint32_t)((x << (63U - msb)) >> 32); /* 1.31 in [1, 2) */
+  uint32_t idx  = (mant >> 26) & 31U;
+  uint32_t frac = (mant >> 10) & 0xFFFFU;
+  int32_t low   = log2_q16_table[idx];
+
+  return (int32_t)(msb << 16) + low + (int32_t)(((uint32_t)(log2_q16_table[idx + 1] - low) * frac) >> 16);
+}
+
+/* sqrt of a power, 16-bit accurate: two Newton steps from a linear guess */
+static __INLINE uint32_t sqrt_u64(uint64_t x)
+{
+  uint32_t norm;
+  uint32_t y;
+  uint32_t s;
+
+  if (x == 0U)
+  {
+    return 0U;
+  }
+  norm = clz64(x) & ~1U;
+  y    = (uint32_t)((x << norm) >> 32);                   /* [2^30, 2^32) */
+  s    = (1UL << 15) + ((y - (1UL << 30)) >> 17) + ((y - (1UL << 30)) >> 19);
+  s    = (s + y / s) >> 1;
+  s    = (s + y / s) >> 1;
+  s    = (s > 0xFFFFU) ? 0xFFFFU : s;                     /* sqrt(y) in [2^15, 2^16) */
+  norm >>= 1;
+
+  return (norm <= 16U) ? (s << (16U - norm)) : (s >> (norm - 16U));
+}
+
+/* Power of a q31 bin in Q62 */
+static __INLINE uint64_t power_q31(q31_t *pBin)
+{
+  int64_t re = pBin[0];
+  int64_t im = pBin[1];
+
+  return (uint64_t)(re * re) + (uint64_t)(im * im);
+}
+
+/* round(log(mel) * inv_scale + offset), from log2(mel) in Q16 */
+static __INLINE int8_t quantize_log2_q16(LogMelSpectrogramFixedTypeDef *S, int32_t log2_mel)
+{
+  int64_t q;
+
+  log2_mel = (log2_mel > S->Log2Min) ? log2_mel : S->Log2Min;
+  q = (int64_t)log2_mel * S->OutScale + (int64_t)S->OutOffset * 4294967296LL + (1LL << 31);
+
+  return (int8_t)__SSAT((int32_t)(q >> 32), 8);
+}
+
 /**
  * @} end of groupFeature
  */
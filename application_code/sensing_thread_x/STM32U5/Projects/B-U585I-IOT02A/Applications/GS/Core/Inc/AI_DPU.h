@@ -110,6 +110,12 @@ struct _AI_DPU_t {
    */
   float input_Q_inv_scale;
   int   input_Q_offset;
+
+  /**
+   * Specifies if the network outputs are written directly in the DPU output data.
+   * It is set when the model is loaded, if each output has only channel elements.
+   */
+  bool outputs_in_place;
 };
 
 
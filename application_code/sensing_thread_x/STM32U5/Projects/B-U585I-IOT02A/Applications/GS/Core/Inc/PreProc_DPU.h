@@ -62,8 +62,43 @@ struct _PreProc_DPU {
   DCT_InstanceTypeDef        S_DCT;
   MfccTypeDef                S_Mfcc;
 
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U)
+  /**
+   * Integer Log-Mel Spectrogram, converted from the floating-point configuration by PreProc_DPUInit.
+   */
+  arm_rfft_instance_q31          S_RfftQ31;
+  LogMelSpectrogramFixedTypeDef  S_LogMelFixed;
+
+  q31_t pWindowQ31[CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH];
+  q31_t pMelCoefficientsQ31[sizeof(CTRL_X_CUBE_AI_SPECTROGRAM_MEL_LUT)/sizeof(float32_t)];
+  q31_t pFixedScratchBuffer1[CTRL_X_CUBE_AI_SPECTROGRAM_NFFT];
+  q31_t pFixedScratchBuffer2[2*CTRL_X_CUBE_AI_SPECTROGRAM_NFFT];
+#else
   float32_t pSpectrScratchBuffer1[CTRL_X_CUBE_AI_SPECTROGRAM_NFFT];
   float32_t pSpectrScratchBuffer2[CTRL_X_CUBE_AI_SPECTROGRAM_NFFT];
+#endif
+
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL == 1U)
+  /**
+   * Samples of the new columns: the last HISTORY_LENGTH samples of the previous input, then the new input.
+   */
+  int16_t pFrames[CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH + CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH];
+
+  /**
+   * Ring of the quantized columns, in the (mel x time) layout of the output.
+   */
+  int8_t pColumns[CTRL_X_CUBE_AI_SPECTROGRAM_NMEL * CTRL_X_CUBE_AI_SPECTROGRAM_COL];
+
+  /**
+   * Ring index of the oldest column, replaced by the next new column.
+   */
+  uint32_t col_head;
+
+  /**
+   * false after a reset: the history and the ring are filled with silence by the next process.
+   */
+  bool is_primed;
+#endif
 
   /**
    * Specifies the quantization parameters of the unique output preprocessing
@@ -119,6 +154,16 @@ sys_error_code_t PreProc_DPUInit(PreProc_DPU_t *_this, uint16_t mfcc_data_input_
  */
 sys_error_code_t PreProc_DPUPrepareToProcessData(PreProc_DPU_t *_this);
 
+/**
+ * Set the quantization parameters of the output, i.e. the input ones of the model.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ * @param offset [IN] specifies the output zero point.
+ * @param inv_scale [IN] specifies the inverse of the output quantization step.
+ * @return SYS_NO_ERROR_CODE if success, an error code otherwise.
+ */
+sys_error_code_t PreProc_DPUSetQuantization(PreProc_DPU_t *_this, int offset, float inv_scale);
+
 
 /* Inline functions definition */
 /*******************************/
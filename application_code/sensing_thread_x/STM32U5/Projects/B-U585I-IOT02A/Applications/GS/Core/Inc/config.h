@@ -134,8 +134,31 @@ extern "C" {
 #define CTRL_X_CUBE_AI_SPECTROGRAM_MEL_STOP_IDX  (melFiltersStopIndices_1024_30)
 #endif
 
+#ifndef CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL
+#define CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL    (CTRL_X_CUBE_AI_SPECTROGRAM_COL) // new columns per inference, COL: independent patches
+#endif
+
+#ifndef CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT
+#define CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT   (0U) // 1U: integer log-mel columns, within one output step of the float ones
+#endif
+
 #define CTRL_X_CUBE_AI_SPECTROGRAM_PATCH_LENGTH  ((CTRL_X_CUBE_AI_SPECTROGRAM_COL-1)*CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH + CTRL_X_CUBE_AI_SPECTROGRAM_NFFT)
 
+/* Incremental spectrogram: each inference gets STRIDE_COL * HOP_LENGTH new samples, only the columns
+ * covering them are computed and the older ones are kept from the previous inferences */
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL < CTRL_X_CUBE_AI_SPECTROGRAM_COL)
+#define CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL   (1U)
+#define CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH  (CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL*CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH)
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH > CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH)
+#define CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH (CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH - CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH)
+#else
+#define CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH (0U)
+#endif
+#else
+#define CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL   (0U)
+#define CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH  (CTRL_X_CUBE_AI_SPECTROGRAM_PATCH_LENGTH)
+#endif
+
 #ifndef CTRL_X_CUBE_AI_OOD_THR 
 #define CTRL_X_CUBE_AI_OOD_THR (0.0F)
 #endif
@@ -122,6 +122,16 @@ sys_error_code_t AI_DPU_vtblProcess(IDPU2_t *_this, EMData_t in_data, EMData_t o
 #endif
 #endif
 
+  if (p_obj->outputs_in_place)
+  {
+    /* bind the outputs to the DPU output data, in the same order as the serialized outputs.*/
+    float *p_out = (float*)EMD_Data(&out_data);
+    for (int i = 0 ; i < n_outputs ; i++){
+      ai_output[i].data = AI_HANDLE_PTR(p_out);
+      p_out += AI_BUFFER_SHAPE_ELEM(&p_obj->net_exec_ctx->report.outputs[i], AI_SHAPE_CHANNEL);
+    }
+  }
+
   if (p_obj->sensor_type==COM_TYPE_ACC)
   {
     Preproc_3D_ACC((float*)EMD_Data(&in_data),ai_input[0].data,p_obj);
@@ -136,6 +146,7 @@ sys_error_code_t AI_DPU_vtblProcess(IDPU2_t *_this, EMData_t in_data, EMData_t o
 
   /* prepare output */
   if (batch != 1) aiLogErr(ai_network_get_error(p_obj->net_exec_ctx->handle),"ai_network_run");
+  if (!p_obj->outputs_in_place)
   {
     float *p_out  = (float*)EMD_Data(&out_data);
     float *p_out0 = (float*)ai_output[0].data;
@@ -201,6 +212,7 @@ sys_error_code_t AI_DPU_Init(AI_DPU_t *_this)
   EMData_t none = {0};
   _this->input_Q_inv_scale = 0.0F;
   _this->input_Q_offset    = 0;
+  _this->outputs_in_place  = false;
 
   /*initialize the base class.*/
   if SYS_IS_ERROR_CODE(ADPU2_Init((ADPU2_t*)_this,none,none)){
@@ -362,6 +374,15 @@ sys_error_code_t AiDPULoadModel(AI_DPU_t *_this, const char *name)
     sys_error_handler();
   }
 
+  /* the outputs can be bound to the output data only if they are not larger than their serialized part.*/
+  _this->outputs_in_place = true;
+  for (int i = 0 ; i < nOut ; i++){
+    const ai_buffer *p_output = &_this->net_exec_ctx->report.outputs[i];
+    if (AI_BUFFER_SIZE(p_output) != AI_BUFFER_SHAPE_ELEM(p_output, AI_SHAPE_CHANNEL)){
+      _this->outputs_in_place = false;
+    }
+  }
+
   if SYS_IS_ERROR_CODE(EMD_Init(&out_data, NULL, E_EM_FLOAT, E_EM_MODE_LINEAR, 1,widthOut1+widthOut2))
 	{
     sys_error_handler();
@@ -255,6 +255,8 @@ sys_error_code_t AI_Task_vtblOnCreateTask(AManagedTask *_this,
   /*register the DPU with the base class*/
   (void) DPT1AddDPU((DProcessTask1_t*)p_obj, (ADPU2_t*)&p_obj->dpu);
   (void) DPT1EnableAsyncDataProcessing((DProcessTask1_t*)p_obj, true);
+  /* one producer, the pre-processing DPU, and one consumer, this task: no critical sections on the input buffer */
+  (void) ADPU2_SetInDataBufferSPSC((ADPU2_t*)&p_obj->dpu, true);
   /* Initialize the base class */
   p_obj->super.p_dpu_out_buff = NULL;
   p_obj->super.p_dpu_in_buff = NULL;
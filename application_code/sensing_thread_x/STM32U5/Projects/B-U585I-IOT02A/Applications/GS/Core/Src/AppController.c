@@ -493,9 +493,9 @@ static sys_error_code_t AppControllerExecuteSequence(AManagedTask *_this)
     case CTRL_CMD_PARAM_AI:
       AppControllerSetAISensor(p_obj,sensor_id); // sensor has just been enabled
       AI_LoadModel(p_obj->p_ai_task,CTRL_X_CUBE_AI_MODE_NETWORK_MODEL_NAME);
-      /* propagate Q params ,to improve */
-      p_obj->p_preproc_task->dpu.output_Q_offset    = p_obj->p_ai_task->dpu.input_Q_offset;
-      p_obj->p_preproc_task->dpu.output_Q_inv_scale = p_obj->p_ai_task->dpu.input_Q_inv_scale;
+      /* propagate Q params */
+      PreProc_DPUSetQuantization(&p_obj->p_preproc_task->dpu, p_obj->p_ai_task->dpu.input_Q_offset,
+                                 p_obj->p_ai_task->dpu.input_Q_inv_scale);
       break;
     default:
       return SYS_INVALID_PARAMETER_ERROR_CODE;
@@ -24,6 +24,7 @@
 #include "services/sysdebug.h"
 #include "services/SysTimestamp.h"
 #include <stdio.h>
+#include <string.h>
 //#define MFCC_GEN_LUT
 
 #define SYS_DEBUGF(level, message)      SYS_DEBUGF3(SYS_DBG_PRE_PROC, level, message)
@@ -64,6 +65,19 @@ static const PreProc_DPUClass_t sTheClass = {
 /* Private member functions declaration */
 /****************************************/
 
+/**
+ * Compute consecutive quantized Log-Mel Spectrogram columns in the (mel x time) layout,
+ * with the integer or the floating-point pipeline.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ * @param p_in [IN] specifies the samples of the first column, the next ones are HOP_LENGTH apart.
+ * @param n_cols [IN] specifies the number of columns.
+ * @param p_out [OUT] specifies the first column of the output.
+ * @param out_stride [IN] specifies the length of an output row.
+ */
+static inline void PreProc_DPUColumns(PreProc_DPU_t *_this, int16_t *p_in, uint32_t n_cols, int8_t *p_out,
+                                      uint32_t out_stride);
+
 #ifdef MFCC_GEN_LUT
 #define NUM_MEL      CTRL_X_CUBE_AI_SPECTROGRAM_NMEL
 #define NUM_MEL_COEF 462
@@ -148,6 +162,19 @@ static void genLUT(void)
 #endif
 
 
+static inline void PreProc_DPUColumns(PreProc_DPU_t *_this, int16_t *p_in, uint32_t n_cols, int8_t *p_out,
+                                      uint32_t out_stride)
+{
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U)
+  LogMelSpectrogramFixed_q15_Q8(&_this->S_LogMelFixed, p_in, CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH, n_cols,
+                                p_out, out_stride);
+#else
+  LogMelSpectrogram_q15_Q8(&_this->S_LogMelSpectr, p_in, CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH, n_cols,
+                           p_out, out_stride, _this->output_Q_offset, _this->output_Q_inv_scale);
+#endif
+}
+
+
 /* Public API functions definition */
 /***********************************/
 
@@ -223,8 +250,10 @@ sys_error_code_t PreProc_DPUInit(PreProc_DPU_t *_this, uint16_t data_input_user)
   _this->S_Spectr.SampRate                 = CTRL_X_CUBE_AI_SENSOR_ODR;
   _this->S_Spectr.FrameLen                 = CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH;
   _this->S_Spectr.FFTLen                   = CTRL_X_CUBE_AI_SPECTROGRAM_NFFT;
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 0U)
   _this->S_Spectr.pScratch1                = _this->pSpectrScratchBuffer1;
   _this->S_Spectr.pScratch2                = _this->pSpectrScratchBuffer2;
+#endif
 
   pad                                      = CTRL_X_CUBE_AI_SPECTROGRAM_NFFT - CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH;
   _this->S_Spectr.pad_left                 = pad/2;
@@ -253,6 +282,26 @@ sys_error_code_t PreProc_DPUInit(PreProc_DPU_t *_this, uint16_t data_input_user)
   _this->S_LogMelSpectr.Ref                = 1.0f;
   _this->S_LogMelSpectr.TopdB              = HUGE_VALF;
 
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U)
+  /* Init the integer LogMelSpectrogram from the floating-point one */
+  _this->S_LogMelFixed.pRfft               = &_this->S_RfftQ31;
+  _this->S_LogMelFixed.pWindow             = _this->pWindowQ31;
+  _this->S_LogMelFixed.pCoefficients       = _this->pMelCoefficientsQ31;
+  _this->S_LogMelFixed.pScratch1           = _this->pFixedScratchBuffer1;
+  _this->S_LogMelFixed.pScratch2           = _this->pFixedScratchBuffer2;
+  if (LogMelSpectrogramFixed_Init(&_this->S_LogMelFixed, &_this->S_LogMelSpectr) != 0)
+  {
+    sys_error_handler();
+  }
+  LogMelSpectrogramFixed_SetQuantization(&_this->S_LogMelFixed, (int8_t)_this->output_Q_offset, _this->output_Q_inv_scale);
+#endif
+
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL == 1U)
+  assert_param(data_input_user == CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH);
+  _this->col_head                          = 0U;
+  _this->is_primed                         = false;
+#endif
+
   return res;
 }
 
@@ -262,6 +311,24 @@ sys_error_code_t PreProc_DPUPrepareToProcessData(PreProc_DPU_t *_this)
   sys_error_code_t res = SYS_NO_ERROR_CODE;
 
   ADPU2_Reset((ADPU2_t*)_this);
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL == 1U)
+  /* a new stream does not continue the previous one */
+  _this->is_primed = false;
+#endif
+
+  return res;
+}
+
+sys_error_code_t PreProc_DPUSetQuantization(PreProc_DPU_t *_this, int offset, float inv_scale)
+{
+  assert_param(_this != NULL);
+  sys_error_code_t res = SYS_NO_ERROR_CODE;
+
+  _this->output_Q_offset    = offset;
+  _this->output_Q_inv_scale = inv_scale;
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U)
+  LogMelSpectrogramFixed_SetQuantization(&_this->S_LogMelFixed, (int8_t)offset, inv_scale);
+#endif
 
   return res;
 }
@@ -275,22 +342,54 @@ sys_error_code_t PreProc_DPU_vtblProcess(IDPU2_t *_this, EMData_t in_data, EMDat
   sys_error_code_t res = SYS_NO_ERROR_CODE;
   PreProc_DPU_t *p_obj = (PreProc_DPU_t*)_this;
 
-  int16_t *p_in;
-  int8_t  out[CTRL_X_CUBE_AI_SPECTROGRAM_NMEL];
   int8_t *p_spectro = (int8_t *)EMD_Data(&out_data);
 
   assert_param (p_obj->type == SPECTROGRAM_LOG_MEL);
   assert_param (p_obj->S_MelFilter.NumMels == CTRL_X_CUBE_AI_SPECTROGRAM_NMEL);
 
-  /* Create a quantized Mel-scaled spectrogram column */
-  for (int i = 0; i < CTRL_X_CUBE_AI_SPECTROGRAM_COL; i++ )
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL == 1U)
+  const uint32_t n_col = CTRL_X_CUBE_AI_SPECTROGRAM_COL;
+  uint32_t n_tail;
+  int8_t *p_col;
+
+  if (!p_obj->is_primed)
   {
-    p_in = (int16_t *)EMD_Data(&in_data)+CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH*i;
-    LogMelSpectrogramColumn_q15_Q8(&p_obj->S_LogMelSpectr, p_in,out,p_obj->output_Q_offset,p_obj->output_Q_inv_scale);
-    /* transpose */
-    for (int j=0 ; j < p_obj->S_MelFilter.NumMels ; j++ ){
-      p_spectro[i+CTRL_X_CUBE_AI_SPECTROGRAM_COL*j]= out[j];
+    /* Start of a stream: the samples and columns before it are silence */
+    memset(p_obj->pFrames, 0, sizeof(p_obj->pFrames));
+    PreProc_DPUColumns(p_obj, p_obj->pFrames, 1U, p_obj->pColumns, n_col);
+    for (int j=0 ; j < CTRL_X_CUBE_AI_SPECTROGRAM_NMEL ; j++ ){
+      memset(&p_obj->pColumns[n_col*j], p_obj->pColumns[n_col*j], n_col);
     }
+    p_obj->col_head  = 0U;
+    p_obj->is_primed = true;
+  }
+
+  /* Only the STRIDE_COL columns covering the new samples are computed, they replace the oldest
+   * columns of the ring: up to its end, then from its start */
+  memcpy(&p_obj->pFrames[CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH], EMD_Data(&in_data),
+         CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH*sizeof(int16_t));
+  n_tail = n_col - p_obj->col_head;
+  n_tail = (n_tail < CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL) ? n_tail : CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL;
+  PreProc_DPUColumns(p_obj, p_obj->pFrames, n_tail, &p_obj->pColumns[p_obj->col_head], n_col);
+  if (n_tail < CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL)
+  {
+    PreProc_DPUColumns(p_obj, &p_obj->pFrames[CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH*n_tail],
+                       CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL - n_tail, p_obj->pColumns, n_col);
   }
+  p_obj->col_head = (p_obj->col_head + CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL) % n_col;
+  memmove(p_obj->pFrames, &p_obj->pFrames[CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH],
+          CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH*sizeof(int16_t));
+
+  /* Rotate copy: each mel row of the output from the oldest to the newest column */
+  for (int j=0 ; j < CTRL_X_CUBE_AI_SPECTROGRAM_NMEL ; j++ ){
+    p_col = &p_obj->pColumns[n_col*j];
+    memcpy(&p_spectro[n_col*j], &p_col[p_obj->col_head], n_col - p_obj->col_head);
+    memcpy(&p_spectro[n_col*j + n_col - p_obj->col_head], p_col, p_obj->col_head);
+  }
+#else
+  /* Create the quantized Mel-scaled spectrogram, directly in the (mel x time) layout */
+  PreProc_DPUColumns(p_obj, (int16_t *)EMD_Data(&in_data), CTRL_X_CUBE_AI_SPECTROGRAM_COL, p_spectro,
+                     CTRL_X_CUBE_AI_SPECTROGRAM_COL);
+#endif
   return res;
 }
@@ -232,13 +232,17 @@ sys_error_code_t PreProc_Task_vtblOnCreateTask(AManagedTask *_this,
   }
   /* Initialize DPU */
   (void) PreProc_DPUStaticAlloc(&p_obj->dpu);
-  (void) PreProc_DPUInit(&p_obj->dpu,CTRL_X_CUBE_AI_SPECTROGRAM_PATCH_LENGTH);
+  (void) PreProc_DPUInit(&p_obj->dpu,CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH);
   (void) ADPU2_SetTag((ADPU2_t*)&p_obj->dpu, PRE_PROC_TASK_DPU_TAG);
   assert_param(sizeof(p_obj->dpu_out_buff) == ADPU2_GetOutDataPayloadSize((ADPU2_t*)&p_obj->dpu));
   res = ADPU2_SetOutDataBuffer((ADPU2_t*)&p_obj->dpu, (uint8_t*)p_obj->dpu_out_buff, sizeof(p_obj->dpu_out_buff));
   /*register the DPU with the base class*/
   (void) DPT1AddDPU((DProcessTask1_t*)p_obj, (ADPU2_t*)&p_obj->dpu);
   (void) DPT1EnableAsyncDataProcessing((DProcessTask1_t*)p_obj, true);
+  /* one producer, the microphone, and one consumer, this task: no critical sections on the input buffer */
+  (void) ADPU2_SetInDataBufferSPSC((ADPU2_t*)&p_obj->dpu, true);
+  /* the spectrogram is computed directly in the input buffer of the AI DPU */
+  (void) ADPU2_SetZeroCopyChain((ADPU2_t*)&p_obj->dpu, true);
   /* Initialize the base class */
   p_obj->super.p_dpu_out_buff = p_obj->dpu_out_buff;
   p_obj->super.p_dpu_in_buff = NULL;
@@ -72,6 +72,12 @@ typedef struct _CBHandle2
    * Specifies the ::CBItem used to produce an new input data.
    */
   CBItem *p_producer_data_buff;
+
+  /**
+   * Specifies if the input circular buffer is allocated in lock-free single producer / single consumer mode.
+   * See ADPU2_SetInDataBufferSPSC().
+   */
+  bool spsc;
 }CBHandle2_t;
 
 /**
@@ -119,6 +125,12 @@ typedef struct _AttachedDPU
    * Points to the next attached DPU.
    */
   ADPU2_t *p_next;
+
+  /**
+   * Specifies if the DPU writes its output data directly in the input buffer of the next DPU.
+   * See ADPU2_SetZeroCopyChain().
+   */
+  bool zero_copy;
 } AttachedDPU;
 
 
@@ -296,6 +308,36 @@ sys_error_code_t ADPU2_Resume(ADPU2_t *_this);
  */
 sys_error_code_t ADPU2_SetInDataBuffer(ADPU2_t *_this, uint8_t *p_buffer, uint32_t buffer_size);
 
+/**
+ * Select the lock-free single producer / single consumer mode (see CB_AllocSPSC()) for the input
+ * circular buffer. The mode is applied by the next call of ADPU2_SetInDataBuffer().
+ * It can be enabled when the input data are built in only one execution context (for example the ISR
+ * or the task of the data source, or the previous DPU of the chain), and processed in only one other
+ * execution context, that is the DPU uses a ::DPU2_ReadyToProcessCallback_t to defer ADPU2_ProcessAndDispatch().
+ * Then the DPU and its circular buffer never disable the interrupts. ADPU2_Reset() must be called when the
+ * DPU does not receive input data, for example when it is suspended.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ * @param enable [IN] `true` to select the SPSC mode, `false` to use the critical sections (default).
+ * @return SYS_NO_ERROR_CODE
+ */
+sys_error_code_t ADPU2_SetInDataBufferSPSC(ADPU2_t *_this, bool enable);
+
+/**
+ * Enable the zero-copy chaining with the next DPU. When it is enabled, and the input data of the next DPU
+ * has the same type and payload size as the output data of this DPU, the DPU borrows a free item of the input
+ * circular buffer of the next DPU, and it uses it as output buffer: the next DPU then consumes the output data
+ * in place and the data builder of the chain is not used. If the next DPU does not match, or it has no free item,
+ * the output data is copied by the data builder as usual.
+ * The data events dispatched to the listeners point to the borrowed item. It is valid only during the dispatch.
+ * The DPU must compute the whole output data each time, because the output buffer changes at every process.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ * @param enable [IN] `true` to enable the zero-copy chaining, `false` to copy the output data (default).
+ * @return SYS_NO_ERROR_CODE
+ */
+sys_error_code_t ADPU2_SetZeroCopyChain(ADPU2_t *_this, bool enable);
+
 /**
  * Set the memory buffer used by the DPU to manage the output data. It must be big enough to store
  * the payload of one output data. To know the size in byte of the payload of one output data, it is
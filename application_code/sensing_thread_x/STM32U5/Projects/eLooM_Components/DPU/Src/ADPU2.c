@@ -156,6 +156,50 @@ static uint8_t *ADPU2_DataBuffAlloc(IDataBuilder_t *_this, void *p_data_build_co
  */
 static sys_error_code_t ADPU2_OnNewInputDataFromDPU(ADPU2_t *_this,  DataEvent_t *p_evt, ADPU2_t *p_src_dpu);
 
+/**
+ * Zero-copy chaining: borrow a free item of the input circular buffer of the next DPU, to be used as output buffer.
+ * The item becomes the producer item of the next DPU, as when its data builder starts building a new data.
+ * The borrowed item is not used if the producer item of the next DPU is already in use by its data builder.
+ *
+ * @param _this [IN] specifies a pointer to the object. It is the DPU that produces the data.
+ * @return `true` if the output data can be produced in the input buffer of the next DPU, `false` otherwise.
+ */
+static bool ADPU2_BorrowNextDPUInItem(ADPU2_t *_this);
+
+/**
+ * Check if a payload is the borrowed producer item of a DPU.
+ *
+ * @param _this [IN] specifies a pointer to the object. It is the DPU that lends its input buffer.
+ * @param p_payload [IN] specifies the payload of a data event.
+ * @return `true` if the payload is in the producer item of the DPU, `false` otherwise.
+ */
+static inline bool ADPU2_IsBorrowedInItem(ADPU2_t *_this, const void *p_payload);
+
+/**
+ * Zero-copy chaining: the previous DPU has produced the input data in the borrowed producer item.
+ * Mark it as ready and notify the application, or process it.
+ *
+ * @param _this [IN] specifies a pointer to the object. It is the DPU that lends its input buffer.
+ * @return SYS_NO_ERROR_CODE if success, an application specific error code otherwise.
+ */
+static sys_error_code_t ADPU2_OnNewInputDataInPlace(ADPU2_t *_this);
+
+/**
+ * Check if the DPU needs a new ::CBItem to build the next input data. The critical section is skipped
+ * when the input circular buffer is SPSC, because then the producer item is accessed only by the producer.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ * @return `true` if there is no input data in progress, `false` otherwise.
+ */
+static inline bool ADPU2_IsProducerDataBuffFree(ADPU2_t *_this);
+
+/**
+ * Mark the input data in progress as ready to be processed and release the producer item.
+ *
+ * @param _this [IN] specifies a pointer to the object.
+ */
+static inline void ADPU2_SetProducerDataBuffReady(ADPU2_t *_this);
+
 
 /* IDPU2 virtual functions definition */
 /**************************************/
@@ -330,7 +374,15 @@ sys_error_code_t ADPU2_vtblDispatchEvents(IDPU2_t *_this,  DataEvent_t *p_evt)
     /* then propagate the data into DPU2 chain*/
     if(p_obj->next_dpu.p_next != NULL)
     {
-      res = ADPU2_OnNewInputDataFromDPU(p_obj->next_dpu.p_next, p_evt, p_obj);
+      if (ADPU2_IsBorrowedInItem(p_obj->next_dpu.p_next, EMD_Data(p_evt->p_data)))
+      {
+        /* the data has been produced in place, so the next DPU has only to consume it.*/
+        res = ADPU2_OnNewInputDataInPlace(p_obj->next_dpu.p_next);
+      }
+      else
+      {
+        res = ADPU2_OnNewInputDataFromDPU(p_obj->next_dpu.p_next, p_evt, p_obj);
+      }
 
       if (res == SYS_IDB_DATA_READY_ERROR_CODE)
       {
@@ -383,7 +435,7 @@ void ADPU2_vtblSetOwner(IEventListener *_this, void *p_owner)
 {
   assert_param(_this != NULL);
   assert_param(p_owner != NULL);
-  ADPU2_t* p_obj = (ADPU2_t*) ((uint32_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
+  ADPU2_t* p_obj = (ADPU2_t*) ((uintptr_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
 
   p_obj->p_owner = p_owner;
 }
@@ -391,7 +443,7 @@ void ADPU2_vtblSetOwner(IEventListener *_this, void *p_owner)
 void *ADPU2_vtblGetOwner(IEventListener *_this)
 {
   assert_param(_this != NULL);
-  ADPU2_t* p_obj = (ADPU2_t*) ((uint32_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
+  ADPU2_t* p_obj = (ADPU2_t*) ((uintptr_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
 
   return p_obj->p_owner;
 }
@@ -405,8 +457,7 @@ sys_error_code_t ADPU2_vtblOnNewDataReady(IEventListener *_this, const DataEvent
   assert_param(_this != NULL);
   assert_param(p_evt != NULL);
   sys_error_code_t res = SYS_NO_ERROR_CODE;
-  ADPU2_t* p_obj = (ADPU2_t*) ((uint32_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
-  SYS_DECLARE_CS(cs);
+  ADPU2_t* p_obj = (ADPU2_t*) ((uintptr_t) _this - offsetof (ADPU2_t , data_evt_listener_if));
 
   if (p_obj->active)
   {
@@ -414,10 +465,8 @@ sys_error_code_t ADPU2_vtblOnNewDataReady(IEventListener *_this, const DataEvent
     AttachedSourceObservedItem_t *p_aso_item = ASOListFindItemBySrcID(&p_obj->attached_data_src_list, p_evt->tag);
 
     /* Check if we are start building a new data.*/
-    SYS_ENTER_CRITICAL(cs);
-    if (p_obj->cbh.p_producer_data_buff == NULL)
+    if (ADPU2_IsProducerDataBuffFree(p_obj))
     {
-      SYS_EXIT_CRITICAL(cs);
       /* we start to build a new data.*/
       res = ADPU2_PrepareToBuildNewData(p_obj, NULL);
       if (SYS_IS_ERROR_CODE(res))
@@ -435,10 +484,6 @@ sys_error_code_t ADPU2_vtblOnNewDataReady(IEventListener *_this, const DataEvent
         }
       }
     }
-    else
-    {
-      SYS_EXIT_CRITICAL(cs);
-    }
 
     res = IDataBuilder_OnNewInData(p_aso_item->p_builder, &p_obj->in_data, p_evt->p_data, p_aso_item->build_strategy, ADPU2_DataBuffAlloc);
 
@@ -447,10 +492,7 @@ sys_error_code_t ADPU2_vtblOnNewDataReady(IEventListener *_this, const DataEvent
       if (!--p_obj->data_builder_to_complete)
       {
         /*a new data is ready*/
-        CB_SetItemReady(p_obj->cbh.p_cb, p_obj->cbh.p_producer_data_buff);
-        SYS_ENTER_CRITICAL(cs);
-        p_obj->cbh.p_producer_data_buff = NULL;
-        SYS_EXIT_CRITICAL(cs);
+        ADPU2_SetProducerDataBuffReady(p_obj);
         if(p_obj->notify_data_ready_f)
         {
           /* I do not process inline the new data, but I notify the app.
@@ -503,8 +545,10 @@ sys_error_code_t ADPU2_Init(ADPU2_t *_this, EMData_t in_data, EMData_t out_data)
   p_obj->out_data = out_data;
   p_obj->cbh.p_cb = NULL;
   p_obj->cbh.p_producer_data_buff = NULL;
+  p_obj->cbh.spsc = false;
   p_obj->next_dpu.p_next = NULL;
   p_obj->next_dpu.p_builder = NULL;
+  p_obj->next_dpu.zero_copy = false;
   p_obj->is_chained_as_next = false;
 
   return res;
@@ -607,7 +651,7 @@ sys_error_code_t ADPU2_SetInDataBuffer(ADPU2_t *_this, uint8_t *p_buffer, uint32
   {
     size_t payload_size = EMD_GetPayloadSize(&_this->in_data);
     uint16_t cb_items = buffer_size / payload_size;
-    _this->cbh.p_cb = CB_Alloc(cb_items);
+    _this->cbh.p_cb = _this->cbh.spsc ? CB_AllocSPSC(cb_items) : CB_Alloc(cb_items);
     if (_this->cbh.p_cb != NULL)
     {
       (void)CB_Init(_this->cbh.p_cb, p_buffer, payload_size);
@@ -622,6 +666,26 @@ sys_error_code_t ADPU2_SetInDataBuffer(ADPU2_t *_this, uint8_t *p_buffer, uint32
   return res;
 }
 
+sys_error_code_t ADPU2_SetInDataBufferSPSC(ADPU2_t *_this, bool enable)
+{
+  assert_param(_this != NULL);
+  sys_error_code_t res = SYS_NO_ERROR_CODE;
+
+  _this->cbh.spsc = enable;
+
+  return res;
+}
+
+sys_error_code_t ADPU2_SetZeroCopyChain(ADPU2_t *_this, bool enable)
+{
+  assert_param(_this != NULL);
+  sys_error_code_t res = SYS_NO_ERROR_CODE;
+
+  _this->next_dpu.zero_copy = enable;
+
+  return res;
+}
+
 sys_error_code_t ADPU2_SetOutDataBuffer(ADPU2_t *_this, uint8_t *p_buffer, uint32_t buffer_size)
 {
   assert_param(_this != NULL);
@@ -665,14 +729,20 @@ sys_error_code_t ADPU2_ProcessAndDispatch(ADPU2_t *_this)
   }
 
   EMData_t in_data = _this->in_data;
+  EMData_t out_data = _this->out_data;
   in_data.p_payload = CB_GetItemData(p_ready_item);
-  res = IDPU2_Process((IDPU2_t*)_this, in_data, _this->out_data);
+  if (ADPU2_BorrowNextDPUInItem(_this))
+  {
+    /* process directly in the input buffer of the next DPU.*/
+    out_data.p_payload = _this->next_dpu.p_next->in_data.p_payload;
+  }
+  res = IDPU2_Process((IDPU2_t*)_this, in_data, out_data);
   CB_ReleaseItem(_this->cbh.p_cb, p_ready_item);
   double timestamp = SysTsGetTimestampF(SysGetTimestampSrv());
   if (!SYS_IS_ERROR_CODE(res))
   {
     DataEvent_t data_evt;
-    DataEventInit((IEvent*)&data_evt, (IEventSrc*)&_this->data_evt_src_if, &_this->out_data, timestamp, _this->tag);
+    DataEventInit((IEvent*)&data_evt, (IEventSrc*)&_this->data_evt_src_if, &out_data, timestamp, _this->tag);
     res = IDPU2_DispatchEvents((IDPU2_t*)_this, &data_evt);
   }
 
@@ -784,6 +854,91 @@ void ASOListRemoveItem(AttachedSourceObservedItem_t *p_list_head, AttachedSource
   }
 }
 
+static bool ADPU2_BorrowNextDPUInItem(ADPU2_t *_this)
+{
+  ADPU2_t *p_next = _this->next_dpu.p_next;
+  bool res = false;
+
+  if (_this->next_dpu.zero_copy && (p_next != NULL) && p_next->active && (p_next->cbh.p_cb != NULL) &&
+      (EMD_GetType(&p_next->in_data) == EMD_GetType(&_this->out_data)) &&
+      (EMD_GetPayloadSize(&p_next->in_data) == EMD_GetPayloadSize(&_this->out_data)))
+  {
+    if (ADPU2_IsProducerDataBuffFree(p_next))
+    {
+      if (!SYS_IS_ERROR_CODE(CB_GetFreeItemFromHead(p_next->cbh.p_cb, &p_next->cbh.p_producer_data_buff)))
+      {
+        p_next->in_data.p_payload = (uint8_t*)CB_GetItemData(p_next->cbh.p_producer_data_buff);
+        /* if the process fails, the item is left to the data builder that restarts from its beginning.*/
+        (void)IDataBuilder_Reset(_this->next_dpu.p_builder, p_next);
+        res = true;
+      }
+    }
+  }
+
+  return res;
+}
+
+static inline bool ADPU2_IsBorrowedInItem(ADPU2_t *_this, const void *p_payload)
+{
+  return (_this->cbh.p_producer_data_buff != NULL) && (CB_GetItemData(_this->cbh.p_producer_data_buff) == p_payload);
+}
+
+static sys_error_code_t ADPU2_OnNewInputDataInPlace(ADPU2_t *_this)
+{
+  sys_error_code_t res = SYS_NO_ERROR_CODE;
+
+  ADPU2_SetProducerDataBuffReady(_this);
+  if(_this->notify_data_ready_f)
+  {
+    /* I do not process inline the new data, but I notify the app.
+     * It will be responsibility of the app to call ADPU2_ProcessAndDispatch or manually
+     * do the Process&Dispatch */
+    _this->notify_data_ready_f((IDPU2_t*)_this, _this->p_data_ready_callback_param);
+  }
+  else
+  {
+    res = ADPU2_ProcessAndDispatch(_this);
+  }
+
+  return res;
+}
+
+static inline bool ADPU2_IsProducerDataBuffFree(ADPU2_t *_this)
+{
+  bool res;
+  SYS_DECLARE_CS(cs);
+
+  if (CB_IsSPSC(_this->cbh.p_cb))
+  {
+    res = (_this->cbh.p_producer_data_buff == NULL);
+  }
+  else
+  {
+    SYS_ENTER_CRITICAL(cs);
+    res = (_this->cbh.p_producer_data_buff == NULL);
+    SYS_EXIT_CRITICAL(cs);
+  }
+
+  return res;
+}
+
+static inline void ADPU2_SetProducerDataBuffReady(ADPU2_t *_this)
+{
+  SYS_DECLARE_CS(cs);
+
+  CB_SetItemReady(_this->cbh.p_cb, _this->cbh.p_producer_data_buff);
+  if (CB_IsSPSC(_this->cbh.p_cb))
+  {
+    _this->cbh.p_producer_data_buff = NULL;
+  }
+  else
+  {
+    SYS_ENTER_CRITICAL(cs);
+    _this->cbh.p_producer_data_buff = NULL;
+    SYS_EXIT_CRITICAL(cs);
+  }
+}
+
 static sys_error_code_t ADPU2_PrepareToBuildNewData(ADPU2_t *_this, AttachedSourceObservedItem_t *p_no_reset_item)
 {
   assert_param(_this != NULL);
@@ -826,7 +981,6 @@ static uint8_t *ADPU2_DataBuffAlloc(IDataBuilder_t *_this, void *p_data_build_co
   ADPU2_t *p_obj = (ADPU2_t*)p_data_build_context;
   uint8_t *p_buff = NULL;
   sys_error_code_t res = SYS_NO_ERROR_CODE;
-  SYS_DECLARE_CS(cs);
 
   /*a data builder needs a new buffer because it has completed its part of the data.*/
 
@@ -835,10 +989,7 @@ static uint8_t *ADPU2_DataBuffAlloc(IDataBuilder_t *_this, void *p_data_build_co
     /* it is the last data builder so I can mark the data ready and allocate a new buffer.*/
     SYS_DEBUGF(SYS_DBG_LEVEL_ALL, ("ADPU2: new data ready _\r\n"));
 
-    CB_SetItemReady(p_obj->cbh.p_cb, p_obj->cbh.p_producer_data_buff);
-    SYS_ENTER_CRITICAL(cs);
-    p_obj->cbh.p_producer_data_buff = NULL;
-    SYS_EXIT_CRITICAL(cs);
+    ADPU2_SetProducerDataBuffReady(p_obj);
     /* find the attached source observer list item*/
     AttachedSourceObservedItem_t *p_aso_item = ASOListFindItemByDataBuilder(&p_obj->attached_data_src_list, _this);
     res = ADPU2_PrepareToBuildNewData(p_obj, p_aso_item);
@@ -870,15 +1021,12 @@ static sys_error_code_t ADPU2_OnNewInputDataFromDPU(ADPU2_t *_this,  DataEvent_t
   assert_param(p_evt != NULL);
   assert_param(p_src_dpu != NULL);
   sys_error_code_t res = SYS_NO_ERROR_CODE;
-  SYS_DECLARE_CS(cs);
 
   if (_this->active)
   {
     /* Check if we are start building a new data.*/
-    SYS_ENTER_CRITICAL(cs);
-    if (_this->cbh.p_producer_data_buff == NULL)
+    if (ADPU2_IsProducerDataBuffFree(_this))
     {
-      SYS_EXIT_CRITICAL(cs);
       /*get a new empty buffer from the circular buffer.*/
       res = (sys_error_code_t)CB_GetFreeItemFromHead(_this->cbh.p_cb, &_this->cbh.p_producer_data_buff);
       if (!SYS_IS_ERROR_CODE(res))
@@ -903,20 +1051,13 @@ static sys_error_code_t ADPU2_OnNewInputDataFromDPU(ADPU2_t *_this,  DataEvent_t
         }
       }
     }
-    else
-    {
-      SYS_EXIT_CRITICAL(cs);
-    }
 
     res = IDataBuilder_OnNewInData(p_src_dpu->next_dpu.p_builder, &_this->in_data, p_evt->p_data, p_src_dpu->next_dpu.build_strategy, ADPU2_DataBuffAlloc);
 
     if (res == SYS_IDB_DATA_READY_ERROR_CODE)
     {
       /*a new data is ready*/
-      CB_SetItemReady(_this->cbh.p_cb, _this->cbh.p_producer_data_buff);
-      SYS_ENTER_CRITICAL(cs);
-      _this->cbh.p_producer_data_buff = NULL;
-      SYS_EXIT_CRITICAL(cs);
+      ADPU2_SetProducerDataBuffReady(_this);
       if(_this->notify_data_ready_f)
       {
         /* I do not process inline the new data, but I notify the app.
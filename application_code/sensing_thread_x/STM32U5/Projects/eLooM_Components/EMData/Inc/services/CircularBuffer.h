@@ -9,6 +9,9 @@
  * head of the buffer (to produce its content), and a he get a ready item from
  * the tail (to consume its content).
  * This class is specialized for the producer /consumer design pattern.
+ * By default every operation is protected by a critical section, so the buffer can be shared
+ * by any number of tasks and ISRs. A buffer allocated with CB_AllocSPSC() is lock-free instead:
+ * it supports exactly one producer and one consumer, and never masks the interrupts.
   ******************************************************************************
   * @attention
   *
@@ -71,6 +74,28 @@ typedef struct _CBItem CBItem;
  */
 CircularBuffer *CB_Alloc(uint16_t item_count);
 
+/**
+ * Allocate an object of ::CircularBuffer type in single producer / single consumer (SPSC) mode.
+ * The buffer does not use critical sections: the items are passed between the producer and the consumer
+ * with C11 atomics (release / acquire ordering). It is the application's responsibility to ensure that:
+ * - only one execution context (a task or an ISR) calls CB_GetFreeItemFromHead() and CB_SetItemReady().
+ * - only one execution context calls CB_GetReadyItemFromTail() and CB_ReleaseItem().
+ * - CB_Init() is called when neither the producer nor the consumer is using the buffer.
+ * The mode is kept by CB_Init(). A new allocated object must be initialized before use it.
+ *
+ * @param item_count [IN] specifies the maximum number of items that is possible to store in the buffer.
+ * @return a pointer to new allocated circular buffer object.
+ */
+CircularBuffer *CB_AllocSPSC(uint16_t item_count);
+
+/**
+ * Check if the circular buffer has been allocated in single producer / single consumer mode.
+ *
+ * @param _this [IN] specifies a pointer to a ::CircularBuffer object.
+ * @return `true` if the circular buffer is lock-free SPSC, `false` otherwise
+ */
+bool CB_IsSPSC(CircularBuffer *_this);
+
 /**
  * Deallocate the ::CircularBuffer object.
  *
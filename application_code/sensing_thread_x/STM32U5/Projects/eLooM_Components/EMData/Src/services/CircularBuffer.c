@@ -19,33 +19,21 @@
 
 #include "services/CircularBuffer.h"
 #include <stdlib.h>
+#include <stdatomic.h>
 
 #define CB_ITEM_FREE   0x00  ///< Status of a circular buffer item: FREE.
 #define CB_ITEM_NEW    0x01  ///< Status of a circular buffer item: NEW
 #define CB_ITEM_READY  0x02  ///< Status of a circular buffer item: READY
 
 #define CB_INCREMENT_IDX(p_cb, idx)    (((idx) + 1) % (p_cb)->item_count)
-#define CB_IS_EMPTY(p_cb)              (((p_cb)->head_idx == (p_cb)->tail_idx) && ((p_cb)->p_items[(p_cb)->head_idx].status.status == CB_ITEM_FREE) ? 1 : 0)
-#define CB_IS_FULL(p_cb)               (((p_cb)->head_idx == (p_cb)->tail_idx) && ((p_cb)->p_items[(p_cb)->head_idx].status.status != CB_ITEM_FREE) ? 1 : 0)
-
-/**
-* Specifies the status of a ::CBItem. An item can be:
-* - FREE: an item is free if it is not allocated and it cannot be used by the application.
-* - NEW: an item is new if it allocated and can be used by the application to produce its content.
-* - READY: an item is ready if the application has produced its content and it can be consumed.
-*/
-typedef struct _CBItemStatus
-{
-  /**
-  * Status bit.
-  */
-  uint8_t status :2;
-
-  /**
-  * reserved. Must be set to zero.
-  */
-  uint8_t reserved :6;
-} CBItemStatus;
+#define CB_HEAD_IDX(p_cb)              atomic_load_explicit(&(p_cb)->head_idx, memory_order_relaxed)
+#define CB_TAIL_IDX(p_cb)              atomic_load_explicit(&(p_cb)->tail_idx, memory_order_relaxed)
+#define CB_SET_HEAD_IDX(p_cb, idx)     atomic_store_explicit(&(p_cb)->head_idx, (idx), memory_order_relaxed)
+#define CB_SET_TAIL_IDX(p_cb, idx)     atomic_store_explicit(&(p_cb)->tail_idx, (idx), memory_order_relaxed)
+#define CB_ITEM_STATUS(p_item)         atomic_load_explicit(&(p_item)->status, memory_order_relaxed)
+#define CB_SET_ITEM_STATUS(p_item, s)  atomic_store_explicit(&(p_item)->status, (s), memory_order_relaxed)
+#define CB_IS_EMPTY(p_cb)              ((CB_HEAD_IDX(p_cb) == CB_TAIL_IDX(p_cb)) && (CB_ITEM_STATUS(&(p_cb)->p_items[CB_HEAD_IDX(p_cb)]) == CB_ITEM_FREE) ? 1 : 0)
+#define CB_IS_FULL(p_cb)               ((CB_HEAD_IDX(p_cb) == CB_TAIL_IDX(p_cb)) && (CB_ITEM_STATUS(&(p_cb)->p_items[CB_HEAD_IDX(p_cb)]) != CB_ITEM_FREE) ? 1 : 0)
 
 /**
 * ::CBItem internal state.
@@ -58,9 +46,14 @@ struct _CBItem
   void *p_data;
 
   /**
-  * Specifies a status flag added to each item. It is used to manage the item.
+  * Specifies the status of the item (CB_ITEM_FREE, CB_ITEM_NEW or CB_ITEM_READY). An item can be:
+  * - FREE: an item is free if it is not allocated and it cannot be used by the application.
+  * - NEW: an item is new if it allocated and can be used by the application to produce its content.
+  * - READY: an item is ready if the application has produced its content and it can be consumed.
+  * In SPSC mode it is the only variable shared by the producer and the consumer: it is written with
+  * release semantic and read with acquire semantic to pass the ownership of the item data.
   */
-  CBItemStatus status;
+  atomic_uint_least8_t status;
 };
 
 /**
@@ -70,14 +63,14 @@ struct _CircularBuffer
 {
 
   /**
-  * Specifies the index of the circular buffer tail.
+  * Specifies the index of the circular buffer tail. In SPSC mode it is written only by the consumer.
   */
-  uint16_t tail_idx;
+  atomic_uint_least16_t tail_idx;
 
   /**
-  * Specifies the index of the circular buffer head.
+  * Specifies the index of the circular buffer head. In SPSC mode it is written only by the producer.
   */
-  uint16_t head_idx;
+  atomic_uint_least16_t head_idx;
 
   /**
   * Specifies the maximum number of items that is possible to store in the buffer.
@@ -89,6 +82,11 @@ struct _CircularBuffer
   */
   uint16_t item_size;
 
+  /**
+  * Specifies if the buffer is lock-free single producer / single consumer (see CB_AllocSPSC()).
+  */
+  bool spsc;
+
   /**
   * Specified the buffer of items managed as a circular buffer.
   */
@@ -98,6 +96,11 @@ struct _CircularBuffer
 // Private functions declarations
 // ******************************
 
+static uint16_t CB_SPSCGetFreeItemFromHead(CircularBuffer *_this, CBItem **p_item);
+static uint16_t CB_SPSCGetReadyItemFromTail(CircularBuffer *_this, CBItem **p_item);
+static uint16_t CB_SPSCReleaseItem(CircularBuffer *_this, CBItem *p_item);
+static uint16_t CB_SPSCSetItemReady(CircularBuffer *_this, CBItem *p_item);
+
 
 // Public API definition
 // **********************
@@ -118,11 +121,29 @@ CircularBuffer* CB_Alloc(uint16_t item_count)
     else
     {
       p_obj->item_count = item_count;
+      p_obj->spsc = false;
     }
   }
   return p_obj;
 }
 
+CircularBuffer* CB_AllocSPSC(uint16_t item_count)
+{
+  CircularBuffer *p_obj = CB_Alloc(item_count);
+  if(p_obj != NULL)
+  {
+    p_obj->spsc = true;
+  }
+  return p_obj;
+}
+
+bool CB_IsSPSC(CircularBuffer *_this)
+{
+  assert_param(_this);
+
+  return _this->spsc;
+}
+
 void CB_Free(CircularBuffer *_this)
 {
   assert_param(_this);
@@ -137,17 +158,18 @@ uint16_t CB_Init(CircularBuffer *_this, void *p_items_buffer, uint16_t item_size
   assert_param(p_items_buffer);
   uint16_t res = SYS_NO_ERROR_CODE;
 
-  _this->head_idx = 0;
-  _this->tail_idx = 0;
+  CB_SET_HEAD_IDX(_this, 0);
+  CB_SET_TAIL_IDX(_this, 0);
   _this->item_size = item_size;
-  uint32_t pData = (uint32_t) p_items_buffer;
+  uint8_t *pData = (uint8_t*) p_items_buffer;
   for(uint32_t i = 0; i < _this->item_count; ++i)
   {
     _this->p_items[i].p_data = (void*) pData;
-    _this->p_items[i].status.status = CB_ITEM_FREE;
-    _this->p_items[i].status.reserved = 0;
+    atomic_init(&_this->p_items[i].status, CB_ITEM_FREE);
     pData += item_size;
   }
+  /* publish the reset buffer to the producer and consumer contexts.*/
+  atomic_thread_fence(memory_order_release);
 
   return res;
 }
@@ -158,9 +180,17 @@ bool CB_IsEmpty(CircularBuffer *_this)
   bool res = false;
   SYS_DECLARE_CS(cs);
 
-  SYS_ENTER_CRITICAL(cs);
-  res = CB_IS_EMPTY(_this);
-  SYS_EXIT_CRITICAL(cs);
+  if(_this->spsc)
+  {
+    /* snapshot of the buffer: it can be changed by the other side as soon as it is read.*/
+    res = CB_IS_EMPTY(_this);
+  }
+  else
+  {
+    SYS_ENTER_CRITICAL(cs);
+    res = CB_IS_EMPTY(_this);
+    SYS_EXIT_CRITICAL(cs);
+  }
 
   return res;
 }
@@ -171,9 +201,17 @@ bool CB_IsFull(CircularBuffer *_this)
   bool res = false;
   SYS_DECLARE_CS(cs);
 
-  SYS_ENTER_CRITICAL(cs);
-  res = CB_IS_FULL(_this);
-  SYS_EXIT_CRITICAL(cs);
+  if(_this->spsc)
+  {
+    /* snapshot of the buffer: it can be changed by the other side as soon as it is read.*/
+    res = CB_IS_FULL(_this);
+  }
+  else
+  {
+    SYS_ENTER_CRITICAL(cs);
+    res = CB_IS_FULL(_this);
+    SYS_EXIT_CRITICAL(cs);
+  }
 
   return res;
 }
@@ -184,19 +222,27 @@ uint32_t CB_GetUsedItemsCount(CircularBuffer *_this)
   uint32_t items = 0;
   SYS_DECLARE_CS(cs);
 
-  SYS_ENTER_CRITICAL(cs);
-  if(!CB_IS_EMPTY(_this))
+  if(!_this->spsc)
   {
-    if(_this->head_idx > _this->tail_idx)
+    SYS_ENTER_CRITICAL(cs);
+  }
+  uint16_t head_idx = CB_HEAD_IDX(_this);
+  uint16_t tail_idx = CB_TAIL_IDX(_this);
+  if((head_idx != tail_idx) || (CB_ITEM_STATUS(&_this->p_items[head_idx]) != CB_ITEM_FREE))
+  {
+    if(head_idx > tail_idx)
     {
-      items = _this->head_idx - _this->tail_idx;
+      items = head_idx - tail_idx;
     }
     else
     {
-      items = _this->item_count - (_this->tail_idx - _this->head_idx);
+      items = _this->item_count - (tail_idx - head_idx);
     }
   }
-  SYS_EXIT_CRITICAL(cs);
+  if(!_this->spsc)
+  {
+    SYS_EXIT_CRITICAL(cs);
+  }
 
   return items;
 }
@@ -234,14 +280,20 @@ uint16_t CB_GetFreeItemFromHead(CircularBuffer *_this, CBItem **p_item)
   uint16_t res = SYS_NO_ERROR_CODE;
   SYS_DECLARE_CS(cs);
 
+  if(_this->spsc)
+  {
+    return CB_SPSCGetFreeItemFromHead(_this, p_item);
+  }
+
   SYS_ENTER_CRITICAL(cs);
-  if(_this->p_items[_this->head_idx].status.status == CB_ITEM_FREE)
+  uint16_t head_idx = CB_HEAD_IDX(_this);
+  if(CB_ITEM_STATUS(&_this->p_items[head_idx]) == CB_ITEM_FREE)
   {
-    *p_item = &_this->p_items[_this->head_idx];
+    *p_item = &_this->p_items[head_idx];
     /* Mark the item as NEW */
-    (*p_item)->status.status = CB_ITEM_NEW;
+    CB_SET_ITEM_STATUS(*p_item, CB_ITEM_NEW);
     /* Increment the head pointer */
-    _this->head_idx = CB_INCREMENT_IDX(_this, _this->head_idx);
+    CB_SET_HEAD_IDX(_this, CB_INCREMENT_IDX(_this, head_idx));
   }
   else
   {
@@ -260,12 +312,18 @@ uint16_t CB_GetReadyItemFromTail(CircularBuffer *_this, CBItem **p_item)
   uint16_t res = SYS_NO_ERROR_CODE;
   SYS_DECLARE_CS(cs);
 
+  if(_this->spsc)
+  {
+    return CB_SPSCGetReadyItemFromTail(_this, p_item);
+  }
+
   SYS_ENTER_CRITICAL(cs);
-  if(_this->p_items[_this->tail_idx].status.status == CB_ITEM_READY)
+  uint16_t tail_idx = CB_TAIL_IDX(_this);
+  if(CB_ITEM_STATUS(&_this->p_items[tail_idx]) == CB_ITEM_READY)
   {
-    *p_item = &_this->p_items[_this->tail_idx];
+    *p_item = &_this->p_items[tail_idx];
     /* increment the tail pointer */
-    _this->tail_idx = CB_INCREMENT_IDX(_this, _this->tail_idx);
+    CB_SET_TAIL_IDX(_this, CB_INCREMENT_IDX(_this, tail_idx));
   }
   else
   {
@@ -284,10 +342,13 @@ uint16_t CB_ReleaseItem(CircularBuffer *_this, CBItem *p_item)
   uint16_t res = SYS_NO_ERROR_CODE;
   SYS_DECLARE_CS(cs);
 
-  UNUSED(_this);
+  if(_this->spsc)
+  {
+    return CB_SPSCReleaseItem(_this, p_item);
+  }
 
   SYS_ENTER_CRITICAL(cs);
-  if(p_item->status.status == CB_ITEM_NEW)
+  if(CB_ITEM_STATUS(p_item) == CB_ITEM_NEW)
   {
     /* the item is not valid because it has been only allocated but not produced. */
     res = SYS_CB_INVALID_ITEM_ERROR_CODE;
@@ -295,7 +356,7 @@ uint16_t CB_ReleaseItem(CircularBuffer *_this, CBItem *p_item)
   else
   {
     /* item is already FREE or READY, so I can release it. */
-    p_item->status.status = CB_ITEM_FREE;
+    CB_SET_ITEM_STATUS(p_item, CB_ITEM_FREE);
   }
   SYS_EXIT_CRITICAL(cs);
 
@@ -309,10 +370,13 @@ uint16_t CB_SetItemReady(CircularBuffer *_this, CBItem *p_item)
   uint16_t res = SYS_NO_ERROR_CODE;
   SYS_DECLARE_CS(cs);
 
-  UNUSED(_this);
+  if(_this->spsc)
+  {
+    return CB_SPSCSetItemReady(_this, p_item);
+  }
 
   SYS_ENTER_CRITICAL(cs);
-  if(p_item->status.status == CB_ITEM_FREE)
+  if(CB_ITEM_STATUS(p_item) == CB_ITEM_FREE)
   {
     /* the item is not valid because it has not been allocated */
     res = SYS_CB_INVALID_ITEM_ERROR_CODE;
@@ -320,7 +384,7 @@ uint16_t CB_SetItemReady(CircularBuffer *_this, CBItem *p_item)
   else
   {
     /* the item is already READY or NEW, so I can mark as READY. */
-    p_item->status.status = CB_ITEM_READY;
+    CB_SET_ITEM_STATUS(p_item, CB_ITEM_READY);
   }
   SYS_EXIT_CRITICAL(cs);
 
@@ -373,4 +437,90 @@ CBItem* CB_PeekNextItem(CircularBuffer *_this, CBItem *p_item)
 // Private functions definition
 // ****************************
 
+/* In SPSC mode the head index and the NEW state belong to the producer, the tail index to the consumer.
+ * The ownership of an item passes from one side to the other through its status:
+ * - READY is stored with release semantic by the producer and loaded with acquire semantic by the consumer,
+ *   so the consumer sees the produced data.
+ * - FREE is stored with release semantic by the consumer and loaded with acquire semantic by the producer,
+ *   so the producer does not overwrite data still being read.
+ */
+
+static uint16_t CB_SPSCGetFreeItemFromHead(CircularBuffer *_this, CBItem **p_item)
+{
+  uint16_t res = SYS_NO_ERROR_CODE;
+  uint16_t head_idx = CB_HEAD_IDX(_this);
+  CBItem *p_head = &_this->p_items[head_idx];
+
+  if(atomic_load_explicit(&p_head->status, memory_order_acquire) == CB_ITEM_FREE)
+  {
+    /* Mark the item as NEW. The consumer ignores NEW items, so there is no ordering to enforce. */
+    CB_SET_ITEM_STATUS(p_head, CB_ITEM_NEW);
+    CB_SET_HEAD_IDX(_this, CB_INCREMENT_IDX(_this, head_idx));
+    *p_item = p_head;
+  }
+  else
+  {
+    *p_item = NULL;
+    res = SYS_CB_FULL_ERROR_CODE;
+  }
+
+  return res;
+}
+
+static uint16_t CB_SPSCGetReadyItemFromTail(CircularBuffer *_this, CBItem **p_item)
+{
+  uint16_t res = SYS_NO_ERROR_CODE;
+  uint16_t tail_idx = CB_TAIL_IDX(_this);
+  CBItem *p_tail = &_this->p_items[tail_idx];
+
+  if(atomic_load_explicit(&p_tail->status, memory_order_acquire) == CB_ITEM_READY)
+  {
+    CB_SET_TAIL_IDX(_this, CB_INCREMENT_IDX(_this, tail_idx));
+    *p_item = p_tail;
+  }
+  else
+  {
+    *p_item = NULL;
+    res = SYS_CB_NO_READY_ITEM_ERROR_CODE;
+  }
+
+  return res;
+}
+
+static uint16_t CB_SPSCReleaseItem(CircularBuffer *_this, CBItem *p_item)
+{
+  uint16_t res = SYS_NO_ERROR_CODE;
+
+  UNUSED(_this);
 
+  if(CB_ITEM_STATUS(p_item) == CB_ITEM_NEW)
+  {
+    /* the item is not valid because it has been only allocated but not produced. */
+    res = SYS_CB_INVALID_ITEM_ERROR_CODE;
+  }
+  else
+  {
+    atomic_store_explicit(&p_item->status, CB_ITEM_FREE, memory_order_release);
+  }
+
+  return res;
+}
+
+static uint16_t CB_SPSCSetItemReady(CircularBuffer *_this, CBItem *p_item)
+{
+  uint16_t res = SYS_NO_ERROR_CODE;
+
+  UNUSED(_this);
+
+  if(CB_ITEM_STATUS(p_item) == CB_ITEM_FREE)
+  {
+    /* the item is not valid because it has not been allocated */
+    res = SYS_CB_INVALID_ITEM_ERROR_CODE;
+  }
+  else
+  {
+    atomic_store_explicit(&p_item->status, CB_ITEM_READY, memory_order_release);
+  }
+
+  return res;
+}
@@ -0,0 +1,190 @@
+/**
+  ******************************************************************************
+  * @file    cb_spsc_stress.c
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host stress test of the lock-free SPSC mode of the eLooM CircularBuffer
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* A producer thread and a consumer thread exchange items through a CircularBuffer allocated with CB_AllocSPSC().
+ * - The producer writes in each item a sequence number and its complement, then marks it ready.
+ * - The consumer checks that the items come in sequence (no loss, no duplicate, no reordering) and that the
+ *   payload is complete (the data written before CB_SetItemReady() is visible after CB_GetReadyItemFromTail()).
+ * - The buffer is small, so the producer finds it full and the consumer finds it empty very often.
+ * The same exchange is then timed with the default mode, where the eLooM critical section is a mutex.
+ * Usage: cb_spsc_stress [spsc_items [locked_items]], by default 10^8 and 10^7 items.
+ * The program returns 1 when an error is found.
+ *
+ * From application_code/sensing_thread_x/STM32U5 (the eLooM services headers need the MCU headers, so they are
+ * replaced by the definitions below and CircularBuffer.c is included in this file):
+ *   gcc -O2 -Wall -pthread -IProjects/eLooM_Components/EMData/Inc -IMiddlewares/ST/eLooM/Inc \
+ *       Tools/cb_spsc_stress.c -o cb_spsc_stress && ./cb_spsc_stress
+ * With -fsanitize=thread and fewer items (e.g. 10^6) the data race detector must stay silent.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* services/systp.h, services/sysmem.h and services/syscs.h for the host */
+#define SYSTARGETPLATFORM_H_
+#define INCLUDE_SERVICES_SYSMEM_H_
+#define ELOOM_INC_SERVICES_SYSCS_H_
+
+#define assert_param(expr)       ((void)0)
+#define UNUSED(x)                ((void)(x))
+#define SysAlloc(size)           malloc(size)
+#define SysFree(p)               free(p)
+
+static pthread_mutex_t stress_cs = PTHREAD_MUTEX_INITIALIZER;
+#define SYS_DECLARE_CS(cs)       int cs = 0
+#define SYS_ENTER_CRITICAL(cs)   ((void)(cs), pthread_mutex_lock(&stress_cs))
+#define SYS_EXIT_CRITICAL(cs)    ((void)(cs), pthread_mutex_unlock(&stress_cs))
+
+#include "../Projects/eLooM_Components/EMData/Src/services/CircularBuffer.c"
+
+#define STRESS_CB_ITEMS          8U
+
+typedef struct
+{
+  uint64_t seq;
+  uint64_t check;
+} stress_item_t;
+
+typedef struct
+{
+  CircularBuffer *p_cb;
+  uint64_t n_items;
+  uint64_t n_full;
+  uint64_t n_empty;
+  uint64_t n_errors;
+} stress_ctx_t;
+
+static stress_item_t stress_items[STRESS_CB_ITEMS];
+
+static double stress_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *stress_producer(void *p_arg)
+{
+  stress_ctx_t *p_ctx = (stress_ctx_t *)p_arg;
+  CBItem *p_item;
+
+  for (uint64_t seq = 0; seq < p_ctx->n_items; seq++)
+  {
+    while (CB_GetFreeItemFromHead(p_ctx->p_cb, &p_item) != SYS_NO_ERROR_CODE)
+    {
+      p_ctx->n_full++;
+      sched_yield();
+    }
+    stress_item_t *p_data = (stress_item_t *)CB_GetItemData(p_item);
+    p_data->seq = seq;
+    p_data->check = ~seq;
+    if (CB_SetItemReady(p_ctx->p_cb, p_item) != SYS_NO_ERROR_CODE)
+    {
+      p_ctx->n_errors++;
+    }
+  }
+
+  return NULL;
+}
+
+static void *stress_consumer(void *p_arg)
+{
+  stress_ctx_t *p_ctx = (stress_ctx_t *)p_arg;
+  CBItem *p_item;
+
+  for (uint64_t seq = 0; seq < p_ctx->n_items; seq++)
+  {
+    while (CB_GetReadyItemFromTail(p_ctx->p_cb, &p_item) != SYS_NO_ERROR_CODE)
+    {
+      p_ctx->n_empty++;
+      sched_yield();
+    }
+    stress_item_t *p_data = (stress_item_t *)CB_GetItemData(p_item);
+    if ((p_data->seq != seq) || (p_data->check != ~seq))
+    {
+      if (p_ctx->n_errors++ < 10U)
+      {
+        printf("item %llu: got %llu (check %llx)\n", (unsigned long long)seq, (unsigned long long)p_data->seq,
+               (unsigned long long)p_data->check);
+      }
+    }
+    if (CB_ReleaseItem(p_ctx->p_cb, p_item) != SYS_NO_ERROR_CODE)
+    {
+      p_ctx->n_errors++;
+    }
+  }
+
+  return NULL;
+}
+
+static int stress_run(bool spsc, uint64_t n_items)
+{
+  stress_ctx_t prod = { 0 }, cons = { 0 };
+  pthread_t th_prod, th_cons;
+  CircularBuffer *p_cb = spsc ? CB_AllocSPSC(STRESS_CB_ITEMS) : CB_Alloc(STRESS_CB_ITEMS);
+  double t0;
+  int failed;
+
+  if ((p_cb == NULL) || (CB_IsSPSC(p_cb) != spsc))
+  {
+    printf("allocation failed\n");
+    return 1;
+  }
+  (void)CB_Init(p_cb, stress_items, sizeof(stress_item_t));
+  prod.p_cb = cons.p_cb = p_cb;
+  prod.n_items = cons.n_items = n_items;
+
+  t0 = stress_now();
+  pthread_create(&th_cons, NULL, stress_consumer, &cons);
+  pthread_create(&th_prod, NULL, stress_producer, &prod);
+  pthread_join(th_prod, NULL);
+  pthread_join(th_cons, NULL);
+  t0 = stress_now() - t0;
+
+  /* all the items have been consumed and released */
+  failed = (prod.n_errors + cons.n_errors != 0U) || !CB_IsEmpty(p_cb) || (CB_GetUsedItemsCount(p_cb) != 0U);
+
+  printf("%-6s %11llu items | %6.1f ns/item | full %llu empty %llu | errors %llu | %s\n", spsc ? "spsc" : "locked",
+         (unsigned long long)n_items, t0 * 1e9 / n_items, (unsigned long long)prod.n_full,
+         (unsigned long long)cons.n_empty, (unsigned long long)(prod.n_errors + cons.n_errors),
+         failed ? "FAILED" : "OK");
+  CB_Free(p_cb);
+
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t spsc_items = (argc > 1) ? strtoull(argv[1], NULL, 0) : 100000000ULL;
+  uint64_t locked_items = (argc > 2) ? strtoull(argv[2], NULL, 0) : 10000000ULL;
+  int failed = 0;
+
+  failed |= stress_run(true, spsc_items);
+  if (locked_items > 0U)
+  {
+    failed |= stress_run(false, locked_items);
+  }
+  printf("%s\n", failed ? "FAILED" : "OK");
+
+  return failed;
+}
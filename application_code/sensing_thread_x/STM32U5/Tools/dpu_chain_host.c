@@ -0,0 +1,401 @@
+/**
+  ******************************************************************************
+  * @file    dpu_chain_host.c
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host demonstration of the zero-copy DPU chaining of ADPU2
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Runs the sensing chain of the application on the host, with the eLooM components of the firmware:
+ *   mock microphone -> feature DPU (like PreProc_DPU) -> classifier DPU (like AI_DPU) -> result listener
+ * - The mock microphone is an ISourceObservable sending int16 chunks of MOCK_CHUNK samples.
+ * - The feature DPU computes a (band x time) int8 patch, the whole patch at each process.
+ * - The classifier DPU reads the patch in place and computes float results. It is processed when the
+ *   application is notified, as the DPT1 tasks do.
+ * The chain is run with the copy by the data builder, then with ADPU2_SetZeroCopyChain(). The program checks that
+ * the results are identical, that the zero-copy run does not use the data builder of the chain, and that the
+ * classifier DPU reads the patch at the address where the feature DPU has written it.
+ * The program returns 1 when a check fails.
+ *
+ * From application_code/sensing_thread_x/STM32U5 (see eloom_host.h for the services replaced on the host):
+ *   S=Projects/eLooM_Components; E=Middlewares/ST/eLooM
+ *   gcc -O2 -Wall -include Tools/eloom_host.h -I$S/DPU/Inc -I$S/EMData/Inc -I$E/Inc \
+ *       -IProjects/B-U585I-IOT02A/Applications/GS/Core/Inc Tools/dpu_chain_host.c $S/DPU/Src/ADPU2.c \
+ *       $S/DPU/Src/DefDataBuilder.c $S/EMData/Src/services/CircularBuffer.c $S/EMData/Src/services/em_data_format.c \
+ *       $S/EMData/Src/events/DataEventSrc.c $E/Src/events/AEventSrc.c -lm -o dpu_chain_host && ./dpu_chain_host
+ */
+#include "ADPU2.h"
+#include "ADPU2_vtbl.h"
+#include "DefDataBuilder.h"
+#include "DefDataBuilder_vtbl.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MOCK_SRC_ID          1U
+#define MOCK_CHUNK           160U
+#define MOCK_CHUNKS          800U
+
+#define FEAT_BANDS           8U
+#define FEAT_COLS            10U
+#define FEAT_HOP             64U
+#define FEAT_IN              (FEAT_COLS * FEAT_HOP)
+
+#define CLASS_OUT            2U
+#define CHAIN_ITEMS          2U
+#define CHAIN_MAX_RESULTS    (MOCK_CHUNKS * MOCK_CHUNK / FEAT_IN)
+
+sys_error_t g_nSysError;
+
+void sys_error_handler(void)
+{
+  printf("sys_error_handler: error 0x%x\n", (unsigned)g_nSysError.error_code);
+  exit(1);
+}
+
+
+/* Mock microphone */
+/*******************/
+
+typedef struct
+{
+  ISourceObservable super;
+  DataEventSrc_t evt_src;
+  uint32_t noise_state;
+  int16_t chunk[MOCK_CHUNK];
+} MockMic_t;
+
+static uint8_t MockMic_GetId(ISourceObservable *_this)
+{
+  UNUSED(_this);
+  return MOCK_SRC_ID;
+}
+
+static IEventSrc *MockMic_GetEventSrcIF(ISourceObservable *_this)
+{
+  return (IEventSrc *)&((MockMic_t *)_this)->evt_src;
+}
+
+static EMData_t MockMic_GetDataInfo(ISourceObservable *_this)
+{
+  EMData_t data;
+
+  (void)EMD_1dInit(&data, (uint8_t *)((MockMic_t *)_this)->chunk, E_EM_INT16, MOCK_CHUNK);
+  return data;
+}
+
+static sys_error_code_t MockMic_GetODR(ISourceObservable *_this, float *p_measured, float *p_nominal)
+{
+  UNUSED(_this);
+  *p_measured = *p_nominal = 16000.0f;
+  return SYS_NO_ERROR_CODE;
+}
+
+static float MockMic_GetFS(ISourceObservable *_this)
+{
+  UNUSED(_this);
+  return 130.0f;
+}
+
+static float MockMic_GetSensitivity(ISourceObservable *_this)
+{
+  UNUSED(_this);
+  return 1.0f;
+}
+
+static const ISourceObservable_vtbl sMockMicVtbl = {
+    MockMic_GetId,
+    MockMic_GetEventSrcIF,
+    MockMic_GetDataInfo,
+    MockMic_GetODR,
+    MockMic_GetFS,
+    MockMic_GetSensitivity
+};
+
+/* Noisy tone with a slowly varying level, one chunk after the other */
+static void MockMic_Send(MockMic_t *_this, uint32_t chunk_idx)
+{
+  EMData_t data = MockMic_GetDataInfo((ISourceObservable *)_this);
+  DataEvent_t evt;
+
+  for (uint32_t i = 0; i < MOCK_CHUNK; i++)
+  {
+    uint32_t t = chunk_idx * MOCK_CHUNK + i;
+    _this->noise_state ^= _this->noise_state << 13;
+    _this->noise_state ^= _this->noise_state >> 17;
+    _this->noise_state ^= _this->noise_state << 5;
+    _this->chunk[i] = (int16_t)((4000.0 + 3000.0 * sin(t * 1e-3)) * sin(t * 0.3) +
+                                (int32_t)(_this->noise_state & 0x1FFU) - 0x100);
+  }
+  (void)DataEventInit((IEvent *)&evt, (IEventSrc *)&_this->evt_src, &data, 0.0, MOCK_SRC_ID);
+  (void)IEventSrcSendEvent((IEventSrc *)&_this->evt_src, (IEvent *)&evt, NULL);
+}
+
+
+/* Feature DPU: band energies of the last FEAT_IN samples */
+/**********************************************************/
+
+typedef struct
+{
+  ADPU2_t super;
+  int8_t out_buff[FEAT_BANDS * FEAT_COLS];
+  uint8_t *p_last_out;
+} FeatDPU_t;
+
+static sys_error_code_t FeatDPU_vtblProcess(IDPU2_t *_this, EMData_t in_data, EMData_t out_data)
+{
+  FeatDPU_t *p_obj = (FeatDPU_t *)_this;
+  int16_t *p_in = (int16_t *)EMD_Data(&in_data);
+  int8_t *p_out = (int8_t *)EMD_Data(&out_data);
+
+  for (uint32_t c = 0; c < FEAT_COLS; c++)
+  {
+    for (uint32_t b = 0; b < FEAT_BANDS; b++)
+    {
+      int32_t acc = 0;
+      for (uint32_t i = 0; i < FEAT_HOP / FEAT_BANDS; i++)
+      {
+        acc += abs(p_in[c * FEAT_HOP + b * (FEAT_HOP / FEAT_BANDS) + i]);
+      }
+      p_out[b * FEAT_COLS + c] = (int8_t)((acc >> 9) - 128);
+    }
+  }
+  p_obj->p_last_out = EMD_Data(&out_data);
+
+  return SYS_NO_ERROR_CODE;
+}
+
+static const IDPU2_vtbl sFeatDPUVtbl = {
+    ADPU2_vtblAttachToDataSource,
+    ADPU2_vtblDetachFromDataSource,
+    ADPU2_vtblAttachToDPU,
+    ADPU2_vtblDetachFromDPU,
+    ADPU2_vtblDispatchEvents,
+    ADPU2_vtblRegisterNotifyCallback,
+    FeatDPU_vtblProcess
+};
+
+
+/* Classifier DPU: sum and maximum of the patch */
+/************************************************/
+
+typedef struct
+{
+  ADPU2_t super;
+  float out_buff[CLASS_OUT];
+  FeatDPU_t *p_feat;
+  uint32_t in_place;
+} ClassDPU_t;
+
+static sys_error_code_t ClassDPU_vtblProcess(IDPU2_t *_this, EMData_t in_data, EMData_t out_data)
+{
+  ClassDPU_t *p_obj = (ClassDPU_t *)_this;
+  int8_t *p_in = (int8_t *)EMD_Data(&in_data);
+  float *p_out = (float *)EMD_Data(&out_data);
+  float sum = 0.0f, max = -128.0f;
+
+  for (uint32_t i = 0; i < FEAT_BANDS * FEAT_COLS; i++)
+  {
+    sum += p_in[i];
+    max = (p_in[i] > max) ? p_in[i] : max;
+  }
+  p_out[0] = sum;
+  p_out[1] = max;
+  p_obj->in_place += (EMD_Data(&in_data) == p_obj->p_feat->p_last_out);
+
+  return SYS_NO_ERROR_CODE;
+}
+
+static const IDPU2_vtbl sClassDPUVtbl = {
+    ADPU2_vtblAttachToDataSource,
+    ADPU2_vtblDetachFromDataSource,
+    ADPU2_vtblAttachToDPU,
+    ADPU2_vtblDetachFromDPU,
+    ADPU2_vtblDispatchEvents,
+    ADPU2_vtblRegisterNotifyCallback,
+    ClassDPU_vtblProcess
+};
+
+
+/* Data builder of the chain, counting the copied bytes */
+/********************************************************/
+
+static uint32_t chain_copied_bytes;
+
+static sys_error_code_t CountDB_vtblOnNewInData(IDataBuilder_t *_this, EMData_t *p_target_data,
+                                                const EMData_t *p_new_in_data, IDB_BuildStrategy_e build_strategy,
+                                                DataBuffAllocator_f data_buff_alloc)
+{
+  chain_copied_bytes += EMD_GetPayloadSize(p_new_in_data);
+  return DefDB_vtblOnNewInData(_this, p_target_data, p_new_in_data, build_strategy, data_buff_alloc);
+}
+
+static const IDataBuilder_vtbl sCountDBVtbl = {
+    DefDB_vtblOnReset,
+    CountDB_vtblOnNewInData
+};
+
+
+/* Result listener */
+/*******************/
+
+typedef struct
+{
+  IDataEventListener_t super;
+  void *p_owner;
+  float results[CHAIN_MAX_RESULTS][CLASS_OUT];
+  uint32_t n_results;
+} ResultListener_t;
+
+static sys_error_code_t Result_OnStatusChange(IListener *_this)
+{
+  UNUSED(_this);
+  return SYS_NO_ERROR_CODE;
+}
+
+static void Result_SetOwner(IEventListener *_this, void *p_owner)
+{
+  ((ResultListener_t *)_this)->p_owner = p_owner;
+}
+
+static void *Result_GetOwner(IEventListener *_this)
+{
+  return ((ResultListener_t *)_this)->p_owner;
+}
+
+static sys_error_code_t Result_OnNewDataReady(IEventListener *_this, const DataEvent_t *p_evt)
+{
+  ResultListener_t *p_obj = (ResultListener_t *)_this;
+
+  if (p_obj->n_results < CHAIN_MAX_RESULTS)
+  {
+    memcpy(p_obj->results[p_obj->n_results++], EMD_Data(p_evt->p_data), sizeof(p_obj->results[0]));
+  }
+  return SYS_NO_ERROR_CODE;
+}
+
+static const IDataEventListener_vtbl sResultVtbl = {
+    Result_OnStatusChange,
+    Result_SetOwner,
+    Result_GetOwner,
+    Result_OnNewDataReady
+};
+
+
+/* Chain */
+/*********/
+
+static MockMic_t mic;
+static FeatDPU_t feat;
+static ClassDPU_t classifier;
+static DefDataBuilder_t mic_builder;
+static DefDataBuilder_t chain_builder;
+static ResultListener_t listener[2];
+static bool classifier_ready;
+
+static void chain_on_classifier_ready(IDPU2_t *_this, void *p_param)
+{
+  UNUSED(_this);
+  UNUSED(p_param);
+  classifier_ready = true;
+}
+
+static void chain_run(bool zero_copy, ResultListener_t *p_listener)
+{
+  static int16_t feat_in_buff[CHAIN_ITEMS * FEAT_IN];
+  static int8_t class_in_buff[CHAIN_ITEMS * FEAT_BANDS * FEAT_COLS];
+  EMData_t in_data, out_data;
+
+  memset(&mic, 0, sizeof(mic));
+  memset(&feat, 0, sizeof(feat));
+  memset(&classifier, 0, sizeof(classifier));
+  chain_copied_bytes = 0;
+
+  mic.super.vptr = &sMockMicVtbl;
+  mic.noise_state = 1U;
+  (void)DataEventSrcAllocStatic(&mic.evt_src);
+  (void)IEventSrcInit((IEventSrc *)&mic.evt_src);
+
+  ((IDPU2_t *)&feat)->vptr = &sFeatDPUVtbl;
+  (void)EMD_1dInit(&in_data, NULL, E_EM_INT16, FEAT_IN);
+  (void)EMD_Init(&out_data, NULL, E_EM_INT8, E_EM_MODE_LINEAR, 2U, FEAT_BANDS, FEAT_COLS);
+  (void)ADPU2_Init((ADPU2_t *)&feat, in_data, out_data);
+  (void)ADPU2_SetInDataBuffer((ADPU2_t *)&feat, (uint8_t *)feat_in_buff, sizeof(feat_in_buff));
+  (void)ADPU2_SetOutDataBuffer((ADPU2_t *)&feat, (uint8_t *)feat.out_buff, sizeof(feat.out_buff));
+
+  ((IDPU2_t *)&classifier)->vptr = &sClassDPUVtbl;
+  classifier.p_feat = &feat;
+  in_data = out_data;
+  (void)EMD_1dInit(&out_data, NULL, E_EM_FLOAT, CLASS_OUT);
+  (void)ADPU2_Init((ADPU2_t *)&classifier, in_data, out_data);
+  (void)ADPU2_SetInDataBufferSPSC((ADPU2_t *)&classifier, true);
+  (void)ADPU2_SetInDataBuffer((ADPU2_t *)&classifier, (uint8_t *)class_in_buff, sizeof(class_in_buff));
+  (void)ADPU2_SetOutDataBuffer((ADPU2_t *)&classifier, (uint8_t *)classifier.out_buff, sizeof(classifier.out_buff));
+  (void)IDPU2_RegisterNotifyCallback((IDPU2_t *)&classifier, chain_on_classifier_ready, NULL);
+
+  (void)IDPU2_AttachToDataSource((IDPU2_t *)&feat, (ISourceObservable *)&mic, DefDB_AllocStatic(&mic_builder),
+                                 E_IDB_NO_DATA_LOSS);
+  chain_builder.super.vptr = &sCountDBVtbl;
+  (void)IDPU2_AttachToDPU((IDPU2_t *)&feat, (IDPU2_t *)&classifier, (IDataBuilder_t *)&chain_builder,
+                          E_IDB_NO_DATA_LOSS);
+  (void)ADPU2_SetZeroCopyChain((ADPU2_t *)&feat, zero_copy);
+
+  p_listener->super.vptr = &sResultVtbl;
+  p_listener->n_results = 0;
+  (void)IEventSrcAddEventListener(ADPU2_GetEventSrcIF((ADPU2_t *)&classifier), (IEventListener *)p_listener);
+
+  for (uint32_t i = 0; i < MOCK_CHUNKS; i++)
+  {
+    MockMic_Send(&mic, i);
+    /* the DPT1 task of the classifier */
+    while (classifier_ready)
+    {
+      classifier_ready = false;
+      while (ADPU2_ProcessAndDispatch((ADPU2_t *)&classifier) == SYS_NO_ERROR_CODE)
+      {
+      }
+    }
+  }
+
+  (void)ADPU2_SetInDataBuffer((ADPU2_t *)&feat, NULL, 0U);
+  (void)ADPU2_SetInDataBuffer((ADPU2_t *)&classifier, NULL, 0U);
+}
+
+int main(void)
+{
+  int failed = 0;
+
+  for (uint32_t zero_copy = 0; zero_copy <= 1U; zero_copy++)
+  {
+    ResultListener_t *p_listener = &listener[zero_copy];
+    uint32_t expected_bytes;
+
+    chain_run(zero_copy != 0U, p_listener);
+    expected_bytes = zero_copy ? 0U : p_listener->n_results * FEAT_BANDS * FEAT_COLS;
+    failed |= (p_listener->n_results != CHAIN_MAX_RESULTS) || (chain_copied_bytes != expected_bytes) ||
+              (classifier.in_place != (zero_copy ? p_listener->n_results : 0U));
+
+    printf("%-9s %3u results | chain copy %6u bytes | classifier input in place %3u\n",
+           zero_copy ? "zero-copy" : "copy", (unsigned)p_listener->n_results, (unsigned)chain_copied_bytes,
+           (unsigned)classifier.in_place);
+  }
+
+  if (memcmp(listener[0].results, listener[1].results, sizeof(listener[0].results)) != 0)
+  {
+    printf("results differ\n");
+    failed = 1;
+  }
+  printf("%s\n", failed ? "FAILED" : "OK");
+
+  return failed;
+}
@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file    eloom_host.h
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host replacement of the MCU and RTOS dependent eLooM services
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* To be force-included (gcc -include Tools/eloom_host.h) in every file of a host build of the eLooM components.
+ * It defines the include guards of services/systp.h, sysmem.h, syscs.h, sysdebug.h and SysTimestamp.h, which
+ * need the MCU headers and the RTOS, and provides the few definitions used by the components:
+ * - the memory is allocated with malloc(), the critical sections do nothing (one thread),
+ * - the debug log is disabled and the timestamp is always 0.
+ * The other services (syserror.h, systypes.h, the events) are the target ones, syserror.h needs the apperror.h
+ * of the application. The tool defines g_nSysError and sys_error_handler().
+ */
+#ifndef TOOLS_ELOOM_HOST_H_
+#define TOOLS_ELOOM_HOST_H_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* services/systp.h */
+#define SYSTARGETPLATFORM_H_
+#define SYS_DEFINE_INLINE          inline
+#define SYS_DEFINE_STATIC_INLINE   static inline
+#define UNUSED(x)                  ((void)(x))
+#define assert_param(expr)         assert(expr)
+
+/* services/sysmem.h */
+#define INCLUDE_SERVICES_SYSMEM_H_
+#define SysAlloc(size)             malloc(size)
+#define SysFree(p)                 free(p)
+
+/* services/syscs.h */
+#define ELOOM_INC_SERVICES_SYSCS_H_
+#define SYS_DECLARE_CS(cs)         int cs = 0
+#define SYS_ENTER_CRITICAL(cs)     ((void)(cs))
+#define SYS_EXIT_CRITICAL(cs)      ((void)(cs))
+
+/* services/sysdebug.h */
+#define SYSDEBUG_H_
+#define SYS_DEBUGF3(dbg, level, message)
+#define SYS_DBG_LEVEL_ALL          0x00U
+#define SYS_DBG_LEVEL_VERBOSE      0x01U
+#define SYS_DBG_LEVEL_LLA          0x02U
+#define SYS_DBG_LEVEL_SL           0x03U
+#define SYS_DBG_LEVEL_DEFAULT      0x04U
+#define SYS_DBG_LEVEL_WARNING      0x05U
+#define SYS_DBG_LEVEL_SEVERE       0x06U
+
+/* services/SysTimestamp.h */
+#define ELOOM_INC_SERVICES_SYSTIMESTAMP_H_
+#define SysGetTimestampSrv()       NULL
+#define SysTsGetTimestampF(p_ts)   ((void)(p_ts), 0.0)
+
+#endif /* TOOLS_ELOOM_HOST_H_ */
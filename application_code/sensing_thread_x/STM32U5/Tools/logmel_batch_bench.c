@@ -0,0 +1,268 @@
+/**
+  ******************************************************************************
+  * @file    logmel_batch_bench.c
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host benchmark of the multi-column log-mel spectrogram
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Times the spectrogram of a patch computed column by column then transposed, as PreProc_DPU did,
+ * against the multi-column functions writing the (mel x time) layout, for the floating-point
+ * (LogMelSpectrogram_q15_Q8) and the fixed-point (LogMelSpectrogramFixed_q15_Q8) paths.
+ * - Configurations: the AED model one (magnitude, HTK, log) and a Slaney power dB one.
+ * - The input is a noisy chirp, the output of both ways must be identical.
+ * - Host timings only give the trend, the gain on the target depends on its caches.
+ * The program returns 1 when the outputs differ.
+ *
+ * From application_code/sensing_thread_x/STM32U5 (the U5 tree only has the CMSIS-DSP headers, the
+ * sources of the same V1.6.0 release are taken from the H7 tree):
+ *   A=Middlewares/ST/STM32_AI_AudioPreprocessing_Library
+ *   D=../../object_detection/STM32H7/Drivers/CMSIS/Core/DSP/Source; T=$D/TransformFunctions
+ *   gcc -O2 -Wall -I$A/Inc -IDrivers/CMSIS/DSP/Include -IDrivers/CMSIS/Include Tools/logmel_batch_bench.c \
+ *       $A/Src/feature_extraction.c $A/Src/mel_filterbank.c $A/Src/window.c $A/Src/dct.c \
+ *       $T/arm_rfft_q31.c $T/arm_rfft_init_q31.c $T/arm_cfft_q31.c $T/arm_cfft_radix4_q31.c \
+ *       $T/arm_rfft_fast_f32.c $T/arm_rfft_fast_init_f32.c $T/arm_cfft_f32.c $T/arm_cfft_radix8_f32.c \
+ *       $T/arm_bitreversal.c $T/arm_bitreversal2.c $D/CommonTables/arm_common_tables.c \
+ *       $D/CommonTables/arm_const_structs.c \
+ *       $D/BasicMathFunctions/arm_mult_f32.c $D/ComplexMathFunctions/arm_cmplx_mag_squared_f32.c \
+ *       -lm -o logmel_batch_bench && ./logmel_batch_bench
+ */
+#include "feature_extraction.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_FFT      1024U
+#define BENCH_MAX_MELS     64U
+#define BENCH_MAX_COEFS    4096U
+#define BENCH_MAX_COLS     96U
+#define BENCH_MAX_SIGNAL   (BENCH_MAX_COLS * 512U + BENCH_MAX_FFT)
+#define BENCH_PATCHES      50U
+
+typedef struct
+{
+  const char *name;
+  uint32_t samp_rate;
+  uint32_t n_fft;
+  uint32_t frame_len;
+  uint32_t hop_len;
+  uint32_t n_mels;
+  uint32_t n_cols;
+  float32_t f_min;
+  float32_t f_max;
+  MelFormulaTypedef formula;
+  uint32_t normalize;
+  Spectrogram_TypeTypedef type;
+  LogMelSpectrogram_ScaleTypedef log_formula;
+  float32_t top_db;
+  int8_t offset;
+  float32_t inv_scale;
+} bench_conf_t;
+
+static const bench_conf_t bench_confs[] = {
+  { "aed", 16000, 512, 400, 160, 64, 96, 125.0f, 7500.0f, MEL_HTK,    0, SPECTRUM_TYPE_MAGNITUDE,
+    LOGMELSPECTROGRAM_SCALE_LOG, HUGE_VALF, 50, 16.0f },
+  { "db",  16000, 512, 512, 256, 40, 64, 0.0f,   8000.0f, MEL_SLANEY, 1, SPECTRUM_TYPE_POWER,
+    LOGMELSPECTROGRAM_SCALE_DB, 80.0f, 65, 2.4f },
+};
+
+/* Float configuration, as set by PreProc_DPUInit */
+static arm_rfft_fast_instance_f32 S_Rfft;
+static MelFilterTypeDef S_MelFilter;
+static SpectrogramTypeDef S_Spectr;
+static MelSpectrogramTypeDef S_MelSpectr;
+static LogMelSpectrogramTypeDef S_LogMelSpectr;
+static float32_t bench_win[BENCH_MAX_FFT];
+static float32_t bench_mel_coefs[BENCH_MAX_COEFS];
+static uint32_t bench_mel_start[BENCH_MAX_MELS];
+static uint32_t bench_mel_stop[BENCH_MAX_MELS];
+static float32_t bench_scratch1[BENCH_MAX_FFT];
+static float32_t bench_scratch2[BENCH_MAX_FFT];
+
+/* Fixed-point configuration */
+static arm_rfft_instance_q31 S_RfftQ31;
+static LogMelSpectrogramFixedTypeDef S_LogMelFixed;
+static q31_t bench_win_q31[BENCH_MAX_FFT];
+static q31_t bench_mel_coefs_q31[BENCH_MAX_COEFS];
+static q31_t bench_scratch_q31_1[BENCH_MAX_FFT];
+static q31_t bench_scratch_q31_2[2 * BENCH_MAX_FFT];
+
+static int16_t bench_signal[BENCH_MAX_SIGNAL];
+static int8_t bench_out_col[BENCH_MAX_MELS * BENCH_MAX_COLS];
+static int8_t bench_out_batch[BENCH_MAX_MELS * BENCH_MAX_COLS];
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Chirp from 100 Hz to 7 kHz at -12 dBFS plus noise at -50 dBFS */
+static void bench_synth(const bench_conf_t *c, uint32_t len)
+{
+  uint32_t state = 1U;
+  double phase = 0.0;
+
+  for (uint32_t t = 0; t < len; t++)
+  {
+    double f = 100.0 + 6900.0 * t / len;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    phase += 2.0 * M_PI * f / c->samp_rate;
+    bench_signal[t] = (int16_t)(8192.0 * sin(phase) + (double)((int32_t)(state & 0x3FFU) - 0x200));
+  }
+}
+
+static void bench_init(const bench_conf_t *c)
+{
+  uint32_t pad = c->n_fft - c->frame_len;
+
+  Window_Init(bench_win, c->frame_len, WINDOW_HANN);
+  arm_rfft_fast_init_f32(&S_Rfft, c->n_fft);
+
+  S_Spectr.pRfft     = &S_Rfft;
+  S_Spectr.Type      = c->type;
+  S_Spectr.pWindow   = bench_win;
+  S_Spectr.SampRate  = c->samp_rate;
+  S_Spectr.FrameLen  = c->frame_len;
+  S_Spectr.FFTLen    = c->n_fft;
+  S_Spectr.pScratch1 = bench_scratch1;
+  S_Spectr.pScratch2 = bench_scratch2;
+  S_Spectr.pad_left  = pad / 2;
+  S_Spectr.pad_right = pad / 2 + (pad & 1);
+
+  S_MelFilter.pStartIndices = bench_mel_start;
+  S_MelFilter.pStopIndices  = bench_mel_stop;
+  S_MelFilter.pCoefficients = bench_mel_coefs;
+  S_MelFilter.NumMels       = c->n_mels;
+  S_MelFilter.FFTLen        = c->n_fft;
+  S_MelFilter.SampRate      = c->samp_rate;
+  S_MelFilter.FMin          = c->f_min;
+  S_MelFilter.FMax          = c->f_max;
+  S_MelFilter.Formula       = c->formula;
+  S_MelFilter.Normalize     = c->normalize;
+  S_MelFilter.Mel2F         = 1U;
+  MelFilterbank_Init(&S_MelFilter);
+
+  S_MelSpectr.SpectrogramConf       = &S_Spectr;
+  S_MelSpectr.MelFilter             = &S_MelFilter;
+  S_LogMelSpectr.MelSpectrogramConf = &S_MelSpectr;
+  S_LogMelSpectr.LogFormula         = c->log_formula;
+  S_LogMelSpectr.Ref                = 1.0f;
+  S_LogMelSpectr.TopdB              = c->top_db;
+
+  S_LogMelFixed.pRfft         = &S_RfftQ31;
+  S_LogMelFixed.pWindow       = bench_win_q31;
+  S_LogMelFixed.pCoefficients = bench_mel_coefs_q31;
+  S_LogMelFixed.pScratch1     = bench_scratch_q31_1;
+  S_LogMelFixed.pScratch2     = bench_scratch_q31_2;
+  if (LogMelSpectrogramFixed_Init(&S_LogMelFixed, &S_LogMelSpectr) != 0)
+  {
+    printf("%s: fixed-point init failed\n", c->name);
+    exit(1);
+  }
+  LogMelSpectrogramFixed_SetQuantization(&S_LogMelFixed, c->offset, c->inv_scale);
+}
+
+/* One patch column by column, then transposed to (mel x time) */
+static void bench_patch_col(const bench_conf_t *c, uint32_t is_fixed)
+{
+  int8_t out[BENCH_MAX_MELS];
+
+  for (uint32_t i = 0; i < c->n_cols; i++)
+  {
+    int16_t *p_in = &bench_signal[i * c->hop_len];
+
+    if (is_fixed)
+    {
+      LogMelSpectrogramFixedColumn_q15_Q8(&S_LogMelFixed, p_in, out);
+    }
+    else
+    {
+      LogMelSpectrogramColumn_q15_Q8(&S_LogMelSpectr, p_in, out, c->offset, c->inv_scale);
+    }
+    for (uint32_t j = 0; j < c->n_mels; j++)
+    {
+      bench_out_col[i + c->n_cols * j] = out[j];
+    }
+  }
+}
+
+static void bench_patch_batch(const bench_conf_t *c, uint32_t is_fixed)
+{
+  if (is_fixed)
+  {
+    LogMelSpectrogramFixed_q15_Q8(&S_LogMelFixed, bench_signal, c->hop_len, c->n_cols, bench_out_batch, c->n_cols);
+  }
+  else
+  {
+    LogMelSpectrogram_q15_Q8(&S_LogMelSpectr, bench_signal, c->hop_len, c->n_cols, bench_out_batch, c->n_cols,
+                             c->offset, c->inv_scale);
+  }
+}
+
+static int bench_conf(const bench_conf_t *c)
+{
+  int failed = 0;
+
+  bench_init(c);
+  bench_synth(c, (c->n_cols - 1) * c->hop_len + c->frame_len);
+
+  for (uint32_t is_fixed = 0; is_fixed <= 1U; is_fixed++)
+  {
+    double t_col = 0.0, t_batch = 0.0, t0;
+    uint32_t nb_diff = 0;
+
+    /* Interleaved runs, so that both ways see the same machine load */
+    for (uint32_t p = 0; p < BENCH_PATCHES; p++)
+    {
+      t0 = bench_now();
+      bench_patch_col(c, is_fixed);
+      t_col += bench_now() - t0;
+
+      t0 = bench_now();
+      bench_patch_batch(c, is_fixed);
+      t_batch += bench_now() - t0;
+    }
+
+    for (uint32_t i = 0; i < c->n_mels * c->n_cols; i++)
+    {
+      nb_diff += (bench_out_col[i] != bench_out_batch[i]);
+    }
+    failed |= (nb_diff != 0U);
+
+    printf("%-4s %-5s %3u x %2u | us/col per column %6.2f batch %6.2f | speedup %.2f | %s\n",
+           c->name, is_fixed ? "fixed" : "float", (unsigned)c->n_cols, (unsigned)c->n_mels,
+           t_col / (BENCH_PATCHES * c->n_cols), t_batch / (BENCH_PATCHES * c->n_cols), t_col / t_batch,
+           (nb_diff == 0U) ? "identical" : "DIFFERENT");
+  }
+
+  return failed;
+}
+
+int main(void)
+{
+  int failed = 0;
+
+  for (uint32_t i = 0; i < sizeof(bench_confs) / sizeof(bench_confs[0]); i++)
+  {
+    failed |= bench_conf(&bench_confs[i]);
+  }
+  printf("%s\n", failed ? "FAILED" : "OK");
+
+  return failed;
+}
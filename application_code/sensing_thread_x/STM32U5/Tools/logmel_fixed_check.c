@@ -0,0 +1,486 @@
+/**
+  ******************************************************************************
+  * @file    logmel_fixed_check.c
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host check of the fixed-point log-mel spectrogram
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Compares LogMelSpectrogramFixedColumn_q15_Q8 to the floating-point LogMelSpectrogramColumn_q15_Q8
+ * on every column of a corpus, built on the real library and CMSIS-DSP sources.
+ * - The corpus is the 16-bit PCM WAV files given as arguments (first channel, read at the sampling
+ *   rate of each configuration), or a synthetic corpus without argument: noise from full scale to
+ *   a few LSBs, tones, chirp, clicks, clipping and digital silence.
+ * - Configurations: the AED model one (magnitude, HTK, log), a Slaney power one and a dB one.
+ * - Each configuration is quantized on the log-mel range of the corpus, then on a 4x finer step.
+ * - Reports the share of the int8 outputs that differ from the float path by 0, 1 and more than
+ *   1 step, the largest error of both paths to the exact (double precision) log-mel, and the time
+ *   per column of both paths (host timings only give the trend).
+ * The program returns 1 when an output is more than one step away from both the float path and
+ * the exact value: far below the peak of a column, the float FFT is not exact either.
+ *
+ * From application_code/sensing_thread_x/STM32U5 (the U5 tree only has the CMSIS-DSP headers, the
+ * sources of the same V1.6.0 release are taken from the H7 tree):
+ *   A=Middlewares/ST/STM32_AI_AudioPreprocessing_Library
+ *   D=../../object_detection/STM32H7/Drivers/CMSIS/Core/DSP/Source; T=$D/TransformFunctions
+ *   gcc -O2 -Wall -I$A/Inc -IDrivers/CMSIS/DSP/Include -IDrivers/CMSIS/Include Tools/logmel_fixed_check.c \
+ *       $A/Src/feature_extraction.c $A/Src/mel_filterbank.c $A/Src/window.c $A/Src/dct.c \
+ *       $T/arm_rfft_q31.c $T/arm_rfft_init_q31.c $T/arm_cfft_q31.c $T/arm_cfft_radix4_q31.c \
+ *       $T/arm_rfft_fast_f32.c $T/arm_rfft_fast_init_f32.c $T/arm_cfft_f32.c $T/arm_cfft_radix8_f32.c \
+ *       $T/arm_bitreversal.c $T/arm_bitreversal2.c $D/CommonTables/arm_common_tables.c \
+ *       $D/CommonTables/arm_const_structs.c \
+ *       $D/BasicMathFunctions/arm_mult_f32.c $D/ComplexMathFunctions/arm_cmplx_mag_squared_f32.c \
+ *       -lm -o logmel_fixed_check && ./logmel_fixed_check [file.wav ...]
+ */
+#include "feature_extraction.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK_MAX_FFT      1024U
+#define CHECK_MAX_MELS     64U
+#define CHECK_MAX_COEFS    4096U
+#define CHECK_SYNTH_LEN    (16000U * 2U)
+
+typedef struct
+{
+  const char *name;
+  uint32_t samp_rate;
+  uint32_t n_fft;
+  uint32_t frame_len;
+  uint32_t hop_len;
+  uint32_t n_mels;
+  float32_t f_min;
+  float32_t f_max;
+  MelFormulaTypedef formula;
+  uint32_t normalize;
+  Spectrogram_TypeTypedef type;
+  LogMelSpectrogram_ScaleTypedef log_formula;
+  float32_t top_db;
+} check_conf_t;
+
+typedef struct
+{
+  const char *name;
+  int16_t *pSamples;
+  uint32_t len;
+} check_signal_t;
+
+static const check_conf_t check_confs[] = {
+  { "aed",    16000, 512,  400,  160, 64, 125.0f, 7500.0f, MEL_HTK,    0, SPECTRUM_TYPE_MAGNITUDE,
+    LOGMELSPECTROGRAM_SCALE_LOG, HUGE_VALF },
+  { "slaney", 16000, 1024, 1024, 512, 30, 0.0f,   8000.0f, MEL_SLANEY, 1, SPECTRUM_TYPE_POWER,
+    LOGMELSPECTROGRAM_SCALE_LOG, HUGE_VALF },
+  { "db",     16000, 512,  512,  256, 40, 0.0f,   8000.0f, MEL_SLANEY, 1, SPECTRUM_TYPE_POWER,
+    LOGMELSPECTROGRAM_SCALE_DB, 80.0f },
+};
+
+/* Float configuration, as set by PreProc_DPUInit */
+static arm_rfft_fast_instance_f32 S_Rfft;
+static MelFilterTypeDef S_MelFilter;
+static SpectrogramTypeDef S_Spectr;
+static MelSpectrogramTypeDef S_MelSpectr;
+static LogMelSpectrogramTypeDef S_LogMelSpectr;
+static float32_t check_win[CHECK_MAX_FFT];
+static float32_t check_mel_coefs[CHECK_MAX_COEFS];
+static uint32_t check_mel_start[CHECK_MAX_MELS];
+static uint32_t check_mel_stop[CHECK_MAX_MELS];
+static float32_t check_scratch1[CHECK_MAX_FFT];
+static float32_t check_scratch2[CHECK_MAX_FFT];
+
+/* Fixed-point configuration */
+static arm_rfft_instance_q31 S_RfftQ31;
+static LogMelSpectrogramFixedTypeDef S_LogMelFixed;
+static q31_t check_win_q31[CHECK_MAX_FFT];
+static q31_t check_mel_coefs_q31[CHECK_MAX_COEFS];
+static q31_t check_scratch_q31_1[CHECK_MAX_FFT];
+static q31_t check_scratch_q31_2[2 * CHECK_MAX_FFT];
+
+static double check_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint32_t check_rand_state = 1U;
+
+static uint32_t check_rand(void)
+{
+  check_rand_state ^= check_rand_state << 13;
+  check_rand_state ^= check_rand_state >> 17;
+  check_rand_state ^= check_rand_state << 5;
+  return check_rand_state;
+}
+
+static float check_noise(void)
+{
+  return ((float)(check_rand() & 0xFFFFU) - 32768.0f) / 32768.0f;
+}
+
+static int16_t check_sat16(float x)
+{
+  x = roundf(x);
+  return (int16_t)((x > 32767.0f) ? 32767.0f : ((x < -32768.0f) ? -32768.0f : x));
+}
+
+static int16_t *check_synth(uint32_t kind, uint32_t len)
+{
+  int16_t *p = malloc(len * sizeof(int16_t));
+  float phase = 0.0f;
+
+  for (uint32_t t = 0; t < len; t++)
+  {
+    float x;
+    switch (kind)
+    {
+    case 0: x = 30000.0f * check_noise(); break;                                    /* full scale noise */
+    case 1: x = 300.0f * check_noise(); break;                                      /* -40 dB noise */
+    case 2: x = 3.0f * check_noise(); break;                                        /* a few LSBs */
+    case 3: x = 12000.0f * sinf(0.1f * t) + 4000.0f * sinf(0.63f * t) + 20.0f * check_noise(); break;
+    case 4: phase += 0.01f + 2.9f * t / len; x = 16000.0f * sinf(phase); break;     /* chirp */
+    case 5: x = ((t % 1999U) < 3U) ? 32000.0f : 2.0f * check_noise(); break;        /* clicks */
+    case 6: x = 3.0f * 32767.0f * sinf(0.05f * t); break;                            /* clipped */
+    case 7: x = ((t / 4000U) & 1U) ? 8000.0f * check_noise() : 0.0f; break;         /* silence bursts */
+    default: x = 0.0f; break;                                                       /* silence */
+    }
+    p[t] = check_sat16(x);
+  }
+  return p;
+}
+
+static uint32_t check_le(const uint8_t *p, uint32_t n)
+{
+  uint32_t v = 0;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    v |= (uint32_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+/* First channel of a 16-bit PCM WAV file */
+static int check_read_wav(const char *path, check_signal_t *pSignal)
+{
+  FILE *f = fopen(path, "rb");
+  uint8_t *buf;
+  long size;
+  uint32_t pos = 12, channels = 0, bits = 0;
+
+  if (f == NULL)
+  {
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = malloc((size_t)size);
+  if ((fread(buf, 1, (size_t)size, f) != (size_t)size) || (size < 12) || memcmp(buf, "RIFF", 4) ||
+      memcmp(buf + 8, "WAVE", 4))
+  {
+    fclose(f);
+    free(buf);
+    return -1;
+  }
+  fclose(f);
+
+  while (pos + 8 <= (uint32_t)size)
+  {
+    uint32_t chunk = check_le(buf + pos + 4, 4);
+    if (!memcmp(buf + pos, "fmt ", 4))
+    {
+      channels = check_le(buf + pos + 10, 2);
+      bits = check_le(buf + pos + 22, 2);
+    }
+    else if (!memcmp(buf + pos, "data", 4) && (bits == 16) && (channels > 0))
+    {
+      chunk = (pos + 8 + chunk > (uint32_t)size) ? (uint32_t)size - pos - 8 : chunk;
+      pSignal->name = path;
+      pSignal->len = chunk / (2 * channels);
+      pSignal->pSamples = malloc(pSignal->len * sizeof(int16_t));
+      for (uint32_t t = 0; t < pSignal->len; t++)
+      {
+        pSignal->pSamples[t] = (int16_t)check_le(buf + pos + 8 + 2 * channels * t, 2);
+      }
+      free(buf);
+      return 0;
+    }
+    pos += 8 + chunk + (chunk & 1U);
+  }
+  free(buf);
+  return -1;
+}
+
+/* In-place radix-2 complex FFT in double precision, for the exact reference */
+static void check_fft_f64(double *re, double *im, uint32_t n)
+{
+  for (uint32_t i = 1, j = 0; i < n; i++)
+  {
+    uint32_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+    {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j)
+    {
+      double t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (uint32_t len = 2; len <= n; len <<= 1)
+  {
+    double ang = -2.0 * M_PI / len;
+    for (uint32_t i = 0; i < n; i += len)
+    {
+      for (uint32_t k = 0; k < len / 2; k++)
+      {
+        double wr = cos(ang * k), wi = sin(ang * k);
+        double xr = re[i + k + len / 2] * wr - im[i + k + len / 2] * wi;
+        double xi = re[i + k + len / 2] * wi + im[i + k + len / 2] * wr;
+        re[i + k + len / 2] = re[i + k] - xr;
+        im[i + k + len / 2] = im[i + k] - xi;
+        re[i + k] += xr;
+        im[i + k] += xi;
+      }
+    }
+  }
+}
+
+/* Exact log-mel column (double precision) of the float configuration, quantized */
+static void check_exact(const check_conf_t *c, int16_t *pIn, int8_t *pOut, int8_t offset, float32_t inv_scale)
+{
+  static double re[CHECK_MAX_FFT], im[CHECK_MAX_FFT];
+  const float32_t *p_coefs = check_mel_coefs;
+
+  memset(re, 0, sizeof(re));
+  memset(im, 0, sizeof(im));
+  for (uint32_t i = 0; i < c->frame_len; i++)
+  {
+    re[S_Spectr.pad_left + i] = pIn[i] / 32768.0 * check_win[i];
+  }
+  check_fft_f64(re, im, c->n_fft);
+  for (uint32_t i = 0; i < c->n_mels; i++)
+  {
+    double mel = 0.0, lm;
+    for (uint32_t j = check_mel_start[i]; j <= check_mel_stop[i]; j++)
+    {
+      double pw = re[j] * re[j] + im[j] * im[j];
+      mel += *p_coefs++ * ((c->type == SPECTRUM_TYPE_POWER) ? pw : sqrt(pw));
+    }
+    mel = (mel > FLT_MIN) ? mel : FLT_MIN;
+    if (c->log_formula == LOGMELSPECTROGRAM_SCALE_DB)
+    {
+      lm = 10.0 * log10(mel);
+      lm = (lm < -c->top_db) ? -c->top_db : lm;
+    }
+    else
+    {
+      lm = log(mel);
+    }
+    pOut[i] = (int8_t)__SSAT((int32_t)round(lm * inv_scale + offset), 8);
+  }
+}
+
+static void check_init(const check_conf_t *c)
+{
+  uint32_t pad = c->n_fft - c->frame_len;
+
+  Window_Init(check_win, c->frame_len, WINDOW_HANN);
+  arm_rfft_fast_init_f32(&S_Rfft, c->n_fft);
+
+  S_Spectr.pRfft     = &S_Rfft;
+  S_Spectr.Type      = c->type;
+  S_Spectr.pWindow   = check_win;
+  S_Spectr.SampRate  = c->samp_rate;
+  S_Spectr.FrameLen  = c->frame_len;
+  S_Spectr.FFTLen    = c->n_fft;
+  S_Spectr.pScratch1 = check_scratch1;
+  S_Spectr.pScratch2 = check_scratch2;
+  S_Spectr.pad_left  = pad / 2;
+  S_Spectr.pad_right = pad / 2 + (pad & 1);
+
+  S_MelFilter.pStartIndices = check_mel_start;
+  S_MelFilter.pStopIndices  = check_mel_stop;
+  S_MelFilter.pCoefficients = check_mel_coefs;
+  S_MelFilter.NumMels       = c->n_mels;
+  S_MelFilter.FFTLen        = c->n_fft;
+  S_MelFilter.SampRate      = c->samp_rate;
+  S_MelFilter.FMin          = c->f_min;
+  S_MelFilter.FMax          = c->f_max;
+  S_MelFilter.Formula       = c->formula;
+  S_MelFilter.Normalize     = c->normalize;
+  S_MelFilter.Mel2F         = 1U;
+  MelFilterbank_Init(&S_MelFilter);
+
+  S_MelSpectr.SpectrogramConf       = &S_Spectr;
+  S_MelSpectr.MelFilter             = &S_MelFilter;
+  S_LogMelSpectr.MelSpectrogramConf = &S_MelSpectr;
+  S_LogMelSpectr.LogFormula         = c->log_formula;
+  S_LogMelSpectr.Ref                = 1.0f;
+  S_LogMelSpectr.TopdB              = c->top_db;
+
+  S_LogMelFixed.pRfft         = &S_RfftQ31;
+  S_LogMelFixed.pWindow       = check_win_q31;
+  S_LogMelFixed.pCoefficients = check_mel_coefs_q31;
+  S_LogMelFixed.pScratch1     = check_scratch_q31_1;
+  S_LogMelFixed.pScratch2     = check_scratch_q31_2;
+  if (LogMelSpectrogramFixed_Init(&S_LogMelFixed, &S_LogMelSpectr) != 0)
+  {
+    printf("%s: fixed-point init failed\n", c->name);
+    exit(1);
+  }
+}
+
+/* Log-mel range of the corpus, above the floor of the null energies */
+static void check_range(const check_conf_t *c, check_signal_t *pSignals, uint32_t nb_signals,
+                        float32_t *pMin, float32_t *pMax)
+{
+  float32_t floor_lm = (c->log_formula == LOGMELSPECTROGRAM_SCALE_DB) ? -c->top_db : logf(FLT_MIN);
+  float32_t frame[CHECK_MAX_FFT];
+  float32_t out[CHECK_MAX_MELS];
+  float32_t lo = HUGE_VALF, hi = -HUGE_VALF;
+
+  for (uint32_t s = 0; s < nb_signals; s++)
+  {
+    for (uint32_t t = 0; t + c->frame_len <= pSignals[s].len; t += c->hop_len)
+    {
+      /* Frame not centered in the FFT: same spectrum magnitude as the padded one */
+      buf_to_float_normed(&pSignals[s].pSamples[t], frame, c->frame_len);
+      LogMelSpectrogramColumn(&S_LogMelSpectr, frame, out);
+      for (uint32_t i = 0; i < c->n_mels; i++)
+      {
+        if (out[i] > floor_lm + 1.0f)
+        {
+          lo = (out[i] < lo) ? out[i] : lo;
+          hi = (out[i] > hi) ? out[i] : hi;
+        }
+      }
+    }
+  }
+  *pMin = lo;
+  *pMax = hi;
+}
+
+static int check_conf(const check_conf_t *c, check_signal_t *pSignals, uint32_t nb_signals)
+{
+  int8_t out_float[CHECK_MAX_MELS];
+  int8_t out_fixed[CHECK_MAX_MELS];
+  int8_t out_exact[CHECK_MAX_MELS];
+  float32_t lo, hi;
+  int failed = 0;
+
+  check_init(c);
+  check_range(c, pSignals, nb_signals, &lo, &hi);
+
+  /* Whole range, then a 4x finer step on its center, as far as the int8 offset reaches */
+  for (uint32_t zoom = 1; zoom <= 4; zoom *= 4)
+  {
+    float32_t inv_scale = 255.0f * zoom / (hi - lo);
+    int8_t offset = (int8_t)__SSAT((int32_t)roundf(-0.5f * (lo + hi) * inv_scale), 8);
+    uint64_t hist[3] = { 0, 0, 0 };
+    double t_float = 0.0, t_fixed = 0.0, t0;
+    uint64_t nb_cols = 0;
+    int max_err_float = 0, max_err_fixed = 0;
+
+    LogMelSpectrogramFixed_SetQuantization(&S_LogMelFixed, offset, inv_scale);
+    for (uint32_t s = 0; s < nb_signals; s++)
+    {
+      for (uint32_t t = 0; t + c->frame_len <= pSignals[s].len; t += c->hop_len)
+      {
+        int16_t *p_in = &pSignals[s].pSamples[t];
+
+        t0 = check_now();
+        LogMelSpectrogramColumn_q15_Q8(&S_LogMelSpectr, p_in, out_float, offset, inv_scale);
+        t_float += check_now() - t0;
+        t0 = check_now();
+        LogMelSpectrogramFixedColumn_q15_Q8(&S_LogMelFixed, p_in, out_fixed);
+        t_fixed += check_now() - t0;
+        check_exact(c, p_in, out_exact, offset, inv_scale);
+        nb_cols++;
+
+        for (uint32_t i = 0; i < c->n_mels; i++)
+        {
+          int diff = abs(out_float[i] - out_fixed[i]);
+          int err_float = abs(out_float[i] - out_exact[i]);
+          int err_fixed = abs(out_fixed[i] - out_exact[i]);
+
+          hist[(diff > 2) ? 2 : diff]++;
+          max_err_float = (err_float > max_err_float) ? err_float : max_err_float;
+          max_err_fixed = (err_fixed > max_err_fixed) ? err_fixed : max_err_fixed;
+          /* Far below the column peak the float FFT is not exact either */
+          if ((diff > 1) && (err_fixed > 1) && (failed++ < 5))
+          {
+            printf("  %s col %u mel %u: float %d fixed %d exact %d\n", pSignals[s].name, t / c->hop_len, i,
+                   out_float[i], out_fixed[i], out_exact[i]);
+          }
+        }
+      }
+    }
+
+    uint64_t total = hist[0] + hist[1] + hist[2];
+    printf("%-7s x%u inv_scale %7.3f offset %4d %5llu cols | to float: same %6.2f%% 1 step %5.2f%% more %5.2f%%"
+           " | max error float %2d fixed %2d | us/col float %6.2f fixed %6.2f\n",
+           c->name, zoom, inv_scale, offset, (unsigned long long)nb_cols, 100.0 * hist[0] / total,
+           100.0 * hist[1] / total, 100.0 * hist[2] / total, max_err_float, max_err_fixed,
+           t_float / nb_cols, t_fixed / nb_cols);
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  check_signal_t signals[64];
+  uint32_t nb_signals = 0;
+  int failed = 0;
+
+  if (argc > 1)
+  {
+    for (int i = 1; (i < argc) && (nb_signals < 64); i++)
+    {
+      if (check_read_wav(argv[i], &signals[nb_signals]) == 0)
+      {
+        nb_signals++;
+      }
+      else
+      {
+        printf("%s: not a 16-bit PCM WAV file\n", argv[i]);
+      }
+    }
+  }
+  else
+  {
+    static const char *names[] = { "noise", "noise-40dB", "noise-lsb", "tones", "chirp", "clicks", "clipped",
+                                   "bursts", "silence" };
+    for (uint32_t k = 0; k < 9; k++)
+    {
+      signals[nb_signals].name = names[k];
+      signals[nb_signals].len = CHECK_SYNTH_LEN;
+      signals[nb_signals].pSamples = check_synth(k, CHECK_SYNTH_LEN);
+      nb_signals++;
+    }
+  }
+  if (nb_signals == 0)
+  {
+    return 1;
+  }
+
+  for (uint32_t i = 0; i < sizeof(check_confs) / sizeof(check_confs[0]); i++)
+  {
+    failed += check_conf(&check_confs[i], signals, nb_signals);
+  }
+  printf(failed ? "FAILED\n" : "OK\n");
+  return failed ? 1 : 0;
+}
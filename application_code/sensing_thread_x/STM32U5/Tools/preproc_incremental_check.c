@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @file    preproc_incremental_check.c
+  * @author  STMicroelectronics - AIS - MCD Team
+  * @brief   Host check of the incremental spectrogram of PreProc_DPU
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Runs the real PreProc_DPU, built with the AED configuration of the application and a stride of
+ * CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL columns, on an audio stream cut in inputs of
+ * STRIDE_COL * HOP_LENGTH samples, as the PreProc task does.
+ * - Every output patch is compared with its COL columns recomputed directly from the stream with
+ *   the column function of the library (LogMelSpectrogramColumn_q15_Q8, or
+ *   LogMelSpectrogramFixedColumn_q15_Q8 with CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT=1U). Column g
+ *   of the stream starts at sample g * HOP_LENGTH - (WINDOW_LENGTH - HOP_LENGTH), the samples and
+ *   columns before the stream are silence.
+ * - The stream is run twice with PreProc_DPUPrepareToProcessData() in between: the second run must
+ *   not continue the first one.
+ * - The stream is a noisy chirp with a silent gap, longer than several turns of the column ring.
+ * The program returns 1 when an output differs.
+ *
+ * From application_code/sensing_thread_x/STM32U5 (see eloom_host.h for the services replaced on the host,
+ * the CMSIS-DSP sources of the same V1.6.0 release are taken from the H7 tree), for a stride of 8:
+ *   S=Projects/eLooM_Components; E=Middlewares/ST/eLooM; C=Projects/B-U585I-IOT02A/Applications/GS/Core
+ *   A=Middlewares/ST/STM32_AI_AudioPreprocessing_Library
+ *   D=../../object_detection/STM32H7/Drivers/CMSIS/Core/DSP/Source; T=$D/TransformFunctions
+ *   gcc -O2 -Wall -DCTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL=8U -include Tools/eloom_host.h -I$S/DPU/Inc \
+ *       -I$S/EMData/Inc -I$S/SensorManager/Inc -I$E/Inc -I$C/Inc -I$A/Inc -IMiddlewares/ST/STM32_AI_Library/Inc \
+ *       -IDrivers/CMSIS/DSP/Include -IDrivers/CMSIS/Include Tools/preproc_incremental_check.c \
+ *       $C/Src/PreProc_DPU.c $C/Src/user_mel_tables.c $S/DPU/Src/ADPU2.c $S/EMData/Src/services/CircularBuffer.c \
+ *       $S/EMData/Src/services/em_data_format.c $S/EMData/Src/events/DataEventSrc.c $E/Src/events/AEventSrc.c \
+ *       $A/Src/feature_extraction.c $A/Src/mel_filterbank.c $A/Src/window.c $A/Src/dct.c \
+ *       $T/arm_rfft_q31.c $T/arm_rfft_init_q31.c $T/arm_cfft_q31.c $T/arm_cfft_radix4_q31.c \
+ *       $T/arm_rfft_fast_f32.c $T/arm_rfft_fast_init_f32.c $T/arm_cfft_f32.c $T/arm_cfft_radix8_f32.c \
+ *       $T/arm_bitreversal.c $T/arm_bitreversal2.c $D/CommonTables/arm_common_tables.c \
+ *       $D/CommonTables/arm_const_structs.c \
+ *       $D/BasicMathFunctions/arm_mult_f32.c $D/ComplexMathFunctions/arm_cmplx_mag_squared_f32.c \
+ *       -lm -o preproc_incremental_check && ./preproc_incremental_check
+ * Strides of 1 and 8 divide COL (96), a stride of 7 also splits the new columns at the end of the ring.
+ */
+#include "PreProc_DPU.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_INCREMENTAL != 1U)
+#error "Build with CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL smaller than CTRL_X_CUBE_AI_SPECTROGRAM_COL"
+#endif
+
+#define CHECK_NMEL           CTRL_X_CUBE_AI_SPECTROGRAM_NMEL
+#define CHECK_COL            CTRL_X_CUBE_AI_SPECTROGRAM_COL
+#define CHECK_HOP            CTRL_X_CUBE_AI_SPECTROGRAM_HOP_LENGTH
+#define CHECK_STRIDE         CTRL_X_CUBE_AI_SPECTROGRAM_STRIDE_COL
+#define CHECK_INPUT          CTRL_X_CUBE_AI_SPECTROGRAM_INPUT_LENGTH
+#define CHECK_HISTORY        CTRL_X_CUBE_AI_SPECTROGRAM_HISTORY_LENGTH
+#define CHECK_WINDOW         CTRL_X_CUBE_AI_SPECTROGRAM_WINDOW_LENGTH
+/* Three turns of the column ring, whatever the stride */
+#define CHECK_INPUTS         ((3U * CHECK_COL + CHECK_STRIDE - 1U) / CHECK_STRIDE + 2U)
+#define CHECK_RUNS           2U
+
+/* Quantization of the AED model input */
+#define CHECK_Q_OFFSET       (-20)
+#define CHECK_Q_INV_SCALE    (4.0F)
+
+sys_error_t g_nSysError;
+
+void sys_error_handler(void)
+{
+  printf("sys_error_handler: error 0x%x\n", (unsigned)g_nSysError.error_code);
+  exit(1);
+}
+
+/* Stream sample t is stream[CHECK_HISTORY + t], the CHECK_HISTORY samples before it are silence */
+static int16_t stream[CHECK_HISTORY + CHECK_INPUTS * CHECK_INPUT];
+static int16_t silence[CHECK_WINDOW];
+static int8_t patch[CHECK_NMEL * CHECK_COL];
+static PreProc_DPU_t dpu;
+
+static void check_fill(void)
+{
+  uint32_t noise_state = 1U;
+
+  for (uint32_t t = 0; t < CHECK_INPUTS * CHECK_INPUT; t++)
+  {
+    float phase = 2.0F * (float)M_PI * (100.0F + 0.05F * (float)t) * (float)t / CTRL_X_CUBE_AI_SENSOR_ODR;
+    int32_t noise;
+
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    noise = (int32_t)(noise_state & 0x3FFFU) - 0x2000;
+    /* silent gap in the middle of the stream */
+    if ((t / CHECK_INPUT) % 23U == 11U)
+    {
+      stream[CHECK_HISTORY + t] = 0;
+    }
+    else
+    {
+      stream[CHECK_HISTORY + t] = (int16_t)(noise + (int32_t)(12000.0F * sinf(phase)));
+    }
+  }
+}
+
+/* Quantized log-mel column g of the stream, computed directly */
+static void check_column(int32_t g, int8_t *p_col)
+{
+  int16_t *p_in = (g < 0) ? silence : &stream[g * CHECK_HOP];
+
+#if (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U)
+  LogMelSpectrogramFixedColumn_q15_Q8(&dpu.S_LogMelFixed, p_in, p_col);
+#else
+  LogMelSpectrogramColumn_q15_Q8(&dpu.S_LogMelSpectr, p_in, p_col, CHECK_Q_OFFSET, CHECK_Q_INV_SCALE);
+#endif
+}
+
+int main(void)
+{
+  EMData_t in_data, out_data;
+  int8_t ref[CHECK_NMEL];
+  uint32_t nb_patches = 0, nb_differ = 0;
+
+  check_fill();
+
+  PreProc_DPUStaticAlloc(&dpu);
+  (void)PreProc_DPUInit(&dpu, CHECK_INPUT);
+  dpu.type = SPECTROGRAM_LOG_MEL;
+  (void)PreProc_DPUSetQuantization(&dpu, CHECK_Q_OFFSET, CHECK_Q_INV_SCALE);
+  (void)EMD_Init(&out_data, (uint8_t *)patch, E_EM_INT8, E_EM_MODE_LINEAR, 2U, CHECK_COL, CHECK_NMEL);
+
+  for (uint32_t run = 0; run < CHECK_RUNS; run++)
+  {
+    uint32_t differ = 0;
+
+    (void)PreProc_DPUPrepareToProcessData(&dpu);
+    for (uint32_t c = 0; c < CHECK_INPUTS; c++)
+    {
+      (void)EMD_1dInit(&in_data, (uint8_t *)&stream[CHECK_HISTORY + c * CHECK_INPUT], E_EM_INT16, CHECK_INPUT);
+      memset(patch, 0x55, sizeof(patch));
+      if (IDPU2_Process((IDPU2_t *)&dpu, in_data, out_data) != SYS_NO_ERROR_CODE)
+      {
+        return 1;
+      }
+
+      /* Patch column k, oldest first, is stream column (c + 1) * STRIDE - COL + k */
+      for (uint32_t k = 0; k < CHECK_COL; k++)
+      {
+        check_column((int32_t)((c + 1U) * CHECK_STRIDE + k) - (int32_t)CHECK_COL, ref);
+        for (uint32_t j = 0; j < CHECK_NMEL; j++)
+        {
+          differ += (patch[CHECK_COL * j + k] != ref[j]);
+        }
+      }
+      nb_patches++;
+    }
+    printf("run %u: %u patches of %ux%u, %u outputs differ from the direct columns\n", (unsigned)run,
+           (unsigned)CHECK_INPUTS, (unsigned)CHECK_NMEL, (unsigned)CHECK_COL, (unsigned)differ);
+    nb_differ += differ;
+  }
+
+  printf("stride %u (%u samples per inference, %u kept), %s spectrogram: %u patches\n", (unsigned)CHECK_STRIDE,
+         (unsigned)CHECK_INPUT, (unsigned)CHECK_HISTORY,
+         (CTRL_X_CUBE_AI_SPECTROGRAM_FIXED_POINT == 1U) ? "fixed-point" : "floating-point", (unsigned)nb_patches);
+  printf("%s\n", (nb_differ == 0U) ? "OK" : "FAILED");
+
+  return nb_differ != 0U;
+}